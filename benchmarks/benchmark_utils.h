@@ -0,0 +1,64 @@
+#pragma once
+
+#include <ATen/core/dispatch/Dispatcher.h>
+#include <benchmark/benchmark.h>
+#include <torch/script.h>
+
+#include <string>
+#include <vector>
+
+namespace torchaudio {
+namespace benchmarks {
+
+// The ops are called through the dispatcher, as TorchScript and Python do,
+// so that the benchmarks build whatever parts of libtorchaudio are enabled.
+// Returns false, and skips the benchmark, if the op is not registered.
+inline bool FindOp(
+    benchmark::State& state,
+    const char* name,
+    c10::OperatorHandle* op) {
+  auto handle = c10::Dispatcher::singleton().findSchema({name, ""});
+  if (!handle.has_value()) {
+    state.SkipWithError(
+        (std::string(name) + " is not built into libtorchaudio").c_str());
+    return false;
+  }
+  *op = *handle;
+  return true;
+}
+
+// Calls op with args, and returns its outputs.
+inline std::vector<c10::IValue> Call(
+    const c10::OperatorHandle& op,
+    std::vector<c10::IValue> args) {
+  op.callBoxed(&args);
+  return args;
+}
+
+// Returns false, and skips the benchmark, if the device is not available.
+inline bool CheckDevice(benchmark::State& state, const torch::Device& device) {
+  if (device.is_cuda() && !at::hasCUDA()) {
+    state.SkipWithError("CUDA is not available");
+    return false;
+  }
+  return true;
+}
+
+// Waits for the kernels on the device of tensor.
+inline void Synchronize(const torch::Tensor& tensor) {
+  if (tensor.is_cuda()) {
+    benchmark::DoNotOptimize(tensor.sum().item<double>());
+  }
+}
+
+// Reports the seconds of audio processed per second, the inverse of the
+// real-time factor.
+inline void SetAudioRate(benchmark::State& state, double seconds) {
+  state.counters["audio_seconds"] = benchmark::Counter(
+      seconds * state.iterations(), benchmark::Counter::kIsRate);
+}
+
+constexpr int64_t kSampleRate = 16000;
+
+} // namespace benchmarks
+} // namespace torchaudio
@@ -0,0 +1,84 @@
+#include <benchmarks/benchmark_utils.h>
+
+namespace torchaudio {
+namespace benchmarks {
+namespace {
+
+torch::Device DeviceOf(int64_t arg) {
+  return arg == 0 ? torch::Device(torch::kCPU) : torch::Device(torch::kCUDA);
+}
+
+// The coefficients of (1 - 0.5 z^-1)^order, a stable filter of the order.
+torch::Tensor StablePolynomial(int64_t order) {
+  std::vector<double> coeffs = {1.};
+  for (int64_t i = 0; i < order; ++i) {
+    coeffs.push_back(0.);
+    for (size_t j = coeffs.size() - 1; j > 0; --j) {
+      coeffs[j] -= 0.5 * coeffs[j - 1];
+    }
+  }
+  return torch::tensor(coeffs, torch::kFloat32);
+}
+
+// Args: channels, order, seconds, device (0: CPU, 1: CUDA).
+void BM_lfilter(benchmark::State& state) {
+  c10::OperatorHandle op;
+  const auto device = DeviceOf(state.range(3));
+  if (!FindOp(state, "torchaudio::_lfilter", &op) ||
+      !CheckDevice(state, device)) {
+    return;
+  }
+  torch::NoGradGuard no_grad;
+  const int64_t channels = state.range(0);
+  const int64_t order = state.range(1);
+  const int64_t frames = state.range(2) * kSampleRate;
+  const auto options = torch::TensorOptions().device(device);
+  const auto waveform = torch::rand({1, channels, frames}, options) * 2 - 1;
+  const auto a_coeffs =
+      StablePolynomial(order).to(device).unsqueeze(0).repeat({channels, 1});
+  auto b_coeffs = torch::zeros_like(a_coeffs);
+  b_coeffs.select(1, 0).fill_(1.);
+  for (auto _ : state) {
+    auto output = Call(op, {waveform, a_coeffs, b_coeffs})[0].toTensor();
+    Synchronize(output);
+  }
+  state.SetItemsProcessed(state.iterations() * channels * frames);
+  SetAudioRate(state, state.range(2));
+}
+BENCHMARK(BM_lfilter)
+    ->ArgNames({"channels", "order", "seconds", "cuda"})
+    ->ArgsProduct({{1, 2, 8}, {2, 4, 8}, {1, 10}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
+// Args: channels, seconds, device (0: CPU, 1: CUDA).
+void BM_overdrive(benchmark::State& state) {
+  c10::OperatorHandle op;
+  const auto device = DeviceOf(state.range(2));
+  if (!FindOp(state, "torchaudio::_overdrive_core_loop", &op) ||
+      !CheckDevice(state, device)) {
+    return;
+  }
+  torch::NoGradGuard no_grad;
+  const int64_t channels = state.range(0);
+  const int64_t frames = state.range(1) * kSampleRate;
+  const auto options = torch::TensorOptions().device(device);
+  const auto waveform = torch::rand({channels, frames}, options) * 2 - 1;
+  const auto temp = torch::tanh(waveform * 10);
+  for (auto _ : state) {
+    auto last_in = torch::zeros({channels}, options);
+    auto last_out = torch::zeros({channels}, options);
+    auto output = torch::zeros_like(waveform);
+    Call(op, {waveform, temp, last_in, last_out, output});
+    Synchronize(output);
+  }
+  state.SetItemsProcessed(state.iterations() * channels * frames);
+  SetAudioRate(state, state.range(1));
+}
+BENCHMARK(BM_overdrive)
+    ->ArgNames({"channels", "seconds", "cuda"})
+    ->ArgsProduct({{1, 2, 8}, {1, 10}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace
+} // namespace benchmarks
+} // namespace torchaudio
@@ -0,0 +1,56 @@
+#include <benchmarks/benchmark_utils.h>
+
+#include <cmath>
+
+namespace torchaudio {
+namespace benchmarks {
+namespace {
+
+// Args: batch, seconds.
+void BM_ComputeKaldiPitch(benchmark::State& state) {
+  c10::OperatorHandle op;
+  if (!FindOp(state, "torchaudio::kaldi_ComputeKaldiPitch", &op)) {
+    return;
+  }
+  const int64_t batch = state.range(0);
+  const int64_t frames = state.range(1) * kSampleRate;
+  // A 200 Hz tone with noise, so that the pitch search has to track it.
+  const auto time =
+      torch::arange(frames, torch::kFloat32).div(kSampleRate).unsqueeze(0);
+  const auto wave = torch::sin(time * (2 * M_PI * 200)).repeat({batch, 1}) +
+      0.1 * torch::randn({batch, frames});
+  for (auto _ : state) {
+    // The defaults of torchaudio.functional.compute_kaldi_pitch.
+    benchmark::DoNotOptimize(Call(
+        op,
+        {wave,
+         static_cast<double>(kSampleRate),
+         25.,
+         10.,
+         50.,
+         400.,
+         10.,
+         0.1,
+         1000.,
+         4000.,
+         0.005,
+         7000.,
+         int64_t(1),
+         int64_t(5),
+         int64_t(0),
+         int64_t(0),
+         false,
+         int64_t(500),
+         true}));
+  }
+  state.SetItemsProcessed(state.iterations() * batch * frames);
+  SetAudioRate(state, batch * state.range(1));
+}
+BENCHMARK(BM_ComputeKaldiPitch)
+    ->ArgNames({"batch", "seconds"})
+    ->ArgsProduct({{1, 8}, {1, 10, 60}})
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace
+} // namespace benchmarks
+} // namespace torchaudio
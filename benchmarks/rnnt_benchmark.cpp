@@ -0,0 +1,101 @@
+#include <benchmarks/benchmark_utils.h>
+
+namespace torchaudio {
+namespace benchmarks {
+namespace {
+
+// Args: batch, T (frames), U (target length), D (classes), device (0: CPU,
+// 1: CUDA), half (0: float32, 1: float16).
+void BM_rnnt_loss(benchmark::State& state) {
+  c10::OperatorHandle op;
+  const auto device = state.range(4) == 0 ? torch::Device(torch::kCPU)
+                                          : torch::Device(torch::kCUDA);
+  if (!FindOp(state, "torchaudio::rnnt_loss", &op) ||
+      !CheckDevice(state, device)) {
+    return;
+  }
+  const int64_t B = state.range(0);
+  const int64_t T = state.range(1);
+  const int64_t U = state.range(2);
+  const int64_t D = state.range(3);
+  const auto dtype = state.range(5) == 0 ? torch::kFloat32 : torch::kFloat16;
+  const auto int_options =
+      torch::TensorOptions().device(device).dtype(torch::kInt32);
+
+  const auto logits = torch::randn(
+      {B, T, U + 1, D}, torch::TensorOptions().device(device).dtype(dtype));
+  // Targets do not contain blank, the last class.
+  const auto targets = torch::randint(0, D - 1, {B, U}, int_options);
+  const auto logit_lengths = torch::full({B}, T, int_options);
+  const auto target_lengths = torch::full({B}, U, int_options);
+  for (auto _ : state) {
+    auto outputs = Call(
+        op,
+        {logits,
+         targets,
+         logit_lengths,
+         target_lengths,
+         D - 1,
+         -1.,
+         false,
+         true,
+         "counters"});
+    Synchronize(outputs[0].toTensor());
+  }
+  state.SetItemsProcessed(state.iterations() * B * T * (U + 1));
+  state.SetBytesProcessed(state.iterations() * logits.nbytes());
+}
+BENCHMARK(BM_rnnt_loss)
+    ->ArgNames({"B", "T", "U", "D", "cuda", "half"})
+    ->ArgsProduct({{1, 8}, {150, 500}, {20, 80}, {128, 512}, {0, 1}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
+// Compares the kernels of the alphas and the betas on CUDA, over lattices
+// from much longer than wide to much wider than long.
+// Args: batch, T (frames), U (target length), kernel (0: counters,
+// 1: diagonal).
+void BM_rnnt_alphas_betas_kernel(benchmark::State& state) {
+  c10::OperatorHandle op;
+  const auto device = torch::Device(torch::kCUDA);
+  if (!FindOp(state, "torchaudio::rnnt_loss", &op) ||
+      !CheckDevice(state, device)) {
+    return;
+  }
+  const int64_t B = state.range(0);
+  const int64_t T = state.range(1);
+  const int64_t U = state.range(2);
+  const int64_t D = 32;
+  const auto int_options =
+      torch::TensorOptions().device(device).dtype(torch::kInt32);
+
+  const auto logits = torch::randn(
+      {B, T, U + 1, D},
+      torch::TensorOptions().device(device).dtype(torch::kFloat32));
+  const auto targets = torch::randint(0, D - 1, {B, U}, int_options);
+  const auto logit_lengths = torch::full({B}, T, int_options);
+  const auto target_lengths = torch::full({B}, U, int_options);
+  const std::string kernel = state.range(3) == 0 ? "counters" : "diagonal";
+  for (auto _ : state) {
+    auto outputs = Call(
+        op,
+        {logits,
+         targets,
+         logit_lengths,
+         target_lengths,
+         D - 1,
+         -1.,
+         false,
+         false,
+         kernel});
+    Synchronize(outputs[0].toTensor());
+  }
+  state.SetItemsProcessed(state.iterations() * B * T * (U + 1));
+}
+BENCHMARK(BM_rnnt_alphas_betas_kernel)
+    ->ArgNames({"B", "T", "U", "kernel"})
+    ->ArgsProduct({{1, 16}, {100, 1000}, {10, 100, 1000}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace
+} // namespace benchmarks
+} // namespace torchaudio
@@ -0,0 +1,155 @@
+#include <benchmarks/benchmark_utils.h>
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace torchaudio {
+namespace benchmarks {
+namespace {
+
+struct Format {
+  const char* name;
+  const char* extension;
+};
+
+const Format kFormats[] = {
+    {"wav", "wav"},
+    {"flac", "flac"},
+    {"mp3", "mp3"},
+    {"vorbis", "ogg"},
+};
+
+std::string TempPath(const std::string& name) {
+  const char* dir = std::getenv("TMPDIR");
+  return std::string(dir ? dir : "/tmp") + "/torchaudio_benchmark_" + name;
+}
+
+// (channels, frames) float32 noise in [-0.5, 0.5].
+torch::Tensor Noise(int64_t channels, int64_t seconds) {
+  return torch::rand({channels, seconds * kSampleRate}) - 0.5;
+}
+
+bool Save(
+    benchmark::State& state,
+    const c10::OperatorHandle& op,
+    const std::string& path,
+    const torch::Tensor& waveform) {
+  try {
+    Call(
+        op,
+        {path,
+         waveform,
+         kSampleRate,
+         true,
+         c10::IValue(),
+         c10::IValue(),
+         c10::IValue(),
+         c10::IValue()});
+  } catch (const c10::Error& error) {
+    state.SkipWithError(error.what_without_backtrace());
+    return false;
+  }
+  return true;
+}
+
+// Args: format (index in kFormats), channels, seconds.
+void BM_sox_io_load(benchmark::State& state) {
+  c10::OperatorHandle load, save;
+  if (!FindOp(state, "torchaudio::sox_io_load_audio_file", &load) ||
+      !FindOp(state, "torchaudio::sox_io_save_audio_file", &save)) {
+    return;
+  }
+  const Format& format = kFormats[state.range(0)];
+  state.SetLabel(format.name);
+  const std::string path = TempPath(
+      std::to_string(state.range(1)) + "_" + std::to_string(state.range(2)) +
+      "." + format.extension);
+  if (!Save(state, save, path, Noise(state.range(1), state.range(2)))) {
+    return;
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Call(
+        load,
+        {path,
+         c10::IValue(),
+         c10::IValue(),
+         true,
+         true,
+         c10::IValue()}));
+  }
+  std::remove(path.c_str());
+  SetAudioRate(state, state.range(2));
+}
+BENCHMARK(BM_sox_io_load)
+    ->ArgNames({"format", "channels", "seconds"})
+    ->ArgsProduct({{0, 1, 2, 3}, {1, 2}, {1, 10, 60}})
+    ->Unit(benchmark::kMillisecond);
+
+// Args: format (index in kFormats), channels, seconds.
+void BM_sox_io_save(benchmark::State& state) {
+  c10::OperatorHandle save;
+  if (!FindOp(state, "torchaudio::sox_io_save_audio_file", &save)) {
+    return;
+  }
+  const Format& format = kFormats[state.range(0)];
+  state.SetLabel(format.name);
+  const std::string path = TempPath(std::string("save.") + format.extension);
+  const auto waveform = Noise(state.range(1), state.range(2));
+  for (auto _ : state) {
+    if (!Save(state, save, path, waveform)) {
+      break;
+    }
+  }
+  std::remove(path.c_str());
+  SetAudioRate(state, state.range(2));
+}
+BENCHMARK(BM_sox_io_save)
+    ->ArgNames({"format", "channels", "seconds"})
+    ->ArgsProduct({{0, 1, 2, 3}, {1, 2}, {1, 10, 60}})
+    ->Unit(benchmark::kMillisecond);
+
+const std::vector<std::vector<std::string>> kEffects[] = {
+    {{"gain", "-n"}},
+    {{"rate", "8000"}},
+    {{"speed", "1.1"}, {"rate", "16000"}},
+    {{"reverb", "50"}},
+    {{"lowpass", "-1", "300"}, {"highpass", "-1", "100"}, {"gain", "-n"}},
+};
+
+// Args: effects (index in kEffects), channels, seconds.
+void BM_sox_effects_apply_effects_tensor(benchmark::State& state) {
+  c10::OperatorHandle op;
+  if (!FindOp(state, "torchaudio::sox_effects_apply_effects_tensor", &op)) {
+    return;
+  }
+  c10::OperatorHandle initialize;
+  const char* initialize_name =
+      "torchaudio::sox_effects_initialize_sox_effects";
+  if (!FindOp(state, initialize_name, &initialize)) {
+    return;
+  }
+  Call(initialize, {});
+  const auto& effects = kEffects[state.range(0)];
+  c10::List<c10::List<std::string>> chain;
+  std::string label;
+  for (const auto& effect : effects) {
+    chain.push_back(c10::List<std::string>(effect));
+    for (const auto& option : effect) {
+      label += (label.empty() ? "" : " ") + option;
+    }
+  }
+  state.SetLabel(label);
+  const auto waveform = Noise(state.range(1), state.range(2));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Call(op, {waveform, kSampleRate, chain, true}));
+  }
+  SetAudioRate(state, state.range(2));
+}
+BENCHMARK(BM_sox_effects_apply_effects_tensor)
+    ->ArgNames({"effects", "channels", "seconds"})
+    ->ArgsProduct({{0, 1, 2, 3, 4}, {1, 2}, {1, 10}})
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace
+} // namespace benchmarks
+} // namespace torchaudio
@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+"""Measure how the throughput of sox effects chains scales with concurrency.
+
+The same set of files is decoded (and processed with the given effects) with
+1, 2, ... N chains running at the same time, and the aggregate throughput is
+reported as seconds of audio per second of wall time. A speedup well below N
+indicates contention, for example in the process-wide state of libsox.
+
+Two modes are available.
+
+* ``load``: ``torchaudio.backend.sox_io_backend.load_files`` with ``num_threads=N``.
+  The chains run on the intra-op thread pool, without Python in between.
+* ``effects``: ``torchaudio.sox_effects.apply_effects_file`` on file objects,
+  from N Python threads. The decoding runs without the GIL, which is taken
+  only to read the file objects.
+
+Example
+
+    python sox_chain_scaling.py --mode effects --effects "rate 8000" --max-chains 8
+"""
+import argparse
+import concurrent.futures
+import os
+import tempfile
+import time
+
+import torch
+import torchaudio
+from torchaudio.backend import sox_io_backend
+
+
+def _parse_args():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawTextHelpFormatter)
+    parser.add_argument(
+        "files", nargs="*",
+        help="Audio files to decode. When not given, WAV and FLAC files of sine waves are generated.")
+    parser.add_argument("--mode", choices=["load", "effects"], default="load")
+    parser.add_argument(
+        "--effects", action="append", default=[],
+        help='Effect applied in "effects" mode, such as "rate 8000". Can be given multiple times.')
+    parser.add_argument("--max-chains", type=int, default=os.cpu_count())
+    parser.add_argument("--num-files", type=int, default=64, help="The number of files to generate.")
+    parser.add_argument("--duration", type=float, default=10., help="The duration of the generated files.")
+    parser.add_argument("--repeats", type=int, default=3, help="The best of this many runs is reported.")
+    parser.add_argument(
+        "--buffer-size", type=int,
+        help="The buffer size of each chain in \"load\" mode, in the unit of sox_utils.set_buffer_size.")
+    return parser.parse_args()
+
+
+def _generate_files(dir_, num_files, duration, sample_rate=16000):
+    time_ = torch.arange(int(duration * sample_rate)) / sample_rate
+    paths = []
+    for i in range(num_files):
+        waveform = 0.5 * torch.sin(2 * 3.14159 * (220 + 10 * i) * time_).repeat(2, 1)
+        path = os.path.join(dir_, f"{i}.{'wav' if i % 2 else 'flac'}")
+        torchaudio.save(path, waveform, sample_rate, bits_per_sample=16)
+        paths.append(path)
+    return paths
+
+
+def _run_load(paths, num_chains, buffer_size):
+    waveforms, sample_rates = sox_io_backend.load_files(paths, num_threads=num_chains, buffer_size=buffer_size)
+    return sum(w.size(1) / sr for w, sr in zip(waveforms, sample_rates))
+
+
+def _run_effects(paths, num_chains, effects):
+    def _apply(path):
+        with open(path, "rb") as fileobj:
+            waveform, sample_rate = torchaudio.sox_effects.apply_effects_file(fileobj, effects)
+        return waveform.size(1) / sample_rate
+
+    with concurrent.futures.ThreadPoolExecutor(max_workers=num_chains) as executor:
+        return sum(executor.map(_apply, paths))
+
+
+def _benchmark(args, paths):
+    effects = [effect.split() for effect in args.effects]
+    print(f"{'chains':>6} {'audio sec/sec':>14} {'speedup':>8}")
+    base = None
+    for num_chains in range(1, args.max_chains + 1):
+        best = None
+        for _ in range(args.repeats):
+            start = time.perf_counter()
+            if args.mode == "load":
+                audio_seconds = _run_load(paths, num_chains, args.buffer_size)
+            else:
+                audio_seconds = _run_effects(paths, num_chains, effects)
+            elapsed = time.perf_counter() - start
+            best = elapsed if best is None else min(best, elapsed)
+        throughput = audio_seconds / best
+        base = base or throughput
+        print(f"{num_chains:>6} {throughput:>14.1f} {throughput / base:>8.2f}")
+
+
+def _main():
+    args = _parse_args()
+    if args.files:
+        _benchmark(args, args.files)
+        return
+    with tempfile.TemporaryDirectory() as dir_:
+        _benchmark(args, _generate_files(dir_, args.num_files, args.duration))
+
+
+if __name__ == "__main__":
+    _main()
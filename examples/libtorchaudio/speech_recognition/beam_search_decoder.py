@@ -0,0 +1,52 @@
+from typing import List, Optional
+
+import torch
+import torchaudio
+
+
+class Decoder(torch.nn.Module):
+    def __init__(
+            self,
+            labels: List[str],
+            beam_size: int = 50,
+            lexicon: Optional[str] = None,
+            lm: Optional[str] = None,
+            lm_weight: float = 2.,
+            word_score: float = 0.,
+    ):
+        super().__init__()
+        self.labels = labels
+        self.decoder = torchaudio.functional.create_ctc_decoder(
+            labels,
+            blank=labels.index('<s>'),
+            word_boundary=labels.index('|'),
+            beam_size=beam_size,
+            lexicon=lexicon,
+            lm=lm,
+            lm_weight=lm_weight,
+            word_score=word_score,
+        )
+
+    def forward(self, logits: torch.Tensor) -> str:
+        """Given a sequence logits over labels, get the best transcript of the beam search
+
+        Args:
+            logits (Tensor): Logit tensors. Shape `[num_seq, num_label]`.
+
+        Returns:
+            str: The resulting transcript
+        """
+        emission = torch.log_softmax(logits.float(), dim=-1).unsqueeze(0)
+        hypos = self.decoder.decode(emission, None)[0]
+        hypothesis = ''
+        if len(hypos) == 0:
+            return hypothesis
+        tokens, _ = hypos[0]
+        for i in tokens:
+            char = self.labels[i]
+            if char in ['<s>', '<pad>']:
+                continue
+            if char == '|':
+                char = ' '
+            hypothesis += char
+        return hypothesis.strip()
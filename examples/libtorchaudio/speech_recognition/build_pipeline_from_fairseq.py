@@ -6,6 +6,7 @@ To use this script, you need `fairseq`.
 import os
 import argparse
 import logging
+from typing import Optional, Tuple
 
 import torch
 from torch.utils.mobile_optimizer import optimize_for_mobile
@@ -13,7 +14,8 @@ import torchaudio
 from torchaudio.models.wav2vec2.utils.import_fairseq import import_fairseq_model
 import fairseq
 
-from greedy_decoder import Decoder
+import beam_search_decoder
+import greedy_decoder
 
 _LG = logging.getLogger(__name__)
 
@@ -55,6 +57,35 @@ def _parse_args():
         action='store_true',
         help='Apply quantization to model.'
     )
+    parser.add_argument(
+        '--beam-size',
+        type=int,
+        default=0,
+        help=(
+            'Decode with a CTC prefix beam search of this size. '
+            'When not given, the greedy decoder is used.'
+        )
+    )
+    parser.add_argument(
+        '--lexicon',
+        help=(
+            'Path to a lexicon file, to which the beam search is restricted. '
+            'The path is stored in `decoder.zip`, so it must be valid where the pipeline runs.'
+        )
+    )
+    parser.add_argument(
+        '--lm',
+        help=(
+            'Path to a word n-gram language model in ARPA format, used by the beam search. '
+            'The path is stored in `decoder.zip`, so it must be valid where the pipeline runs.'
+        )
+    )
+    parser.add_argument(
+        '--lm-weight',
+        type=float,
+        default=2.,
+        help='The weight of the language model.'
+    )
     parser.add_argument(
         '--optimize-for-mobile',
         action='store_true',
@@ -80,8 +111,17 @@ class Encoder(torch.nn.Module):
         result, _ = self.encoder(waveform)
         return result[0]
 
+    @torch.jit.export
+    def forward_batch(
+            self,
+            waveforms: torch.Tensor,
+            lengths: torch.Tensor,
+    ) -> Tuple[torch.Tensor, Optional[torch.Tensor]]:
+        """Encode a zero-padded batch of waveforms. Used by `transcribe_list`."""
+        return self.encoder(waveforms, lengths)
+
 
-def _get_decoder():
+def _get_decoder(beam_size=0, lexicon=None, lm=None, lm_weight=2.):
     labels = [
         "<s>",
         "<pad>",
@@ -116,7 +156,10 @@ def _get_decoder():
         "Q",
         "Z",
     ]
-    return Decoder(labels)
+    if beam_size > 0 or lexicon or lm:
+        return beam_search_decoder.Decoder(
+            labels, beam_size=beam_size or 50, lexicon=lexicon, lm=lm, lm_weight=lm_weight)
+    return greedy_decoder.Decoder(labels)
 
 
 def _load_fairseq_model(input_file, data_dir=None):
@@ -143,7 +186,7 @@ def _main():
     loader = Loader()
     model = _get_model(args.model_file, args.dict_dir).eval()
     encoder = Encoder(model)
-    decoder = _get_decoder()
+    decoder = _get_decoder(args.beam_size, args.lexicon, args.lm, args.lm_weight)
     _LG.info(encoder)
 
     if args.quantize:
@@ -165,7 +208,7 @@ def _main():
     torch.jit.script(decoder).save(os.path.join(args.output_path, 'decoder.zip'))
     scripted = torch.jit.script(encoder)
     if args.optimize_for_mobile:
-        scripted = optimize_for_mobile(scripted)
+        scripted = optimize_for_mobile(scripted, preserved_methods=['forward_batch'])
     scripted.save(os.path.join(args.output_path, 'encoder.zip'))
 
 
@@ -2,6 +2,7 @@
 import argparse
 import logging
 import os
+from typing import Optional, Tuple
 
 import torch
 import torchaudio
@@ -61,6 +62,15 @@ class Encoder(torch.nn.Module):
         result, _ = self.encoder(waveform)
         return result[0]
 
+    @torch.jit.export
+    def forward_batch(
+            self,
+            waveforms: torch.Tensor,
+            lengths: torch.Tensor,
+    ) -> Tuple[torch.Tensor, Optional[torch.Tensor]]:
+        """Encode a zero-padded batch of waveforms. Used by `transcribe_list`."""
+        return self.encoder(waveforms, lengths)
+
 
 def _get_model(model_id):
     from transformers import Wav2Vec2ForCTC, Wav2Vec2Processor
@@ -1,11 +1,164 @@
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include <c10/core/InferenceMode.h>
 #include <torch/script.h>
 
+// The loader resamples the audio to this rate.
+constexpr double kSampleRate = 16000.;
+
+using Clock = std::chrono::steady_clock;
+
+double elapsed_ms(Clock::time_point t0, Clock::time_point t1) {
+  return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+struct Options {
+  int loader_threads = 2;
+  int decoder_threads = 2;
+  int batch_size = 8;
+  // Number of batches of loaded utterances sorted by length together.
+  int bucket_batches = 4;
+  int queue_size = 64;
+};
+
+// Queue of bounded capacity between the stages of the pipeline.
+template <typename T>
+class BoundedQueue {
+ public:
+  explicit BoundedQueue(size_t capacity) : capacity_(capacity) {}
+
+  // Blocks while the queue is full.
+  void push(T item) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_full_.wait(lock, [&] { return items_.size() < capacity_; });
+    items_.push_back(std::move(item));
+    not_empty_.notify_one();
+  }
+
+  // Blocks while the queue is empty and open. Returns false once it is closed
+  // and empty.
+  bool pop(T& item) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_empty_.wait(lock, [&] { return !items_.empty() || closed_; });
+    if (items_.empty()) {
+      return false;
+    }
+    item = std::move(items_.front());
+    items_.pop_front();
+    not_full_.notify_one();
+    return true;
+  }
+
+  // Called by the last producer.
+  void close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    not_empty_.notify_all();
+  }
+
+ private:
+  const size_t capacity_;
+  std::deque<T> items_;
+  bool closed_ = false;
+  std::mutex mutex_;
+  std::condition_variable not_full_;
+  std::condition_variable not_empty_;
+};
+
+// Latencies of a stage, in milliseconds, recorded from several threads.
+class Latencies {
+ public:
+  explicit Latencies(std::string name) : name_(std::move(name)) {}
+
+  void add(double ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    values_.push_back(ms);
+  }
+
+  void report() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (values_.empty()) {
+      return;
+    }
+    std::sort(values_.begin(), values_.end());
+    double total = 0.;
+    for (double v : values_) {
+      total += v;
+    }
+    auto percentile = [&](double p) {
+      return values_[std::min(
+          values_.size() - 1, static_cast<size_t>(p * values_.size()))];
+    };
+    std::cout << "Latency (" << name_ << "): n=" << values_.size()
+              << " total=" << total << " p50=" << percentile(0.5)
+              << " p99=" << percentile(0.99) << " max=" << values_.back()
+              << " [ms]" << std::endl;
+  }
+
+ private:
+  std::string name_;
+  std::mutex mutex_;
+  std::vector<double> values_;
+};
+
+struct Entry {
+  std::string id;
+  std::string path;
+  std::string reference;
+};
+
+struct Utterance {
+  size_t index;
+  // (num_samples, ) waveform, then (num_frames, num_labels) emission.
+  torch::Tensor data;
+  Clock::time_point start;
+};
+
+void usage(const char* name) {
+  std::cerr << "Usage: " << name
+            << " <JIT_OBJECT_DIR> <FILE_LIST> <OUTPUT_DIR> [--loader-threads N]"
+               " [--decoder-threads N] [--batch-size N] [--queue-size N]\n"
+            << std::endl;
+  std::cerr << "<FILE_LIST> is `<ID>\t<PATH>\t<TRANSCRIPTION>`" << std::endl;
+}
+
+bool parse_options(int argc, char* argv[], Options& options) {
+  for (int i = 4; i < argc; i += 2) {
+    if (i + 1 >= argc) {
+      return false;
+    }
+    const std::string key(argv[i]);
+    const int value = std::atoi(argv[i + 1]);
+    if (value <= 0) {
+      return false;
+    }
+    if (key == "--loader-threads") {
+      options.loader_threads = value;
+    } else if (key == "--decoder-threads") {
+      options.decoder_threads = value;
+    } else if (key == "--batch-size") {
+      options.batch_size = value;
+    } else if (key == "--queue-size") {
+      options.queue_size = value;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
 
 int main(int argc, char* argv[]) {
-  if (argc != 4) {
-    std::cerr << "Usage: " << argv[0] << "<JIT_OBJECT_DIR> <FILE_LIST> <OUTPUT_DIR>\n" << std::endl;
-    std::cerr << "<FILE_LIST> is `<ID>\t<PATH>\t<TRANSCRIPTION>`" << std::endl;
+  Options options;
+  if (argc < 4 || !parse_options(argc, argv, options)) {
+    usage(argv[0]);
     return -1;
   }
 
@@ -29,38 +182,182 @@ int main(int argc, char* argv[]) {
     std::cerr << "Failed to load the module:" << error.what() << std::endl;
     return -1;
   }
+  // Pipelines built before `forward_batch` was added are run one utterance at
+  // a time.
+  const bool batched = encoder.find_method("forward_batch").has_value();
+  if (!batched) {
+    std::cout << "The encoder has no `forward_batch` method; "
+                 "running with a batch size of 1." << std::endl;
+    options.batch_size = 1;
+  }
+
+  std::vector<Entry> entries;
+  {
+    std::ifstream input_file(argv[2]);
+    std::string line;
+    while (std::getline(input_file, line)) {
+      std::istringstream iline(line);
+      Entry entry;
+      std::getline(iline, entry.id, '\t');
+      std::getline(iline, entry.path, '\t');
+      std::getline(iline, entry.reference, '\t');
+      entries.push_back(std::move(entry));
+    }
+  }
+
+  BoundedQueue<Utterance> loaded(options.queue_size);
+  BoundedQueue<Utterance> encoded(options.queue_size);
+  std::vector<std::string> hypotheses(entries.size());
+  std::atomic<double> audio_seconds(0.);
+  Latencies load_latency("load"), encode_latency("encode, per batch"),
+      decode_latency("decode"), total_latency("end to end");
+
+  const Clock::time_point t_start = Clock::now();
+
+  // Loaders: read and resample the files ahead of the encoder.
+  std::atomic<size_t> next_entry(0);
+  std::atomic<int> running_loaders(options.loader_threads);
+  std::vector<std::thread> loader_threads;
+  for (int i = 0; i < options.loader_threads; ++i) {
+    loader_threads.emplace_back([&] {
+      torch::NoGradGuard no_grad;
+      c10::InferenceMode inference_mode;
+      for (size_t index = next_entry++; index < entries.size();
+           index = next_entry++) {
+        const Clock::time_point t0 = Clock::now();
+        torch::Tensor waveform;
+        try {
+          waveform = loader.forward({c10::IValue(entries[index].path)})
+                         .toTensor()[0];
+        } catch (const c10::Error &error) {
+          std::cerr << "Failed to load " << entries[index].path << ": "
+                    << error.what() << std::endl;
+          continue;
+        }
+        load_latency.add(elapsed_ms(t0, Clock::now()));
+        double seconds = audio_seconds.load();
+        while (!audio_seconds.compare_exchange_weak(
+            seconds, seconds + waveform.size(0) / kSampleRate)) {
+        }
+        loaded.push({index, std::move(waveform), t0});
+      }
+      if (--running_loaders == 0) {
+        loaded.close();
+      }
+    });
+  }
+
+  // Decoders: turn the emissions into transcripts while the next batches are
+  // encoded.
+  std::vector<std::thread> decoder_threads;
+  for (int i = 0; i < options.decoder_threads; ++i) {
+    decoder_threads.emplace_back([&] {
+      torch::NoGradGuard no_grad;
+      c10::InferenceMode inference_mode;
+      Utterance utterance;
+      while (encoded.pop(utterance)) {
+        const Clock::time_point t0 = Clock::now();
+        auto result = decoder.forward({utterance.data});
+        const Clock::time_point t1 = Clock::now();
+        decode_latency.add(elapsed_ms(t0, t1));
+        total_latency.add(elapsed_ms(utterance.start, t1));
+        hypotheses[utterance.index] = result.toString()->string();
+      }
+    });
+  }
+
+  // Encoder: batches the loaded utterances of similar lengths, so that little
+  // of a batch is padding.
+  {
+    torch::NoGradGuard no_grad;
+    c10::InferenceMode inference_mode;
+    const size_t bucket_size =
+        static_cast<size_t>(options.batch_size) * options.bucket_batches;
+    std::vector<Utterance> bucket;
+    auto encode = [&](std::vector<Utterance>::iterator begin,
+                      std::vector<Utterance>::iterator end) {
+      const Clock::time_point t0 = Clock::now();
+      const int64_t batch_size = end - begin;
+      if (!batched) {
+        auto emission = encoder.forward({begin->data.unsqueeze(0)}).toTensor();
+        encode_latency.add(elapsed_ms(t0, Clock::now()));
+        encoded.push({begin->index, emission, begin->start});
+        return;
+      }
+      int64_t max_length = 0;
+      for (auto it = begin; it != end; ++it) {
+        max_length = std::max(max_length, it->data.size(0));
+      }
+      auto waveforms =
+          torch::zeros({batch_size, max_length}, begin->data.options());
+      auto lengths = torch::empty({batch_size}, torch::kInt64);
+      for (int64_t i = 0; i < batch_size; ++i) {
+        const auto& waveform = begin[i].data;
+        waveforms[i].narrow(0, 0, waveform.size(0)).copy_(waveform);
+        lengths[i] = waveform.size(0);
+      }
+      auto outputs = encoder.get_method("forward_batch")({waveforms, lengths})
+                         .toTuple()
+                         ->elements();
+      auto emissions = outputs[0].toTensor();
+      encode_latency.add(elapsed_ms(t0, Clock::now()));
+      for (int64_t i = 0; i < batch_size; ++i) {
+        auto emission = emissions[i];
+        if (!outputs[1].isNone()) {
+          emission =
+              emission.narrow(0, 0, outputs[1].toTensor()[i].item<int64_t>());
+        }
+        encoded.push({begin[i].index, emission, begin[i].start});
+      }
+    };
+    auto flush = [&] {
+      std::sort(
+          bucket.begin(),
+          bucket.end(),
+          [](const Utterance& a, const Utterance& b) {
+            return a.data.size(0) < b.data.size(0);
+          });
+      for (size_t i = 0; i < bucket.size(); i += options.batch_size) {
+        encode(
+            bucket.begin() + i,
+            bucket.begin() + std::min(bucket.size(), i + options.batch_size));
+      }
+      bucket.clear();
+    };
+    Utterance utterance;
+    while (loaded.pop(utterance)) {
+      bucket.push_back(std::move(utterance));
+      if (bucket.size() >= bucket_size) {
+        flush();
+      }
+    }
+    flush();
+    encoded.close();
+  }
+
+  for (auto& thread : loader_threads) {
+    thread.join();
+  }
+  for (auto& thread : decoder_threads) {
+    thread.join();
+  }
+  const double wall_seconds = elapsed_ms(t_start, Clock::now()) / 1000.;
 
-  std::ifstream input_file(argv[2]);
   std::string output_dir(argv[3]);
   std::ofstream output_ref(output_dir + "/ref.trn");
   std::ofstream output_hyp(output_dir + "/hyp.trn");
-  std::string line;
-  std::chrono::milliseconds t_encode(0);
-  std::chrono::milliseconds t_decode(0);
-  while(std::getline(input_file, line)) {
-    std::istringstream iline(line);
-    std::string id;
-    std::string path;
-    std::string reference;
-    std::getline(iline, id, '\t');
-    std::getline(iline, path, '\t');
-    std::getline(iline, reference, '\t');
-
-    auto waveform = loader.forward({c10::IValue(path)});
-    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
-    auto emission = encoder.forward({waveform});
-    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
-    auto result = decoder.forward({emission});
-    std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
-
-    t_encode += std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0);
-    t_decode += std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1);
-
-    auto hypothesis = result.toString()->string();
-    output_hyp << hypothesis << " (" << id << ")" << std::endl;
-    output_ref << reference << " (" << id << ")" << std::endl;
-    std::cout << id << '\t' << hypothesis << std::endl;
-  }
-  std::cout << "Time (encode): " << t_encode.count() << " [ms]" << std::endl;
-  std::cout << "Time (decode): " << t_decode.count() << " [ms]" << std::endl;
+  for (size_t i = 0; i < entries.size(); ++i) {
+    output_hyp << hypotheses[i] << " (" << entries[i].id << ")" << std::endl;
+    output_ref << entries[i].reference << " (" << entries[i].id << ")"
+               << std::endl;
+    std::cout << entries[i].id << '\t' << hypotheses[i] << std::endl;
+  }
+
+  load_latency.report();
+  encode_latency.report();
+  decode_latency.report();
+  total_latency.report();
+  std::cout << "Audio: " << audio_seconds.load() << " [s], wall time: "
+            << wall_seconds << " [s], real-time factor: "
+            << wall_seconds / std::max(audio_seconds.load(), 1e-9) << std::endl;
 }
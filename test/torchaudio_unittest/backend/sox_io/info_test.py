@@ -294,6 +294,70 @@ class TestLoadWithoutExtension(PytorchTestCase):
         assert sinfo.encoding == "MP3"
 
 
+@skipIfNoExec('sox')
+@skipIfNoSox
+class TestInfoFiles(TempDirMixin, PytorchTestCase):
+    """Test `sox_io_backend.info_files`"""
+    paths = None
+
+    def setUp(self):
+        super().setUp()
+        self.paths = []
+        for ext in ['wav', 'flac', 'mp3', 'vorbis', 'wav']:
+            path = self.get_temp_path(f'{len(self.paths)}.{ext}')
+            sox_utils.gen_audio_file(path, 16000, 2, bit_depth=16 if ext != 'mp3' else None, duration=1)
+            self.paths.append(path)
+
+    def assert_info(self, found, expected, header_only):
+        assert found.sample_rate == expected.sample_rate
+        assert found.num_frames == (0 if header_only else expected.num_frames)
+        assert found.num_channels == expected.num_channels
+        assert found.bits_per_sample == expected.bits_per_sample
+        assert found.encoding == expected.encoding
+
+    @parameterized.expand([(False, ), (True, )], name_func=name_func)
+    def test_info_files(self, header_only):
+        """`info_files` returns the same as `info` on each file"""
+        found = sox_io_backend.info_files(self.paths, header_only=header_only)
+        assert len(found) == len(self.paths)
+        for path, info in zip(self.paths, found):
+            self.assert_info(info, sox_io_backend.info(path), header_only)
+
+    @parameterized.expand([(False, ), (True, )], name_func=name_func)
+    def test_info_files_cache(self, header_only):
+        """`info_files` returns the same result with cache, and updates it when a file changes"""
+        cache_path = self.get_temp_path(f'cache_{header_only}.json')
+        for _ in range(2):
+            found = sox_io_backend.info_files(self.paths, header_only=header_only, cache_path=cache_path)
+            for path, info in zip(self.paths, found):
+                self.assert_info(info, sox_io_backend.info(path), header_only)
+        assert os.path.exists(cache_path)
+
+        # Rewrite one file with a different sample rate
+        sox_utils.gen_audio_file(self.paths[0], 8000, 1, bit_depth=16, duration=2)
+        found = sox_io_backend.info_files(self.paths, header_only=header_only, cache_path=cache_path)
+        self.assert_info(found[0], sox_io_backend.info(self.paths[0]), header_only)
+        assert found[0].sample_rate == 8000
+
+    def test_info_files_cache_mode(self):
+        """Cached results of a query mode are not returned for the other mode"""
+        cache_path = self.get_temp_path('cache.json')
+        for header_only in [False, True, False]:
+            found = sox_io_backend.info_files(self.paths, header_only=header_only, cache_path=cache_path)
+            for path, info in zip(self.paths, found):
+                self.assert_info(info, sox_io_backend.info(path), header_only)
+
+    def test_info_files_fail(self):
+        """An error on one of the files is raised with its path"""
+        path = "non_existing_audio.wav"
+        for header_only in [False, True]:
+            with self.assertRaisesRegex(RuntimeError, path):
+                sox_io_backend.info_files(self.paths + [path], header_only=header_only)
+            with self.assertRaisesRegex(RuntimeError, path):
+                sox_io_backend.info_files(
+                    self.paths + [path], header_only=header_only, cache_path=self.get_temp_path('cache.json'))
+
+
 class FileObjTestBase(TempDirMixin):
     def _gen_file(self, ext, dtype, sample_rate, num_channels, num_frames, *, comments=None):
         path = self.get_temp_path(f'test.{ext}')
@@ -1,8 +1,10 @@
+import concurrent.futures
 import io
 import itertools
 import tarfile
 
 from parameterized import parameterized
+import torchaudio
 from torchaudio.backend import sox_io_backend
 from torchaudio._internal import module_utils as _mod_utils
 
@@ -271,6 +273,20 @@ class TestLoadParams(TempDirMixin, PytorchTestCase):
         frame_end = None if num_frames == -1 else frame_offset + num_frames
         self.assertEqual(found, self.original[:, frame_offset:frame_end])
 
+    @parameterized.expand(list(itertools.product(
+        ['flac', 'mp3', 'vorbis'],
+        [1, 1000, 10000],
+        [-1, 1, 1000],
+    )), name_func=name_func)
+    def test_frame_compressed(self, ext, frame_offset, num_frames):
+        """num_frames and frame_offset give the same region as slicing the whole data"""
+        path = self.get_temp_path(f'test.{ext}')
+        sox_utils.convert_audio_file(self.path, path, bit_depth=16 if ext == 'flac' else None)
+        expected, _ = sox_io_backend.load(path)
+        found, _ = sox_io_backend.load(path, frame_offset, num_frames)
+        frame_end = None if num_frames == -1 else frame_offset + num_frames
+        self.assertEqual(found, expected[:, frame_offset:frame_end])
+
     @parameterized.expand([(True, ), (False, )], name_func=name_func)
     def test_channels_first(self, channels_first):
         """channels_first swaps axes"""
@@ -279,6 +295,236 @@ class TestLoadParams(TempDirMixin, PytorchTestCase):
         self.assertEqual(found, expected)
 
 
+@skipIfNoSox
+class TestLoadWavMmap(TempDirMixin, PytorchTestCase):
+    """Test WAV files, which are read from a memory map of the file"""
+    @parameterized.expand(list(itertools.product(
+        ['float32', 'int32', 'int16', 'uint8'],
+        [1, 2],
+        [False, True],
+    )), name_func=name_func)
+    def test_modify_in_place(self, dtype, num_channels, normalize):
+        """Modifying the loaded Tensor does not modify the file"""
+        path = self.get_temp_path('test.wav')
+        data = get_wav_data(dtype, num_channels, normalize=False)
+        save_wav(path, data, 8000)
+        expected, _ = sox_io_backend.load(path, normalize=normalize, channels_first=False)
+        found, _ = sox_io_backend.load(path, normalize=normalize, channels_first=False)
+        found.zero_()
+        found, _ = sox_io_backend.load(path, normalize=normalize, channels_first=False)
+        self.assertEqual(found, expected)
+
+    @parameterized.expand(list(itertools.product(
+        ['float32', 'int32', 'int16'],
+        [0, 1, 3],
+        [False, True],
+    )), name_func=name_func)
+    def test_frame_offset(self, dtype, frame_offset, channels_first):
+        """Samples not aligned in the file are loaded correctly"""
+        path = self.get_temp_path('test.wav')
+        data = get_wav_data(dtype, 3, normalize=False)
+        save_wav(path, data, 8000)
+        expected = load_wav(path, normalize=False, channels_first=channels_first)[0]
+        found, _ = sox_io_backend.load(
+            path, frame_offset=frame_offset, normalize=False, channels_first=channels_first)
+        self.assertEqual(found, expected[:, frame_offset:] if channels_first else expected[frame_offset:])
+
+    @parameterized.expand([(False, ), (True, )], name_func=name_func)
+    def test_float_clip(self, normalize):
+        """Floating point samples are clipped and rounded in the same way as libsox"""
+        path = self.get_temp_path('test.wav')
+        data = 4 * get_wav_data('float32', 2, normalize=False)
+        save_wav(path, data, 8000)
+        with open(path, 'rb') as fileobj:
+            expected, _ = sox_io_backend.load(fileobj, normalize=normalize)
+        found, _ = sox_io_backend.load(path, normalize=normalize)
+        self.assertEqual(found, expected, atol=0, rtol=0)
+        self.assertEqual(found, data.clamp(-1, 1))
+
+    @parameterized.expand(list(itertools.product(
+        ['float32', 'int32', 'int16', 'uint8'],
+        [1, 5],
+    )), name_func=name_func)
+    def test_truncated(self, dtype, num_bytes):
+        """A file shorter than its data chunk is loaded up to the last complete frame"""
+        path = self.get_temp_path('test.wav')
+        data = get_wav_data(dtype, 2, normalize=False)
+        save_wav(path, data, 8000)
+        with open(path, 'rb') as fileobj:
+            content = fileobj.read()
+        with open(path, 'wb') as fileobj:
+            fileobj.write(content[:-num_bytes])
+        num_frames = data.size(1) - (num_bytes + 2 * data.element_size() - 1) // (2 * data.element_size())
+        found, _ = sox_io_backend.load(path, normalize=False)
+        self.assertEqual(found, data[:, :num_frames])
+
+
+@skipIfNoSox
+class TestLoadFiles(TempDirMixin, PytorchTestCase):
+    """Test `sox_io_backend.load_files` and `sox_io_backend.load_batch`"""
+    paths = None
+
+    def setUp(self):
+        super().setUp()
+        self.paths = []
+        for i, duration in enumerate([0.5, 1, 0.25, 2, 1.5]):
+            path = self.get_temp_path(f'{i}.wav')
+            save_wav(path, get_wav_data('int16', 2, num_frames=int(8000 * duration), normalize=False), 8000)
+            self.paths.append(path)
+
+    @parameterized.expand(list(itertools.product(
+        [None, [0, 10, 100, 1000, 0]],
+        [None, [-1, 100, 1000, 10, 1]],
+        [False, True],
+    )), name_func=name_func)
+    def test_load_files(self, frame_offsets, num_frames, channels_first):
+        """`load_files` returns the same as `load` on each file"""
+        found, sample_rates = sox_io_backend.load_files(
+            self.paths, frame_offsets, num_frames, normalize=False, channels_first=channels_first)
+        assert len(found) == len(self.paths)
+        for i, path in enumerate(self.paths):
+            expected, sample_rate = sox_io_backend.load(
+                path,
+                frame_offsets[i] if frame_offsets else 0,
+                num_frames[i] if num_frames else -1,
+                normalize=False,
+                channels_first=channels_first)
+            assert sample_rates[i] == sample_rate
+            self.assertEqual(found[i], expected)
+
+    @parameterized.expand([(True, ), (False, )], name_func=name_func)
+    def test_load_batch(self, channels_first):
+        """`load_batch` pads the waveforms to the longest one"""
+        batch, lengths, sample_rate = sox_io_backend.load_batch(self.paths, channels_first=channels_first)
+        assert sample_rate == 8000
+        time_dim = 1 if channels_first else 0
+        for i, path in enumerate(self.paths):
+            expected, _ = sox_io_backend.load(path, channels_first=channels_first)
+            length = int(lengths[i])
+            assert length == expected.size(time_dim)
+            self.assertEqual(batch[i].narrow(time_dim, 0, length), expected)
+            padding = batch[i].narrow(time_dim, length, batch.size(time_dim + 1) - length)
+            assert (padding == 0).all()
+
+    @parameterized.expand(list(itertools.product(
+        [None, 1, 2],
+        [None, 64, 1000],
+    )), name_func=name_func)
+    def test_load_files_options(self, num_threads, buffer_size):
+        """`load_files` returns the same regardless of the number of threads and the buffer size"""
+        paths = []
+        for i, path in enumerate(self.paths):
+            paths.append(self.get_temp_path(f'{i}.flac'))
+            sox_utils.convert_audio_file(path, paths[-1])
+        found, _ = sox_io_backend.load_files(paths, num_threads=num_threads, buffer_size=buffer_size)
+        for i, path in enumerate(paths):
+            expected, _ = sox_io_backend.load(path)
+            self.assertEqual(found[i], expected)
+
+    def test_load_files_fail(self):
+        """An error on one of the files is raised with its path"""
+        path = "non_existing_audio.wav"
+        with self.assertRaisesRegex(RuntimeError, path):
+            sox_io_backend.load_files(self.paths + [path])
+
+
+@skipIfNoExec('sox')
+@skipIfNoSox
+class TestLoadTar(TempDirMixin, PytorchTestCase):
+    @parameterized.expand([
+        (tarfile.USTAR_FORMAT, ),
+        (tarfile.GNU_FORMAT, ),
+        (tarfile.PAX_FORMAT, ),
+    ], name_func=name_func)
+    def test_load_tar(self, tar_format):
+        """load_tar yields the audio members with their keys, skipping the other members"""
+        members = []
+        for i, ext in enumerate(['wav', 'flac', 'mp3']):
+            wav = self.get_temp_path(f'{i}.orig.wav')
+            save_wav(wav, get_wav_data('int16', 2, num_frames=8000 * (i + 1), normalize=False), 8000)
+            path = self.get_temp_path(f'{i}.{ext}')
+            sox_utils.convert_audio_file(wav, path)
+            members.append((f'sample{i}/' + 'x' * 120 + f'{i}.audio.{ext}', path))
+        text = self.get_temp_path('text.txt')
+        with open(text, 'w') as f:
+            f.write('hello')
+
+        archive = self.get_temp_path('shard.tar')
+        with tarfile.open(archive, 'w', format=tar_format) as tar:
+            for name, path in members:
+                if tar_format == tarfile.USTAR_FORMAT:
+                    name = name.replace('x' * 120, 'x' * 10)
+                tar.add(path, arcname=name)
+                tar.add(text, arcname=name.split('.')[0] + '.txt')
+
+        found = list(sox_io_backend.load_tar(archive))
+        assert len(found) == len(members)
+        for (key, waveform, sample_rate), (name, path) in zip(found, members):
+            if tar_format == tarfile.USTAR_FORMAT:
+                name = name.replace('x' * 120, 'x' * 10)
+            assert key == name.split('.')[0]
+            expected, expected_sample_rate = sox_io_backend.load(path)
+            assert sample_rate == expected_sample_rate
+            self.assertEqual(waveform, expected)
+
+    def test_load_tar_invalid(self):
+        """A corrupted header is reported with the archive path"""
+        archive = self.get_temp_path('broken.tar')
+        with open(archive, 'wb') as f:
+            f.write(b'not a tar archive'.ljust(1024, b'x'))
+        with self.assertRaisesRegex(RuntimeError, 'invalid header'):
+            list(sox_io_backend.load_tar(archive))
+
+
+@skipIfNoExec('sox')
+@skipIfNoSox
+class TestDecodeWithoutEffects(TempDirMixin, PytorchTestCase):
+    """Loads without trim skip the effects chain, and give the same result as the chain"""
+    @parameterized.expand(list(itertools.product(
+        ['flac', 'mp3'],
+        [0, 1000],
+        [-1, 1, 1000],
+        [False, True],
+    )), name_func=name_func)
+    def test_decode(self, ext, frame_offset, num_frames, channels_first):
+        src = self.get_temp_path('original.wav')
+        path = self.get_temp_path(f'test.{ext}')
+        save_wav(src, get_wav_data('int16', 2, num_frames=8000, normalize=False), 8000)
+        sox_utils.convert_audio_file(src, path)
+
+        effects = []
+        if frame_offset or num_frames > 0:
+            effects = [['trim', f'{frame_offset}s'] + ([f'+{num_frames}s'] if num_frames > 0 else [])]
+        expected, _ = torchaudio.sox_effects.apply_effects_file(
+            path, effects, normalize=False, channels_first=channels_first)
+        for buffer_size in [None, 7]:
+            found, _ = sox_io_backend.load_files(
+                [path], [frame_offset], [num_frames], normalize=False, channels_first=channels_first,
+                buffer_size=buffer_size)
+            self.assertEqual(found[0], expected)
+
+    @parameterized.expand([(-1, ), (2 ** 40, )], name_func=name_func)
+    def test_decode_bogus_length(self, num_frames):
+        """The output is not allocated with a length larger than the file"""
+        src = self.get_temp_path('original.wav')
+        path = self.get_temp_path('test.wav')
+        save_wav(src, get_wav_data('int16', 2, num_frames=8000, normalize=False), 8000)
+        # u-law is not read from the memory map, but decoded by libsox.
+        sox_utils.convert_audio_file(src, path, encoding='u-law')
+        expected, _ = sox_io_backend.load(path, normalize=False)
+
+        # Claim about 2^31 bytes of data in the header.
+        with open(path, 'rb') as fileobj:
+            content = bytearray(fileobj.read())
+        pos = content.index(b'data')
+        content[4:8] = (0x7FFFFFF0).to_bytes(4, 'little')
+        content[pos + 4:pos + 8] = (0x7FFFFF00).to_bytes(4, 'little')
+        with open(path, 'wb') as fileobj:
+            fileobj.write(content)
+        found, _ = sox_io_backend.load(path, num_frames=num_frames, normalize=False)
+        self.assertEqual(found, expected)
+
+
 @skipIfNoSox
 class TestLoadWithoutExtension(PytorchTestCase):
     def test_mp3(self):
@@ -309,6 +555,17 @@ class CloggedFileObj:
         return ret
 
 
+class CloggedReadIntoFileObj:
+    """File-like object which only has `readinto` method and fills 2 bytes at a time"""
+    def __init__(self, fileobj):
+        self.fileobj = fileobj
+
+    def readinto(self, buffer):
+        data = self.fileobj.read(min(len(buffer), 2))
+        buffer[:len(data)] = data
+        return len(data)
+
+
 @skipIfNoSox
 @skipIfNoExec('sox')
 class TestFileObject(TempDirMixin, PytorchTestCase):
@@ -373,6 +630,35 @@ class TestFileObject(TempDirMixin, PytorchTestCase):
         assert sr == sample_rate
         self.assertEqual(expected, found)
 
+    @parameterized.expand([
+        ('wav', None),
+        ('mp3', 128),
+        ('flac', 8),
+        ('vorbis', 10),
+    ])
+    def test_bytesio_threads(self, ext, compression):
+        """Loading audio via BytesIO objects from multiple threads returns the same result as via file path."""
+        sample_rate = 16000
+        format_ = ext if ext in ['mp3'] else None
+        path = self.get_temp_path(f'test.{ext}')
+
+        sox_utils.gen_audio_file(
+            path, sample_rate, num_channels=2,
+            compression=compression)
+        expected, _ = sox_io_backend.load(path)
+
+        with open(path, 'rb') as file_:
+            data = file_.read()
+
+        def _load(_):
+            return sox_io_backend.load(io.BytesIO(data), format=format_)
+
+        with concurrent.futures.ThreadPoolExecutor(max_workers=4) as executor:
+            results = list(executor.map(_load, range(8)))
+        for found, sr in results:
+            assert sr == sample_rate
+            self.assertEqual(expected, found)
+
     @parameterized.expand([
         ('wav', None),
         ('mp3', 128),
@@ -405,6 +691,38 @@ class TestFileObject(TempDirMixin, PytorchTestCase):
         assert sr == sample_rate
         self.assertEqual(expected, found)
 
+    @parameterized.expand([
+        ('wav', None),
+        ('mp3', 128),
+        ('mp3', 320),
+        ('flac', 0),
+        ('flac', 5),
+        ('flac', 8),
+        ('vorbis', -1),
+        ('vorbis', 10),
+        ('amb', None),
+    ])
+    def test_bytesio_clogged_readinto(self, ext, compression):
+        """Loading audio via clogged file object with `readinto` returns the same result as via file path.
+
+        This test case validates the case where fileobject fills shorter bytes than requeted.
+        """
+        sample_rate = 16000
+        format_ = ext if ext in ['mp3'] else None
+        path = self.get_temp_path(f'test.{ext}')
+
+        sox_utils.gen_audio_file(
+            path, sample_rate, num_channels=2,
+            compression=compression)
+        expected, _ = sox_io_backend.load(path)
+
+        with open(path, 'rb') as file_:
+            fileobj = CloggedReadIntoFileObj(io.BytesIO(file_.read()))
+        found, sr = sox_io_backend.load(fileobj, format=format_)
+
+        assert sr == sample_rate
+        self.assertEqual(expected, found)
+
     @parameterized.expand([
         ('wav', None),
         ('mp3', 128),
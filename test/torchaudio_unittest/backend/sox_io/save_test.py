@@ -400,3 +400,48 @@ class TestSaveNonExistingDirectory(PytorchTestCase):
         path = os.path.join("non_existing_directory", "foo.wav")
         with self.assertRaisesRegex(RuntimeError, "^Error saving audio file: failed to open file {0}$".format(path)):
             sox_io_backend.save(path, torch.zeros(1, 1), 8000)
+
+
+@skipIfNoSox
+class TestAudioWriter(TempDirMixin, PytorchTestCase):
+    @parameterized.expand([
+        ('wav', 'int16'),
+        ('flac', 'int32'),
+        ('flac', 'float32'),
+    ], name_func=name_func)
+    def test_save(self, format, dtype):
+        """AudioWriter produces the same files as save"""
+        writer = sox_io_backend.AudioWriter(num_threads=2)
+        data = [get_wav_data(dtype, 2, normalize=False, num_frames=8000 * (i + 1)) for i in range(4)]
+        futures = [
+            writer.save(self.get_temp_path(f'{i}.writer.{format}'), d, 8000)
+            for i, d in enumerate(data)]
+        torch.futures.wait_all(futures)
+        for i, d in enumerate(data):
+            path = self.get_temp_path(f'{i}.{format}')
+            sox_io_backend.save(path, d, 8000)
+            expected = sox_io_backend.load(path)[0]
+            found = sox_io_backend.load(self.get_temp_path(f'{i}.writer.{format}'))[0]
+            self.assertEqual(found, expected)
+
+    def test_wait(self):
+        """wait blocks until all the files are written"""
+        writer = sox_io_backend.AudioWriter()
+        data = get_wav_data('int16', 1, normalize=False)
+        futures = [writer.save(self.get_temp_path(f'{i}.wav'), data, 8000) for i in range(3)]
+        writer.wait()
+        assert all(f.done() for f in futures)
+
+    def test_invalid_arguments(self):
+        """Invalid arguments are reported by save"""
+        writer = sox_io_backend.AudioWriter()
+        with self.assertRaisesRegex(RuntimeError, 'gsm format only supports single channel audio.'):
+            writer.save(self.get_temp_path('data.gsm'), torch.zeros(2, 8000), 8000)
+
+    def test_save_fail(self):
+        """Errors raised while writing the file are set to the Future"""
+        writer = sox_io_backend.AudioWriter()
+        path = os.path.join("non_existing_directory", "foo.wav")
+        future = writer.save(path, torch.zeros(1, 1), 8000)
+        with self.assertRaisesRegex(RuntimeError, "Error saving audio file: failed to open file"):
+            future.wait()
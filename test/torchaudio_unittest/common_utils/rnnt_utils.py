@@ -1,5 +1,7 @@
 import unittest
 import random
+from typing import List, Tuple
+
 import torch
 import numpy as np
 from torchaudio.functional import rnnt_loss
@@ -595,6 +597,72 @@ def get_random_data(
     }
 
 
+class GRUPredictor(torch.nn.Module):
+    """Predictor of the RNNT decoders, with a GRU cell whose state is ``[(N, dim)]``"""
+    def __init__(self, num_classes: int, dim: int):
+        super().__init__()
+        self.embedding = torch.nn.Embedding(num_classes, dim)
+        self.cell = torch.nn.GRUCell(dim, dim)
+
+    def forward(self, tokens: torch.Tensor, state: List[torch.Tensor]) -> Tuple[torch.Tensor, List[torch.Tensor]]:
+        hidden = self.cell(self.embedding(tokens), state[0])
+        return hidden, [hidden]
+
+
+class LinearJoiner(torch.nn.Module):
+    def __init__(self, dim: int, num_classes: int):
+        super().__init__()
+        self.linear = torch.nn.Linear(dim, num_classes)
+
+    def forward(self, frames: torch.Tensor, outputs: torch.Tensor) -> torch.Tensor:
+        return self.linear(torch.tanh(frames + outputs))
+
+
+class LastTokenPredictor(torch.nn.Module):
+    """Stateless predictor whose output is the one-hot last token, or zero for blank"""
+    def __init__(self, num_classes: int, blank: int):
+        super().__init__()
+        self.num_classes = num_classes
+        self.blank = blank
+
+    def forward(self, tokens: torch.Tensor, state: List[torch.Tensor]) -> Tuple[torch.Tensor, List[torch.Tensor]]:
+        outputs = torch.nn.functional.one_hot(tokens, self.num_classes).float()
+        return outputs * (tokens != self.blank).unsqueeze(-1), state
+
+
+class PeakedJoiner(torch.nn.Module):
+    """Joiner of one-hot frames whose logits peak at the token of the frame, then at blank once it is emitted"""
+    def __init__(self, blank: int):
+        super().__init__()
+        self.blank = blank
+
+    def forward(self, frames: torch.Tensor, outputs: torch.Tensor) -> torch.Tensor:
+        emitted = frames * outputs
+        logits = 10 * frames - 20 * emitted
+        logits[:, self.blank] += 15 * emitted.sum(-1)
+        return logits
+
+
+def greedy_decode(predictor, joiner, encoder_outputs, state, blank, max_symbols_per_step):
+    """Argmax decoding of one utterance, one symbol at a time"""
+    tokens = []
+    score = 0.
+    with torch.no_grad():
+        outputs, state = predictor(torch.tensor([blank]), state)
+        for t in range(encoder_outputs.size(0)):
+            for s in range(max_symbols_per_step + 1):
+                log_probs = joiner(encoder_outputs[t:t + 1], outputs).log_softmax(-1)[0]
+                token = int(log_probs.argmax())
+                if s == max_symbols_per_step:
+                    token = blank
+                score += float(log_probs[token])
+                if token == blank:
+                    break
+                tokens.append(token)
+                outputs, state = predictor(torch.tensor([token]), state)
+    return tokens, score
+
+
 def skipIfNoRNNT(test_item):
     try:
         torch.ops.torchaudio.rnnt_loss
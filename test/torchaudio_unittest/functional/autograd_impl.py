@@ -79,6 +79,47 @@ class Autograd(TestBaseMixin):
                           [0.7, 0.2, 0.6]])
         self.assert_grad(F.lfilter, (x, a, b))
 
+    def test_lfilter_per_example_coeffs(self):
+        torch.random.manual_seed(2434)
+        x = torch.rand(2, 2, 200) * 2 - 1
+        a = torch.tensor([[[0.7, 0.2, 0.6],
+                           [0.8, 0.2, 0.9]],
+                          [[0.9, 0.1, 0.3],
+                           [0.6, 0.3, 0.2]]])
+        b = torch.tensor([[[0.4, 0.2, 0.9],
+                           [0.7, 0.2, 0.6]],
+                          [[0.5, 0.3, 0.1],
+                           [0.2, 0.8, 0.4]]])
+        self.assert_grad(F.lfilter, (x, a, b))
+
+    def test_lfilter_recompute_output(self):
+        torch.random.manual_seed(2434)
+        x = get_whitenoise(sample_rate=22050, duration=0.01, n_channels=2)
+        a = torch.tensor([0.7, 0.2, 0.6])
+        b = torch.tensor([0.4, 0.2, 0.9])
+        self.assert_grad(partial(F.lfilter, recompute_output=True), (x, a, b))
+
+    def test_lfilter_long_fir(self):
+        torch.random.manual_seed(2434)
+        x = get_whitenoise(sample_rate=8000, duration=0.01, n_channels=2)
+        a = torch.zeros(300)
+        a[0] = 1
+        b = torch.rand(300) / 10
+        x = x.to(dtype=self.dtype, device=self.device).requires_grad_(True)
+        b = b.to(dtype=self.dtype, device=self.device).requires_grad_(True)
+        a = a.to(dtype=self.dtype, device=self.device)
+        assert gradcheck(partial(F.lfilter, clamp=False), (x, a, b))
+
+    def test_sosfilt(self):
+        torch.random.manual_seed(2434)
+        x = get_whitenoise(sample_rate=22050, duration=0.01, n_channels=2)
+        sos = torch.tensor([[0.4, 0.2, 0.9, 0.7, 0.2, 0.6],
+                            [0.7, 0.2, 0.6, 0.8, 0.2, 0.5]])
+        x = x.to(dtype=self.dtype, device=self.device).requires_grad_(True)
+        sos = sos.to(dtype=self.dtype, device=self.device).requires_grad_(True)
+        # The native kernel only supports first-order gradients.
+        assert gradcheck(partial(F.sosfilt, clamp=False), (x, sos))
+
     def test_filtfilt_a(self):
         torch.random.manual_seed(2434)
         x = get_whitenoise(sample_rate=22050, duration=0.01, n_channels=2)
@@ -218,6 +218,39 @@ class TestFunctional(common_utils.TorchaudioTestCase):
         self.assert_batch_consistency(
             F.compute_kaldi_pitch, batch, sample_rate=sample_rate)
 
+    @common_utils.skipIfNoKaldi
+    def test_compute_kaldi_pitch_lengths(self):
+        """Padded batch with lengths matches the items computed one by one"""
+        sample_rate = 16000
+        waveform = common_utils.get_whitenoise(sample_rate=sample_rate, n_channels=3)
+        lengths = torch.tensor([16000, 12000, 8000])
+        result = F.compute_kaldi_pitch(waveform, sample_rate, lengths=lengths)
+        for i, length in enumerate(lengths.tolist()):
+            expected = F.compute_kaldi_pitch(waveform[i, :length], sample_rate)
+            num_frames = expected.size(0)
+            self.assertEqual(result[i, :num_frames], expected)
+            self.assertEqual(result[i, num_frames:], torch.zeros_like(result[i, num_frames:]))
+
+    @common_utils.skipIfNoKaldi
+    def test_compute_kaldi_fbank(self):
+        sample_rate = 16000
+        n_channels = 2
+        waveform = common_utils.get_whitenoise(
+            sample_rate=sample_rate, n_channels=self.batch_size * n_channels) * 32768
+        batch = waveform.view(self.batch_size, n_channels, waveform.size(-1))
+        self.assert_batch_consistency(
+            F.compute_kaldi_fbank, batch, sample_rate=sample_rate)
+
+    @common_utils.skipIfNoKaldi
+    def test_compute_kaldi_mfcc(self):
+        sample_rate = 16000
+        n_channels = 2
+        waveform = common_utils.get_whitenoise(
+            sample_rate=sample_rate, n_channels=self.batch_size * n_channels) * 32768
+        batch = waveform.view(self.batch_size, n_channels, waveform.size(-1))
+        self.assert_batch_consistency(
+            F.compute_kaldi_mfcc, batch, sample_rate=sample_rate)
+
     def test_lfilter(self):
         signal_length = 2048
         torch.manual_seed(2434)
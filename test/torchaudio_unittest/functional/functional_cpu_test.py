@@ -1,9 +1,21 @@
+import os
+import subprocess
+import sys
+
 import torch
 import torchaudio.functional as F
 import unittest
 from parameterized import parameterized
 
-from torchaudio_unittest.common_utils import PytorchTestCase, TorchaudioTestCase, skipIfNoSox
+from torchaudio.functional.filtering import _vad_start_generic
+from torchaudio_unittest.common_utils import (
+    PytorchTestCase,
+    TempDirMixin,
+    TorchaudioTestCase,
+    get_asset_path,
+    load_wav,
+    skipIfNoSox,
+)
 from .functional_impl import Functional, FunctionalCPUOnly
 
 
@@ -21,6 +33,125 @@ class TestFunctionalFloat64(Functional, PytorchTestCase):
     device = torch.device('cpu')
 
 
+_FILTER_SCRIPT = """
+import sys
+import torch
+import torchaudio.functional as F
+
+torch.random.manual_seed(0)
+waveform = torch.rand(3, 5, 1000, dtype=torch.float64) * 2 - 1
+# Orders above 5 go through the interleaved recurrence, and lower ones through the fused kernel.
+a_coeffs = torch.tensor([[1.0, -0.5, 0.2, -0.1, 0.05, -0.02, 0.01]] * 5, dtype=torch.float64)
+b_coeffs = torch.rand(5, 7, dtype=torch.float64)
+outputs = {
+    "interleaved": F.lfilter(waveform, a_coeffs, b_coeffs, clamp=False),
+    "fused": F.lfilter(waveform, a_coeffs[:, :3], b_coeffs[:, :3], clamp=False),
+    "overdrive": F.overdrive(waveform[0], gain=30, colour=40),
+}
+torch.save(outputs, sys.argv[1])
+"""
+
+
+class TestCPUCapability(TempDirMixin, TorchaudioTestCase):
+    @parameterized.expand([("default", ), ("avx2", ), ("avx512", )])
+    def test_filter_kernels(self, capability):
+        """The CPU kernels give the same results whichever instruction set they are compiled for"""
+        # ATEN_CPU_CAPABILITY is read once, so each variant runs in its own process.
+        # It is a cap, so the variants not supported by the CPU fall back to the best supported one.
+        paths = []
+        for env in [None, capability]:
+            path = self.get_temp_path(f"{env}.pt")
+            environ = dict(os.environ)
+            if env is not None:
+                environ["ATEN_CPU_CAPABILITY"] = env
+            subprocess.check_call([sys.executable, "-c", _FILTER_SCRIPT, path], env=environ)
+            paths.append(path)
+        expected, found = [torch.load(path) for path in paths]
+        for key in expected:
+            self.assertEqual(found[key], expected[key], atol=1e-12, rtol=1e-10)
+
+
+class TestLfilterChunks(TorchaudioTestCase):
+    def _filter(self, num_threads, waveform, a_coeffs, b_coeffs):
+        num_threads_ = torch.get_num_threads()
+        torch.set_num_threads(num_threads)
+        try:
+            waveform = waveform.clone().requires_grad_(True)
+            output = F.lfilter(waveform, a_coeffs, b_coeffs, clamp=False)
+            output.backward(torch.linspace(-1, 1, output.size(-1), dtype=output.dtype).expand_as(output))
+            return output.detach(), waveform.grad, F.lfilter(waveform.detach(), a_coeffs, b_coeffs, clamp=False)
+        finally:
+            torch.set_num_threads(num_threads_)
+
+    @parameterized.expand([(2, ), (3, ), (7, )])
+    def test_lfilter_long_rows(self, n_order):
+        """Long rows split along time are filtered as whole rows are, in both directions"""
+        torch.random.manual_seed(0)
+        # With 8 threads, each of the two rows is split into 4 chunks.
+        waveform = torch.rand(2, 1 << 16, dtype=torch.float64) * 2 - 1
+        a_coeffs = torch.tensor([1.0, -0.9, 0.4, -0.1, 0.05, -0.02, 0.01][:n_order], dtype=torch.float64)
+        b_coeffs = torch.rand(n_order, dtype=torch.float64)
+        expected = self._filter(1, waveform, a_coeffs, b_coeffs)
+        found = self._filter(8, waveform, a_coeffs, b_coeffs)
+        for e, f in zip(expected, found):
+            self.assertEqual(f, e, atol=1e-10, rtol=1e-8)
+
+
+_VAD_ARGS = (7.0, 0.25, 1.0, 0.25, 0.0, 0.35, 0.1, 0.01, 1.35, 20.0, None, 0.4, 50.0, 6000.0, 150.0, 2000.0)
+
+
+class TestVad(TorchaudioTestCase):
+    def _load(self, filename):
+        return load_wav(get_asset_path(filename))
+
+    def test_native_matches_generic(self):
+        """The native op trims the recordings where the Python implementation does"""
+        waveform, sample_rate = self._load("vad-go-mono-32000.wav")
+        # Silence in front, and a recording which does not trigger.
+        waveform = torch.stack([
+            torch.nn.functional.pad(waveform, (sample_rate // 2, 0)),
+            torch.nn.functional.pad(waveform * 1e-4, (sample_rate // 2, 0)),
+        ])
+        lengths = torch.tensor([waveform.size(-1), waveform.size(-1) // 2])
+        expected = _vad_start_generic(waveform, lengths, sample_rate, *_VAD_ARGS)
+        found = torch.ops.torchaudio._vad(waveform, lengths, sample_rate, *_VAD_ARGS)
+        self.assertEqual(found, expected)
+
+    @parameterized.expand([("vad-go-mono-32000.wav", ), ("vad-go-stereo-44100.wav", )])
+    def test_vad_start_index(self, filename):
+        """vad_start_index gives where vad trims each recording of a padded batch"""
+        waveform, sample_rate = self._load(filename)
+        lengths = [waveform.size(-1), waveform.size(-1) * 2 // 3, sample_rate // 10]
+        batch = torch.stack([
+            torch.nn.functional.pad(waveform[:, :length], (0, waveform.size(-1) - length)) for length in lengths
+        ])
+        start = F.vad_start_index(batch, sample_rate, lengths=torch.tensor(lengths))
+        for i, length in enumerate(lengths):
+            expected = F.vad(waveform[:, :length], sample_rate)
+            self.assertEqual(batch[i, :, start[i]:length], expected)
+
+    @parameterized.expand([(160, ), (4096, ), (32000, )])
+    def test_online_vad(self, chunk_size):
+        """Feeding the audio chunk by chunk gives the output of vad"""
+        waveform, sample_rate = self._load("vad-go-stereo-44100.wav")
+        waveform = torch.nn.functional.pad(waveform, (sample_rate * 2, 0))
+        detector = F.create_online_vad(sample_rate, num_channels=waveform.size(0))
+        outputs = [detector.accept_waveform(chunk) for chunk in waveform.split(chunk_size, dim=1)]
+        outputs.append(detector.input_finished())
+        assert detector.triggered()
+        self.assertEqual(torch.cat(outputs, dim=1), F.vad(waveform, sample_rate))
+
+    def test_online_vad_not_triggered(self):
+        """Without voice activity, the detector returns the tail that vad returns"""
+        sample_rate = 16000
+        waveform = torch.zeros(1, sample_rate * 3)
+        detector = F.create_online_vad(sample_rate)
+        outputs = [detector.accept_waveform(chunk) for chunk in waveform.split(1000, dim=1)]
+        assert all(output.size(1) == 0 for output in outputs)
+        assert not detector.triggered()
+        self.assertEqual(detector.input_finished(), F.vad(waveform, sample_rate))
+
+
 @skipIfNoSox
 class TestApplyCodec(TorchaudioTestCase):
     backend = "sox_io"
@@ -1,7 +1,11 @@
+import itertools
 import torch
+import torchaudio.functional as F
 import unittest
+from parameterized import parameterized
 
-from torchaudio_unittest.common_utils import PytorchTestCase, skipIfNoCuda
+from torchaudio_unittest.common_utils import PytorchTestCase, skipIfNoCuda, rnnt_utils
+from torchaudio_unittest.common_utils.rnnt_utils import skipIfNoRNNT
 from .functional_impl import Functional
 
 
@@ -19,3 +23,28 @@ class TestFunctionalFloat32(Functional, PytorchTestCase):
 class TestLFilterFloat64(Functional, PytorchTestCase):
     dtype = torch.float64
     device = torch.device('cuda')
+
+
+@skipIfNoCuda
+@skipIfNoRNNT
+class TestRNNTAlphasBetasKernel(PytorchTestCase):
+    """The anti-diagonal and the counter-based alpha/beta kernels compute the same costs"""
+
+    @parameterized.expand(list(itertools.product(
+        ["counters", "diagonal"],
+        [(40, 200), (400, 8)],
+    )))
+    def test_rnnt_loss(self, kernel, shape):
+        max_T, max_U = shape
+        data = rnnt_utils.get_random_data(max_T=max_T, max_U=max_U, device=torch.device("cpu"), seed=0)
+        ref_costs, ref_gradients = rnnt_utils.compute_with_pytorch_transducer(data=data)
+
+        device = torch.device("cuda")
+        logits = data["logits"].detach().to(device).requires_grad_(True)
+        args = [data[key].to(device) for key in ("targets", "logit_lengths", "target_lengths")]
+        costs = F.rnnt_loss(logits, *args, blank=data["blank"], reduction="none", alphas_betas_kernel=kernel)
+        costs.sum().backward()
+        scores = F.rnnt_score(logits.detach(), *args, blank=data["blank"], alphas_betas_kernel=kernel)
+        self.assertEqual(costs.cpu(), ref_costs, atol=1e-4, rtol=1e-4)
+        self.assertEqual(logits.grad.cpu(), ref_gradients, atol=1e-4, rtol=1e-4)
+        self.assertEqual(scores.cpu(), ref_costs, atol=1e-4, rtol=1e-4)
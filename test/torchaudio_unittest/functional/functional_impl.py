@@ -1,20 +1,26 @@
 """Test definition common to CPU and CUDA"""
 import math
 import itertools
+import os
+import tempfile
 import warnings
 
 import numpy as np
 import torch
+import torchaudio.compliance.kaldi
 import torchaudio.functional as F
+from torchaudio.functional import filtering
 from parameterized import parameterized
 from scipy import signal
 
 from torchaudio_unittest.common_utils import (
     TestBaseMixin,
+    get_asset_path,
     get_sinusoid,
     nested_params,
     get_whitenoise,
     rnnt_utils,
+    skipIfNoKaldi,
 )
 
 
@@ -121,6 +127,157 @@ class Functional(TestBaseMixin):
         yhat = F.lfilter(x, a, b, False)
         self.assertEqual(yhat, y, atol=1e-4, rtol=1e-5)
 
+    def test_lfilter_long_fir(self):
+        """lfilter with a long FIR filter, which is convolved through FFT, matches scipy"""
+        torch.random.manual_seed(42)
+        waveform = torch.rand(2, 8000, dtype=self.dtype, device=self.device) * 2 - 1
+        b_coeffs = torch.rand(2000, dtype=self.dtype, device=self.device) * torch.linspace(
+            1, 0, 2000, dtype=self.dtype, device=self.device) ** 4 / 100
+        a_coeffs = torch.zeros(2000, dtype=self.dtype, device=self.device)
+        a_coeffs[0] = 1
+
+        expected = torch.from_numpy(
+            signal.lfilter(b_coeffs.cpu().double().numpy(), a_coeffs.cpu().double().numpy(),
+                           waveform.cpu().double().numpy())).to(dtype=self.dtype, device=self.device)
+        output = F.lfilter(waveform, a_coeffs, b_coeffs, clamp=False)
+        self.assertEqual(output, expected, atol=1e-4, rtol=1e-5)
+
+    def test_lfilter_long_fir_empty(self):
+        """lfilter with a long FIR filter returns an empty Tensor for an empty waveform"""
+        waveform = torch.zeros(2, 0, dtype=self.dtype, device=self.device, requires_grad=True)
+        b_coeffs = torch.rand(300, dtype=self.dtype, device=self.device, requires_grad=True)
+        a_coeffs = torch.zeros(300, dtype=self.dtype, device=self.device)
+        a_coeffs[0] = 1
+
+        output = F.lfilter(waveform, a_coeffs, b_coeffs, clamp=False)
+        assert output.shape == (2, 0)
+        output.sum().backward()
+        self.assertEqual(b_coeffs.grad, torch.zeros_like(b_coeffs))
+        assert waveform.grad.shape == (2, 0)
+
+    @parameterized.expand([(1, ), (3, ), (12, ), (300, )])
+    def test_lfilter_per_example_coeffs(self, n_order):
+        """Filtering with per-example coefficients matches filtering each example separately"""
+        torch.random.manual_seed(42)
+        waveform = torch.rand(4, 2, 600, dtype=self.dtype, device=self.device) * 2 - 1
+        b_coeffs = torch.rand(4, 2, n_order, dtype=self.dtype, device=self.device)
+        a_coeffs = torch.rand(4, 2, n_order, dtype=self.dtype, device=self.device) * 0.1 / n_order
+        a_coeffs[..., 0] = 1.5
+
+        output = F.lfilter(waveform, a_coeffs, b_coeffs, clamp=False)
+        for i in range(4):
+            expected = F.lfilter(waveform[i], a_coeffs[i], b_coeffs[i], clamp=False)
+            self.assertEqual(output[i], expected, atol=1e-5, rtol=1e-5)
+
+    @parameterized.expand([(1, ), (2, ), (5, )])
+    def test_lfilter_stateful_chunks(self, n_order):
+        """Filtering chunk by chunk with the carried state matches filtering the whole signal"""
+        torch.random.manual_seed(42)
+        waveform = torch.rand(2, 3, 400, dtype=self.dtype, device=self.device) * 2 - 1
+        b_coeffs = torch.rand(3, n_order, dtype=self.dtype, device=self.device)
+        a_coeffs = torch.rand(3, n_order, dtype=self.dtype, device=self.device) * 0.1
+        a_coeffs[:, 0] = 1.5
+
+        expected = torch.ops.torchaudio._lfilter(waveform, a_coeffs, b_coeffs)
+
+        state = None
+        outputs = []
+        for chunk in torch.split(waveform, [1, 3, 96, 300], dim=-1):
+            output, state = torch.ops.torchaudio._lfilter_stateful(chunk, a_coeffs, b_coeffs, state)
+            outputs.append(output)
+        self.assertEqual(state.shape, (2, 3, 2 * (n_order - 1)))
+        self.assertEqual(torch.cat(outputs, dim=-1), expected, atol=1e-5, rtol=1e-5)
+
+    def test_profiler_ranges(self):
+        """The stages of lfilter and rnnt_loss are recorded by the profiler"""
+        waveform = torch.rand(2, 3, 100, dtype=self.dtype, device=self.device, requires_grad=True)
+        a_coeffs = torch.tensor([[1.0, -0.5]] * 3, dtype=self.dtype, device=self.device)
+        b_coeffs = torch.tensor([[0.5, 0.5]] * 3, dtype=self.dtype, device=self.device)
+        data = rnnt_utils.get_random_data(dtype=torch.float32, device=self.device, seed=123)
+        with torch.autograd.profiler.profile(record_shapes=True) as prof:
+            torch.ops.torchaudio._lfilter(waveform, a_coeffs, b_coeffs)
+            rnnt_utils.compute_with_pytorch_transducer(data=data)
+        names = {event.name for event in prof.function_events}
+        for name in [
+                "torchaudio::lfilter::fir",
+                "torchaudio::lfilter::iir",
+                "torchaudio::rnnt::alphas_betas",
+                "torchaudio::rnnt::gradients",
+        ]:
+            self.assertIn(name, names)
+
+    def test_sosfilt(self):
+        """sosfilt matches scipy's implementation and cascaded lfilter"""
+        torch.random.manual_seed(42)
+        waveform = torch.rand(2, 3, 1024, dtype=self.dtype, device=self.device) * 2 - 1
+        sos_np = signal.butter(6, 850, 'hp', fs=22050, output='sos')
+        sos = torch.from_numpy(sos_np).to(dtype=self.dtype, device=self.device)
+
+        expected = torch.from_numpy(
+            signal.sosfilt(sos_np, waveform.cpu().double().numpy())).to(dtype=self.dtype, device=self.device)
+        output = F.sosfilt(waveform, sos, clamp=False)
+        self.assertEqual(output, expected, atol=1e-4, rtol=1e-5)
+
+        cascaded = waveform
+        for section in sos:
+            cascaded = F.lfilter(cascaded, section[3:], section[:3], clamp=False)
+        self.assertEqual(output, cascaded, atol=1e-4, rtol=1e-5)
+
+    def test_overdrive_core_loop(self):
+        """The native overdrive loop matches the python implementation and carries its state"""
+        torch.random.manual_seed(42)
+        waveform = torch.rand(11, 300, dtype=self.dtype, device=self.device) * 2 - 1
+        temp = torch.rand(11, 300, dtype=self.dtype, device=self.device) * 2 - 1
+
+        last_in = torch.zeros(11, dtype=self.dtype, device=self.device)
+        last_out = torch.zeros(11, dtype=self.dtype, device=self.device)
+        expected = torch.zeros_like(waveform)
+        filtering._overdrive_core_loop_generic(waveform, temp, last_in, last_out, expected)
+
+        last_in = torch.zeros(11, dtype=self.dtype, device=self.device)
+        last_out = torch.zeros(11, dtype=self.dtype, device=self.device)
+        outputs = []
+        for wave, t in zip(torch.split(waveform, [100, 200], dim=-1), torch.split(temp, [100, 200], dim=-1)):
+            output = torch.zeros_like(wave)
+            torch.ops.torchaudio._overdrive_core_loop(
+                wave.contiguous(), t.contiguous(), last_in, last_out, output)
+            outputs.append(output)
+        self.assertEqual(torch.cat(outputs, dim=-1), expected, atol=1e-5, rtol=1e-5)
+
+    @parameterized.expand([(1, ), (11, )])
+    def test_phaser_core_loop(self, n_channels):
+        """The native phaser loop matches the python implementation"""
+        torch.random.manual_seed(42)
+        waveform = torch.rand(n_channels, 500, dtype=self.dtype, device=self.device) * 2 - 1
+        mod_table = torch.randint(1, 7, (13, ), dtype=torch.int32, device=self.device)
+
+        delay_buf = torch.zeros(n_channels, 7, dtype=self.dtype, device=self.device)
+        expected = torch.zeros_like(waveform)
+        filtering._phaser_core_loop_generic(waveform, mod_table, delay_buf, expected, 0.4)
+
+        state = torch.zeros(n_channels, 7, dtype=self.dtype, device=self.device)
+        output = torch.zeros_like(waveform)
+        torch.ops.torchaudio._phaser_core_loop(waveform, mod_table, state, output, 0.4)
+        self.assertEqual(output, expected, atol=1e-5, rtol=1e-5)
+        self.assertEqual(state, delay_buf, atol=1e-5, rtol=1e-5)
+
+    @parameterized.expand(list(itertools.product([1, 11], [False, True])))
+    def test_flanger_core_loop(self, n_channels, quadratic):
+        """The native flanger loop matches the python implementation"""
+        torch.random.manual_seed(42)
+        waveform = torch.rand(n_channels, 500, dtype=self.dtype, device=self.device) * 2 - 1
+        delay = torch.rand(n_channels, 500, dtype=self.dtype, device=self.device) * 7
+
+        state = torch.zeros(n_channels, 10, dtype=self.dtype, device=self.device)
+        expected = torch.zeros_like(waveform)
+        filtering._flanger_core_loop_generic(waveform, delay, state, expected, 0.6, 0.3, -0.4, quadratic)
+
+        native_state = torch.zeros(n_channels, 10, dtype=self.dtype, device=self.device)
+        output = torch.zeros_like(waveform)
+        torch.ops.torchaudio._flanger_core_loop(waveform, delay, native_state, output, 0.6, 0.3, -0.4, quadratic)
+        self.assertEqual(output, expected, atol=1e-5, rtol=1e-5)
+        self.assertEqual(native_state, state, atol=1e-5, rtol=1e-5)
+
     def test_filtfilt_simple(self):
         """
         Check that, for an arbitrary signal, applying filtfilt with filter coefficients
@@ -458,6 +615,25 @@ class Functional(TestBaseMixin):
             F.resample(waveform, sample_rate, 5512.5)
         assert len(w) == 1
 
+    @nested_params(
+        [(44100, 16000), (16000, 44100), (8000, 16000), (48000, 8000), (3, 2)],
+        ["sinc_interpolation", "kaiser_window"],
+    )
+    def test_resample_native(self, freqs, resampling_method):
+        """The native implementation matches the convolution with the full kernel"""
+        orig_freq, new_freq = freqs
+        waveform = get_whitenoise(sample_rate=orig_freq, duration=0.5, n_channels=3).to(self.device, self.dtype)
+        waveform = waveform.reshape(1, 3, -1)
+
+        gcd = math.gcd(orig_freq, new_freq)
+        kernel, width = F.functional._get_sinc_resample_kernel(
+            orig_freq, new_freq, gcd, 6, 0.99, resampling_method, None, self.device, torch.float64)
+        expected = F.functional._apply_sinc_resample_kernel(
+            waveform.to(torch.float64), orig_freq, new_freq, gcd, kernel, width).to(self.dtype)
+        for _ in range(2):
+            found = F.resample(waveform, orig_freq, new_freq, resampling_method=resampling_method)
+            self.assertEqual(found, expected, atol=1e-5, rtol=1e-5)
+
     @nested_params(
         [0.5, 1.01, 1.3],
         [True, False],
@@ -582,6 +758,181 @@ class Functional(TestBaseMixin):
                 data=data, ref_costs=ref_costs, ref_gradients=ref_gradients
             )
 
+    def test_rnnt_loss_reuse_logits_for_grads(self):
+        """rnnt_loss writing the gradients over the logits gives the same costs and gradients"""
+        data = rnnt_utils.get_random_data(dtype=torch.float32, device=self.device, seed=7)
+        ref_costs, ref_gradients = rnnt_utils.compute_with_pytorch_transducer(data=data)
+        leaf = data["logits"].detach().clone().requires_grad_(True)
+        logits = leaf.clone()
+        costs = F.rnnt_loss(
+            logits, data["targets"], data["logit_lengths"], data["target_lengths"],
+            blank=data["blank"], reduction="none", reuse_logits_for_grads=True)
+        costs.sum().backward()
+        self.assertEqual(costs.cpu(), ref_costs, atol=1e-6, rtol=1e-2)
+        self.assertEqual(leaf.grad.cpu(), ref_gradients, atol=1e-6, rtol=1e-2)
+        self.assertEqual(logits.detach().cpu(), ref_gradients, atol=1e-6, rtol=1e-2)
+
+    @parameterized.expand([(False, ), (True, )])
+    def test_rnnt_loss_packed(self, reuse_logits_for_grads):
+        """rnnt_loss on packed logits matches rnnt_loss on padded logits"""
+        data = rnnt_utils.get_random_data(dtype=torch.float32, device=self.device, seed=11)
+        ref_costs, ref_gradients = rnnt_utils.compute_with_pytorch_transducer(data=data)
+        lengths = list(zip(data["logit_lengths"].tolist(), (data["target_lengths"] + 1).tolist()))
+
+        def pack(padded):
+            return torch.cat([padded[b, :T, :U].reshape(-1, padded.shape[-1]) for b, (T, U) in enumerate(lengths)])
+
+        leaf = pack(data["logits"].detach()).requires_grad_(True)
+        logits = leaf.clone()
+        costs = F.rnnt_loss(
+            logits, data["targets"], data["logit_lengths"], data["target_lengths"],
+            blank=data["blank"], reduction="none", reuse_logits_for_grads=reuse_logits_for_grads)
+        costs.sum().backward()
+        self.assertEqual(costs.cpu(), ref_costs, atol=1e-6, rtol=1e-2)
+        self.assertEqual(leaf.grad.cpu(), pack(ref_gradients), atol=1e-6, rtol=1e-2)
+
+    def test_rnnt_loss_without_length_checks(self):
+        """rnnt_loss gives the same results when the lengths are not checked on the host"""
+        data = rnnt_utils.get_random_data(dtype=torch.float32, device=self.device, seed=5)
+        ref_costs, ref_gradients = rnnt_utils.compute_with_pytorch_transducer(data=data)
+        logits = data["logits"].detach().clone().requires_grad_(True)
+        costs = F.rnnt_loss(
+            logits, data["targets"], data["logit_lengths"], data["target_lengths"],
+            blank=data["blank"], reduction="none", check_lengths=False)
+        costs.sum().backward()
+        self.assertEqual(costs.cpu(), ref_costs)
+        self.assertEqual(logits.grad.cpu(), ref_gradients)
+
+    def test_rnnt_loss_alphas_betas_kernel(self):
+        """rnnt_loss and rnnt_score give the same results with both kernels, and reject other kernels"""
+        data = rnnt_utils.get_random_data(dtype=torch.float32, device=self.device, seed=7)
+        ref_costs, ref_gradients = rnnt_utils.compute_with_pytorch_transducer(data=data)
+        args = [data["targets"], data["logit_lengths"], data["target_lengths"]]
+        for kernel in ["counters", "diagonal"]:
+            logits = data["logits"].detach().clone().requires_grad_(True)
+            costs = F.rnnt_loss(
+                logits, *args, blank=data["blank"], reduction="none", alphas_betas_kernel=kernel)
+            costs.sum().backward()
+            scores = F.rnnt_score(logits.detach(), *args, blank=data["blank"], alphas_betas_kernel=kernel)
+            self.assertEqual(costs.cpu(), ref_costs)
+            self.assertEqual(logits.grad.cpu(), ref_gradients)
+            self.assertEqual(scores.cpu(), ref_costs)
+
+        with self.assertRaisesRegex(RuntimeError, "alphas_betas_kernel must be one of"):
+            F.rnnt_loss(data["logits"].detach(), *args, blank=data["blank"], alphas_betas_kernel="auto")
+        with self.assertRaisesRegex(RuntimeError, "alphas_betas_kernel must be one of"):
+            F.rnnt_score(data["logits"].detach(), *args, blank=data["blank"], alphas_betas_kernel="auto")
+
+    def test_rnnt_loss_cached_workspace(self):
+        """rnnt_loss gives the same results on reused and on released workspaces of other sizes"""
+        small = rnnt_utils.get_B2_T4_U3_D3_data(dtype=torch.float32, device=self.device)[0]
+        large = rnnt_utils.get_random_data(dtype=torch.float32, device=self.device, seed=3)
+
+        def compute(data):
+            logits = data["logits"].detach().clone().requires_grad_(True)
+            costs = F.rnnt_loss(
+                logits, data["targets"], data["logit_lengths"], data["target_lengths"],
+                blank=data["blank"], reduction="none")
+            costs.sum().backward()
+            return costs.detach(), logits.grad
+
+        F.rnnt_loss_release_workspace()
+        ref_small, ref_large = compute(small), compute(large)
+        for data, ref in [(small, ref_small), (large, ref_large), (small, ref_small)]:
+            self.assertEqual(compute(data), ref)
+        F.rnnt_loss_release_workspace()
+        self.assertEqual(compute(large), ref_large)
+
+    def test_rnnt_score(self):
+        """rnnt_score of each hypothesis matches the costs of rnnt_loss"""
+        data = rnnt_utils.get_random_data(dtype=torch.float32, device=self.device, seed=13)
+        ref_costs, _ = rnnt_utils.compute_with_pytorch_transducer(data=data)
+        logits = data["logits"].detach()
+        costs = F.rnnt_score(
+            logits, data["targets"], data["logit_lengths"], data["target_lengths"], blank=data["blank"])
+        self.assertEqual(costs.cpu(), ref_costs)
+
+        # Two hypotheses per sequence, here copies of its target.
+        costs = F.rnnt_score(
+            logits.repeat_interleave(2, 0), data["targets"].repeat_interleave(2, 0), data["logit_lengths"],
+            data["target_lengths"].repeat_interleave(2, 0), blank=data["blank"])
+        self.assertEqual(costs.cpu(), ref_costs.repeat_interleave(2, 0))
+
+    def test_rnnt_loss_pruned_full_range(self):
+        """rnnt_loss_pruned with bands covering all the targets matches rnnt_loss"""
+        data = rnnt_utils.get_random_data(dtype=torch.float32, device=self.device, seed=99)
+        ref_costs, ref_gradients = rnnt_utils.compute_with_pytorch_transducer(data=data)
+        logits = data["logits"].detach().clone().requires_grad_(True)
+        ranges = torch.zeros(logits.shape[:2], dtype=torch.int32, device=self.device)
+        costs = F.rnnt_loss_pruned(
+            logits, data["targets"], data["logit_lengths"], data["target_lengths"], ranges,
+            blank=data["blank"], reduction="none")
+        costs.sum().backward()
+        self.assertEqual(costs.cpu(), ref_costs, atol=1e-5, rtol=1e-5)
+        self.assertEqual(logits.grad.cpu(), ref_gradients, atol=1e-5, rtol=1e-5)
+
+    @parameterized.expand([(2, ), (4, )])
+    def test_rnnt_prune_ranges(self, S):
+        """rnnt_prune_ranges starts at 0, ends at the last band of the targets, and the bands overlap"""
+        torch.random.manual_seed(0)
+        B, T, U, D = 4, 30, 10, 8
+        am = torch.randn(B, T, D, device=self.device)
+        lm = torch.randn(B, U + 1, D, device=self.device)
+        targets = torch.randint(1, D, (B, U), dtype=torch.int32, device=self.device)
+        logit_lengths = torch.tensor([T, 25, 20, 12], dtype=torch.int32, device=self.device)
+        target_lengths = torch.tensor([U, 7, U, 3], dtype=torch.int32, device=self.device)
+        for inputs in [(am, lm), (torch.zeros_like(am), torch.zeros_like(lm))]:
+            ranges = F.rnnt_prune_ranges(*inputs, targets, logit_lengths, target_lengths, S, blank=0).cpu()
+            for b in range(B):
+                r = ranges[b, :logit_lengths[b]]
+                steps = r[1:] - r[:-1]
+                assert r[0] == 0
+                assert ((steps >= 0) & (steps <= S - 1)).all()
+                assert r[-1] == target_lengths[b] + 1 - S
+
+    def test_rnnt_loss_pruned_invalid_ranges(self):
+        """rnnt_loss_pruned is infinite with zero gradients for bands out of the targets"""
+        data = rnnt_utils.get_B2_T4_U3_D3_data(torch.float32, self.device)[0]
+        S = 2
+        logits = data["logits"][:, :, :S].detach().contiguous().requires_grad_(True)
+        for value in [-3, 10]:
+            ranges = torch.full(logits.shape[:2], value, dtype=torch.int32, device=self.device)
+            costs = F.rnnt_loss_pruned(
+                logits, data["targets"], data["logit_lengths"], data["target_lengths"], ranges,
+                blank=data["blank"], reduction="none")
+            costs.sum().backward()
+            assert torch.isinf(costs).all()
+            assert (logits.grad == 0).all()
+            logits.grad = None
+
+    def test_rnnt_loss_pruned(self):
+        """rnnt_loss_pruned over the bands of rnnt_prune_ranges is finite and bounds rnnt_loss"""
+        torch.random.manual_seed(0)
+        B, T, U, D, S = 3, 30, 10, 8, 4
+        am = torch.randn(B, T, D, device=self.device)
+        lm = torch.randn(B, U + 1, D, device=self.device)
+        targets = torch.randint(1, D, (B, U), dtype=torch.int32, device=self.device)
+        logit_lengths = torch.tensor([T, 25, 20], dtype=torch.int32, device=self.device)
+        target_lengths = torch.tensor([U, 7, U], dtype=torch.int32, device=self.device)
+
+        ranges = F.rnnt_prune_ranges(am, lm, targets, logit_lengths, target_lengths, S, blank=0)
+        self.assertEqual(ranges.shape, (B, T))
+        assert (ranges[:, 0] == 0).all()
+        steps = ranges[:, 1:] - ranges[:, :-1]
+        assert ((steps >= 0) & (steps < S)).all()
+
+        am_pruned, lm_pruned = F.rnnt_prune(am, lm, ranges, S)
+        logits = (am_pruned + lm_pruned).requires_grad_(True)
+        costs = F.rnnt_loss_pruned(
+            logits, targets, logit_lengths, target_lengths, ranges, blank=0, reduction="none")
+        costs.sum().backward()
+        full_costs = F.rnnt_loss(
+            am[:, :, None] + lm[:, None], targets, logit_lengths, target_lengths, blank=0, reduction="none")
+        # The pruned lattice has a subset of the paths.
+        assert torch.isfinite(costs).all()
+        assert (costs >= full_costs - 1e-4).all()
+        assert torch.isfinite(logits.grad).all()
+
 
 class FunctionalCPUOnly(TestBaseMixin):
     def test_melscale_fbanks_no_warning_high_n_freq(self):
@@ -601,3 +952,216 @@ class FunctionalCPUOnly(TestBaseMixin):
             warnings.simplefilter("always")
             F.melscale_fbanks(201, 0, 8000, 128, 16000)
         assert len(w) == 1
+
+    def test_rnnt_loss_num_threads(self):
+        """rnnt_loss gives the same result regardless of the number of threads"""
+        data = rnnt_utils.get_random_data(dtype=torch.float32, device=self.device, seed=123)
+        costs, gradients = rnnt_utils.compute_with_pytorch_transducer(data=data)
+        num_threads = torch.get_num_threads()
+        try:
+            torch.set_num_threads(1)
+            data["logits"].grad = None
+            ref_costs, ref_gradients = rnnt_utils.compute_with_pytorch_transducer(data=data)
+        finally:
+            torch.set_num_threads(num_threads)
+        self.assertEqual(costs, ref_costs, atol=0, rtol=0)
+        self.assertEqual(gradients, ref_gradients, atol=0, rtol=0)
+
+    def test_rnnt_loss_long_sequences(self):
+        """rnnt_loss matches the numpy reference on sequences long enough for the wavefront recursion"""
+        data = rnnt_utils.get_random_data(
+            max_B=4, max_T=200, max_U=48, dtype=torch.float32, device=self.device, seed=321)
+        ref_costs, ref_gradients = rnnt_utils.compute_with_numpy_transducer(data=data)
+        costs, gradients = rnnt_utils.compute_with_pytorch_transducer(data=data)
+        self.assertEqual(costs, ref_costs, atol=1e-4, rtol=1e-5)
+        self.assertEqual(gradients, ref_gradients, atol=1e-4, rtol=1e-2)
+
+    @skipIfNoKaldi
+    def test_online_kaldi_pitch(self):
+        """Feeding chunks to the online pitch extractor matches compute_kaldi_pitch"""
+        sample_rate = 16000
+        waveform = get_sinusoid(frequency=300, sample_rate=sample_rate, n_channels=1, dtype='float32')[0]
+        expected = F.compute_kaldi_pitch(waveform, sample_rate)
+
+        pitch = F.create_online_kaldi_pitch(sample_rate)
+        for chunk in torch.split(waveform, 320):
+            pitch.accept_waveform(chunk)
+        pitch.input_finished()
+        self.assertEqual(pitch.get_frames(), expected)
+
+        # Frames taken while streaming are returned exactly once
+        pitch = F.create_online_kaldi_pitch(sample_rate, max_frames_latency=20)
+        frames = []
+        for chunk in torch.split(waveform, 320):
+            pitch.accept_waveform(chunk)
+            frames.append(pitch.get_frames())
+        pitch.input_finished()
+        frames.append(pitch.get_frames())
+        self.assertEqual(sum(f.size(0) for f in frames), expected.size(0))
+        self.assertEqual(pitch.num_frames_ready(), expected.size(0))
+
+    @skipIfNoKaldi
+    def test_compute_kaldi_pitch_sinusoid(self):
+        """compute_kaldi_pitch finds the frequency of a pure tone with an NCCF close to one"""
+        sample_rate = 16000
+        waveform = get_sinusoid(frequency=300, sample_rate=sample_rate, n_channels=1, dtype='float32')[0]
+        result = F.compute_kaldi_pitch(waveform, sample_rate)
+        nccf, pitch = result[..., 0], result[..., 1]
+        self.assertGreater(nccf.median().item(), 0.9)
+        self.assertEqual(pitch.median().item(), 300., atol=3., rtol=0)
+
+    @skipIfNoKaldi
+    def test_compute_kaldi_pitch_quiet(self):
+        """compute_kaldi_pitch scales the input to the int16 range, so quiet input has the same pitch"""
+        sample_rate = 16000
+        waveform = get_sinusoid(frequency=300, sample_rate=sample_rate, n_channels=1, dtype='float32')[0]
+        expected = F.compute_kaldi_pitch(waveform, sample_rate)
+        # Without the int16 scaling, the frame energy products of this input
+        # underflow in float and the NCCF collapses to zero.
+        result = F.compute_kaldi_pitch(waveform * 2 ** -44, sample_rate)
+        self.assertEqual(result, expected, atol=1e-4, rtol=1e-4)
+
+    def test_ctc_decoder(self):
+        """The beam search finds the best path of peaked emissions, and the lexicon constrains its words"""
+        tokens = ['-', 'a', 'b', '|']
+        # "ab|bab|" and "ba|" with repetitions and blanks.
+        paths = [[1, 1, 0, 2, 3, 2, 1, 1, 2, 3], [2, 2, 1, 0, 3, 0, 0, 0, 0, 0]]
+        lengths = torch.tensor([10, 5])
+        emissions = torch.full((2, 10, 4), 0.1 / 3)
+        for i, path in enumerate(paths):
+            emissions[i, torch.arange(10), torch.tensor(path)] = 0.9
+        emissions = emissions.log()
+
+        decoder = F.create_ctc_decoder(tokens, word_boundary=3, beam_size=10, nbest=2)
+        hypos = decoder.decode(emissions, lengths)
+        self.assertEqual(hypos[0][0][0], [1, 2, 3, 2, 1, 2, 3])
+        self.assertEqual(hypos[1][0][0], [2, 1, 3])
+        self.assertEqual(len(hypos[0]), 2)
+        self.assertGreater(hypos[0][0][1], hypos[0][1][1])
+
+        # Same result when decoded alone
+        self.assertEqual(decoder.decode(emissions[1:, :5], None), hypos[1:])
+
+        with tempfile.TemporaryDirectory() as temp_dir:
+            lexicon = os.path.join(temp_dir, 'lexicon.txt')
+            with open(lexicon, 'w') as file:
+                file.write('ab a b |\nba b a |\n')
+            decoder = F.create_ctc_decoder(tokens, word_boundary=3, beam_size=10, lexicon=lexicon)
+            hypos = decoder.decode(emissions, lengths)
+        # "bab" is not a word, so the best hypothesis within the lexicon differs.
+        self.assertNotEqual(hypos[0][0][0], [1, 2, 3, 2, 1, 2, 3])
+        self.assertIn(hypos[0][0][0], [[1, 2, 3, 2, 1, 3], [1, 2, 3, 1, 2, 3]])
+        self.assertEqual(hypos[1][0][0], [2, 1, 3])
+
+    def test_ctc_decoder_lm(self):
+        """The language model adds the log probabilities of the words, backing off to the shorter contexts"""
+        tokens = ['-', 'a', 'b', '|']
+        # "a|b|", which only has bigrams, "b|a|", which backs off to the unigrams, and "ab|", which is unknown.
+        paths = [[1, 0, 3, 2, 0, 3], [2, 0, 3, 1, 0, 3], [1, 2, 0, 3, 0, 0]]
+        # log10 probabilities of the words and of the end of the sentence in ctc_decoder_lm.arpa
+        lm_scores = [-0.2 - 0.3 - 0.4, (-0.5 - 0.9) + (-0.2 - 0.7) + (-0.3 - 0.5), (-0.5 - 2.0) + (0. - 0.5)]
+        emissions = torch.full((3, 6, 4), 0.1 / 3)
+        for i, path in enumerate(paths):
+            emissions[i, torch.arange(6), torch.tensor(path)] = 0.9
+        emissions = emissions.log()
+
+        kwargs = {'word_boundary': 3, 'beam_size': 50, 'nbest': 50, 'lm_weight': 1.}
+        hypos = F.create_ctc_decoder(tokens, **kwargs).decode(emissions, None)
+        hypos_lm = F.create_ctc_decoder(tokens, lm=get_asset_path('ctc_decoder_lm.arpa'), **kwargs).decode(
+            emissions, None)
+        for i, lm_score in enumerate(lm_scores):
+            expected = [t for t in paths[i] if t != 0]
+            expected = [t for j, t in enumerate(expected) if j == 0 or t != expected[j - 1]]
+            self.assertEqual(hypos[i][0][0], expected)
+            score = dict((tuple(t), s) for t, s in hypos[i])[tuple(expected)]
+            score_lm = dict((tuple(t), s) for t, s in hypos_lm[i])[tuple(expected)]
+            self.assertEqual(score_lm - score, lm_score * math.log(10), atol=1e-6, rtol=0)
+
+    def _save_rnnt_modules(self, temp_dir, predictor, joiner):
+        paths = [os.path.join(temp_dir, 'predictor.pt'), os.path.join(temp_dir, 'joiner.pt')]
+        torch.jit.save(torch.jit.script(predictor), paths[0])
+        torch.jit.save(torch.jit.script(joiner), paths[1])
+        return paths
+
+    @parameterized.expand([(1, ), (3, )])
+    @rnnt_utils.skipIfNoRNNT
+    def test_rnnt_decoder_greedy(self, max_symbols_per_step):
+        """The RNNT decoder with a beam of 1 matches argmax decoding"""
+        torch.random.manual_seed(0)
+        D, dim, blank = 6, 8, 0
+        predictor = rnnt_utils.GRUPredictor(D, dim).eval()
+        joiner = rnnt_utils.LinearJoiner(dim, D).eval()
+        encoder_outputs = torch.randn(20, dim)
+        state = [torch.zeros(1, dim)]
+        expected, expected_score = rnnt_utils.greedy_decode(
+            predictor, joiner, encoder_outputs, state, blank, max_symbols_per_step)
+
+        with tempfile.TemporaryDirectory() as temp_dir:
+            paths = self._save_rnnt_modules(temp_dir, predictor, joiner)
+            decoder = F.create_rnnt_decoder(
+                *paths, blank, beam_width=1, max_symbols_per_step=max_symbols_per_step)
+            hypos = decoder.search(encoder_outputs, state)
+        self.assertEqual(len(hypos), 1)
+        self.assertEqual(hypos[0][0], expected)
+        self.assertEqual(hypos[0][1], expected_score, atol=1e-4, rtol=1e-4)
+
+    @rnnt_utils.skipIfNoRNNT
+    def test_rnnt_decoder_beam(self):
+        """Time synchronous and alignment-length synchronous searches find the best path of peaked inputs"""
+        torch.random.manual_seed(0)
+        D, T, blank = 5, 30, 0
+        frames = torch.randint(0, D, (T, ))
+        expected = []
+        for token in frames.tolist():
+            if token != blank and (not expected or expected[-1] != token):
+                expected.append(token)
+        encoder_outputs = torch.nn.functional.one_hot(frames, D).float()
+
+        results = []
+        with tempfile.TemporaryDirectory() as temp_dir:
+            paths = self._save_rnnt_modules(
+                temp_dir, rnnt_utils.LastTokenPredictor(D, blank), rnnt_utils.PeakedJoiner(blank))
+            for mode in ["time_synchronous", "alignment_length_synchronous"]:
+                decoder = F.create_rnnt_decoder(*paths, blank, beam_width=4, mode=mode)
+                results.append(decoder.search(encoder_outputs, []))
+        for hypos in results:
+            assert 1 < len(hypos) <= 4
+            self.assertEqual(hypos[0][0], expected)
+            self.assertGreater(hypos[0][1], hypos[1][1])
+        self.assertEqual(results[0][0][1], results[1][0][1], atol=1e-3, rtol=0)
+
+    @parameterized.expand([
+        ({}, ),
+        ({'snip_edges': False, 'use_energy': True}, ),
+        ({'round_to_power_of_two': False, 'window_type': 'hamming', 'htk_compat': True, 'use_energy': True}, ),
+        # 402 (2 * 3 * 67), 403 (13 * 31) and 401 (prime) samples
+        ({'round_to_power_of_two': False, 'frame_length': 25.15625}, ),
+        ({'round_to_power_of_two': False, 'frame_length': 25.21875, 'use_power': False}, ),
+        ({'round_to_power_of_two': False, 'frame_length': 25.09375}, ),
+        ({'raw_energy': False, 'use_power': False, 'subtract_mean': True}, ),
+        ({'use_log_fbank': False}, ),
+        ({'vtln_warp': 0.9, 'num_mel_bins': 40, 'low_freq': 60.0, 'high_freq': -400.0}, ),
+    ])
+    @skipIfNoKaldi
+    def test_compute_kaldi_fbank(self, kwargs):
+        """compute_kaldi_fbank matches torchaudio.compliance.kaldi.fbank"""
+        sample_rate = 16000
+        waveform = get_whitenoise(sample_rate=sample_rate, n_channels=1, scale_factor=0.5) * 32768
+        expected = torchaudio.compliance.kaldi.fbank(waveform, sample_frequency=sample_rate, **kwargs)
+        result = F.compute_kaldi_fbank(waveform[0], sample_rate, **kwargs)
+        self.assertEqual(result, expected, atol=1e-3, rtol=1e-4)
+
+    @parameterized.expand([
+        ({}, ),
+        ({'snip_edges': False, 'use_energy': True}, ),
+        ({'htk_compat': True, 'cepstral_lifter': 0.0, 'window_type': 'hanning'}, ),
+        ({'htk_compat': True, 'use_energy': True, 'subtract_mean': True, 'num_ceps': 23}, ),
+    ])
+    @skipIfNoKaldi
+    def test_compute_kaldi_mfcc(self, kwargs):
+        """compute_kaldi_mfcc matches torchaudio.compliance.kaldi.mfcc"""
+        sample_rate = 16000
+        waveform = get_whitenoise(sample_rate=sample_rate, n_channels=1, scale_factor=0.5) * 32768
+        expected = torchaudio.compliance.kaldi.mfcc(waveform, sample_frequency=sample_rate, **kwargs)
+        result = F.compute_kaldi_mfcc(waveform[0], sample_rate, **kwargs)
+        self.assertEqual(result, expected, atol=1e-3, rtol=1e-4)
@@ -1,9 +1,12 @@
 import io
 import itertools
 from pathlib import Path
+import subprocess
+import sys
 import tarfile
 
 from parameterized import parameterized
+import torch
 from torchaudio import sox_effects
 from torchaudio._internal import module_utils as _mod_utils
 
@@ -38,6 +41,22 @@ class TestSoxEffects(PytorchTestCase):
         for _ in range(3):
             sox_effects.init_sox_effects()
 
+    def test_lazy_init(self):
+        """Effects can be applied without init_sox_effects, and shutdown does not need it"""
+        script = (
+            "import torch, torchaudio\n"
+            "torchaudio.sox_effects.apply_effects_tensor(torch.zeros(1, 8000), 8000, [['gain', '-n']])\n"
+        )
+        subprocess.check_call([sys.executable, "-c", script])
+        # Exceptions raised by the atexit handlers do not change the exit code
+        result = subprocess.run(
+            [sys.executable, "-c", "import torchaudio"], stderr=subprocess.PIPE, check=True)
+        self.assertNotIn(b"atexit", result.stderr)
+
+    def test_effect_names_cached(self):
+        """effect_names returns the same list on every call"""
+        self.assertEqual(sox_effects.effect_names(), sox_effects.effect_names())
+
 
 @skipIfNoSox
 class TestSoxEffectsTensor(TempDirMixin, PytorchTestCase):
@@ -63,6 +82,20 @@ class TestSoxEffectsTensor(TempDirMixin, PytorchTestCase):
         # Returned Tensor should equal to the input Tensor
         self.assertEqual(expected, found)
 
+    @parameterized.expand(list(itertools.product(
+        ['float32', 'int32', 'int16', 'uint8'],
+        [True, False]
+    )), name_func=name_func)
+    def test_apply_no_effect_non_contiguous(self, dtype, channels_first):
+        """`apply_effects_tensor` should read non-contiguous Tensor as is"""
+        original = get_wav_data(dtype, 3, channels_first=not channels_first).t()
+        # Transposed and strided along time
+        waveform = original[:, ::3] if channels_first else original[::3]
+        assert not waveform.is_contiguous()
+
+        found, _ = sox_effects.apply_effects_tensor(waveform, 8000, [], channels_first)
+        self.assertEqual(waveform, found)
+
     @parameterized.expand(
         load_params("sox_effect_test_args.jsonl"),
         name_func=lambda f, i, p: f'{f.__name__}_{i}_{p.args[0]["effects"][0][0]}',
@@ -90,6 +123,66 @@ class TestSoxEffectsTensor(TempDirMixin, PytorchTestCase):
         assert sr == expected_sr
         self.assertEqual(expected, found)
 
+    @parameterized.expand(
+        # dither and synth draw from the global random state of libsox
+        [p for p in load_params("sox_effect_test_args.jsonl")
+         if p.args[0]["effects"][0][0] not in ["dither", "synth"]],
+        name_func=lambda f, i, p: f'{f.__name__}_{i}_{p.args[0]["effects"][0][0]}',
+    )
+    def test_prepare_effects(self, args):
+        """Prepared effects should return identical data as `apply_effects_tensor` on every call"""
+        effects = args['effects']
+        num_channels = args.get("num_channels", 2)
+        input_sr = args.get("input_sample_rate", 8000)
+
+        prepared = sox_effects.prepare_effects(effects, input_sr, num_channels)
+        for duration in [1, 0.5, 2, 1]:
+            original = get_sinusoid(
+                frequency=800, sample_rate=input_sr, duration=duration,
+                n_channels=num_channels, dtype='float32')
+            expected, expected_sr = sox_effects.apply_effects_tensor(original, input_sr, effects)
+            found, sr = prepared.apply(original)
+
+            assert sr == expected_sr
+            assert prepared.get_output_sample_rate() == expected_sr
+            assert prepared.get_output_num_channels() == expected.size(0)
+            self.assertEqual(expected, found)
+
+    @parameterized.expand([(1, ), (63, ), (1000, )], name_func=name_func)
+    def test_prepare_effects_buffer_size(self, buffer_size):
+        """Prepared effects return the same data regardless of the buffer size"""
+        effects = [["rate", "16000"], ["gain", "-3"]]
+        original = get_sinusoid(frequency=800, sample_rate=8000, duration=1, n_channels=2, dtype='float32')
+        expected, _ = sox_effects.apply_effects_tensor(original, 8000, effects)
+        prepared = sox_effects.prepare_effects(effects, 8000, 2, buffer_size=buffer_size)
+        found, _ = prepared.apply(original)
+        self.assertEqual(expected, found)
+
+    @parameterized.expand([
+        ([["sinc", "-a", "50", "1k-3k"]], ),
+        ([["rate", "16000"]], ),
+        ([["sinc", "1k"], ["rate", "4000"]], ),
+        ([["fir", "0.0195", "-0.082", "0.234", "0.891", "-0.145", "0.043"]], ),
+        ([["compand", "0.02,0.05", "-60,-60,-30,-10,-20,-8,-5,-8,-2,-8", "-8", "-7", "0.05"]], ),
+    ], name_func=lambda f, i, p: f'{f.__name__}_{i}_{p.args[0][0][0]}')
+    def test_prepare_effects_repeated(self, effects):
+        """Prepared effects give the same output on every call"""
+        original = get_sinusoid(frequency=800, sample_rate=8000, duration=1, n_channels=2, dtype='float32')
+        expected, expected_sr = sox_effects.apply_effects_tensor(original, 8000, effects)
+        prepared = sox_effects.prepare_effects(effects, 8000, 2)
+        for _ in range(3):
+            found, sr = prepared.apply(original)
+            assert sr == expected_sr
+            self.assertEqual(expected, found)
+
+    def test_prepare_effects_mismatch(self):
+        """Prepared effects reject Tensors of different spec"""
+        prepared = sox_effects.prepare_effects([["gain", "-n"]], 8000, 2, torch.int16)
+        with self.assertRaisesRegex(RuntimeError, "channels"):
+            prepared.apply(get_wav_data('int16', 1))
+        with self.assertRaisesRegex(RuntimeError, "type"):
+            prepared.apply(get_wav_data('float32', 2))
+
 
 @skipIfNoSox
 class TestSoxEffectsFile(TempDirMixin, PytorchTestCase):
@@ -163,6 +256,47 @@ class TestSoxEffectsFile(TempDirMixin, PytorchTestCase):
         self.assertEqual(found, expected)
 
 
+@skipIfNoSox
+class TestStreamEffectsFile(TempDirMixin, PytorchTestCase):
+    """Test suite for `stream_effects_file` function"""
+    @parameterized.expand(list(itertools.product(
+        ['float32', 'int16'],
+        [1, 2],
+        [True, False],
+        [1000, 4000, 100000],
+    )), name_func=name_func)
+    def test_chunks(self, dtype, num_channels, channels_first, frames_per_chunk):
+        """Concatenated chunks match `apply_effects_file`"""
+        path = self.get_temp_path('input.wav')
+        data = get_wav_data(dtype, num_channels, num_frames=20000, channels_first=channels_first)
+        save_wav(path, data, 8000, channels_first=channels_first)
+        effects = [['gain', '-n'], ['rate', '16000']]
+        expected, expected_sr = sox_effects.apply_effects_file(
+            path, effects, normalize=False, channels_first=channels_first)
+
+        chunks, sr = sox_effects.stream_effects_file(
+            path, effects, frames_per_chunk, normalize=False, channels_first=channels_first)
+        chunks = list(chunks)
+        time_dim = 1 if channels_first else 0
+
+        assert sr == expected_sr
+        for chunk in chunks[:-1]:
+            assert chunk.size(time_dim) == frames_per_chunk
+        assert 0 < chunks[-1].size(time_dim) <= frames_per_chunk
+        self.assertEqual(torch.cat(chunks, dim=time_dim), expected)
+
+    def test_early_stop(self):
+        """Deleting the iterator before the end stops the decoding"""
+        path = self.get_temp_path('input.wav')
+        data = get_wav_data('float32', 2, num_frames=80000)
+        save_wav(path, data, 8000)
+        chunks, _ = sox_effects.stream_effects_file(
+            path, [], frames_per_chunk=100, num_buffered_chunks=1)
+        first = next(chunks)
+        del chunks
+        self.assertEqual(first, data[:, :100])
+
+
 @skipIfNoSox
 class TestFileFormats(TempDirMixin, PytorchTestCase):
     """`apply_effects_file` gives the same result as sox on various file formats"""
@@ -1,3 +1,5 @@
+from unittest.mock import patch
+
 import torch
 import torchaudio.transforms as T
 from parameterized import parameterized, param
@@ -83,6 +85,30 @@ class TransformsTestBase(TestBaseMixin):
 
         assert transform.kernel.dtype == dtype if dtype is not None else torch.float32
 
+    @parameterized.expand([
+        param(),
+        param(n_fft=512, win_length=400, hop_length=160, n_mels=80),
+        param(n_fft=400, center=False, power=1.),
+        param(n_fft=400, normalized=True, pad=32, pad_mode="constant"),
+        param(n_fft=256, f_min=100., f_max=4000., n_mels=40, power=3., norm="slaney", mel_scale="slaney"),
+    ])
+    def test_mel_spectrogram_fused(self, **args):
+        """The native mel spectrogram matches the composition of Spectrogram and MelScale"""
+        waveform = get_whitenoise(sample_rate=8000, duration=0.5, n_channels=2, dtype=self.dtype).to(self.device)
+        transform = T.MelSpectrogram(sample_rate=8000, **args).to(device=self.device, dtype=self.dtype)
+        expected = transform.mel_scale(transform.spectrogram(waveform))
+
+        self.assertEqual(transform(waveform), expected, atol=1e-5, rtol=1e-4)
+        self.assertEqual(
+            transform._mel_spectrogram(waveform.unsqueeze(0), 1e-6), torch.log(expected + 1e-6).unsqueeze(0),
+            atol=1e-4, rtol=1e-4)
+
+        # The fallback used when the extension is not available.
+        with patch.object(T, "_mel_spectrogram", T._mel_spectrogram_generic):
+            self.assertEqual(transform(waveform), expected, atol=1e-5, rtol=1e-4)
+            self.assertEqual(
+                transform._mel_spectrogram(waveform, 1e-6), torch.log(expected + 1e-6), atol=1e-4, rtol=1e-4)
+
     @parameterized.expand([
         param(n_fft=300, center=True, onesided=True),
         param(n_fft=400, center=True, onesided=False),
@@ -27,8 +27,50 @@ namespace kaldi {
 template <typename Real>
 MatrixBase<Real>::MatrixBase(torch::Tensor tensor) : tensor_(tensor) {
   assert_matrix_shape<Real>(tensor_);
+  SyncFromTensor();
 };
 
+template <typename Real>
+MatrixBase<Real>::MatrixBase(
+    const torch::Tensor& base,
+    Real* data,
+    MatrixIndexT num_rows,
+    MatrixIndexT num_cols,
+    MatrixIndexT row_stride,
+    MatrixIndexT col_stride)
+    : data_(data),
+      num_rows_(num_rows),
+      num_cols_(num_cols),
+      row_stride_(row_stride),
+      col_stride_(col_stride),
+      base_(base) {}
+
+template <typename Real>
+void MatrixBase<Real>::SyncFromTensor() {
+  data_ = tensor_.data_ptr<Real>();
+  num_rows_ = tensor_.size(0);
+  num_cols_ = tensor_.size(1);
+  row_stride_ = tensor_.stride(0);
+  col_stride_ = tensor_.stride(1);
+  base_ = tensor_;
+}
+
+template <typename Real>
+const torch::Tensor& MatrixBase<Real>::tensor() const {
+  if (!tensor_.defined()) {
+    // The deleter holds a reference to the owner of the memory, so that the
+    // view stays valid as long as the tensor is in use.
+    auto base = base_;
+    tensor_ = torch::from_blob(
+        data_,
+        {num_rows_, num_cols_},
+        {row_stride_, col_stride_},
+        [base](void*) {},
+        base_.options());
+  }
+  return tensor_;
+}
+
 template class Matrix<float>;
 template class Matrix<double>;
 template class MatrixBase<float>;
@@ -18,38 +18,46 @@ class MatrixBase {
   ////////////////////////////////////////////////////////////////////////////////
   // PyTorch-specific items
   ////////////////////////////////////////////////////////////////////////////////
-  torch::Tensor tensor_;
   /// Construct VectorBase which is an interface to an existing torch::Tensor
   /// object.
   MatrixBase(torch::Tensor tensor);
 
+  /// The torch::Tensor holding the elements. Element access, rows and
+  /// sub-matrices only use the cached data pointer and strides, so the
+  /// tensor of a SubMatrix is only created when a method needs it.
+  const torch::Tensor& tensor() const;
+
   ////////////////////////////////////////////////////////////////////////////////
   // Kaldi-compatible items
   ////////////////////////////////////////////////////////////////////////////////
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-matrix.h#L62-L63
   inline MatrixIndexT NumRows() const {
-    return tensor_.size(0);
+    return num_rows_;
   };
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-matrix.h#L65-L66
   inline MatrixIndexT NumCols() const {
-    return tensor_.size(1);
+    return num_cols_;
   };
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-matrix.h#L177-L178
   void CopyColFromVec(const VectorBase<Real>& v, const MatrixIndexT col) {
-    tensor_.index_put_({Slice(), col}, v.tensor_);
+    TORCH_INTERNAL_ASSERT(v.Dim() == num_rows_);
+    TORCH_INTERNAL_ASSERT(col >= 0 && col < num_cols_);
+    Real* data = data_ + col * col_stride_;
+    for (MatrixIndexT r = 0; r < num_rows_; r++) {
+      data[r * row_stride_] = v(r);
+    }
   }
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-matrix.h#L99-L107
   inline Real& operator()(MatrixIndexT r, MatrixIndexT c) {
-    // CPU only
-    return tensor_.accessor<Real, 2>()[r][c];
+    return data_[r * row_stride_ + c * col_stride_];
   }
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-matrix.h#L112-L120
   inline const Real operator()(MatrixIndexT r, MatrixIndexT c) const {
-    return tensor_.index({Slice(r), Slice(c)}).item().template to<Real>();
+    return data_[r * row_stride_ + c * col_stride_];
   }
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-matrix.h#L138-L141
@@ -58,10 +66,10 @@ class MatrixBase {
   void CopyFromMat(
       const MatrixBase<OtherReal>& M,
       MatrixTransposeType trans = kNoTrans) {
-    auto src = M.tensor_;
+    auto src = M.tensor();
     if (trans == kTrans)
       src = src.transpose(1, 0);
-    tensor_.index_put_({Slice(), Slice()}, src);
+    tensor().copy_(src);
   }
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-matrix.h#L186-L191
@@ -78,9 +86,37 @@ class MatrixBase {
 
  protected:
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-matrix.h#L749-L753
-  explicit MatrixBase() : tensor_(torch::empty({0, 0})) {
+  explicit MatrixBase()
+      : MatrixBase<Real>(torch::empty({0, 0}, torch::dtype<Real>())) {
     KALDI_ASSERT_IS_FLOATING_TYPE(Real);
   }
+
+  /// View on the elements of an other matrix, which are owned by `base`.
+  /// Used by SubMatrix.
+  MatrixBase(
+      const torch::Tensor& base,
+      Real* data,
+      MatrixIndexT num_rows,
+      MatrixIndexT num_cols,
+      MatrixIndexT row_stride,
+      MatrixIndexT col_stride);
+
+  /// Updates the cached pointer, sizes and strides after `tensor_` changed.
+  void SyncFromTensor();
+
+  Real* data_;
+  MatrixIndexT num_rows_;
+  MatrixIndexT num_cols_;
+  MatrixIndexT row_stride_;
+  MatrixIndexT col_stride_;
+  /// Tensor which owns the memory of the elements.
+  torch::Tensor base_;
+  /// Tensor view on the elements. Undefined until `tensor()` is called for
+  /// SubMatrix.
+  mutable torch::Tensor tensor_;
+
+  friend class SubVector<Real>;
+  friend class SubMatrix<Real>;
 };
 
 // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-matrix.h#L781-L784
@@ -105,7 +141,7 @@ class Matrix : public MatrixBase<Real> {
       const MatrixBase<Real>& M,
       MatrixTransposeType trans = kNoTrans)
       : MatrixBase<Real>(
-            trans == kNoTrans ? M.tensor_ : M.tensor_.transpose(1, 0)) {}
+            trans == kNoTrans ? M.tensor() : M.tensor().transpose(1, 0)) {}
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-matrix.h#L816-L819
   template <typename OtherReal>
@@ -113,7 +149,7 @@ class Matrix : public MatrixBase<Real> {
       const MatrixBase<OtherReal>& M,
       MatrixTransposeType trans = kNoTrans)
       : MatrixBase<Real>(
-            trans == kNoTrans ? M.tensor_ : M.tensor_.transpose(1, 0)) {}
+            trans == kNoTrans ? M.tensor() : M.tensor().transpose(1, 0)) {}
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-matrix.h#L859-L874
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-matrix.cc#L817-L857
@@ -131,7 +167,7 @@ class Matrix : public MatrixBase<Real> {
         tensor_.resize_({r, c});
         break;
       case kCopyData:
-        auto tmp = tensor_;
+        auto tmp = tensor_.clone();
         auto tmp_rows = tmp.size(0);
         auto tmp_cols = tmp.size(1);
         tensor_.resize_({r, c}).zero_();
@@ -140,6 +176,7 @@ class Matrix : public MatrixBase<Real> {
         tensor_.index_put_({rows, cols}, tmp.index({rows, cols}));
         break;
     }
+    this->SyncFromTensor();
   }
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-matrix.h#L876-L883
@@ -163,13 +200,31 @@ class SubMatrix : public MatrixBase<Real> {
       const MatrixIndexT co, // column offset, 0 < co < NumCols()
       const MatrixIndexT c) // number of columns, c > 0
       : MatrixBase<Real>(
-            T.tensor_.index({Slice(ro, ro + r), Slice(co, co + c)})) {}
+            T.base_,
+            T.data_ + ro * T.row_stride_ + co * T.col_stride_,
+            r,
+            c,
+            T.row_stride_,
+            T.col_stride_) {
+    TORCH_INTERNAL_ASSERT(ro >= 0 && r >= 0 && ro + r <= T.num_rows_);
+    TORCH_INTERNAL_ASSERT(co >= 0 && c >= 0 && co + c <= T.num_cols_);
+  }
+
+  // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-matrix.h#L966-L970
+  SubMatrix(const SubMatrix& other)
+      : MatrixBase<Real>(
+            other.base_,
+            other.data_,
+            other.num_rows_,
+            other.num_cols_,
+            other.row_stride_,
+            other.col_stride_) {}
 };
 
 // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-matrix.h#L1059-L1060
 template <typename Real>
 std::ostream& operator<<(std::ostream& Out, const MatrixBase<Real>& M) {
-  Out << M.tensor_;
+  Out << M.tensor();
   return Out;
 }
 
@@ -26,13 +26,42 @@ void assert_vector_shape<double>(const torch::Tensor& tensor_) {
 namespace kaldi {
 
 template <typename Real>
-VectorBase<Real>::VectorBase(torch::Tensor tensor)
-    : tensor_(tensor), data_(tensor.data_ptr<Real>()) {
+VectorBase<Real>::VectorBase(torch::Tensor tensor) : tensor_(tensor) {
   assert_vector_shape<Real>(tensor_);
+  SyncFromTensor();
 };
 
 template <typename Real>
-VectorBase<Real>::VectorBase() : VectorBase<Real>(torch::empty({0})) {}
+VectorBase<Real>::VectorBase()
+    : VectorBase<Real>(torch::empty({0}, torch::dtype<Real>())) {}
+
+template <typename Real>
+VectorBase<Real>::VectorBase(
+    const torch::Tensor& base,
+    Real* data,
+    MatrixIndexT dim,
+    MatrixIndexT stride)
+    : data_(data), dim_(dim), stride_(stride), base_(base) {}
+
+template <typename Real>
+void VectorBase<Real>::SyncFromTensor() {
+  data_ = tensor_.data_ptr<Real>();
+  dim_ = tensor_.numel();
+  stride_ = dim_ ? tensor_.stride(0) : 1;
+  base_ = tensor_;
+}
+
+template <typename Real>
+const torch::Tensor& VectorBase<Real>::tensor() const {
+  if (!tensor_.defined()) {
+    // The deleter holds a reference to the owner of the memory, so that the
+    // view stays valid as long as the tensor is in use.
+    auto base = base_;
+    tensor_ = torch::from_blob(
+        data_, {dim_}, {stride_}, [base](void*) {}, base_.options());
+  }
+  return tensor_;
+}
 
 template class Vector<float>;
 template class Vector<double>;
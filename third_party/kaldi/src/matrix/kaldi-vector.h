@@ -4,6 +4,9 @@
 #define KALDI_MATRIX_KALDI_VECTOR_H_
 
 #include <torch/torch.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include "matrix/matrix-common.h"
 
 using namespace torch::indexing;
@@ -17,12 +20,15 @@ class VectorBase {
   ////////////////////////////////////////////////////////////////////////////////
   // PyTorch-specific things
   ////////////////////////////////////////////////////////////////////////////////
-  torch::Tensor tensor_;
-
   /// Construct VectorBase which is an interface to an existing torch::Tensor
   /// object.
   VectorBase(torch::Tensor tensor);
 
+  /// The torch::Tensor holding the elements. Element access and sub-vectors
+  /// only use the cached data pointer and stride, so the tensor of a
+  /// SubVector is only created when a method needs it.
+  const torch::Tensor& tensor() const;
+
   ////////////////////////////////////////////////////////////////////////////////
   // Kaldi-compatible methods
   ////////////////////////////////////////////////////////////////////////////////
@@ -33,12 +39,14 @@ class VectorBase {
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L48-L49
   void Set(Real f) {
-    tensor_.index_put_({"..."}, f);
+    for (MatrixIndexT i = 0; i < dim_; i++) {
+      data_[i * stride_] = f;
+    }
   }
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L62-L63
   inline MatrixIndexT Dim() const {
-    return tensor_.numel();
+    return dim_;
   };
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L68-L69
@@ -53,12 +61,12 @@ class VectorBase {
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L74-L79
   inline Real operator()(MatrixIndexT i) const {
-    return data_[i];
+    return data_[i * stride_];
   };
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L81-L86
   inline Real& operator()(MatrixIndexT i) {
-    return tensor_.accessor<Real, 1>()[i];
+    return data_[i * stride_];
   };
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L88-L95
@@ -75,36 +83,54 @@ class VectorBase {
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L107-L108
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.cc#L226-L233
   void CopyFromVec(const VectorBase<Real>& v) {
-    TORCH_INTERNAL_ASSERT(tensor_.sizes() == v.tensor_.sizes());
-    tensor_.copy_(v.tensor_);
+    TORCH_INTERNAL_ASSERT(dim_ == v.dim_);
+    for (MatrixIndexT i = 0; i < dim_; i++) {
+      data_[i * stride_] = v.data_[i * v.stride_];
+    }
   }
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L137-L139
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.cc#L816-L832
   void ApplyFloor(Real floor_val, MatrixIndexT* floored_count = nullptr) {
-    auto index = tensor_ < floor_val;
-    auto tmp = tensor_.index_put_({index}, floor_val);
+    MatrixIndexT count = 0;
+    for (MatrixIndexT i = 0; i < dim_; i++) {
+      Real& x = data_[i * stride_];
+      if (x < floor_val) {
+        x = floor_val;
+        count++;
+      }
+    }
     if (floored_count) {
-      *floored_count = index.sum().item().template to<MatrixIndexT>();
+      *floored_count = count;
     }
   }
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L164-L165
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.cc#L449-L479
   void ApplyPow(Real power) {
-    tensor_.pow_(power);
-    TORCH_INTERNAL_ASSERT(!tensor_.isnan().sum().item().template to<int32_t>());
+    for (MatrixIndexT i = 0; i < dim_; i++) {
+      Real& x = data_[i * stride_];
+      x = static_cast<Real>(std::pow(x, power));
+      TORCH_INTERNAL_ASSERT(!std::isnan(x));
+    }
   }
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L181-L184
   template <typename OtherReal>
   void AddVec(const Real alpha, const VectorBase<OtherReal>& v) {
-    tensor_ += alpha * v.tensor_;
+    TORCH_INTERNAL_ASSERT(dim_ == v.Dim());
+    for (MatrixIndexT i = 0; i < dim_; i++) {
+      data_[i * stride_] += alpha * static_cast<Real>(v(i));
+    }
   }
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L186-L187
   void AddVec2(const Real alpha, const VectorBase<Real>& v) {
-    tensor_ += alpha * (v.tensor_.square());
+    TORCH_INTERNAL_ASSERT(dim_ == v.dim_);
+    for (MatrixIndexT i = 0; i < dim_; i++) {
+      const Real x = v.data_[i * v.stride_];
+      data_[i * stride_] += alpha * x * x;
+    }
   }
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L196-L198
@@ -114,21 +140,26 @@ class VectorBase {
       const MatrixTransposeType trans,
       const VectorBase<Real>& v,
       const Real beta) { // **beta previously defaulted to 0.0**
-    auto mat = M.tensor_;
+    auto mat = M.tensor();
     if (trans == kTrans) {
       mat = mat.transpose(1, 0);
     }
-    tensor_.addmv_(mat, v.tensor_, beta, alpha);
+    tensor().addmv_(mat, v.tensor(), beta, alpha);
   }
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L221-L222
   void MulElements(const VectorBase<Real>& v) {
-    tensor_ *= v.tensor_;
+    TORCH_INTERNAL_ASSERT(dim_ == v.dim_);
+    for (MatrixIndexT i = 0; i < dim_; i++) {
+      data_[i * stride_] *= v.data_[i * v.stride_];
+    }
   }
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L233-L234
   void Add(Real c) {
-    tensor_ += c;
+    for (MatrixIndexT i = 0; i < dim_; i++) {
+      data_[i * stride_] += c;
+    }
   }
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L236-L239
@@ -137,34 +168,49 @@ class VectorBase {
       const VectorBase<Real>& v,
       const VectorBase<Real>& r,
       Real beta) {
-    tensor_ = beta * tensor_ + alpha * v.tensor_ * r.tensor_;
+    TORCH_INTERNAL_ASSERT(dim_ == v.dim_ && dim_ == r.dim_);
+    for (MatrixIndexT i = 0; i < dim_; i++) {
+      Real& x = data_[i * stride_];
+      x = beta * x + alpha * v.data_[i * v.stride_] * r.data_[i * r.stride_];
+    }
   }
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L246-L247
   void Scale(Real alpha) {
-    tensor_ *= alpha;
+    for (MatrixIndexT i = 0; i < dim_; i++) {
+      data_[i * stride_] *= alpha;
+    }
   }
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L305-L306
   Real Min() const {
-    if (tensor_.numel()) {
-      return tensor_.min().item().template to<Real>();
+    Real ans = std::numeric_limits<Real>::infinity();
+    for (MatrixIndexT i = 0; i < dim_; i++) {
+      ans = std::min(ans, data_[i * stride_]);
     }
-    return std::numeric_limits<Real>::infinity();
+    return ans;
   }
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L308-L310
   Real Min(MatrixIndexT* index) const {
-    TORCH_INTERNAL_ASSERT(tensor_.numel());
-    torch::Tensor value, ind;
-    std::tie(value, ind) = tensor_.min(0);
-    *index = ind.item().to<MatrixIndexT>();
-    return value.item().to<Real>();
+    TORCH_INTERNAL_ASSERT(dim_);
+    MatrixIndexT ind = 0;
+    for (MatrixIndexT i = 1; i < dim_; i++) {
+      if (data_[i * stride_] < data_[ind * stride_]) {
+        ind = i;
+      }
+    }
+    *index = ind;
+    return data_[ind * stride_];
   }
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L312-L313
   Real Sum() const {
-    return tensor_.sum().item().template to<Real>();
+    Real sum = 0;
+    for (MatrixIndexT i = 0; i < dim_; i++) {
+      sum += data_[i * stride_];
+    }
+    return sum;
   };
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L320-L321
@@ -189,13 +235,15 @@ class VectorBase {
       const MatrixBase<Real>& M,
       MatrixTransposeType trans = kNoTrans,
       Real beta = 1.0) {
-    auto mat = M.tensor_;
+    // Updated in place, so that the result is visible through data_ and in
+    // the parent of a SubVector.
+    auto mat = M.tensor();
     if (trans == kNoTrans) {
-      tensor_ =
-          beta * tensor_ + torch::diag(torch::mm(mat, mat.transpose(1, 0)));
+      tensor().mul_(beta).add_(
+          torch::diag(torch::mm(mat, mat.transpose(1, 0))), alpha);
     } else {
-      tensor_ =
-          beta * tensor_ + torch::diag(torch::mm(mat.transpose(1, 0), mat));
+      tensor().mul_(beta).add_(
+          torch::diag(torch::mm(mat.transpose(1, 0), mat)), alpha);
     }
   }
 
@@ -203,8 +251,28 @@ class VectorBase {
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L362-L365
   explicit VectorBase();
 
+  /// View on the elements of an other vector or matrix, which are owned by
+  /// `base`. Used by SubVector.
+  VectorBase(
+      const torch::Tensor& base,
+      Real* data,
+      MatrixIndexT dim,
+      MatrixIndexT stride);
+
+  /// Updates the cached pointer, size and stride after `tensor_` changed.
+  void SyncFromTensor();
+
   //  https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L378-L379
   Real* data_;
+  MatrixIndexT dim_;
+  MatrixIndexT stride_;
+  /// Tensor which owns the memory of the elements.
+  torch::Tensor base_;
+  /// Tensor view on the elements. Undefined until `tensor()` is called for
+  /// SubVector.
+  mutable torch::Tensor tensor_;
+
+  friend class SubVector<Real>;
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L382
   KALDI_DISALLOW_COPY_AND_ASSIGN(VectorBase);
 };
@@ -235,17 +303,17 @@ class Vector : public VectorBase<Real> {
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L406-L410
   // Note: unlike the original implementation, this is "explicit".
   explicit Vector(const Vector<Real>& v)
-      : VectorBase<Real>(v.tensor_.clone()) {}
+      : VectorBase<Real>(v.tensor().clone()) {}
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L412-L416
   explicit Vector(const VectorBase<Real>& v)
-      : VectorBase<Real>(v.tensor_.clone()) {}
+      : VectorBase<Real>(v.tensor().clone()) {}
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L434-L435
   void Swap(Vector<Real>* other) {
-    auto tmp = VectorBase<Real>::tensor_;
-    this->tensor_ = other->tensor_;
-    other->tensor_ = tmp;
+    std::swap(this->tensor_, other->tensor_);
+    this->SyncFromTensor();
+    other->SyncFromTensor();
   }
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L444-L451
@@ -260,15 +328,14 @@ class Vector : public VectorBase<Real> {
         tensor_.resize_({length});
         break;
       case kCopyData:
-        auto tmp = tensor_;
+        auto tmp = tensor_.clone();
         auto tmp_numel = tensor_.numel();
         tensor_.resize_({length}).zero_();
         auto numel = Slice(length < tmp_numel ? length : tmp_numel);
         tensor_.index_put_({numel}, tmp.index({numel}));
         break;
     }
-    // data_ptr<Real>() causes compiler error
-    this->data_ = static_cast<Real*>(tensor_.data_ptr());
+    this->SyncFromTensor();
   }
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L463-L468
@@ -288,24 +355,51 @@ class SubVector : public VectorBase<Real> {
       const VectorBase<Real>& t,
       const MatrixIndexT origin,
       const MatrixIndexT length)
-      : VectorBase<Real>(t.tensor_.index({Slice(origin, origin + length)})) {}
+      : VectorBase<Real>(
+            t.base_,
+            t.data_ + origin * t.stride_,
+            length,
+            t.stride_) {
+    TORCH_INTERNAL_ASSERT(
+        origin >= 0 && length >= 0 && origin + length <= t.dim_);
+  }
+
+  // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L501-L505
+  SubVector(const SubVector& other)
+      : VectorBase<Real>(
+            other.base_,
+            other.data_,
+            other.dim_,
+            other.stride_) {}
 
   // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L524-L528
   SubVector(const MatrixBase<Real>& matrix, MatrixIndexT row)
-      : VectorBase<Real>(matrix.tensor_.index({row})) {}
+      : VectorBase<Real>(
+            matrix.base_,
+            matrix.data_ + row * matrix.row_stride_,
+            matrix.num_cols_,
+            matrix.col_stride_) {
+    TORCH_INTERNAL_ASSERT(row >= 0 && row < matrix.num_rows_);
+  }
 };
 
 // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L540-L543
 template <typename Real>
 std::ostream& operator<<(std::ostream& out, const VectorBase<Real>& v) {
-  out << v.tensor_;
+  out << v.tensor();
   return out;
 }
 
 // https://github.com/kaldi-asr/kaldi/blob/7fb716aa0f56480af31514c7e362db5c9f787fd4/src/matrix/kaldi-vector.h#L573-L575
 template <typename Real>
 Real VecVec(const VectorBase<Real>& v1, const VectorBase<Real>& v2) {
-  return torch::dot(v1.tensor_, v2.tensor_).item().template to<Real>();
+  const MatrixIndexT dim = v1.Dim();
+  TORCH_INTERNAL_ASSERT(dim == v2.Dim());
+  Real sum = 0;
+  for (MatrixIndexT i = 0; i < dim; i++) {
+    sum += v1(i) * v2(i);
+  }
+  return sum;
 }
 
 } // namespace kaldi
@@ -1,5 +1,6 @@
+import json
 import os
-from typing import Tuple, Optional
+from typing import Dict, Iterator, List, Tuple, Optional
 
 import torch
 from torchaudio._internal import (
@@ -54,6 +55,86 @@ def info(
     return AudioMetaData(*sinfo)
 
 
+@_mod_utils.requires_sox()
+def info_files(
+        filepaths: List[str],
+        format: Optional[str] = None,
+        header_only: bool = False,
+        cache_path: Optional[str] = None,
+) -> List[AudioMetaData]:
+    """Get signal information of multiple audio files in parallel.
+
+    The files are opened by the intra-op thread pool of PyTorch (see
+    :py:func:`torch.set_num_threads`).
+
+    Args:
+        filepaths (list of path-like objects):
+            Paths to audio files.
+        format (str or None, optional):
+            Override the format detection of all the files with the given format.
+        header_only (bool, optional):
+            When ``True``, only the first few kilobytes of each file are parsed, and
+            ``num_frames`` is ``0``. For formats such as ``mp3`` and ``vorbis``, libsox
+            otherwise reads much more of the file to find the number of frames.
+            (Default: ``False``)
+        cache_path (str or None, optional):
+            Path to a JSON file holding the results of previous calls, keyed by path,
+            ``format`` and ``header_only``, along with the modification time and size of
+            the files. Only the files which are not in it, or which changed, are opened,
+            and the file is updated with them. Not supported by TorchScript.
+            (Default: ``None``)
+
+    Returns:
+        List[AudioMetaData]: Metadata of the given audio files, in the order of ``filepaths``.
+    """
+    if not torch.jit.is_scripting():
+        filepaths = [os.fspath(p) for p in filepaths]
+        if cache_path is not None:
+            return _info_files_cached(filepaths, format, header_only, os.fspath(cache_path))
+    sinfos = torch.ops.torchaudio.sox_io_get_info_files(filepaths, format, header_only)
+    return [AudioMetaData(*sinfo) for sinfo in sinfos]
+
+
+def _info_files_cached(
+        filepaths: List[str],
+        format: Optional[str],
+        header_only: bool,
+        cache_path: str,
+) -> List[AudioMetaData]:
+    cache: Dict[str, list] = {}
+    if os.path.exists(cache_path):
+        with open(cache_path, 'r') as file:
+            cache = json.load(file)
+
+    keys, stats, missing = [], [], []
+    for i, filepath in enumerate(filepaths):
+        # The results differ by query mode (``num_frames`` is ``0`` for header-only queries).
+        key = f'{os.path.abspath(filepath)}:{format or ""}:{int(header_only)}'
+        try:
+            stat = os.stat(filepath)
+        except OSError:
+            # Let the op raise the same error as without cache.
+            stat = None
+        entry = cache.get(key)
+        if stat is None or entry is None or entry[:2] != [stat.st_mtime_ns, stat.st_size]:
+            missing.append(i)
+        keys.append(key)
+        stats.append(stat)
+
+    if missing:
+        sinfos = torch.ops.torchaudio.sox_io_get_info_files(
+            [filepaths[i] for i in missing], format, header_only)
+        for i, sinfo in zip(missing, sinfos):
+            cache[keys[i]] = [stats[i].st_mtime_ns, stats[i].st_size, list(sinfo)]
+        # Write to a temporary file first, so that the cache is not corrupted if interrupted.
+        tmp_path = f'{cache_path}.{os.getpid()}.tmp'
+        with open(tmp_path, 'w') as file:
+            json.dump(cache, file)
+        os.replace(tmp_path, cache_path)
+
+    return [AudioMetaData(*cache[key][2]) for key in keys]
+
+
 @_mod_utils.requires_sox()
 def load(
         filepath: str,
@@ -153,6 +234,158 @@ def load(
         filepath, frame_offset, num_frames, normalize, channels_first, format)
 
 
+@_mod_utils.requires_sox()
+def load_files(
+        filepaths: List[str],
+        frame_offsets: Optional[List[int]] = None,
+        num_frames: Optional[List[int]] = None,
+        normalize: bool = True,
+        channels_first: bool = True,
+        format: Optional[str] = None,
+        buffer_size: Optional[int] = None,
+        num_threads: Optional[int] = None,
+) -> Tuple[List[torch.Tensor], List[int]]:
+    """Load audio data from multiple files in parallel.
+
+    The files are decoded by the intra-op thread pool of PyTorch (see
+    :py:func:`torch.set_num_threads`), each with its own libsox effects chain,
+    so a single process can use all the cores.
+
+    Args:
+        filepaths (list of path-like objects):
+            Paths to audio files.
+        frame_offsets (list of int or None, optional):
+            Number of frames to skip before start reading data, one value per file.
+        num_frames (list of int or None, optional):
+            Maximum number of frames to read from each file. ``-1`` reads all the remaining
+            samples, starting from the frame offset.
+        normalize (bool, optional):
+            Same as :py:func:`load`.
+        channels_first (bool, optional):
+            Same as :py:func:`load`.
+        format (str or None, optional):
+            Override the format detection of all the files with the given format.
+        buffer_size (int or None, optional):
+            The maximum number of samples the effects chain of each file processes at a time.
+            Unlike :py:func:`torchaudio.utils.sox_utils.set_buffer_size`, this does not change
+            the process-wide configuration, but it cannot exceed the buffer size set with it.
+            (Default: ``None``, the buffer size of ``libsox``)
+        num_threads (int or None, optional):
+            The maximum number of files decoded at the same time.
+            (Default: ``None``, the number of threads of the intra-op thread pool)
+
+    Returns:
+        Tuple[List[torch.Tensor], List[int]]: Resulting Tensors and sample rates,
+            in the order of ``filepaths``.
+            Each Tensor is the same as the one :py:func:`load` returns for the file.
+    """
+    if not torch.jit.is_scripting():
+        filepaths = [os.fspath(p) for p in filepaths]
+    return torch.ops.torchaudio.sox_io_load_audio_files(
+        filepaths, frame_offsets, num_frames, normalize, channels_first, format, buffer_size, num_threads)
+
+
+@_mod_utils.requires_sox()
+def load_batch(
+        filepaths: List[str],
+        frame_offsets: Optional[List[int]] = None,
+        num_frames: Optional[List[int]] = None,
+        normalize: bool = True,
+        channels_first: bool = True,
+        format: Optional[str] = None,
+) -> Tuple[torch.Tensor, torch.Tensor, int]:
+    """Load audio data from multiple files in parallel into a padded batch.
+
+    Same as :py:func:`load_files`, but the waveforms are zero-padded to the longest one
+    and stacked. All the files must have the same sample rate and number of channels.
+
+    Args:
+        filepaths (list of path-like objects):
+            Paths to audio files.
+        frame_offsets (list of int or None, optional):
+            Same as :py:func:`load_files`.
+        num_frames (list of int or None, optional):
+            Same as :py:func:`load_files`.
+        normalize (bool, optional):
+            Same as :py:func:`load`.
+        channels_first (bool, optional):
+            When True, the returned Tensor has dimension ``[batch, channel, time]``.
+            Otherwise, the returned Tensor's dimension is ``[batch, time, channel]``.
+        format (str or None, optional):
+            Override the format detection of all the files with the given format.
+
+    Returns:
+        Tuple[torch.Tensor, torch.Tensor, int]: Resulting Tensor, the number of frames of
+            each file as an ``int64`` Tensor of ``[batch]`` shape, and sample rate.
+    """
+    if len(filepaths) == 0:
+        raise ValueError("At least one file path is required.")
+    waveforms, sample_rates = load_files(
+        filepaths, frame_offsets, num_frames, normalize, channels_first, format)
+    time_dim = 1 if channels_first else 0
+    num_channels = waveforms[0].size(1 - time_dim)
+    for i in range(len(waveforms)):
+        if sample_rates[i] != sample_rates[0]:
+            raise ValueError(
+                f"All the files must have the same sample rate. Found: {sample_rates[i]} "
+                f"({filepaths[i]}) and {sample_rates[0]} ({filepaths[0]}).")
+        if waveforms[i].size(1 - time_dim) != num_channels:
+            raise ValueError(
+                f"All the files must have the same number of channels. Found: "
+                f"{waveforms[i].size(1 - time_dim)} ({filepaths[i]}) and {num_channels} ({filepaths[0]}).")
+    lengths = torch.tensor([w.size(time_dim) for w in waveforms], dtype=torch.int64)
+    max_length = int(lengths.max())
+    shape = [len(waveforms), num_channels, max_length] if channels_first else [len(waveforms), max_length, num_channels]
+    batch = torch.zeros(shape, dtype=waveforms[0].dtype)
+    for i, waveform in enumerate(waveforms):
+        batch[i].narrow(time_dim, 0, waveform.size(time_dim)).copy_(waveform)
+    return batch, lengths, sample_rates[0]
+
+
+@_mod_utils.requires_sox()
+def load_tar(
+        filepath: str,
+        normalize: bool = True,
+        channels_first: bool = True,
+) -> Iterator[Tuple[str, torch.Tensor, int]]:
+    """Load the audio members of a tar archive in order, without extracting them.
+
+    The archive is mapped in memory and read sequentially, and each member is decoded from
+    the mapped bytes, so the files of a shard are loaded with a single open.
+    WAV members are decoded as in :py:func:`load`, and the other members with libsox, if
+    it supports the extension of the member. The other members (for example ``.json`` or
+    ``.txt`` in `WebDataset <https://github.com/webdataset/webdataset>`_ shards) are skipped.
+
+    Note:
+        With TorchScript, use ``torch.classes.torchaudio.sox_io_TarReader``, whose ``next``
+        method returns the next member or ``None`` at the end.
+
+    Args:
+        filepath (path-like object): Path to a tar archive (ustar, GNU or pax, not compressed).
+        normalize (bool, optional): Same as :py:func:`load`.
+        channels_first (bool, optional): Same as :py:func:`load`.
+
+    Returns:
+        Iterator[Tuple[str, torch.Tensor, int]]: Iterator over the key, the waveform and the
+            sample rate of each audio member. The key is the path of the member up to the first
+            dot of its file name, as in WebDataset.
+
+    Example
+        >>> for key, waveform, sample_rate in sox_io_backend.load_tar("shard-000000.tar"):
+        ...     labels = transcripts[key]
+    """
+    reader = torch.classes.torchaudio.sox_io_TarReader(os.fspath(filepath), normalize, channels_first)
+
+    def _iterate():
+        while True:
+            member = reader.next()
+            if member is None:
+                return
+            yield member
+
+    return _iterate()
+
+
 @_mod_utils.requires_sox()
 def save(
         filepath: str,
@@ -315,3 +548,59 @@ def save(
         filepath = os.fspath(filepath)
     torch.ops.torchaudio.sox_io_save_audio_file(
         filepath, src, sample_rate, channels_first, compression, format, encoding, bits_per_sample)
+
+
+class AudioWriter:
+    """Save audio data to files in background threads.
+
+    :py:meth:`save` takes the same arguments as :py:func:`save`, checks them and returns
+    immediately with a :py:class:`torch.futures.Future`, while the file is encoded by one of
+    ``num_threads`` threads. The encoding parameters are resolved once for each combination
+    of format, dtype, ``compression``, ``encoding`` and ``bits_per_sample``, so writing many
+    files with the same settings does not repeat the work.
+
+    The Tensor given to :py:meth:`save` must not be modified until its Future is completed.
+
+    Note:
+        With TorchScript, use ``torch.classes.torchaudio.sox_io_AudioWriter`` and
+        ``torch.ops.torchaudio.sox_io_AudioWriter_save``, which takes the writer as the first
+        argument.
+
+    Args:
+        num_threads (int, optional): The number of files encoded at the same time. (Default: ``1``)
+
+    Example
+        >>> writer = torchaudio.backend.sox_io_backend.AudioWriter(num_threads=4)
+        >>> futures = [writer.save(f"{i}.flac", waveform, 22050) for i, waveform in enumerate(outputs)]
+        >>> torch.futures.wait_all(futures)
+    """
+    @_mod_utils.requires_sox()
+    def __init__(self, num_threads: int = 1):
+        self._writer = torch.classes.torchaudio.sox_io_AudioWriter(num_threads)
+
+    def save(
+            self,
+            filepath: str,
+            src: torch.Tensor,
+            sample_rate: int,
+            channels_first: bool = True,
+            compression: Optional[float] = None,
+            format: Optional[str] = None,
+            encoding: Optional[str] = None,
+            bits_per_sample: Optional[int] = None,
+    ) -> torch.futures.Future:
+        """Save audio data to file in the background.
+
+        See :py:func:`save` for the arguments. Invalid arguments are reported here, and the
+        errors raised while writing the file are raised by the ``wait`` method of the Future.
+
+        Returns:
+            torch.futures.Future: Future completed with ``None`` when the file is written.
+        """
+        return torch.ops.torchaudio.sox_io_AudioWriter_save(
+            self._writer, os.fspath(filepath), src, sample_rate, channels_first, compression,
+            format, encoding, bits_per_sample)
+
+    def wait(self):
+        """Block until all the files given to :py:meth:`save` so far are written."""
+        self._writer.wait()
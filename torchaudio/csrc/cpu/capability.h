@@ -0,0 +1,14 @@
+#pragma once
+
+// The inline namespace of the code that the kernel sources, which are
+// compiled once per instruction set (see `dispatch.h`), share through
+// headers, such as the CPU runner of `stateful_effect.h`. Each copy of a
+// kernel source gets its own instantiations of this code, instead of inline
+// functions and template instantiations which the linker would pick from any
+// of the copies. The other sources are compiled for the baseline instruction
+// set, and share the DEFAULT ones.
+#ifdef CPU_CAPABILITY
+#define TORCHAUDIO_CPU_CAPABILITY_NAMESPACE CPU_CAPABILITY
+#else
+#define TORCHAUDIO_CPU_CAPABILITY_NAMESPACE DEFAULT
+#endif
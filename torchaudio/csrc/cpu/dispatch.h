@@ -0,0 +1,88 @@
+#pragma once
+
+#include <ATen/native/DispatchStub.h>
+#include <c10/macros/Macros.h>
+#include <torchaudio/csrc/cpu/capability.h>
+
+#include <utility>
+
+namespace torchaudio {
+namespace cpu {
+
+// CPU kernels compiled once per instruction set, after ATen's DispatchStub.
+//
+// The sources listed in `CPU_KERNEL_SOURCES` of `csrc/CMakeLists.txt` are
+// compiled once for each of DEFAULT, AVX2 and, with PyTorch 1.10 or later,
+// AVX512 (DEFAULT only on the other architectures), with `CPU_CAPABILITY`
+// defined to the name of the instruction set, and all the sources with
+// `TORCHAUDIO_HAVE_CPU_CAPABILITY_<name>` defined for each of them. Each copy
+// registers its kernels into the stubs with
+// `TORCHAUDIO_REGISTER_DISPATCH`, and calling a stub runs the variant for the
+// best instruction set that the CPU supports, as reported by
+// `at::native::get_cpu_capability`. So the `ATEN_CPU_CAPABILITY` environment
+// variable caps the variant of torchaudio's kernels as it caps ATen's ones.
+//
+// The code in the kernel sources must have internal linkage (an anonymous
+// namespace), and the code they share through torchaudio's headers must be
+// in the `TORCHAUDIO_CPU_CAPABILITY_NAMESPACE` inline namespace (see
+// `capability.h`), so that each copy only runs code compiled for its
+// instruction set.
+template <typename FnPtr>
+struct DispatchStub;
+
+template <typename ReturnType, typename... Args>
+struct DispatchStub<ReturnType (*)(Args...)> {
+  using FnPtr = ReturnType (*)(Args...);
+
+  // Set by the static initializers of the kernel sources. These members are
+  // zero-initialized before any of them runs.
+  FnPtr DEFAULT;
+  FnPtr AVX2;
+  FnPtr AVX512;
+
+  FnPtr choose() const {
+    // Only the instruction sets the kernels are compiled for are named, as
+    // `CPUCapability` does not have all of them on every version and
+    // architecture of PyTorch.
+#if defined(TORCHAUDIO_HAVE_CPU_CAPABILITY_AVX512) || \
+    defined(TORCHAUDIO_HAVE_CPU_CAPABILITY_AVX2)
+    const auto capability = at::native::get_cpu_capability();
+#endif
+#ifdef TORCHAUDIO_HAVE_CPU_CAPABILITY_AVX512
+    if (AVX512 && capability >= at::native::CPUCapability::AVX512) {
+      return AVX512;
+    }
+#endif
+#ifdef TORCHAUDIO_HAVE_CPU_CAPABILITY_AVX2
+    if (AVX2 && capability >= at::native::CPUCapability::AVX2) {
+      return AVX2;
+    }
+#endif
+    TORCH_INTERNAL_ASSERT(DEFAULT, "The DEFAULT kernel is not registered.");
+    return DEFAULT;
+  }
+
+  template <typename... ArgTypes>
+  ReturnType operator()(ArgTypes&&... args) const {
+    return (*choose())(std::forward<ArgTypes>(args)...);
+  }
+};
+
+} // namespace cpu
+} // namespace torchaudio
+
+// Declares the stub `name` of the kernels of type `fn_type`, in a header.
+#define TORCHAUDIO_DECLARE_DISPATCH(fn_type, name) \
+  extern ::torchaudio::cpu::DispatchStub<fn_type> name
+
+// Defines the stub `name`, in a source which is compiled once.
+#define TORCHAUDIO_DEFINE_DISPATCH(fn_type, name) \
+  ::torchaudio::cpu::DispatchStub<fn_type> name
+
+// Registers `fn` as the variant of the stub `name` for the instruction set
+// the kernel source is being compiled for.
+#define TORCHAUDIO_REGISTER_DISPATCH(name, fn)                         \
+  static const bool C10_ANONYMOUS_VARIABLE(registered_##name) = [] { \
+    (name).CPU_CAPABILITY = (fn);                                      \
+    return true;                                                       \
+  }()
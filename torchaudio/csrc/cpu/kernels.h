@@ -0,0 +1,61 @@
+#pragma once
+
+#include <torch/script.h>
+#include <torchaudio/csrc/cpu/capability.h>
+#include <torchaudio/csrc/cpu/dispatch.h>
+
+namespace torchaudio {
+namespace cpu {
+
+// Runs the recurrence of `_lfilter_core_loop`. See `lfilter.cpp`.
+using lfilter_core_loop_fn = void (*)(
+    const torch::Tensor& input_signal_windows,
+    const torch::Tensor& a_coeff_flipped,
+    torch::Tensor& padded_output_waveform,
+    bool reverse);
+
+// Minimum number of samples of the chunks a row is split into by
+// `lfilter_core_loop_stub`.
+constexpr int64_t kMinLfilterChunk = 1 << 14;
+
+// Returns the number of chunks along time each of the `n_rows` rows of
+// `n_samples` samples is split into by `lfilter_core_loop_stub`, so that few
+// long rows still use all the threads, or 1 when the rows are filtered whole.
+// The first and the last chunks are filtered once and the other ones twice,
+// so fewer than three chunks would not be any faster.
+inline namespace TORCHAUDIO_CPU_CAPABILITY_NAMESPACE {
+inline int64_t lfilter_num_chunks(int64_t n_rows, int64_t n_samples) {
+  const int64_t n_chunks = std::min<int64_t>(
+      at::get_num_threads() / std::max<int64_t>(n_rows, 1),
+      n_samples / kMinLfilterChunk);
+  return n_chunks >= 3 ? n_chunks : 1;
+}
+} // namespace TORCHAUDIO_CPU_CAPABILITY_NAMESPACE
+
+// Filters with at most this many coefficients are evaluated by the fused
+// kernel below when no gradient is required. Higher orders keep going
+// through the FIR + IIR path, which is numerically more robust for them.
+constexpr int64_t kMaxFusedOrder = 5;
+
+// Evaluates the whole difference equation of `lfilter` in direct form II
+// transposed, so that the input is read once and the output written once.
+using lfilter_fused_fn = void (*)(
+    const torch::Tensor& waveform,
+    const torch::Tensor& a_coeffs,
+    const torch::Tensor& b_coeffs,
+    torch::Tensor& output);
+
+// Runs `_overdrive_core_loop`. See `overdrive.cpp`.
+using overdrive_fn = void (*)(
+    const torch::Tensor& waveform,
+    const torch::Tensor& temp,
+    torch::Tensor& last_in,
+    torch::Tensor& last_out,
+    torch::Tensor& output_waveform);
+
+TORCHAUDIO_DECLARE_DISPATCH(lfilter_core_loop_fn, lfilter_core_loop_stub);
+TORCHAUDIO_DECLARE_DISPATCH(lfilter_fused_fn, lfilter_fused_stub);
+TORCHAUDIO_DECLARE_DISPATCH(overdrive_fn, overdrive_stub);
+
+} // namespace cpu
+} // namespace torchaudio
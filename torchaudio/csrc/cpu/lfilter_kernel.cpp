@@ -0,0 +1,552 @@
+#include <torchaudio/csrc/cpu/kernels.h>
+
+#include <algorithm>
+#include <array>
+
+// This source is compiled once per instruction set. See `dispatch.h`.
+
+namespace torchaudio {
+namespace cpu {
+namespace {
+
+// Width of the vector registers the interleaved kernel is tuned for. The
+// DEFAULT variant targets SSE2 and NEON, the baselines of x86-64 and aarch64.
+#if defined(CPU_CAPABILITY_AVX512)
+constexpr int64_t kVectorBytes = 64;
+#elif defined(CPU_CAPABILITY_AVX2)
+constexpr int64_t kVectorBytes = 32;
+#else
+constexpr int64_t kVectorBytes = 16;
+#endif
+
+// Filters with at most this many coefficients are run by the interleaved
+// kernel below. Higher orders use the scalar loop.
+constexpr int64_t kMaxInterleavedOrder = 9;
+// Number of samples that are transposed into a channels-last tile at a time.
+constexpr int64_t kInterleavedBlock = 64;
+
+// Runs the recurrence of `kLanes` consecutive (batch, channel) rows in
+// lockstep. A block of samples from every row is transposed into a
+// channels-last tile, so that each step of the recurrence is a single
+// vector operation across the lanes, and the filter state stays in
+// registers instead of being reloaded from `padded_output_waveform`.
+// The summation order is the same as the one of `host_lfilter_core_loop`.
+// Row `row` is filtered with the coefficients `row % n_filters`.
+template <typename scalar_t, int64_t kOrder, int64_t kLanes>
+C10_ALWAYS_INLINE void lfilter_interleaved_tile(
+    const scalar_t* input_data,
+    const scalar_t* a_coeff_flipped_data,
+    scalar_t* output_data,
+    int64_t row_begin,
+    int64_t n_rows,
+    int64_t n_filters,
+    int64_t n_samples_input,
+    int64_t n_samples_output,
+    bool reverse) {
+  constexpr int64_t kState = kOrder - 1;
+  const int64_t step = reverse ? -1 : 1;
+  const int64_t input_first = reverse ? n_samples_input - 1 : 0;
+  const int64_t output_first = reverse ? n_samples_output - 1 : 0;
+  scalar_t coeff[kState][kLanes];
+  scalar_t state[kState][kLanes];
+  // Lanes past `n_rows` are never loaded, so they stay at zero.
+  scalar_t tile[kInterleavedBlock][kLanes] = {};
+
+  for (int64_t lane = 0; lane < kLanes; lane++) {
+    const bool valid = lane < n_rows;
+    const int64_t row = row_begin + lane;
+    const scalar_t* a_coeff =
+        a_coeff_flipped_data + (row % n_filters) * kOrder;
+    const scalar_t* history =
+        output_data + row * n_samples_output + output_first;
+    for (int64_t k = 0; k < kState; k++) {
+      coeff[k][lane] = valid ? a_coeff[k] : scalar_t(0);
+      state[k][lane] = valid ? history[k * step] : scalar_t(0);
+    }
+  }
+
+  for (int64_t t0 = 0; t0 < n_samples_input; t0 += kInterleavedBlock) {
+    const int64_t n_block = std::min(kInterleavedBlock, n_samples_input - t0);
+
+    for (int64_t lane = 0; lane < n_rows; lane++) {
+      const scalar_t* x = input_data + (row_begin + lane) * n_samples_input +
+          input_first + t0 * step;
+      for (int64_t t = 0; t < n_block; t++) {
+        tile[t][lane] = x[t * step];
+      }
+    }
+
+    for (int64_t t = 0; t < n_block; t++) {
+      for (int64_t lane = 0; lane < kLanes; lane++) {
+        scalar_t a0 = tile[t][lane];
+        for (int64_t k = 0; k < kState; k++) {
+          a0 -= state[k][lane] * coeff[k][lane];
+        }
+        for (int64_t k = 0; k + 1 < kState; k++) {
+          state[k][lane] = state[k + 1][lane];
+        }
+        state[kState - 1][lane] = a0;
+        tile[t][lane] = a0;
+      }
+    }
+
+    for (int64_t lane = 0; lane < n_rows; lane++) {
+      scalar_t* y = output_data + (row_begin + lane) * n_samples_output +
+          output_first + (kState + t0) * step;
+      for (int64_t t = 0; t < n_block; t++) {
+        y[t * step] = tile[t][lane];
+      }
+    }
+  }
+}
+
+template <typename scalar_t, int64_t kLanes>
+C10_ALWAYS_INLINE void lfilter_interleaved_rows(
+    const scalar_t* input_data,
+    const scalar_t* a_coeff_flipped_data,
+    scalar_t* output_data,
+    int64_t row_begin,
+    int64_t n_rows,
+    int64_t n_filters,
+    int64_t n_samples_input,
+    int64_t n_samples_output,
+    int64_t n_order,
+    bool reverse) {
+#define LFILTER_INTERLEAVED_CASE(ORDER)                     \
+  case ORDER:                                               \
+    lfilter_interleaved_tile<scalar_t, ORDER, kLanes>(      \
+        input_data,                                         \
+        a_coeff_flipped_data,                               \
+        output_data,                                        \
+        row_begin,                                          \
+        n_rows,                                             \
+        n_filters,                                          \
+        n_samples_input,                                    \
+        n_samples_output,                                   \
+        reverse);                                           \
+    break;
+
+  switch (n_order) {
+    LFILTER_INTERLEAVED_CASE(2)
+    LFILTER_INTERLEAVED_CASE(3)
+    LFILTER_INTERLEAVED_CASE(4)
+    LFILTER_INTERLEAVED_CASE(5)
+    LFILTER_INTERLEAVED_CASE(6)
+    LFILTER_INTERLEAVED_CASE(7)
+    LFILTER_INTERLEAVED_CASE(8)
+    LFILTER_INTERLEAVED_CASE(9)
+    default:
+      TORCH_INTERNAL_ASSERT(false, "Unexpected filter order: ", n_order);
+  }
+#undef LFILTER_INTERLEAVED_CASE
+}
+
+// Runs the recurrence of one row over the samples [begin, end) from `state`,
+// which holds the last kState outputs from the oldest one, and leaves the
+// state after `end` in it. The outputs are only written when `write` is true.
+// `x` and `y` point at the first input sample and at the first output sample
+// of the row, which are the last ones when `step` is -1.
+template <typename scalar_t, int64_t kOrder>
+C10_ALWAYS_INLINE void lfilter_scan_chunk(
+    const scalar_t* x,
+    scalar_t* y,
+    const scalar_t* a_coeff,
+    int64_t begin,
+    int64_t end,
+    int64_t step,
+    bool write,
+    scalar_t* state_data) {
+  constexpr int64_t kState = kOrder - 1;
+  scalar_t coeff[kState];
+  scalar_t state[kState];
+  for (int64_t k = 0; k < kState; k++) {
+    coeff[k] = a_coeff[k];
+    state[k] = state_data[k];
+  }
+  for (int64_t t = begin; t < end; t++) {
+    scalar_t a0 = x[t * step];
+    for (int64_t k = 0; k < kState; k++) {
+      a0 -= state[k] * coeff[k];
+    }
+    for (int64_t k = 0; k + 1 < kState; k++) {
+      state[k] = state[k + 1];
+    }
+    state[kState - 1] = a0;
+    if (write) {
+      y[t * step] = a0;
+    }
+  }
+  for (int64_t k = 0; k < kState; k++) {
+    state_data[k] = state[k];
+  }
+}
+
+// Computes the kState x kState matrix which maps the state entering
+// `n_samples` samples of the recurrence with a zero input to the state
+// leaving them, by repeated squaring of the companion matrix of the filter.
+template <typename scalar_t, int64_t kOrder>
+void lfilter_transition_matrix(
+    const scalar_t* a_coeff,
+    int64_t n_samples,
+    scalar_t* output) {
+  constexpr int64_t kState = kOrder - 1;
+  using Matrix = std::array<scalar_t, kState * kState>;
+  auto multiply = [](const Matrix& lhs, const Matrix& rhs) {
+    Matrix product{};
+    for (int64_t i = 0; i < kState; i++) {
+      for (int64_t k = 0; k < kState; k++) {
+        for (int64_t j = 0; j < kState; j++) {
+          product[i * kState + j] += lhs[i * kState + k] * rhs[k * kState + j];
+        }
+      }
+    }
+    return product;
+  };
+
+  // The state is shifted by one sample, and the new output is appended.
+  Matrix step{};
+  for (int64_t k = 0; k + 1 < kState; k++) {
+    step[k * kState + k + 1] = 1;
+  }
+  for (int64_t k = 0; k < kState; k++) {
+    step[(kState - 1) * kState + k] = -a_coeff[k];
+  }
+  Matrix power{};
+  for (int64_t k = 0; k < kState; k++) {
+    power[k * kState + k] = 1;
+  }
+  for (; n_samples > 0; n_samples >>= 1) {
+    if (n_samples & 1) {
+      power = multiply(power, step);
+    }
+    step = multiply(step, step);
+  }
+  std::copy(power.begin(), power.end(), output);
+}
+
+// Runs the recurrence of rows which are too few to keep all the threads
+// busy, with a chunked scan over time, as `overdrive_scan_kernel` does.
+//
+// The recurrence is linear, so the state leaving each chunk filtered from a
+// zero state is first computed in parallel. The states at the boundaries of
+// the chunks are then propagated sequentially with the transition matrix of
+// a chunk, and the chunks are filtered again in parallel from the state
+// entering them. The first chunk starts from the actual state, so it is
+// filtered only once, and the last one only needs the second pass.
+// The outputs are computed in the same order as by the other kernels, only
+// the state entering each chunk is rounded differently.
+template <typename scalar_t, int64_t kOrder>
+void lfilter_scan_rows(
+    const scalar_t* input_data,
+    const scalar_t* a_coeff_flipped_data,
+    scalar_t* output_data,
+    int64_t n_rows,
+    int64_t n_filters,
+    int64_t n_samples_input,
+    int64_t n_samples_output,
+    int64_t n_chunks,
+    bool reverse) {
+  constexpr int64_t kState = kOrder - 1;
+  const int64_t step = reverse ? -1 : 1;
+  const int64_t input_first = reverse ? n_samples_input - 1 : 0;
+  const int64_t output_first = reverse ? n_samples_output - 1 : 0;
+  const int64_t chunk_size = (n_samples_input + n_chunks - 1) / n_chunks;
+
+  // Only the filters of the first `n_rows` rows are used.
+  const int64_t n_used_filters = std::min(n_filters, n_rows);
+  std::vector<scalar_t> transition(n_used_filters * kState * kState);
+  for (int64_t f = 0; f < n_used_filters; f++) {
+    lfilter_transition_matrix<scalar_t, kOrder>(
+        a_coeff_flipped_data + f * kOrder,
+        chunk_size,
+        transition.data() + f * kState * kState);
+  }
+
+  // The state leaving the chunk `c` of the row `row`, at
+  // `(row * n_chunks + c) * kState`.
+  std::vector<scalar_t> chunk_state(n_rows * n_chunks * kState);
+  auto run_chunk = [&](int64_t row, int64_t c, bool write, scalar_t* state) {
+    lfilter_scan_chunk<scalar_t, kOrder>(
+        input_data + row * n_samples_input + input_first,
+        output_data + row * n_samples_output + output_first + kState * step,
+        a_coeff_flipped_data + (row % n_filters) * kOrder,
+        c * chunk_size,
+        std::min((c + 1) * chunk_size, n_samples_input),
+        step,
+        write,
+        state);
+  };
+
+  at::parallel_for(
+      0, n_rows * (n_chunks - 1), 1, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          const int64_t row = i / (n_chunks - 1);
+          const int64_t c = i % (n_chunks - 1);
+          scalar_t* state = chunk_state.data() + (row * n_chunks + c) * kState;
+          if (c == 0) {
+            const scalar_t* history =
+                output_data + row * n_samples_output + output_first;
+            for (int64_t k = 0; k < kState; k++) {
+              state[k] = history[k * step];
+            }
+          }
+          run_chunk(row, c, /*write=*/c == 0, state);
+        }
+      });
+
+  // After this loop, the state leaving each chunk accounts for the state
+  // entering it.
+  for (int64_t row = 0; row < n_rows; row++) {
+    const scalar_t* phi =
+        transition.data() + (row % n_filters) * kState * kState;
+    for (int64_t c = 1; c + 1 < n_chunks; c++) {
+      const scalar_t* incoming =
+          chunk_state.data() + (row * n_chunks + c - 1) * kState;
+      scalar_t* state = chunk_state.data() + (row * n_chunks + c) * kState;
+      for (int64_t i = 0; i < kState; i++) {
+        for (int64_t j = 0; j < kState; j++) {
+          state[i] += phi[i * kState + j] * incoming[j];
+        }
+      }
+    }
+  }
+
+  at::parallel_for(
+      0, n_rows * (n_chunks - 1), 1, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          const int64_t row = i / (n_chunks - 1);
+          const int64_t c = 1 + i % (n_chunks - 1);
+          scalar_t state[kState];
+          std::copy_n(
+              chunk_state.data() + (row * n_chunks + c - 1) * kState,
+              kState,
+              state);
+          run_chunk(row, c, /*write=*/true, state);
+        }
+      });
+}
+
+template <typename scalar_t>
+void lfilter_scan(
+    const scalar_t* input_data,
+    const scalar_t* a_coeff_flipped_data,
+    scalar_t* output_data,
+    int64_t n_rows,
+    int64_t n_filters,
+    int64_t n_samples_input,
+    int64_t n_samples_output,
+    int64_t n_order,
+    int64_t n_chunks,
+    bool reverse) {
+#define LFILTER_SCAN_CASE(ORDER)        \
+  case ORDER:                           \
+    lfilter_scan_rows<scalar_t, ORDER>( \
+        input_data,                     \
+        a_coeff_flipped_data,           \
+        output_data,                    \
+        n_rows,                         \
+        n_filters,                      \
+        n_samples_input,                \
+        n_samples_output,               \
+        n_chunks,                       \
+        reverse);                       \
+    break;
+
+  switch (n_order) {
+    LFILTER_SCAN_CASE(2)
+    LFILTER_SCAN_CASE(3)
+    LFILTER_SCAN_CASE(4)
+    LFILTER_SCAN_CASE(5)
+    LFILTER_SCAN_CASE(6)
+    LFILTER_SCAN_CASE(7)
+    LFILTER_SCAN_CASE(8)
+    LFILTER_SCAN_CASE(9)
+    default:
+      TORCH_INTERNAL_ASSERT(false, "Unexpected filter order: ", n_order);
+  }
+#undef LFILTER_SCAN_CASE
+}
+
+// When `reverse` is true, the recurrence runs from the last sample to the
+// first one, that is, the signal is filtered as if it was time-reversed,
+// without materializing flipped copies. The padding of
+// `padded_output_waveform` is then at the end instead of the beginning.
+//
+// `a_coeff_flipped` is either `(n_channel, n_order)`, shared by the batch,
+// or `(n_batch, n_channel, n_order)`, with one set of filters per example.
+// Either way, the (batch, channel) row `i` uses the filter `i % n_filters`.
+template <typename scalar_t>
+void host_lfilter_core_loop(
+    const torch::Tensor& input_signal_windows,
+    const torch::Tensor& a_coeff_flipped,
+    torch::Tensor& padded_output_waveform,
+    bool reverse) {
+  int64_t n_batch = input_signal_windows.size(0);
+  int64_t n_channel = input_signal_windows.size(1);
+  int64_t n_samples_input = input_signal_windows.size(2);
+  int64_t n_samples_output = padded_output_waveform.size(2);
+  int64_t n_order = a_coeff_flipped.size(-1);
+  int64_t n_filters = a_coeff_flipped.numel() / n_order;
+  scalar_t* output_data = padded_output_waveform.data_ptr<scalar_t>();
+  const scalar_t* input_data = input_signal_windows.data_ptr<scalar_t>();
+  const scalar_t* a_coeff_flipped_data = a_coeff_flipped.data_ptr<scalar_t>();
+
+  if (n_order > 1 && n_order <= kMaxInterleavedOrder) {
+    constexpr int64_t kLanes = kVectorBytes / sizeof(scalar_t);
+    int64_t n_rows = n_channel * n_batch;
+    int64_t n_chunks = lfilter_num_chunks(n_rows, n_samples_input);
+    if (n_chunks > 1) {
+      lfilter_scan<scalar_t>(
+          input_data,
+          a_coeff_flipped_data,
+          output_data,
+          n_rows,
+          n_filters,
+          n_samples_input,
+          n_samples_output,
+          n_order,
+          n_chunks,
+          reverse);
+      return;
+    }
+    int64_t n_tiles = (n_rows + kLanes - 1) / kLanes;
+    at::parallel_for(0, n_tiles, 1, [&](int64_t begin, int64_t end) {
+      for (auto i = begin; i < end; i++) {
+        int64_t row_begin = i * kLanes;
+        lfilter_interleaved_rows<scalar_t, kLanes>(
+            input_data,
+            a_coeff_flipped_data,
+            output_data,
+            row_begin,
+            std::min(kLanes, n_rows - row_begin),
+            n_filters,
+            n_samples_input,
+            n_samples_output,
+            n_order,
+            reverse);
+      }
+    });
+    return;
+  }
+
+  const int64_t step = reverse ? -1 : 1;
+  at::parallel_for(0, n_channel * n_batch, 1, [&](int64_t begin, int64_t end) {
+    for (auto i = begin; i < end; i++) {
+      int64_t offset_input =
+          i * n_samples_input + (reverse ? n_samples_input - 1 : 0);
+      int64_t offset_output =
+          i * n_samples_output + (reverse ? n_samples_output - 1 : 0);
+      int64_t i_filter = i % n_filters;
+      for (int64_t i_sample = 0; i_sample < n_samples_input; i_sample++) {
+        scalar_t a0 = input_data[offset_input + i_sample * step];
+        for (int64_t i_coeff = 0; i_coeff < n_order; i_coeff++) {
+          a0 -= output_data[offset_output + (i_sample + i_coeff) * step] *
+              a_coeff_flipped_data[i_coeff + i_filter * n_order];
+        }
+        output_data[offset_output + (i_sample + n_order - 1) * step] = a0;
+      }
+    }
+  });
+}
+
+void lfilter_core_loop_kernel(
+    const torch::Tensor& input_signal_windows,
+    const torch::Tensor& a_coeff_flipped,
+    torch::Tensor& padded_output_waveform,
+    bool reverse) {
+  AT_DISPATCH_FLOATING_TYPES(
+      input_signal_windows.scalar_type(), "lfilter_core_loop", [&] {
+        host_lfilter_core_loop<scalar_t>(
+            input_signal_windows,
+            a_coeff_flipped,
+            padded_output_waveform,
+            reverse);
+      });
+}
+
+// Evaluates the whole difference equation in direct form II transposed,
+// so that the input is read once and the output is written once, without
+// any intermediate buffer. The coefficients are shared by the batch or given
+// per example, as in `host_lfilter_core_loop`.
+template <typename scalar_t, int64_t kOrder>
+void host_lfilter_fused_loop(
+    const torch::Tensor& waveform,
+    const torch::Tensor& a_coeffs,
+    const torch::Tensor& b_coeffs,
+    torch::Tensor& output) {
+  constexpr int64_t kState = kOrder > 1 ? kOrder - 1 : 1;
+  int64_t n_batch = waveform.size(0);
+  int64_t n_channel = waveform.size(1);
+  int64_t n_sample = waveform.size(2);
+  int64_t n_filters = a_coeffs.numel() / kOrder;
+  const scalar_t* input_data = waveform.data_ptr<scalar_t>();
+  const scalar_t* a_data = a_coeffs.data_ptr<scalar_t>();
+  const scalar_t* b_data = b_coeffs.data_ptr<scalar_t>();
+  scalar_t* output_data = output.data_ptr<scalar_t>();
+
+  std::vector<scalar_t> a_normalized(n_filters * kOrder);
+  std::vector<scalar_t> b_normalized(n_filters * kOrder);
+  for (int64_t i = 0; i < n_filters * kOrder; i++) {
+    scalar_t a0 = a_data[(i / kOrder) * kOrder];
+    a_normalized[i] = a_data[i] / a0;
+    b_normalized[i] = b_data[i] / a0;
+  }
+
+  at::parallel_for(0, n_channel * n_batch, 1, [&](int64_t begin, int64_t end) {
+    for (auto i = begin; i < end; i++) {
+      const scalar_t* a = a_normalized.data() + (i % n_filters) * kOrder;
+      const scalar_t* b = b_normalized.data() + (i % n_filters) * kOrder;
+      const scalar_t* x = input_data + i * n_sample;
+      scalar_t* y = output_data + i * n_sample;
+      scalar_t state[kState] = {};
+      for (int64_t i_sample = 0; i_sample < n_sample; i_sample++) {
+        scalar_t in = x[i_sample];
+        scalar_t out = b[0] * in + state[0];
+        for (int64_t k = 1; k < kOrder - 1; k++) {
+          state[k - 1] = b[k] * in - a[k] * out + state[k];
+        }
+        if (kOrder > 1) {
+          state[kState - 1] = b[kOrder - 1] * in - a[kOrder - 1] * out;
+        }
+        y[i_sample] = out;
+      }
+    }
+  });
+}
+
+void lfilter_fused_kernel(
+    const torch::Tensor& x,
+    const torch::Tensor& a,
+    const torch::Tensor& b,
+    torch::Tensor& output) {
+  int64_t n_order = a.size(-1);
+  AT_DISPATCH_FLOATING_TYPES(x.scalar_type(), "lfilter_fused_loop", [&] {
+    switch (n_order) {
+      case 1:
+        host_lfilter_fused_loop<scalar_t, 1>(x, a, b, output);
+        break;
+      case 2:
+        host_lfilter_fused_loop<scalar_t, 2>(x, a, b, output);
+        break;
+      case 3:
+        host_lfilter_fused_loop<scalar_t, 3>(x, a, b, output);
+        break;
+      case 4:
+        host_lfilter_fused_loop<scalar_t, 4>(x, a, b, output);
+        break;
+      case 5:
+        host_lfilter_fused_loop<scalar_t, 5>(x, a, b, output);
+        break;
+      default:
+        TORCH_INTERNAL_ASSERT(false, "Unexpected filter order: ", n_order);
+    }
+  });
+}
+
+} // namespace
+
+TORCHAUDIO_REGISTER_DISPATCH(lfilter_core_loop_stub, &lfilter_core_loop_kernel);
+TORCHAUDIO_REGISTER_DISPATCH(lfilter_fused_stub, &lfilter_fused_kernel);
+
+} // namespace cpu
+} // namespace torchaudio
@@ -0,0 +1,144 @@
+#include <torchaudio/csrc/cpu/kernels.h>
+#include <torchaudio/csrc/overdrive.h>
+
+// This source is compiled once per instruction set. See `dispatch.h`.
+
+namespace torchaudio {
+namespace cpu {
+namespace {
+
+// Signals with fewer channels than threads and at least this many frames are
+// split along time, so that mono audio can still use all the threads.
+constexpr int64_t kMinScanFrames = 1 << 16;
+// Minimum number of frames of a chunk of the scan.
+constexpr int64_t kMinScanChunk = 64;
+
+// Runs the high-pass recurrence of a single channel with a chunked scan.
+//
+// The recurrence, last_out[n] = temp[n] - temp[n - 1] + p * last_out[n - 1],
+// is linear, so each chunk is first filtered from a zero state in parallel.
+// The state at the chunk boundaries is then propagated sequentially, and
+// the contribution of the incoming state, p^(k + 1) * state, is added back
+// to each chunk in parallel.
+template <typename scalar_t>
+void overdrive_scan_kernel(
+    const scalar_t* waveform_data,
+    const scalar_t* temp_data,
+    scalar_t& last_in,
+    scalar_t& last_out,
+    scalar_t* output_data,
+    int64_t n_frames) {
+  const scalar_t p = 0.995;
+  const int64_t n_chunks = std::max<int64_t>(
+      1, std::min<int64_t>(at::get_num_threads(), n_frames / kMinScanChunk));
+  const int64_t chunk_size = (n_frames + n_chunks - 1) / n_chunks;
+
+  std::vector<scalar_t> chunk_state(n_chunks);
+  at::parallel_for(0, n_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      const int64_t start = c * chunk_size;
+      const int64_t stop = std::min(start + chunk_size, n_frames);
+      scalar_t prev_in = start == 0 ? last_in : temp_data[start - 1];
+      scalar_t state = 0;
+      for (int64_t n = start; n < stop; n++) {
+        state = temp_data[n] - prev_in + p * state;
+        prev_in = temp_data[n];
+        output_data[n] = state;
+      }
+      chunk_state[c] = state;
+    }
+  });
+
+  // After this loop, `chunk_state[c]` holds the state entering chunk `c`.
+  scalar_t carry = last_out;
+  for (int64_t c = 0; c < n_chunks; c++) {
+    const int64_t start = c * chunk_size;
+    const int64_t length = std::max<int64_t>(
+        0, std::min(start + chunk_size, n_frames) - start);
+    scalar_t next = chunk_state[c] +
+        static_cast<scalar_t>(std::pow(p, static_cast<double>(length))) *
+            carry;
+    chunk_state[c] = carry;
+    carry = next;
+  }
+
+  at::parallel_for(0, n_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      const int64_t start = c * chunk_size;
+      const int64_t stop = std::min(start + chunk_size, n_frames);
+      scalar_t correction = chunk_state[c];
+      for (int64_t n = start; n < stop; n++) {
+        correction *= p;
+        output_data[n] = waveform_data[n] * scalar_t(0.5) +
+            (output_data[n] + correction) * scalar_t(0.75);
+      }
+    }
+  });
+
+  last_in = temp_data[n_frames - 1];
+  last_out = carry;
+}
+
+template <typename scalar_t>
+void overdrive_cpu_kernel(
+    const torch::Tensor& waveform,
+    const torch::Tensor& temp,
+    torch::Tensor& last_in,
+    torch::Tensor& last_out,
+    torch::Tensor& output_waveform) {
+  int64_t n_frames = waveform.size(1);
+  int64_t n_channels = waveform.size(0);
+  const scalar_t* waveform_data = waveform.data_ptr<scalar_t>();
+  const scalar_t* temp_data = temp.data_ptr<scalar_t>();
+  scalar_t* last_in_data = last_in.data_ptr<scalar_t>();
+  scalar_t* last_out_data = last_out.data_ptr<scalar_t>();
+  scalar_t* output_data = output_waveform.data_ptr<scalar_t>();
+
+  if (n_frames == 0) {
+    return;
+  }
+
+  if (n_channels < at::get_num_threads() && n_frames >= kMinScanFrames) {
+    for (int64_t i_channel = 0; i_channel < n_channels; ++i_channel) {
+      const int64_t offset = i_channel * n_frames;
+      overdrive_scan_kernel<scalar_t>(
+          waveform_data + offset,
+          temp_data + offset,
+          last_in_data[i_channel],
+          last_out_data[i_channel],
+          output_data + offset,
+          n_frames);
+    }
+    return;
+  }
+
+  // The state of the channels is gathered into a single tensor for the
+  // generic runner, and written back once all the frames are processed.
+  auto state = torch::stack({last_in, last_out}, 1);
+  effects::run_stateful_effect_cpu<scalar_t>(
+      effects::OverdriveEffect<scalar_t>{},
+      {waveform, temp},
+      state,
+      output_waveform);
+  last_in.copy_(state.select(1, 0));
+  last_out.copy_(state.select(1, 1));
+}
+
+void overdrive_kernel(
+    const torch::Tensor& waveform,
+    const torch::Tensor& temp,
+    torch::Tensor& last_in,
+    torch::Tensor& last_out,
+    torch::Tensor& output_waveform) {
+  AT_DISPATCH_FLOATING_TYPES(waveform.scalar_type(), "overdrive_cpu", [&] {
+    overdrive_cpu_kernel<scalar_t>(
+        waveform, temp, last_in, last_out, output_waveform);
+  });
+}
+
+} // namespace
+
+TORCHAUDIO_REGISTER_DISPATCH(overdrive_stub, &overdrive_kernel);
+
+} // namespace cpu
+} // namespace torchaudio
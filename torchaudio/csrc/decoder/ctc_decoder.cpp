@@ -0,0 +1,188 @@
+#include <ATen/Parallel.h>
+#include <torchaudio/csrc/decoder/ctc_decoder.h>
+
+namespace torchaudio {
+namespace decoder {
+
+namespace {
+
+std::shared_ptr<const LanguageModel> LoadLanguageModel(const std::string& lm) {
+  if (lm.empty()) {
+    return nullptr;
+  }
+  return std::make_shared<NGramLanguageModel>(lm);
+}
+
+} // namespace
+
+CTCDecoder::CTCDecoder(
+    std::vector<std::string> tokens,
+    int64_t blank,
+    int64_t word_boundary,
+    int64_t beam_size,
+    int64_t beam_size_token,
+    double beam_threshold,
+    std::string lexicon,
+    std::string lm,
+    double lm_weight,
+    double word_score,
+    int64_t nbest)
+    : CTCDecoder(
+          tokens,
+          blank,
+          word_boundary,
+          beam_size,
+          beam_size_token,
+          beam_threshold,
+          lexicon,
+          LoadLanguageModel(lm),
+          lm_weight,
+          word_score,
+          nbest) {
+  std::get<7>(state_) = std::move(lm);
+  serializable_ = true;
+}
+
+CTCDecoder::CTCDecoder(
+    std::vector<std::string> tokens,
+    int64_t blank,
+    int64_t word_boundary,
+    int64_t beam_size,
+    int64_t beam_size_token,
+    double beam_threshold,
+    std::string lexicon,
+    std::shared_ptr<const LanguageModel> lm,
+    double lm_weight,
+    double word_score,
+    int64_t nbest)
+    : state_(
+          tokens,
+          blank,
+          word_boundary,
+          beam_size,
+          beam_size_token,
+          beam_threshold,
+          lexicon,
+          "",
+          lm_weight,
+          word_score,
+          nbest) {
+  TORCH_CHECK(beam_size_token >= 0, "beam_size_token must be non-negative");
+  CTCPrefixBeamSearchOptions options;
+  options.blank_ = blank;
+  options.wordBoundary_ = word_boundary;
+  options.beamSize_ = beam_size;
+  options.beamSizeToken_ = beam_size_token;
+  options.beamThreshold_ = beam_threshold;
+  options.lmWeight_ = lm_weight;
+  options.wordScore_ = word_score;
+  options.nbest_ = nbest;
+
+  std::shared_ptr<const Lexicon> trie;
+  if (!lexicon.empty()) {
+    TORCH_CHECK(word_boundary >= 0, "A lexicon requires word_boundary");
+    trie = std::make_shared<Lexicon>(lexicon, tokens, word_boundary);
+  }
+  search_ = std::make_unique<CTCPrefixBeamSearch>(
+      options, std::move(tokens), std::move(trie), std::move(lm));
+}
+
+std::vector<std::vector<CTCResult>> CTCDecoder::Decode(
+    const torch::Tensor& emissions,
+    const c10::optional<torch::Tensor>& lengths) const {
+  TORCH_CHECK(emissions.device().is_cpu(), "emissions must be on CPU");
+  TORCH_CHECK(
+      emissions.dtype() == torch::kFloat32, "emissions must be float32 type");
+  TORCH_CHECK(
+      emissions.dim() == 3, "emissions must be 3-D (batch, frame, token)");
+  const auto& tokens = std::get<0>(state_);
+  TORCH_CHECK(
+      emissions.size(2) == static_cast<int64_t>(tokens.size()),
+      "The last dimension of emissions (",
+      emissions.size(2),
+      ") must be the number of tokens (",
+      tokens.size(),
+      ")");
+
+  const int64_t batch_size = emissions.size(0);
+  const int64_t num_frames = emissions.size(1);
+  const torch::Tensor input = emissions.contiguous();
+  torch::Tensor frames;
+  if (lengths.has_value()) {
+    TORCH_CHECK(lengths->dim() == 1, "lengths must be 1-D");
+    TORCH_CHECK(
+        lengths->size(0) == batch_size,
+        "batch dimension mismatch between emissions and lengths");
+    frames = lengths->to(torch::kCPU, torch::kInt64).contiguous();
+    TORCH_CHECK(
+        batch_size == 0 ||
+            (frames.min().item<int64_t>() >= 0 &&
+             frames.max().item<int64_t>() <= num_frames),
+        "lengths must be within [0, emissions.size(1)]");
+  } else {
+    frames = torch::full({batch_size}, num_frames, torch::kInt64);
+  }
+
+  const float* data = input.data_ptr<float>();
+  const int64_t* num_frames_data = frames.data_ptr<int64_t>();
+  const int64_t stride = input.size(2);
+  std::vector<std::vector<CTCHypothesis>> hypos(batch_size);
+  at::parallel_for(0, batch_size, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      hypos[i] = search_->Decode(
+          data + i * num_frames * stride, num_frames_data[i], stride);
+    }
+  });
+
+  std::vector<std::vector<CTCResult>> results(batch_size);
+  for (int64_t i = 0; i < batch_size; ++i) {
+    for (auto& hypo : hypos[i]) {
+      results[i].emplace_back(std::move(hypo.tokens), hypo.score);
+    }
+  }
+  return results;
+}
+
+CTCDecoder::State CTCDecoder::GetState() const {
+  TORCH_CHECK(
+      serializable_,
+      "Decoders with a language model of C++ cannot be serialized");
+  return state_;
+}
+
+TORCH_LIBRARY_FRAGMENT(torchaudio, m) {
+  m.class_<CTCDecoder>("decoder_CTCDecoder")
+      .def(torch::init<
+           std::vector<std::string>,
+           int64_t,
+           int64_t,
+           int64_t,
+           int64_t,
+           double,
+           std::string,
+           std::string,
+           double,
+           double,
+           int64_t>())
+      .def("decode", &CTCDecoder::Decode)
+      .def_pickle(
+          [](const c10::intrusive_ptr<CTCDecoder>& self)
+              -> CTCDecoder::State { return self->GetState(); },
+          [](CTCDecoder::State state) -> c10::intrusive_ptr<CTCDecoder> {
+            return c10::make_intrusive<CTCDecoder>(
+                std::move(std::get<0>(state)),
+                std::get<1>(state),
+                std::get<2>(state),
+                std::get<3>(state),
+                std::get<4>(state),
+                std::get<5>(state),
+                std::move(std::get<6>(state)),
+                std::move(std::get<7>(state)),
+                std::get<8>(state),
+                std::get<9>(state),
+                std::get<10>(state));
+          });
+}
+
+} // namespace decoder
+} // namespace torchaudio
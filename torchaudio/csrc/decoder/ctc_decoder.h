@@ -0,0 +1,83 @@
+#ifndef TORCHAUDIO_DECODER_CTC_DECODER_H
+#define TORCHAUDIO_DECODER_CTC_DECODER_H
+
+#include <torch/script.h>
+#include <torchaudio/csrc/decoder/ctc_prefix_beam_search.h>
+
+namespace torchaudio {
+namespace decoder {
+
+/// Token indices and score of a hypothesis.
+using CTCResult = std::tuple<std::vector<int64_t>, double>;
+
+/// CTC prefix beam search decoder, with an optional lexicon and n-gram
+/// language model, for TorchScript.
+///
+/// The utterances of a batch are decoded in parallel, with
+/// `at::parallel_for`.
+struct CTCDecoder : torch::CustomClassHolder {
+  /// `lexicon` and `lm` are the paths of a lexicon file and of an ARPA
+  /// language model, or empty for none. They require `word_boundary`.
+  /// `beam_size_token` of 0 tries all the tokens at each frame.
+  CTCDecoder(
+      std::vector<std::string> tokens,
+      int64_t blank,
+      int64_t word_boundary,
+      int64_t beam_size,
+      int64_t beam_size_token,
+      double beam_threshold,
+      std::string lexicon,
+      std::string lm,
+      double lm_weight,
+      double word_score,
+      int64_t nbest);
+
+  /// Same as above, with a language model of C++. Such decoders cannot be
+  /// serialized.
+  CTCDecoder(
+      std::vector<std::string> tokens,
+      int64_t blank,
+      int64_t word_boundary,
+      int64_t beam_size,
+      int64_t beam_size_token,
+      double beam_threshold,
+      std::string lexicon,
+      std::shared_ptr<const LanguageModel> lm,
+      double lm_weight,
+      double word_score,
+      int64_t nbest);
+
+  /// Decodes the `(batch, frame, token)` float32 log probabilities of
+  /// `emissions`, of which only the first `lengths[i]` frames of the i-th
+  /// utterance are used, if given. Returns the best hypotheses of each
+  /// utterance, by decreasing score.
+  std::vector<std::vector<CTCResult>> Decode(
+      const torch::Tensor& emissions,
+      const c10::optional<torch::Tensor>& lengths) const;
+
+  using State = std::tuple<
+      std::vector<std::string>,
+      int64_t,
+      int64_t,
+      int64_t,
+      int64_t,
+      double,
+      std::string,
+      std::string,
+      double,
+      double,
+      int64_t>;
+
+  /// The arguments of the constructor, for serialization.
+  State GetState() const;
+
+ private:
+  State state_;
+  bool serializable_ = false;
+  std::unique_ptr<CTCPrefixBeamSearch> search_;
+};
+
+} // namespace decoder
+} // namespace torchaudio
+
+#endif
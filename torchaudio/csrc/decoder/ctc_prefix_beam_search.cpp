@@ -0,0 +1,363 @@
+#include <c10/util/Exception.h>
+#include <torchaudio/csrc/decoder/ctc_prefix_beam_search.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+namespace torchaudio {
+namespace decoder {
+
+namespace {
+
+constexpr double kNegInf = -std::numeric_limits<double>::infinity();
+// The prefix tree is compacted once it has this many nodes, and then again
+// whenever it has doubled since the last compaction.
+constexpr size_t kMinCompactionSize = 1 << 12;
+
+inline double LogAdd(double a, double b) {
+  if (a < b) {
+    std::swap(a, b);
+  }
+  if (b == kNegInf) {
+    return a;
+  }
+  return a + std::log1p(std::exp(b - a));
+}
+
+} // namespace
+
+// The state of one call of Decode: a tree of the prefixes seen so far, and
+// the beam of the current frame.
+struct CTCPrefixBeamSearch::Search {
+  // A prefix: its parent followed by token.
+  struct Node {
+    int parent;
+    int64_t token;
+    // the node of the lexicon reached by the current word.
+    int lexNode;
+    // the context of the language model after the completed words.
+    LanguageModel::State lmState;
+    // the weighted language model and word scores of the completed words.
+    double lmScore;
+    // the current word, spelled out when there is no lexicon.
+    std::string word;
+  };
+
+  // A prefix of the beam, with the log probabilities of the alignments which
+  // end with blank and with its last token.
+  struct Entry {
+    int node;
+    double pb;
+    double pnb;
+
+    double Total() const {
+      return LogAdd(pb, pnb);
+    }
+  };
+
+  const CTCPrefixBeamSearch& s;
+  const CTCPrefixBeamSearchOptions& o;
+  std::vector<Node> nodes;
+  // (parent, token) -> child, or -1 if the child is not a valid prefix.
+  std::unordered_map<int64_t, int> children;
+
+  explicit Search(const CTCPrefixBeamSearch& search)
+      : s(search), o(search.options_) {
+    Node root{-1, -1, Lexicon::kRoot, {}, 0., {}};
+    if (s.lm_) {
+      root.lmState = s.lm_->Start();
+    }
+    nodes.push_back(std::move(root));
+  }
+
+  // Adds the score of word, completed after node, to lmScore and advances
+  // lmState.
+  void ScoreWord(
+      const Node& node,
+      const std::string& word,
+      double* lmScore,
+      LanguageModel::State* lmState) const {
+    *lmScore += o.wordScore_;
+    if (s.lm_) {
+      *lmScore += o.lmWeight_ * s.lm_->Score(node.lmState, word, lmState);
+    }
+  }
+
+  // The child of node by token, node itself if token is a boundary which does
+  // not end a word, or -1 if the lexicon forbids it.
+  int Extend(int node, int64_t token) {
+    const int64_t key = static_cast<int64_t>(node) * s.tokens_.size() + token;
+    const auto it = children.find(key);
+    if (it != children.end()) {
+      return it->second;
+    }
+
+    const Node& parent = nodes[node];
+    if (token == o.wordBoundary_ &&
+        (s.lexicon_ ? parent.lexNode == Lexicon::kRoot : parent.word.empty())) {
+      // Boundaries between words, or before the first one, are silence.
+      children.emplace(key, node);
+      return node;
+    }
+
+    Node child{node, token, parent.lexNode, parent.lmState, parent.lmScore, {}};
+    bool valid = true;
+    if (token == o.wordBoundary_) {
+      if (s.lexicon_) {
+        const int word = s.lexicon_->Word(parent.lexNode);
+        if (word >= 0) {
+          ScoreWord(
+              parent,
+              s.lexicon_->WordString(word),
+              &child.lmScore,
+              &child.lmState);
+        }
+        valid = word >= 0;
+        child.lexNode = Lexicon::kRoot;
+      } else {
+        ScoreWord(parent, parent.word, &child.lmScore, &child.lmState);
+      }
+    } else if (s.lexicon_) {
+      child.lexNode = s.lexicon_->Child(parent.lexNode, token);
+      valid = child.lexNode >= 0;
+    } else if (o.wordBoundary_ >= 0) {
+      child.word = parent.word + s.tokens_[token];
+    }
+
+    int index = -1;
+    if (valid) {
+      index = nodes.size();
+      nodes.push_back(std::move(child));
+    }
+    children.emplace(key, index);
+    return index;
+  }
+
+  // Drops the nodes which are not a prefix of the beam, and their children,
+  // so that the tree does not grow with every prefix ever extended.
+  void Compact(std::vector<Entry>& beam) {
+    const int64_t C = s.tokens_.size();
+    std::vector<bool> live(nodes.size(), false);
+    live[0] = true;
+    for (const Entry& e : beam) {
+      for (int n = e.node; !live[n]; n = nodes[n].parent) {
+        live[n] = true;
+      }
+    }
+    // Parents come before their children, so the nodes are moved in order.
+    std::vector<int> index(nodes.size(), -1);
+    int size = 0;
+    for (size_t n = 0; n < nodes.size(); ++n) {
+      if (!live[n]) {
+        continue;
+      }
+      index[n] = size;
+      Node& node = nodes[n];
+      if (node.parent >= 0) {
+        node.parent = index[node.parent];
+      }
+      if (static_cast<int>(n) != size) {
+        nodes[size] = std::move(node);
+      }
+      ++size;
+    }
+    nodes.erase(nodes.begin() + size, nodes.end());
+
+    std::unordered_map<int64_t, int> kept;
+    for (const auto& item : children) {
+      const int parent = index[item.first / C];
+      const int child = item.second < 0 ? -1 : index[item.second];
+      if (parent >= 0 && (item.second < 0 || child >= 0)) {
+        kept.emplace(parent * C + item.first % C, child);
+      }
+    }
+    children.swap(kept);
+    for (Entry& e : beam) {
+      e.node = index[e.node];
+    }
+  }
+
+  // Keeps the beamSize_ best entries within beamThreshold_ of the best.
+  void Prune(std::vector<Entry>& beam) const {
+    auto score = [&](const Entry& e) {
+      return e.Total() + nodes[e.node].lmScore;
+    };
+    auto better = [&](const Entry& a, const Entry& b) {
+      return score(a) > score(b);
+    };
+    if (static_cast<int>(beam.size()) > o.beamSize_) {
+      std::nth_element(
+          beam.begin(), beam.begin() + o.beamSize_ - 1, beam.end(), better);
+      beam.resize(o.beamSize_);
+    }
+    double best = kNegInf;
+    for (const Entry& e : beam) {
+      best = std::max(best, score(e));
+    }
+    beam.erase(
+        std::remove_if(
+            beam.begin(),
+            beam.end(),
+            [&](const Entry& e) {
+              return score(e) < best - o.beamThreshold_;
+            }),
+        beam.end());
+  }
+
+  std::vector<CTCHypothesis> Run(
+      const float* emissions,
+      int T,
+      int64_t stride) {
+    const int64_t C = s.tokens_.size();
+    const int K = std::min<int64_t>(
+        o.beamSizeToken_ > 0 ? o.beamSizeToken_ : C - 1, C - 1);
+
+    std::vector<Entry> beam = {{0, 0., kNegInf}};
+    std::vector<int64_t> candidates(C - 1);
+    std::unordered_map<int, Entry> next;
+    size_t compactionSize = kMinCompactionSize;
+    for (int t = 0; t < T; ++t) {
+      const float* e = emissions + t * stride;
+
+      // The K best tokens besides blank.
+      for (int64_t c = 0, i = 0; c < C; ++c) {
+        if (c != o.blank_) {
+          candidates[i++] = c;
+        }
+      }
+      std::partial_sort(
+          candidates.begin(),
+          candidates.begin() + K,
+          candidates.end(),
+          [&](int64_t a, int64_t b) { return e[a] > e[b]; });
+
+      next.clear();
+      auto entry = [&](int node) -> Entry& {
+        return next.emplace(node, Entry{node, kNegInf, kNegInf}).first->second;
+      };
+      for (const Entry& prefix : beam) {
+        const double total = prefix.Total();
+        Entry& same = entry(prefix.node);
+        same.pb = LogAdd(same.pb, total + e[o.blank_]);
+        for (int k = 0; k < K; ++k) {
+          const int64_t c = candidates[k];
+          const double ec = e[c];
+          double extend = total + ec;
+          if (c == nodes[prefix.node].token) {
+            // A repeated token only extends the prefix after a blank.
+            Entry& repeat = entry(prefix.node);
+            repeat.pnb = LogAdd(repeat.pnb, prefix.pnb + ec);
+            extend = prefix.pb + ec;
+          }
+          const int child = Extend(prefix.node, c);
+          if (child == prefix.node) {
+            same.pb = LogAdd(same.pb, extend);
+          } else if (child >= 0 && extend != kNegInf) {
+            Entry& extended = entry(child);
+            extended.pnb = LogAdd(extended.pnb, extend);
+          }
+        }
+      }
+
+      beam.clear();
+      for (const auto& item : next) {
+        beam.push_back(item.second);
+      }
+      Prune(beam);
+      if (nodes.size() >= compactionSize) {
+        Compact(beam);
+        compactionSize = std::max(kMinCompactionSize, 2 * nodes.size());
+      }
+    }
+
+    return Finish(beam);
+  }
+
+  // Scores the words in progress and the end of the sentences, and returns
+  // the nbest_ best hypotheses.
+  std::vector<CTCHypothesis> Finish(const std::vector<Entry>& beam) const {
+    std::vector<CTCHypothesis> hypos;
+    for (const Entry& prefix : beam) {
+      const Node& node = nodes[prefix.node];
+      double lmScore = node.lmScore;
+      LanguageModel::State lmState = node.lmState;
+      if (s.lexicon_) {
+        if (node.lexNode != Lexicon::kRoot) {
+          const int word = s.lexicon_->Word(node.lexNode);
+          if (word < 0) {
+            continue;
+          }
+          ScoreWord(node, s.lexicon_->WordString(word), &lmScore, &lmState);
+        }
+      } else if (!node.word.empty()) {
+        ScoreWord(node, node.word, &lmScore, &lmState);
+      }
+      if (s.lm_) {
+        lmScore += o.lmWeight_ * s.lm_->Finish(lmState);
+      }
+
+      CTCHypothesis hypo;
+      hypo.score = prefix.Total() + lmScore;
+      for (int n = prefix.node; n > 0; n = nodes[n].parent) {
+        hypo.tokens.push_back(nodes[n].token);
+      }
+      std::reverse(hypo.tokens.begin(), hypo.tokens.end());
+      hypos.push_back(std::move(hypo));
+    }
+
+    const int nbest = std::min<int>(o.nbest_, hypos.size());
+    std::partial_sort(
+        hypos.begin(),
+        hypos.begin() + nbest,
+        hypos.end(),
+        [](const CTCHypothesis& a, const CTCHypothesis& b) {
+          return a.score > b.score;
+        });
+    hypos.resize(nbest);
+    return hypos;
+  }
+};
+
+CTCPrefixBeamSearch::CTCPrefixBeamSearch(
+    const CTCPrefixBeamSearchOptions& options,
+    std::vector<std::string> tokens,
+    std::shared_ptr<const Lexicon> lexicon,
+    std::shared_ptr<const LanguageModel> lm)
+    : options_(options),
+      tokens_(std::move(tokens)),
+      lexicon_(std::move(lexicon)),
+      lm_(std::move(lm)) {
+  const int64_t C = tokens_.size();
+  TORCH_CHECK(C >= 2, "There must be at least two tokens, including blank");
+  TORCH_CHECK(
+      options_.blank_ >= 0 && options_.blank_ < C,
+      "blank must be within [0, ",
+      C,
+      ")");
+  TORCH_CHECK(
+      options_.wordBoundary_ < C && options_.wordBoundary_ != options_.blank_,
+      "word_boundary must be -1, or within [0, ",
+      C,
+      ") and different from blank");
+  TORCH_CHECK(
+      options_.wordBoundary_ >= 0 || (!lexicon_ && !lm_),
+      "A lexicon or a language model requires word_boundary");
+  TORCH_CHECK(options_.beamSize_ > 0, "beam_size must be positive");
+  TORCH_CHECK(options_.nbest_ > 0, "nbest must be positive");
+  TORCH_CHECK(
+      options_.beamThreshold_ >= 0, "beam_threshold must be non-negative");
+}
+
+std::vector<CTCHypothesis> CTCPrefixBeamSearch::Decode(
+    const float* emissions,
+    int T,
+    int64_t stride) const {
+  Search search(*this);
+  return search.Run(emissions, T, stride);
+}
+
+} // namespace decoder
+} // namespace torchaudio
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <torchaudio/csrc/decoder/language_model.h>
+#include <torchaudio/csrc/decoder/lexicon.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace torchaudio {
+namespace decoder {
+
+typedef struct CTCPrefixBeamSearchOptions {
+  // the index of "blank".
+  int64_t blank_;
+  // the index of the token which ends the words, or -1 if there is none, in
+  // which case there is neither lexicon nor language model.
+  int64_t wordBoundary_;
+  // the number of prefixes kept at each frame.
+  int beamSize_;
+  // the number of tokens, by decreasing emission, tried at each frame besides
+  // blank.
+  int beamSizeToken_;
+  // prefixes whose score is below the best by more than this are dropped.
+  double beamThreshold_;
+  // the weight of the log probabilities of the language model.
+  double lmWeight_;
+  // the score added for each word.
+  double wordScore_;
+  // the number of hypotheses returned.
+  int nbest_;
+
+  CTCPrefixBeamSearchOptions()
+      : blank_(0),
+        wordBoundary_(-1),
+        beamSize_(50),
+        beamSizeToken_(0),
+        beamThreshold_(25.),
+        lmWeight_(0.),
+        wordScore_(0.),
+        nbest_(1) {}
+} CTCPrefixBeamSearchOptions;
+
+struct CTCHypothesis {
+  // the tokens, with the repetitions and blanks collapsed.
+  std::vector<int64_t> tokens;
+  // the log probability of the tokens summed over their alignments, plus the
+  // weighted language model score and the word scores.
+  double score;
+};
+
+// CTC prefix beam search: the prefixes of the beam are extended frame by
+// frame, and the probability of a prefix is the sum over the alignments which
+// collapse to it, split by whether they end with blank.
+//
+// With a lexicon, the prefixes only spell the words of the lexicon, separated
+// by the word boundary token, and the hypotheses which end inside a word are
+// dropped. Without one, the words are the tokens between the boundaries.
+// Boundaries which do not end a word are not part of the hypotheses: they
+// count as blank.
+// The language model scores the words as they are completed.
+//
+// Decode is const, so one search can decode several utterances concurrently.
+class CTCPrefixBeamSearch {
+ public:
+  CTCPrefixBeamSearch(
+      const CTCPrefixBeamSearchOptions& options,
+      std::vector<std::string> tokens,
+      std::shared_ptr<const Lexicon> lexicon = nullptr,
+      std::shared_ptr<const LanguageModel> lm = nullptr);
+
+  // Inputs:
+  //   emissions: (T, C) log probabilities of the tokens, of row stride
+  //     stride.
+  //
+  // Returns the best hypotheses, at most nbest_, by decreasing score.
+  std::vector<CTCHypothesis> Decode(
+      const float* emissions,
+      int T,
+      int64_t stride) const;
+
+ private:
+  struct Search;
+
+  CTCPrefixBeamSearchOptions options_;
+  std::vector<std::string> tokens_;
+  std::shared_ptr<const Lexicon> lexicon_;
+  std::shared_ptr<const LanguageModel> lm_;
+};
+
+} // namespace decoder
+} // namespace torchaudio
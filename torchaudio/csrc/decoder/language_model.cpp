@@ -0,0 +1,212 @@
+#include <c10/util/Exception.h>
+#include <torchaudio/csrc/decoder/language_model.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace torchaudio {
+namespace decoder {
+
+namespace {
+
+// ARPA files hold log10 probabilities.
+const double kLog10 = std::log(10.);
+
+} // namespace
+
+size_t NGramLanguageModel::Hash::operator()(
+    const std::vector<int>& words) const {
+  size_t hash = words.size();
+  for (const int word : words) {
+    hash ^= std::hash<int>()(word) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+  }
+  return hash;
+}
+
+NGramLanguageModel::NGramLanguageModel(const std::string& path) {
+  std::ifstream file(path);
+  TORCH_CHECK(file.is_open(), "Failed to open the language model: ", path);
+
+  std::string line;
+  int lineno = 0;
+  // The order of the section being read, 0 in the header.
+  int order = 0;
+  bool data = false;
+  while (std::getline(file, line)) {
+    ++lineno;
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    if (line.empty()) {
+      continue;
+    }
+    if (line[0] == '\\') {
+      if (line == "\\data\\") {
+        data = true;
+      } else if (line == "\\end\\") {
+        break;
+      } else {
+        int n = 0;
+        TORCH_CHECK(
+            data && std::sscanf(line.c_str(), "\\%d-grams:", &n) == 1 &&
+                n >= 1 && n <= static_cast<int>(ngrams_.size()),
+            "Unexpected section \"",
+            line,
+            "\" (",
+            path,
+            ":",
+            lineno,
+            ")");
+        order = n;
+      }
+      continue;
+    }
+    if (order == 0) {
+      // Header: "ngram <n>=<count>".
+      int n = 0, count = 0;
+      if (data && std::sscanf(line.c_str(), "ngram %d=%d", &n, &count) == 2) {
+        TORCH_CHECK(
+            n >= 1, "Invalid order ", n, " (", path, ":", lineno, ")");
+        if (n > static_cast<int>(ngrams_.size())) {
+          ngrams_.resize(n);
+        }
+        ngrams_[n - 1].reserve(count);
+      }
+      continue;
+    }
+
+    std::istringstream fields(line);
+    Entry entry{0., 0.};
+    TORCH_CHECK(
+        static_cast<bool>(fields >> entry.logProb),
+        "Invalid n-gram \"",
+        line,
+        "\" (",
+        path,
+        ":",
+        lineno,
+        ")");
+    std::vector<int> ngram(order);
+    for (int i = 0; i < order; ++i) {
+      std::string word;
+      TORCH_CHECK(
+          static_cast<bool>(fields >> word),
+          "Expected ",
+          order,
+          " words in \"",
+          line,
+          "\" (",
+          path,
+          ":",
+          lineno,
+          ")");
+      const auto inserted = words_.emplace(word, words_.size());
+      ngram[i] = inserted.first->second;
+    }
+    fields >> entry.backoff; // optional, 0 when absent.
+    entry.logProb *= kLog10;
+    entry.backoff *= kLog10;
+    ngrams_[order - 1][ngram] = entry;
+  }
+  TORCH_CHECK(
+      !ngrams_.empty() && !ngrams_[0].empty(),
+      "No unigrams in the language model: ",
+      path);
+
+  start_ = WordIndex("<s>");
+  end_ = WordIndex("</s>");
+  const auto it = words_.find("<unk>");
+  unknown_ = it == words_.end() ? -1 : it->second;
+}
+
+int NGramLanguageModel::WordIndex(const std::string& word) const {
+  const auto it = words_.find(word);
+  return it == words_.end() ? -1 : it->second;
+}
+
+double NGramLanguageModel::LogProb(std::vector<int> context) const {
+  double backoff = 0.;
+  while (true) {
+    const int n = context.size();
+    if (n <= Order()) {
+      const auto it = ngrams_[n - 1].find(context);
+      if (it != ngrams_[n - 1].end()) {
+        return backoff + it->second.logProb;
+      }
+    }
+    if (n == 1) {
+      return backoff + kUnknownLogProb;
+    }
+    // Back off from w_1 ... w_n to w_2 ... w_n, weighted by the back-off
+    // of w_1 ... w_{n - 1}.
+    if (n - 1 <= Order()) {
+      const std::vector<int> history(context.begin(), context.end() - 1);
+      const auto it = ngrams_[n - 2].find(history);
+      if (it != ngrams_[n - 2].end()) {
+        backoff += it->second.backoff;
+      }
+    }
+    context.erase(context.begin());
+  }
+}
+
+NGramLanguageModel::State NGramLanguageModel::Next(
+    const State& state,
+    int word) const {
+  State next;
+  if (Order() == 1) {
+    return next;
+  }
+  next.reserve(Order() - 1);
+  const int keep = std::min<int>(state.size(), Order() - 2);
+  next.assign(state.end() - keep, state.end());
+  next.push_back(word);
+  // Only a context which starts an n-gram of the model can change the
+  // probabilities of the next words.
+  while (!next.empty()) {
+    const NGrams& ngrams = ngrams_[next.size() - 1];
+    if (ngrams.find(next) != ngrams.end()) {
+      break;
+    }
+    next.erase(next.begin());
+  }
+  return next;
+}
+
+NGramLanguageModel::State NGramLanguageModel::Start() const {
+  return start_ < 0 ? State() : State({start_});
+}
+
+double NGramLanguageModel::Score(
+    const State& state,
+    const std::string& word,
+    State* next) const {
+  int index = WordIndex(word);
+  if (index < 0) {
+    index = unknown_;
+  }
+  if (index < 0) {
+    *next = State();
+    return kUnknownLogProb;
+  }
+  std::vector<int> context(state);
+  context.push_back(index);
+  const double logProb = LogProb(std::move(context));
+  *next = Next(state, index);
+  return logProb;
+}
+
+double NGramLanguageModel::Finish(const State& state) const {
+  if (end_ < 0) {
+    return 0.;
+  }
+  std::vector<int> context(state);
+  context.push_back(end_);
+  return LogProb(std::move(context));
+}
+
+} // namespace decoder
+} // namespace torchaudio
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace torchaudio {
+namespace decoder {
+
+/// Word-level language model scoring the hypotheses of a search. A state is
+/// the context of a hypothesis, as the model encodes it.
+///
+/// The methods are const and must be safe to call concurrently, as the
+/// utterances of a batch are decoded in parallel.
+class LanguageModel {
+ public:
+  using State = std::vector<int>;
+
+  virtual ~LanguageModel() = default;
+
+  /// The state at the start of a sentence.
+  virtual State Start() const = 0;
+  /// The natural log probability of word after state, and the state after it
+  /// in next.
+  virtual double Score(
+      const State& state,
+      const std::string& word,
+      State* next) const = 0;
+  /// The natural log probability of the end of the sentence after state.
+  virtual double Finish(const State& state) const = 0;
+};
+
+/// Back-off n-gram model loaded from an ARPA file. Words not in the model
+/// are scored as "<unk>" when it has it, and with the log probability of
+/// kUnknownLogProb otherwise.
+class NGramLanguageModel : public LanguageModel {
+ public:
+  static constexpr double kUnknownLogProb = -100.;
+
+  explicit NGramLanguageModel(const std::string& path);
+
+  State Start() const override;
+  double Score(const State& state, const std::string& word, State* next)
+      const override;
+  double Finish(const State& state) const override;
+
+  int Order() const {
+    return ngrams_.size();
+  }
+
+ private:
+  struct Entry {
+    double logProb;
+    double backoff;
+  };
+
+  struct Hash {
+    size_t operator()(const std::vector<int>& words) const;
+  };
+  using NGrams = std::unordered_map<std::vector<int>, Entry, Hash>;
+
+  int WordIndex(const std::string& word) const;
+  // The log probability of the last word of context after the others, backing
+  // off to the shorter contexts.
+  double LogProb(std::vector<int> context) const;
+  // The state after word: the longest suffix of state + word, up to Order()
+  // - 1 words, which is the context of an n-gram of the model.
+  State Next(const State& state, int word) const;
+
+  std::unordered_map<std::string, int> words_;
+  // ngrams_[n - 1] holds the n-grams.
+  std::vector<NGrams> ngrams_;
+  int start_;
+  int end_;
+  int unknown_;
+};
+
+} // namespace decoder
+} // namespace torchaudio
@@ -0,0 +1,95 @@
+#include <c10/util/Exception.h>
+#include <torchaudio/csrc/decoder/lexicon.h>
+
+#include <fstream>
+#include <sstream>
+
+namespace torchaudio {
+namespace decoder {
+
+Lexicon::Lexicon() : nodes_(1) {}
+
+Lexicon::Lexicon(
+    const std::string& path,
+    const std::vector<std::string>& tokens,
+    int64_t wordBoundary)
+    : Lexicon() {
+  std::unordered_map<std::string, int64_t> indices;
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    indices.emplace(tokens[i], i);
+  }
+  std::unordered_map<std::string, int> words;
+
+  std::ifstream file(path);
+  TORCH_CHECK(file.is_open(), "Failed to open the lexicon: ", path);
+  std::string line;
+  for (int lineno = 1; std::getline(file, line); ++lineno) {
+    std::istringstream fields(line);
+    std::string word;
+    if (!(fields >> word)) { // empty line.
+      continue;
+    }
+    std::vector<int64_t> spelling;
+    std::string token;
+    while (fields >> token) {
+      const auto it = indices.find(token);
+      TORCH_CHECK(
+          it != indices.end(),
+          "Unknown token \"",
+          token,
+          "\" in the spelling of \"",
+          word,
+          "\" (",
+          path,
+          ":",
+          lineno,
+          ")");
+      spelling.push_back(it->second);
+    }
+    while (!spelling.empty() && spelling.back() == wordBoundary) {
+      spelling.pop_back();
+    }
+    TORCH_CHECK(
+        !spelling.empty(),
+        "No spelling for \"",
+        word,
+        "\" (",
+        path,
+        ":",
+        lineno,
+        ")");
+
+    const auto inserted = words.emplace(word, words_.size());
+    if (inserted.second) {
+      words_.push_back(word);
+    }
+    Add(spelling, inserted.first->second);
+  }
+}
+
+void Lexicon::Add(const std::vector<int64_t>& spelling, int word) {
+  int node = kRoot;
+  for (const int64_t token : spelling) {
+    const auto it = nodes_[node].children.find(token);
+    if (it != nodes_[node].children.end()) {
+      node = it->second;
+      continue;
+    }
+    const int child = nodes_.size();
+    nodes_[node].children.emplace(token, child);
+    nodes_.emplace_back();
+    node = child;
+  }
+  // Homophones keep the first word.
+  if (nodes_[node].word < 0) {
+    nodes_[node].word = word;
+  }
+}
+
+int Lexicon::Child(int node, int64_t token) const {
+  const auto it = nodes_[node].children.find(token);
+  return it == nodes_[node].children.end() ? -1 : it->second;
+}
+
+} // namespace decoder
+} // namespace torchaudio
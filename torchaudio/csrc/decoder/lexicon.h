@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace torchaudio {
+namespace decoder {
+
+/// Trie of the spellings of the words of a lexicon over the indices of the
+/// tokens, so that a prefix of the search is extended only by the tokens
+/// which continue a word.
+class Lexicon {
+ public:
+  static constexpr int kRoot = 0;
+
+  Lexicon();
+
+  /// Loads a lexicon file, of one spelling per line: a word then its tokens,
+  /// separated by spaces (the format of fairseq and flashlight). tokens maps
+  /// the tokens to their indices. The word boundary tokens which end the
+  /// spellings, as in the lexicons of fairseq, are dropped.
+  Lexicon(
+      const std::string& path,
+      const std::vector<std::string>& tokens,
+      int64_t wordBoundary = -1);
+
+  /// Adds a spelling of the word of index word.
+  void Add(const std::vector<int64_t>& spelling, int word);
+
+  /// The node reached from node by token, or -1 if no word continues so.
+  int Child(int node, int64_t token) const;
+  /// The index of the word spelled up to node, or -1 if there is none.
+  int Word(int node) const {
+    return nodes_[node].word;
+  }
+
+  const std::string& WordString(int word) const {
+    return words_[word];
+  }
+  int NumWords() const {
+    return words_.size();
+  }
+
+ private:
+  struct Node {
+    std::unordered_map<int64_t, int> children;
+    int word = -1;
+  };
+
+  std::vector<Node> nodes_;
+  std::vector<std::string> words_;
+};
+
+} // namespace decoder
+} // namespace torchaudio
@@ -0,0 +1,104 @@
+#include <torchaudio/csrc/flanger.h>
+
+namespace torchaudio {
+namespace {
+
+void check_flanger_args(
+    const torch::Tensor& waveform,
+    const torch::Tensor& delay,
+    const torch::Tensor& state) {
+  TORCH_CHECK(waveform.dim() == 2, "waveform must be a 2D tensor");
+  TORCH_CHECK(
+      delay.sizes() == waveform.sizes(),
+      "delay must have the same shape as waveform");
+  TORCH_CHECK(
+      state.dim() == 2 && state.size(1) > 1,
+      "state must be a 2D tensor with a non-empty delay line");
+}
+
+void flanger_core_loop_cpu(
+    const torch::Tensor& waveform,
+    const torch::Tensor& delay,
+    torch::Tensor& state,
+    torch::Tensor& output_waveform,
+    double in_gain,
+    double delay_gain,
+    double feedback_gain,
+    bool quadratic) {
+  check_flanger_args(waveform, delay, state);
+  AT_DISPATCH_FLOATING_TYPES(waveform.scalar_type(), "flanger_cpu", ([&] {
+                               effects::run_stateful_effect_cpu<scalar_t>(
+                                   effects::FlangerEffect<scalar_t>{
+                                       state.size(1) - 1,
+                                       static_cast<scalar_t>(in_gain),
+                                       static_cast<scalar_t>(delay_gain),
+                                       static_cast<scalar_t>(feedback_gain),
+                                       quadratic},
+                                   {waveform, delay},
+                                   state,
+                                   output_waveform);
+                             }));
+}
+
+// Used for the devices that do not have a native kernel.
+void flanger_core_loop_generic(
+    const torch::Tensor& waveform,
+    const torch::Tensor& delay,
+    torch::Tensor& state,
+    torch::Tensor& output_waveform,
+    double in_gain,
+    double delay_gain,
+    double feedback_gain,
+    bool quadratic) {
+  using torch::indexing::Slice;
+  check_flanger_args(waveform, delay, state);
+  const int64_t delay_buf_len = state.size(1) - 1;
+  auto delay_buf = state.narrow(1, 0, delay_buf_len);
+  auto delay_last = state.select(1, delay_buf_len);
+  auto tap = [&](const torch::Tensor& idx) {
+    return delay_buf.gather(1, (idx % delay_buf_len).unsqueeze(1)).squeeze(1);
+  };
+  for (int64_t i = 0; i < waveform.size(1); i++) {
+    const int64_t pos = delay_buf_len - 1 - i % delay_buf_len;
+    const auto x = waveform.index({Slice(), i});
+    const auto delay_i = delay.index({Slice(), i});
+    const auto int_delay = delay_i.floor();
+    const auto frac_delay = delay_i - int_delay;
+    const auto idx = int_delay.to(torch::kInt64) + pos;
+
+    delay_buf.index_put_({Slice(), pos}, x + delay_last * feedback_gain);
+    const auto delayed_0 = tap(idx);
+    auto delayed_1 = tap(idx + 1);
+    torch::Tensor delayed;
+    if (quadratic) {
+      const auto delayed_2 = tap(idx + 2) - delayed_0;
+      delayed_1 = delayed_1 - delayed_0;
+      const auto a = delayed_2 * 0.5 - delayed_1;
+      const auto b = delayed_1 * 2 - delayed_2 * 0.5;
+      delayed = delayed_0 + (a * frac_delay + b) * frac_delay;
+    } else {
+      delayed = delayed_0 + (delayed_1 - delayed_0) * frac_delay;
+    }
+    delay_last.copy_(delayed);
+    output_waveform.index_put_(
+        {Slice(), i}, x * in_gain + delayed * delay_gain);
+  }
+}
+
+} // namespace
+} // namespace torchaudio
+
+TORCH_LIBRARY_FRAGMENT(torchaudio, m) {
+  m.def(
+      "torchaudio::_flanger_core_loop(Tensor waveform, Tensor delay, Tensor(a!) state, Tensor(b!) output_waveform, float in_gain, float delay_gain, float feedback_gain, bool quadratic) -> ()");
+}
+
+TORCH_LIBRARY_IMPL(torchaudio, CPU, m) {
+  m.impl("torchaudio::_flanger_core_loop", &torchaudio::flanger_core_loop_cpu);
+}
+
+TORCH_LIBRARY_IMPL(torchaudio, CompositeExplicitAutograd, m) {
+  m.impl(
+      "torchaudio::_flanger_core_loop",
+      &torchaudio::flanger_core_loop_generic);
+}
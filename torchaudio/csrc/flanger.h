@@ -0,0 +1,64 @@
+#pragma once
+
+#include <torchaudio/csrc/stateful_effect.h>
+
+namespace torchaudio {
+namespace effects {
+
+// Modulated delay line of the flanger effect. The inputs are the dry
+// waveform and the delay read from the LFO, whose integer part is the delay
+// in samples and whose fractional part is used for the interpolation. The
+// LFO phase of each channel is applied when the delays are computed, so the
+// functor does not depend on the channel. The state of a channel is its
+// delay buffer followed by the last delayed sample. The write position only
+// depends on the frame index, and starts from 0 at every call, as at the
+// start of a SoX stream.
+template <typename scalar_t>
+struct FlangerEffect {
+  static constexpr int64_t kNumInputs = 2;
+
+  int64_t delay_buf_len;
+  scalar_t in_gain;
+  scalar_t delay_gain;
+  scalar_t feedback_gain;
+  bool quadratic;
+
+  int64_t state_size() const {
+    return delay_buf_len + 1;
+  }
+
+  TORCHAUDIO_HOST_DEVICE scalar_t operator()(
+      StateView<scalar_t> state,
+      const scalar_t* inputs,
+      int64_t i_frame) const {
+    const int64_t pos = delay_buf_len - 1 - i_frame % delay_buf_len;
+    const scalar_t delay = inputs[1];
+#ifdef __CUDA_ARCH__
+    const scalar_t int_delay = floor(delay);
+#else
+    const scalar_t int_delay = std::floor(delay);
+#endif
+    const scalar_t frac_delay = delay - int_delay;
+    const int64_t idx = pos + static_cast<int64_t>(int_delay);
+
+    state[pos] = inputs[0] + state[delay_buf_len] * feedback_gain;
+    const scalar_t delayed_0 = state[idx % delay_buf_len];
+    scalar_t delayed_1 = state[(idx + 1) % delay_buf_len];
+    scalar_t delayed;
+    if (quadratic) {
+      scalar_t delayed_2 = state[(idx + 2) % delay_buf_len];
+      delayed_2 = delayed_2 - delayed_0;
+      delayed_1 = delayed_1 - delayed_0;
+      const scalar_t a = delayed_2 * scalar_t(0.5) - delayed_1;
+      const scalar_t b = delayed_1 * scalar_t(2) - delayed_2 * scalar_t(0.5);
+      delayed = delayed_0 + (a * frac_delay + b) * frac_delay;
+    } else {
+      delayed = delayed_0 + (delayed_1 - delayed_0) * frac_delay;
+    }
+    state[delay_buf_len] = delayed;
+    return inputs[0] * in_gain + delayed * delay_gain;
+  }
+};
+
+} // namespace effects
+} // namespace torchaudio
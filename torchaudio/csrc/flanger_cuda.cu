@@ -0,0 +1,38 @@
+#include <torchaudio/csrc/flanger.h>
+#include <torchaudio/csrc/stateful_effect_cuda.cuh>
+
+namespace {
+
+void flanger_core_loop_cuda(
+    const torch::Tensor& waveform,
+    const torch::Tensor& delay,
+    torch::Tensor& state,
+    torch::Tensor& output_waveform,
+    double in_gain,
+    double delay_gain,
+    double feedback_gain,
+    bool quadratic) {
+  using namespace torchaudio::effects;
+  TORCH_CHECK(
+      state.dim() == 2 && state.size(1) > 1,
+      "state must be a 2D tensor with a non-empty delay line");
+
+  AT_DISPATCH_FLOATING_TYPES(waveform.scalar_type(), "flanger_cuda", ([&] {
+                               run_stateful_effect_cuda<scalar_t>(
+                                   FlangerEffect<scalar_t>{
+                                       state.size(1) - 1,
+                                       static_cast<scalar_t>(in_gain),
+                                       static_cast<scalar_t>(delay_gain),
+                                       static_cast<scalar_t>(feedback_gain),
+                                       quadratic},
+                                   {waveform, delay},
+                                   state,
+                                   output_waveform);
+                             }));
+}
+
+} // namespace
+
+TORCH_LIBRARY_IMPL(torchaudio, CUDA, m) {
+  m.impl("torchaudio::_flanger_core_loop", &flanger_core_loop_cuda);
+}
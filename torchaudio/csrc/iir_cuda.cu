@@ -0,0 +1,254 @@
+#include <ATen/cuda/CUDAContext.h>
+#include <c10/cuda/CUDAGuard.h>
+#include <torch/script.h>
+#include <torch/torch.h>
+
+namespace {
+
+constexpr int kThreadsPerBlock = 128;
+// Number of samples of each row staged in shared memory at a time by
+// `iir_cu_kernel_fixed_order`.
+constexpr int kTileSamples = 32;
+
+// One thread runs the recurrence of one (batch, channel) row.
+// For small orders the filter state is kept in registers. The rows of the
+// block go through a shared memory tile of `kTileSamples` samples, which the
+// block loads and stores cooperatively, so that the consecutive threads of a
+// warp access consecutive samples of a row instead of samples a row apart.
+// When `reverse` is true, the row is processed from its last sample, and
+// the padding of the output is at the end. The row `row` is filtered with
+// the coefficients `row % n_filters`, so that they are either shared by the
+// batch or given per example.
+template <typename scalar_t, int kOrder>
+__global__ void iir_cu_kernel_fixed_order(
+    const scalar_t* __restrict__ input_data,
+    const scalar_t* __restrict__ a_coeff_flipped_data,
+    scalar_t* __restrict__ output_data,
+    int64_t n_rows,
+    int64_t n_filters,
+    int64_t n_samples_input,
+    int64_t n_samples_output,
+    bool reverse) {
+  constexpr int kState = kOrder - 1;
+  // Padded so that the threads of a warp, which run different rows, access
+  // different banks.
+  __shared__ scalar_t tile[kThreadsPerBlock][kTileSamples + 1];
+
+  const int64_t row_begin =
+      static_cast<int64_t>(blockIdx.x) * kThreadsPerBlock;
+  const int64_t row = row_begin + threadIdx.x;
+  const int n_block_rows = static_cast<int>(
+      min(static_cast<int64_t>(kThreadsPerBlock), n_rows - row_begin));
+  const bool active = row < n_rows;
+
+  scalar_t coeff[kState];
+  scalar_t state[kState];
+  if (active) {
+    const scalar_t* a_coeff =
+        a_coeff_flipped_data + (row % n_filters) * kOrder;
+    const scalar_t* y = output_data + row * n_samples_output +
+        (reverse ? n_samples_output - 1 : 0);
+#pragma unroll
+    for (int k = 0; k < kState; k++) {
+      coeff[k] = a_coeff[k];
+      state[k] = y[reverse ? -k : k];
+    }
+  }
+
+  for (int64_t t0 = 0; t0 < n_samples_input; t0 += kTileSamples) {
+    const int n_tile = static_cast<int>(
+        min(static_cast<int64_t>(kTileSamples), n_samples_input - t0));
+
+    // Sample i of a row is at i, or at n_samples - 1 - i when reversed.
+    for (int i = threadIdx.x; i < n_block_rows * n_tile;
+         i += kThreadsPerBlock) {
+      const int r = i / n_tile;
+      const int c = i % n_tile;
+      const int64_t t = t0 + c;
+      tile[r][c] = input_data
+          [(row_begin + r) * n_samples_input +
+           (reverse ? n_samples_input - 1 - t : t)];
+    }
+    __syncthreads();
+
+    if (active) {
+      scalar_t* v = tile[threadIdx.x];
+      for (int i = 0; i < n_tile; i++) {
+        scalar_t a0 = v[i];
+#pragma unroll
+        for (int k = 0; k < kState; k++) {
+          a0 -= state[k] * coeff[k];
+        }
+#pragma unroll
+        for (int k = 0; k + 1 < kState; k++) {
+          state[k] = state[k + 1];
+        }
+        state[kState - 1] = a0;
+        v[i] = a0;
+      }
+    }
+    __syncthreads();
+
+    // The output of sample i goes after the kState samples of padding.
+    for (int i = threadIdx.x; i < n_block_rows * n_tile;
+         i += kThreadsPerBlock) {
+      const int r = i / n_tile;
+      const int c = i % n_tile;
+      const int64_t t = t0 + c + kState;
+      output_data
+          [(row_begin + r) * n_samples_output +
+           (reverse ? n_samples_output - 1 - t : t)] = tile[r][c];
+    }
+    __syncthreads();
+  }
+}
+
+// Same recurrence as `host_lfilter_core_loop`, for arbitrary orders.
+template <typename scalar_t>
+__global__ void iir_cu_kernel(
+    const scalar_t* __restrict__ input_data,
+    const scalar_t* __restrict__ a_coeff_flipped_data,
+    scalar_t* __restrict__ output_data,
+    int64_t n_rows,
+    int64_t n_filters,
+    int64_t n_samples_input,
+    int64_t n_samples_output,
+    int64_t n_order,
+    bool reverse) {
+  const int64_t row = blockIdx.x * blockDim.x + threadIdx.x;
+  if (row >= n_rows) {
+    return;
+  }
+  const int64_t step = reverse ? -1 : 1;
+  const scalar_t* a_coeff = a_coeff_flipped_data + (row % n_filters) * n_order;
+  const scalar_t* x = input_data + row * n_samples_input +
+      (reverse ? n_samples_input - 1 : 0);
+  scalar_t* y = output_data + row * n_samples_output +
+      (reverse ? n_samples_output - 1 : 0);
+
+  for (int64_t i_sample = 0; i_sample < n_samples_input; i_sample++) {
+    scalar_t a0 = x[i_sample * step];
+    for (int64_t i_coeff = 0; i_coeff < n_order; i_coeff++) {
+      a0 -= y[(i_sample + i_coeff) * step] * a_coeff[i_coeff];
+    }
+    y[(i_sample + n_order - 1) * step] = a0;
+  }
+}
+
+template <typename scalar_t>
+void cuda_lfilter_core_loop_impl(
+    const torch::Tensor& input_signal_windows,
+    const torch::Tensor& a_coeff_flipped,
+    torch::Tensor& padded_output_waveform,
+    bool reverse) {
+  const int64_t n_rows =
+      input_signal_windows.size(0) * input_signal_windows.size(1);
+  const int64_t n_samples_input = input_signal_windows.size(2);
+  const int64_t n_samples_output = padded_output_waveform.size(2);
+  const int64_t n_order = a_coeff_flipped.size(-1);
+  const int64_t n_filters = a_coeff_flipped.numel() / n_order;
+
+  const scalar_t* input_data = input_signal_windows.data_ptr<scalar_t>();
+  const scalar_t* a_coeff_flipped_data = a_coeff_flipped.data_ptr<scalar_t>();
+  scalar_t* output_data = padded_output_waveform.data_ptr<scalar_t>();
+
+  const dim3 threads(kThreadsPerBlock);
+  const dim3 blocks((n_rows + kThreadsPerBlock - 1) / kThreadsPerBlock);
+  auto stream = at::cuda::getCurrentCUDAStream();
+
+#define IIR_CU_FIXED_ORDER_CASE(ORDER)                                  \
+  case ORDER:                                                           \
+    iir_cu_kernel_fixed_order<scalar_t, ORDER>                          \
+        <<<blocks, threads, 0, stream>>>(                               \
+            input_data,                                                 \
+            a_coeff_flipped_data,                                       \
+            output_data,                                                \
+            n_rows,                                                     \
+            n_filters,                                                  \
+            n_samples_input,                                            \
+            n_samples_output,                                           \
+            reverse);                                                   \
+    break;
+
+  switch (n_order) {
+    IIR_CU_FIXED_ORDER_CASE(2)
+    IIR_CU_FIXED_ORDER_CASE(3)
+    IIR_CU_FIXED_ORDER_CASE(4)
+    IIR_CU_FIXED_ORDER_CASE(5)
+    IIR_CU_FIXED_ORDER_CASE(6)
+    IIR_CU_FIXED_ORDER_CASE(7)
+    IIR_CU_FIXED_ORDER_CASE(8)
+    IIR_CU_FIXED_ORDER_CASE(9)
+    default:
+      iir_cu_kernel<scalar_t><<<blocks, threads, 0, stream>>>(
+          input_data,
+          a_coeff_flipped_data,
+          output_data,
+          n_rows,
+          n_filters,
+          n_samples_input,
+          n_samples_output,
+          n_order,
+          reverse);
+  }
+#undef IIR_CU_FIXED_ORDER_CASE
+  C10_CUDA_KERNEL_LAUNCH_CHECK();
+}
+
+void cuda_lfilter_core_loop(
+    const torch::Tensor& input_signal_windows,
+    const torch::Tensor& a_coeff_flipped,
+    torch::Tensor& padded_output_waveform,
+    bool reverse) {
+  TORCH_CHECK(
+      input_signal_windows.device().is_cuda() &&
+      a_coeff_flipped.device().is_cuda() &&
+      padded_output_waveform.device().is_cuda());
+
+  TORCH_CHECK(
+      input_signal_windows.is_contiguous() && a_coeff_flipped.is_contiguous() &&
+      padded_output_waveform.is_contiguous());
+
+  TORCH_CHECK(
+      (input_signal_windows.dtype() == torch::kFloat32 ||
+       input_signal_windows.dtype() == torch::kFloat64) &&
+      (a_coeff_flipped.dtype() == torch::kFloat32 ||
+       a_coeff_flipped.dtype() == torch::kFloat64) &&
+      (padded_output_waveform.dtype() == torch::kFloat32 ||
+       padded_output_waveform.dtype() == torch::kFloat64));
+
+  TORCH_CHECK(input_signal_windows.size(0) == padded_output_waveform.size(0));
+  TORCH_CHECK(input_signal_windows.size(1) == padded_output_waveform.size(1));
+
+  TORCH_CHECK(
+      (a_coeff_flipped.dim() == 2 &&
+       a_coeff_flipped.size(0) == input_signal_windows.size(1)) ||
+      (a_coeff_flipped.dim() == 3 &&
+       a_coeff_flipped.size(0) == input_signal_windows.size(0) &&
+       a_coeff_flipped.size(1) == input_signal_windows.size(1)));
+
+  TORCH_CHECK(
+      input_signal_windows.size(2) + a_coeff_flipped.size(-1) - 1 ==
+      padded_output_waveform.size(2));
+
+  if (input_signal_windows.numel() == 0) {
+    return;
+  }
+
+  const c10::cuda::CUDAGuard device_guard(input_signal_windows.device());
+
+  AT_DISPATCH_FLOATING_TYPES(
+      input_signal_windows.scalar_type(), "lfilter_core_loop", [&] {
+        cuda_lfilter_core_loop_impl<scalar_t>(
+            input_signal_windows,
+            a_coeff_flipped,
+            padded_output_waveform,
+            reverse);
+      });
+}
+
+} // namespace
+
+TORCH_LIBRARY_IMPL(torchaudio, CUDA, m) {
+  m.impl("torchaudio::_lfilter_core_loop", &cuda_lfilter_core_loop);
+}
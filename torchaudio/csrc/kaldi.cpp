@@ -1,32 +1,102 @@
-#include <torch/script.h>
-#include "feat/pitch-functions.h"
+#include <ATen/record_function.h>
+#include <torchaudio/csrc/kaldi.h>
 
 namespace torchaudio {
 namespace kaldi {
 
 namespace {
 
-torch::Tensor denormalize(const torch::Tensor& t) {
-  auto ret = t;
-  auto pos = t > 0, neg = t < 0;
-  ret.index_put({pos}, t.index({pos}) * 32767);
-  ret.index_put({neg}, t.index({neg}) * 32768);
-  return ret;
+// Kaldi's float type expects value range of int16 expressed as float, so the
+// samples are scaled while they are copied into Kaldi's input vector.
+void denormalize(
+    const float* src,
+    int64_t num_samples,
+    ::kaldi::Vector<::kaldi::BaseFloat>* dst) {
+  dst->Resize(num_samples, ::kaldi::kUndefined);
+  ::kaldi::BaseFloat* data = dst->Data();
+  for (int64_t i = 0; i < num_samples; ++i) {
+    data[i] = src[i] * (src[i] > 0 ? 32767.f : 32768.f);
+  }
 }
 
-torch::Tensor compute_kaldi_pitch(
+// Computes the pitch of each row of `wave`, or of its first `lengths[i]`
+// samples, into a single `(batch, frames, 2)` tensor, where `frames` is the
+// longest output. The frames past the end of a shorter output are zero.
+//
+// The number of frames of an utterance is only known once Kaldi has
+// resampled it, so the workers first run Kaldi on their rows, reusing one
+// input buffer across rows, and then copy the results into the output,
+// which is allocated once.
+std::tuple<torch::Tensor, torch::Tensor> compute_kaldi_pitch_batch(
     const torch::Tensor& wave,
+    const c10::optional<torch::Tensor>& lengths,
     const ::kaldi::PitchExtractionOptions& opts) {
-  ::kaldi::VectorBase<::kaldi::BaseFloat> input(wave);
-  ::kaldi::Matrix<::kaldi::BaseFloat> output;
-  ::kaldi::ComputeKaldiPitch(opts, input, &output);
-  return output.tensor_;
-}
+  TORCH_CHECK(wave.ndimension() == 2, "Input tensor must be 2 dimentional.");
+  TORCH_CHECK(wave.device().is_cpu(), "Input tensor must be on CPU.");
+  TORCH_CHECK(
+      wave.dtype() == torch::kFloat32, "Input tensor must be float32 type.");
 
-} // namespace
+  const auto wave_ = wave.contiguous();
+  const int64_t batch_size = wave_.size(0);
+  const int64_t num_samples = wave_.size(1);
+  const float* wave_data = wave_.data_ptr<float>();
 
-torch::Tensor ComputeKaldiPitch(
-    const torch::Tensor& wave,
+  torch::Tensor lengths_;
+  const int64_t* lengths_data = nullptr;
+  if (lengths.has_value()) {
+    TORCH_CHECK(
+        lengths->ndimension() == 1 && lengths->size(0) == batch_size,
+        "lengths must be a 1D tensor with one value per waveform.");
+    lengths_ = lengths->to(torch::kCPU, torch::kInt64).contiguous();
+    lengths_data = lengths_.data_ptr<int64_t>();
+    for (int64_t i = 0; i < batch_size; ++i) {
+      TORCH_CHECK(
+          lengths_data[i] >= 0 && lengths_data[i] <= num_samples,
+          "lengths must be in the range of [0, ",
+          num_samples,
+          "]. Found: ",
+          lengths_data[i]);
+    }
+  }
+
+  std::vector<::kaldi::Matrix<::kaldi::BaseFloat>> results(batch_size);
+  at::parallel_for(0, batch_size, 1, [&](int64_t begin, int64_t end) {
+    ::kaldi::Vector<::kaldi::BaseFloat> input;
+    for (auto i = begin; i < end; ++i) {
+      const int64_t length = lengths_data ? lengths_data[i] : num_samples;
+      RECORD_FUNCTION(
+          "torchaudio::kaldi::ComputeKaldiPitch",
+          std::vector<c10::IValue>({length}));
+      denormalize(wave_data + i * num_samples, length, &input);
+      ::kaldi::ComputeKaldiPitch(opts, input, &results[i]);
+    }
+  });
+
+  auto num_frames = torch::empty({batch_size}, torch::kInt64);
+  int64_t* num_frames_data = num_frames.data_ptr<int64_t>();
+  int64_t max_frames = 0;
+  for (int64_t i = 0; i < batch_size; ++i) {
+    num_frames_data[i] = results[i].NumRows();
+    max_frames = std::max(max_frames, num_frames_data[i]);
+  }
+
+  auto output = torch::empty({batch_size, max_frames, 2}, torch::kFloat32);
+  float* output_data = output.data_ptr<float>();
+  at::parallel_for(0, batch_size, 1, [&](int64_t begin, int64_t end) {
+    for (auto i = begin; i < end; ++i) {
+      const auto& result = results[i];
+      float* out = output_data + i * max_frames * 2;
+      for (int64_t f = 0; f < result.NumRows(); ++f) {
+        out[f * 2] = result(f, 0);
+        out[f * 2 + 1] = result(f, 1);
+      }
+      std::fill(out + result.NumRows() * 2, out + max_frames * 2, 0.f);
+    }
+  });
+  return std::make_tuple(output, num_frames);
+}
+
+::kaldi::PitchExtractionOptions make_pitch_options(
     double sample_frequency,
     double frame_length,
     double frame_shift,
@@ -45,11 +115,6 @@ torch::Tensor ComputeKaldiPitch(
     bool simulate_first_pass_online,
     int64_t recompute_frame,
     bool snip_edges) {
-  TORCH_CHECK(wave.ndimension() == 2, "Input tensor must be 2 dimentional.");
-  TORCH_CHECK(wave.device().is_cpu(), "Input tensor must be on CPU.");
-  TORCH_CHECK(
-      wave.dtype() == torch::kFloat32, "Input tensor must be float32 type.");
-
   ::kaldi::PitchExtractionOptions opts;
   opts.samp_freq = static_cast<::kaldi::BaseFloat>(sample_frequency);
   opts.frame_shift_ms = static_cast<::kaldi::BaseFloat>(frame_shift);
@@ -61,6 +126,7 @@ torch::Tensor ComputeKaldiPitch(
   opts.lowpass_cutoff = static_cast<::kaldi::BaseFloat>(lowpass_cutoff);
   opts.resample_freq = static_cast<::kaldi::BaseFloat>(resample_frequency);
   opts.delta_pitch = static_cast<::kaldi::BaseFloat>(delta_pitch);
+  opts.nccf_ballast = static_cast<::kaldi::BaseFloat>(nccf_ballast);
   opts.lowpass_filter_width = static_cast<::kaldi::int32>(lowpass_filter_width);
   opts.upsample_filter_width =
       static_cast<::kaldi::int32>(upsample_filter_width);
@@ -69,24 +135,208 @@ torch::Tensor ComputeKaldiPitch(
   opts.simulate_first_pass_online = simulate_first_pass_online;
   opts.recompute_frame = static_cast<::kaldi::int32>(recompute_frame);
   opts.snip_edges = snip_edges;
+  return opts;
+}
 
-  // Kaldi's float type expects value range of int16 expressed as float
-  torch::Tensor wave_ = denormalize(wave);
+} // namespace
 
-  auto batch_size = wave_.size(0);
-  std::vector<torch::Tensor> results(batch_size);
-  at::parallel_for(0, batch_size, 1, [&](int64_t begin, int64_t end) {
-    for (auto i = begin; i < end; ++i) {
-      results[i] = compute_kaldi_pitch(wave_.index({i}), opts);
-    }
-  });
-  return torch::stack(results, 0);
+torch::Tensor ComputeKaldiPitch(
+    const torch::Tensor& wave,
+    double sample_frequency,
+    double frame_length,
+    double frame_shift,
+    double min_f0,
+    double max_f0,
+    double soft_min_f0,
+    double penalty_factor,
+    double lowpass_cutoff,
+    double resample_frequency,
+    double delta_pitch,
+    double nccf_ballast,
+    int64_t lowpass_filter_width,
+    int64_t upsample_filter_width,
+    int64_t max_frames_latency,
+    int64_t frames_per_chunk,
+    bool simulate_first_pass_online,
+    int64_t recompute_frame,
+    bool snip_edges) {
+  const auto opts = make_pitch_options(
+      sample_frequency,
+      frame_length,
+      frame_shift,
+      min_f0,
+      max_f0,
+      soft_min_f0,
+      penalty_factor,
+      lowpass_cutoff,
+      resample_frequency,
+      delta_pitch,
+      nccf_ballast,
+      lowpass_filter_width,
+      upsample_filter_width,
+      max_frames_latency,
+      frames_per_chunk,
+      simulate_first_pass_online,
+      recompute_frame,
+      snip_edges);
+  return std::get<0>(compute_kaldi_pitch_batch(wave, c10::nullopt, opts));
+}
+
+std::tuple<torch::Tensor, torch::Tensor> ComputeKaldiPitchWithLengths(
+    const torch::Tensor& wave,
+    const torch::Tensor& lengths,
+    double sample_frequency,
+    double frame_length,
+    double frame_shift,
+    double min_f0,
+    double max_f0,
+    double soft_min_f0,
+    double penalty_factor,
+    double lowpass_cutoff,
+    double resample_frequency,
+    double delta_pitch,
+    double nccf_ballast,
+    int64_t lowpass_filter_width,
+    int64_t upsample_filter_width,
+    int64_t max_frames_latency,
+    int64_t frames_per_chunk,
+    bool simulate_first_pass_online,
+    int64_t recompute_frame,
+    bool snip_edges) {
+  const auto opts = make_pitch_options(
+      sample_frequency,
+      frame_length,
+      frame_shift,
+      min_f0,
+      max_f0,
+      soft_min_f0,
+      penalty_factor,
+      lowpass_cutoff,
+      resample_frequency,
+      delta_pitch,
+      nccf_ballast,
+      lowpass_filter_width,
+      upsample_filter_width,
+      max_frames_latency,
+      frames_per_chunk,
+      simulate_first_pass_online,
+      recompute_frame,
+      snip_edges);
+  return compute_kaldi_pitch_batch(wave, lengths, opts);
+}
+
+OnlinePitchFeature::OnlinePitchFeature(
+    double sample_frequency,
+    double frame_length,
+    double frame_shift,
+    double min_f0,
+    double max_f0,
+    double soft_min_f0,
+    double penalty_factor,
+    double lowpass_cutoff,
+    double resample_frequency,
+    double delta_pitch,
+    double nccf_ballast,
+    int64_t lowpass_filter_width,
+    int64_t upsample_filter_width,
+    int64_t max_frames_latency,
+    int64_t frames_per_chunk,
+    bool simulate_first_pass_online,
+    int64_t recompute_frame,
+    bool snip_edges)
+    : opts_(make_pitch_options(
+          sample_frequency,
+          frame_length,
+          frame_shift,
+          min_f0,
+          max_f0,
+          soft_min_f0,
+          penalty_factor,
+          lowpass_cutoff,
+          resample_frequency,
+          delta_pitch,
+          nccf_ballast,
+          lowpass_filter_width,
+          upsample_filter_width,
+          max_frames_latency,
+          frames_per_chunk,
+          simulate_first_pass_online,
+          recompute_frame,
+          snip_edges)),
+      pitch_(new ::kaldi::OnlinePitchFeature(opts_)) {}
+
+void OnlinePitchFeature::AcceptWaveform(const torch::Tensor& chunk) {
+  TORCH_CHECK(chunk.ndimension() == 1, "Input tensor must be 1 dimentional.");
+  TORCH_CHECK(chunk.device().is_cpu(), "Input tensor must be on CPU.");
+  TORCH_CHECK(
+      chunk.dtype() == torch::kFloat32, "Input tensor must be float32 type.");
+  TORCH_CHECK(
+      !input_finished_,
+      "accept_waveform cannot be called after input_finished.");
+
+  const auto chunk_ = chunk.contiguous();
+  ::kaldi::Vector<::kaldi::BaseFloat> input;
+  denormalize(chunk_.data_ptr<float>(), chunk_.numel(), &input);
+  pitch_->AcceptWaveform(opts_.samp_freq, input);
+}
+
+void OnlinePitchFeature::InputFinished() {
+  if (!input_finished_) {
+    pitch_->InputFinished();
+    input_finished_ = true;
+  }
+}
+
+int64_t OnlinePitchFeature::NumFramesReady() const {
+  return pitch_->NumFramesReady();
+}
+
+torch::Tensor OnlinePitchFeature::GetFrames() {
+  const int64_t num_frames = pitch_->NumFramesReady();
+  const int64_t num_new =
+      std::max<int64_t>(num_frames - num_frames_output_, 0);
+  torch::Tensor output =
+      torch::empty({num_new, pitch_->Dim()}, torch::kFloat32);
+  ::kaldi::MatrixBase<::kaldi::BaseFloat> frames(output);
+  for (int64_t i = 0; i < num_new; ++i) {
+    ::kaldi::SubVector<::kaldi::BaseFloat> frame(frames, i);
+    pitch_->GetFrame(num_frames_output_ + i, &frame);
+  }
+  num_frames_output_ += num_new;
+  return output;
 }
 
 TORCH_LIBRARY_FRAGMENT(torchaudio, m) {
   m.def(
       "torchaudio::kaldi_ComputeKaldiPitch",
       &torchaudio::kaldi::ComputeKaldiPitch);
+  m.def(
+      "torchaudio::kaldi_ComputeKaldiPitchWithLengths",
+      &torchaudio::kaldi::ComputeKaldiPitchWithLengths);
+  m.class_<OnlinePitchFeature>("kaldi_OnlinePitchFeature")
+      .def(torch::init<
+           double,
+           double,
+           double,
+           double,
+           double,
+           double,
+           double,
+           double,
+           double,
+           double,
+           double,
+           int64_t,
+           int64_t,
+           int64_t,
+           int64_t,
+           bool,
+           int64_t,
+           bool>())
+      .def("accept_waveform", &OnlinePitchFeature::AcceptWaveform)
+      .def("input_finished", &OnlinePitchFeature::InputFinished)
+      .def("num_frames_ready", &OnlinePitchFeature::NumFramesReady)
+      .def("get_frames", &OnlinePitchFeature::GetFrames);
 }
 
 } // namespace kaldi
@@ -0,0 +1,165 @@
+#ifndef TORCHAUDIO_KALDI_H
+#define TORCHAUDIO_KALDI_H
+
+#include <torch/script.h>
+#include "feat/pitch-functions.h"
+
+namespace torchaudio {
+namespace kaldi {
+
+torch::Tensor ComputeKaldiPitch(
+    const torch::Tensor& wave,
+    double sample_frequency,
+    double frame_length,
+    double frame_shift,
+    double min_f0,
+    double max_f0,
+    double soft_min_f0,
+    double penalty_factor,
+    double lowpass_cutoff,
+    double resample_frequency,
+    double delta_pitch,
+    double nccf_ballast,
+    int64_t lowpass_filter_width,
+    int64_t upsample_filter_width,
+    int64_t max_frames_latency,
+    int64_t frames_per_chunk,
+    bool simulate_first_pass_online,
+    int64_t recompute_frame,
+    bool snip_edges);
+
+/// Same as `ComputeKaldiPitch`, but only the first `lengths[i]` samples of
+/// the i-th waveform are used. The output is padded with zeros to the
+/// longest utterance, and the number of frames of each utterance is
+/// returned along with it.
+std::tuple<torch::Tensor, torch::Tensor> ComputeKaldiPitchWithLengths(
+    const torch::Tensor& wave,
+    const torch::Tensor& lengths,
+    double sample_frequency,
+    double frame_length,
+    double frame_shift,
+    double min_f0,
+    double max_f0,
+    double soft_min_f0,
+    double penalty_factor,
+    double lowpass_cutoff,
+    double resample_frequency,
+    double delta_pitch,
+    double nccf_ballast,
+    int64_t lowpass_filter_width,
+    int64_t upsample_filter_width,
+    int64_t max_frames_latency,
+    int64_t frames_per_chunk,
+    bool simulate_first_pass_online,
+    int64_t recompute_frame,
+    bool snip_edges);
+
+/// Kaldi-compatible log mel filter bank features of each row of a 2D float32
+/// tensor, as a `(batch, frames, num_mel_bins + use_energy)` tensor.
+/// The options and the result are the same as the ones of
+/// `torchaudio.compliance.kaldi.fbank`, without dithering.
+torch::Tensor ComputeFbank(
+    const torch::Tensor& wave,
+    double sample_frequency,
+    double blackman_coeff,
+    double energy_floor,
+    double frame_length,
+    double frame_shift,
+    double high_freq,
+    bool htk_compat,
+    double low_freq,
+    int64_t num_mel_bins,
+    double preemphasis_coefficient,
+    bool raw_energy,
+    bool remove_dc_offset,
+    bool round_to_power_of_two,
+    bool snip_edges,
+    bool subtract_mean,
+    bool use_energy,
+    bool use_log_fbank,
+    bool use_power,
+    double vtln_high,
+    double vtln_low,
+    double vtln_warp,
+    const std::string& window_type);
+
+/// Kaldi-compatible MFCC features of each row of a 2D float32 tensor, as a
+/// `(batch, frames, num_ceps)` tensor.
+/// The options and the result are the same as the ones of
+/// `torchaudio.compliance.kaldi.mfcc`, without dithering.
+torch::Tensor ComputeMfcc(
+    const torch::Tensor& wave,
+    double sample_frequency,
+    double blackman_coeff,
+    double cepstral_lifter,
+    double energy_floor,
+    double frame_length,
+    double frame_shift,
+    double high_freq,
+    bool htk_compat,
+    double low_freq,
+    int64_t num_ceps,
+    int64_t num_mel_bins,
+    double preemphasis_coefficient,
+    bool raw_energy,
+    bool remove_dc_offset,
+    bool round_to_power_of_two,
+    bool snip_edges,
+    bool subtract_mean,
+    bool use_energy,
+    double vtln_high,
+    double vtln_low,
+    double vtln_warp,
+    const std::string& window_type);
+
+/// Incremental pitch extraction on top of Kaldi's OnlinePitchFeature.
+///
+/// Audio is fed chunk by chunk with `AcceptWaveform`, and `GetFrames` returns
+/// the frames which became ready since the previous call, so the cost of a
+/// call only depends on the amount of new audio. Frames are not revised once
+/// returned; `max_frames_latency` sets how many frames are held back so that
+/// the pitch traceback can settle. After `InputFinished`, `GetFrames` returns
+/// the remaining frames, and the concatenation of all the frames matches
+/// `ComputeKaldiPitch` when no frames were taken before the end.
+struct OnlinePitchFeature : torch::CustomClassHolder {
+  OnlinePitchFeature(
+      double sample_frequency,
+      double frame_length,
+      double frame_shift,
+      double min_f0,
+      double max_f0,
+      double soft_min_f0,
+      double penalty_factor,
+      double lowpass_cutoff,
+      double resample_frequency,
+      double delta_pitch,
+      double nccf_ballast,
+      int64_t lowpass_filter_width,
+      int64_t upsample_filter_width,
+      int64_t max_frames_latency,
+      int64_t frames_per_chunk,
+      bool simulate_first_pass_online,
+      int64_t recompute_frame,
+      bool snip_edges);
+
+  /// Feeds a 1D float32 chunk in the range of [-1, 1].
+  void AcceptWaveform(const torch::Tensor& chunk);
+  /// Signals the end of the audio, so that the last frames become ready.
+  void InputFinished();
+  /// Total number of frames ready, including the ones already returned.
+  int64_t NumFramesReady() const;
+  /// Returns the frames ready since the previous call, as a
+  /// `(frames, 2)` tensor of NCCF and pitch.
+  torch::Tensor GetFrames();
+
+ private:
+  ::kaldi::PitchExtractionOptions opts_;
+  std::unique_ptr<::kaldi::OnlinePitchFeature> pitch_;
+  int64_t num_frames_output_ = 0;
+  bool input_finished_ = false;
+};
+
+} // namespace kaldi
+} // namespace torchaudio
+
+#endif
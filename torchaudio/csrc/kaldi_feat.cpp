@@ -0,0 +1,886 @@
+#include <torchaudio/csrc/kaldi.h>
+
+#include <cmath>
+#include <complex>
+#include <limits>
+
+// Kaldi-compatible filter bank and MFCC features.
+//
+// The computation follows `torchaudio.compliance.kaldi` (which in turn follows
+// Kaldi's feature-window.cc, mel-computations.cc, feature-fbank.cc and
+// feature-mfcc.cc), but it is done one frame at a time: the window is
+// extracted, pre-processed, transformed and reduced to mel energies while it
+// is hot in cache, and the frames of the whole batch are spread over the
+// threads with `at::parallel_for`.
+
+namespace torchaudio {
+namespace kaldi {
+
+namespace {
+
+constexpr float kEpsilon = std::numeric_limits<float>::epsilon();
+
+struct FrameOptions {
+  double sample_frequency;
+  int64_t window_size;
+  int64_t window_shift;
+  int64_t padded_window_size;
+  double blackman_coeff;
+  double energy_floor;
+  double preemphasis_coefficient;
+  bool raw_energy;
+  bool remove_dc_offset;
+  bool snip_edges;
+  std::string window_type;
+};
+
+struct MelOptions {
+  int64_t num_bins;
+  double low_freq;
+  double high_freq;
+  double vtln_low;
+  double vtln_high;
+  double vtln_warp;
+};
+
+int64_t next_power_of_2(int64_t x) {
+  int64_t n = 1;
+  while (n < x) {
+    n <<= 1;
+  }
+  return n;
+}
+
+FrameOptions make_frame_options(
+    double sample_frequency,
+    double blackman_coeff,
+    double energy_floor,
+    double frame_length,
+    double frame_shift,
+    double preemphasis_coefficient,
+    bool raw_energy,
+    bool remove_dc_offset,
+    bool round_to_power_of_two,
+    bool snip_edges,
+    const std::string& window_type) {
+  TORCH_CHECK(
+      sample_frequency > 0, "`sample_frequency` must be greater than zero");
+  FrameOptions opts;
+  opts.sample_frequency = sample_frequency;
+  opts.window_shift =
+      static_cast<int64_t>(sample_frequency * frame_shift * 0.001);
+  opts.window_size =
+      static_cast<int64_t>(sample_frequency * frame_length * 0.001);
+  opts.padded_window_size = round_to_power_of_two
+      ? next_power_of_2(opts.window_size)
+      : opts.window_size;
+  opts.blackman_coeff = blackman_coeff;
+  opts.energy_floor = energy_floor;
+  opts.preemphasis_coefficient = preemphasis_coefficient;
+  opts.raw_energy = raw_energy;
+  opts.remove_dc_offset = remove_dc_offset;
+  opts.snip_edges = snip_edges;
+  opts.window_type = window_type;
+
+  TORCH_CHECK(
+      opts.window_size >= 2,
+      "choose a window size ",
+      opts.window_size,
+      " that is at least 2");
+  TORCH_CHECK(opts.window_shift > 0, "`window_shift` must be greater than 0");
+  TORCH_CHECK(
+      opts.padded_window_size % 2 == 0,
+      "the padded `window_size` must be divisible by two."
+      " use `round_to_power_of_two` or change `frame_length`");
+  TORCH_CHECK(
+      0. <= preemphasis_coefficient && preemphasis_coefficient <= 1.,
+      "`preemphasis_coefficient` must be between [0,1]");
+  TORCH_CHECK(energy_floor >= 0., "`energy_floor` must not be negative");
+  TORCH_CHECK(
+      window_type == "hamming" || window_type == "hanning" ||
+          window_type == "povey" || window_type == "rectangular" ||
+          window_type == "blackman",
+      "Invalid window type ",
+      window_type);
+  return opts;
+}
+
+// Same as NumFrames in Kaldi's feature-window.cc
+int64_t num_frames(int64_t num_samples, const FrameOptions& opts) {
+  if (opts.snip_edges) {
+    if (num_samples < opts.window_size) {
+      return 0;
+    }
+    return 1 + (num_samples - opts.window_size) / opts.window_shift;
+  }
+  return (num_samples + opts.window_shift / 2) / opts.window_shift;
+}
+
+std::vector<float> feature_window(const FrameOptions& opts) {
+  const int64_t n = opts.window_size;
+  const double a = 2 * M_PI / (n - 1);
+  std::vector<float> window(n);
+  for (int64_t i = 0; i < n; ++i) {
+    double w = 1.;
+    if (opts.window_type == "hanning") {
+      w = 0.5 - 0.5 * std::cos(a * i);
+    } else if (opts.window_type == "hamming") {
+      w = 0.54 - 0.46 * std::cos(a * i);
+    } else if (opts.window_type == "povey") {
+      // like hanning but goes to zero at edges
+      w = std::pow(0.5 - 0.5 * std::cos(a * i), 0.85);
+    } else if (opts.window_type == "blackman") {
+      w = opts.blackman_coeff - 0.5 * std::cos(a * i) +
+          (0.5 - opts.blackman_coeff) * std::cos(2 * a * i);
+    }
+    window[i] = static_cast<float>(w);
+  }
+  return window;
+}
+
+double mel_scale(double freq) {
+  return 1127.0 * std::log(1.0 + freq / 700.0);
+}
+
+double inverse_mel_scale(double mel_freq) {
+  return 700.0 * (std::exp(mel_freq / 1127.0) - 1.0);
+}
+
+// Same as VtlnWarpFreq in Kaldi's mel-computations.cc
+double vtln_warp_freq(
+    double vtln_low_cutoff,
+    double vtln_high_cutoff,
+    double low_freq,
+    double high_freq,
+    double vtln_warp_factor,
+    double freq) {
+  if (freq < low_freq || freq > high_freq) {
+    return freq;
+  }
+  const double l = vtln_low_cutoff * std::max(1.0, vtln_warp_factor);
+  const double h = vtln_high_cutoff * std::min(1.0, vtln_warp_factor);
+  const double scale = 1.0 / vtln_warp_factor;
+  const double Fl = scale * l;
+  const double Fh = scale * h;
+  TORCH_CHECK(l > low_freq && h < high_freq);
+  if (freq < l) {
+    const double scale_left = (Fl - low_freq) / (l - low_freq);
+    return low_freq + scale_left * (freq - low_freq);
+  }
+  if (freq < h) {
+    return scale * freq;
+  }
+  const double scale_right = (high_freq - Fh) / (high_freq - h);
+  return high_freq + scale_right * (freq - high_freq);
+}
+
+// The non-zero part of the triangular filter of a mel bin.
+struct MelBin {
+  int64_t offset;
+  std::vector<float> weights;
+};
+
+// Same as `get_mel_banks` in torchaudio.compliance.kaldi. The FFT bin at the
+// Nyquist frequency never has a weight.
+std::vector<MelBin> mel_banks(
+    const MelOptions& opts,
+    int64_t padded_window_size,
+    double sample_frequency) {
+  TORCH_CHECK(opts.num_bins > 3, "Must have at least 3 mel bins");
+  const int64_t num_fft_bins = padded_window_size / 2;
+  const double nyquist = 0.5 * sample_frequency;
+  const double low_freq = opts.low_freq;
+  const double high_freq =
+      opts.high_freq <= 0.0 ? opts.high_freq + nyquist : opts.high_freq;
+  TORCH_CHECK(
+      0.0 <= low_freq && low_freq < nyquist && 0.0 < high_freq &&
+          high_freq <= nyquist && low_freq < high_freq,
+      "Bad values in options: low-freq ",
+      low_freq,
+      " and high-freq ",
+      high_freq,
+      " vs. nyquist ",
+      nyquist);
+
+  const double fft_bin_width = sample_frequency / padded_window_size;
+  const double mel_low_freq = mel_scale(low_freq);
+  const double mel_high_freq = mel_scale(high_freq);
+  // divide by num_bins+1 because of end-effects where the bins spread out to
+  // the sides.
+  const double mel_freq_delta =
+      (mel_high_freq - mel_low_freq) / (opts.num_bins + 1);
+
+  const double vtln_low = opts.vtln_low;
+  const double vtln_high =
+      opts.vtln_high < 0.0 ? opts.vtln_high + nyquist : opts.vtln_high;
+  const bool warp = opts.vtln_warp != 1.0;
+  TORCH_CHECK(
+      !warp ||
+          (low_freq < vtln_low && vtln_low < high_freq && 0.0 < vtln_high &&
+           vtln_high < high_freq && vtln_low < vtln_high),
+      "Bad values in options: vtln-low ",
+      vtln_low,
+      " and vtln-high ",
+      vtln_high,
+      ", versus low-freq ",
+      low_freq,
+      " and high-freq ",
+      high_freq);
+  auto warp_mel = [&](double mel_freq) {
+    if (!warp) {
+      return mel_freq;
+    }
+    return mel_scale(vtln_warp_freq(
+        vtln_low,
+        vtln_high,
+        low_freq,
+        high_freq,
+        opts.vtln_warp,
+        inverse_mel_scale(mel_freq)));
+  };
+
+  std::vector<double> fft_mel(num_fft_bins);
+  for (int64_t k = 0; k < num_fft_bins; ++k) {
+    fft_mel[k] = mel_scale(fft_bin_width * k);
+  }
+
+  std::vector<MelBin> bins(opts.num_bins);
+  std::vector<float> weights(num_fft_bins);
+  for (int64_t b = 0; b < opts.num_bins; ++b) {
+    const double left_mel = warp_mel(mel_low_freq + b * mel_freq_delta);
+    const double center_mel = warp_mel(mel_low_freq + (b + 1) * mel_freq_delta);
+    const double right_mel = warp_mel(mel_low_freq + (b + 2) * mel_freq_delta);
+    int64_t first = -1, last = -1;
+    for (int64_t k = 0; k < num_fft_bins; ++k) {
+      const double mel = fft_mel[k];
+      const double up_slope = (mel - left_mel) / (center_mel - left_mel);
+      const double down_slope = (right_mel - mel) / (right_mel - center_mel);
+      double weight = 0.0;
+      if (!warp) {
+        weight = std::max(0.0, std::min(up_slope, down_slope));
+      } else if (mel > left_mel && mel <= center_mel) {
+        weight = up_slope;
+      } else if (mel > center_mel && mel < right_mel) {
+        weight = down_slope;
+      }
+      weights[k] = static_cast<float>(weight);
+      if (weight != 0.0) {
+        if (first < 0) {
+          first = k;
+        }
+        last = k;
+      }
+    }
+    if (first >= 0) {
+      bins[b].offset = first;
+      bins[b].weights.assign(
+          weights.begin() + first, weights.begin() + last + 1);
+    } else {
+      bins[b].offset = 0;
+    }
+  }
+  return bins;
+}
+
+// Real-input FFT, reduced to the power (or magnitude) spectrum. A power of two
+// size goes through an in-place radix-2 complex FFT of half the size. Other
+// even sizes go through a mixed-radix (Stockham) complex FFT of half the
+// size, and odd sizes through one of the full size, unless a large prime
+// factor makes it slower than a direct DFT with a precomputed table.
+class RealFft {
+ public:
+  explicit RealFft(int64_t n) : n_(n), half_(n / 2) {
+    pow2_ = (n & (n - 1)) == 0;
+    size_ = pow2_ || n % 2 == 0 ? half_ : n;
+    const int64_t table_size = pow2_ ? half_ : n;
+    twiddles_.resize(table_size);
+    for (int64_t k = 0; k < table_size; ++k) {
+      const double angle = -2 * M_PI * k / n;
+      twiddles_[k] = {
+          static_cast<float>(std::cos(angle)),
+          static_cast<float>(std::sin(angle))};
+    }
+    if (pow2_) {
+      bit_reversed_.resize(half_);
+      int64_t log2 = 0;
+      while ((int64_t{1} << log2) < half_) {
+        ++log2;
+      }
+      for (int64_t k = 0; k < half_; ++k) {
+        int64_t r = 0;
+        for (int64_t b = 0; b < log2; ++b) {
+          r |= ((k >> b) & 1) << (log2 - 1 - b);
+        }
+        bit_reversed_[k] = r;
+      }
+    } else {
+      // Radix 4 first, then the prime factors.
+      int64_t m = size_;
+      while (m % 4 == 0) {
+        radices_.push_back(4);
+        m /= 4;
+      }
+      for (int64_t p = 2; m > 1; ++p) {
+        while (m % p == 0) {
+          radices_.push_back(p);
+          m /= p;
+        }
+        if (p * p > m && m > 1) {
+          radices_.push_back(m);
+          break;
+        }
+      }
+      // A stage of radix r costs about r complex multiplications per value,
+      // and the direct DFT half a complex multiplication per input and bin.
+      int64_t cost = 0;
+      for (const int64_t r : radices_) {
+        cost += 2 * r * size_;
+      }
+      if (cost >= n_ * (half_ + 1)) {
+        radices_.clear();
+      }
+    }
+  }
+
+  // The number of complex values of the `work` buffer of `Spectrum`.
+  int64_t WorkSize() const {
+    return pow2_ ? half_ : 2 * size_;
+  }
+
+  // Writes `n / 2 + 1` values of |X[k]|^2 (or |X[k]| unless `use_power`) of
+  // the `n` samples of `in` into `out`. `work` must hold `WorkSize()` values.
+  void Spectrum(
+      const float* in,
+      float* out,
+      std::complex<float>* work,
+      bool use_power) const {
+    if (pow2_) {
+      fft_spectrum(in, out, work);
+    } else if (!radices_.empty()) {
+      mixed_radix_spectrum(in, out, work);
+    } else {
+      dft_spectrum(in, out);
+    }
+    if (!use_power) {
+      for (int64_t k = 0; k <= half_; ++k) {
+        out[k] = std::sqrt(out[k]);
+      }
+    }
+  }
+
+ private:
+  void fft_spectrum(const float* in, float* out, std::complex<float>* a)
+      const {
+    using complex = std::complex<float>;
+    const int64_t m = half_;
+    // Pack the even samples into the real part and the odd samples into the
+    // imaginary part, then run an in-place radix-2 FFT of size m.
+    for (int64_t k = 0; k < m; ++k) {
+      a[bit_reversed_[k]] = complex(in[2 * k], in[2 * k + 1]);
+    }
+    for (int64_t len = 2; len <= m; len <<= 1) {
+      const int64_t half_len = len / 2;
+      const int64_t stride = 2 * (m / len);
+      for (int64_t i = 0; i < m; i += len) {
+        for (int64_t j = 0; j < half_len; ++j) {
+          const complex u = a[i + j];
+          const complex v = a[i + j + half_len] * twiddles_[j * stride];
+          a[i + j] = u + v;
+          a[i + j + half_len] = u - v;
+        }
+      }
+    }
+    // Split the transform of the packed sequence into the ones of the even
+    // and the odd samples and combine them.
+    const float dc = a[0].real() + a[0].imag();
+    const float nyquist = a[0].real() - a[0].imag();
+    out[0] = dc * dc;
+    out[m] = nyquist * nyquist;
+    for (int64_t k = 1; k < m; ++k) {
+      const complex z = a[k];
+      const complex zc = std::conj(a[m - k]);
+      const complex even = 0.5f * (z + zc);
+      const complex odd = complex(0.f, -0.5f) * (z - zc);
+      out[k] = std::norm(even + twiddles_[k] * odd);
+    }
+  }
+
+  // Complex FFT of the `size_` values of `x`, using `y` as a buffer of the
+  // same size. Returns the buffer which holds the result. The butterflies of
+  // radix 2 and 4 are unrolled, the other radices are direct DFTs, so a size
+  // with a large prime factor is slower.
+  std::complex<float>* stockham(std::complex<float>* x, std::complex<float>* y)
+      const {
+    using complex = std::complex<float>;
+    // W_size^k is W_n^(k * scale), and all the exponents below are less than
+    // n.
+    const int64_t scale = n_ / size_;
+    const std::complex<float>* w = twiddles_.data();
+    // Decimation in frequency: a stage of radix r splits each transform of
+    // length len into r transforms of length m = len / r. The values of the
+    // transforms are interleaved with `stride`, and W_len is W_size^stride.
+    int64_t stride = 1;
+    for (const int64_t r : radices_) {
+      const int64_t m = size_ / (stride * r);
+      const int64_t step = stride * scale;
+      for (int64_t p = 0; p < m; ++p) {
+        const complex* in = x + stride * p;
+        complex* out = y + stride * r * p;
+        for (int64_t q = 0; q < stride; ++q) {
+          if (r == 2) {
+            const complex a0 = in[q], a1 = in[q + stride * m];
+            out[q] = a0 + a1;
+            out[q + stride] = (a0 - a1) * w[p * step];
+          } else if (r == 4) {
+            const complex a0 = in[q], a1 = in[q + stride * m];
+            const complex a2 = in[q + 2 * stride * m];
+            const complex a3 = in[q + 3 * stride * m];
+            const complex s0 = a0 + a2, d0 = a0 - a2, s1 = a1 + a3;
+            // -i * (a1 - a3)
+            const complex d1(a1.imag() - a3.imag(), a3.real() - a1.real());
+            out[q] = s0 + s1;
+            out[q + stride] = (d0 + d1) * w[p * step];
+            out[q + 2 * stride] = (s0 - s1) * w[2 * p * step];
+            out[q + 3 * stride] = (d0 - d1) * w[3 * p * step];
+          } else {
+            for (int64_t k = 0; k < r; ++k) {
+              // W_r^(j * k) is W_n^(j * k % r * m * step).
+              complex sum = in[q];
+              for (int64_t j = 1, jk = k; j < r; ++j) {
+                sum += in[q + j * stride * m] * w[jk * m * step];
+                jk += k;
+                if (jk >= r) {
+                  jk -= r;
+                }
+              }
+              out[q + k * stride] = sum * w[p * k * step];
+            }
+          }
+        }
+      }
+      std::swap(x, y);
+      stride *= r;
+    }
+    return x;
+  }
+
+  void mixed_radix_spectrum(
+      const float* in,
+      float* out,
+      std::complex<float>* work) const {
+    using complex = std::complex<float>;
+    if (size_ == n_) {
+      for (int64_t k = 0; k < n_; ++k) {
+        work[k] = complex(in[k], 0.f);
+      }
+      const complex* x = stockham(work, work + size_);
+      for (int64_t k = 0; k <= half_; ++k) {
+        out[k] = std::norm(x[k]);
+      }
+      return;
+    }
+    // Same packing of the even and odd samples as `fft_spectrum`.
+    const int64_t m = size_;
+    for (int64_t k = 0; k < m; ++k) {
+      work[k] = complex(in[2 * k], in[2 * k + 1]);
+    }
+    const complex* a = stockham(work, work + m);
+    const float dc = a[0].real() + a[0].imag();
+    const float nyquist = a[0].real() - a[0].imag();
+    out[0] = dc * dc;
+    out[m] = nyquist * nyquist;
+    for (int64_t k = 1; k < m; ++k) {
+      const complex z = a[k];
+      const complex zc = std::conj(a[m - k]);
+      const complex even = 0.5f * (z + zc);
+      const complex odd = complex(0.f, -0.5f) * (z - zc);
+      out[k] = std::norm(even + twiddles_[k] * odd);
+    }
+  }
+
+  void dft_spectrum(const float* in, float* out) const {
+    for (int64_t k = 0; k <= half_; ++k) {
+      float re = 0.f, im = 0.f;
+      int64_t index = 0;
+      for (int64_t i = 0; i < n_; ++i) {
+        re += in[i] * twiddles_[index].real();
+        im += in[i] * twiddles_[index].imag();
+        index += k;
+        if (index >= n_) {
+          index -= n_;
+        }
+      }
+      out[k] = re * re + im * im;
+    }
+  }
+
+  int64_t n_;
+  int64_t half_;
+  bool pow2_;
+  // The size of the complex FFT.
+  int64_t size_;
+  std::vector<std::complex<float>> twiddles_;
+  std::vector<int64_t> bit_reversed_;
+  std::vector<int64_t> radices_;
+};
+
+// Per-thread buffers of MelComputer.
+struct MelWorkspace {
+  std::vector<float> frame;
+  std::vector<float> spectrum;
+  std::vector<std::complex<float>> fft;
+};
+
+// Turns a frame of the waveform into its log energy and its mel energies.
+class MelComputer {
+ public:
+  MelComputer(
+      const FrameOptions& frame_opts,
+      const MelOptions& mel_opts,
+      bool use_power)
+      : opts_(frame_opts),
+        window_(feature_window(frame_opts)),
+        fft_(frame_opts.padded_window_size),
+        bins_(mel_banks(
+            mel_opts,
+            frame_opts.padded_window_size,
+            frame_opts.sample_frequency)),
+        use_power_(use_power),
+        log_energy_floor_(
+            frame_opts.energy_floor == 0.
+                ? -std::numeric_limits<float>::infinity()
+                : static_cast<float>(std::log(frame_opts.energy_floor))) {}
+
+  int64_t NumBins() const {
+    return bins_.size();
+  }
+
+  int64_t NumFrames(int64_t num_samples) const {
+    return num_frames(num_samples, opts_);
+  }
+
+  MelWorkspace MakeWorkspace() const {
+    MelWorkspace ws;
+    ws.frame.resize(opts_.padded_window_size);
+    ws.spectrum.resize(opts_.padded_window_size / 2 + 1);
+    ws.fft.resize(fft_.WorkSize());
+    return ws;
+  }
+
+  // Computes the mel energies of the frame `f` of `wave` into `mel`, and
+  // returns the log energy of the frame.
+  float Compute(
+      const float* wave,
+      int64_t num_samples,
+      int64_t f,
+      MelWorkspace* ws,
+      float* mel) const {
+    const int64_t size = opts_.window_size;
+    float* frame = ws->frame.data();
+    extract_window(wave, num_samples, f, frame);
+
+    if (opts_.remove_dc_offset) {
+      double sum = 0.;
+      for (int64_t i = 0; i < size; ++i) {
+        sum += frame[i];
+      }
+      const float mean = static_cast<float>(sum / size);
+      for (int64_t i = 0; i < size; ++i) {
+        frame[i] -= mean;
+      }
+    }
+    float log_energy = 0.f;
+    if (opts_.raw_energy) {
+      log_energy = compute_log_energy(frame);
+    }
+    if (opts_.preemphasis_coefficient != 0.) {
+      const float coeff = static_cast<float>(opts_.preemphasis_coefficient);
+      for (int64_t i = size - 1; i > 0; --i) {
+        frame[i] -= coeff * frame[i - 1];
+      }
+      frame[0] -= coeff * frame[0];
+    }
+    for (int64_t i = 0; i < size; ++i) {
+      frame[i] *= window_[i];
+    }
+    std::fill(frame + size, frame + opts_.padded_window_size, 0.f);
+    if (!opts_.raw_energy) {
+      log_energy = compute_log_energy(frame);
+    }
+
+    float* spectrum = ws->spectrum.data();
+    fft_.Spectrum(frame, spectrum, ws->fft.data(), use_power_);
+    for (size_t b = 0; b < bins_.size(); ++b) {
+      const auto& bin = bins_[b];
+      const float* s = spectrum + bin.offset;
+      float energy = 0.f;
+      for (size_t k = 0; k < bin.weights.size(); ++k) {
+        energy += bin.weights[k] * s[k];
+      }
+      mel[b] = energy;
+    }
+    return log_energy;
+  }
+
+ private:
+  // Same as ExtractWindow in Kaldi's feature-window.cc
+  void extract_window(
+      const float* wave,
+      int64_t num_samples,
+      int64_t f,
+      float* frame) const {
+    const int64_t size = opts_.window_size;
+    const int64_t start = opts_.snip_edges
+        ? f * opts_.window_shift
+        : f * opts_.window_shift + opts_.window_shift / 2 - size / 2;
+    if (start >= 0 && start + size <= num_samples) {
+      std::copy(wave + start, wave + start + size, frame);
+      return;
+    }
+    // Reflect the data at the ends.
+    for (int64_t i = 0; i < size; ++i) {
+      int64_t s = start + i;
+      while (s < 0 || s >= num_samples) {
+        s = s < 0 ? -s - 1 : 2 * num_samples - 1 - s;
+      }
+      frame[i] = wave[s];
+    }
+  }
+
+  float compute_log_energy(const float* frame) const {
+    double energy = 0.;
+    for (int64_t i = 0; i < opts_.window_size; ++i) {
+      energy += frame[i] * frame[i];
+    }
+    const float log_energy =
+        std::log(std::max(static_cast<float>(energy), kEpsilon));
+    return std::max(log_energy, log_energy_floor_);
+  }
+
+  FrameOptions opts_;
+  std::vector<float> window_;
+  RealFft fft_;
+  std::vector<MelBin> bins_;
+  bool use_power_;
+  float log_energy_floor_;
+};
+
+// Runs `fn(mel, log_energy, out)` on every frame of every row of `wave`, and
+// returns the resulting `(batch, frames, feature_dim)` tensor. `fn` may
+// overwrite the mel energies.
+template <typename Fn>
+torch::Tensor compute_mel_features(
+    const torch::Tensor& wave,
+    const MelComputer& computer,
+    int64_t feature_dim,
+    bool subtract_mean,
+    const Fn& fn) {
+  TORCH_CHECK(wave.ndimension() == 2, "Input tensor must be 2 dimentional.");
+  TORCH_CHECK(wave.device().is_cpu(), "Input tensor must be on CPU.");
+  TORCH_CHECK(
+      wave.dtype() == torch::kFloat32, "Input tensor must be float32 type.");
+
+  const auto wave_ = wave.contiguous();
+  const int64_t batch_size = wave_.size(0);
+  const int64_t num_samples = wave_.size(1);
+  const int64_t frames = computer.NumFrames(num_samples);
+  const float* wave_data = wave_.data_ptr<float>();
+
+  auto output = torch::empty({batch_size, frames, feature_dim}, torch::kFloat32);
+  float* output_data = output.data_ptr<float>();
+  // Frames are independent, so the frames of all the rows are split together,
+  // which keeps the threads busy on a batch of one long utterance too.
+  at::parallel_for(0, batch_size * frames, 16, [&](int64_t begin, int64_t end) {
+    auto ws = computer.MakeWorkspace();
+    std::vector<float> mel(computer.NumBins());
+    for (auto i = begin; i < end; ++i) {
+      const float* row = wave_data + (i / frames) * num_samples;
+      const float log_energy =
+          computer.Compute(row, num_samples, i % frames, &ws, mel.data());
+      fn(mel.data(), log_energy, output_data + i * feature_dim);
+    }
+  });
+
+  if (subtract_mean && frames > 0) {
+    at::parallel_for(0, batch_size, 1, [&](int64_t begin, int64_t end) {
+      std::vector<double> mean(feature_dim);
+      for (auto b = begin; b < end; ++b) {
+        float* out = output_data + b * frames * feature_dim;
+        std::fill(mean.begin(), mean.end(), 0.);
+        for (int64_t f = 0; f < frames; ++f) {
+          for (int64_t d = 0; d < feature_dim; ++d) {
+            mean[d] += out[f * feature_dim + d];
+          }
+        }
+        for (int64_t f = 0; f < frames; ++f) {
+          for (int64_t d = 0; d < feature_dim; ++d) {
+            out[f * feature_dim + d] -= static_cast<float>(mean[d] / frames);
+          }
+        }
+      }
+    });
+  }
+  return output;
+}
+
+} // namespace
+
+torch::Tensor ComputeFbank(
+    const torch::Tensor& wave,
+    double sample_frequency,
+    double blackman_coeff,
+    double energy_floor,
+    double frame_length,
+    double frame_shift,
+    double high_freq,
+    bool htk_compat,
+    double low_freq,
+    int64_t num_mel_bins,
+    double preemphasis_coefficient,
+    bool raw_energy,
+    bool remove_dc_offset,
+    bool round_to_power_of_two,
+    bool snip_edges,
+    bool subtract_mean,
+    bool use_energy,
+    bool use_log_fbank,
+    bool use_power,
+    double vtln_high,
+    double vtln_low,
+    double vtln_warp,
+    const std::string& window_type) {
+  const auto frame_opts = make_frame_options(
+      sample_frequency,
+      blackman_coeff,
+      energy_floor,
+      frame_length,
+      frame_shift,
+      preemphasis_coefficient,
+      raw_energy,
+      remove_dc_offset,
+      round_to_power_of_two,
+      snip_edges,
+      window_type);
+  const MelOptions mel_opts{
+      num_mel_bins, low_freq, high_freq, vtln_low, vtln_high, vtln_warp};
+  const MelComputer computer(frame_opts, mel_opts, use_power);
+
+  const int64_t feature_dim = num_mel_bins + (use_energy ? 1 : 0);
+  // The energy is the first feature, or the last one with `htk_compat`.
+  const int64_t mel_offset = use_energy && !htk_compat ? 1 : 0;
+  const int64_t energy_index = htk_compat ? num_mel_bins : 0;
+  return compute_mel_features(
+      wave,
+      computer,
+      feature_dim,
+      subtract_mean,
+      [&](float* mel, float log_energy, float* out) {
+        for (int64_t b = 0; b < num_mel_bins; ++b) {
+          out[mel_offset + b] =
+              use_log_fbank ? std::log(std::max(mel[b], kEpsilon)) : mel[b];
+        }
+        if (use_energy) {
+          out[energy_index] = log_energy;
+        }
+      });
+}
+
+torch::Tensor ComputeMfcc(
+    const torch::Tensor& wave,
+    double sample_frequency,
+    double blackman_coeff,
+    double cepstral_lifter,
+    double energy_floor,
+    double frame_length,
+    double frame_shift,
+    double high_freq,
+    bool htk_compat,
+    double low_freq,
+    int64_t num_ceps,
+    int64_t num_mel_bins,
+    double preemphasis_coefficient,
+    bool raw_energy,
+    bool remove_dc_offset,
+    bool round_to_power_of_two,
+    bool snip_edges,
+    bool subtract_mean,
+    bool use_energy,
+    double vtln_high,
+    double vtln_low,
+    double vtln_warp,
+    const std::string& window_type) {
+  TORCH_CHECK(
+      0 < num_ceps && num_ceps <= num_mel_bins,
+      "num_ceps must be in the range of [1, num_mel_bins]: ",
+      num_ceps,
+      " vs ",
+      num_mel_bins);
+  const auto frame_opts = make_frame_options(
+      sample_frequency,
+      blackman_coeff,
+      energy_floor,
+      frame_length,
+      frame_shift,
+      preemphasis_coefficient,
+      raw_energy,
+      remove_dc_offset,
+      round_to_power_of_two,
+      snip_edges,
+      window_type);
+  const MelOptions mel_opts{
+      num_mel_bins, low_freq, high_freq, vtln_low, vtln_high, vtln_warp};
+  const MelComputer computer(frame_opts, mel_opts, /*use_power=*/true);
+
+  // Orthonormal DCT-II with the lifter folded in, row c giving cepstrum c.
+  std::vector<float> dct(num_ceps * num_mel_bins);
+  for (int64_t c = 0; c < num_ceps; ++c) {
+    const double lifter = cepstral_lifter != 0.
+        ? 1.0 + 0.5 * cepstral_lifter * std::sin(M_PI * c / cepstral_lifter)
+        : 1.0;
+    const double scale = c == 0 ? std::sqrt(1.0 / num_mel_bins)
+                                : std::sqrt(2.0 / num_mel_bins);
+    for (int64_t m = 0; m < num_mel_bins; ++m) {
+      dct[c * num_mel_bins + m] = static_cast<float>(
+          lifter * scale * std::cos(M_PI / num_mel_bins * (m + 0.5) * c));
+    }
+  }
+
+  return compute_mel_features(
+      wave,
+      computer,
+      num_ceps,
+      subtract_mean,
+      [&](float* mel, float log_energy, float* out) {
+        for (int64_t m = 0; m < num_mel_bins; ++m) {
+          mel[m] = std::log(std::max(mel[m], kEpsilon));
+        }
+        // With `htk_compat`, C0 goes last.
+        float* ceps = htk_compat ? out - 1 : out;
+        for (int64_t c = 0; c < num_ceps; ++c) {
+          const float* row = dct.data() + c * num_mel_bins;
+          float sum = 0.f;
+          for (int64_t m = 0; m < num_mel_bins; ++m) {
+            sum += row[m] * mel[m];
+          }
+          if (c == 0) {
+            if (use_energy) {
+              sum = log_energy;
+            } else if (htk_compat) {
+              // Remove the scale of the first row of the orthonormal DCT.
+              sum *= static_cast<float>(M_SQRT2);
+            }
+            out[htk_compat ? num_ceps - 1 : 0] = sum;
+          } else {
+            ceps[c] = sum;
+          }
+        }
+      });
+}
+
+TORCH_LIBRARY_FRAGMENT(torchaudio, m) {
+  m.def("torchaudio::kaldi_ComputeFbank", &torchaudio::kaldi::ComputeFbank);
+  m.def("torchaudio::kaldi_ComputeMfcc", &torchaudio::kaldi::ComputeMfcc);
+}
+
+} // namespace kaldi
+} // namespace torchaudio
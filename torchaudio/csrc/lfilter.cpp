@@ -1,43 +1,25 @@
+#include <ATen/record_function.h>
+#include <torch/fft.h>
 #include <torch/script.h>
 #include <torch/torch.h>
+#include <torchaudio/csrc/cpu/kernels.h>
 
-namespace {
+namespace torchaudio {
+namespace cpu {
 
-template <typename scalar_t>
-void host_lfilter_core_loop(
-    const torch::Tensor& input_signal_windows,
-    const torch::Tensor& a_coeff_flipped,
-    torch::Tensor& padded_output_waveform) {
-  int64_t n_batch = input_signal_windows.size(0);
-  int64_t n_channel = input_signal_windows.size(1);
-  int64_t n_samples_input = input_signal_windows.size(2);
-  int64_t n_samples_output = padded_output_waveform.size(2);
-  int64_t n_order = a_coeff_flipped.size(1);
-  scalar_t* output_data = padded_output_waveform.data_ptr<scalar_t>();
-  const scalar_t* input_data = input_signal_windows.data_ptr<scalar_t>();
-  const scalar_t* a_coeff_flipped_data = a_coeff_flipped.data_ptr<scalar_t>();
-
-  at::parallel_for(0, n_channel * n_batch, 1, [&](int64_t begin, int64_t end) {
-    for (auto i = begin; i < end; i++) {
-      int64_t offset_input = i * n_samples_input;
-      int64_t offset_output = i * n_samples_output;
-      int64_t i_channel = i % n_channel;
-      for (int64_t i_sample = 0; i_sample < n_samples_input; i_sample++) {
-        scalar_t a0 = input_data[offset_input + i_sample];
-        for (int64_t i_coeff = 0; i_coeff < n_order; i_coeff++) {
-          a0 -= output_data[offset_output + i_sample + i_coeff] *
-              a_coeff_flipped_data[i_coeff + i_channel * n_order];
-        }
-        output_data[offset_output + i_sample + n_order - 1] = a0;
-      }
-    }
-  });
-}
+TORCHAUDIO_DEFINE_DISPATCH(lfilter_core_loop_fn, lfilter_core_loop_stub);
+TORCHAUDIO_DEFINE_DISPATCH(lfilter_fused_fn, lfilter_fused_stub);
+
+} // namespace cpu
+} // namespace torchaudio
+
+namespace {
 
 void cpu_lfilter_core_loop(
     const torch::Tensor& input_signal_windows,
     const torch::Tensor& a_coeff_flipped,
-    torch::Tensor& padded_output_waveform) {
+    torch::Tensor& padded_output_waveform,
+    bool reverse) {
   TORCH_CHECK(
       input_signal_windows.device().is_cpu() &&
       a_coeff_flipped.device().is_cpu() &&
@@ -59,14 +41,18 @@ void cpu_lfilter_core_loop(
   TORCH_CHECK(input_signal_windows.size(1) == padded_output_waveform.size(1));
 
   TORCH_CHECK(
-      input_signal_windows.size(2) + a_coeff_flipped.size(1) - 1 ==
+      (a_coeff_flipped.dim() == 2 &&
+       a_coeff_flipped.size(0) == input_signal_windows.size(1)) ||
+      (a_coeff_flipped.dim() == 3 &&
+       a_coeff_flipped.size(0) == input_signal_windows.size(0) &&
+       a_coeff_flipped.size(1) == input_signal_windows.size(1)));
+
+  TORCH_CHECK(
+      input_signal_windows.size(2) + a_coeff_flipped.size(-1) - 1 ==
       padded_output_waveform.size(2));
 
-  AT_DISPATCH_FLOATING_TYPES(
-      input_signal_windows.scalar_type(), "lfilter_core_loop", [&] {
-        host_lfilter_core_loop<scalar_t>(
-            input_signal_windows, a_coeff_flipped, padded_output_waveform);
-      });
+  torchaudio::cpu::lfilter_core_loop_stub(
+      input_signal_windows, a_coeff_flipped, padded_output_waveform, reverse);
 }
 
 void lfilter_core_generic_loop(
@@ -74,8 +60,10 @@ void lfilter_core_generic_loop(
     const torch::Tensor& a_coeff_flipped,
     torch::Tensor& padded_output_waveform) {
   int64_t n_samples_input = input_signal_windows.size(2);
-  int64_t n_order = a_coeff_flipped.size(1);
-  auto coeff = a_coeff_flipped.unsqueeze(2);
+  int64_t n_order = a_coeff_flipped.size(-1);
+  // (n_channel, n_order, 1) or (n_batch, n_channel, n_order, 1), which the
+  // matmul broadcasts against the (n_batch, n_channel, 1, n_order) windows.
+  auto coeff = a_coeff_flipped.unsqueeze(-1);
   for (int64_t i_sample = 0; i_sample < n_samples_input; i_sample++) {
     auto windowed_output_signal =
         padded_output_waveform
@@ -83,11 +71,11 @@ void lfilter_core_generic_loop(
                 {torch::indexing::Slice(),
                  torch::indexing::Slice(),
                  torch::indexing::Slice(i_sample, i_sample + n_order)})
-            .transpose(0, 1);
+            .unsqueeze(2);
     auto o0 =
         input_signal_windows.index(
             {torch::indexing::Slice(), torch::indexing::Slice(), i_sample}) -
-        at::matmul(windowed_output_signal, coeff).squeeze(2).transpose(0, 1);
+        at::matmul(windowed_output_signal, coeff).squeeze(3).squeeze(2);
     padded_output_waveform.index_put_(
         {torch::indexing::Slice(),
          torch::indexing::Slice(),
@@ -96,39 +84,146 @@ void lfilter_core_generic_loop(
   }
 }
 
+torch::Tensor cpu_lfilter_fused(
+    const torch::Tensor& waveform,
+    const torch::Tensor& a_coeffs,
+    const torch::Tensor& b_coeffs) {
+  RECORD_FUNCTION(
+      "torchaudio::lfilter::fused",
+      std::vector<c10::IValue>({waveform, a_coeffs}));
+  auto x = waveform.contiguous();
+  auto a = a_coeffs.contiguous();
+  auto b = b_coeffs.contiguous();
+  auto output = torch::empty_like(x);
+  torchaudio::cpu::lfilter_fused_stub(x, a, b, output);
+  return output;
+}
+
+// Runs the recurrence through `torchaudio::_lfilter_core_loop` when a native
+// kernel is available for the device, and through the generic loop
+// otherwise.
+void lfilter_core_loop(
+    const torch::Tensor& input_signal_windows,
+    const torch::Tensor& a_coeff_flipped,
+    torch::Tensor& padded_output_waveform,
+    bool reverse) {
+  static auto op =
+      c10::Dispatcher::singleton()
+          .findSchemaOrThrow("torchaudio::_lfilter_core_loop", "")
+          .typed<void(
+              const torch::Tensor&,
+              const torch::Tensor&,
+              torch::Tensor&,
+              bool)>();
+  auto device = input_signal_windows.device();
+  if (device.is_cpu() ||
+      (device.is_cuda() &&
+       op.hasKernelForDispatchKey(c10::DispatchKey::CUDA))) {
+    op.call(input_signal_windows, a_coeff_flipped, padded_output_waveform, reverse);
+  } else if (reverse) {
+    auto flipped_output = padded_output_waveform.flip(2);
+    lfilter_core_generic_loop(
+        input_signal_windows.flip(2), a_coeff_flipped, flipped_output);
+    padded_output_waveform.copy_(flipped_output.flip(2));
+  } else {
+    lfilter_core_generic_loop(
+        input_signal_windows, a_coeff_flipped, padded_output_waveform);
+  }
+}
+
+// The coefficients of the filters are either `(n_channel, n_order)`, shared
+// by the whole batch, or `(n_batch, n_channel, n_order)`, one set of filters
+// per example. The gradients with respect to them are computed per example,
+// as `(n_batch, n_channel, n_order)`, and summed over the batch for the
+// shared ones.
+torch::Tensor reduce_coeff_grad(
+    const torch::Tensor& grad,
+    const torch::Tensor& coeffs) {
+  return coeffs.dim() == 2 ? grad.sum(0) : grad;
+}
+
+// Correlates each (batch, channel) row of `input` with its filter `weight`,
+// which is shared by the batch or given per example as above.
+torch::Tensor grouped_conv1d(
+    const torch::Tensor& input,
+    const torch::Tensor& weight) {
+  namespace F = torch::nn::functional;
+  if (weight.dim() == 2) {
+    return F::conv1d(
+        input,
+        weight.unsqueeze(1),
+        F::Conv1dFuncOptions().groups(weight.size(0)));
+  }
+  int64_t n_batch = input.size(0);
+  int64_t n_channel = input.size(1);
+  return F::conv1d(
+             input.reshape({1, n_batch * n_channel, -1}),
+             weight.reshape({n_batch * n_channel, 1, -1}),
+             F::Conv1dFuncOptions().groups(n_batch * n_channel))
+      .view({n_batch, n_channel, -1});
+}
+
+// Anti-causal counterpart of DifferentiableIIR, that is,
+//   y[n] = x[n] - sum_{k > 0} a[k] * y[n + k].
+// The two functions are the adjoint of each other, so each one is used to
+// compute the backward pass of the other.
+class DifferentiableIIRReverse
+    : public torch::autograd::Function<DifferentiableIIRReverse> {
+ public:
+  static torch::Tensor forward(
+      torch::autograd::AutogradContext* ctx,
+      const torch::Tensor& waveform,
+      const torch::Tensor& a_coeffs_normalized);
+
+  static torch::autograd::tensor_list backward(
+      torch::autograd::AutogradContext* ctx,
+      torch::autograd::tensor_list grad_outputs);
+};
+
 class DifferentiableIIR : public torch::autograd::Function<DifferentiableIIR> {
  public:
   static torch::Tensor forward(
       torch::autograd::AutogradContext* ctx,
       const torch::Tensor& waveform,
-      const torch::Tensor& a_coeffs_normalized) {
+      const torch::Tensor& a_coeffs_normalized,
+      bool recompute_output) {
+    RECORD_FUNCTION(
+        "torchaudio::lfilter::iir",
+        std::vector<c10::IValue>({waveform, a_coeffs_normalized}));
     auto device = waveform.device();
     auto dtype = waveform.dtype();
     int64_t n_batch = waveform.size(0);
     int64_t n_channel = waveform.size(1);
     int64_t n_sample = waveform.size(2);
-    int64_t n_order = a_coeffs_normalized.size(1);
+    int64_t n_order = a_coeffs_normalized.size(-1);
     int64_t n_sample_padded = n_sample + n_order - 1;
 
-    auto a_coeff_flipped = a_coeffs_normalized.flip(1).contiguous();
+    auto a_coeff_flipped = a_coeffs_normalized.flip(-1).contiguous();
 
     auto options = torch::TensorOptions().dtype(dtype).device(device);
     auto padded_output_waveform =
         torch::zeros({n_batch, n_channel, n_sample_padded}, options);
 
-    if (device.is_cpu()) {
-      cpu_lfilter_core_loop(waveform, a_coeff_flipped, padded_output_waveform);
-    } else {
-      lfilter_core_generic_loop(
-          waveform, a_coeff_flipped, padded_output_waveform);
-    }
+    lfilter_core_loop(
+        waveform.contiguous(),
+        a_coeff_flipped,
+        padded_output_waveform,
+        /*reverse=*/false);
 
     auto output = padded_output_waveform.index(
         {torch::indexing::Slice(),
          torch::indexing::Slice(),
          torch::indexing::Slice(n_order - 1, torch::indexing::None)});
 
-    ctx->save_for_backward({waveform, a_coeffs_normalized, output});
+    // With `recompute_output`, the output is not kept for the backward pass,
+    // and is recomputed from the input instead. This trades one more pass of
+    // the recurrence for a smaller peak memory.
+    ctx->saved_data["recompute_output"] = recompute_output;
+    if (recompute_output) {
+      ctx->save_for_backward({waveform, a_coeffs_normalized});
+    } else {
+      ctx->save_for_backward({waveform, a_coeffs_normalized, output});
+    }
     return output;
   }
 
@@ -138,11 +233,10 @@ class DifferentiableIIR : public torch::autograd::Function<DifferentiableIIR> {
     auto saved = ctx->get_saved_variables();
     auto x = saved[0];
     auto a_coeffs_normalized = saved[1];
-    auto y = saved[2];
 
     int64_t n_batch = x.size(0);
     int64_t n_channel = x.size(1);
-    int64_t n_order = a_coeffs_normalized.size(1);
+    int64_t n_order = a_coeffs_normalized.size(-1);
 
     auto dx = torch::Tensor();
     auto da = torch::Tensor();
@@ -150,46 +244,224 @@ class DifferentiableIIR : public torch::autograd::Function<DifferentiableIIR> {
 
     namespace F = torch::nn::functional;
 
+    // The gradient with respect to the input is the anti-causal filtering
+    // of the output gradient. It is also needed for the coefficients.
+    auto q = DifferentiableIIRReverse::apply(dy, a_coeffs_normalized);
+
     if (a_coeffs_normalized.requires_grad()) {
-      auto dyda = F::pad(
-          DifferentiableIIR::apply(-y, a_coeffs_normalized),
-          F::PadFuncOptions({n_order - 1, 0}));
-
-      da = F::conv1d(
-               dyda.view({1, n_batch * n_channel, -1}),
-               dy.view({n_batch * n_channel, 1, -1}),
-               F::Conv1dFuncOptions().groups(n_batch * n_channel))
-               .view({n_batch, n_channel, -1})
-               .sum(0)
-               .flip(1);
+      const bool recompute_output =
+          ctx->saved_data["recompute_output"].toBool();
+      auto y = recompute_output
+          ? DifferentiableIIR::apply(x, a_coeffs_normalized, recompute_output)
+          : saved[2];
+
+      // da[k] = - sum_n q[n] * y[n - k]
+      da = -reduce_coeff_grad(
+                F::conv1d(
+                    F::pad(y, F::PadFuncOptions({n_order - 1, 0}))
+                        .view({1, n_batch * n_channel, -1}),
+                    q.reshape({n_batch * n_channel, 1, -1}),
+                    F::Conv1dFuncOptions().groups(n_batch * n_channel))
+                    .view({n_batch, n_channel, -1}),
+                a_coeffs_normalized)
+                .flip(-1);
     }
 
     if (x.requires_grad()) {
-      dx = DifferentiableIIR::apply(dy.flip(2), a_coeffs_normalized).flip(2);
+      dx = q;
     }
 
-    return {dx, da};
+    return {dx, da, torch::Tensor()};
   }
 };
 
+torch::Tensor DifferentiableIIRReverse::forward(
+    torch::autograd::AutogradContext* ctx,
+    const torch::Tensor& waveform,
+    const torch::Tensor& a_coeffs_normalized) {
+  int64_t n_batch = waveform.size(0);
+  int64_t n_channel = waveform.size(1);
+  int64_t n_sample = waveform.size(2);
+  int64_t n_order = a_coeffs_normalized.size(-1);
+
+  auto a_coeff_flipped = a_coeffs_normalized.flip(-1).contiguous();
+  auto padded_output_waveform = torch::zeros(
+      {n_batch, n_channel, n_sample + n_order - 1}, waveform.options());
+
+  lfilter_core_loop(
+      waveform.contiguous(),
+      a_coeff_flipped,
+      padded_output_waveform,
+      /*reverse=*/true);
+
+  auto output = padded_output_waveform.index(
+      {torch::indexing::Slice(),
+       torch::indexing::Slice(),
+       torch::indexing::Slice(0, n_sample)});
+
+  ctx->save_for_backward({a_coeffs_normalized, output});
+  return output;
+}
+
+torch::autograd::tensor_list DifferentiableIIRReverse::backward(
+    torch::autograd::AutogradContext* ctx,
+    torch::autograd::tensor_list grad_outputs) {
+  auto saved = ctx->get_saved_variables();
+  auto a_coeffs_normalized = saved[0];
+  auto y = saved[1];
+
+  int64_t n_batch = y.size(0);
+  int64_t n_channel = y.size(1);
+  int64_t n_order = a_coeffs_normalized.size(-1);
+
+  auto da = torch::Tensor();
+  auto dy = grad_outputs[0];
+
+  namespace F = torch::nn::functional;
+
+  auto dx = DifferentiableIIR::apply(
+      dy, a_coeffs_normalized, /*recompute_output=*/false);
+
+  if (a_coeffs_normalized.requires_grad()) {
+    // da[k] = - sum_n dx[n] * y[n + k]
+    da = -reduce_coeff_grad(
+        F::conv1d(
+            F::pad(y, F::PadFuncOptions({0, n_order - 1}))
+                .view({1, n_batch * n_channel, -1}),
+            dx.reshape({n_batch * n_channel, 1, -1}),
+            F::Conv1dFuncOptions().groups(n_batch * n_channel))
+            .view({n_batch, n_channel, -1}),
+        a_coeffs_normalized);
+  }
+
+  return {dx, da};
+}
+
+// Filters with at least this many taps are convolved through FFT instead of
+// a direct convolution.
+constexpr int64_t kFFTConvThreshold = 256;
+
+// The FFT size of the overlap-add convolution with `n_taps` taps. It is at
+// least twice the number of taps, so that the tail of a block only spills
+// over the next block. The blocks have `n_fft - n_taps + 1` samples.
+int64_t fft_conv_size(int64_t n_taps) {
+  int64_t n_fft = 1;
+  while (n_fft < 2 * n_taps) {
+    n_fft <<= 1;
+  }
+  return n_fft;
+}
+
+// Computes y[n] = sum_k h[k] * x[n - k] for 0 <= n < n_sample with
+// overlap-add FFT convolution.
+//
+// waveform: (n_batch, n_channel, n_sample),
+// taps: (n_channel, n_taps) or (n_batch, n_channel, n_taps)
+torch::Tensor fft_causal_conv1d(
+    const torch::Tensor& waveform,
+    const torch::Tensor& taps) {
+  using torch::indexing::Ellipsis;
+  using torch::indexing::None;
+  using torch::indexing::Slice;
+  namespace F = torch::nn::functional;
+
+  int64_t n_batch = waveform.size(0);
+  int64_t n_channel = waveform.size(1);
+  int64_t n_sample = waveform.size(2);
+  int64_t n_taps = taps.size(-1);
+
+  if (n_sample == 0) {
+    return torch::empty({n_batch, n_channel, 0}, waveform.options());
+  }
+
+  int64_t n_fft = fft_conv_size(n_taps);
+  int64_t block_size = n_fft - n_taps + 1;
+  int64_t n_blocks = (n_sample + block_size - 1) / block_size;
+
+  auto blocks =
+      F::pad(
+          waveform, F::PadFuncOptions({0, n_blocks * block_size - n_sample}))
+          .view({n_batch, n_channel, n_blocks, block_size});
+  auto spectrum = torch::fft::rfft(blocks, n_fft) *
+      torch::fft::rfft(taps, n_fft).unsqueeze(-2);
+  auto convolved = torch::fft::irfft(spectrum, n_fft);
+
+  auto head = convolved.index({Ellipsis, Slice(0, block_size)});
+  auto tail = convolved.index(
+      {Slice(), Slice(), Slice(0, n_blocks - 1), Slice(block_size, None)});
+  auto output = head +
+      F::pad(tail, F::PadFuncOptions({0, block_size - n_taps + 1, 1, 0}));
+  return output.reshape({n_batch, n_channel, n_blocks * block_size})
+      .index({Slice(), Slice(), Slice(0, n_sample)})
+      .contiguous();
+}
+
+// Computes the gradient of `fft_causal_conv1d` with respect to the taps,
+// g[k] = sum_n grad_output[n] * x[n - k] for 0 <= k < n_taps, on the blocks
+// of the forward pass. Each block of `grad_output` is correlated with the
+// input samples it was computed from, that is, the block and the
+// `n_taps - 1` samples before it, which fit in one FFT.
+//
+// waveform, grad_output: (n_batch, n_channel, n_sample)
+// Returns: (n_batch, n_channel, n_taps)
+torch::Tensor fft_causal_conv1d_taps_grad(
+    const torch::Tensor& waveform,
+    const torch::Tensor& grad_output,
+    int64_t n_taps) {
+  using torch::indexing::Ellipsis;
+  using torch::indexing::Slice;
+  namespace F = torch::nn::functional;
+
+  int64_t n_batch = waveform.size(0);
+  int64_t n_channel = waveform.size(1);
+  int64_t n_sample = waveform.size(2);
+
+  if (n_sample == 0) {
+    return torch::zeros({n_batch, n_channel, n_taps}, waveform.options());
+  }
+
+  int64_t n_fft = fft_conv_size(n_taps);
+  int64_t block_size = n_fft - n_taps + 1;
+  int64_t n_blocks = (n_sample + block_size - 1) / block_size;
+  int64_t n_pad = n_blocks * block_size - n_sample;
+
+  auto grad_blocks = F::pad(grad_output, F::PadFuncOptions({0, n_pad}))
+                         .reshape({n_batch, n_channel, n_blocks, block_size});
+  // Block j is correlated with x[j * block_size - n_taps + 1 + m] for
+  // 0 <= m < n_fft.
+  auto input_blocks =
+      F::pad(waveform, F::PadFuncOptions({n_taps - 1, n_pad}))
+          .unfold(2, n_fft, block_size);
+  // c[k] = sum_m grad_block[m] * input_block[m + k] = g[n_taps - 1 - k]
+  auto correlated = torch::fft::irfft(
+      torch::fft::rfft(grad_blocks, n_fft).conj() *
+          torch::fft::rfft(input_blocks, n_fft),
+      n_fft);
+  return correlated.index({Ellipsis, Slice(0, n_taps)}).sum(2).flip(-1);
+}
+
 class DifferentiableFIR : public torch::autograd::Function<DifferentiableFIR> {
  public:
   static torch::Tensor forward(
       torch::autograd::AutogradContext* ctx,
       const torch::Tensor& waveform,
       const torch::Tensor& b_coeffs) {
-    int64_t n_order = b_coeffs.size(1);
-    int64_t n_channel = b_coeffs.size(0);
+    RECORD_FUNCTION(
+        "torchaudio::lfilter::fir",
+        std::vector<c10::IValue>({waveform, b_coeffs}));
+    int64_t n_order = b_coeffs.size(-1);
 
     namespace F = torch::nn::functional;
-    auto b_coeff_flipped = b_coeffs.flip(1).contiguous();
-    auto padded_waveform =
-        F::pad(waveform, F::PadFuncOptions({n_order - 1, 0}));
+    torch::Tensor output;
+    if (n_order >= kFFTConvThreshold) {
+      output = fft_causal_conv1d(waveform, b_coeffs);
+    } else {
+      auto b_coeff_flipped = b_coeffs.flip(-1).contiguous();
+      auto padded_waveform =
+          F::pad(waveform, F::PadFuncOptions({n_order - 1, 0}));
 
-    auto output = F::conv1d(
-        padded_waveform,
-        b_coeff_flipped.unsqueeze(1),
-        F::Conv1dFuncOptions().groups(n_channel));
+      output = grouped_conv1d(padded_waveform, b_coeff_flipped);
+    }
 
     ctx->save_for_backward({waveform, b_coeffs, output});
     return output;
@@ -205,7 +477,7 @@ class DifferentiableFIR : public torch::autograd::Function<DifferentiableFIR> {
 
     int64_t n_batch = x.size(0);
     int64_t n_channel = x.size(1);
-    int64_t n_order = b_coeffs.size(1);
+    int64_t n_order = b_coeffs.size(-1);
 
     auto dx = torch::Tensor();
     auto db = torch::Tensor();
@@ -213,71 +485,221 @@ class DifferentiableFIR : public torch::autograd::Function<DifferentiableFIR> {
 
     namespace F = torch::nn::functional;
 
+    if (n_order >= kFFTConvThreshold) {
+      if (b_coeffs.requires_grad()) {
+        db = reduce_coeff_grad(
+            fft_causal_conv1d_taps_grad(x, dy, n_order), b_coeffs);
+      }
+      if (x.requires_grad()) {
+        dx = fft_causal_conv1d(dy.flip(2), b_coeffs).flip(2);
+      }
+      return {dx, db};
+    }
+
     if (b_coeffs.requires_grad()) {
-      db = F::conv1d(
-               F::pad(x, F::PadFuncOptions({n_order - 1, 0}))
-                   .view({1, n_batch * n_channel, -1}),
-               dy.view({n_batch * n_channel, 1, -1}),
-               F::Conv1dFuncOptions().groups(n_batch * n_channel))
-               .view({n_batch, n_channel, -1})
-               .sum(0)
-               .flip(1);
+      db = reduce_coeff_grad(
+               F::conv1d(
+                   F::pad(x, F::PadFuncOptions({n_order - 1, 0}))
+                       .view({1, n_batch * n_channel, -1}),
+                   dy.reshape({n_batch * n_channel, 1, -1}),
+                   F::Conv1dFuncOptions().groups(n_batch * n_channel))
+                   .view({n_batch, n_channel, -1}),
+               b_coeffs)
+               .flip(-1);
     }
 
     if (x.requires_grad()) {
-      dx = F::conv1d(
-          F::pad(dy, F::PadFuncOptions({0, n_order - 1})),
-          b_coeffs.unsqueeze(1),
-          F::Conv1dFuncOptions().groups(n_channel));
+      dx = grouped_conv1d(
+          F::pad(dy, F::PadFuncOptions({0, n_order - 1})), b_coeffs);
     }
 
     return {dx, db};
   }
 };
 
+// The coefficients are `(n_channel, n_order)`, shared by the batch, or
+// `(n_batch, n_channel, n_order)`, one set of filters per example.
+void check_coeffs_shape(
+    const torch::Tensor& waveform,
+    const torch::Tensor& a_coeffs) {
+  TORCH_CHECK(
+      (a_coeffs.dim() == 2 && a_coeffs.size(0) == waveform.size(1)) ||
+          (a_coeffs.dim() == 3 && a_coeffs.size(0) == waveform.size(0) &&
+           a_coeffs.size(1) == waveform.size(1)),
+      "The coefficients must have shape (",
+      waveform.size(1),
+      ", order) or (",
+      waveform.size(0),
+      ", ",
+      waveform.size(1),
+      ", order). Found: ",
+      a_coeffs.sizes());
+}
+
 torch::Tensor lfilter_core(
     const torch::Tensor& waveform,
     const torch::Tensor& a_coeffs,
-    const torch::Tensor& b_coeffs) {
+    const torch::Tensor& b_coeffs,
+    bool recompute_output) {
   TORCH_CHECK(waveform.device() == a_coeffs.device());
   TORCH_CHECK(b_coeffs.device() == a_coeffs.device());
   TORCH_CHECK(a_coeffs.sizes() == b_coeffs.sizes());
 
   TORCH_INTERNAL_ASSERT(waveform.sizes().size() == 3);
-  TORCH_INTERNAL_ASSERT(a_coeffs.sizes().size() == 2);
-  TORCH_INTERNAL_ASSERT(a_coeffs.size(0) == waveform.size(1));
+  check_coeffs_shape(waveform, a_coeffs);
 
-  int64_t n_order = b_coeffs.size(1);
+  int64_t n_order = b_coeffs.size(-1);
 
   TORCH_INTERNAL_ASSERT(n_order > 0);
 
-  auto filtered_waveform = DifferentiableFIR::apply(
-      waveform,
-      b_coeffs /
-          a_coeffs.index(
-              {torch::indexing::Slice(), torch::indexing::Slice(0, 1)}));
+  // Inference on CPU does not need the intermediate tensors that the
+  // autograd path keeps, so the FIR and IIR parts are fused. The fused
+  // kernel only runs the rows in parallel, so few long rows, which the IIR
+  // loop splits along time, keep going through the FIR + IIR path.
+  bool requires_grad = torch::GradMode::is_enabled() &&
+      (waveform.requires_grad() || a_coeffs.requires_grad() ||
+       b_coeffs.requires_grad());
+  bool split_rows = n_order > 1 &&
+      torchaudio::cpu::lfilter_num_chunks(
+          waveform.size(0) * waveform.size(1), waveform.size(2)) > 1;
+  if (!requires_grad && !split_rows && waveform.device().is_cpu() &&
+      n_order <= torchaudio::cpu::kMaxFusedOrder &&
+      waveform.scalar_type() == a_coeffs.scalar_type() &&
+      waveform.scalar_type() == b_coeffs.scalar_type()) {
+    return cpu_lfilter_fused(waveform, a_coeffs, b_coeffs);
+  }
+
+  auto a0 = a_coeffs.narrow(-1, 0, 1);
+  auto filtered_waveform = DifferentiableFIR::apply(waveform, b_coeffs / a0);
+
+  auto a_coeffs_normalized = a_coeffs / a0;
+
+  // Long FIR filters, such as room impulse responses, come with an all-zero
+  // denominator tail. Trim it so that the IIR part does not run a
+  // recurrence over thousands of zero coefficients. The order is read back
+  // on the host, so this is only done on CPU, where it does not synchronize
+  // with a device stream.
+  if (n_order >= kFFTConvThreshold && !a_coeffs.requires_grad() &&
+      a_coeffs.device().is_cpu()) {
+    auto is_nonzero = a_coeffs_normalized.ne(0).reshape({-1, n_order}).any(0);
+    int64_t n_iir_order = is_nonzero.nonzero().max().item<int64_t>() + 1;
+    a_coeffs_normalized = a_coeffs_normalized.narrow(-1, 0, n_iir_order);
+  }
 
   auto output = DifferentiableIIR::apply(
-      filtered_waveform,
-      a_coeffs /
-          a_coeffs.index(
-              {torch::indexing::Slice(), torch::indexing::Slice(0, 1)}));
+      filtered_waveform, a_coeffs_normalized, recompute_output);
   return output;
 }
 
-} // namespace
+// Variant of `lfilter_core` which carries the filter state across calls,
+// so that a long signal can be filtered chunk by chunk.
+//
+// The state has shape `(n_batch, n_channel, 2 * (n_order - 1))`. The first
+// half holds the last `n_order - 1` input samples (consumed by the FIR part)
+// and the second half holds the last `n_order - 1` output samples (consumed
+// by the IIR part), both from the oldest to the newest.
+// When `zi` is not given, the filter starts from the zero state.
+std::tuple<torch::Tensor, torch::Tensor> lfilter_stateful(
+    const torch::Tensor& waveform,
+    const torch::Tensor& a_coeffs,
+    const torch::Tensor& b_coeffs,
+    const c10::optional<torch::Tensor>& zi) {
+  TORCH_CHECK(waveform.device() == a_coeffs.device());
+  TORCH_CHECK(b_coeffs.device() == a_coeffs.device());
+  TORCH_CHECK(a_coeffs.sizes() == b_coeffs.sizes());
+
+  TORCH_INTERNAL_ASSERT(waveform.sizes().size() == 3);
+  check_coeffs_shape(waveform, a_coeffs);
+
+  int64_t n_batch = waveform.size(0);
+  int64_t n_channel = waveform.size(1);
+  int64_t n_sample = waveform.size(2);
+  int64_t n_order = b_coeffs.size(-1);
+  int64_t n_state = n_order - 1;
 
-// Note: We want to avoid using "catch-all" kernel.
-// The following registration should be replaced with CPU specific registration.
-TORCH_LIBRARY_FRAGMENT(torchaudio, m) {
-  m.def("torchaudio::_lfilter_core_loop", &cpu_lfilter_core_loop);
+  TORCH_INTERNAL_ASSERT(n_order > 0);
+
+  torch::Tensor state;
+  if (zi.has_value()) {
+    state = zi.value();
+    TORCH_CHECK(
+        state.device() == waveform.device(),
+        "zi must be on the same device as waveform");
+    TORCH_CHECK(
+        state.sizes() ==
+            torch::IntArrayRef({n_batch, n_channel, 2 * n_state}),
+        "zi must have shape (",
+        n_batch,
+        ", ",
+        n_channel,
+        ", ",
+        2 * n_state,
+        "). Found: ",
+        state.sizes());
+  } else {
+    state = torch::zeros({n_batch, n_channel, 2 * n_state}, waveform.options());
+  }
+
+  using torch::indexing::None;
+  using torch::indexing::Slice;
+  namespace F = torch::nn::functional;
+
+  auto input_history = state.index({Slice(), Slice(), Slice(0, n_state)});
+  auto output_history = state.index({Slice(), Slice(), Slice(n_state, None)});
+
+  auto a0 = a_coeffs.narrow(-1, 0, 1);
+  auto a_coeffs_normalized = a_coeffs / a0;
+
+  // FIR part: prepend the input history, and drop the outputs which only
+  // depend on it.
+  auto extended_waveform = torch::cat({input_history, waveform}, 2);
+  auto filtered_waveform =
+      DifferentiableFIR::apply(extended_waveform, b_coeffs / a0)
+          .index({Slice(), Slice(), Slice(n_state, None)});
+
+  // IIR part: the output history only affects the first `n_state` samples.
+  // Its contribution, sum_{k > n} a[k] * y[n - k], is moved to the input
+  // side so that the zero-state recurrence can be used as is.
+  if (n_state > 0 && n_sample > 0) {
+    int64_t n_head = std::min(n_state, n_sample);
+    auto correction =
+        grouped_conv1d(
+            F::pad(output_history, F::PadFuncOptions({0, n_state})),
+            a_coeffs_normalized.narrow(-1, 1, n_state).flip(-1))
+            .index({Slice(), Slice(), Slice(0, n_head)});
+    filtered_waveform = filtered_waveform -
+        F::pad(correction, F::PadFuncOptions({0, n_sample - n_head}));
+  }
+
+  auto output = DifferentiableIIR::apply(
+      filtered_waveform.contiguous(),
+      a_coeffs_normalized,
+      /*recompute_output=*/false);
+
+  auto final_state = torch::cat(
+      {extended_waveform.index({Slice(), Slice(), Slice(n_sample, None)}),
+       torch::cat({output_history, output}, 2)
+           .index({Slice(), Slice(), Slice(n_sample, None)})},
+      2);
+  return std::make_tuple(output, final_state);
 }
 
+} // namespace
+
 TORCH_LIBRARY(torchaudio, m) {
   m.def(
-      "torchaudio::_lfilter(Tensor waveform, Tensor a_coeffs, Tensor b_coeffs) -> Tensor");
+      "torchaudio::_lfilter_core_loop(Tensor input_signal_windows, Tensor a_coeff_flipped, Tensor(a!) padded_output_waveform, bool reverse=False) -> ()");
+  m.def(
+      "torchaudio::_lfilter(Tensor waveform, Tensor a_coeffs, Tensor b_coeffs, bool recompute_output=False) -> Tensor");
+  m.def(
+      "torchaudio::_lfilter_stateful(Tensor waveform, Tensor a_coeffs, Tensor b_coeffs, Tensor? zi) -> (Tensor, Tensor)");
+}
+
+TORCH_LIBRARY_IMPL(torchaudio, CPU, m) {
+  m.impl("torchaudio::_lfilter_core_loop", &cpu_lfilter_core_loop);
 }
 
 TORCH_LIBRARY_IMPL(torchaudio, CompositeImplicitAutograd, m) {
   m.impl("torchaudio::_lfilter", lfilter_core);
+  m.impl("torchaudio::_lfilter_stateful", lfilter_stateful);
 }
@@ -0,0 +1,218 @@
+#include <torch/fft.h>
+#include <torchaudio/csrc/mel_spectrogram.h>
+
+#include <cmath>
+
+namespace torchaudio {
+namespace mel_spectrogram {
+namespace {
+
+// Number of frames of a waveform computed by a task. The spectra of a block
+// stay in the cache while they are projected onto the mel bands.
+constexpr int64_t kFrameBlock = 32;
+
+template <typename scalar_t>
+C10_ALWAYS_INLINE scalar_t
+to_power(const c10::complex<scalar_t>& z, scalar_t power) {
+  const scalar_t norm = z.real() * z.real() + z.imag() * z.imag();
+  if (power == 2) {
+    return norm;
+  }
+  if (power == 1) {
+    return std::sqrt(norm);
+  }
+  return std::pow(norm, power / 2);
+}
+
+template <typename scalar_t>
+void mel_spectrogram_cpu_kernel(
+    const Inputs& inputs,
+    scalar_t power,
+    const c10::optional<double>& log_offset,
+    torch::Tensor& output) {
+  const int64_t num_waves = inputs.num_waves();
+  const int64_t num_frames = inputs.num_frames;
+  const int64_t num_blocks = (num_frames + kFrameBlock - 1) / kFrameBlock;
+  const int64_t n_freqs = inputs.n_freqs();
+  const int64_t n_mels = inputs.n_mels();
+  const scalar_t* fb = inputs.fb.data_ptr<scalar_t>();
+  const int64_t* band_begin = inputs.band_begin.data_ptr<int64_t>();
+  const int64_t* band_end = inputs.band_end.data_ptr<int64_t>();
+  const bool take_log = log_offset.has_value();
+  const scalar_t offset = static_cast<scalar_t>(log_offset.value_or(0.));
+  scalar_t* output_data = output.data_ptr<scalar_t>();
+
+  at::parallel_for(
+      0, num_waves * num_blocks, 1, [&](int64_t begin, int64_t end) {
+        std::vector<scalar_t> powers(n_freqs);
+        for (int64_t task = begin; task < end; ++task) {
+          const int64_t w = task / num_blocks;
+          const int64_t frame_begin = (task % num_blocks) * kFrameBlock;
+          const int64_t frame_end =
+              std::min(frame_begin + kFrameBlock, num_frames);
+          const auto spec =
+              spectrum(inputs, w, w + 1, frame_begin, frame_end).contiguous();
+          const auto* spec_data = spec.data_ptr<c10::complex<scalar_t>>();
+          scalar_t* out = output_data + w * n_mels * num_frames;
+          for (int64_t f = frame_begin; f < frame_end; ++f) {
+            const auto* row = spec_data + (f - frame_begin) * n_freqs;
+            for (int64_t k = 0; k < n_freqs; ++k) {
+              powers[k] = to_power(row[k], power);
+            }
+            for (int64_t m = 0; m < n_mels; ++m) {
+              const scalar_t* weights = fb + m * n_freqs;
+              scalar_t sum = 0;
+              for (int64_t k = band_begin[m]; k < band_end[m]; ++k) {
+                sum += weights[k] * powers[k];
+              }
+              out[m * num_frames + f] = take_log ? std::log(sum + offset) : sum;
+            }
+          }
+        }
+      });
+}
+
+torch::Tensor mel_spectrogram_cpu(
+    const torch::Tensor& waveform,
+    const torch::Tensor& window,
+    const torch::Tensor& fb,
+    int64_t n_fft,
+    int64_t hop_length,
+    bool center,
+    const std::string& pad_mode,
+    bool normalized,
+    double power,
+    c10::optional<double> log_offset) {
+  const auto inputs = prepare(
+      waveform, window, fb, n_fft, hop_length, center, pad_mode, normalized);
+  auto output = torch::empty(
+      {inputs.num_waves(), inputs.n_mels(), inputs.num_frames},
+      inputs.waveform.options());
+  AT_DISPATCH_FLOATING_TYPES(
+      inputs.waveform.scalar_type(), "mel_spectrogram_cpu", [&] {
+        mel_spectrogram_cpu_kernel<scalar_t>(
+            inputs, static_cast<scalar_t>(power), log_offset, output);
+      });
+  return output.reshape(inputs.output_sizes);
+}
+
+} // namespace
+
+Inputs prepare(
+    const torch::Tensor& waveform,
+    const torch::Tensor& window,
+    const torch::Tensor& fb,
+    int64_t n_fft,
+    int64_t hop_length,
+    bool center,
+    const std::string& pad_mode,
+    bool normalized) {
+  TORCH_CHECK(waveform.dim() >= 1, "waveform must have at least 1 dimension.");
+  TORCH_CHECK(
+      n_fft > 0 && hop_length > 0,
+      "n_fft and hop_length must be positive. Found: ",
+      n_fft,
+      " and ",
+      hop_length);
+  TORCH_CHECK(
+      window.dim() == 1 && window.size(0) > 0 && window.size(0) <= n_fft,
+      "window must be a 1D tensor of at most n_fft (",
+      n_fft,
+      ") samples. Found: ",
+      window.sizes());
+  const int64_t n_freqs = n_fft / 2 + 1;
+  TORCH_CHECK(
+      fb.dim() == 2 && fb.size(0) == n_freqs,
+      "fb must have the shape of (n_fft // 2 + 1, n_mels) = (",
+      n_freqs,
+      ", n_mels). Found: ",
+      fb.sizes());
+  TORCH_CHECK(
+      window.device() == waveform.device() && fb.device() == waveform.device(),
+      "waveform, window and fb must be on the same device.");
+  TORCH_CHECK(
+      window.scalar_type() == waveform.scalar_type() &&
+          fb.scalar_type() == waveform.scalar_type(),
+      "waveform, window and fb must have the same dtype.");
+
+  Inputs inputs;
+  inputs.n_fft = n_fft;
+  inputs.hop_length = hop_length;
+
+  // Same padding as `torch.stft`.
+  const int64_t length = waveform.size(-1);
+  auto x = waveform.reshape({-1, length});
+  if (center) {
+    const int64_t pad = n_fft / 2;
+    x = x.unsqueeze(1);
+    if (pad_mode == "reflect") {
+      x = torch::reflection_pad1d(x, {pad, pad});
+    } else if (pad_mode == "replicate") {
+      x = torch::replication_pad1d(x, {pad, pad});
+    } else if (pad_mode == "constant") {
+      x = torch::constant_pad_nd(x, {pad, pad});
+    } else {
+      TORCH_CHECK(false, "Unsupported pad_mode: ", pad_mode);
+    }
+    x = x.squeeze(1);
+  }
+  inputs.waveform = x.contiguous();
+  const int64_t padded_length = inputs.waveform.size(1);
+  TORCH_CHECK(
+      padded_length >= n_fft,
+      "The padded waveform must have at least n_fft (",
+      n_fft,
+      ") samples. Found: ",
+      padded_length);
+  inputs.num_frames = 1 + (padded_length - n_fft) / hop_length;
+
+  const int64_t win_length = window.size(0);
+  const int64_t left = (n_fft - win_length) / 2;
+  inputs.window =
+      torch::constant_pad_nd(window, {left, n_fft - win_length - left});
+  if (normalized) {
+    inputs.window = inputs.window / inputs.window.pow(2).sum().sqrt();
+  }
+
+  inputs.fb = fb.t().contiguous();
+  // The bands are found on the device, so that they do not synchronize it.
+  const auto nonzero = inputs.fb.ne(0).to(torch::kInt64);
+  inputs.band_begin = nonzero.argmax(1);
+  inputs.band_end = n_freqs - nonzero.flip(1).argmax(1);
+  inputs.band_end.masked_fill_(nonzero.sum(1).eq(0), 0);
+
+  inputs.output_sizes = waveform.sizes().vec();
+  inputs.output_sizes.back() = inputs.n_mels();
+  inputs.output_sizes.push_back(inputs.num_frames);
+  return inputs;
+}
+
+torch::Tensor spectrum(
+    const Inputs& inputs,
+    int64_t wave_begin,
+    int64_t wave_end,
+    int64_t frame_begin,
+    int64_t frame_end) {
+  const auto& x = inputs.waveform;
+  const int64_t length = x.size(1);
+  const auto frames = x.as_strided(
+      {wave_end - wave_begin, frame_end - frame_begin, inputs.n_fft},
+      {length, inputs.hop_length, 1},
+      x.storage_offset() + wave_begin * length +
+          frame_begin * inputs.hop_length);
+  return torch::fft::rfft(frames * inputs.window);
+}
+
+} // namespace mel_spectrogram
+} // namespace torchaudio
+
+TORCH_LIBRARY_FRAGMENT(torchaudio, m) {
+  m.def(
+      "torchaudio::_mel_spectrogram(Tensor waveform, Tensor window, Tensor fb, int n_fft, int hop_length, bool center, str pad_mode, bool normalized, float power, float? log_offset) -> Tensor");
+}
+
+TORCH_LIBRARY_IMPL(torchaudio, CPU, m) {
+  m.impl(
+      "torchaudio::_mel_spectrogram",
+      &torchaudio::mel_spectrogram::mel_spectrogram_cpu);
+}
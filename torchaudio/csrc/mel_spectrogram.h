@@ -0,0 +1,67 @@
+#pragma once
+
+#include <torch/script.h>
+
+namespace torchaudio {
+namespace mel_spectrogram {
+
+// The arguments of `_mel_spectrogram`, in the layout read by the kernels.
+//
+// The op computes the same mel spectrogram as `MelScale(Spectrogram(...))`,
+// but a block of frames at a time: the frames of the block are windowed and
+// transformed, and their power spectra are projected onto the mel bands
+// right away, so the linear spectrogram of the whole waveform is never
+// written to memory.
+struct Inputs {
+  // [num_waves, padded_length], padded for `center`.
+  torch::Tensor waveform;
+  // [n_fft], the window padded on both sides to `n_fft`, and divided by its
+  // L2 norm for `normalized`.
+  torch::Tensor window;
+  // [n_mels, n_freqs], the transposed filterbank.
+  torch::Tensor fb;
+  // [n_mels], the range [band_begin, band_end) of the frequency bins in which
+  // the weights of the mel band are non-zero. The triangular filters only
+  // overlap with their neighbours, so only these bins are summed.
+  torch::Tensor band_begin;
+  torch::Tensor band_end;
+  int64_t n_fft;
+  int64_t hop_length;
+  int64_t num_frames;
+  // (..., n_mels, num_frames)
+  std::vector<int64_t> output_sizes;
+
+  int64_t num_waves() const {
+    return waveform.size(0);
+  }
+  int64_t n_freqs() const {
+    return fb.size(1);
+  }
+  int64_t n_mels() const {
+    return fb.size(0);
+  }
+};
+
+// Validates the arguments and pads the waveform and the window.
+Inputs prepare(
+    const torch::Tensor& waveform,
+    const torch::Tensor& window,
+    const torch::Tensor& fb,
+    int64_t n_fft,
+    int64_t hop_length,
+    bool center,
+    const std::string& pad_mode,
+    bool normalized);
+
+// Returns the spectra of the frames [frame_begin, frame_end) of the rows
+// [wave_begin, wave_end) of `inputs.waveform`, of shape
+// [wave_end - wave_begin, frame_end - frame_begin, n_freqs], complex.
+torch::Tensor spectrum(
+    const Inputs& inputs,
+    int64_t wave_begin,
+    int64_t wave_end,
+    int64_t frame_begin,
+    int64_t frame_end);
+
+} // namespace mel_spectrogram
+} // namespace torchaudio
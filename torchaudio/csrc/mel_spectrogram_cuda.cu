@@ -0,0 +1,127 @@
+#include <ATen/cuda/CUDAContext.h>
+#include <c10/cuda/CUDAGuard.h>
+#include <torchaudio/csrc/mel_spectrogram.h>
+
+namespace {
+
+constexpr int kThreads = 128;
+// Maximum number of waveforms handled by a row of the grid.
+constexpr int64_t kMaxGridY = 65535;
+// Maximum number of frequency bins of the spectra of a chunk of frames.
+constexpr int64_t kMaxChunkBins = 1 << 22;
+
+template <typename scalar_t>
+__device__ __forceinline__ scalar_t
+to_power(const c10::complex<scalar_t>& z, scalar_t power) {
+  const scalar_t norm = z.real() * z.real() + z.imag() * z.imag();
+  if (power == 2) {
+    return norm;
+  }
+  if (power == 1) {
+    return sqrt(norm);
+  }
+  return pow(norm, power / 2);
+}
+
+// One block computes one frame of one waveform, and one thread one mel band
+// of it. A frequency bin is shared by at most two neighbouring bands, so its
+// power is computed where it is summed instead of being stored.
+template <typename scalar_t>
+__global__ void mel_spectrogram_cuda_kernel(
+    const c10::complex<scalar_t>* __restrict__ spec,
+    const scalar_t* __restrict__ fb,
+    const int64_t* __restrict__ band_begin,
+    const int64_t* __restrict__ band_end,
+    scalar_t* __restrict__ output,
+    int64_t num_waves,
+    int64_t chunk_frames,
+    int64_t frame_begin,
+    int64_t num_frames,
+    int64_t n_freqs,
+    int64_t n_mels,
+    scalar_t power,
+    bool take_log,
+    scalar_t log_offset) {
+  const int64_t f = blockIdx.x;
+  for (int64_t w = blockIdx.y; w < num_waves; w += gridDim.y) {
+    const c10::complex<scalar_t>* row = spec + (w * chunk_frames + f) * n_freqs;
+    for (int64_t m = threadIdx.x; m < n_mels; m += blockDim.x) {
+      const scalar_t* weights = fb + m * n_freqs;
+      scalar_t sum = 0;
+      for (int64_t k = band_begin[m]; k < band_end[m]; ++k) {
+        sum += weights[k] * to_power(row[k], power);
+      }
+      output[(w * n_mels + m) * num_frames + frame_begin + f] =
+          take_log ? log(sum + log_offset) : sum;
+    }
+  }
+}
+
+torch::Tensor mel_spectrogram_cuda(
+    const torch::Tensor& waveform,
+    const torch::Tensor& window,
+    const torch::Tensor& fb,
+    int64_t n_fft,
+    int64_t hop_length,
+    bool center,
+    const std::string& pad_mode,
+    bool normalized,
+    double power,
+    c10::optional<double> log_offset) {
+  using namespace torchaudio::mel_spectrogram;
+  const c10::cuda::CUDAGuard device_guard(waveform.device());
+  const auto inputs = prepare(
+      waveform, window, fb, n_fft, hop_length, center, pad_mode, normalized);
+  const int64_t num_waves = inputs.num_waves();
+  const int64_t num_frames = inputs.num_frames;
+  const int64_t n_freqs = inputs.n_freqs();
+  const int64_t n_mels = inputs.n_mels();
+  auto output = torch::empty(
+      {num_waves, n_mels, num_frames}, inputs.waveform.options());
+
+  if (num_waves > 0 && num_frames > 0) {
+    // The spectra are computed by cuFFT for a chunk of frames of all the
+    // waveforms at a time, which bounds the memory they take.
+    const int64_t chunk_frames = std::min(
+        num_frames,
+        std::max<int64_t>(1, kMaxChunkBins / (num_waves * n_freqs)));
+    const auto stream = at::cuda::getCurrentCUDAStream();
+    AT_DISPATCH_FLOATING_TYPES(
+        inputs.waveform.scalar_type(), "mel_spectrogram_cuda", [&] {
+          for (int64_t frame_begin = 0; frame_begin < num_frames;
+               frame_begin += chunk_frames) {
+            const int64_t frame_end =
+                std::min(frame_begin + chunk_frames, num_frames);
+            const auto spec =
+                spectrum(inputs, 0, num_waves, frame_begin, frame_end)
+                    .contiguous();
+            const dim3 blocks(
+                frame_end - frame_begin, std::min(num_waves, kMaxGridY));
+            mel_spectrogram_cuda_kernel<scalar_t>
+                <<<blocks, kThreads, 0, stream>>>(
+                    spec.data_ptr<c10::complex<scalar_t>>(),
+                    inputs.fb.data_ptr<scalar_t>(),
+                    inputs.band_begin.data_ptr<int64_t>(),
+                    inputs.band_end.data_ptr<int64_t>(),
+                    output.data_ptr<scalar_t>(),
+                    num_waves,
+                    frame_end - frame_begin,
+                    frame_begin,
+                    num_frames,
+                    n_freqs,
+                    n_mels,
+                    static_cast<scalar_t>(power),
+                    log_offset.has_value(),
+                    static_cast<scalar_t>(log_offset.value_or(0.)));
+            C10_CUDA_KERNEL_LAUNCH_CHECK();
+          }
+        });
+  }
+  return output.reshape(inputs.output_sizes);
+}
+
+} // namespace
+
+TORCH_LIBRARY_IMPL(torchaudio, CUDA, m) {
+  m.impl("torchaudio::_mel_spectrogram", &mel_spectrogram_cuda);
+}
@@ -1,52 +1,62 @@
-#include <torch/script.h>
-#include <torch/torch.h>
+#include <torchaudio/csrc/cpu/kernels.h>
+#include <torchaudio/csrc/overdrive.h>
+
+namespace torchaudio {
+namespace cpu {
+
+TORCHAUDIO_DEFINE_DISPATCH(overdrive_fn, overdrive_stub);
+
+} // namespace cpu
 
 namespace {
 
-template <typename scalar_t>
-void overdrive_cpu_kernel(
-    at::TensorAccessor<scalar_t, 2> waveform_accessor,
-    at::TensorAccessor<scalar_t, 2> temp_accessor,
-    at::TensorAccessor<scalar_t, 1> last_in_accessor,
-    at::TensorAccessor<scalar_t, 1> last_out_accessor,
-    at::TensorAccessor<scalar_t, 2> output_waveform_accessor) {
-  int64_t n_frames = waveform_accessor.size(1);
-  int64_t n_channels = waveform_accessor.size(0);
-
-  at::parallel_for(0, n_channels, 1, [&](int64_t begin, int64_t end) {
-    for (int64_t i_channel = begin; i_channel < end; ++i_channel) {
-      for (int64_t i_frame = 0; i_frame < n_frames; ++i_frame) {
-        last_out_accessor[i_channel] = temp_accessor[i_channel][i_frame] -
-            last_in_accessor[i_channel] + 0.995 * last_out_accessor[i_channel];
-        last_in_accessor[i_channel] = temp_accessor[i_channel][i_frame];
-        output_waveform_accessor[i_channel][i_frame] =
-            waveform_accessor[i_channel][i_frame] * 0.5 +
-            last_out_accessor[i_channel] * 0.75;
-      }
-    }
-  });
+void overdrive_core_loop_cpu(
+    const torch::Tensor& waveform,
+    const torch::Tensor& temp,
+    torch::Tensor& last_in,
+    torch::Tensor& last_out,
+    torch::Tensor& output_waveform) {
+  TORCH_CHECK(
+      waveform.is_contiguous() && temp.is_contiguous() &&
+      last_in.is_contiguous() && last_out.is_contiguous() &&
+      output_waveform.is_contiguous());
+
+  cpu::overdrive_stub(waveform, temp, last_in, last_out, output_waveform);
 }
 
-void overdrive_core_loop_cpu(
-    at::Tensor& waveform,
-    at::Tensor& temp,
-    at::Tensor& last_in,
-    at::Tensor& last_out,
-    at::Tensor& output_waveform) {
-  AT_DISPATCH_FLOATING_TYPES(waveform.scalar_type(), "overdrive_cpu", ([&] {
-                               overdrive_cpu_kernel<scalar_t>(
-                                   waveform.accessor<scalar_t, 2>(),
-                                   temp.accessor<scalar_t, 2>(),
-                                   last_in.accessor<scalar_t, 1>(),
-                                   last_out.accessor<scalar_t, 1>(),
-                                   output_waveform.accessor<scalar_t, 2>());
-                             }));
+// Used for the devices that do not have a native kernel.
+void overdrive_core_loop_generic(
+    const torch::Tensor& waveform,
+    const torch::Tensor& temp,
+    torch::Tensor& last_in,
+    torch::Tensor& last_out,
+    torch::Tensor& output_waveform) {
+  using torch::indexing::Slice;
+  for (int64_t i = 0; i < waveform.size(1); i++) {
+    auto temp_i = temp.index({Slice(), i});
+    last_out.copy_(temp_i - last_in + 0.995 * last_out);
+    last_in.copy_(temp_i);
+    output_waveform.index_put_(
+        {Slice(), i}, waveform.index({Slice(), i}) * 0.5 + last_out * 0.75);
+  }
 }
 
 } // namespace
+} // namespace torchaudio
 
-// Note: We want to avoid using "catch-all" kernel.
-// The following registration should be replaced with CPU specific registration.
 TORCH_LIBRARY_FRAGMENT(torchaudio, m) {
-  m.def("torchaudio::_overdrive_core_loop", &overdrive_core_loop_cpu);
+  m.def(
+      "torchaudio::_overdrive_core_loop(Tensor waveform, Tensor temp, Tensor(a!) last_in, Tensor(b!) last_out, Tensor(c!) output_waveform) -> ()");
+}
+
+TORCH_LIBRARY_IMPL(torchaudio, CPU, m) {
+  m.impl(
+      "torchaudio::_overdrive_core_loop",
+      &torchaudio::overdrive_core_loop_cpu);
+}
+
+TORCH_LIBRARY_IMPL(torchaudio, CompositeExplicitAutograd, m) {
+  m.impl(
+      "torchaudio::_overdrive_core_loop",
+      &torchaudio::overdrive_core_loop_generic);
 }
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <torchaudio/csrc/stateful_effect.h>
+
+namespace torchaudio {
+namespace effects {
+inline namespace TORCHAUDIO_CPU_CAPABILITY_NAMESPACE {
+
+// High-pass filter of the clipped signal, mixed with the dry signal.
+// The inputs are the dry waveform and the clipped signal, `temp`, and the
+// state of a channel is (last_in, last_out).
+template <typename scalar_t>
+struct OverdriveEffect {
+  static constexpr int64_t kNumInputs = 2;
+
+  int64_t state_size() const {
+    return 2;
+  }
+
+  TORCHAUDIO_HOST_DEVICE scalar_t operator()(
+      StateView<scalar_t> state,
+      const scalar_t* inputs,
+      int64_t /*i_frame*/) const {
+    const scalar_t temp = inputs[1];
+    const scalar_t last_out = temp - state[0] + scalar_t(0.995) * state[1];
+    state[0] = temp;
+    state[1] = last_out;
+    return inputs[0] * scalar_t(0.5) + last_out * scalar_t(0.75);
+  }
+};
+
+} // namespace TORCHAUDIO_CPU_CAPABILITY_NAMESPACE
+} // namespace effects
+} // namespace torchaudio
@@ -0,0 +1,29 @@
+#include <torchaudio/csrc/overdrive.h>
+#include <torchaudio/csrc/stateful_effect_cuda.cuh>
+
+namespace {
+
+void overdrive_core_loop_cuda(
+    const torch::Tensor& waveform,
+    const torch::Tensor& temp,
+    torch::Tensor& last_in,
+    torch::Tensor& last_out,
+    torch::Tensor& output_waveform) {
+  using namespace torchaudio::effects;
+  auto state = torch::stack({last_in, last_out}, 1);
+  AT_DISPATCH_FLOATING_TYPES(waveform.scalar_type(), "overdrive_cuda", ([&] {
+                               run_stateful_effect_cuda<scalar_t>(
+                                   OverdriveEffect<scalar_t>{},
+                                   {waveform, temp},
+                                   state,
+                                   output_waveform);
+                             }));
+  last_in.copy_(state.select(1, 0));
+  last_out.copy_(state.select(1, 1));
+}
+
+} // namespace
+
+TORCH_LIBRARY_IMPL(torchaudio, CUDA, m) {
+  m.impl("torchaudio::_overdrive_core_loop", &overdrive_core_loop_cuda);
+}
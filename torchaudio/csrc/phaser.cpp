@@ -0,0 +1,84 @@
+#include <torchaudio/csrc/phaser.h>
+
+namespace torchaudio {
+namespace {
+
+void check_phaser_args(
+    const torch::Tensor& waveform,
+    const torch::Tensor& mod_table,
+    const torch::Tensor& delay_buf) {
+  TORCH_CHECK(waveform.dim() == 2, "waveform must be a 2D tensor");
+  TORCH_CHECK(
+      mod_table.dim() == 1 && mod_table.numel() > 0,
+      "mod_table must be a non-empty 1D tensor");
+  TORCH_CHECK(
+      mod_table.scalar_type() == torch::kInt32, "mod_table must be int32");
+  TORCH_CHECK(
+      mod_table.device() == waveform.device(),
+      "mod_table must be on the same device as waveform");
+  TORCH_CHECK(
+      delay_buf.dim() == 2 && delay_buf.size(1) > 0,
+      "delay_buf must be a 2D tensor with a non-empty delay line");
+}
+
+void phaser_core_loop_cpu(
+    const torch::Tensor& waveform,
+    const torch::Tensor& mod_table,
+    torch::Tensor& delay_buf,
+    torch::Tensor& output_waveform,
+    double decay) {
+  check_phaser_args(waveform, mod_table, delay_buf);
+  const auto mod = mod_table.contiguous();
+  AT_DISPATCH_FLOATING_TYPES(waveform.scalar_type(), "phaser_cpu", ([&] {
+                               effects::run_stateful_effect_cpu<scalar_t>(
+                                   effects::PhaserEffect<scalar_t>{
+                                       mod.data_ptr<int32_t>(),
+                                       mod.numel(),
+                                       delay_buf.size(1),
+                                       static_cast<scalar_t>(decay)},
+                                   {waveform},
+                                   delay_buf,
+                                   output_waveform);
+                             }));
+}
+
+// Used for the devices that do not have a native kernel.
+void phaser_core_loop_generic(
+    const torch::Tensor& waveform,
+    const torch::Tensor& mod_table,
+    torch::Tensor& delay_buf,
+    torch::Tensor& output_waveform,
+    double decay) {
+  using torch::indexing::Slice;
+  check_phaser_args(waveform, mod_table, delay_buf);
+  const auto mod = mod_table.to(torch::kCPU).contiguous();
+  const int32_t* mod_data = mod.data_ptr<int32_t>();
+  const int64_t mod_table_size = mod.numel();
+  const int64_t delay_buf_len = delay_buf.size(1);
+  for (int64_t i = 0; i < waveform.size(1); i++) {
+    const int64_t delay_pos = i % delay_buf_len;
+    const int64_t idx =
+        (delay_pos + mod_data[i % mod_table_size]) % delay_buf_len;
+    auto temp = waveform.index({Slice(), i}) + delay_buf.index({Slice(), idx});
+    delay_buf.index_put_(
+        {Slice(), (delay_pos + 1) % delay_buf_len}, temp * decay);
+    output_waveform.index_put_({Slice(), i}, temp);
+  }
+}
+
+} // namespace
+} // namespace torchaudio
+
+TORCH_LIBRARY_FRAGMENT(torchaudio, m) {
+  m.def(
+      "torchaudio::_phaser_core_loop(Tensor waveform, Tensor mod_table, Tensor(a!) delay_buf, Tensor(b!) output_waveform, float decay) -> ()");
+}
+
+TORCH_LIBRARY_IMPL(torchaudio, CPU, m) {
+  m.impl("torchaudio::_phaser_core_loop", &torchaudio::phaser_core_loop_cpu);
+}
+
+TORCH_LIBRARY_IMPL(torchaudio, CompositeExplicitAutograd, m) {
+  m.impl(
+      "torchaudio::_phaser_core_loop", &torchaudio::phaser_core_loop_generic);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <torchaudio/csrc/stateful_effect.h>
+
+namespace torchaudio {
+namespace effects {
+
+// Modulated feedback delay line of the phaser effect. The state of a
+// channel is its delay buffer. The read position is modulated by
+// `mod_table`, which is shared by all the channels, and both positions only
+// depend on the frame index, so the channels run in lockstep. Both positions
+// start from 0 at every call, as at the start of a SoX stream.
+template <typename scalar_t>
+struct PhaserEffect {
+  static constexpr int64_t kNumInputs = 1;
+
+  const int32_t* mod_table;
+  int64_t mod_table_size;
+  int64_t delay_buf_len;
+  scalar_t decay;
+
+  int64_t state_size() const {
+    return delay_buf_len;
+  }
+
+  TORCHAUDIO_HOST_DEVICE scalar_t operator()(
+      StateView<scalar_t> delay_buf,
+      const scalar_t* inputs,
+      int64_t i_frame) const {
+    const int64_t delay_pos = i_frame % delay_buf_len;
+    const int64_t idx =
+        (delay_pos + mod_table[i_frame % mod_table_size]) % delay_buf_len;
+    const scalar_t temp = inputs[0] + delay_buf[idx];
+    delay_buf[(delay_pos + 1) % delay_buf_len] = temp * decay;
+    return temp;
+  }
+};
+
+} // namespace effects
+} // namespace torchaudio
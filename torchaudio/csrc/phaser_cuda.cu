@@ -0,0 +1,43 @@
+#include <torchaudio/csrc/phaser.h>
+#include <torchaudio/csrc/stateful_effect_cuda.cuh>
+
+namespace {
+
+void phaser_core_loop_cuda(
+    const torch::Tensor& waveform,
+    const torch::Tensor& mod_table,
+    torch::Tensor& delay_buf,
+    torch::Tensor& output_waveform,
+    double decay) {
+  using namespace torchaudio::effects;
+  TORCH_CHECK(
+      mod_table.dim() == 1 && mod_table.numel() > 0,
+      "mod_table must be a non-empty 1D tensor");
+  TORCH_CHECK(
+      mod_table.scalar_type() == torch::kInt32, "mod_table must be int32");
+  TORCH_CHECK(
+      mod_table.device() == waveform.device(),
+      "mod_table must be on the same device as waveform");
+  TORCH_CHECK(
+      delay_buf.dim() == 2 && delay_buf.size(1) > 0,
+      "delay_buf must be a 2D tensor with a non-empty delay line");
+
+  const auto mod = mod_table.contiguous();
+  AT_DISPATCH_FLOATING_TYPES(waveform.scalar_type(), "phaser_cuda", ([&] {
+                               run_stateful_effect_cuda<scalar_t>(
+                                   PhaserEffect<scalar_t>{
+                                       mod.data_ptr<int32_t>(),
+                                       mod.numel(),
+                                       delay_buf.size(1),
+                                       static_cast<scalar_t>(decay)},
+                                   {waveform},
+                                   delay_buf,
+                                   output_waveform);
+                             }));
+}
+
+} // namespace
+
+TORCH_LIBRARY_IMPL(torchaudio, CUDA, m) {
+  m.impl("torchaudio::_phaser_core_loop", &phaser_core_loop_cuda);
+}
@@ -48,6 +48,9 @@ std::tuple<torch::Tensor, int64_t> apply_effects_fileobj(
   // the whole audio data are fetched.
   //
   // * This can be changed with `torchaudio.utils.sox_utils.set_buffer_size`.
+  //
+  // The buffer holds twice as much so that it can be refilled in large chunks.
+  // See `fileobj_input_drain` in effects_chain.cpp.
   const auto capacity = [&]() {
     // NOTE:
     // Use the abstraction provided by `libtorchaudio` to access the global
@@ -56,8 +59,9 @@ std::tuple<torch::Tensor, int64_t> apply_effects_fileobj(
     // not correct.
     const auto bufsiz = get_buffer_size();
     const size_t kDefaultCapacityInBytes = 256;
-    return (bufsiz > kDefaultCapacityInBytes) ? bufsiz
-                                              : kDefaultCapacityInBytes;
+    return 2 *
+        ((bufsiz > kDefaultCapacityInBytes) ? bufsiz
+                                            : kDefaultCapacityInBytes);
   }();
   std::string buffer(capacity, '\0');
   auto* in_buf = const_cast<char*>(buffer.data());
@@ -85,11 +89,7 @@ std::tuple<torch::Tensor, int64_t> apply_effects_fileobj(
   // In case of streamed data, length can be 0
   validate_input_memfile(sf);
 
-  // Prepare output buffer
-  std::vector<sox_sample_t> out_buffer;
-  out_buffer.reserve(sf->signal.length);
-
-  // Create and run SoxEffectsChain
+  // Create SoxEffectsChain
   const auto dtype = get_dtype(sf->encoding.encoding, sf->signal.precision);
   torchaudio::sox_effects_chain::SoxEffectsChainPyBind chain(
       /*input_encoding=*/sf->encoding,
@@ -98,21 +98,31 @@ std::tuple<torch::Tensor, int64_t> apply_effects_fileobj(
   for (const auto& effect : effects) {
     chain.addEffect(effect);
   }
-  chain.addOutputBuffer(&out_buffer);
-  chain.run();
 
-  // Create tensor from buffer
-  bool channels_first_ = channels_first.value_or(true);
-  auto tensor = convert_to_tensor(
-      /*buffer=*/out_buffer.data(),
-      /*num_samples=*/out_buffer.size(),
-      /*num_channels=*/chain.getOutputNumChannels(),
+  // In case of streamed data, the length is not known and the output tensor
+  // grows as the data come.
+  TensorOutputSink sink(
       dtype,
       normalize.value_or(true),
-      channels_first_);
+      channels_first.value_or(true),
+      /*num_channels=*/chain.getOutputNumChannels(),
+      /*num_frames=*/chain.getOutputNumFrames());
+  torchaudio::sox_effects_chain::OutputCallback callback =
+      [&](const sox_sample_t* samples, size_t num_samples) {
+        sink.write(samples, num_samples);
+        return true;
+      };
+  chain.addOutputCallback(&callback);
+  {
+    // Decode without GIL, so that multiple files can be processed by
+    // multiple Python threads in parallel. The GIL is acquired only when
+    // the fileobj is read.
+    py::gil_scoped_release release;
+    chain.run();
+  }
 
   return std::make_tuple(
-      tensor, static_cast<int64_t>(chain.getOutputSampleRate()));
+      sink.finalize(), static_cast<int64_t>(chain.getOutputSampleRate()));
 }
 
 } // namespace sox_effects
@@ -9,6 +9,10 @@ namespace sox_effects_chain {
 
 namespace {
 
+// The encoded data are written to the fileobj in chunks of at least this size.
+// The rest is written after the chain is closed.
+constexpr long kOutputBatchSizeInBytes = 1 << 16;
+
 /// helper classes for passing file-like object to SoxEffectChain
 struct FileObjInputPriv {
   sox_format_t* sf;
@@ -16,6 +20,8 @@ struct FileObjInputPriv {
   bool eof_reached;
   char* buffer;
   uint64_t buffer_size;
+  // The maximum number of samples to decode at a time, or 0 for no limit.
+  size_t chain_buffer_size;
 };
 
 struct FileObjOutputPriv {
@@ -51,6 +57,11 @@ int fileobj_input_drain(sox_effect_t* effp, sox_sample_t* obuf, size_t* osamp) {
   //     |<-offset->|<---remaining--->|<-new data->|
   //     |**********|-----------------|++++++++++++|
   //                ^ ftell
+  //
+  // The buffer is twice as large as what libsox needs for one read, and it is
+  // refilled only once at least a half of it has been consumed, so that the
+  // data are fetched in large chunks, and the unconsumed data moved at the
+  // time of refill are at most a half of the buffer.
 
   // NOTE:
   //   Do not use `sf->tell_off` here. Presumably, `tell_off` and `fseek` are
@@ -69,40 +80,48 @@ int fileobj_input_drain(sox_effect_t* effp, sox_sample_t* obuf, size_t* osamp) {
 
   const auto num_remain = priv->buffer_size - num_consumed;
 
-  // 1.1. Fetch the data to see if there is data to fill the buffer
-  size_t num_refill = 0;
-  std::string chunk(num_consumed, '\0');
-  if (num_consumed && !priv->eof_reached) {
-    num_refill = read_fileobj(
-        priv->fileobj, num_consumed, const_cast<char*>(chunk.data()));
+  if (!priv->eof_reached && num_consumed &&
+      num_remain < priv->buffer_size / 2) {
+    // 1.1. Move the unconsumed data to the beginning of buffer.
+    if (num_remain) {
+      memmove(buffer, buffer + num_consumed, num_remain);
+    }
+
+    // 1.2. Read the new data directly into the buffer, after the unconsumed
+    // data.
+    // The chain runs without GIL. It is acquired only while reading the
+    // fileobj, which happens once for every refill.
+    const auto num_refill = [&]() {
+      py::gil_scoped_acquire acquire;
+      return read_fileobj(priv->fileobj, num_consumed, buffer + num_remain);
+    }();
     if (num_refill < num_consumed) {
       priv->eof_reached = true;
     }
-  }
-  const auto offset = num_consumed - num_refill;
 
-  // 1.2. Move the unconsumed data towards the beginning of buffer.
-  if (num_remain) {
-    auto src = static_cast<void*>(buffer + num_consumed);
-    auto dst = static_cast<void*>(buffer + offset);
-    memmove(dst, src, num_remain);
-  }
+    // 1.3. Align the content at the end of the buffer. This happens only once,
+    // when the fileobj is exhausted.
+    const auto offset = num_consumed - num_refill;
+    if (offset) {
+      memmove(buffer + offset, buffer, num_remain + num_refill);
+    }
 
-  // 1.3. Refill the remaining buffer.
-  if (num_refill) {
-    auto src = static_cast<void*>(const_cast<char*>(chunk.c_str()));
-    auto dst = buffer + offset + num_remain;
-    memcpy(dst, src, num_refill);
+    // 1.4. Set the file pointer to the new offset. This also discards the data
+    // FILE* buffered internally.
+    sf->tell_off = offset;
+    fseek((FILE*)sf->fp, offset, SEEK_SET);
   }
 
-  // 1.4. Set the file pointer to the new offset
-  sf->tell_off = offset;
-  fseek((FILE*)sf->fp, offset, SEEK_SET);
-
   // 2. Perform decoding operation
   // The following part is practically same as "input" effect
   // https://github.com/dmkrepo/libsox/blob/b9dd1a86e71bbd62221904e3e59dfaa9e5e72046/src/input.c#L30-L48
 
+  // Limit to the buffer size of the chain, but read at least one frame.
+  if (priv->chain_buffer_size) {
+    *osamp = std::min(
+        *osamp,
+        std::max<size_t>(priv->chain_buffer_size, effp->out_signal.channels));
+  }
   // Ensure that it's a multiple of the number of channels
   *osamp -= *osamp % effp->out_signal.channels;
 
@@ -128,18 +147,22 @@ int fileobj_output_flow(
     auto fp = static_cast<FILE*>(sf->fp);
     auto fileobj = priv->fileobj;
     auto buffer = priv->buffer;
-    auto buffer_size = priv->buffer_size;
 
     // Encode chunk
     auto num_samples_written = sox_write(sf, ibuf, *isamp);
     fflush(fp);
 
-    // Copy the encoded chunk to python object.
-    fileobj->attr("write")(py::bytes(*buffer, ftell(fp)));
+    // Copy the encoded chunks to python object, once enough of them are
+    // accumulated. The chain runs without GIL, so it is acquired only here.
+    const auto num_bytes = ftell(fp);
+    if (num_bytes >= kOutputBatchSizeInBytes) {
+      py::gil_scoped_acquire acquire;
+      fileobj->attr("write")(py::bytes(*buffer, num_bytes));
 
-    // Reset FILE*
-    sf->tell_off = 0;
-    fseek(fp, 0, SEEK_SET);
+      // Reset FILE*
+      sf->tell_off = 0;
+      fseek(fp, 0, SEEK_SET);
+    }
 
     if (num_samples_written != *isamp) {
       if (sf->sox_errno) {
@@ -201,6 +224,7 @@ void SoxEffectsChainPyBind::addInputFileObj(
   priv->eof_reached = false;
   priv->buffer = buffer;
   priv->buffer_size = buffer_size;
+  priv->chain_buffer_size = buffer_size_;
   if (sox_add_effect(sec_, e, &interm_sig_, &in_sig_) != SOX_SUCCESS) {
     throw std::runtime_error(
         "Internal Error: Failed to add effect: input fileobj");
@@ -170,11 +170,16 @@ void save_audio_fileobj(
       /*output_encoding=*/sf->encoding);
   chain.addInputTensor(&tensor, sample_rate, channels_first);
   chain.addOutputFileObj(sf, &buffer.ptr, &buffer.size, &fileobj);
-  chain.run();
-
-  // Closing the sox_format_t is necessary for flushing the last chunk to the
-  // buffer
-  sf.close();
+  {
+    // Encode without GIL. The GIL is acquired only when the fileobj is
+    // written.
+    py::gil_scoped_release release;
+    chain.run();
+
+    // Closing the sox_format_t is necessary for flushing the last chunk to the
+    // buffer
+    sf.close();
+  }
 
   fileobj.attr("write")(py::bytes(buffer.ptr, buffer.size));
 }
@@ -3,13 +3,29 @@
 namespace torchaudio {
 namespace sox_utils {
 
-uint64_t read_fileobj(py::object* fileobj, const uint64_t size, char* buffer) {
+namespace {
+
+/// Reads with `readinto` method, directly into the given buffer.
+uint64_t readinto_fileobj(
+    py::object* fileobj,
+    const uint64_t size,
+    char* buffer) {
+  auto readinto = fileobj->attr("readinto");
   uint64_t num_read = 0;
   while (num_read < size) {
     auto request = size - num_read;
-    auto chunk = static_cast<std::string>(
-        static_cast<py::bytes>(fileobj->attr("read")(request)));
-    auto chunk_len = chunk.length();
+    auto view = py::reinterpret_steal<py::object>(
+        PyMemoryView_FromMemory(
+            buffer, static_cast<Py_ssize_t>(request), PyBUF_WRITE));
+    if (!view) {
+      throw py::error_already_set();
+    }
+    auto result = readinto(view);
+    // `None` means that no data is available without blocking.
+    if (result.is_none()) {
+      break;
+    }
+    auto chunk_len = result.cast<uint64_t>();
     if (chunk_len == 0) {
       break;
     }
@@ -21,7 +37,40 @@ uint64_t read_fileobj(py::object* fileobj, const uint64_t size, char* buffer) {
           << "The given object does not confirm to read protocol of file object.";
       throw std::runtime_error(message.str());
     }
-    memcpy(buffer, chunk.data(), chunk_len);
+    buffer += chunk_len;
+    num_read += chunk_len;
+  }
+  return num_read;
+}
+
+} // namespace
+
+uint64_t read_fileobj(py::object* fileobj, const uint64_t size, char* buffer) {
+  if (py::hasattr(*fileobj, "readinto")) {
+    return readinto_fileobj(fileobj, size, buffer);
+  }
+  uint64_t num_read = 0;
+  while (num_read < size) {
+    auto request = size - num_read;
+    auto chunk = fileobj->attr("read")(request);
+    // Copy out of the returned bytes without an intermediate string.
+    char* chunk_data = nullptr;
+    Py_ssize_t chunk_len = 0;
+    if (PyBytes_AsStringAndSize(chunk.ptr(), &chunk_data, &chunk_len) < 0) {
+      throw py::error_already_set();
+    }
+    if (chunk_len == 0) {
+      break;
+    }
+    if (static_cast<uint64_t>(chunk_len) > request) {
+      std::ostringstream message;
+      message
+          << "Requested up to " << request << " bytes but, "
+          << "received " << chunk_len << " bytes. "
+          << "The given object does not confirm to read protocol of file object.";
+      throw std::runtime_error(message.str());
+    }
+    memcpy(buffer, chunk_data, chunk_len);
     buffer += chunk_len;
     num_read += chunk_len;
   }
@@ -6,6 +6,10 @@
 namespace torchaudio {
 namespace sox_utils {
 
+/// Reads up to `size` bytes from the file-like object into `buffer`, and
+/// returns the number of bytes read, which is less than `size` only at EOF.
+/// The data are read directly into `buffer` if the object has `readinto`
+/// method.
 uint64_t read_fileobj(py::object* fileobj, uint64_t size, char* buffer);
 
 } // namespace sox_utils
@@ -0,0 +1,312 @@
+#include <torchaudio/csrc/resample.h>
+
+#include <cmath>
+#include <map>
+
+namespace torchaudio {
+namespace resample {
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+// Same as the default of `functional.resample`.
+constexpr double kDefaultKaiserBeta = 14.769656459379492;
+// The cache is cleared when it grows past this many kernels.
+constexpr size_t kMaxCachedKernels = 64;
+// Number of output samples of a waveform computed by a task.
+constexpr int64_t kOutputBlock = 1024;
+
+// Modified Bessel function of the first kind of order 0, by its power series.
+double bessel_i0(double x) {
+  const double q = x * x / 4;
+  double term = 1;
+  double sum = 1;
+  for (int k = 1; term > sum * 1e-17; ++k) {
+    term *= q / (static_cast<double>(k) * k);
+    sum += term;
+  }
+  return sum;
+}
+
+std::shared_ptr<PolyphaseKernel> compute_polyphase_kernel(
+    int64_t orig_freq,
+    int64_t new_freq,
+    int64_t lowpass_filter_width,
+    double rolloff,
+    bool kaiser_window,
+    double beta) {
+  // See `_get_sinc_resample_kernel` for the derivation.
+  const double base_freq = std::min(orig_freq, new_freq) * rolloff;
+  const double lpw = static_cast<double>(lowpass_filter_width);
+  const int64_t width =
+      static_cast<int64_t>(std::ceil(lpw * orig_freq / base_freq));
+  const int64_t full_size = 2 * width + orig_freq;
+  const double scale = base_freq / orig_freq;
+  const double i0_beta = kaiser_window ? bessel_i0(beta) : 1.;
+
+  // Position of the tap `j` of the phase in the unit of zero crossings.
+  const auto position = [&](int64_t phase, int64_t j) {
+    return (-static_cast<double>(phase) / new_freq +
+            static_cast<double>(j - width) / orig_freq) *
+        base_freq;
+  };
+  const auto value = [&](int64_t phase, int64_t j) {
+    double t = std::min(std::max(position(phase, j), -lpw), lpw);
+    double window;
+    if (kaiser_window) {
+      window = bessel_i0(beta * std::sqrt(1 - (t / lpw) * (t / lpw))) / i0_beta;
+    } else {
+      window = std::cos(t * kPi / lpw / 2);
+      window *= window;
+    }
+    t *= kPi;
+    return (t == 0 ? 1. : std::sin(t) / t) * window * scale;
+  };
+
+  auto kernel = std::make_shared<PolyphaseKernel>();
+  kernel->orig_freq = orig_freq;
+  kernel->new_freq = new_freq;
+  kernel->width = width;
+  kernel->offsets.resize(new_freq);
+  int64_t max_support = 1;
+  for (int64_t phase = 0; phase < new_freq; ++phase) {
+    // The positions increase with `j`, so the support is a single interval.
+    int64_t first = 0;
+    while (first < full_size - 1 && position(phase, first) < -lpw) {
+      ++first;
+    }
+    int64_t last = full_size - 1;
+    while (last > first && position(phase, last) > lpw) {
+      --last;
+    }
+    kernel->offsets[phase] = first;
+    max_support = std::max(max_support, last - first + 1);
+  }
+  constexpr int64_t kAlign = PolyphaseKernel::kTapAlignment;
+  kernel->num_taps = (max_support + kAlign - 1) / kAlign * kAlign;
+  kernel->taps.assign(new_freq * kernel->num_taps, 0.);
+  for (int64_t phase = 0; phase < new_freq; ++phase) {
+    double* taps = kernel->taps.data() + phase * kernel->num_taps;
+    const int64_t first = kernel->offsets[phase];
+    const int64_t num_taps = std::min(kernel->num_taps, full_size - first);
+    for (int64_t k = 0; k < num_taps; ++k) {
+      taps[k] = value(phase, first + k);
+    }
+  }
+  return kernel;
+}
+
+// Dot product of `n` samples, a multiple of `kTapAlignment`. The partial sums
+// of the lanes are independent, so the loop is vectorized.
+template <typename scalar_t>
+C10_ALWAYS_INLINE scalar_t
+dot_aligned(const scalar_t* x, const scalar_t* h, int64_t n) {
+  constexpr int64_t kLanes = PolyphaseKernel::kTapAlignment;
+  scalar_t acc[kLanes] = {};
+  for (int64_t t = 0; t < n; t += kLanes) {
+    for (int64_t l = 0; l < kLanes; ++l) {
+      acc[l] += x[t + l] * h[t + l];
+    }
+  }
+  scalar_t sum = 0;
+  for (int64_t l = 0; l < kLanes; ++l) {
+    sum += acc[l];
+  }
+  return sum;
+}
+
+// Dot product where the input starting at `start` is zero outside of
+// [0, length).
+template <typename scalar_t>
+scalar_t dot_bounded(
+    const scalar_t* x,
+    int64_t start,
+    int64_t length,
+    const scalar_t* h,
+    int64_t n) {
+  scalar_t sum = 0;
+  const int64_t end = std::min(n, length - start);
+  for (int64_t t = std::max<int64_t>(0, -start); t < end; ++t) {
+    sum += x[start + t] * h[t];
+  }
+  return sum;
+}
+
+template <typename scalar_t>
+void resample_cpu_kernel(
+    const torch::Tensor& input,
+    torch::Tensor& output,
+    const PolyphaseKernel& kernel,
+    const torch::Tensor& taps) {
+  const int64_t num_waves = input.size(0);
+  const int64_t length = input.size(1);
+  const int64_t output_length = output.size(1);
+  const int64_t num_blocks = (output_length + kOutputBlock - 1) / kOutputBlock;
+  const int64_t num_taps = kernel.num_taps;
+  const int64_t orig_freq = kernel.orig_freq;
+  const int64_t new_freq = kernel.new_freq;
+  const int64_t* offsets = kernel.offsets.data();
+  const scalar_t* taps_data = taps.data_ptr<scalar_t>();
+  const scalar_t* input_data = input.data_ptr<scalar_t>();
+  scalar_t* output_data = output.data_ptr<scalar_t>();
+
+  at::parallel_for(
+      0, num_waves * num_blocks, 1, [&](int64_t begin, int64_t end) {
+        for (int64_t block = begin; block < end; ++block) {
+          const scalar_t* x = input_data + (block / num_blocks) * length;
+          scalar_t* y = output_data + (block / num_blocks) * output_length;
+          const int64_t n_begin = (block % num_blocks) * kOutputBlock;
+          const int64_t n_end = std::min(n_begin + kOutputBlock, output_length);
+          int64_t m = n_begin / new_freq;
+          int64_t phase = n_begin % new_freq;
+          for (int64_t n = n_begin; n < n_end; ++n) {
+            const int64_t start = m * orig_freq + offsets[phase] - kernel.width;
+            const scalar_t* h = taps_data + phase * num_taps;
+            y[n] = (start >= 0 && start + num_taps <= length)
+                ? dot_aligned(x + start, h, num_taps)
+                : dot_bounded(x, start, length, h, num_taps);
+            if (++phase == new_freq) {
+              phase = 0;
+              ++m;
+            }
+          }
+        }
+      });
+}
+
+torch::Tensor resample_cpu(
+    const torch::Tensor& waveform,
+    int64_t orig_freq,
+    int64_t new_freq,
+    int64_t lowpass_filter_width,
+    double rolloff,
+    const std::string& resampling_method,
+    c10::optional<double> beta) {
+  TORCH_CHECK(waveform.dim() >= 1, "waveform must have at least 1 dimension.");
+  const auto kernel = get_polyphase_kernel(
+      orig_freq,
+      new_freq,
+      lowpass_filter_width,
+      rolloff,
+      resampling_method,
+      beta);
+  const int64_t length = waveform.size(-1);
+  const auto input = waveform.reshape({-1, length}).contiguous();
+  auto output = torch::empty(
+      {input.size(0), get_output_length(length, orig_freq, new_freq)},
+      input.options());
+  AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "resample_cpu", [&] {
+    const auto taps = std::get<0>(kernel->tensors(input.options()));
+    resample_cpu_kernel<scalar_t>(input, output, *kernel, taps);
+  });
+  auto sizes = waveform.sizes().vec();
+  sizes.back() = output.size(1);
+  return output.reshape(sizes);
+}
+
+} // namespace
+
+std::tuple<torch::Tensor, torch::Tensor> PolyphaseKernel::tensors(
+    const torch::TensorOptions& options) const {
+  const auto device = options.device();
+  const auto dtype = c10::typeMetaToScalarType(options.dtype());
+  std::lock_guard<std::mutex> lock(mutex_);
+  torch::Tensor taps_tensor, offsets_tensor;
+  for (const auto& entry : taps_cache_) {
+    if (std::get<0>(entry) == device && std::get<1>(entry) == dtype) {
+      taps_tensor = std::get<2>(entry);
+    }
+  }
+  for (const auto& entry : offsets_cache_) {
+    if (std::get<0>(entry) == device) {
+      offsets_tensor = std::get<1>(entry);
+    }
+  }
+  if (!taps_tensor.defined()) {
+    taps_tensor = torch::from_blob(
+                      const_cast<double*>(taps.data()),
+                      {new_freq, num_taps},
+                      torch::kFloat64)
+                      .to(options.device(device).dtype(dtype));
+    taps_cache_.emplace_back(device, dtype, taps_tensor);
+  }
+  if (!offsets_tensor.defined()) {
+    offsets_tensor = torch::from_blob(
+                         const_cast<int64_t*>(offsets.data()),
+                         {new_freq},
+                         torch::kInt64)
+                         .to(options.device(device).dtype(torch::kInt64));
+    offsets_cache_.emplace_back(device, offsets_tensor);
+  }
+  return std::make_tuple(taps_tensor, offsets_tensor);
+}
+
+std::shared_ptr<const PolyphaseKernel> get_polyphase_kernel(
+    int64_t orig_freq,
+    int64_t new_freq,
+    int64_t lowpass_filter_width,
+    double rolloff,
+    const std::string& resampling_method,
+    c10::optional<double> beta) {
+  TORCH_CHECK(
+      orig_freq > 0 && new_freq > 0,
+      "orig_freq and new_freq must be positive. Found: ",
+      orig_freq,
+      " and ",
+      new_freq);
+  TORCH_CHECK(
+      lowpass_filter_width > 0,
+      "lowpass_filter_width must be positive. Found: ",
+      lowpass_filter_width);
+  TORCH_CHECK(
+      resampling_method == "sinc_interpolation" ||
+          resampling_method == "kaiser_window",
+      "Invalid resampling method: ",
+      resampling_method);
+  const bool kaiser_window = resampling_method == "kaiser_window";
+  const double beta_value =
+      kaiser_window ? beta.value_or(kDefaultKaiserBeta) : 0.;
+
+  using Key = std::tuple<int64_t, int64_t, int64_t, double, bool, double>;
+  static std::mutex mutex;
+  static std::map<Key, std::shared_ptr<const PolyphaseKernel>> cache;
+  const Key key{
+      orig_freq,
+      new_freq,
+      lowpass_filter_width,
+      rolloff,
+      kaiser_window,
+      beta_value};
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto it = cache.find(key);
+    if (it != cache.end()) {
+      return it->second;
+    }
+  }
+  // Computed without the lock, so another thread may compute the same kernel
+  // concurrently. The first one is kept.
+  std::shared_ptr<const PolyphaseKernel> kernel = compute_polyphase_kernel(
+      orig_freq,
+      new_freq,
+      lowpass_filter_width,
+      rolloff,
+      kaiser_window,
+      beta_value);
+  std::lock_guard<std::mutex> lock(mutex);
+  if (cache.size() >= kMaxCachedKernels) {
+    cache.clear();
+  }
+  return cache.emplace(key, kernel).first->second;
+}
+
+} // namespace resample
+} // namespace torchaudio
+
+TORCH_LIBRARY_FRAGMENT(torchaudio, m) {
+  m.def(
+      "torchaudio::_resample(Tensor waveform, int orig_freq, int new_freq, int lowpass_filter_width, float rolloff, str resampling_method, float? beta) -> Tensor");
+}
+
+TORCH_LIBRARY_IMPL(torchaudio, CPU, m) {
+  m.impl("torchaudio::_resample", &torchaudio::resample::resample_cpu);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <torch/script.h>
+
+#include <mutex>
+
+namespace torchaudio {
+namespace resample {
+
+// Polyphase form of the windowed sinc kernel of `functional.resample`.
+//
+// Output sample `n = m * new_freq + phase` is the dot product of `num_taps`
+// taps of the phase with the input starting at
+// `m * orig_freq + offsets[phase] - width`, where the input is zero outside of
+// [0, length). Unlike the kernel of `_get_sinc_resample_kernel`, which spans
+// `2 * width + orig_freq` samples for every phase, each phase only keeps the
+// taps of its own support, so the number of taps does not grow with
+// `orig_freq`. The taps outside of the support are below 1e-30.
+struct PolyphaseKernel {
+  int64_t orig_freq;
+  int64_t new_freq;
+  int64_t width;
+  // Padded to a multiple of `kTapAlignment`, with zeros.
+  int64_t num_taps;
+  std::vector<int64_t> offsets;
+  // [new_freq, num_taps]
+  std::vector<double> taps;
+
+  static constexpr int64_t kTapAlignment = 8;
+
+  // Returns the taps and the offsets as Tensors of the device and the dtype
+  // of `options` (the offsets are int64). They are copied once per device and
+  // dtype, and reused afterwards.
+  std::tuple<torch::Tensor, torch::Tensor> tensors(
+      const torch::TensorOptions& options) const;
+
+ private:
+  mutable std::mutex mutex_;
+  mutable std::vector<std::tuple<c10::Device, c10::ScalarType, torch::Tensor>>
+      taps_cache_;
+  mutable std::vector<std::tuple<c10::Device, torch::Tensor>> offsets_cache_;
+};
+
+// Returns the kernel for the parameters, which is computed once and cached.
+// `orig_freq` and `new_freq` must be already divided by their GCD.
+std::shared_ptr<const PolyphaseKernel> get_polyphase_kernel(
+    int64_t orig_freq,
+    int64_t new_freq,
+    int64_t lowpass_filter_width,
+    double rolloff,
+    const std::string& resampling_method,
+    c10::optional<double> beta);
+
+inline int64_t get_output_length(
+    int64_t length,
+    int64_t orig_freq,
+    int64_t new_freq) {
+  return (new_freq * length + orig_freq - 1) / orig_freq;
+}
+
+} // namespace resample
+} // namespace torchaudio
@@ -0,0 +1,105 @@
+#include <ATen/cuda/CUDAContext.h>
+#include <c10/cuda/CUDAGuard.h>
+#include <torchaudio/csrc/resample.h>
+
+namespace {
+
+constexpr int kThreads = 256;
+// Maximum number of waveforms handled by a row of the grid.
+constexpr int64_t kMaxGridY = 65535;
+
+// One thread computes one output sample of one waveform. The threads of a
+// block compute consecutive samples, so they read overlapping inputs and, for
+// the taps, cycle through the phases in the same order.
+template <typename scalar_t>
+__global__ void resample_cuda_kernel(
+    const scalar_t* __restrict__ input,
+    scalar_t* __restrict__ output,
+    const scalar_t* __restrict__ taps,
+    const int64_t* __restrict__ offsets,
+    int64_t num_waves,
+    int64_t length,
+    int64_t output_length,
+    int64_t num_taps,
+    int64_t orig_freq,
+    int64_t new_freq,
+    int64_t width) {
+  const int64_t n =
+      static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+  if (n >= output_length) {
+    return;
+  }
+  const int64_t m = n / new_freq;
+  const int64_t phase = n % new_freq;
+  const int64_t start = m * orig_freq + offsets[phase] - width;
+  const scalar_t* h = taps + phase * num_taps;
+  const int64_t t_begin = start < 0 ? -start : 0;
+  const int64_t t_end = min(num_taps, length - start);
+  for (int64_t w = blockIdx.y; w < num_waves; w += gridDim.y) {
+    const scalar_t* x = input + w * length + start;
+    scalar_t sum = 0;
+    for (int64_t t = t_begin; t < t_end; ++t) {
+      sum += x[t] * h[t];
+    }
+    output[w * output_length + n] = sum;
+  }
+}
+
+torch::Tensor resample_cuda(
+    const torch::Tensor& waveform,
+    int64_t orig_freq,
+    int64_t new_freq,
+    int64_t lowpass_filter_width,
+    double rolloff,
+    const std::string& resampling_method,
+    c10::optional<double> beta) {
+  using namespace torchaudio::resample;
+  TORCH_CHECK(waveform.dim() >= 1, "waveform must have at least 1 dimension.");
+  const c10::cuda::CUDAGuard device_guard(waveform.device());
+  const auto kernel = get_polyphase_kernel(
+      orig_freq,
+      new_freq,
+      lowpass_filter_width,
+      rolloff,
+      resampling_method,
+      beta);
+  const int64_t length = waveform.size(-1);
+  const auto input = waveform.reshape({-1, length}).contiguous();
+  const int64_t num_waves = input.size(0);
+  const int64_t output_length = get_output_length(length, orig_freq, new_freq);
+  auto output =
+      torch::empty({num_waves, output_length}, input.options());
+
+  if (num_waves > 0 && output_length > 0) {
+    const dim3 blocks(
+        (output_length + kThreads - 1) / kThreads,
+        std::min(num_waves, kMaxGridY));
+    const auto stream = at::cuda::getCurrentCUDAStream();
+    AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "resample_cuda", [&] {
+      torch::Tensor taps, offsets;
+      std::tie(taps, offsets) = kernel->tensors(input.options());
+      resample_cuda_kernel<scalar_t><<<blocks, kThreads, 0, stream>>>(
+          input.data_ptr<scalar_t>(),
+          output.data_ptr<scalar_t>(),
+          taps.data_ptr<scalar_t>(),
+          offsets.data_ptr<int64_t>(),
+          num_waves,
+          length,
+          output_length,
+          kernel->num_taps,
+          orig_freq,
+          new_freq,
+          kernel->width);
+      C10_CUDA_KERNEL_LAUNCH_CHECK();
+    });
+  }
+  auto sizes = waveform.sizes().vec();
+  sizes.back() = output_length;
+  return output.reshape(sizes);
+}
+
+} // namespace
+
+TORCH_LIBRARY_IMPL(torchaudio, CUDA, m) {
+  m.impl("torchaudio::_resample", &resample_cuda);
+}
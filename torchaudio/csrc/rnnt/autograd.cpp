@@ -13,10 +13,93 @@ class RNNTLossFunction : public torch::autograd::Function<RNNTLossFunction> {
       const torch::Tensor& logit_lengths,
       const torch::Tensor& target_lengths,
       int64_t blank,
+      double clamp,
+      bool reuse_logits_for_grads,
+      bool check_lengths,
+      const std::string& alphas_betas_kernel) {
+    torch::Tensor undef;
+    auto result = rnnt_loss(
+        logits,
+        targets,
+        logit_lengths,
+        target_lengths,
+        blank,
+        clamp,
+        reuse_logits_for_grads,
+        check_lengths,
+        alphas_betas_kernel);
+    auto costs = std::get<0>(result);
+    auto grads = std::get<1>(result).value_or(undef);
+    if (reuse_logits_for_grads) {
+      // The logits now hold the gradients: the saved buffer is the logits
+      // themselves, and the operations which saved the logits for their
+      // backward fail instead of using the gradients.
+      torch::autograd::impl::bump_version(logits);
+      ctx->mark_dirty({logits});
+    }
+    ctx->save_for_backward({grads, logit_lengths, target_lengths});
+    return {costs, grads};
+  }
+
+  static torch::autograd::tensor_list backward(
+      torch::autograd::AutogradContext* ctx,
+      torch::autograd::tensor_list grad_outputs) {
+    auto saved = ctx->get_saved_variables();
+    auto grad = saved[0];
+    auto grad_out = grad_outputs[0];
+    if (grad.dim() == 2) { // packed logits, with the rows of each sequence.
+      auto rows =
+          saved[1].to(torch::kInt64) * (saved[2].to(torch::kInt64) + 1);
+      grad_out =
+          grad_out.repeat_interleave(rows, 0, grad.size(0)).view({-1, 1});
+    } else {
+      grad_out = grad_out.view({-1, 1, 1, 1});
+    }
+    auto result = grad * grad_out;
+    torch::Tensor undef;
+    return {result, undef, undef, undef, undef, undef, undef, undef, undef};
+  }
+};
+
+std::tuple<torch::Tensor, c10::optional<torch::Tensor>> rnnt_loss_autograd(
+    torch::Tensor& logits,
+    const torch::Tensor& targets,
+    const torch::Tensor& logit_lengths,
+    const torch::Tensor& target_lengths,
+    int64_t blank,
+    double clamp,
+    bool reuse_logits_for_grads,
+    bool check_lengths,
+    const std::string& alphas_betas_kernel) {
+  at::AutoDispatchBelowADInplaceOrView guard;
+  auto results = RNNTLossFunction::apply(
+      logits,
+      targets,
+      logit_lengths,
+      target_lengths,
+      blank,
+      clamp,
+      reuse_logits_for_grads,
+      check_lengths,
+      alphas_betas_kernel);
+  return std::make_tuple(results[0], results[1]);
+}
+
+class RNNTLossPrunedFunction
+    : public torch::autograd::Function<RNNTLossPrunedFunction> {
+ public:
+  static torch::autograd::tensor_list forward(
+      torch::autograd::AutogradContext* ctx,
+      torch::Tensor& logits,
+      const torch::Tensor& targets,
+      const torch::Tensor& logit_lengths,
+      const torch::Tensor& target_lengths,
+      const torch::Tensor& ranges,
+      int64_t blank,
       double clamp) {
     torch::Tensor undef;
-    auto result =
-        rnnt_loss(logits, targets, logit_lengths, target_lengths, blank, clamp);
+    auto result = rnnt_loss_pruned(
+        logits, targets, logit_lengths, target_lengths, ranges, blank, clamp);
     auto costs = std::get<0>(result);
     auto grads = std::get<1>(result).value_or(undef);
     ctx->save_for_backward({grads});
@@ -31,25 +114,28 @@ class RNNTLossFunction : public torch::autograd::Function<RNNTLossFunction> {
     auto grad_out = grad_outputs[0].view({-1, 1, 1, 1});
     auto result = grad * grad_out;
     torch::Tensor undef;
-    return {result, undef, undef, undef, undef, undef, undef, undef};
+    return {result, undef, undef, undef, undef, undef, undef};
   }
 };
 
-std::tuple<torch::Tensor, c10::optional<torch::Tensor>> rnnt_loss_autograd(
+std::tuple<torch::Tensor, c10::optional<torch::Tensor>>
+rnnt_loss_pruned_autograd(
     torch::Tensor& logits,
     const torch::Tensor& targets,
     const torch::Tensor& logit_lengths,
     const torch::Tensor& target_lengths,
+    const torch::Tensor& ranges,
     int64_t blank,
     double clamp) {
   at::AutoDispatchBelowADInplaceOrView guard;
-  auto results = RNNTLossFunction::apply(
-      logits, targets, logit_lengths, target_lengths, blank, clamp);
+  auto results = RNNTLossPrunedFunction::apply(
+      logits, targets, logit_lengths, target_lengths, ranges, blank, clamp);
   return std::make_tuple(results[0], results[1]);
 }
 
 TORCH_LIBRARY_IMPL(torchaudio, Autograd, m) {
   m.impl("rnnt_loss", rnnt_loss_autograd);
+  m.impl("rnnt_loss_pruned", rnnt_loss_pruned_autograd);
 }
 
 } // namespace rnnt
@@ -0,0 +1,574 @@
+#include <torchaudio/csrc/rnnt/beam_search.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
+namespace torchaudio {
+namespace rnnt {
+
+namespace {
+
+constexpr float kNegInf = -std::numeric_limits<float>::infinity();
+
+// FNV-1a over the symbols.
+constexpr uint64_t kHashSeed = 14695981039346656037ULL;
+
+uint64_t HashCombine(uint64_t hash, int64_t token) {
+  return (hash ^ static_cast<uint64_t>(token + 1)) * 1099511628211ULL;
+}
+
+float LogAddExp(float a, float b) {
+  if (a < b) {
+    std::swap(a, b);
+  }
+  if (b == kNegInf) {
+    return a;
+  }
+  return a + std::log1p(std::exp(b - a));
+}
+
+// Returns a tensor of rows rows of the shape of like otherwise, reusing buffer
+// if it has this shape.
+torch::Tensor Reserve(
+    const torch::Tensor& buffer,
+    int rows,
+    const torch::Tensor& like) {
+  TORCH_CHECK(
+      like.dim() >= 1,
+      "the outputs and the states of the predictor must have a dimension of "
+      "hypotheses");
+  std::vector<int64_t> sizes = like.sizes().vec();
+  sizes[0] = rows;
+  if (buffer.defined() && buffer.sizes() == sizes &&
+      buffer.scalar_type() == like.scalar_type() &&
+      buffer.device() == like.device()) {
+    return buffer;
+  }
+  return torch::empty(sizes, like.options());
+}
+
+torch::Tensor ToIndex(
+    const std::vector<int64_t>& indices,
+    const torch::Device& device) {
+  return torch::tensor(indices, torch::kLong).to(device);
+}
+
+} // namespace
+
+BeamSearch::BeamSearch(
+    const BeamSearchOptions& options,
+    Predictor predictor,
+    Joiner joiner)
+    : options_(options),
+      predictor_(std::move(predictor)),
+      joiner_(std::move(joiner)),
+      capacity_(0),
+      numRows_(0) {
+  TORCH_CHECK(options_.blank_ >= 0, "blank must be non-negative");
+  TORCH_CHECK(options_.beamWidth_ >= 1, "the beam width must be positive");
+  TORCH_CHECK(
+      options_.maxSymbolsPerStep_ >= 1,
+      "the maximum number of symbols per step must be positive");
+  TORCH_CHECK(
+      options_.maxOutputLength_ >= 0,
+      "the maximum output length must be non-negative");
+}
+
+void BeamSearch::Reset(
+    const torch::Tensor& encoderOutputs,
+    const PredictorState& state) {
+  encoderOutputs_ = encoderOutputs;
+  const int T = encoderOutputs.size(0);
+  capacity_ = options_.maxOutputLength_ > 0
+      ? options_.maxOutputLength_
+      : options_.maxSymbolsPerStep_ * T;
+
+  // A step of the search holds the blank-ended hypotheses and the parents of
+  // the new ones besides the new ones, so 3 beams of rows.
+  numRows_ = 3 * options_.beamWidth_;
+  tokens_.resize(static_cast<size_t>(numRows_) * capacity_);
+  lengths_.assign(numRows_, 0);
+  hashes_.assign(numRows_, kHashSeed);
+  used_.assign(numRows_, false);
+
+  // The root, after blank.
+  const torch::Tensor tokens =
+      torch::full({1}, options_.blank_, torch::kLong)
+          .to(encoderOutputs.device());
+  auto outputs = predictor_(tokens, state);
+  TORCH_CHECK(
+      outputs.second.size() == state.size(),
+      "the predictor must return as many state tensors as it takes");
+  predictorOutputs_ = Reserve(predictorOutputs_, numRows_, outputs.first);
+  predictorOutputs_.narrow(0, 0, 1).copy_(outputs.first);
+  states_.resize(state.size());
+  for (size_t i = 0; i < state.size(); ++i) {
+    states_[i] = Reserve(states_[i], numRows_, outputs.second[i]);
+    states_[i].narrow(0, 0, 1).copy_(outputs.second[i]);
+  }
+  used_[0] = true;
+}
+
+int BeamSearch::AllocateRow() {
+  int row = 0;
+  while (row < numRows_ && used_[row]) {
+    ++row;
+  }
+  TORCH_CHECK(row < numRows_, "no free row for the hypotheses of the beam");
+  used_[row] = true;
+  return row;
+}
+
+void BeamSearch::Collect(
+    const std::vector<Candidate>& a,
+    const std::vector<Candidate>& b) {
+  std::fill(used_.begin(), used_.end(), false);
+  for (const auto& c : a) {
+    used_[c.row] = true;
+  }
+  for (const auto& c : b) {
+    used_[c.row] = true;
+  }
+}
+
+uint64_t BeamSearch::Hash(const Candidate& c) const {
+  return c.token < 0 ? hashes_[c.row] : HashCombine(hashes_[c.row], c.token);
+}
+
+int BeamSearch::Length(const Candidate& c) const {
+  return lengths_[c.row] + (c.token < 0 ? 0 : 1);
+}
+
+int64_t BeamSearch::TokenAt(const Candidate& c, int i) const {
+  if (i < lengths_[c.row]) {
+    return tokens_[static_cast<size_t>(c.row) * capacity_ + i];
+  }
+  return c.token;
+}
+
+bool BeamSearch::SameTokens(const Candidate& a, const Candidate& b) const {
+  const int length = Length(a);
+  if (length != Length(b) || Hash(a) != Hash(b)) {
+    return false;
+  }
+  for (int i = 0; i < length; ++i) {
+    if (TokenAt(a, i) != TokenAt(b, i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void BeamSearch::MergeAndPrune(std::vector<Candidate>& candidates, int k)
+    const {
+  std::vector<Candidate> merged;
+  merged.reserve(candidates.size());
+  std::unordered_multimap<uint64_t, size_t> index;
+  for (const auto& c : candidates) {
+    const uint64_t hash = Hash(c);
+    bool found = false;
+    const auto range = index.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      Candidate& m = merged[it->second];
+      if (SameTokens(m, c)) {
+        m.score = LogAddExp(m.score, c.score);
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      index.emplace(hash, merged.size());
+      merged.push_back(c);
+    }
+  }
+
+  const size_t size = std::min(merged.size(), static_cast<size_t>(k));
+  std::partial_sort(
+      merged.begin(),
+      merged.begin() + size,
+      merged.end(),
+      [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+  merged.resize(size);
+  candidates.swap(merged);
+}
+
+void BeamSearch::ComputeLogProbs(
+    const std::vector<Candidate>& hypos,
+    const std::vector<int64_t>& frames,
+    std::vector<float>& blankLogProbs,
+    torch::Tensor& topLogProbs,
+    torch::Tensor& topTokens) {
+  const int64_t n = hypos.size();
+  std::vector<int64_t> rows(n);
+  for (int64_t i = 0; i < n; ++i) {
+    rows[i] = hypos[i].row;
+  }
+
+  torch::Tensor logits = joiner_(
+      encoderOutputs_.index_select(
+          0, ToIndex(frames, encoderOutputs_.device())),
+      predictorOutputs_.index_select(
+          0, ToIndex(rows, predictorOutputs_.device())));
+  logits = logits.reshape({n, -1}).to(torch::kFloat);
+  const int64_t D = logits.size(1);
+  TORCH_CHECK(options_.blank_ < D, "blank must be within [0, num classes)");
+
+  torch::Tensor logProbs = torch::log_softmax(logits, 1);
+  const torch::Tensor blank =
+      logProbs.select(1, options_.blank_).contiguous().cpu();
+  blankLogProbs.assign(blank.data_ptr<float>(), blank.data_ptr<float>() + n);
+
+  // The other symbols, of which only the best beamWidth_ of each hypothesis
+  // can enter the beam.
+  logProbs.select(1, options_.blank_).fill_(kNegInf);
+  const int64_t k = std::min<int64_t>(options_.beamWidth_, D - 1);
+  auto top = logProbs.topk(k, 1);
+  topLogProbs = std::get<0>(top).cpu();
+  topTokens = std::get<1>(top).cpu();
+}
+
+void BeamSearch::Expand(std::vector<Candidate>& candidates) {
+  std::vector<int64_t> parents, children, tokens;
+  for (auto& c : candidates) {
+    if (c.token < 0) {
+      continue;
+    }
+    const int row = AllocateRow();
+    const int length = lengths_[c.row];
+    std::copy(
+        tokens_.begin() + static_cast<size_t>(c.row) * capacity_,
+        tokens_.begin() + static_cast<size_t>(c.row) * capacity_ + length,
+        tokens_.begin() + static_cast<size_t>(row) * capacity_);
+    tokens_[static_cast<size_t>(row) * capacity_ + length] = c.token;
+    lengths_[row] = length + 1;
+    hashes_[row] = Hash(c);
+
+    parents.push_back(c.row);
+    children.push_back(row);
+    tokens.push_back(c.token);
+    c.row = row;
+    c.token = -1;
+  }
+  if (children.empty()) {
+    return;
+  }
+
+  const torch::Device device = predictorOutputs_.device();
+  const torch::Tensor parentIndex = ToIndex(parents, device);
+  const torch::Tensor childIndex = ToIndex(children, device);
+  PredictorState state(states_.size());
+  for (size_t i = 0; i < states_.size(); ++i) {
+    state[i] = states_[i].index_select(0, parentIndex);
+  }
+  auto outputs = predictor_(ToIndex(tokens, device), state);
+  TORCH_CHECK(
+      outputs.second.size() == states_.size(),
+      "the predictor must return as many state tensors as it takes");
+  predictorOutputs_.index_copy_(0, childIndex, outputs.first);
+  for (size_t i = 0; i < states_.size(); ++i) {
+    states_[i].index_copy_(0, childIndex, outputs.second[i]);
+  }
+}
+
+Hypothesis BeamSearch::ToHypothesis(const Candidate& c) const {
+  Hypothesis hypo;
+  hypo.tokens.resize(Length(c));
+  for (int i = 0; i < Length(c); ++i) {
+    hypo.tokens[i] = TokenAt(c, i);
+  }
+  hypo.score = c.score;
+  return hypo;
+}
+
+std::vector<Hypothesis> BeamSearch::SearchGreedy(int T) {
+  std::vector<Candidate> hypo = {{/*row=*/0, /*token=*/-1, 0, /*t=*/0}};
+  for (int t = 0; t < T; ++t) {
+    for (int s = 0;; ++s) {
+      std::vector<float> blank;
+      torch::Tensor topLogProbs, topTokens;
+      ComputeLogProbs(
+          hypo, std::vector<int64_t>(1, t), blank, topLogProbs, topTokens);
+      Candidate& h = hypo[0];
+      if (s >= options_.maxSymbolsPerStep_ || lengths_[h.row] >= capacity_ ||
+          topLogProbs.size(1) == 0 ||
+          topLogProbs.accessor<float, 2>()[0][0] <= blank[0]) {
+        h.score += blank[0];
+        break;
+      }
+      h.token = topTokens.accessor<int64_t, 2>()[0][0];
+      h.score += topLogProbs.accessor<float, 2>()[0][0];
+      Expand(hypo);
+      Collect(hypo);
+    }
+  }
+  return {ToHypothesis(hypo[0])};
+}
+
+std::vector<Hypothesis> BeamSearch::SearchTimeSynchronous(int T) {
+  const int W = options_.beamWidth_;
+  std::vector<Candidate> beam = {{/*row=*/0, /*token=*/-1, 0, /*t=*/0}};
+  for (int t = 0; t < T; ++t) {
+    // The hypotheses of the frame, which emit symbols, and those which have
+    // emitted blank.
+    std::vector<Candidate> hypos = beam;
+    std::vector<Candidate> done;
+    for (int s = 0; !hypos.empty(); ++s) {
+      std::vector<float> blank;
+      torch::Tensor topLogProbs, topTokens;
+      ComputeLogProbs(
+          hypos,
+          std::vector<int64_t>(hypos.size(), t),
+          blank,
+          topLogProbs,
+          topTokens);
+
+      for (size_t i = 0; i < hypos.size(); ++i) {
+        done.push_back({hypos[i].row, -1, hypos[i].score + blank[i], t + 1});
+      }
+      MergeAndPrune(done, W);
+
+      std::vector<Candidate> next;
+      if (s < options_.maxSymbolsPerStep_) {
+        // The scores only decrease, so the hypotheses below the beam of the
+        // frame are pruned.
+        const float threshold =
+            static_cast<int>(done.size()) < W ? kNegInf : done.back().score;
+        const auto values = topLogProbs.accessor<float, 2>();
+        const auto ids = topTokens.accessor<int64_t, 2>();
+        for (size_t i = 0; i < hypos.size(); ++i) {
+          if (lengths_[hypos[i].row] >= capacity_) {
+            continue;
+          }
+          for (int64_t j = 0; j < values.size(1); ++j) {
+            const float score = hypos[i].score + values[i][j];
+            if (score > threshold) {
+              next.push_back({hypos[i].row, ids[i][j], score, t});
+            }
+          }
+        }
+        MergeAndPrune(next, W);
+      }
+
+      Expand(next);
+      Collect(done, next);
+      hypos.swap(next);
+    }
+    beam.swap(done);
+  }
+
+  std::vector<Hypothesis> hypotheses;
+  for (const auto& c : beam) {
+    hypotheses.push_back(ToHypothesis(c));
+  }
+  return hypotheses;
+}
+
+std::vector<Hypothesis> BeamSearch::SearchAlignmentLengthSynchronous(int T) {
+  const int W = options_.beamWidth_;
+  const auto byScore = [](const Hypothesis& a, const Hypothesis& b) {
+    return a.score > b.score;
+  };
+  if (T == 0) {
+    return {Hypothesis{{}, 0}};
+  }
+
+  std::vector<Candidate> beam = {{/*row=*/0, /*token=*/-1, 0, /*t=*/0}};
+  std::vector<Hypothesis> finals;
+  for (int i = 0; i < T + capacity_ && !beam.empty(); ++i) {
+    std::vector<int64_t> frames(beam.size());
+    for (size_t j = 0; j < beam.size(); ++j) {
+      frames[j] = beam[j].t;
+    }
+    std::vector<float> blank;
+    torch::Tensor topLogProbs, topTokens;
+    ComputeLogProbs(beam, frames, blank, topLogProbs, topTokens);
+
+    // The candidates all have i + 1 frames and symbols, so those with the
+    // same symbols are at the same frame.
+    std::vector<Candidate> candidates;
+    const auto values = topLogProbs.accessor<float, 2>();
+    const auto ids = topTokens.accessor<int64_t, 2>();
+    for (size_t j = 0; j < beam.size(); ++j) {
+      const Candidate& h = beam[j];
+      candidates.push_back({h.row, -1, h.score + blank[j], h.t + 1});
+      if (lengths_[h.row] >= capacity_) {
+        continue;
+      }
+      for (int64_t k = 0; k < values.size(1); ++k) {
+        candidates.push_back({h.row, ids[j][k], h.score + values[j][k], h.t});
+      }
+    }
+    MergeAndPrune(candidates, static_cast<int>(candidates.size()));
+
+    std::vector<Candidate> next;
+    for (const auto& c : candidates) {
+      if (c.t == T) {
+        finals.push_back(ToHypothesis(c));
+      } else if (static_cast<int>(next.size()) < W) {
+        next.push_back(c);
+      }
+    }
+
+    // The scores only decrease, so the search stops once the beam cannot
+    // improve the best final hypotheses.
+    if (static_cast<int>(finals.size()) >= W) {
+      std::partial_sort(
+          finals.begin(), finals.begin() + W, finals.end(), byScore);
+      finals.resize(W);
+      if (next.empty() || finals.back().score >= next.front().score) {
+        break;
+      }
+    }
+
+    Expand(next);
+    Collect(next);
+    beam.swap(next);
+  }
+
+  std::sort(finals.begin(), finals.end(), byScore);
+  if (static_cast<int>(finals.size()) > W) {
+    finals.resize(W);
+  }
+  return finals;
+}
+
+std::vector<Hypothesis> BeamSearch::Search(
+    const torch::Tensor& encoderOutputs,
+    const PredictorState& initialState) {
+  TORCH_CHECK(
+      encoderOutputs.dim() >= 1,
+      "encoderOutputs must have a dimension of frames");
+  at::NoGradGuard no_grad;
+
+  Reset(encoderOutputs, initialState);
+  const int T = encoderOutputs.size(0);
+  if (options_.mode_ == ALIGNMENT_LENGTH_SYNCHRONOUS) {
+    return SearchAlignmentLengthSynchronous(T);
+  }
+  if (options_.beamWidth_ == 1) {
+    return SearchGreedy(T);
+  }
+  return SearchTimeSynchronous(T);
+}
+
+namespace {
+
+beam_search_mode_t ParseMode(const std::string& mode) {
+  if (mode == "time_synchronous") {
+    return TIME_SYNCHRONOUS;
+  }
+  TORCH_CHECK(
+      mode == "alignment_length_synchronous",
+      "mode must be \"time_synchronous\" or \"alignment_length_synchronous\". "
+      "Found: ",
+      mode);
+  return ALIGNMENT_LENGTH_SYNCHRONOUS;
+}
+
+std::shared_ptr<torch::jit::Module> LoadModule(const std::string& path) {
+  auto module = std::make_shared<torch::jit::Module>(torch::jit::load(path));
+  module->eval();
+  return module;
+}
+
+} // namespace
+
+BeamSearchDecoder::BeamSearchDecoder(
+    std::string predictor,
+    std::string joiner,
+    int64_t blank,
+    int64_t beam_width,
+    std::string mode,
+    int64_t max_symbols_per_step,
+    int64_t max_output_length)
+    : state_(
+          predictor,
+          joiner,
+          blank,
+          beam_width,
+          mode,
+          max_symbols_per_step,
+          max_output_length) {
+  BeamSearchOptions options;
+  options.blank_ = blank;
+  options.beamWidth_ = beam_width;
+  options.mode_ = ParseMode(mode);
+  options.maxSymbolsPerStep_ = max_symbols_per_step;
+  options.maxOutputLength_ = max_output_length;
+
+  auto predictorModule = LoadModule(predictor);
+  auto joinerModule = LoadModule(joiner);
+  search_.reset(new BeamSearch(
+      options,
+      [predictorModule](
+          const torch::Tensor& tokens, const PredictorState& state) {
+        c10::List<torch::Tensor> states;
+        states.reserve(state.size());
+        for (const auto& s : state) {
+          states.push_back(s);
+        }
+        auto outputs = predictorModule->forward({tokens, states}).toTuple();
+        TORCH_CHECK(
+            outputs->elements().size() == 2,
+            "the predictor must return its outputs and its state");
+        return std::make_pair(
+            outputs->elements()[0].toTensor(),
+            outputs->elements()[1].toTensorVector());
+      },
+      [joinerModule](
+          const torch::Tensor& frames, const torch::Tensor& predictorOutputs) {
+        return joinerModule->forward({frames, predictorOutputs}).toTensor();
+      }));
+}
+
+std::vector<BeamSearchResult> BeamSearchDecoder::Search(
+    const torch::Tensor& encoder_outputs,
+    std::vector<torch::Tensor> initial_state) {
+  std::vector<Hypothesis> hypotheses;
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    hypotheses = search_->Search(encoder_outputs, initial_state);
+  }
+  std::vector<BeamSearchResult> results;
+  results.reserve(hypotheses.size());
+  for (auto& hypo : hypotheses) {
+    results.emplace_back(std::move(hypo.tokens), hypo.score);
+  }
+  return results;
+}
+
+BeamSearchDecoder::State BeamSearchDecoder::GetState() const {
+  return state_;
+}
+
+TORCH_LIBRARY_FRAGMENT(torchaudio, m) {
+  m.class_<BeamSearchDecoder>("rnnt_BeamSearchDecoder")
+      .def(torch::init<
+           std::string,
+           std::string,
+           int64_t,
+           int64_t,
+           std::string,
+           int64_t,
+           int64_t>())
+      .def("search", &BeamSearchDecoder::Search)
+      .def_pickle(
+          [](const c10::intrusive_ptr<BeamSearchDecoder>& self)
+              -> BeamSearchDecoder::State { return self->GetState(); },
+          [](BeamSearchDecoder::State state)
+              -> c10::intrusive_ptr<BeamSearchDecoder> {
+            return c10::make_intrusive<BeamSearchDecoder>(
+                std::move(std::get<0>(state)),
+                std::move(std::get<1>(state)),
+                std::get<2>(state),
+                std::get<3>(state),
+                std::move(std::get<4>(state)),
+                std::get<5>(state),
+                std::get<6>(state));
+          });
+}
+
+} // namespace rnnt
+} // namespace torchaudio
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <torch/script.h>
+
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace torchaudio {
+namespace rnnt {
+
+// The search of Saon et al., "Alignment-Length Synchronous Decoding for RNN
+// Transducer", ICASSP 2020, to use.
+typedef enum {
+  // Time synchronous decoding: the hypotheses advance frame by frame, with up
+  // to maxSymbolsPerStep_ symbols emitted per frame.
+  TIME_SYNCHRONOUS = 0,
+  // Alignment-length synchronous decoding: the hypotheses of a step have the
+  // same number of frames plus symbols, and those which have consumed all the
+  // frames are final.
+  ALIGNMENT_LENGTH_SYNCHRONOUS = 1
+} beam_search_mode_t;
+
+typedef struct BeamSearchOptions {
+  // the index for "blank", also fed to the predictor before the first symbol.
+  int blank_;
+  // the number of hypotheses kept at each step, 1 for greedy decoding.
+  int beamWidth_;
+  // the type of search.
+  beam_search_mode_t mode_;
+  // the maximum number of symbols emitted in a frame, for TIME_SYNCHRONOUS.
+  int maxSymbolsPerStep_;
+  // the maximum number of symbols of a hypothesis, or 0 (the default) for
+  // maxSymbolsPerStep_ times the number of frames.
+  int maxOutputLength_;
+
+  BeamSearchOptions()
+      : blank_(-1),
+        beamWidth_(1),
+        mode_(TIME_SYNCHRONOUS),
+        maxSymbolsPerStep_(1),
+        maxOutputLength_(0) {}
+} BeamSearchOptions;
+
+// The state of the predictor for a batch of hypotheses: tensors whose first
+// dimension is the hypothesis.
+using PredictorState = std::vector<torch::Tensor>;
+
+// (tokens, state) -> (outputs, next state): runs the predictor over the (N, )
+// int64 tokens of N hypotheses, from their state, and returns its outputs,
+// (N, ...), and the state after the tokens.
+using Predictor = std::function<std::pair<torch::Tensor, PredictorState>(
+    const torch::Tensor& tokens,
+    const PredictorState& state)>;
+
+// (encoder frames, predictor outputs) -> logits: returns the (N, class)
+// logits for the (N, ...) frames and predictor outputs of N hypotheses.
+using Joiner = std::function<torch::Tensor(
+    const torch::Tensor& frames,
+    const torch::Tensor& predictorOutputs)>;
+
+struct Hypothesis {
+  // the symbols, without blank.
+  std::vector<int64_t> tokens;
+  // the log probability of the symbols, summed over their alignments.
+  float score;
+};
+
+// Beam search of RNN transducers driven by the callbacks of their predictor
+// and joiner. The hypotheses of a step are run through the predictor and the
+// joiner in one batch, and their symbols, predictor outputs and states are
+// kept in buffers allocated once for the beam, which are reused across calls.
+// Hypotheses with the same symbols are merged.
+//
+// With beamWidth_ = 1 and TIME_SYNCHRONOUS, the search is greedy: the best
+// symbol is emitted at each step, until it is blank.
+//
+// Not thread safe: concurrent searches need one BeamSearch each.
+class BeamSearch {
+ public:
+  BeamSearch(
+      const BeamSearchOptions& options,
+      Predictor predictor,
+      Joiner joiner);
+
+  // Inputs:
+  //   encoderOutputs: (T, ...) outputs of the encoder for one utterance.
+  //   initialState: state of the predictor for one hypothesis (batch of 1)
+  //     before the first symbol.
+  //
+  // Returns the best hypotheses, at most beamWidth_, by decreasing score.
+  std::vector<Hypothesis> Search(
+      const torch::Tensor& encoderOutputs,
+      const PredictorState& initialState = {});
+
+ private:
+  // A hypothesis of the beam: the symbols of row, or of row followed by token
+  // (unless it is negative), with its score and, for
+  // ALIGNMENT_LENGTH_SYNCHRONOUS, the index of its next frame.
+  struct Candidate {
+    int row;
+    int64_t token;
+    float score;
+    int t;
+  };
+
+  void Reset(const torch::Tensor& encoderOutputs, const PredictorState& state);
+  int AllocateRow();
+  // Frees the rows which no candidate of the lists uses.
+  void Collect(
+      const std::vector<Candidate>& a,
+      const std::vector<Candidate>& b = {});
+
+  uint64_t Hash(const Candidate& c) const;
+  int Length(const Candidate& c) const;
+  int64_t TokenAt(const Candidate& c, int i) const;
+  bool SameTokens(const Candidate& a, const Candidate& b) const;
+  // Sums the scores of the candidates with the same symbols, and keeps the k
+  // best by decreasing score.
+  void MergeAndPrune(std::vector<Candidate>& candidates, int k) const;
+
+  // The log probabilities of the blank and of the best other symbols of the
+  // candidates, which have no token, at frames.
+  void ComputeLogProbs(
+      const std::vector<Candidate>& hypos,
+      const std::vector<int64_t>& frames,
+      std::vector<float>& blankLogProbs,
+      torch::Tensor& topLogProbs,
+      torch::Tensor& topTokens);
+  // Gives their own row to the candidates with a token, and runs the
+  // predictor over the tokens.
+  void Expand(std::vector<Candidate>& candidates);
+
+  Hypothesis ToHypothesis(const Candidate& c) const;
+
+  std::vector<Hypothesis> SearchGreedy(int T);
+  std::vector<Hypothesis> SearchTimeSynchronous(int T);
+  std::vector<Hypothesis> SearchAlignmentLengthSynchronous(int T);
+
+  BeamSearchOptions options_;
+  Predictor predictor_;
+  Joiner joiner_;
+
+  torch::Tensor encoderOutputs_;
+  // The maximum number of symbols of a hypothesis in the current search.
+  int capacity_;
+
+  // Rows of the hypotheses: symbols, predictor outputs and states.
+  int numRows_;
+  std::vector<int64_t> tokens_; // numRows_ * capacity_
+  std::vector<int> lengths_;
+  std::vector<uint64_t> hashes_;
+  std::vector<bool> used_;
+  torch::Tensor predictorOutputs_;
+  PredictorState states_;
+};
+
+/// Tokens and score of a hypothesis.
+using BeamSearchResult = std::tuple<std::vector<int64_t>, double>;
+
+/// BeamSearch for TorchScript, with a predictor and a joiner which are
+/// TorchScript modules saved with `torch.jit.save`.
+///
+/// The `forward` of the predictor takes the (N, ) int64 tokens of N
+/// hypotheses and their state, a list of tensors, and returns its outputs and
+/// the state after the tokens. The `forward` of the joiner takes the frames
+/// and the predictor outputs of N hypotheses, and returns their (N, class)
+/// logits. The searches are serialized.
+struct BeamSearchDecoder : torch::CustomClassHolder {
+  /// `mode` is "time_synchronous" or "alignment_length_synchronous".
+  BeamSearchDecoder(
+      std::string predictor,
+      std::string joiner,
+      int64_t blank,
+      int64_t beam_width,
+      std::string mode,
+      int64_t max_symbols_per_step,
+      int64_t max_output_length);
+
+  /// Decodes the (T, ...) `encoder_outputs` of one utterance, from the
+  /// `initial_state` of the predictor for one hypothesis. Returns the best
+  /// hypotheses by decreasing score.
+  std::vector<BeamSearchResult> Search(
+      const torch::Tensor& encoder_outputs,
+      std::vector<torch::Tensor> initial_state);
+
+  using State = std::tuple<
+      std::string,
+      std::string,
+      int64_t,
+      int64_t,
+      std::string,
+      int64_t,
+      int64_t>;
+
+  /// The arguments of the constructor, for serialization.
+  State GetState() const;
+
+ private:
+  State state_;
+  std::unique_ptr<BeamSearch> search_;
+  std::mutex mutex_;
+};
+
+} // namespace rnnt
+} // namespace torchaudio
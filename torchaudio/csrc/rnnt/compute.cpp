@@ -1,5 +1,26 @@
 #include <torch/script.h>
 #include <torchaudio/csrc/rnnt/compute.h>
+#include <torchaudio/csrc/rnnt/options.h>
+
+#include <string>
+
+namespace torchaudio {
+namespace rnnt {
+
+alphas_betas_kernel_t ParseAlphasBetasKernel(const std::string& kernel) {
+  if (kernel == "counters") {
+    return COUNTERS_KERNEL;
+  }
+  TORCH_CHECK(
+      kernel == "diagonal",
+      "alphas_betas_kernel must be one of \"counters\" and \"diagonal\". "
+      "Found: ",
+      kernel);
+  return DIAGONAL_KERNEL;
+}
+
+} // namespace rnnt
+} // namespace torchaudio
 
 std::tuple<torch::Tensor, c10::optional<torch::Tensor>> rnnt_loss(
     torch::Tensor& logits,
@@ -7,11 +28,23 @@ std::tuple<torch::Tensor, c10::optional<torch::Tensor>> rnnt_loss(
     const torch::Tensor& logit_lengths,
     const torch::Tensor& target_lengths,
     int64_t blank,
-    double clamp) {
+    double clamp,
+    bool reuse_logits_for_grads,
+    bool check_lengths,
+    const std::string& alphas_betas_kernel) {
   static auto op = torch::Dispatcher::singleton()
                        .findSchemaOrThrow("torchaudio::rnnt_loss", "")
                        .typed<decltype(rnnt_loss)>();
-  return op.call(logits, targets, logit_lengths, target_lengths, blank, clamp);
+  return op.call(
+      logits,
+      targets,
+      logit_lengths,
+      target_lengths,
+      blank,
+      clamp,
+      reuse_logits_for_grads,
+      check_lengths,
+      alphas_betas_kernel);
 }
 
 TORCH_LIBRARY_FRAGMENT(torchaudio, m) {
@@ -21,5 +54,8 @@ TORCH_LIBRARY_FRAGMENT(torchaudio, m) {
       "Tensor logit_lengths,"
       "Tensor target_lengths,"
       "int blank,"
-      "float clamp) -> (Tensor, Tensor?)");
+      "float clamp,"
+      "bool reuse_logits_for_grads=False,"
+      "bool check_lengths=True,"
+      "str alphas_betas_kernel=\"counters\") -> (Tensor, Tensor?)");
 }
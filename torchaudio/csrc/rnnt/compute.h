@@ -2,10 +2,24 @@
 
 #include <torch/script.h>
 
+#include <string>
+
 std::tuple<torch::Tensor, c10::optional<torch::Tensor>> rnnt_loss(
     torch::Tensor& logits,
     const torch::Tensor& targets,
     const torch::Tensor& logit_lengths,
     const torch::Tensor& target_lengths,
     int64_t blank,
+    double clamp,
+    bool reuse_logits_for_grads,
+    bool check_lengths,
+    const std::string& alphas_betas_kernel);
+
+std::tuple<torch::Tensor, c10::optional<torch::Tensor>> rnnt_loss_pruned(
+    torch::Tensor& logits,
+    const torch::Tensor& targets,
+    const torch::Tensor& logit_lengths,
+    const torch::Tensor& target_lengths,
+    const torch::Tensor& ranges,
+    int64_t blank,
     double clamp);
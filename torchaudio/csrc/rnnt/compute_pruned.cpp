@@ -0,0 +1,28 @@
+#include <torch/script.h>
+#include <torchaudio/csrc/rnnt/compute.h>
+
+std::tuple<torch::Tensor, c10::optional<torch::Tensor>> rnnt_loss_pruned(
+    torch::Tensor& logits,
+    const torch::Tensor& targets,
+    const torch::Tensor& logit_lengths,
+    const torch::Tensor& target_lengths,
+    const torch::Tensor& ranges,
+    int64_t blank,
+    double clamp) {
+  static auto op = torch::Dispatcher::singleton()
+                       .findSchemaOrThrow("torchaudio::rnnt_loss_pruned", "")
+                       .typed<decltype(rnnt_loss_pruned)>();
+  return op.call(
+      logits, targets, logit_lengths, target_lengths, ranges, blank, clamp);
+}
+
+TORCH_LIBRARY_FRAGMENT(torchaudio, m) {
+  m.def(
+      "rnnt_loss_pruned(Tensor logits,"
+      "Tensor targets,"
+      "Tensor logit_lengths,"
+      "Tensor target_lengths,"
+      "Tensor ranges,"
+      "int blank,"
+      "float clamp) -> (Tensor, Tensor?)");
+}
@@ -0,0 +1,11 @@
+#include <torch/script.h>
+
+TORCH_LIBRARY_FRAGMENT(torchaudio, m) {
+  m.def(
+      "rnnt_score(Tensor logits,"
+      "Tensor targets,"
+      "Tensor logit_lengths,"
+      "Tensor target_lengths,"
+      "int blank,"
+      "str alphas_betas_kernel=\"counters\") -> Tensor");
+}
@@ -1,5 +1,6 @@
 #include <torch/script.h>
 #include <torchaudio/csrc/rnnt/cpu/cpu_transducer.h>
+#include <torchaudio/csrc/rnnt/workspace_cache.h>
 
 namespace torchaudio {
 namespace rnnt {
@@ -12,7 +13,14 @@ std::tuple<torch::Tensor, c10::optional<torch::Tensor>> compute(
     const torch::Tensor& logit_lengths,
     const torch::Tensor& target_lengths,
     int64_t blank,
-    double clamp) {
+    double clamp,
+    bool reuse_logits_for_grads,
+    bool /*check_lengths*/,
+    const std::string& alphas_betas_kernel) {
+  // The lengths are always checked, as reading them does not wait for a
+  // device on CPU. The kernel of the alphas and the betas only applies to
+  // GPU, but is checked, so that the arguments are valid on all devices.
+  ParseAlphasBetasKernel(alphas_betas_kernel);
   TORCH_CHECK(
       logits.device().type() == targets.device().type(),
       "logits and targets must be on the same device");
@@ -41,32 +49,38 @@ std::tuple<torch::Tensor, c10::optional<torch::Tensor>> compute(
   TORCH_CHECK(
       target_lengths.is_contiguous(), "target_lengths must be contiguous");
 
+  // Packed logits are the (T_b, U_b, class) blocks of the sequences, with
+  // U_b = target_lengths[b] + 1, concatenated into (sum_b T_b * U_b, class).
+  const bool packed = logits.dim() == 2;
   TORCH_CHECK(
-      logits.dim() == 4, "logits must be 4-D (batch, time, target, class)");
+      logits.dim() == 4 || packed,
+      "logits must be 4-D (batch, time, target, class) or 2-D (row, class)");
   TORCH_CHECK(
       targets.dim() == 2, "targets must be 2-D (batch, max target length)");
   TORCH_CHECK(logit_lengths.dim() == 1, "logit_lengths must be 1-D");
   TORCH_CHECK(target_lengths.dim() == 1, "target_lengths must be 1-D");
 
+  const int64_t batch_size = packed ? logit_lengths.size(0) : logits.size(0);
   TORCH_CHECK(
-      logit_lengths.size(0) == logits.size(0),
+      logit_lengths.size(0) == batch_size,
       "batch dimension mismatch between logits and logit_lengths");
   TORCH_CHECK(
-      target_lengths.size(0) == logits.size(0),
+      target_lengths.size(0) == batch_size,
       "batch dimension mismatch between logits and target_lengths");
   TORCH_CHECK(
-      targets.size(0) == logits.size(0),
+      targets.size(0) == batch_size,
       "batch dimension mismatch between logits and targets");
 
   TORCH_CHECK(
       blank >= 0 && blank < logits.size(-1),
       "blank must be within [0, logits.shape[-1])");
 
+  const int max_src_length = at::max(logit_lengths).item().toInt();
   TORCH_CHECK(
-      logits.size(1) == at::max(logit_lengths).item().toInt(),
-      "input length mismatch");
+      packed || logits.size(1) == max_src_length, "input length mismatch");
   TORCH_CHECK(
-      logits.size(2) == at::max(target_lengths).item().toInt() + 1,
+      packed ||
+          logits.size(2) == at::max(target_lengths).item().toInt() + 1,
       "output length mismatch");
   TORCH_CHECK(
       targets.size(1) == at::max(target_lengths).item().toInt(),
@@ -75,38 +89,40 @@ std::tuple<torch::Tensor, c10::optional<torch::Tensor>> compute(
   Options options;
   options.batchSize_ = logit_lengths.size(0);
   options.nHypos_ = target_lengths.size(0) / logit_lengths.size(0);
-  options.maxSrcLen_ = logits.size(1);
-  options.maxTgtLen_ = logits.size(2);
-  options.numTargets_ = logits.size(3);
+  options.maxSrcLen_ = packed ? max_src_length : logits.size(1);
+  options.maxTgtLen_ = packed ? targets.size(1) + 1 : logits.size(2);
+  options.numTargets_ = logits.size(-1);
   options.blank_ = blank;
   options.clamp_ = clamp;
 
+  // The first row of each sequence, for the packed layout.
+  torch::Tensor offsets;
+  if (packed) {
+    const torch::Tensor rows = logit_lengths.to(torch::kInt64) *
+        (target_lengths.to(torch::kInt64) + 1);
+    TORCH_CHECK(
+        logits.size(0) == rows.sum().item().toLong(),
+        "packed logits must have sum(logit_lengths * (target_lengths + 1)) "
+        "rows");
+    offsets = (rows.cumsum(0) - rows).to(torch::kInt32);
+    options.packedOffsets_ = offsets.data_ptr<int>();
+    options.packedRows_ = logits.size(0);
+  }
+
   CHECK_EQ(logits.device().type(), torch::DeviceType::CPU);
   options.device_ = CPU;
 
   torch::Tensor costs = torch::empty(
       options.batchSize_ * options.nHypos_,
       torch::TensorOptions().device(logits.device()).dtype(logits.dtype()));
-  c10::optional<torch::Tensor> gradients = torch::zeros_like(logits);
-
-  torch::Tensor int_workspace = torch::empty(
-      IntWorkspace::ComputeSizeFromOptions(options),
-      torch::TensorOptions()
-          .device(logits.device())
-          .dtype(torch::ScalarType::Int));
-
-  torch::Tensor float_workspace = torch::empty(
-      DtypeWorkspace<float>::ComputeSizeFromOptions(options),
-      torch::TensorOptions()
-          .device(logits.device())
-          .dtype(torch::ScalarType::Float));
-
-  Workspace<float> workspace(
-      /*options=*/options,
-      /*dtype_data=*/float_workspace.data_ptr<float>(),
-      /*dtype_size=*/float_workspace.numel(),
-      /*int_data=*/int_workspace.data_ptr<int>(),
-      /*int_size=*/int_workspace.numel());
+  // The kernels write the gradients over the logits they have read, and zero
+  // the padding. All the rows of packed logits are written.
+  c10::optional<torch::Tensor> gradients = reuse_logits_for_grads
+      ? logits
+      : (packed ? torch::empty_like(logits) : torch::zeros_like(logits));
+
+  CachedWorkspace cached_workspace(options, logits.device());
+  const Workspace<float>& workspace = cached_workspace.get();
 
   switch (logits.scalar_type()) {
     case torch::ScalarType::Float: {
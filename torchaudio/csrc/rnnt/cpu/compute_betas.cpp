@@ -1,5 +1,6 @@
 #include <torch/script.h>
 #include <torchaudio/csrc/rnnt/cpu/cpu_transducer.h>
+#include <torchaudio/csrc/rnnt/workspace_cache.h>
 
 namespace torchaudio {
 namespace rnnt {
@@ -34,24 +35,8 @@ torch::Tensor compute_betas(
        options.maxTgtLen_},
       torch::TensorOptions().device(logits.device()).dtype(logits.dtype()));
 
-  torch::Tensor int_workspace = torch::empty(
-      IntWorkspace::ComputeSizeFromOptions(options),
-      torch::TensorOptions()
-          .device(logits.device())
-          .dtype(torch::ScalarType::Int));
-
-  torch::Tensor float_workspace = torch::empty(
-      DtypeWorkspace<float>::ComputeSizeFromOptions(options),
-      torch::TensorOptions()
-          .device(logits.device())
-          .dtype(torch::ScalarType::Float));
-
-  Workspace<float> workspace(
-      /*options=*/options,
-      /*dtype_data=*/float_workspace.data_ptr<float>(),
-      /*dtype_size=*/float_workspace.numel(),
-      /*int_data=*/int_workspace.data_ptr<int>(),
-      /*int_size=*/int_workspace.numel());
+  CachedWorkspace cached_workspace(options, logits.device());
+  const Workspace<float>& workspace = cached_workspace.get();
 
   // Only support float, this is mainly to enable easy
   // unit-testing
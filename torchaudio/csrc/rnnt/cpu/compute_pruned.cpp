@@ -0,0 +1,289 @@
+#include <torch/script.h>
+#include <torchaudio/csrc/rnnt/cpu/cpu_kernels.h>
+#include <torchaudio/csrc/rnnt/pruned_kernels.h>
+
+namespace torchaudio {
+namespace rnnt {
+namespace cpu {
+namespace {
+
+// Inputs:
+//   logits: pointer to (B, maxT, S, D) logits of the bands.
+//   targets: pointer to (B, maxTgtLen) targets in the batch.
+//   srcLengths: pointer to (B, ) source lengths in the batch.
+//   tgtLengths: pointer to (B, ) target lengths in the batch.
+//   ranges: pointer to (B, maxT) first symbol of the band of each frame.
+//   denominators, logProbs, alphas, betas: (B, maxT, S) buffers, (B, maxT, S,
+//     2) for logProbs.
+//
+// Outputs:
+//   costs: pointer to (B, ) costs in the batch.
+//   gradients: pointer to (B, maxT, S, D) gradients in the batch.
+template <typename DTYPE>
+void ComputePruned(
+    const Options& options,
+    int maxTgtLen,
+    const DTYPE* logits,
+    const int* targets,
+    const int* srcLengths,
+    const int* tgtLengths,
+    const int* ranges,
+    float* denominators,
+    float* logProbs,
+    float* alphas,
+    float* betas,
+    DTYPE* costs,
+    DTYPE* gradients) {
+  const int& B = options.batchSize_;
+  const int& maxT = options.maxSrcLen_;
+  const int& S = options.maxTgtLen_;
+  const int& D = options.numTargets_;
+  const int& blank = options.blank_;
+  const int64_t TS = static_cast<int64_t>(maxT) * S;
+
+  LogSumExp2D<DTYPE, float>(
+      /*options=*/options,
+      /*N=*/B * TS,
+      /*D=*/D,
+      /*logits=*/logits,
+      /*outputs=*/denominators);
+
+  ParallelFor(options, B, /*grainSize=*/1, [&](int b) {
+    const int T = srcLengths[b];
+    const int U = tgtLengths[b] + 1;
+    const int* r = ranges + b * maxT;
+    for (int t = 0; t < T; ++t) {
+      for (int s = 0; s < S; ++s) {
+        const int u = r[t] + s;
+        const int64_t idx = b * TS + t * S + s;
+        if (u < 0 || u >= U) {
+          logProbs[(idx << 1) + pruned::kSkip] = pruned::NegInf();
+          logProbs[(idx << 1) + pruned::kEmit] = pruned::NegInf();
+          continue;
+        }
+        const DTYPE* row = logits + idx * D;
+        logProbs[(idx << 1) + pruned::kSkip] =
+            float(row[blank]) - denominators[idx];
+        if (u < U - 1) {
+          logProbs[(idx << 1) + pruned::kEmit] =
+              float(row[targets[b * maxTgtLen + u]]) - denominators[idx];
+        }
+      }
+    }
+  });
+
+  // The alpha and the beta of a sequence are independent, so there are 2 * B
+  // jobs.
+  std::vector<float> scores(B << 1);
+  ParallelFor(options, B << 1, /*grainSize=*/1, [&](int i) {
+    const int b = i >> 1;
+    const float* seqLogProbs = logProbs + 2 * b * TS;
+    const int* seqRanges = ranges + b * maxT;
+    const int T = srcLengths[b];
+    const int U = tgtLengths[b] + 1;
+    if (i & 1) {
+      scores[i] = pruned::ComputeAlphaOneSequence(
+          seqLogProbs, seqRanges, T, U, S, alphas + b * TS);
+    } else {
+      scores[i] = pruned::ComputeBetaOneSequence(
+          seqLogProbs, seqRanges, T, U, S, betas + b * TS);
+    }
+  });
+  for (int b = 0; b < B; ++b) {
+    costs[b] = -scores[b << 1];
+  }
+
+  if (gradients == nullptr) {
+    return;
+  }
+  ParallelFor(options, B * maxT, /*grainSize=*/1, [&](int bt) {
+    const int b = bt / maxT;
+    const int t = bt % maxT;
+    const int U = tgtLengths[b] + 1;
+    const int* r = ranges + b * maxT;
+    const float cost = -scores[b << 1];
+    for (int s = 0; s < S; ++s) {
+      const int u = r[t] + s;
+      const int target =
+          u >= 0 && u < U - 1 ? targets[b * maxTgtLen + u] : -1;
+      const int64_t row = (static_cast<int64_t>(bt) * S + s) * D;
+      for (int d = 0; d < D; ++d) {
+        gradients[row + d] = pruned::ComputeGradient(
+            /*logit=*/float(logits[row + d]),
+            /*d=*/d,
+            /*t=*/t,
+            /*s=*/s,
+            /*T=*/srcLengths[b],
+            /*U=*/U,
+            /*S=*/S,
+            /*blank=*/blank,
+            /*target=*/target,
+            /*clamp=*/options.clamp_,
+            /*cost=*/cost,
+            /*ranges=*/r,
+            /*denom=*/denominators + b * TS,
+            /*alpha=*/alphas + b * TS,
+            /*beta=*/betas + b * TS);
+      }
+    }
+  });
+}
+
+} // namespace
+
+// Entry point into the pruned RNNT Loss
+std::tuple<torch::Tensor, c10::optional<torch::Tensor>> compute_pruned(
+    torch::Tensor& logits,
+    const torch::Tensor& targets,
+    const torch::Tensor& logit_lengths,
+    const torch::Tensor& target_lengths,
+    const torch::Tensor& ranges,
+    int64_t blank,
+    double clamp) {
+  TORCH_CHECK(
+      logits.device().type() == targets.device().type(),
+      "logits and targets must be on the same device");
+  TORCH_CHECK(
+      logits.device().type() == logit_lengths.device().type(),
+      "logits and logit_lengths must be on the same device");
+  TORCH_CHECK(
+      logits.device().type() == target_lengths.device().type(),
+      "logits and target_lengths must be on the same device");
+  TORCH_CHECK(
+      logits.device().type() == ranges.device().type(),
+      "logits and ranges must be on the same device");
+
+  TORCH_CHECK(
+      logits.dtype() == torch::kFloat32 || logits.dtype() == torch::kFloat16,
+      "logits must be float32 or float16 (half) type");
+  TORCH_CHECK(targets.dtype() == torch::kInt32, "targets must be int32 type");
+  TORCH_CHECK(
+      logit_lengths.dtype() == torch::kInt32,
+      "logit_lengths must be int32 type");
+  TORCH_CHECK(
+      target_lengths.dtype() == torch::kInt32,
+      "target_lengths must be int32 type");
+  TORCH_CHECK(ranges.dtype() == torch::kInt32, "ranges must be int32 type");
+
+  TORCH_CHECK(logits.is_contiguous(), "logits must be contiguous");
+  TORCH_CHECK(targets.is_contiguous(), "targets must be contiguous");
+  TORCH_CHECK(
+      logit_lengths.is_contiguous(), "logit_lengths must be contiguous");
+  TORCH_CHECK(
+      target_lengths.is_contiguous(), "target_lengths must be contiguous");
+  TORCH_CHECK(ranges.is_contiguous(), "ranges must be contiguous");
+
+  TORCH_CHECK(
+      logits.dim() == 4, "logits must be 4-D (batch, time, range, class)");
+  TORCH_CHECK(
+      targets.dim() == 2, "targets must be 2-D (batch, max target length)");
+  TORCH_CHECK(logit_lengths.dim() == 1, "logit_lengths must be 1-D");
+  TORCH_CHECK(target_lengths.dim() == 1, "target_lengths must be 1-D");
+  TORCH_CHECK(ranges.dim() == 2, "ranges must be 2-D (batch, time)");
+
+  TORCH_CHECK(
+      logit_lengths.size(0) == logits.size(0),
+      "batch dimension mismatch between logits and logit_lengths");
+  TORCH_CHECK(
+      target_lengths.size(0) == logits.size(0),
+      "batch dimension mismatch between logits and target_lengths");
+  TORCH_CHECK(
+      targets.size(0) == logits.size(0),
+      "batch dimension mismatch between logits and targets");
+  TORCH_CHECK(
+      ranges.size(0) == logits.size(0) && ranges.size(1) == logits.size(1),
+      "(batch, time) dimension mismatch between logits and ranges");
+
+  TORCH_CHECK(
+      blank >= 0 && blank < logits.size(-1),
+      "blank must be within [0, logits.shape[-1])");
+
+  TORCH_CHECK(
+      logits.size(1) == at::max(logit_lengths).item().toInt(),
+      "input length mismatch");
+  TORCH_CHECK(
+      targets.size(1) == at::max(target_lengths).item().toInt(),
+      "target length mismatch");
+  TORCH_CHECK(
+      logits.size(2) >= 1 && logits.size(2) <= targets.size(1) + 1,
+      "range must be within [1, max target length + 1]");
+
+  Options options;
+  options.batchSize_ = logit_lengths.size(0);
+  options.maxSrcLen_ = logits.size(1);
+  // The band takes the place of the target dimension.
+  options.maxTgtLen_ = logits.size(2);
+  options.numTargets_ = logits.size(3);
+  options.blank_ = blank;
+  options.clamp_ = clamp;
+
+  CHECK_EQ(logits.device().type(), torch::DeviceType::CPU);
+  options.device_ = CPU;
+
+  torch::Tensor costs = torch::empty(
+      options.batchSize_,
+      torch::TensorOptions().device(logits.device()).dtype(logits.dtype()));
+  c10::optional<torch::Tensor> gradients = torch::zeros_like(logits);
+
+  const auto float_options = torch::TensorOptions()
+                                 .device(logits.device())
+                                 .dtype(torch::ScalarType::Float);
+  torch::Tensor denominators = torch::empty(
+      {options.batchSize_, options.maxSrcLen_, options.maxTgtLen_},
+      float_options);
+  torch::Tensor log_probs = torch::empty(
+      {options.batchSize_, options.maxSrcLen_, options.maxTgtLen_, 2},
+      float_options);
+  torch::Tensor alphas = torch::empty_like(denominators);
+  torch::Tensor betas = torch::empty_like(denominators);
+
+  switch (logits.scalar_type()) {
+    case torch::ScalarType::Float: {
+      ComputePruned<float>(
+          /*options=*/options,
+          /*maxTgtLen=*/targets.size(1),
+          /*logits=*/logits.data_ptr<float>(),
+          /*targets=*/targets.data_ptr<int>(),
+          /*srcLengths=*/logit_lengths.data_ptr<int>(),
+          /*tgtLengths=*/target_lengths.data_ptr<int>(),
+          /*ranges=*/ranges.data_ptr<int>(),
+          /*denominators=*/denominators.data_ptr<float>(),
+          /*logProbs=*/log_probs.data_ptr<float>(),
+          /*alphas=*/alphas.data_ptr<float>(),
+          /*betas=*/betas.data_ptr<float>(),
+          /*costs=*/costs.data_ptr<float>(),
+          /*gradients=*/gradients->data_ptr<float>());
+      break;
+    }
+    case torch::ScalarType::Half: {
+      ComputePruned<c10::Half>(
+          /*options=*/options,
+          /*maxTgtLen=*/targets.size(1),
+          /*logits=*/logits.data_ptr<c10::Half>(),
+          /*targets=*/targets.data_ptr<int>(),
+          /*srcLengths=*/logit_lengths.data_ptr<int>(),
+          /*tgtLengths=*/target_lengths.data_ptr<int>(),
+          /*ranges=*/ranges.data_ptr<int>(),
+          /*denominators=*/denominators.data_ptr<float>(),
+          /*logProbs=*/log_probs.data_ptr<float>(),
+          /*alphas=*/alphas.data_ptr<float>(),
+          /*betas=*/betas.data_ptr<float>(),
+          /*costs=*/costs.data_ptr<c10::Half>(),
+          /*gradients=*/gradients->data_ptr<c10::Half>());
+      break;
+    }
+    default: {
+      break;
+    }
+  };
+
+  return std::make_tuple(costs, gradients);
+}
+
+TORCH_LIBRARY_IMPL(torchaudio, CPU, m) {
+  m.impl("rnnt_loss_pruned", &compute_pruned);
+}
+
+} // namespace cpu
+} // namespace rnnt
+} // namespace torchaudio
@@ -0,0 +1,141 @@
+#include <torch/script.h>
+#include <torchaudio/csrc/rnnt/cpu/cpu_transducer.h>
+#include <torchaudio/csrc/rnnt/workspace_cache.h>
+
+namespace torchaudio {
+namespace rnnt {
+namespace cpu {
+
+// Entry point into RNNT scoring: the costs of the H = target_lengths.size(0) /
+// logit_lengths.size(0) hypotheses of each sequence, without gradients.
+torch::Tensor compute_score(
+    const torch::Tensor& logits,
+    const torch::Tensor& targets,
+    const torch::Tensor& logit_lengths,
+    const torch::Tensor& target_lengths,
+    int64_t blank,
+    const std::string& alphas_betas_kernel) {
+  // The kernel of the alphas only applies to GPU, see compute.
+  ParseAlphasBetasKernel(alphas_betas_kernel);
+  TORCH_CHECK(
+      logits.device().type() == targets.device().type(),
+      "logits and targets must be on the same device");
+  TORCH_CHECK(
+      logits.device().type() == logit_lengths.device().type(),
+      "logits and logit_lengths must be on the same device");
+  TORCH_CHECK(
+      logits.device().type() == target_lengths.device().type(),
+      "logits and target_lengths must be on the same device");
+
+  TORCH_CHECK(
+      logits.dtype() == torch::kFloat32 || logits.dtype() == torch::kFloat16,
+      "logits must be float32 or float16 (half) type");
+  TORCH_CHECK(targets.dtype() == torch::kInt32, "targets must be int32 type");
+  TORCH_CHECK(
+      logit_lengths.dtype() == torch::kInt32,
+      "logit_lengths must be int32 type");
+  TORCH_CHECK(
+      target_lengths.dtype() == torch::kInt32,
+      "target_lengths must be int32 type");
+
+  TORCH_CHECK(logits.is_contiguous(), "logits must be contiguous");
+  TORCH_CHECK(targets.is_contiguous(), "targets must be contiguous");
+  TORCH_CHECK(
+      logit_lengths.is_contiguous(), "logit_lengths must be contiguous");
+  TORCH_CHECK(
+      target_lengths.is_contiguous(), "target_lengths must be contiguous");
+
+  TORCH_CHECK(
+      logits.dim() == 4,
+      "logits must be 4-D (batch * hypos, time, target, class)");
+  TORCH_CHECK(
+      targets.dim() == 2,
+      "targets must be 2-D (batch * hypos, max target length)");
+  TORCH_CHECK(logit_lengths.dim() == 1, "logit_lengths must be 1-D");
+  TORCH_CHECK(target_lengths.dim() == 1, "target_lengths must be 1-D");
+
+  TORCH_CHECK(
+      target_lengths.size(0) == logits.size(0),
+      "batch dimension mismatch between logits and target_lengths");
+  TORCH_CHECK(
+      targets.size(0) == logits.size(0),
+      "batch dimension mismatch between logits and targets");
+  TORCH_CHECK(
+      logit_lengths.size(0) > 0 &&
+          logits.size(0) % logit_lengths.size(0) == 0,
+      "the batch dimension of logits must be a multiple of the one of "
+      "logit_lengths");
+
+  TORCH_CHECK(
+      blank >= 0 && blank < logits.size(-1),
+      "blank must be within [0, logits.shape[-1])");
+
+  TORCH_CHECK(logits.size(2) == targets.size(1) + 1, "output length mismatch");
+  TORCH_CHECK(
+      at::max(logit_lengths).item().toInt() <= logits.size(1),
+      "input length mismatch");
+  TORCH_CHECK(
+      at::max(target_lengths).item().toInt() <= targets.size(1),
+      "target length mismatch");
+
+  // The CPU kernels read the source length of each hypothesis, so the
+  // lengths of the sequences are repeated for their hypotheses.
+  const int64_t n_hypos = logits.size(0) / logit_lengths.size(0);
+  const torch::Tensor src_lengths =
+      logit_lengths.repeat_interleave(n_hypos).contiguous();
+
+  Options options;
+  options.batchSize_ = logits.size(0);
+  options.nHypos_ = 1;
+  options.maxSrcLen_ = logits.size(1);
+  options.maxTgtLen_ = logits.size(2);
+  options.numTargets_ = logits.size(3);
+  options.blank_ = blank;
+  options.scoreOnly_ = true;
+
+  CHECK_EQ(logits.device().type(), torch::DeviceType::CPU);
+  options.device_ = CPU;
+
+  torch::Tensor costs = torch::empty(
+      options.batchSize_,
+      torch::TensorOptions().device(logits.device()).dtype(logits.dtype()));
+
+  CachedWorkspace cached_workspace(options, logits.device());
+  const Workspace<float>& workspace = cached_workspace.get();
+
+  switch (logits.scalar_type()) {
+    case torch::ScalarType::Float: {
+      ComputeScores</*DTYPE=*/float, /*CAST_DTYPE=*/float>(
+          /*workspace=*/workspace,
+          /*logits=*/logits.data_ptr<float>(),
+          /*targets=*/targets.data_ptr<int>(),
+          /*logit_lengths=*/src_lengths.data_ptr<int>(),
+          /*target_lengths=*/target_lengths.data_ptr<int>(),
+          /*costs=*/costs.data_ptr<float>());
+      break;
+    }
+    case torch::ScalarType::Half: {
+      ComputeScores</*DTYPE=*/c10::Half, /*CAST_DTYPE=*/float>(
+          /*workspace=*/workspace,
+          /*logits=*/logits.data_ptr<c10::Half>(),
+          /*targets=*/targets.data_ptr<int>(),
+          /*logit_lengths=*/src_lengths.data_ptr<int>(),
+          /*target_lengths=*/target_lengths.data_ptr<int>(),
+          /*costs=*/costs.data_ptr<c10::Half>());
+      break;
+    }
+    default: {
+      break;
+    }
+  };
+
+  return costs;
+}
+
+TORCH_LIBRARY_IMPL(torchaudio, CPU, m) {
+  m.impl("rnnt_score", &compute_score);
+}
+
+} // namespace cpu
+} // namespace rnnt
+} // namespace torchaudio
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <ATen/Parallel.h>
 #include <torchaudio/csrc/rnnt/cpu/math.h>
+#include <torchaudio/csrc/rnnt/cpu/wavefront.h>
 #include <torchaudio/csrc/rnnt/options.h>
 #include <torchaudio/csrc/rnnt/types.h>
 
+#include <array>
 #include <cstring>
 #include <limits>
 #include <vector>
@@ -34,52 +37,121 @@ struct LogProbs {
   }
 };
 
-// TensorView: view a block of allocated memory as a tensor.
-template <typename DTYPE>
+// TensorView: view a block of allocated memory as a row-major tensor of rank
+// N. The rank is a compile time constant, so indexing is a few multiply-adds
+// without any allocation or check: view(t, u) or view(t, u, d).
+template <typename DTYPE, int N>
 class TensorView {
  public:
-  TensorView(const std::vector<int>& dims, DTYPE* data)
+  TensorView(const std::array<int, N>& dims, DTYPE* data)
       : dims_(dims), data_(data) {
-    strides_.resize(dims.size());
-    strides_.back() = 1;
-    for (int i = dims.size() - 2; i >= 0; --i) {
+    strides_[N - 1] = 1;
+    for (int i = N - 2; i >= 0; --i) {
       strides_[i] = strides_[i + 1] * dims[i + 1];
     }
   }
 
-  DTYPE& operator()(const std::vector<int>& indices) {
-    CHECK_EQ(indices.size(), dims_.size());
-    int index = indices.back();
-    for (int i = indices.size() - 2; i >= 0; --i) {
-      index += indices[i] * strides_[i];
+  template <typename... Indices>
+  FORCE_INLINE DTYPE& operator()(Indices... indices) const {
+    static_assert(sizeof...(Indices) == N, "the number of indices must be N");
+    const int64_t idx[N] = {static_cast<int64_t>(indices)...};
+    int64_t index = idx[N - 1];
+    for (int i = 0; i < N - 1; ++i) {
+      index += idx[i] * strides_[i];
     }
     return data_[index];
   }
 
+  int dim(int i) const {
+    return dims_[i];
+  }
+
   void SetZero() {
-    int size = dims_[0] * strides_[0];
+    int64_t size = dims_[0] * strides_[0];
     std::memset(data_, 0, sizeof(DTYPE) * size);
   }
 
  private:
-  std::vector<int> dims_;
-  std::vector<int> strides_;
+  std::array<int, N> dims_;
+  std::array<int64_t, N> strides_;
   DTYPE* data_;
 };
 
+// The lattice of sequence b in the rows of the logits and of the buffers of
+// the workspace: the (maxT, maxU) block at b * maxT * maxU in the padded
+// layout, or the (T_b, U_b) block at options.packedOffsets_[b] in the packed
+// one.
+struct SequenceRows {
+  int64_t offset;
+  int maxT;
+  int maxU;
+};
+
+inline SequenceRows GetSequenceRows(
+    const Options& options,
+    int b,
+    const int* srcLengths,
+    const int* tgtLengths) {
+  if (options.IsPacked()) {
+    return {options.packedOffsets_[b], srcLengths[b], tgtLengths[b] + 1};
+  }
+  return {
+      static_cast<int64_t>(b) * options.maxSrcLen_ * options.maxTgtLen_,
+      options.maxSrcLen_,
+      options.maxTgtLen_};
+}
+
+// Calls fn(i) for i in [0, n) with at::parallel_for. If
+// options.numThreads_ is positive, the range is split into at most that many
+// tasks, so that no more threads are used. Otherwise, the range is split in
+// chunks of at least `grainSize` indices over the intra-op thread pool.
+template <typename Fn>
+void ParallelFor(const Options& options, int n, int grainSize, const Fn& fn) {
+  if (n <= 0) {
+    return;
+  }
+  const auto body = [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      fn(static_cast<int>(i));
+    }
+  };
+  if (options.numThreads_ <= 0) {
+    at::parallel_for(0, n, grainSize, body);
+    return;
+  }
+  const int numTasks = std::min(n, options.numThreads_);
+  if (numTasks == 1) {
+    body(0, n);
+    return;
+  }
+  at::parallel_for(0, numTasks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t task = begin; task < end; ++task) {
+      body(task * n / numTasks, (task + 1) * n / numTasks);
+    }
+  });
+}
+
 template <typename DTYPE, typename CAST_DTYPE>
-status_t LogSumExp2D(int N, int D, const DTYPE* logits, CAST_DTYPE* outputs) {
-  for (int i = 0; i < N * D; i += D) {
-    CAST_DTYPE max = logits[i];
+status_t LogSumExp2D(
+    const Options& options,
+    int N,
+    int D,
+    const DTYPE* logits,
+    CAST_DTYPE* outputs) {
+  // Rows of about 32k elements per task.
+  const int grainSize = std::max(1, (1 << 15) / std::max(D, 1));
+  ParallelFor(options, N, grainSize, [&](int n) {
+    const DTYPE* row = logits + static_cast<int64_t>(n) * D;
+    CAST_DTYPE max = row[0];
     for (int j = 1; j < D; ++j) {
-      max = std::max(max, CAST_DTYPE(logits[i + j]));
+      max = std::max(max, CAST_DTYPE(row[j]));
     }
     CAST_DTYPE sum = 0;
     for (int j = 0; j < D; ++j) {
-      sum = sum + std::exp(CAST_DTYPE(logits[i + j]) - max);
+      sum = sum + std::exp(CAST_DTYPE(row[j]) - max);
     }
-    outputs[i / D] = max + std::log(sum);
-  }
+    outputs[n] = max + std::log(sum);
+  });
 
   return SUCCESS;
 }
@@ -87,12 +159,12 @@ status_t LogSumExp2D(int N, int D, const DTYPE* logits, CAST_DTYPE* outputs) {
 template <typename DTYPE, typename CAST_DTYPE>
 void ComputeLogProbsOneSequence(
     const Options& options,
-    TensorView<const DTYPE>& logits,
+    const TensorView<const DTYPE, 3>& logits,
     const int* targets,
     int srcLen,
     int tgtLen,
-    TensorView<const CAST_DTYPE>& denom,
-    TensorView<LogProbs<CAST_DTYPE>>& logProbs) {
+    const TensorView<const CAST_DTYPE, 2>& denom,
+    const TensorView<LogProbs<CAST_DTYPE>, 2>& logProbs) {
   const int& T = srcLen;
   const int& U = tgtLen;
   const int& blank = options.blank_;
@@ -100,11 +172,11 @@ void ComputeLogProbsOneSequence(
   for (int t = 0; t < T; ++t) {
     for (int u = 0; u < U; ++u) {
       if (u < U - 1) {
-        logProbs({t, u}).emit() =
-            CAST_DTYPE(logits({t, u, targets[u]})) - denom({t, u});
+        logProbs(t, u).emit() =
+            CAST_DTYPE(logits(t, u, targets[u])) - denom(t, u);
       }
-      logProbs({t, u}).skip() =
-          CAST_DTYPE(logits({t, u, blank})) - denom({t, u});
+      logProbs(t, u).skip() =
+          CAST_DTYPE(logits(t, u, blank)) - denom(t, u);
     }
   }
 }
@@ -118,37 +190,29 @@ status_t ComputeLogProbs(
     const int* tgtLengths,
     const CAST_DTYPE* denominators,
     CAST_DTYPE* logProbs) {
-  std::vector<TensorView<const DTYPE>> seqLogits;
-  std::vector<const int*> seqTargets;
-  std::vector<TensorView<const CAST_DTYPE>> seqDenoms;
-  std::vector<TensorView<LogProbs<CAST_DTYPE>>> seqlogProbs;
-
   const int& B = options.batchSize_;
-  const int& maxT = options.maxSrcLen_;
   const int& maxU = options.maxTgtLen_;
   const int& D = options.numTargets_;
-  for (int b = 0; b < B; ++b) {
-    seqLogits.push_back(
-        TensorView<const DTYPE>({maxT, maxU, D}, logits + b * maxT * maxU * D));
-    seqTargets.push_back(targets + b * (maxU - 1));
-    seqDenoms.push_back(TensorView<const CAST_DTYPE>(
-        {maxT, maxU}, denominators + b * maxT * maxU));
-    seqlogProbs.push_back(TensorView<LogProbs<CAST_DTYPE>>(
-        {maxT, maxU},
-        reinterpret_cast<LogProbs<CAST_DTYPE>*>(logProbs) + b * maxT * maxU));
-  }
 
-  //#pragma omp parallel for
-  for (int b = 0; b < B; ++b) { // use max 2 * B threads.
+  ParallelFor(options, B, /*grainSize=*/1, [&](int b) {
+    const SequenceRows rows =
+        GetSequenceRows(options, b, srcLengths, tgtLengths);
     ComputeLogProbsOneSequence<DTYPE, CAST_DTYPE>(
         /*options=*/options,
-        /*logits=*/seqLogits[b],
-        /*targets=*/seqTargets[b],
+        /*logits=*/
+        TensorView<const DTYPE, 3>(
+            {rows.maxT, rows.maxU, D}, logits + rows.offset * D),
+        /*targets=*/targets + b * (maxU - 1),
         /*srcLen=*/srcLengths[b],
         /*tgtLen=*/tgtLengths[b] + 1, // with prepended blank.
-        /*denom=*/seqDenoms[b],
-        /*logProbs=*/seqlogProbs[b]);
-  }
+        /*denom=*/
+        TensorView<const CAST_DTYPE, 2>(
+            {rows.maxT, rows.maxU}, denominators + rows.offset),
+        /*logProbs=*/
+        TensorView<LogProbs<CAST_DTYPE>, 2>(
+            {rows.maxT, rows.maxU},
+            reinterpret_cast<LogProbs<CAST_DTYPE>*>(logProbs) + rows.offset));
+  });
 
   return SUCCESS;
 }
@@ -156,32 +220,36 @@ status_t ComputeLogProbs(
 template <typename DTYPE>
 DTYPE ComputeAlphaOneSequence(
     const Options& options,
-    TensorView<const LogProbs<DTYPE>>& logProbs,
+    const TensorView<const LogProbs<DTYPE>, 2>& logProbs,
     int srcLen,
     int tgtLen,
-    TensorView<DTYPE>& alpha) {
+    const TensorView<DTYPE, 2>& alpha) {
   const int& T = srcLen;
   const int& U = tgtLen;
 
-  alpha({0, 0}) = DTYPE(0);
+  if (UseWavefront(T, U)) {
+    return ComputeAlphaWavefront<DTYPE>(logProbs, T, U, alpha);
+  }
+
+  alpha(0, 0) = DTYPE(0);
 
   for (int t = 1; t < T; ++t) { // u == 0.
-    alpha({t, 0}) = alpha({t - 1, 0}) + logProbs({t - 1, 0}).skip();
+    alpha(t, 0) = alpha(t - 1, 0) + logProbs(t - 1, 0).skip();
   }
 
   for (int u = 1; u < U; ++u) { // t == 0.
-    alpha({0, u}) = alpha({0, u - 1}) + logProbs({0, u - 1}).emit();
+    alpha(0, u) = alpha(0, u - 1) + logProbs(0, u - 1).emit();
   }
 
   for (int t = 1; t < T; ++t) {
     for (int u = 1; u < U; ++u) {
-      alpha({t, u}) = math::lse(
-          alpha({t - 1, u}) + logProbs({t - 1, u}).skip(),
-          alpha({t, u - 1}) + logProbs({t, u - 1}).emit());
+      alpha(t, u) = math::lse(
+          alpha(t - 1, u) + logProbs(t - 1, u).skip(),
+          alpha(t, u - 1) + logProbs(t, u - 1).emit());
     }
   }
 
-  DTYPE forward_score = alpha({T - 1, U - 1}) + logProbs({T - 1, U - 1}).skip();
+  DTYPE forward_score = alpha(T - 1, U - 1) + logProbs(T - 1, U - 1).skip();
 
   return forward_score;
 }
@@ -189,32 +257,36 @@ DTYPE ComputeAlphaOneSequence(
 template <typename DTYPE>
 DTYPE ComputeBetaOneSequence(
     const Options& options,
-    TensorView<const LogProbs<DTYPE>>& logProbs,
+    const TensorView<const LogProbs<DTYPE>, 2>& logProbs,
     int srcLen,
     int tgtLen,
-    TensorView<DTYPE>& beta) {
+    const TensorView<DTYPE, 2>& beta) {
   const int& T = srcLen;
   const int& U = tgtLen;
 
-  beta({T - 1, U - 1}) = logProbs({T - 1, U - 1}).skip();
+  if (UseWavefront(T, U)) {
+    return ComputeBetaWavefront<DTYPE>(logProbs, T, U, beta);
+  }
+
+  beta(T - 1, U - 1) = logProbs(T - 1, U - 1).skip();
 
   for (int t = T - 2; t >= 0; --t) { // u == U - 1.
-    beta({t, U - 1}) = beta({t + 1, U - 1}) + logProbs({t, U - 1}).skip();
+    beta(t, U - 1) = beta(t + 1, U - 1) + logProbs(t, U - 1).skip();
   }
 
   for (int u = U - 2; u >= 0; --u) { // t == T - 1.
-    beta({T - 1, u}) = beta({T - 1, u + 1}) + logProbs({T - 1, u}).emit();
+    beta(T - 1, u) = beta(T - 1, u + 1) + logProbs(T - 1, u).emit();
   }
 
   for (int t = T - 2; t >= 0; --t) {
     for (int u = U - 2; u >= 0; --u) {
-      beta({t, u}) = math::lse(
-          beta({t + 1, u}) + logProbs({t, u}).skip(),
-          beta({t, u + 1}) + logProbs({t, u}).emit());
+      beta(t, u) = math::lse(
+          beta(t + 1, u) + logProbs(t, u).skip(),
+          beta(t, u + 1) + logProbs(t, u).emit());
     }
   }
 
-  DTYPE backward_score = beta({0, 0});
+  DTYPE backward_score = beta(0, 0);
 
   return backward_score;
 }
@@ -223,11 +295,11 @@ template <typename DTYPE>
 DTYPE ComputeAlphaOrBetaOneSequence(
     int thread,
     const Options& options,
-    TensorView<const LogProbs<DTYPE>>& logProbs,
+    const TensorView<const LogProbs<DTYPE>, 2>& logProbs,
     int srcLen,
     int tgtLen,
-    TensorView<DTYPE>& alpha,
-    TensorView<DTYPE>& beta) {
+    const TensorView<DTYPE, 2>& alpha,
+    const TensorView<DTYPE, 2>& beta) {
   if (thread & 1) {
     return ComputeAlphaOneSequence<DTYPE>(
         /*options=*/options,
@@ -254,39 +326,30 @@ void ComputeAlphasBetas(
     CAST_DTYPE* alphas,
     CAST_DTYPE* betas,
     DTYPE* costs) {
-  std::vector<TensorView<const LogProbs<CAST_DTYPE>>> seqlogProbs;
-  std::vector<TensorView<CAST_DTYPE>> seq_alphas;
-  std::vector<TensorView<CAST_DTYPE>> seq_betas;
-
   const int& B = options.batchSize_;
-  const int& maxT = options.maxSrcLen_;
-  const int& maxU = options.maxTgtLen_;
-
-  for (int b = 0; b < B; ++b) {
-    seqlogProbs.push_back(TensorView<const LogProbs<CAST_DTYPE>>(
-        {maxT, maxU},
-        reinterpret_cast<LogProbs<CAST_DTYPE>*>(
-            const_cast<CAST_DTYPE*>(logProbs)) +
-            b * maxT * maxU));
-    seq_alphas.push_back(
-        TensorView<CAST_DTYPE>({maxT, maxU}, alphas + b * maxT * maxU));
-    seq_betas.push_back(
-        TensorView<CAST_DTYPE>({maxT, maxU}, betas + b * maxT * maxU));
-  }
+  const auto* seqLogProbs =
+      reinterpret_cast<const LogProbs<CAST_DTYPE>*>(logProbs);
 
+  // The alpha and the beta of a sequence are independent, so there are 2 * B
+  // jobs.
   std::vector<CAST_DTYPE> scores(B << 1);
-  //#pragma omp parallel for
-  for (int t = 0; t < (B << 1); ++t) { // use max 2 * B threads.
+  ParallelFor(options, B << 1, /*grainSize=*/1, [&](int t) {
     int i = (t >> 1);
+    const SequenceRows rows =
+        GetSequenceRows(options, i, srcLengths, tgtLengths);
     scores[t] = ComputeAlphaOrBetaOneSequence<CAST_DTYPE>(
         /*thread=*/t,
         /*options=*/options,
-        /*logProbs=*/seqlogProbs[i],
+        /*logProbs=*/
+        TensorView<const LogProbs<CAST_DTYPE>, 2>(
+            {rows.maxT, rows.maxU}, seqLogProbs + rows.offset),
         /*srcLen=*/srcLengths[i],
         /*tgtLen=*/tgtLengths[i] + 1, // with prepended blank.
-        /*alpha=*/seq_alphas[i],
-        /*beta=*/seq_betas[i]);
-  }
+        /*alpha=*/
+        TensorView<CAST_DTYPE, 2>({rows.maxT, rows.maxU}, alphas + rows.offset),
+        /*beta=*/
+        TensorView<CAST_DTYPE, 2>({rows.maxT, rows.maxU}, betas + rows.offset));
+  });
   for (int b = 0; b < B; ++b) {
     costs[b] = -scores[b << 1];
   }
@@ -295,24 +358,33 @@ void ComputeAlphasBetas(
 template <typename DTYPE, typename CAST_DTYPE>
 void ComputeGradientsOneSequence(
     const Options& options,
-    TensorView<const DTYPE>& logits,
+    const TensorView<const DTYPE, 3>& logits,
     const int* targets,
     int srcLen,
     int tgtLen,
-    TensorView<const CAST_DTYPE>& denom,
-    TensorView<const CAST_DTYPE>& alpha,
-    TensorView<const CAST_DTYPE>& beta,
-    TensorView<DTYPE>& gradients) {
+    const TensorView<const CAST_DTYPE, 2>& denom,
+    const TensorView<const CAST_DTYPE, 2>& alpha,
+    const TensorView<const CAST_DTYPE, 2>& beta,
+    const TensorView<DTYPE, 3>& gradients,
+    int tBegin = 0,
+    int tEnd = -1) {
   // don't set gradients to zero to here as gradients might reuse memory from
   // logits
 
+  // Only the rows [tBegin, tEnd) of the frames are computed (all of them by
+  // default), so that a sequence can be split over multiple threads.
+  const int maxT = logits.dim(0);
+  if (tEnd < 0) {
+    tEnd = maxT;
+  }
+
   const int& T = srcLen;
   const int& U = tgtLen;
   const int& D = options.numTargets_;
   const int& blank = options.blank_;
   const CAST_DTYPE clamp = options.clamp_;
 
-  CAST_DTYPE cost = -beta({0, 0});
+  CAST_DTYPE cost = -beta(0, 0);
 
   // Note - below gradient is different from numpy_transducer, since we
   // compute log_softmax more efficiently within the loss, to save memory The
@@ -320,28 +392,28 @@ void ComputeGradientsOneSequence(
   // (function merging) in below paper:
   // https://www.microsoft.com/en-us/research/uploads/prod/2019/10/RNNT.pdf
 
-  for (int t = 0; t < T; ++t) {
+  for (int t = tBegin; t < std::min(T, tEnd); ++t) {
     for (int u = 0; u < U; ++u) {
-      CAST_DTYPE c = alpha({t, u}) + cost - denom({t, u});
+      CAST_DTYPE c = alpha(t, u) + cost - denom(t, u);
       for (int d = 0; d < D; ++d) {
-        CAST_DTYPE g = CAST_DTYPE(logits({t, u, d})) + c;
+        CAST_DTYPE g = CAST_DTYPE(logits(t, u, d)) + c;
         if (d == blank && t == T - 1 && u == U - 1) { // last blank transition.
-          gradients({t, u, d}) = std::exp(g + beta({t, u})) - std::exp(g);
+          gradients(t, u, d) = std::exp(g + beta(t, u)) - std::exp(g);
         } else if (d == blank && t < T - 1) {
-          gradients({t, u, d}) =
-              std::exp(g + beta({t, u})) - std::exp(g + beta({t + 1, u}));
+          gradients(t, u, d) =
+              std::exp(g + beta(t, u)) - std::exp(g + beta(t + 1, u));
         } else if (u < U - 1 && d == targets[u]) {
-          gradients({t, u, d}) =
-              std::exp(g + beta({t, u})) - std::exp(g + beta({t, u + 1}));
+          gradients(t, u, d) =
+              std::exp(g + beta(t, u)) - std::exp(g + beta(t, u + 1));
         } else {
-          gradients({t, u, d}) = std::exp(g + beta({t, u}));
+          gradients(t, u, d) = std::exp(g + beta(t, u));
         }
 
         if (clamp > 0) {
-          gradients({t, u, d}) =
-              math::min(CAST_DTYPE(gradients({t, u, d})), clamp);
-          gradients({t, u, d}) =
-              math::max(CAST_DTYPE(gradients({t, u, d})), -clamp);
+          gradients(t, u, d) =
+              math::min(CAST_DTYPE(gradients(t, u, d)), clamp);
+          gradients(t, u, d) =
+              math::max(CAST_DTYPE(gradients(t, u, d)), -clamp);
         }
       }
     }
@@ -349,20 +421,19 @@ void ComputeGradientsOneSequence(
 
   // zero out the rest of the gradients, necessary when reusing logits memory
   // check the memory location to see if it's necessary
-  if (&gradients({0, 0, 0}) == &logits({0, 0, 0})) {
-    const int& maxT = options.maxSrcLen_;
-    const int& maxU = options.maxTgtLen_;
-    for (int t = T; t < maxT; ++t) {
+  if (&gradients(0, 0, 0) == &logits(0, 0, 0)) {
+    const int maxU = logits.dim(1);
+    for (int t = std::max(T, tBegin); t < tEnd; ++t) {
       for (int u = 0; u < maxU; ++u) {
         for (int d = 0; d < D; ++d) {
-          gradients({t, u, d}) = 0.;
+          gradients(t, u, d) = 0.;
         }
       }
     }
-    for (int t = 0; t < T; ++t) {
+    for (int t = tBegin; t < std::min(T, tEnd); ++t) {
       for (int u = U; u < maxU; ++u) {
         for (int d = 0; d < D; ++d) {
-          gradients({t, u, d}) = 0.;
+          gradients(t, u, d) = 0.;
         }
       }
     }
@@ -380,44 +451,47 @@ void ComputeGradients(
     const CAST_DTYPE* alphas,
     const CAST_DTYPE* betas,
     DTYPE* gradients) {
-  std::vector<TensorView<const DTYPE>> seqLogits;
-  std::vector<const int*> seqTargets;
-  std::vector<TensorView<const CAST_DTYPE>> seqDenoms;
-  std::vector<TensorView<const CAST_DTYPE>> seq_alphas;
-  std::vector<TensorView<const CAST_DTYPE>> seq_betas;
-  std::vector<TensorView<DTYPE>> seq_gradients;
-
   const int& B = options.batchSize_;
   const int& maxT = options.maxSrcLen_;
   const int& maxU = options.maxTgtLen_;
   const int& D = options.numTargets_;
-  for (int b = 0; b < B; ++b) {
-    seqLogits.push_back(
-        TensorView<const DTYPE>({maxT, maxU, D}, logits + b * maxT * maxU * D));
-    seqTargets.push_back(targets + b * (maxU - 1));
-    seqDenoms.push_back(TensorView<const CAST_DTYPE>(
-        {maxT, maxU}, denominators + b * maxT * maxU));
-    seq_alphas.push_back(
-        TensorView<const CAST_DTYPE>({maxT, maxU}, alphas + b * maxT * maxU));
-    seq_betas.push_back(
-        TensorView<const CAST_DTYPE>({maxT, maxU}, betas + b * maxT * maxU));
-    seq_gradients.push_back(
-        TensorView<DTYPE>({maxT, maxU, D}, gradients + b * maxT * maxU * D));
-  }
 
-  //#pragma omp parallel for
-  for (int b = 0; b < B; ++b) { // use max 2 * B threads.
+  // Each gradient only depends on alpha and beta, so the sequences are split
+  // in tiles of kGradientTile frames (of all the targets), which balances
+  // batches of sequences of different lengths.
+  constexpr int kGradientTile = 8;
+  const int numTiles = (maxT + kGradientTile - 1) / kGradientTile;
+  ParallelFor(options, B * numTiles, /*grainSize=*/1, [&](int i) {
+    const int b = i / numTiles;
+    const int tBegin = (i % numTiles) * kGradientTile;
+    const SequenceRows rows =
+        GetSequenceRows(options, b, srcLengths, tgtLengths);
+    if (tBegin >= rows.maxT) { // past the frames of a packed sequence.
+      return;
+    }
     ComputeGradientsOneSequence<DTYPE, CAST_DTYPE>(
         /*options=*/options,
-        /*logits=*/seqLogits[b],
-        /*targets=*/seqTargets[b],
+        /*logits=*/
+        TensorView<const DTYPE, 3>(
+            {rows.maxT, rows.maxU, D}, logits + rows.offset * D),
+        /*targets=*/targets + b * (maxU - 1),
         /*srcLen=*/srcLengths[b],
         /*tgtLen=*/tgtLengths[b] + 1, // with prepended blank.
-        /*denom=*/seqDenoms[b],
-        /*alpha=*/seq_alphas[b],
-        /*beta=*/seq_betas[b],
-        /*gradients=*/seq_gradients[b]);
-  }
+        /*denom=*/
+        TensorView<const CAST_DTYPE, 2>(
+            {rows.maxT, rows.maxU}, denominators + rows.offset),
+        /*alpha=*/
+        TensorView<const CAST_DTYPE, 2>(
+            {rows.maxT, rows.maxU}, alphas + rows.offset),
+        /*beta=*/
+        TensorView<const CAST_DTYPE, 2>(
+            {rows.maxT, rows.maxU}, betas + rows.offset),
+        /*gradients=*/
+        TensorView<DTYPE, 3>(
+            {rows.maxT, rows.maxU, D}, gradients + rows.offset * D),
+        /*tBegin=*/tBegin,
+        /*tEnd=*/std::min(tBegin + kGradientTile, rows.maxT));
+  });
 }
 
 template <typename DTYPE, typename CAST_DTYPE>
@@ -426,34 +500,29 @@ void ComputeAlphas(
     const CAST_DTYPE* logProbs,
     const int* srcLengths,
     const int* tgtLengths,
-    CAST_DTYPE* alphas) {
-  std::vector<TensorView<const LogProbs<CAST_DTYPE>>> seqlogProbs;
-  std::vector<TensorView<CAST_DTYPE>> seq_alphas;
-
+    CAST_DTYPE* alphas,
+    DTYPE* costs = nullptr) {
   const int& B = options.batchSize_;
-  const int& maxT = options.maxSrcLen_;
-  const int& maxU = options.maxTgtLen_;
-
-  for (int b = 0; b < B; ++b) {
-    seqlogProbs.push_back(TensorView<const LogProbs<CAST_DTYPE>>(
-        {maxT, maxU},
-        reinterpret_cast<LogProbs<CAST_DTYPE>*>(
-            const_cast<CAST_DTYPE*>(logProbs)) +
-            b * maxT * maxU));
-    seq_alphas.push_back(
-        TensorView<CAST_DTYPE>({maxT, maxU}, alphas + b * maxT * maxU));
-  }
+  const auto* seqLogProbs =
+      reinterpret_cast<const LogProbs<CAST_DTYPE>*>(logProbs);
 
-  std::vector<CAST_DTYPE> scores(B << 1);
-  //#pragma omp parallel for
-  for (int i = 0; i < B; ++i) { // use max 2 * B threads.
-    ComputeAlphaOneSequence<DTYPE>(
+  ParallelFor(options, B, /*grainSize=*/1, [&](int i) {
+    const SequenceRows rows =
+        GetSequenceRows(options, i, srcLengths, tgtLengths);
+    const CAST_DTYPE score = ComputeAlphaOneSequence<CAST_DTYPE>(
         options,
-        /*logProbs=*/seqlogProbs[i],
+        /*logProbs=*/
+        TensorView<const LogProbs<CAST_DTYPE>, 2>(
+            {rows.maxT, rows.maxU}, seqLogProbs + rows.offset),
         /*srcLen=*/srcLengths[i],
         /*tgtLen=*/tgtLengths[i] + 1, // with prepended blank.
-        /*alpha=*/seq_alphas[i]);
-  }
+        /*alpha=*/
+        TensorView<CAST_DTYPE, 2>(
+            {rows.maxT, rows.maxU}, alphas + rows.offset));
+    if (costs != nullptr) {
+      costs[i] = -score;
+    }
+  });
 }
 
 template <typename DTYPE, typename CAST_DTYPE>
@@ -464,33 +533,23 @@ void ComputeBetas(
     const int* tgtLengths,
     CAST_DTYPE* costs,
     CAST_DTYPE* betas) {
-  std::vector<TensorView<const LogProbs<CAST_DTYPE>>> seqlogProbs;
-  std::vector<TensorView<CAST_DTYPE>> seq_betas;
-
   const int& B = options.batchSize_;
-  const int& maxT = options.maxSrcLen_;
-  const int& maxU = options.maxTgtLen_;
+  const auto* seqLogProbs =
+      reinterpret_cast<const LogProbs<CAST_DTYPE>*>(logProbs);
 
-  for (int b = 0; b < B; ++b) {
-    seqlogProbs.push_back(TensorView<const LogProbs<CAST_DTYPE>>(
-        {maxT, maxU},
-        reinterpret_cast<LogProbs<CAST_DTYPE>*>(
-            const_cast<CAST_DTYPE*>(logProbs)) +
-            b * maxT * maxU));
-    seq_betas.push_back(
-        TensorView<CAST_DTYPE>({maxT, maxU}, betas + b * maxT * maxU));
-  }
-
-  std::vector<CAST_DTYPE> scores(B << 1);
-  //#pragma omp parallel for
-  for (int i = 0; i < B; ++i) { // use max 2 * B threads.
+  ParallelFor(options, B, /*grainSize=*/1, [&](int i) {
+    const SequenceRows rows =
+        GetSequenceRows(options, i, srcLengths, tgtLengths);
     ComputeBetaOneSequence<DTYPE>(
         options,
-        /*logProbs=*/seqlogProbs[i],
+        /*logProbs=*/
+        TensorView<const LogProbs<CAST_DTYPE>, 2>(
+            {rows.maxT, rows.maxU}, seqLogProbs + rows.offset),
         /*srcLen=*/srcLengths[i],
         /*tgtLen=*/tgtLengths[i] + 1, // with prepended blank.
-        /*betas=*/seq_betas[i]);
-  }
+        /*betas=*/
+        TensorView<CAST_DTYPE, 2>({rows.maxT, rows.maxU}, betas + rows.offset));
+  });
 }
 
 } // namespace cpu
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <torchaudio/csrc/rnnt/cpu/cpu_kernels.h>
+#include <torchaudio/csrc/rnnt/record_function.h>
 #include <torchaudio/csrc/rnnt/workspace.h>
 
 namespace torchaudio {
@@ -9,14 +10,15 @@ namespace cpu {
 
 // Inputs:
 //   workspace: workspace.
-//   logits: pointer to (B, maxT, maxU, D) logits.
+//   logits: pointer to (B, maxT, maxU, D) logits, or to the
+//     (options.packedRows_, D) rows of the packed layout.
 //   targets: pointer to (B, maxU - 1) targets in the batch.
 //   srcLengths: pointer to (B, ) source lengths in the batch.
 //   tgtLengths: pointer to (B, ) target lengths in the batch.
 //
 // Outputs:
 //   costs: pointer to (B, ) costs in the batch.
-//   gradients: pointer to (B, maxT, maxU, D) gradients in the batch.
+//   gradients: pointer to the gradients in the batch, of the shape of logits.
 template <typename DTYPE, typename CAST_DTYPE>
 status_t Compute(
     const Workspace<CAST_DTYPE>& workspace,
@@ -30,20 +32,20 @@ status_t Compute(
 
   CHECK_EQ(options.device_, CPU);
 
-  const int& B = options.batchSize_;
-  const int& maxT = options.maxSrcLen_;
-  const int& maxU = options.maxTgtLen_;
   const int& D = options.numTargets_;
 
   { // compute denominators.
+    RNNT_RECORD_STAGE("torchaudio::rnnt::denominators", options);
     LogSumExp2D<DTYPE, CAST_DTYPE>(
-        /*N=*/B * maxT * maxU,
+        /*options=*/options,
+        /*N=*/options.BTU(),
         /*D=*/D,
         /*logits=*/logits,
         /*denominators=*/workspace.GetPointerToDenominators());
   }
 
   { // compute log prob pairs.
+    RNNT_RECORD_STAGE("torchaudio::rnnt::log_probs", options);
     ComputeLogProbs<DTYPE, CAST_DTYPE>(
         /*options=*/options,
         /*logits=*/logits,
@@ -55,6 +57,7 @@ status_t Compute(
   }
 
   { // compute alphas and betas.
+    RNNT_RECORD_STAGE("torchaudio::rnnt::alphas_betas", options);
     ComputeAlphasBetas<DTYPE, CAST_DTYPE>(
         /*options=*/options,
         /*log_probs=*/workspace.GetPointerToLogProbs(),
@@ -66,6 +69,7 @@ status_t Compute(
   }
 
   if (gradients != nullptr) {
+    RNNT_RECORD_STAGE("torchaudio::rnnt::gradients", options);
     ComputeGradients<DTYPE, CAST_DTYPE>(
         /*options=*/options,
         /*logits=*/logits,
@@ -93,14 +97,12 @@ status_t ComputeAlphas(
 
   CHECK_EQ(options.device_, CPU);
 
-  const int& B = options.batchSize_;
-  const int& maxT = options.maxSrcLen_;
-  const int& maxU = options.maxTgtLen_;
   const int& D = options.numTargets_;
 
   { // compute denominators.
     LogSumExp2D<DTYPE, CAST_DTYPE>(
-        /*N=*/B * maxT * maxU,
+        /*options=*/options,
+        /*N=*/options.BTU(),
         /*D=*/D,
         /*logits=*/logits,
         /*denominators=*/workspace.GetPointerToDenominators());
@@ -142,14 +144,12 @@ status_t ComputeBetas(
 
   CHECK_EQ(options.device_, CPU);
 
-  const int& B = options.batchSize_;
-  const int& maxT = options.maxSrcLen_;
-  const int& maxU = options.maxTgtLen_;
   const int& D = options.numTargets_;
 
   { // compute denominators.
     LogSumExp2D<DTYPE, CAST_DTYPE>(
-        /*N=*/B * maxT * maxU,
+        /*options=*/options,
+        /*N=*/options.BTU(),
         /*D=*/D,
         /*logits=*/logits,
         /*denominators=*/workspace.GetPointerToDenominators());
@@ -179,6 +179,58 @@ status_t ComputeBetas(
   return SUCCESS;
 }
 
+// Computes the costs from the alphas only, for the scoring of sequences
+// without gradients. The workspace only needs options.scoreOnly_.
+//
+// Outputs:
+//   costs: pointer to (B, ) costs in the batch.
+template <typename DTYPE, typename CAST_DTYPE>
+status_t ComputeScores(
+    const Workspace<CAST_DTYPE>& workspace,
+    const DTYPE* logits,
+    const int* targets,
+    const int* srcLengths,
+    const int* tgtLengths,
+    DTYPE* costs) {
+  const Options& options = workspace.GetOptions();
+
+  CHECK_EQ(options.device_, CPU);
+
+  const int& D = options.numTargets_;
+
+  { // compute denominators.
+    LogSumExp2D<DTYPE, CAST_DTYPE>(
+        /*options=*/options,
+        /*N=*/options.BTU(),
+        /*D=*/D,
+        /*logits=*/logits,
+        /*denominators=*/workspace.GetPointerToDenominators());
+  }
+
+  { // compute log prob pairs.
+    ComputeLogProbs<DTYPE, CAST_DTYPE>(
+        /*options=*/options,
+        /*logits=*/logits,
+        /*targets=*/targets,
+        /*srcLengths=*/srcLengths,
+        /*tgtLengths=*/tgtLengths,
+        /*denominators=*/workspace.GetPointerToDenominators(),
+        /*log_probs=*/workspace.GetPointerToLogProbs());
+  }
+
+  { // compute alphas and costs.
+    ComputeAlphas<DTYPE, CAST_DTYPE>(
+        /*options=*/options,
+        /*log_probs=*/workspace.GetPointerToLogProbs(),
+        /*srcLengths=*/srcLengths,
+        /*tgtLengths=*/tgtLengths,
+        /*alphas=*/workspace.GetPointerToAlphas(),
+        /*costs=*/costs);
+  }
+
+  return SUCCESS;
+}
+
 } // namespace cpu
 } // namespace rnnt
 } // namespace torchaudio
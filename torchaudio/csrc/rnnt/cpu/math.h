@@ -2,6 +2,8 @@
 
 #include <torchaudio/csrc/rnnt/macros.h>
 
+#include <cmath>
+
 namespace torchaudio {
 namespace rnnt {
 
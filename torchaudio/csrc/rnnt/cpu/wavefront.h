@@ -0,0 +1,197 @@
+#pragma once
+
+#include <torchaudio/csrc/rnnt/cpu/math.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace torchaudio {
+namespace rnnt {
+namespace cpu {
+
+// Anti-diagonal (wavefront) order of the alpha and beta recursions.
+//
+// alpha(t, u) depends on alpha(t - 1, u) and alpha(t, u - 1), so in the
+// t-major order every cell waits for the log-sum-exp of the previous one. The
+// cells of an anti-diagonal t + u = k only depend on the diagonal k - 1 (k + 1
+// for beta), so the diagonal is computed as a whole: the inputs are gathered
+// into contiguous buffers indexed by t (the diagonal-major layout), the
+// log-sum-exp runs over the buffers in a loop without dependency between the
+// iterations, which is vectorized, and the results are written back in the
+// (t, u) layout that the gradients and `compute_alphas`/`compute_betas` use.
+
+// Sequences whose shorter side is below this use the t-major loops, since
+// their diagonals are too short to amortize the gathering.
+constexpr int kMinWavefrontLength = 16;
+
+inline bool UseWavefront(int T, int U) {
+  return std::min(T, U) >= kMinWavefrontLength;
+}
+
+namespace wavefront {
+
+// exp(x) for x in [-87, 0], with the Cephes polynomial, written with
+// operations that vectorize (no branch, no library call). The relative error
+// is within 2 ulp.
+FORCE_INLINE float exp_nonpositive(float x) {
+  constexpr float kLog2e = 1.44269504088896341f;
+  constexpr float kLn2Hi = 0.693359375f;
+  constexpr float kLn2Lo = -2.12194440e-4f;
+  // Adding and subtracting 1.5 * 2^23 rounds to the nearest integer.
+  constexpr float kRound = 12582912.f;
+  const float n = (x * kLog2e + kRound) - kRound;
+  const float r = x - n * kLn2Hi - n * kLn2Lo;
+  float p = 1.9875691500e-4f;
+  p = p * r + 1.3981999507e-3f;
+  p = p * r + 8.3334519073e-3f;
+  p = p * r + 4.1665795894e-2f;
+  p = p * r + 1.6666665459e-1f;
+  p = p * r + 5.0000001201e-1f;
+  p = p * r * r + r + 1.f;
+  const int32_t bits = (static_cast<int32_t>(n) + 127) << 23;
+  float scale;
+  std::memcpy(&scale, &bits, sizeof(scale));
+  return p * scale;
+}
+
+// log(x) for x in [1, 2], with the Cephes polynomial.
+FORCE_INLINE float log_1_to_2(float x) {
+  // Split x into 2^e * m with m in [sqrt(0.5), sqrt(2)), on the bits: the
+  // offset carries into the exponent for mantissas of sqrt(2) and above.
+  constexpr int32_t kSqrtHalfBits = 0x3f3504f3;
+  int32_t bits;
+  std::memcpy(&bits, &x, sizeof(bits));
+  bits += 0x3f800000 - kSqrtHalfBits;
+  const float e = static_cast<float>((bits >> 23) - 127);
+  bits = (bits & 0x007fffff) + kSqrtHalfBits;
+  float m;
+  std::memcpy(&m, &bits, sizeof(m));
+  const float f = m - 1.f;
+  const float z = f * f;
+  float y = 7.0376836292e-2f;
+  y = y * f - 1.1514610310e-1f;
+  y = y * f + 1.1676998740e-1f;
+  y = y * f - 1.2420140846e-1f;
+  y = y * f + 1.4249322787e-1f;
+  y = y * f - 1.6668057665e-1f;
+  y = y * f + 2.0000714765e-1f;
+  y = y * f - 2.4999993993e-1f;
+  y = y * f + 3.3333331174e-1f;
+  y = y * f * z;
+  y += e * -2.12194440e-4f;
+  y += -0.5f * z;
+  return f + y + e * 0.693359375f;
+}
+
+// log(1 + y) for y in [0, 1]. 1 + y is rounded, and the first order
+// correction of the rounding keeps small y accurate.
+FORCE_INLINE float log1p_unit(float y) {
+  const float u = 1.f + y;
+  return log_1_to_2(u) - ((u - 1.f) - y) / u;
+}
+
+} // namespace wavefront
+
+// out[i] = lse(a[i], b[i]) for i in [0, n).
+template <typename DTYPE>
+void LseArrays(int n, const DTYPE* a, const DTYPE* b, DTYPE* out) {
+  for (int i = 0; i < n; ++i) {
+    out[i] = math::lse(a[i], b[i]);
+  }
+}
+
+template <>
+inline void LseArrays<float>(
+    int n,
+    const float* a,
+    const float* b,
+    float* out) {
+  // The clamp is a loop of its own, as GCC does not if-convert it in the
+  // polynomial loop. exp(-87) is ~1e-38, which is 0 once added to 1.
+  for (int i = 0; i < n; ++i) {
+    out[i] = std::max(std::min(a[i], b[i]) - std::max(a[i], b[i]), -87.f);
+  }
+  for (int i = 0; i < n; ++i) {
+    out[i] = std::max(a[i], b[i]) +
+        wavefront::log1p_unit(wavefront::exp_nonpositive(out[i]));
+  }
+}
+
+// Same as ComputeAlphaOneSequence, in the wavefront order.
+template <typename DTYPE, typename LOGPROBS, typename ALPHA>
+DTYPE ComputeAlphaWavefront(
+    const LOGPROBS& logProbs,
+    int T,
+    int U,
+    const ALPHA& alpha) {
+  constexpr DTYPE kNegInf = -std::numeric_limits<DTYPE>::infinity();
+  // Indexed by t: the previous and the current diagonals, and the two terms
+  // of the log-sum-exp of the current diagonal.
+  std::vector<DTYPE> buffers(4 * T);
+  DTYPE* prev = buffers.data();
+  DTYPE* cur = prev + T;
+  DTYPE* skip = cur + T;
+  DTYPE* emit = skip + T;
+
+  alpha(0, 0) = DTYPE(0);
+  cur[0] = DTYPE(0);
+  for (int k = 1; k < T + U - 1; ++k) {
+    std::swap(prev, cur);
+    const int tBegin = std::max(0, k - (U - 1));
+    const int tEnd = std::min(k, T - 1) + 1;
+    for (int t = tBegin; t < tEnd; ++t) {
+      const int u = k - t;
+      // From (t - 1, u) with blank, and from (t, u - 1) with the target.
+      skip[t] = t > 0 ? prev[t - 1] + logProbs(t - 1, u).skip() : kNegInf;
+      emit[t] = u > 0 ? prev[t] + logProbs(t, u - 1).emit() : kNegInf;
+    }
+    LseArrays<DTYPE>(tEnd - tBegin, skip + tBegin, emit + tBegin, cur + tBegin);
+    for (int t = tBegin; t < tEnd; ++t) {
+      alpha(t, k - t) = cur[t];
+    }
+  }
+
+  return alpha(T - 1, U - 1) + logProbs(T - 1, U - 1).skip();
+}
+
+// Same as ComputeBetaOneSequence, in the wavefront order.
+template <typename DTYPE, typename LOGPROBS, typename BETA>
+DTYPE ComputeBetaWavefront(
+    const LOGPROBS& logProbs,
+    int T,
+    int U,
+    const BETA& beta) {
+  constexpr DTYPE kNegInf = -std::numeric_limits<DTYPE>::infinity();
+  std::vector<DTYPE> buffers(4 * T);
+  DTYPE* prev = buffers.data();
+  DTYPE* cur = prev + T;
+  DTYPE* skip = cur + T;
+  DTYPE* emit = skip + T;
+
+  beta(T - 1, U - 1) = logProbs(T - 1, U - 1).skip();
+  cur[T - 1] = beta(T - 1, U - 1);
+  for (int k = T + U - 3; k >= 0; --k) {
+    std::swap(prev, cur);
+    const int tBegin = std::max(0, k - (U - 1));
+    const int tEnd = std::min(k, T - 1) + 1;
+    for (int t = tBegin; t < tEnd; ++t) {
+      const int u = k - t;
+      // To (t + 1, u) with blank, and to (t, u + 1) with the target.
+      skip[t] = t < T - 1 ? prev[t + 1] + logProbs(t, u).skip() : kNegInf;
+      emit[t] = u < U - 1 ? prev[t] + logProbs(t, u).emit() : kNegInf;
+    }
+    LseArrays<DTYPE>(tEnd - tBegin, skip + tBegin, emit + tBegin, cur + tBegin);
+    for (int t = tBegin; t < tEnd; ++t) {
+      beta(t, k - t) = cur[t];
+    }
+  }
+
+  return beta(0, 0);
+}
+
+} // namespace cpu
+} // namespace rnnt
+} // namespace torchaudio
@@ -1,10 +1,39 @@
 #include <c10/cuda/CUDAStream.h>
 #include <torch/script.h>
 #include <torchaudio/csrc/rnnt/gpu/gpu_transducer.h>
+#include <torchaudio/csrc/rnnt/workspace_cache.h>
 
 namespace torchaudio {
 namespace rnnt {
 namespace gpu {
+namespace {
+
+// Device-side assertions that the lengths fit the shapes of the logits (maxT,
+// maxU) and of the targets (maxU - 1), and, for the packed layout (offsets is
+// not nullptr), that the sequences have numRows rows. Unlike the checks of the
+// lengths on the host, they do not wait for the lengths to be computed.
+__global__ void CheckLengths(
+    int batchSize,
+    int maxSrcLen,
+    int maxTgtLen,
+    const int* srcLengths,
+    const int* tgtLengths,
+    const int* offsets,
+    int numRows) {
+  const int b = blockIdx.x * blockDim.x + threadIdx.x;
+  if (b >= batchSize) {
+    return;
+  }
+  const int T = srcLengths[b];
+  const int U = tgtLengths[b] + 1;
+  CUDA_KERNEL_ASSERT(T >= 0 && T <= maxSrcLen);
+  CUDA_KERNEL_ASSERT(U >= 1 && U <= maxTgtLen);
+  if (offsets != nullptr && b == batchSize - 1) {
+    CUDA_KERNEL_ASSERT(offsets[b] + T * U == numRows);
+  }
+}
+
+} // namespace
 
 // Entry point into RNNT Loss
 std::tuple<torch::Tensor, c10::optional<torch::Tensor>> compute(
@@ -13,7 +42,10 @@ std::tuple<torch::Tensor, c10::optional<torch::Tensor>> compute(
     const torch::Tensor& logit_lengths,
     const torch::Tensor& target_lengths,
     int64_t blank,
-    double clamp) {
+    double clamp,
+    bool reuse_logits_for_grads,
+    bool check_lengths,
+    const std::string& alphas_betas_kernel) {
   TORCH_CHECK(
       logits.device().type() == targets.device().type(),
       "logits and targets must be on the same device");
@@ -42,74 +74,117 @@ std::tuple<torch::Tensor, c10::optional<torch::Tensor>> compute(
   TORCH_CHECK(
       target_lengths.is_contiguous(), "target_lengths must be contiguous");
 
+  // Packed logits are the (T_b, U_b, class) blocks of the sequences, with
+  // U_b = target_lengths[b] + 1, concatenated into (sum_b T_b * U_b, class).
+  const bool packed = logits.dim() == 2;
   TORCH_CHECK(
-      logits.dim() == 4, "logits must be 4-D (batch, time, target, class)");
+      logits.dim() == 4 || packed,
+      "logits must be 4-D (batch, time, target, class) or 2-D (row, class)");
   TORCH_CHECK(
       targets.dim() == 2, "targets must be 2-D (batch, max target length)");
   TORCH_CHECK(logit_lengths.dim() == 1, "logit_lengths must be 1-D");
   TORCH_CHECK(target_lengths.dim() == 1, "target_lengths must be 1-D");
 
+  const int64_t batch_size = packed ? logit_lengths.size(0) : logits.size(0);
   TORCH_CHECK(
-      logit_lengths.size(0) == logits.size(0),
+      logit_lengths.size(0) == batch_size,
       "batch dimension mismatch between logits and logit_lengths");
   TORCH_CHECK(
-      target_lengths.size(0) == logits.size(0),
+      target_lengths.size(0) == batch_size,
       "batch dimension mismatch between logits and target_lengths");
   TORCH_CHECK(
-      targets.size(0) == logits.size(0),
+      targets.size(0) == batch_size,
       "batch dimension mismatch between logits and targets");
 
   TORCH_CHECK(
       blank >= 0 && blank < logits.size(-1),
       "blank must be within [0, logits.shape[-1])");
 
-  TORCH_CHECK(
-      logits.size(1) == at::max(logit_lengths).item().toInt(),
-      "input length mismatch");
-  TORCH_CHECK(
-      logits.size(2) == at::max(target_lengths).item().toInt() + 1,
-      "output length mismatch");
-  TORCH_CHECK(
-      targets.size(1) == at::max(target_lengths).item().toInt(),
-      "target length mismatch");
+  // Reading the lengths waits for the kernels which compute them. Without
+  // check_lengths, they are only checked against the shapes in CheckLengths,
+  // on the device, and the call does not synchronize, except for packed
+  // logits, whose maximum input length sizes the grids.
+  int max_src_length = packed ? 0 : logits.size(1);
+  if (check_lengths || packed) {
+    max_src_length = at::max(logit_lengths).item().toInt();
+  }
+  if (check_lengths) {
+    TORCH_CHECK(
+        packed || logits.size(1) == max_src_length, "input length mismatch");
+    TORCH_CHECK(
+        packed ||
+            logits.size(2) == at::max(target_lengths).item().toInt() + 1,
+        "output length mismatch");
+    TORCH_CHECK(
+        targets.size(1) == at::max(target_lengths).item().toInt(),
+        "target length mismatch");
+  } else {
+    TORCH_CHECK(
+        packed || logits.size(2) == targets.size(1) + 1,
+        "output length mismatch");
+  }
 
   Options options;
   options.batchSize_ = logit_lengths.size(0);
   options.nHypos_ = target_lengths.size(0) / logit_lengths.size(0);
-  options.maxSrcLen_ = logits.size(1);
-  options.maxTgtLen_ = logits.size(2);
-  options.numTargets_ = logits.size(3);
+  options.maxSrcLen_ = packed ? max_src_length : logits.size(1);
+  options.maxTgtLen_ = packed ? targets.size(1) + 1 : logits.size(2);
+  options.numTargets_ = logits.size(-1);
   options.blank_ = blank;
   options.clamp_ = clamp;
 
+  // The first row of each sequence, for the packed layout.
+  torch::Tensor offsets;
+  if (packed) {
+    const torch::Tensor rows = logit_lengths.to(torch::kInt64) *
+        (target_lengths.to(torch::kInt64) + 1);
+    TORCH_CHECK(
+        !check_lengths || logits.size(0) == rows.sum().item().toLong(),
+        "packed logits must have sum(logit_lengths * (target_lengths + 1)) "
+        "rows");
+    offsets = (rows.cumsum(0) - rows).to(torch::kInt32);
+    options.packedOffsets_ = offsets.data_ptr<int>();
+    options.packedRows_ = logits.size(0);
+  }
+
   CHECK_EQ(logits.device().type(), torch::DeviceType::CUDA);
   options.stream_ = at::cuda::getCurrentCUDAStream();
   cudaSetDevice(logits.get_device());
   options.device_ = GPU;
+  options.diagonalAlphasBetas_ =
+      UseDiagonalAlphasBetas</*CAST_DTYPE=*/float>(
+          ParseAlphasBetasKernel(alphas_betas_kernel), options.maxTgtLen_);
+
+  if (!check_lengths && options.batchSize_ > 0) {
+    const int batch = options.batchSize_;
+    CheckLengths<<<
+        (batch + MAX_THREADS_PER_BLOCK - 1) / MAX_THREADS_PER_BLOCK,
+        MAX_THREADS_PER_BLOCK,
+        0,
+        options.stream_>>>(
+        /*batchSize=*/batch,
+        /*maxSrcLen=*/options.maxSrcLen_,
+        /*maxTgtLen=*/options.maxTgtLen_,
+        /*srcLengths=*/logit_lengths.data_ptr<int>(),
+        /*tgtLengths=*/target_lengths.data_ptr<int>(),
+        /*offsets=*/options.packedOffsets_,
+        /*numRows=*/options.packedRows_);
+    TORCH_CHECK(
+        cudaGetLastError() == cudaSuccess,
+        "failed to launch the check of the lengths");
+  }
 
   torch::Tensor costs = torch::empty(
       options.batchSize_ * options.nHypos_,
       torch::TensorOptions().device(logits.device()).dtype(logits.dtype()));
-  c10::optional<torch::Tensor> gradients = torch::zeros_like(logits);
-
-  torch::Tensor int_workspace = torch::empty(
-      IntWorkspace::ComputeSizeFromOptions(options),
-      torch::TensorOptions()
-          .device(logits.device())
-          .dtype(torch::ScalarType::Int));
-
-  torch::Tensor float_workspace = torch::empty(
-      DtypeWorkspace<float>::ComputeSizeFromOptions(options),
-      torch::TensorOptions()
-          .device(logits.device())
-          .dtype(torch::ScalarType::Float));
-
-  Workspace<float> workspace(
-      /*options=*/options,
-      /*dtype_data=*/float_workspace.data_ptr<float>(),
-      /*dtype_size=*/float_workspace.numel(),
-      /*int_data=*/int_workspace.data_ptr<int>(),
-      /*int_size=*/int_workspace.numel());
+  // The kernels write the gradients over the logits they have read, and zero
+  // the padding. All the rows of packed logits are written.
+  c10::optional<torch::Tensor> gradients = reuse_logits_for_grads
+      ? logits
+      : (packed ? torch::empty_like(logits) : torch::zeros_like(logits));
+
+  CachedWorkspace cached_workspace(options, logits.device());
+  const Workspace<float>& workspace = cached_workspace.get();
 
   switch (logits.scalar_type()) {
     case torch::ScalarType::Float: {
@@ -0,0 +1,397 @@
+#include <c10/cuda/CUDAException.h>
+#include <c10/cuda/CUDAStream.h>
+#include <torch/script.h>
+#include <torchaudio/csrc/rnnt/gpu/gpu_transducer.h>
+#include <torchaudio/csrc/rnnt/pruned_kernels.h>
+
+namespace torchaudio {
+namespace rnnt {
+namespace gpu {
+namespace {
+
+constexpr int kThreads = 256;
+
+int NumBlocks(int64_t n) {
+  return static_cast<int>((n + kThreads - 1) / kThreads);
+}
+
+// One thread per cell (t, s) of the bands, and one grid row per sequence.
+template <typename DTYPE>
+__global__ void ComputePrunedLogProbs(
+    int maxT,
+    int S,
+    int D,
+    int maxTgtLen,
+    int blank,
+    const DTYPE* logits,
+    const int* targets,
+    const int* srcLengths,
+    const int* tgtLengths,
+    const int* ranges,
+    const float* denominators,
+    float* logProbs) {
+  const int64_t TS = static_cast<int64_t>(maxT) * S;
+  const int64_t cell = static_cast<int64_t>(blockIdx.x) * blockDim.x +
+      threadIdx.x; // t * S + s
+  const int b = blockIdx.y;
+  if (cell >= TS) {
+    return;
+  }
+  const int t = cell / S;
+  const int u = ranges[b * maxT + t] + cell % S;
+  const int U = tgtLengths[b] + 1;
+  if (t >= srcLengths[b]) {
+    return;
+  }
+  const int64_t idx = b * TS + cell;
+  if (u < 0 || u >= U) {
+    logProbs[(idx << 1) + pruned::kSkip] = pruned::NegInf();
+    logProbs[(idx << 1) + pruned::kEmit] = pruned::NegInf();
+    return;
+  }
+  const DTYPE* row = logits + idx * D;
+  logProbs[(idx << 1) + pruned::kSkip] =
+      float(row[blank]) - denominators[idx];
+  if (u < U - 1) {
+    logProbs[(idx << 1) + pruned::kEmit] =
+        float(row[targets[b * maxTgtLen + u]]) - denominators[idx];
+  }
+}
+
+// One thread per sequence and direction: the bands are only a few symbols
+// wide, so the parallelism is over the batch.
+__global__ void ComputePrunedAlphasBetas(
+    int batchSize,
+    int maxT,
+    int S,
+    const float* logProbs,
+    const int* ranges,
+    const int* srcLengths,
+    const int* tgtLengths,
+    float* alphas,
+    float* betas,
+    float* scores) {
+  const int i = blockIdx.x * blockDim.x + threadIdx.x;
+  if (i >= (batchSize << 1)) {
+    return;
+  }
+  const int b = i >> 1;
+  const int64_t TS = static_cast<int64_t>(maxT) * S;
+  if (i & 1) {
+    scores[i] = pruned::ComputeAlphaOneSequence(
+        logProbs + 2 * b * TS,
+        ranges + b * maxT,
+        srcLengths[b],
+        tgtLengths[b] + 1,
+        S,
+        alphas + b * TS);
+  } else {
+    scores[i] = pruned::ComputeBetaOneSequence(
+        logProbs + 2 * b * TS,
+        ranges + b * maxT,
+        srcLengths[b],
+        tgtLengths[b] + 1,
+        S,
+        betas + b * TS);
+  }
+}
+
+// One thread per element (b, t, s, d) of the gradients.
+template <typename DTYPE>
+__global__ void ComputePrunedGradients(
+    int batchSize,
+    int maxT,
+    int S,
+    int D,
+    int maxTgtLen,
+    int blank,
+    float clamp,
+    const DTYPE* logits,
+    const int* targets,
+    const int* srcLengths,
+    const int* tgtLengths,
+    const int* ranges,
+    const float* denominators,
+    const float* alphas,
+    const float* betas,
+    const float* scores,
+    DTYPE* gradients) {
+  const int64_t TS = static_cast<int64_t>(maxT) * S;
+  const int64_t n = batchSize * TS * D;
+  for (int64_t idx = static_cast<int64_t>(blockIdx.x) * blockDim.x +
+           threadIdx.x;
+       idx < n;
+       idx += static_cast<int64_t>(gridDim.x) * blockDim.x) {
+    const int64_t cell = idx / D;
+    const int d = idx % D;
+    const int b = cell / TS;
+    const int t = (cell / S) % maxT;
+    const int s = cell % S;
+    const int U = tgtLengths[b] + 1;
+    const int u = ranges[b * maxT + t] + s;
+    const int target =
+        u >= 0 && u < U - 1 ? targets[b * maxTgtLen + u] : -1;
+    gradients[idx] = pruned::ComputeGradient(
+        /*logit=*/float(logits[idx]),
+        /*d=*/d,
+        /*t=*/t,
+        /*s=*/s,
+        /*T=*/srcLengths[b],
+        /*U=*/U,
+        /*S=*/S,
+        /*blank=*/blank,
+        /*target=*/target,
+        /*clamp=*/clamp,
+        /*cost=*/-scores[b << 1],
+        /*ranges=*/ranges + b * maxT,
+        /*denom=*/denominators + b * TS,
+        /*alpha=*/alphas + b * TS,
+        /*beta=*/betas + b * TS);
+  }
+}
+
+template <typename DTYPE>
+void ComputePruned(
+    const Options& options,
+    int maxTgtLen,
+    const DTYPE* logits,
+    const int* targets,
+    const int* srcLengths,
+    const int* tgtLengths,
+    const int* ranges,
+    float* denominators,
+    float* logProbs,
+    float* alphas,
+    float* betas,
+    float* scores,
+    DTYPE* gradients) {
+  const int& B = options.batchSize_;
+  const int& maxT = options.maxSrcLen_;
+  const int& S = options.maxTgtLen_;
+  const int& D = options.numTargets_;
+  const cudaStream_t& stream = options.stream_;
+  const int64_t TS = static_cast<int64_t>(maxT) * S;
+
+  LogSumExp2D<DTYPE, float>(
+      /*stream=*/stream,
+      /*N=*/B * TS,
+      /*D=*/D,
+      /*logits=*/logits,
+      /*outputs=*/denominators);
+  C10_CUDA_KERNEL_LAUNCH_CHECK();
+
+  ComputePrunedLogProbs<DTYPE>
+      <<<dim3(NumBlocks(TS), B), kThreads, 0, stream>>>(
+          maxT,
+          S,
+          D,
+          maxTgtLen,
+          options.blank_,
+          logits,
+          targets,
+          srcLengths,
+          tgtLengths,
+          ranges,
+          denominators,
+          logProbs);
+  C10_CUDA_KERNEL_LAUNCH_CHECK();
+
+  ComputePrunedAlphasBetas<<<NumBlocks(B << 1), kThreads, 0, stream>>>(
+      B,
+      maxT,
+      S,
+      logProbs,
+      ranges,
+      srcLengths,
+      tgtLengths,
+      alphas,
+      betas,
+      scores);
+  C10_CUDA_KERNEL_LAUNCH_CHECK();
+
+  if (gradients == nullptr) {
+    return;
+  }
+  // Grid-stride loop, over at most 64k blocks.
+  const int numBlocks = std::min(NumBlocks(B * TS * D), 1 << 16);
+  ComputePrunedGradients<DTYPE><<<numBlocks, kThreads, 0, stream>>>(
+      B,
+      maxT,
+      S,
+      D,
+      maxTgtLen,
+      options.blank_,
+      options.clamp_,
+      logits,
+      targets,
+      srcLengths,
+      tgtLengths,
+      ranges,
+      denominators,
+      alphas,
+      betas,
+      scores,
+      gradients);
+  C10_CUDA_KERNEL_LAUNCH_CHECK();
+}
+
+} // namespace
+
+// Entry point into the pruned RNNT Loss
+std::tuple<torch::Tensor, c10::optional<torch::Tensor>> compute_pruned(
+    torch::Tensor& logits,
+    const torch::Tensor& targets,
+    const torch::Tensor& logit_lengths,
+    const torch::Tensor& target_lengths,
+    const torch::Tensor& ranges,
+    int64_t blank,
+    double clamp) {
+  TORCH_CHECK(
+      logits.device().type() == targets.device().type(),
+      "logits and targets must be on the same device");
+  TORCH_CHECK(
+      logits.device().type() == logit_lengths.device().type(),
+      "logits and logit_lengths must be on the same device");
+  TORCH_CHECK(
+      logits.device().type() == target_lengths.device().type(),
+      "logits and target_lengths must be on the same device");
+  TORCH_CHECK(
+      logits.device().type() == ranges.device().type(),
+      "logits and ranges must be on the same device");
+
+  TORCH_CHECK(
+      logits.dtype() == torch::kFloat32 || logits.dtype() == torch::kFloat16,
+      "logits must be float32 or float16 (half) type");
+  TORCH_CHECK(targets.dtype() == torch::kInt32, "targets must be int32 type");
+  TORCH_CHECK(
+      logit_lengths.dtype() == torch::kInt32,
+      "logit_lengths must be int32 type");
+  TORCH_CHECK(
+      target_lengths.dtype() == torch::kInt32,
+      "target_lengths must be int32 type");
+  TORCH_CHECK(ranges.dtype() == torch::kInt32, "ranges must be int32 type");
+
+  TORCH_CHECK(logits.is_contiguous(), "logits must be contiguous");
+  TORCH_CHECK(targets.is_contiguous(), "targets must be contiguous");
+  TORCH_CHECK(
+      logit_lengths.is_contiguous(), "logit_lengths must be contiguous");
+  TORCH_CHECK(
+      target_lengths.is_contiguous(), "target_lengths must be contiguous");
+  TORCH_CHECK(ranges.is_contiguous(), "ranges must be contiguous");
+
+  TORCH_CHECK(
+      logits.dim() == 4, "logits must be 4-D (batch, time, range, class)");
+  TORCH_CHECK(
+      targets.dim() == 2, "targets must be 2-D (batch, max target length)");
+  TORCH_CHECK(logit_lengths.dim() == 1, "logit_lengths must be 1-D");
+  TORCH_CHECK(target_lengths.dim() == 1, "target_lengths must be 1-D");
+  TORCH_CHECK(ranges.dim() == 2, "ranges must be 2-D (batch, time)");
+
+  TORCH_CHECK(
+      logit_lengths.size(0) == logits.size(0),
+      "batch dimension mismatch between logits and logit_lengths");
+  TORCH_CHECK(
+      target_lengths.size(0) == logits.size(0),
+      "batch dimension mismatch between logits and target_lengths");
+  TORCH_CHECK(
+      targets.size(0) == logits.size(0),
+      "batch dimension mismatch between logits and targets");
+  TORCH_CHECK(
+      ranges.size(0) == logits.size(0) && ranges.size(1) == logits.size(1),
+      "(batch, time) dimension mismatch between logits and ranges");
+
+  TORCH_CHECK(
+      blank >= 0 && blank < logits.size(-1),
+      "blank must be within [0, logits.shape[-1])");
+
+  TORCH_CHECK(
+      logits.size(1) == at::max(logit_lengths).item().toInt(),
+      "input length mismatch");
+  TORCH_CHECK(
+      targets.size(1) == at::max(target_lengths).item().toInt(),
+      "target length mismatch");
+  TORCH_CHECK(
+      logits.size(2) >= 1 && logits.size(2) <= targets.size(1) + 1,
+      "range must be within [1, max target length + 1]");
+
+  Options options;
+  options.batchSize_ = logit_lengths.size(0);
+  options.maxSrcLen_ = logits.size(1);
+  // The band takes the place of the target dimension.
+  options.maxTgtLen_ = logits.size(2);
+  options.numTargets_ = logits.size(3);
+  options.blank_ = blank;
+  options.clamp_ = clamp;
+
+  CHECK_EQ(logits.device().type(), torch::DeviceType::CUDA);
+  options.stream_ = at::cuda::getCurrentCUDAStream();
+  cudaSetDevice(logits.get_device());
+  options.device_ = GPU;
+
+  c10::optional<torch::Tensor> gradients = torch::zeros_like(logits);
+
+  const auto float_options = torch::TensorOptions()
+                                 .device(logits.device())
+                                 .dtype(torch::ScalarType::Float);
+  torch::Tensor denominators = torch::empty(
+      {options.batchSize_, options.maxSrcLen_, options.maxTgtLen_},
+      float_options);
+  torch::Tensor log_probs = torch::empty(
+      {options.batchSize_, options.maxSrcLen_, options.maxTgtLen_, 2},
+      float_options);
+  torch::Tensor alphas = torch::empty_like(denominators);
+  torch::Tensor betas = torch::empty_like(denominators);
+  // The beta and the alpha scores of each sequence.
+  torch::Tensor scores = torch::empty({options.batchSize_, 2}, float_options);
+
+  switch (logits.scalar_type()) {
+    case torch::ScalarType::Float: {
+      ComputePruned<float>(
+          /*options=*/options,
+          /*maxTgtLen=*/targets.size(1),
+          /*logits=*/logits.data_ptr<float>(),
+          /*targets=*/targets.data_ptr<int>(),
+          /*srcLengths=*/logit_lengths.data_ptr<int>(),
+          /*tgtLengths=*/target_lengths.data_ptr<int>(),
+          /*ranges=*/ranges.data_ptr<int>(),
+          /*denominators=*/denominators.data_ptr<float>(),
+          /*logProbs=*/log_probs.data_ptr<float>(),
+          /*alphas=*/alphas.data_ptr<float>(),
+          /*betas=*/betas.data_ptr<float>(),
+          /*scores=*/scores.data_ptr<float>(),
+          /*gradients=*/gradients->data_ptr<float>());
+      break;
+    }
+    case torch::ScalarType::Half: {
+      ComputePruned<c10::Half>(
+          /*options=*/options,
+          /*maxTgtLen=*/targets.size(1),
+          /*logits=*/logits.data_ptr<c10::Half>(),
+          /*targets=*/targets.data_ptr<int>(),
+          /*srcLengths=*/logit_lengths.data_ptr<int>(),
+          /*tgtLengths=*/target_lengths.data_ptr<int>(),
+          /*ranges=*/ranges.data_ptr<int>(),
+          /*denominators=*/denominators.data_ptr<float>(),
+          /*logProbs=*/log_probs.data_ptr<float>(),
+          /*alphas=*/alphas.data_ptr<float>(),
+          /*betas=*/betas.data_ptr<float>(),
+          /*scores=*/scores.data_ptr<float>(),
+          /*gradients=*/gradients->data_ptr<c10::Half>());
+      break;
+    }
+    default: {
+      break;
+    }
+  };
+
+  torch::Tensor costs = scores.select(1, 0).neg().to(logits.dtype());
+  return std::make_tuple(costs, gradients);
+}
+
+TORCH_LIBRARY_IMPL(torchaudio, CUDA, m) {
+  m.impl("rnnt_loss_pruned", &compute_pruned);
+}
+
+} // namespace gpu
+} // namespace rnnt
+} // namespace torchaudio
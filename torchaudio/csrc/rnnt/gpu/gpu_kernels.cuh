@@ -11,49 +11,132 @@
 namespace torchaudio {
 namespace rnnt {
 
-template <typename DTYPE, typename CAST_DTYPE>
-__global__ void ComputeLogProbs(
+// Rows of the lattices per block of ComputeDenominatorsAndLogProbs, one per
+// warp.
+constexpr int kLogProbsRowsPerBlock = 8;
+
+// N elements loaded with a single instruction, e.g. as a float4.
+template <typename DTYPE, int N>
+struct alignas(sizeof(DTYPE) * N) Vector {
+  DTYPE val[N];
+};
+
+// Adds the terms of (max2, sum2) to (max, sum), where the log-sum-exp of the
+// terms is max + log(sum). sum is 0 for no term.
+template <typename DTYPE>
+FORCE_INLINE __device__ void
+MergeLogSumExp(DTYPE& max, DTYPE& sum, DTYPE max2, DTYPE sum2) {
+  if (sum2 == 0) {
+    return;
+  }
+  if (sum == 0) {
+    max = max2;
+    sum = sum2;
+    return;
+  }
+  const DTYPE newMax = math::max(max, max2);
+  sum = sum * std::exp(max - newMax) + sum2 * std::exp(max2 - newMax);
+  max = newMax;
+}
+
+// Computes the denominator of the softmax and the log probabilities (blank
+// and target) of each row of the lattices in one pass over the logits. A warp
+// reduces a row, with an online log-sum-exp over loads of VEC elements (D must
+// be a multiple of VEC), and the rows of the padding are skipped.
+//
+// The blocks are (WARP_SIZE, kLogProbsRowsPerBlock) threads over numRows rows.
+template <typename DTYPE, typename CAST_DTYPE, int VEC>
+__global__ void ComputeDenominatorsAndLogProbs(
+    int numRows,
     int maxSrcLen,
     int maxTgtLen,
     int numTargets,
     int blank,
+    int batchSize,
     const DTYPE* logits,
     const int* targets,
     const int* srcLengths,
     const int* tgtLengths,
-    const CAST_DTYPE* denominators,
+    const int* offsets,
+    CAST_DTYPE* denominators,
     CAST_DTYPE* logProbs,
     int H = 1) {
   const int& maxT = maxSrcLen;
   const int& maxU = maxTgtLen;
   const int& D = numTargets;
 
-  const int bTgt = blockIdx.z; // 0 <= b < B
-  const int bSrc = bTgt / H;
-  const int T = srcLengths[bSrc];
-  const int U = tgtLengths[bTgt] + 1;
-
-  const int t = blockIdx.x * blockDim.x + threadIdx.x;
-  const int u = blockIdx.y;
-
-  if (t >= T || u >= U) { // out of boundary.
+  const int row = blockIdx.x * blockDim.y + threadIdx.y;
+  if (row >= numRows) {
     return;
   }
 
-  Indexer3D indexer(maxT, maxU);
+  // (bTgt, t, u) of the row.
+  int bTgt, t, u;
+  if (offsets == nullptr) {
+    u = row % maxU;
+    t = (row / maxU) % maxT;
+    bTgt = row / (maxU * maxT);
+  } else { // the last sequence starting at or before the row.
+    int lo = 0;
+    int hi = batchSize - 1;
+    while (lo < hi) {
+      const int mid = (lo + hi + 1) >> 1;
+      if (offsets[mid] <= row) {
+        lo = mid;
+      } else {
+        hi = mid - 1;
+      }
+    }
+    bTgt = lo;
+    const int rowU = tgtLengths[bTgt] + 1;
+    t = (row - offsets[bTgt]) / rowU;
+    u = (row - offsets[bTgt]) % rowU;
+  }
+  const int T = srcLengths[bTgt / H];
+  const int U = tgtLengths[bTgt] + 1;
+  // The whole warp returns, so the shuffles below have all their lanes.
+  if (t >= T || u >= U) { // padding.
+    return;
+  }
 
-  int idx = indexer(bTgt, t, u);
+  const DTYPE* rowLogits = logits + static_cast<int64_t>(row) * D;
+  CAST_DTYPE max = 0;
+  CAST_DTYPE sum = 0;
+  for (int d = threadIdx.x * VEC; d < D; d += WARP_SIZE * VEC) {
+    const auto v = *reinterpret_cast<const Vector<DTYPE, VEC>*>(rowLogits + d);
+    CAST_DTYPE vMax = CAST_DTYPE(v.val[0]);
+#pragma unroll
+    for (int i = 1; i < VEC; ++i) {
+      vMax = math::max(vMax, CAST_DTYPE(v.val[i]));
+    }
+    CAST_DTYPE vSum = 0;
+#pragma unroll
+    for (int i = 0; i < VEC; ++i) {
+      vSum = vSum + std::exp(CAST_DTYPE(v.val[i]) - vMax);
+    }
+    MergeLogSumExp(max, sum, vMax, vSum);
+  }
 
-  // skip: log_prob(b, t, u).skip() = logits(b, t, u, blank) - denom(b, t, u).
-  logProbs[(idx << 1) + LOG_PROBS_SKIP_IDX] =
-      CAST_DTYPE(logits[idx * D + blank]) - denominators[idx];
+#pragma unroll
+  for (int stride = (WARP_SIZE >> 1); stride > 0; stride >>= 1) {
+    const CAST_DTYPE max2 = __shfl_xor_sync(0xFFFFFFFF, max, stride);
+    const CAST_DTYPE sum2 = __shfl_xor_sync(0xFFFFFFFF, sum, stride);
+    MergeLogSumExp(max, sum, max2, sum2);
+  }
 
-  if (u < U - 1) {
-    // emit: log_prob(b, t, u).emit() = logits(b, t, u, tgt[u]) - denom(b, t,
-    // u).
-    int target = targets[Indexer2D(maxU - 1)(bTgt, u)];
-    logProbs[(idx << 1) + LOG_PROBS_EMIT_IDX] =
-        CAST_DTYPE(logits[idx * D + target]) - denominators[idx];
+  if (threadIdx.x == 0) {
+    const CAST_DTYPE denom = max + std::log(sum);
+    denominators[row] = denom;
+    // skip: log_prob(b, t, u).skip() = logits(b, t, u, blank) - denom(b, t, u).
+    logProbs[(row << 1) + LOG_PROBS_SKIP_IDX] =
+        CAST_DTYPE(rowLogits[blank]) - denom;
+    if (u < U - 1) {
+      // emit: log_prob(b, t, u).emit() = logits(b, t, u, tgt[u]) - denom(b,
+      // t, u).
+      const int target = targets[Indexer2D(maxU - 1)(bTgt, u)];
+      logProbs[(row << 1) + LOG_PROBS_EMIT_IDX] =
+          CAST_DTYPE(rowLogits[target]) - denom;
+    }
   }
 }
 
@@ -66,6 +149,7 @@ __device__ void ComputeAlphas(
     const CAST_DTYPE* logProbs,
     const int* srcLengths,
     const int* tgtLengths,
+    const int* offsets,
     int* alpha_counters,
     volatile CAST_DTYPE* alphas,
     int H = 1) {
@@ -86,10 +170,10 @@ __device__ void ComputeAlphas(
 
   int* counter = alpha_counters + Indexer2D(maxU)(bTgt, blockIdx.y);
 
-  Indexer3D idxr(maxT, maxU);
+  LatticeIndexer idxr(offsets, bTgt, maxT, maxU, U);
 
   if (t == 1 && u == 1) {
-    alphas[idxr(bTgt, 0, 0)] = 0;
+    alphas[idxr(0, 0)] = 0;
   }
 
   if (blockIdx.x > 0) { // wait for previous warp (in t-axis) is ready.
@@ -104,13 +188,13 @@ __device__ void ComputeAlphas(
 
   if (t == 1 && u < U) {
     // alpha(0, u) = alpha(0, u - 1) + logProbs(0, u - 1).emit().
-    alphas[idxr(bTgt, 0, u)] = alphas[idxr(bTgt, 0, u - 1)] +
-        logProbs[(idxr(bTgt, 0, u - 1) << 1) + LOG_PROBS_EMIT_IDX];
+    alphas[idxr(0, u)] = alphas[idxr(0, u - 1)] +
+        logProbs[(idxr(0, u - 1) << 1) + LOG_PROBS_EMIT_IDX];
   }
 
   if (blockIdx.y == 0 && t < T) {
     CAST_DTYPE skip_prob =
-        logProbs[(idxr(bTgt, t - 1, 0) << 1) + LOG_PROBS_SKIP_IDX];
+        logProbs[(idxr(t - 1, 0) << 1) + LOG_PROBS_SKIP_IDX];
     CAST_DTYPE val;
 
 #pragma unroll
@@ -121,19 +205,19 @@ __device__ void ComputeAlphas(
       }
     }
 
-    val = alphas[idxr(bTgt, blockIdx.x * blockDim.x, 0)];
-    alphas[idxr(bTgt, t, 0)] = skip_prob + val;
+    val = alphas[idxr(blockIdx.x * blockDim.x, 0)];
+    alphas[idxr(t, 0)] = skip_prob + val;
   }
 
   if (t < T && u < U) {
     CAST_DTYPE skip_prob =
-        logProbs[(idxr(bTgt, t - 1, u) << 1) + LOG_PROBS_SKIP_IDX];
+        logProbs[(idxr(t - 1, u) << 1) + LOG_PROBS_SKIP_IDX];
     CAST_DTYPE emit_prob =
-        logProbs[(idxr(bTgt, t, u - 1) << 1) + LOG_PROBS_EMIT_IDX];
+        logProbs[(idxr(t, u - 1) << 1) + LOG_PROBS_EMIT_IDX];
 
     CAST_DTYPE skip =
-        alphas[idxr(bTgt, blockIdx.x * blockDim.x, u)] + skip_prob;
-    CAST_DTYPE emit = alphas[idxr(bTgt, t, u - 1)] + emit_prob;
+        alphas[idxr(blockIdx.x * blockDim.x, u)] + skip_prob;
+    CAST_DTYPE emit = alphas[idxr(t, u - 1)] + emit_prob;
 
     CAST_DTYPE val = math::lse(skip, emit);
     CAST_DTYPE out = val;
@@ -146,7 +230,7 @@ __device__ void ComputeAlphas(
       }
     }
 
-    alphas[idxr(bTgt, t, u)] = out;
+    alphas[idxr(t, u)] = out;
   }
 
   if (threadIdx.x == 0) {
@@ -164,6 +248,7 @@ __device__ void ComputeBetasCosts(
     const CAST_DTYPE* logProbs,
     const int* srcLengths,
     const int* tgtLengths,
+    const int* offsets,
     int* betaCounters,
     volatile CAST_DTYPE* betas,
     DTYPE* costs,
@@ -185,11 +270,11 @@ __device__ void ComputeBetasCosts(
 
   int* counter = betaCounters + Indexer2D(maxU)(bTgt, blockIdx.y);
 
-  Indexer3D idxr(maxT, maxU);
+  LatticeIndexer idxr(offsets, bTgt, maxT, maxU, U);
 
   if (t == T - 2 && u == U - 2) {
-    betas[idxr(bTgt, T - 1, U - 1)] =
-        logProbs[(idxr(bTgt, T - 1, U - 1) << 1) + LOG_PROBS_SKIP_IDX];
+    betas[idxr(T - 1, U - 1)] =
+        logProbs[(idxr(T - 1, U - 1) << 1) + LOG_PROBS_SKIP_IDX];
   }
 
   if (blockIdx.x > 0) { // wait for previous warp (in t-axis) is ready.
@@ -203,13 +288,13 @@ __device__ void ComputeBetasCosts(
   }
 
   if (t == T - 2 && u >= 0) {
-    betas[idxr(bTgt, T - 1, u)] = betas[idxr(bTgt, T - 1, u + 1)] +
-        logProbs[(idxr(bTgt, T - 1, u) << 1) + LOG_PROBS_EMIT_IDX];
+    betas[idxr(T - 1, u)] = betas[idxr(T - 1, u + 1)] +
+        logProbs[(idxr(T - 1, u) << 1) + LOG_PROBS_EMIT_IDX];
   }
 
   if (blockIdx.y == 0 && t >= 0) {
     CAST_DTYPE skip_prob =
-        logProbs[(idxr(bTgt, t, U - 1) << 1) + LOG_PROBS_SKIP_IDX];
+        logProbs[(idxr(t, U - 1) << 1) + LOG_PROBS_SKIP_IDX];
     CAST_DTYPE val;
 
 #pragma unroll
@@ -220,18 +305,18 @@ __device__ void ComputeBetasCosts(
       }
     }
 
-    betas[idxr(bTgt, t, U - 1)] =
-        betas[idxr(bTgt, T - 1 - blockIdx.x * blockDim.x, U - 1)] + skip_prob;
+    betas[idxr(t, U - 1)] =
+        betas[idxr(T - 1 - blockIdx.x * blockDim.x, U - 1)] + skip_prob;
   }
 
   if (t >= 0 && u >= 0) {
     CAST_DTYPE skip_prob =
-        logProbs[(idxr(bTgt, t, u) << 1) + LOG_PROBS_SKIP_IDX];
+        logProbs[(idxr(t, u) << 1) + LOG_PROBS_SKIP_IDX];
     CAST_DTYPE emit_prob =
-        logProbs[(idxr(bTgt, t, u) << 1) + LOG_PROBS_EMIT_IDX];
+        logProbs[(idxr(t, u) << 1) + LOG_PROBS_EMIT_IDX];
 
-    CAST_DTYPE skip = betas[idxr(bTgt, t + threadIdx.x + 1, u)] + skip_prob;
-    CAST_DTYPE emit = betas[idxr(bTgt, t, u + 1)] + emit_prob;
+    CAST_DTYPE skip = betas[idxr(t + threadIdx.x + 1, u)] + skip_prob;
+    CAST_DTYPE emit = betas[idxr(t, u + 1)] + emit_prob;
 
     CAST_DTYPE val = math::lse(skip, emit);
     CAST_DTYPE out = val;
@@ -244,7 +329,7 @@ __device__ void ComputeBetasCosts(
       }
     }
 
-    betas[idxr(bTgt, t, u)] = out;
+    betas[idxr(t, u)] = out;
 
     if (t == 0 && u == 0) { // use -beta(0, 0) as cost.
       costs[bTgt] = DTYPE(-out);
@@ -266,6 +351,7 @@ __global__ void ComputeAlphasBetasCosts(
     const CAST_DTYPE* logProbs,
     const int* srcLengths,
     const int* tgtLengths,
+    const int* offsets,
     int* alpha_counters,
     volatile CAST_DTYPE* alphas,
     int* betaCounters,
@@ -285,6 +371,7 @@ __global__ void ComputeAlphasBetasCosts(
         /*logProbs=*/logProbs,
         /*srcLengths=*/srcLengths,
         /*tgtLengths=*/tgtLengths,
+        /*offsets=*/offsets,
         /*alpha_counters=*/alpha_counters,
         /*alphas=*/alphas,
         H);
@@ -297,6 +384,7 @@ __global__ void ComputeAlphasBetasCosts(
         /*logProbs=*/logProbs,
         /*srcLengths=*/srcLengths,
         /*tgtLengths=*/tgtLengths,
+        /*offsets=*/offsets,
         /*betaCounters=*/betaCounters,
         /*beta=*/betas,
         /*costs=*/costs,
@@ -304,6 +392,140 @@ __global__ void ComputeAlphasBetasCosts(
   }
 }
 
+// Computes the alphas (blockIdx.y == 0), or the betas and the costs
+// (blockIdx.y == 1), of the lattice of the sequence blockIdx.x with a single
+// block, without the counters of ComputeAlphasBetasCosts.
+//
+// The cells of an anti-diagonal, t + u = d for the alphas and
+// (T - 1 - t) + (U - 1 - u) = d for the betas, only depend on the previous
+// anti-diagonal, so the block computes them in parallel, one anti-diagonal
+// after the other. The last two anti-diagonals are staged in the shared
+// memory, 2 * maxTgtLen values indexed by their distance to the (0, 0) corner
+// along the u-axis (from the (T - 1, U - 1) corner for the betas), and the
+// values are also written to alphas and betas for the gradients. Unlike
+// ComputeAlphasBetasCosts, all the lattices are filled, including the ones of
+// T == 1 or U == 1.
+template <typename DTYPE, typename CAST_DTYPE>
+__global__ void ComputeAlphasBetasCostsDiagonal(
+    int maxSrcLen,
+    int maxTgtLen,
+    const CAST_DTYPE* logProbs,
+    const int* srcLengths,
+    const int* tgtLengths,
+    const int* offsets,
+    CAST_DTYPE* alphas,
+    CAST_DTYPE* betas,
+    DTYPE* costs,
+    int H = 1) {
+  extern __shared__ unsigned char diagonalsData[];
+  CAST_DTYPE* prev = reinterpret_cast<CAST_DTYPE*>(diagonalsData);
+  CAST_DTYPE* curr = prev + maxTgtLen;
+
+  const int bTgt = blockIdx.x;
+  const int T = srcLengths[bTgt / H];
+  const int U = tgtLengths[bTgt] + 1;
+  if (T <= 0) {
+    return;
+  }
+  const bool isAlpha = blockIdx.y == 0;
+
+  LatticeIndexer idxr(offsets, bTgt, maxSrcLen, maxTgtLen, U);
+  auto skipProb = [&](int t, int u) {
+    return logProbs[(idxr(t, u) << 1) + LOG_PROBS_SKIP_IDX];
+  };
+  auto emitProb = [&](int t, int u) {
+    return logProbs[(idxr(t, u) << 1) + LOG_PROBS_EMIT_IDX];
+  };
+
+  for (int d = 0; d < T + U - 1; ++d) {
+    const int iBegin = max(0, d - (T - 1));
+    const int iEnd = min(d, U - 1);
+    for (int i = iBegin + threadIdx.x; i <= iEnd; i += blockDim.x) {
+      CAST_DTYPE val;
+      if (isAlpha) {
+        const int t = d - i;
+        const int u = i;
+        if (d == 0) {
+          val = 0;
+        } else if (t == 0) {
+          val = prev[i - 1] + emitProb(0, u - 1);
+        } else if (u == 0) {
+          val = prev[i] + skipProb(t - 1, 0);
+        } else {
+          val = math::lse(
+              prev[i] + skipProb(t - 1, u), prev[i - 1] + emitProb(t, u - 1));
+        }
+        alphas[idxr(t, u)] = val;
+      } else {
+        const int t = T - 1 - (d - i);
+        const int u = U - 1 - i;
+        if (d == 0) {
+          val = skipProb(T - 1, U - 1);
+        } else if (t == T - 1) {
+          val = prev[i - 1] + emitProb(T - 1, u);
+        } else if (u == U - 1) {
+          val = prev[i] + skipProb(t, U - 1);
+        } else {
+          val = math::lse(
+              prev[i] + skipProb(t, u), prev[i - 1] + emitProb(t, u));
+        }
+        betas[idxr(t, u)] = val;
+        if (t == 0 && u == 0) { // use -beta(0, 0) as cost.
+          costs[bTgt] = DTYPE(-val);
+        }
+      }
+      curr[i] = val;
+    }
+    __syncthreads();
+    CAST_DTYPE* next = prev;
+    prev = curr;
+    curr = next;
+  }
+}
+
+// Computes the costs of the sequences from their alphas, with one thread per
+// sequence: cost = -(alpha(T - 1, U - 1) + log_prob(T - 1, U - 1).skip()).
+// ComputeAlphas only fills the lattices of T > 1 and U > 1, and the alpha of a
+// single frame (or of an empty target) is the sum of the log probs of its
+// emissions (or of its skips).
+template <typename DTYPE, typename CAST_DTYPE>
+__global__ void ComputeCostsFromAlphas(
+    int numSequences,
+    int maxSrcLen,
+    int maxTgtLen,
+    const CAST_DTYPE* logProbs,
+    const int* srcLengths,
+    const int* tgtLengths,
+    const int* offsets,
+    const CAST_DTYPE* alphas,
+    DTYPE* costs,
+    int H = 1) {
+  const int bTgt = blockIdx.x * blockDim.x + threadIdx.x;
+  if (bTgt >= numSequences) {
+    return;
+  }
+  const int T = srcLengths[bTgt / H];
+  const int U = tgtLengths[bTgt] + 1;
+
+  LatticeIndexer idxr(offsets, bTgt, maxSrcLen, maxTgtLen, U);
+
+  CAST_DTYPE alpha = 0;
+  if (T == 1) {
+    for (int u = 0; u < U - 1; ++u) {
+      alpha = alpha + logProbs[(idxr(0, u) << 1) + LOG_PROBS_EMIT_IDX];
+    }
+  } else if (U == 1) {
+    for (int t = 0; t < T - 1; ++t) {
+      alpha = alpha + logProbs[(idxr(t, 0) << 1) + LOG_PROBS_SKIP_IDX];
+    }
+  } else {
+    alpha = alphas[idxr(T - 1, U - 1)];
+  }
+  const CAST_DTYPE skip =
+      logProbs[(idxr(T - 1, U - 1) << 1) + LOG_PROBS_SKIP_IDX];
+  costs[bTgt] = DTYPE(-(alpha + skip));
+}
+
 template <typename DTYPE, typename CAST_DTYPE>
 __global__ void ComputeGradients(
     int maxSrcLen,
@@ -315,6 +537,7 @@ __global__ void ComputeGradients(
     const int* targets,
     const int* srcLengths,
     const int* tgtLengths,
+    const int* offsets,
     const CAST_DTYPE* denominators,
     const CAST_DTYPE* alphas,
     const CAST_DTYPE* betas,
@@ -337,6 +560,7 @@ __global__ void ComputeGradients(
       targets,
       srcLengths,
       tgtLengths,
+      offsets,
       denominators,
       alphas,
       betas,
@@ -355,6 +579,7 @@ __global__ void ComputeAlphasWrapper(
     const CAST_DTYPE* logProbs,
     const int* srcLengths,
     const int* tgtLengths,
+    const int* offsets,
     int* alpha_counters,
     volatile CAST_DTYPE* alphas,
     int H = 1) {
@@ -366,6 +591,7 @@ __global__ void ComputeAlphasWrapper(
       logProbs,
       srcLengths,
       tgtLengths,
+      offsets,
       alpha_counters,
       alphas,
       H);
@@ -382,6 +608,7 @@ __global__ void ComputeBetasWrapper(
     const CAST_DTYPE* logProbs,
     const int* srcLengths,
     const int* tgtLengths,
+    const int* offsets,
     int* betaCounters,
     volatile CAST_DTYPE* betas,
     DTYPE* costs,
@@ -394,6 +621,7 @@ __global__ void ComputeBetasWrapper(
       logProbs,
       srcLengths,
       tgtLengths,
+      offsets,
       betaCounters,
       betas,
       costs,
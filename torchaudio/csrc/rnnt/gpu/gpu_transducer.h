@@ -2,6 +2,9 @@
 
 #ifdef USE_CUDA
 
+#include <algorithm>
+
+#include <torchaudio/csrc/rnnt/record_function.h>
 #include <torchaudio/csrc/rnnt/workspace.h>
 #include <torchaudio/csrc/rnnt/gpu/gpu_kernel_utils.cuh>
 #include <torchaudio/csrc/rnnt/gpu/gpu_kernels.cuh>
@@ -72,6 +75,129 @@ status_t LogSumExp2D(
   return SUCCESS;
 }
 
+// ComputeAlphasBetasCostsDiagonal keeps two anti-diagonals of max_U values per
+// block in the shared memory, within the default limit of 48 KiB.
+constexpr int kDiagonalMaxSharedBytes = 48 * 1024;
+
+template <typename CAST_DTYPE>
+size_t DiagonalSharedBytes(int maxTgtLen) {
+  return 2 * static_cast<size_t>(maxTgtLen) * sizeof(CAST_DTYPE);
+}
+
+// Whether the alphas and the betas of lattices of max_U symbols are computed
+// by ComputeAlphasBetasCostsDiagonal, which needs no counters, rather than by
+// ComputeAlphasBetasCosts. Sets options.diagonalAlphasBetas_ before the
+// workspace is allocated. The diagonal kernel only runs one block per lattice
+// and direction, so it is only used when the caller selects it, and when its
+// shared memory fits.
+template <typename CAST_DTYPE>
+bool UseDiagonalAlphasBetas(alphas_betas_kernel_t kernel, int maxTgtLen) {
+  return kernel == DIAGONAL_KERNEL &&
+      DiagonalSharedBytes<CAST_DTYPE>(maxTgtLen) <= kDiagonalMaxSharedBytes;
+}
+
+// Computes the alphas, and unless alphasOnly the betas and the costs, with
+// ComputeAlphasBetasCostsDiagonal: one block per lattice and direction.
+template <typename DTYPE, typename CAST_DTYPE>
+status_t ComputeAlphasBetasCostsByDiagonals(
+    const Workspace<CAST_DTYPE>& workspace,
+    const int* srcLengths,
+    const int* tgtLengths,
+    DTYPE* costs,
+    bool alphasOnly) {
+  const Options& options = workspace.GetOptions();
+  const int num_sequences = options.batchSize_ * options.nHypos_;
+  const int& max_T = options.maxSrcLen_;
+  const int& max_U = options.maxTgtLen_;
+  if (num_sequences == 0) {
+    return SUCCESS;
+  }
+
+  // Enough warps for the longest anti-diagonal, of min(max_T, max_U) cells.
+  const int num_threads = std::min(
+      MAX_THREADS_PER_BLOCK,
+      std::max(
+          WARP_SIZE,
+          (std::min(max_T, max_U) + WARP_SIZE - 1) / WARP_SIZE * WARP_SIZE));
+  dim3 block_dims(num_sequences, alphasOnly ? 1 : 2);
+  const size_t shared_bytes = DiagonalSharedBytes<CAST_DTYPE>(max_U);
+
+  ComputeAlphasBetasCostsDiagonal<DTYPE, CAST_DTYPE>
+      <<<block_dims, num_threads, shared_bytes, options.stream_>>>(
+          /*max_src_len=*/max_T,
+          /*max_tgt_len=*/max_U,
+          /*log_probs=*/workspace.GetPointerToLogProbs(),
+          /*srcLengths=*/srcLengths,
+          /*tgtLengths=*/tgtLengths,
+          /*offsets=*/options.packedOffsets_,
+          /*alphas=*/workspace.GetPointerToAlphas(),
+          /*betas=*/workspace.GetPointerToBetas(),
+          /*costs=*/costs,
+          options.nHypos_);
+  if (cudaGetLastError() != cudaSuccess) {
+    return COMPUTE_ALPHAS_BETAS_COSTS_FAILED;
+  }
+  return SUCCESS;
+}
+
+// Computes the denominators and the log probability pairs (blank and target)
+// with ComputeDenominatorsAndLogProbs, loading VEC elements at a time.
+template <typename DTYPE, typename CAST_DTYPE, int VEC>
+status_t ComputeLogProbsVectorized(
+    const Workspace<CAST_DTYPE>& workspace,
+    const DTYPE* logits,
+    const int* targets,
+    const int* srcLengths,
+    const int* tgtLengths) {
+  const Options& options = workspace.GetOptions();
+  const int N = options.BTU();
+  if (N == 0) {
+    return SUCCESS;
+  }
+
+  dim3 block_dims((N + kLogProbsRowsPerBlock - 1) / kLogProbsRowsPerBlock);
+  dim3 thread_dims(WARP_SIZE, kLogProbsRowsPerBlock);
+  ComputeDenominatorsAndLogProbs<DTYPE, CAST_DTYPE, VEC>
+      <<<block_dims, thread_dims, 0, options.stream_>>>(
+          /*num_rows=*/N,
+          /*max_src_len=*/options.maxSrcLen_,
+          /*max_tgt_len=*/options.maxTgtLen_,
+          /*num_targets=*/options.numTargets_,
+          /*blank=*/options.blank_,
+          /*batch_size=*/options.batchSize_ * options.nHypos_,
+          /*logits=*/logits,
+          /*targets=*/targets,
+          /*srcLengths=*/srcLengths,
+          /*tgtLengths=*/tgtLengths,
+          /*offsets=*/options.packedOffsets_,
+          /*denominators=*/workspace.GetPointerToDenominators(),
+          /*log_probs=*/workspace.GetPointerToLogProbs(),
+          options.nHypos_);
+
+  if (cudaGetLastError() != cudaSuccess) {
+    return COMPUTE_LOG_PROBS_FAILED;
+  }
+  return SUCCESS;
+}
+
+template <typename DTYPE, typename CAST_DTYPE>
+status_t ComputeLogProbs(
+    const Workspace<CAST_DTYPE>& workspace,
+    const DTYPE* logits,
+    const int* targets,
+    const int* srcLengths,
+    const int* tgtLengths) {
+  // Loads of 16 bytes (float4 or 8 halves) when every row is aligned to them.
+  constexpr int kVec = 16 / sizeof(DTYPE);
+  const int& D = workspace.GetOptions().numTargets_;
+  if (D % kVec == 0 && reinterpret_cast<uintptr_t>(logits) % 16 == 0) {
+    return ComputeLogProbsVectorized<DTYPE, CAST_DTYPE, kVec>(
+        workspace, logits, targets, srcLengths, tgtLengths);
+  }
+  return ComputeLogProbsVectorized<DTYPE, CAST_DTYPE, 1>(
+      workspace, logits, targets, srcLengths, tgtLengths);
+}
+
 // Inputs:
 //   workspace: workspace.
 //   logits: pointer to (B, max_T, max_U, D) logits.
@@ -102,44 +228,33 @@ status_t Compute(
   const int& blank = options.blank_;
   const CAST_DTYPE clamp = options.clamp_;
 
-  { // compute denominators.
-    status_t status = LogSumExp2D<DTYPE, CAST_DTYPE>(
-        /*stream=*/stream,
-        /*N=*/B * H * max_T * max_U,
-        /*D=*/D,
+  { // compute denominators and log probability pairs (blank and target).
+    RNNT_RECORD_STAGE("torchaudio::rnnt::denominators_log_probs", options);
+    status_t status = ComputeLogProbs<DTYPE, CAST_DTYPE>(
+        /*workspace=*/workspace,
         /*logits=*/logits,
-        /*denominators=*/workspace.GetPointerToDenominators());
+        /*targets=*/targets,
+        /*srcLengths=*/srcLengths,
+        /*tgtLengths=*/tgtLengths);
 
     if (status != SUCCESS) {
       return status;
     }
   }
 
-  { // compute log probability pairs (blank and target).
-    int num_segments =
-        (max_T + MAX_THREADS_PER_BLOCK - 1) / MAX_THREADS_PER_BLOCK;
-    dim3 block_dims(num_segments, max_U, B * H);
-    dim3 thread_dims(MAX_THREADS_PER_BLOCK);
-
-    ComputeLogProbs<DTYPE, CAST_DTYPE><<<block_dims, thread_dims, 0, stream>>>(
-        /*max_src_len=*/max_T,
-        /*max_tgt_len=*/max_U,
-        /*num_targets=*/D,
-        /*blank=*/blank,
-        /*logits=*/logits,
-        /*targets=*/targets,
+  if (options.diagonalAlphasBetas_) { // compute alphas, betas and costs.
+    RNNT_RECORD_STAGE("torchaudio::rnnt::alphas_betas", options);
+    status_t status = ComputeAlphasBetasCostsByDiagonals<DTYPE, CAST_DTYPE>(
+        /*workspace=*/workspace,
         /*srcLengths=*/srcLengths,
         /*tgtLengths=*/tgtLengths,
-        /*denominators=*/workspace.GetPointerToDenominators(),
-        /*log_probs=*/workspace.GetPointerToLogProbs(),
-        H);
-
-    if (cudaGetLastError() != cudaSuccess) {
-      return COMPUTE_LOG_PROBS_FAILED;
+        /*costs=*/costs,
+        /*alphasOnly=*/false);
+    if (status != SUCCESS) {
+      return status;
     }
-  }
-
-  { // compute alphas, betas and costs.
+  } else { // compute alphas, betas and costs.
+    RNNT_RECORD_STAGE("torchaudio::rnnt::alphas_betas", options);
     // warp is usually a group of threads (32)
     int num_warps = (max_T + WARP_SIZE - 1) / WARP_SIZE;
 
@@ -161,6 +276,7 @@ status_t Compute(
             /*log_probs=*/workspace.GetPointerToLogProbs(),
             /*srcLengths=*/srcLengths,
             /*tgtLengths=*/tgtLengths,
+            /*offsets=*/options.packedOffsets_,
             /*alpha_counters=*/workspace.GetPointerToAlphaCounters(),
             /*alphas=*/workspace.GetPointerToAlphas(),
             /*beta_counters=*/workspace.GetPointerToBetaCounters(),
@@ -175,6 +291,7 @@ status_t Compute(
   }
 
   if (gradients != nullptr) { // compute gradients.
+    RNNT_RECORD_STAGE("torchaudio::rnnt::gradients", options);
     // don't set gradients to zero to here as gradients might reuse memory from
     // logits
 
@@ -193,6 +310,7 @@ status_t Compute(
         /*targets=*/targets,
         /*srcLengths=*/srcLengths,
         /*tgtLengths=*/tgtLengths,
+        /*offsets=*/options.packedOffsets_,
         /*denominators=*/workspace.GetPointerToDenominators(),
         /*alphas=*/workspace.GetPointerToAlphas(),
         /*betas=*/workspace.GetPointerToBetas(),
@@ -224,40 +342,16 @@ status_t ComputeAlphas(
   const int& D = options.numTargets_;
   const int& blank = options.blank_;
 
-  { // compute denominators.
-    status_t status = LogSumExp2D<DTYPE, CAST_DTYPE>(
-        /*stream=*/stream,
-        /*N=*/B * H * max_T * max_U,
-        /*D=*/D,
-        /*logits=*/logits,
-        /*denominators=*/workspace.GetPointerToDenominators());
-
-    if (status != SUCCESS) {
-      return status;
-    }
-  }
-
-  { // compute log probability pairs (blank and target).
-    int num_segments =
-        (max_T + MAX_THREADS_PER_BLOCK - 1) / MAX_THREADS_PER_BLOCK;
-    dim3 block_dims(num_segments, max_U, B * H);
-    dim3 thread_dims(MAX_THREADS_PER_BLOCK);
-
-    ComputeLogProbs<DTYPE, CAST_DTYPE><<<block_dims, thread_dims, 0, stream>>>(
-        /*max_src_len=*/max_T,
-        /*max_tgt_len=*/max_U,
-        /*num_targets=*/D,
-        /*blank=*/blank,
+  { // compute denominators and log probability pairs (blank and target).
+    status_t status = ComputeLogProbs<DTYPE, CAST_DTYPE>(
+        /*workspace=*/workspace,
         /*logits=*/logits,
         /*targets=*/targets,
         /*srcLengths=*/srcLengths,
-        /*tgtLengths=*/tgtLengths,
-        /*denominators=*/workspace.GetPointerToDenominators(),
-        /*log_probs=*/workspace.GetPointerToLogProbs(),
-        H);
+        /*tgtLengths=*/tgtLengths);
 
-    if (cudaGetLastError() != cudaSuccess) {
-      return COMPUTE_LOG_PROBS_FAILED;
+    if (status != SUCCESS) {
+      return status;
     }
   }
   { // compute alphas
@@ -282,6 +376,7 @@ status_t ComputeAlphas(
             /*log_probs=*/workspace.GetPointerToLogProbs(),
             /*srcLengths=*/srcLengths,
             /*tgtLengths=*/tgtLengths,
+            /*offsets=*/options.packedOffsets_,
             /*alpha_counters=*/workspace.GetPointerToAlphaCounters(),
             /*alphas=*/(volatile DTYPE*)alphas,
             H);
@@ -313,40 +408,16 @@ status_t ComputeBetas(
   const int& D = options.numTargets_;
   const int& blank = options.blank_;
 
-  { // compute denominators.
-    status_t status = LogSumExp2D<DTYPE, CAST_DTYPE>(
-        /*stream=*/stream,
-        /*N=*/B * H * max_T * max_U,
-        /*D=*/D,
-        /*logits=*/logits,
-        /*denominators=*/workspace.GetPointerToDenominators());
-
-    if (status != SUCCESS) {
-      return status;
-    }
-  }
-
-  { // compute log probability pairs (blank and target).
-    int num_segments =
-        (max_T + MAX_THREADS_PER_BLOCK - 1) / MAX_THREADS_PER_BLOCK;
-    dim3 block_dims(num_segments, max_U, B * H);
-    dim3 thread_dims(MAX_THREADS_PER_BLOCK);
-
-    ComputeLogProbs<DTYPE, CAST_DTYPE><<<block_dims, thread_dims, 0, stream>>>(
-        /*max_src_len=*/max_T,
-        /*max_tgt_len=*/max_U,
-        /*num_targets=*/D,
-        /*blank=*/blank,
+  { // compute denominators and log probability pairs (blank and target).
+    status_t status = ComputeLogProbs<DTYPE, CAST_DTYPE>(
+        /*workspace=*/workspace,
         /*logits=*/logits,
         /*targets=*/targets,
         /*srcLengths=*/srcLengths,
-        /*tgtLengths=*/tgtLengths,
-        /*denominators=*/workspace.GetPointerToDenominators(),
-        /*log_probs=*/workspace.GetPointerToLogProbs(),
-        H);
+        /*tgtLengths=*/tgtLengths);
 
-    if (cudaGetLastError() != cudaSuccess) {
-      return COMPUTE_LOG_PROBS_FAILED;
+    if (status != SUCCESS) {
+      return status;
     }
   }
   { // compute betas
@@ -371,6 +442,7 @@ status_t ComputeBetas(
             /*log_probs=*/workspace.GetPointerToLogProbs(),
             /*srcLengths=*/srcLengths,
             /*tgtLengths=*/tgtLengths,
+            /*offsets=*/options.packedOffsets_,
             /*alpha_counters=*/workspace.GetPointerToBetaCounters(),
             /*alphas=*/(volatile DTYPE*)betas,
             costs,
@@ -384,6 +456,103 @@ status_t ComputeBetas(
   return SUCCESS;
 }
 
+// Computes the costs from the alphas only, for the scoring of sequences
+// without gradients. The workspace only needs options.scoreOnly_.
+template <typename DTYPE, typename CAST_DTYPE>
+status_t ComputeScores(
+    const Workspace<CAST_DTYPE>& workspace,
+    const DTYPE* logits,
+    const int* targets,
+    const int* srcLengths,
+    const int* tgtLengths,
+    DTYPE* costs) {
+  const Options& options = workspace.GetOptions();
+
+  const cudaStream_t& stream = options.stream_;
+  const int& B = options.batchSize_;
+  const int& H = options.nHypos_;
+  const int& max_T = options.maxSrcLen_;
+  const int& max_U = options.maxTgtLen_;
+  const int& D = options.numTargets_;
+  const int& blank = options.blank_;
+
+  if (B * H == 0) {
+    return SUCCESS;
+  }
+
+  { // compute denominators and log probability pairs (blank and target).
+    status_t status = ComputeLogProbs<DTYPE, CAST_DTYPE>(
+        /*workspace=*/workspace,
+        /*logits=*/logits,
+        /*targets=*/targets,
+        /*srcLengths=*/srcLengths,
+        /*tgtLengths=*/tgtLengths);
+
+    if (status != SUCCESS) {
+      return status;
+    }
+  }
+
+  if (options.diagonalAlphasBetas_) { // compute alphas
+    status_t status = ComputeAlphasBetasCostsByDiagonals<DTYPE, CAST_DTYPE>(
+        /*workspace=*/workspace,
+        /*srcLengths=*/srcLengths,
+        /*tgtLengths=*/tgtLengths,
+        /*costs=*/costs,
+        /*alphasOnly=*/true);
+    if (status != SUCCESS) {
+      return status;
+    }
+  } else { // compute alphas
+    int num_warps = (max_T + WARP_SIZE - 1) / WARP_SIZE;
+    dim3 block_dims(num_warps, max_U, B * H);
+    dim3 thread_dims(WARP_SIZE, 1);
+
+    ComputeAlphasWrapper<DTYPE, CAST_DTYPE>
+        <<<block_dims, thread_dims, 0, stream>>>(
+            /*max_src_len=*/max_T,
+            /*max_tgt_len=*/max_U,
+            /*num_targets=*/D,
+            /*blank=*/blank,
+            /*log_probs=*/workspace.GetPointerToLogProbs(),
+            /*srcLengths=*/srcLengths,
+            /*tgtLengths=*/tgtLengths,
+            /*offsets=*/options.packedOffsets_,
+            /*alpha_counters=*/workspace.GetPointerToAlphaCounters(),
+            /*alphas=*/workspace.GetPointerToAlphas(),
+            H);
+
+    if (cudaGetLastError() != cudaSuccess) {
+      return COMPUTE_ALPHAS_BETAS_COSTS_FAILED;
+    }
+  }
+
+  { // compute costs
+    const int num_sequences = B * H;
+    ComputeCostsFromAlphas<DTYPE, CAST_DTYPE>
+        <<<(num_sequences + MAX_THREADS_PER_BLOCK - 1) / MAX_THREADS_PER_BLOCK,
+           MAX_THREADS_PER_BLOCK,
+           0,
+           stream>>>(
+            /*num_sequences=*/num_sequences,
+            /*max_src_len=*/max_T,
+            /*max_tgt_len=*/max_U,
+            /*log_probs=*/workspace.GetPointerToLogProbs(),
+            /*srcLengths=*/srcLengths,
+            /*tgtLengths=*/tgtLengths,
+            /*offsets=*/options.packedOffsets_,
+            /*alphas=*/workspace.GetPointerToAlphas(),
+            /*costs=*/costs,
+            H);
+
+    if (cudaGetLastError() != cudaSuccess) {
+      return COMPUTE_ALPHAS_BETAS_COSTS_FAILED;
+    }
+  }
+
+  return SUCCESS;
+}
+
 } // namespace gpu
 } // namespace rnnt
 } // namespace torchaudio
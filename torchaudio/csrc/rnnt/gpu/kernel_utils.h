@@ -18,9 +18,10 @@ inline HOST_AND_DEVICE bool in_range(
 #define LOG_PROBS_EMIT_IDX 1
 
 struct Indexer2D {
-  const int& size2_;
+  // By value, as it is constructed with temporaries like maxU - 1.
+  const int size2_;
 
-  FORCE_INLINE HOST_AND_DEVICE Indexer2D(const int& size2) : size2_(size2) {}
+  FORCE_INLINE HOST_AND_DEVICE Indexer2D(int size2) : size2_(size2) {}
 
   FORCE_INLINE HOST_AND_DEVICE int operator()(int index1, int index2) {
     return index1 * size2_ + index2;
@@ -42,6 +43,28 @@ struct Indexer3D {
   }
 };
 
+// Index of the row (t, u) of the lattice of sequence b: in the padded layout
+// (B, maxT, maxU) if offsets is nullptr, or in the packed layout, where the
+// rows of the sequence, of U targets, start at offsets[b] (see
+// Options::packedOffsets_).
+struct LatticeIndexer {
+  int base_;
+  int size2_;
+
+  FORCE_INLINE HOST_AND_DEVICE LatticeIndexer(
+      const int* offsets,
+      int b,
+      int maxT,
+      int maxU,
+      int U)
+      : base_(offsets == nullptr ? b * maxT * maxU : offsets[b]),
+        size2_(offsets == nullptr ? maxU : U) {}
+
+  FORCE_INLINE HOST_AND_DEVICE int operator()(int t, int u) const {
+    return base_ + t * size2_ + u;
+  }
+};
+
 struct Indexer4D {
   const int& size2_;
   const int& size3_;
@@ -22,6 +22,7 @@ HOST_AND_DEVICE void ComputeGradientsElement(
     const int* targets,
     const int* srcLengths,
     const int* tgtLengths,
+    const int* offsets,
     const CAST_DTYPE* denominators,
     const CAST_DTYPE* alphas,
     const CAST_DTYPE* betas,
@@ -36,7 +37,8 @@ HOST_AND_DEVICE void ComputeGradientsElement(
   const int U = tgtLengths[bTgt] + 1;
 
   if (t >= T || u >= U) { // out of boundary.
-    if (gradients == logits && t < maxT && u < maxU) {
+    // The packed layout has no padding.
+    if (offsets == nullptr && gradients == logits && t < maxT && u < maxU) {
       // gradients and logits are pointing to the same memory location
       Indexer3D idxr3(maxT, maxU);
       int idx_b_t_u_zero = idxr3(bTgt, t, u);
@@ -50,16 +52,16 @@ HOST_AND_DEVICE void ComputeGradientsElement(
     return;
   }
 
-  int costIdx = bTgt * maxT * maxU;
+  LatticeIndexer idxr3(offsets, bTgt, maxT, maxU, U);
+  int costIdx = idxr3(0, 0);
   CAST_DTYPE cost = -(betas[costIdx]);
 
   Indexer2D idxr2(maxU - 1);
 
   int idx_b_t_u, idx_b_t_up1, idx_b_tp1_u;
-  Indexer3D idxr3(maxT, maxU);
-  idx_b_t_u = idxr3(bTgt, t, u);
-  idx_b_t_up1 = idxr3(bTgt, t, u + 1);
-  idx_b_tp1_u = idxr3(bTgt, t + 1, u);
+  idx_b_t_u = idxr3(t, u);
+  idx_b_t_up1 = idxr3(t, u + 1);
+  idx_b_tp1_u = idxr3(t + 1, u);
 
   if (idx_b_t_u == -1) {
     return;
@@ -9,6 +9,8 @@
 #include <torchaudio/csrc/rnnt/macros.h>
 #include <torchaudio/csrc/rnnt/types.h>
 
+#include <string>
+
 namespace torchaudio {
 namespace rnnt {
 
@@ -19,7 +21,8 @@ typedef struct Options {
   // the stream to launch kernels in when using GPU.
   cudaStream_t stream_;
 #endif
-  // The maximum number of threads that can be used.
+  // The maximum number of threads that can be used on CPU, or 0 (the default)
+  // for all the threads of the intra-op thread pool.
   int numThreads_;
 
   // the index for "blank".
@@ -28,6 +31,14 @@ typedef struct Options {
   bool backtrack_;
   // gradient clamp value.
   float clamp_;
+  // whether to compute the costs only, from the alphas. The workspace has no
+  // buffer for the betas then, and the gradients cannot be computed.
+  bool scoreOnly_;
+  // whether the alphas and the betas are computed on GPU by a single block per
+  // lattice, which walks it through its anti-diagonals, instead of blocks
+  // which wait for each other through the counters of the IntWorkspace. The
+  // workspace has no counters then.
+  bool diagonalAlphasBetas_;
 
   // batch size = B.
   int batchSize_;
@@ -42,23 +53,42 @@ typedef struct Options {
   // num_targets = D.
   int numTargets_;
 
+  // The packed layout: the lattice of sequence b is the (T_b, U_b) block of
+  // rows at packedOffsets_[b], in memory of the device, and packedRows_ is the
+  // number of rows (sum of T_b * U_b). nullptr for the padded layout, of
+  // B * max_T * max_U rows.
+  const int* packedOffsets_;
+  int packedRows_;
+
   Options()
       : device_(UNDEFINED),
         numThreads_(0),
         blank_(-1),
         backtrack_(false),
         clamp_(-1), // negative for disabling clamping by default.
+        scoreOnly_(false),
+        diagonalAlphasBetas_(false),
         batchSize_(0),
         nHypos_(1),
         maxSrcLen_(0),
         maxTgtLen_(0),
-        numTargets_(0) {}
+        numTargets_(0),
+        packedOffsets_(nullptr),
+        packedRows_(0) {}
 
   int BU() const {
     return batchSize_ * maxTgtLen_ * nHypos_;
   }
 
+  bool IsPacked() const {
+    return packedOffsets_ != nullptr;
+  }
+
+  // The number of rows of the logits and of the buffers of the lattices.
   int BTU() const {
+    if (IsPacked()) {
+      return packedRows_;
+    }
     return batchSize_ * maxSrcLen_ * maxTgtLen_ * nHypos_;
   }
 
@@ -73,5 +103,10 @@ typedef struct Options {
   }
 } Options;
 
+// The kernel of the alphas and the betas on GPU named by the
+// alphas_betas_kernel argument of rnnt_loss and rnnt_score: "counters" or
+// "diagonal".
+alphas_betas_kernel_t ParseAlphasBetasKernel(const std::string& kernel);
+
 } // namespace rnnt
 } // namespace torchaudio
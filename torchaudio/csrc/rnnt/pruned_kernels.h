@@ -0,0 +1,186 @@
+#pragma once
+
+#include <torchaudio/csrc/rnnt/macros.h>
+
+#include <cmath>
+
+namespace torchaudio {
+namespace rnnt {
+namespace pruned {
+
+// Kernels of the pruned RNNT loss, shared by the CPU and the GPU
+// implementations.
+//
+// The lattice of a sequence is restricted to a band of S symbols per frame:
+// cell (t, s) of the band is the node (t, u) of the full lattice with
+// u = ranges[t] + s. Nodes outside of the band, and the transitions to them,
+// are removed. Cells with u < 0 or u > target length are padding and are
+// ignored, so out-of-range bands give an infinite cost rather than reads out
+// of the targets.
+//
+// For a path to exist, ranges[0] must be 0, ranges must be non-decreasing,
+// the bands of consecutive frames must overlap (ranges[t + 1] <=
+// ranges[t] + S - 1) and the last band must contain the target length.
+// Otherwise the cost is infinite and the gradients are zero.
+//
+// All the arrays are the ones of one sequence, row-major:
+//   logProbs (maxT, S, 2) - log probabilities of blank (kSkip) and of the
+//                           target (kEmit).
+//   ranges (maxT)
+//   alpha, beta, denom (maxT, S)
+// T is the number of frames and U the target length + 1.
+
+constexpr int kSkip = 0;
+constexpr int kEmit = 1;
+
+FORCE_INLINE HOST_AND_DEVICE float NegInf() {
+  return -INFINITY;
+}
+
+// log(exp(x) + exp(y)), with -inf for the missing terms.
+FORCE_INLINE HOST_AND_DEVICE float LogAddExp(float x, float y) {
+  if (x == NegInf()) {
+    return y;
+  }
+  if (y == NegInf()) {
+    return x;
+  }
+  if (y > x) {
+    return y + log1pf(expf(x - y));
+  }
+  return x + log1pf(expf(y - x));
+}
+
+// Index of node (t, u) in the band of frame t, or -1 if it is outside.
+FORCE_INLINE HOST_AND_DEVICE int
+BandIndex(const int* ranges, int S, int t, int u) {
+  const int s = u - ranges[t];
+  return (s >= 0 && s < S) ? s : -1;
+}
+
+// Computes the alphas and returns the log likelihood.
+FORCE_INLINE HOST_AND_DEVICE float ComputeAlphaOneSequence(
+    const float* logProbs,
+    const int* ranges,
+    int T,
+    int U,
+    int S,
+    float* alpha) {
+  for (int t = 0; t < T; ++t) {
+    for (int s = 0; s < S; ++s) {
+      const int u = ranges[t] + s;
+      const int idx = t * S + s;
+      if (u < 0 || u >= U) {
+        alpha[idx] = NegInf();
+        continue;
+      }
+      if (t == 0 && u == 0) {
+        alpha[idx] = 0;
+        continue;
+      }
+      float a = NegInf();
+      if (t > 0) { // blank from (t - 1, u).
+        const int prev = BandIndex(ranges, S, t - 1, u);
+        if (prev >= 0) {
+          const int pidx = (t - 1) * S + prev;
+          a = alpha[pidx] + logProbs[(pidx << 1) + kSkip];
+        }
+      }
+      if (s > 0) { // target from (t, u - 1).
+        a = LogAddExp(a, alpha[idx - 1] + logProbs[((idx - 1) << 1) + kEmit]);
+      }
+      alpha[idx] = a;
+    }
+  }
+  const int last = BandIndex(ranges, S, T - 1, U - 1);
+  if (last < 0) {
+    return NegInf();
+  }
+  const int idx = (T - 1) * S + last;
+  return alpha[idx] + logProbs[(idx << 1) + kSkip];
+}
+
+// Computes the betas and returns the log likelihood.
+FORCE_INLINE HOST_AND_DEVICE float ComputeBetaOneSequence(
+    const float* logProbs,
+    const int* ranges,
+    int T,
+    int U,
+    int S,
+    float* beta) {
+  for (int t = T - 1; t >= 0; --t) {
+    for (int s = S - 1; s >= 0; --s) {
+      const int u = ranges[t] + s;
+      const int idx = t * S + s;
+      if (u < 0 || u >= U) {
+        beta[idx] = NegInf();
+        continue;
+      }
+      if (t == T - 1 && u == U - 1) {
+        beta[idx] = logProbs[(idx << 1) + kSkip];
+        continue;
+      }
+      float b = NegInf();
+      if (t < T - 1) { // blank to (t + 1, u).
+        const int next = BandIndex(ranges, S, t + 1, u);
+        if (next >= 0) {
+          b = beta[(t + 1) * S + next] + logProbs[(idx << 1) + kSkip];
+        }
+      }
+      if (u < U - 1 && s < S - 1) { // target to (t, u + 1).
+        b = LogAddExp(b, beta[idx + 1] + logProbs[(idx << 1) + kEmit]);
+      }
+      beta[idx] = b;
+    }
+  }
+  return ranges[0] == 0 ? beta[0] : NegInf();
+}
+
+// Gradient of the cost with regard to logits(t, s, d), when the log softmax
+// over the classes is computed within the loss (denom is its denominator).
+// target is the target at u, ignored at u == U - 1.
+FORCE_INLINE HOST_AND_DEVICE float ComputeGradient(
+    float logit,
+    int d,
+    int t,
+    int s,
+    int T,
+    int U,
+    int S,
+    int blank,
+    int target,
+    float clamp,
+    float cost,
+    const int* ranges,
+    const float* denom,
+    const float* alpha,
+    const float* beta) {
+  const int u = ranges[t] + s;
+  // Padding, or no path.
+  if (t >= T || u < 0 || u >= U || !(cost < INFINITY)) {
+    return 0;
+  }
+  const int idx = t * S + s;
+  const float g = logit + alpha[idx] + cost - denom[idx];
+  float grad = expf(g + beta[idx]);
+  if (d == blank) {
+    if (t == T - 1 && u == U - 1) { // last blank transition.
+      grad -= expf(g);
+    } else if (t < T - 1) {
+      const int next = BandIndex(ranges, S, t + 1, u);
+      if (next >= 0) {
+        grad -= expf(g + beta[(t + 1) * S + next]);
+      }
+    }
+  } else if (u < U - 1 && s < S - 1 && d == target) {
+    grad -= expf(g + beta[idx + 1]);
+  }
+  if (clamp > 0) {
+    grad = fminf(fmaxf(grad, -clamp), clamp);
+  }
+  return grad;
+}
+
+} // namespace pruned
+} // namespace rnnt
+} // namespace torchaudio
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <ATen/record_function.h>
+#include <torchaudio/csrc/rnnt/options.h>
+
+namespace torchaudio {
+namespace rnnt {
+
+// The (B * H, max_T, max_U, D) sizes of the lattices, which the profiler
+// records as the inputs of the stages.
+inline std::vector<c10::IValue> ProfilerInputs(const Options& options) {
+  return {
+      static_cast<int64_t>(options.batchSize_ * options.nHypos_),
+      static_cast<int64_t>(options.maxSrcLen_),
+      static_cast<int64_t>(options.maxTgtLen_),
+      static_cast<int64_t>(options.numTargets_)};
+}
+
+} // namespace rnnt
+} // namespace torchaudio
+
+// Marks the rest of the scope as the stage `name` of the computation, for the
+// profiler. The inputs are only built while profiling with record_shapes, and
+// the range costs a check of a thread-local flag otherwise.
+#define RNNT_RECORD_STAGE(name, options) \
+  RECORD_FUNCTION(name, ::torchaudio::rnnt::ProfilerInputs(options))
@@ -15,6 +15,10 @@ typedef enum {
 
 typedef enum { UNDEFINED = 0, CPU = 1, GPU = 2 } device_t;
 
+// The kernel computing the alphas and the betas on GPU, see
+// gpu::UseDiagonalAlphasBetas.
+typedef enum { COUNTERS_KERNEL = 0, DIAGONAL_KERNEL = 1 } alphas_betas_kernel_t;
+
 const char* toString(status_t status);
 
 const char* toString(device_t device);
@@ -15,7 +15,7 @@ namespace rnnt {
 //     1. softmax denominators (in log form), size = B * max_T * max_U
 //     2. log probibility pairs for blank and target, size = B * max_T * max_U
 //     3. alphas, size = B * max_T * max_U
-//     4. betas, size = B * max_T * max_U
+//     4. betas, size = B * max_T * max_U, or 0 if options.scoreOnly_
 template <typename DTYPE>
 class DtypeWorkspace {
  public:
@@ -72,6 +72,9 @@ class DtypeWorkspace {
   }
 
   static int ComputeSizeForBetas(const Options& options) { // B * T * U
+    if (options.scoreOnly_) {
+      return 0;
+    }
     return options.BTU();
   }
 
@@ -82,7 +85,8 @@ class DtypeWorkspace {
 
 // IntWorkspace holds a "view" of workspace for:
 //     1. alpha counters, size = B * max_U
-//     2. beta counters, size = B * max_U
+//     2. beta counters, size = B * max_U, or 0 if options.scoreOnly_
+// Both are empty if options.diagonalAlphasBetas_, and then nothing is reset.
 class IntWorkspace {
  public:
   IntWorkspace() : options_(), size_(0), data_(nullptr) {}
@@ -118,24 +122,29 @@ class IntWorkspace {
   }
 
  private:
+  // On the stream of the kernels, since the memory may be reused from a
+  // previous call whose kernels are still running.
   inline void ResetAlphaBetaCounters() {
 #ifdef USE_CUDA
-    if (data_ != nullptr && options_.device_ == GPU) {
-      cudaMemset(
+    if (data_ != nullptr && options_.device_ == GPU &&
+        !options_.diagonalAlphasBetas_) {
+      cudaMemsetAsync(
           GetPointerToAlphaCounters(),
           0,
-          ComputeSizeForAlphaCounters(options_) * sizeof(int));
-      cudaMemset(
+          ComputeSizeForAlphaCounters(options_) * sizeof(int),
+          options_.stream_);
+      cudaMemsetAsync(
           GetPointerToBetaCounters(),
           0,
-          ComputeSizeForBetaCounters(options_) * sizeof(int));
+          ComputeSizeForBetaCounters(options_) * sizeof(int),
+          options_.stream_);
     }
 #endif // USE_CUDA
   }
 
   static int ComputeSizeForAlphaCounters(const Options& options) { // B * U
 #ifdef USE_CUDA
-    if (options.device_ == GPU) {
+    if (options.device_ == GPU && !options.diagonalAlphasBetas_) {
       return options.BU();
     } else {
       return 0;
@@ -146,7 +155,8 @@ class IntWorkspace {
   }
   static int ComputeSizeForBetaCounters(const Options& options) { // B * U
 #ifdef USE_CUDA
-    if (options.device_ == GPU) {
+    if (options.device_ == GPU && !options.scoreOnly_ &&
+        !options.diagonalAlphasBetas_) {
       return options.BU();
     } else {
       return 0;
@@ -0,0 +1,130 @@
+#include <torchaudio/csrc/rnnt/workspace_cache.h>
+
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace torchaudio {
+namespace rnnt {
+
+namespace {
+
+using Key = std::tuple<c10::DeviceType, c10::DeviceIndex, uintptr_t>;
+// The float and the int buffers.
+using Buffers = std::pair<torch::Tensor, torch::Tensor>;
+
+struct Cache {
+  std::mutex mutex;
+  std::map<Key, std::vector<Buffers>> free_buffers;
+  // Incremented by ReleaseCachedWorkspaces, so that the buffers acquired
+  // before are not put back.
+  int64_t generation = 0;
+};
+
+Cache& GetCache() {
+  // Leaked, so that the buffers returned during the static destruction do not
+  // use a destroyed cache.
+  static Cache* cache = new Cache();
+  return *cache;
+}
+
+bool IsCapturing(const Options& options) {
+#ifdef USE_CUDA
+  if (options.device_ == GPU) {
+    cudaStreamCaptureStatus status = cudaStreamCaptureStatusNone;
+    cudaStreamIsCapturing(options.stream_, &status);
+    return status != cudaStreamCaptureStatusNone;
+  }
+#endif // USE_CUDA
+  return false;
+}
+
+// Returns a tensor of at least size elements, reusing buffer if it is large
+// enough.
+torch::Tensor Grow(
+    const torch::Tensor& buffer,
+    int size,
+    const torch::Device& device,
+    torch::ScalarType dtype) {
+  if (buffer.defined() && buffer.numel() >= size) {
+    return buffer;
+  }
+  return torch::empty(
+      size, torch::TensorOptions().device(device).dtype(dtype));
+}
+
+} // namespace
+
+CachedWorkspace::CachedWorkspace(
+    const Options& options,
+    const torch::Device& device) {
+  uintptr_t stream = 0;
+#ifdef USE_CUDA
+  if (options.device_ == GPU) {
+    stream = reinterpret_cast<uintptr_t>(options.stream_);
+  }
+#endif // USE_CUDA
+  key_ = std::make_tuple(device.type(), device.index(), stream);
+
+  Buffers buffers;
+  generation_ = -1;
+  if (!IsCapturing(options)) {
+    Cache& cache = GetCache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    generation_ = cache.generation;
+    auto& free_buffers = cache.free_buffers[key_];
+    if (!free_buffers.empty()) {
+      buffers = std::move(free_buffers.back());
+      free_buffers.pop_back();
+    }
+  }
+  // The allocations, if any, are done out of the lock.
+  float_workspace_ = Grow(
+      buffers.first,
+      DtypeWorkspace<float>::ComputeSizeFromOptions(options),
+      device,
+      torch::ScalarType::Float);
+  int_workspace_ = Grow(
+      buffers.second,
+      IntWorkspace::ComputeSizeFromOptions(options),
+      device,
+      torch::ScalarType::Int);
+
+  workspace_.Reset(
+      /*options=*/options,
+      /*dtype_data=*/float_workspace_.data_ptr<float>(),
+      /*dtype_size=*/float_workspace_.numel(),
+      /*int_data=*/int_workspace_.data_ptr<int>(),
+      /*int_size=*/int_workspace_.numel());
+}
+
+CachedWorkspace::~CachedWorkspace() {
+  if (generation_ < 0) {
+    return;
+  }
+  Cache& cache = GetCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  if (cache.generation == generation_) {
+    cache.free_buffers[key_].emplace_back(
+        std::move(float_workspace_), std::move(int_workspace_));
+  }
+}
+
+void ReleaseCachedWorkspaces() {
+  std::map<Key, std::vector<Buffers>> free_buffers;
+  {
+    Cache& cache = GetCache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    free_buffers.swap(cache.free_buffers);
+    ++cache.generation;
+  }
+  // The buffers are freed here, out of the lock.
+}
+
+TORCH_LIBRARY_FRAGMENT(torchaudio, m) {
+  m.def("rnnt_loss_release_workspace", &ReleaseCachedWorkspaces);
+}
+
+} // namespace rnnt
+} // namespace torchaudio
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <torch/script.h>
+#include <torchaudio/csrc/rnnt/workspace.h>
+
+namespace torchaudio {
+namespace rnnt {
+
+// Workspace<float> over buffers borrowed from a process-wide cache, so that
+// consecutive calls reuse the memory of the previous ones instead of
+// allocating it anew.
+//
+// The cache holds a list of free buffers per device and, on GPU, per stream.
+// A buffer is taken out of its list for the lifetime of the CachedWorkspace,
+// so concurrent calls never share one, and put back afterwards. The buffers
+// only grow: one that is too small for the options is replaced by one of the
+// needed size. On GPU a buffer is put back while the kernels using it may
+// still be running, which is safe as the next call with the same key enqueues
+// its kernels after them, on the same stream.
+//
+// During the capture of a CUDA graph, the buffers are neither taken from nor
+// put in the cache: the allocations go to the memory pool of the graph, which
+// keeps using them at each replay.
+class CachedWorkspace {
+ public:
+  CachedWorkspace(const Options& options, const torch::Device& device);
+  ~CachedWorkspace();
+
+  CachedWorkspace(const CachedWorkspace&) = delete;
+  CachedWorkspace& operator=(const CachedWorkspace&) = delete;
+
+  const Workspace<float>& get() const {
+    return workspace_;
+  }
+
+ private:
+  std::tuple<c10::DeviceType, c10::DeviceIndex, uintptr_t> key_;
+  // Counter of the cache at the acquisition, see ReleaseCachedWorkspaces, or
+  // -1 if the buffers are not cached.
+  int64_t generation_;
+  torch::Tensor float_workspace_;
+  torch::Tensor int_workspace_;
+  Workspace<float> workspace_;
+};
+
+// Frees the buffers of the cache. The buffers in use are freed when they are
+// returned.
+void ReleaseCachedWorkspaces();
+
+} // namespace rnnt
+} // namespace torchaudio
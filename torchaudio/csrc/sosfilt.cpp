@@ -0,0 +1,227 @@
+#include <ATen/AccumulateType.h>
+#include <torch/script.h>
+#include <torch/torch.h>
+
+namespace {
+
+// Runs every row of `waveform` through the cascade of biquads described
+// by `sos`, in a single pass over the samples. Each section is evaluated
+// in direct form II transposed, and the state of all the sections is kept
+// locally, so that a sample goes through the whole cascade before the
+// next one is read.
+//
+// When `section_outputs` is not null, the output of every section is
+// written to it as well. It has shape `(n_sections, n_rows, n_samples)`.
+template <typename scalar_t>
+void host_sosfilt_forward(
+    const torch::Tensor& waveform,
+    const torch::Tensor& sos,
+    torch::Tensor& output,
+    torch::Tensor* section_outputs) {
+  int64_t n_rows = waveform.size(0);
+  int64_t n_samples = waveform.size(1);
+  int64_t n_sections = sos.size(0);
+  const scalar_t* input_data = waveform.data_ptr<scalar_t>();
+  const scalar_t* sos_data = sos.data_ptr<scalar_t>();
+  scalar_t* output_data = output.data_ptr<scalar_t>();
+  scalar_t* section_data =
+      section_outputs ? section_outputs->data_ptr<scalar_t>() : nullptr;
+
+  // Normalized coefficients, b0, b1, b2, a1, a2 for each section.
+  std::vector<scalar_t> coeffs(n_sections * 5);
+  for (int64_t i = 0; i < n_sections; i++) {
+    const scalar_t* s = sos_data + i * 6;
+    for (int64_t k = 0; k < 3; k++) {
+      coeffs[i * 5 + k] = s[k] / s[3];
+    }
+    coeffs[i * 5 + 3] = s[4] / s[3];
+    coeffs[i * 5 + 4] = s[5] / s[3];
+  }
+
+  at::parallel_for(0, n_rows, 1, [&](int64_t begin, int64_t end) {
+    std::vector<scalar_t> state(n_sections * 2);
+    for (int64_t i_row = begin; i_row < end; i_row++) {
+      std::fill(state.begin(), state.end(), scalar_t(0));
+      const scalar_t* x = input_data + i_row * n_samples;
+      scalar_t* y = output_data + i_row * n_samples;
+      for (int64_t i_sample = 0; i_sample < n_samples; i_sample++) {
+        scalar_t value = x[i_sample];
+        for (int64_t i = 0; i < n_sections; i++) {
+          const scalar_t* c = coeffs.data() + i * 5;
+          scalar_t* z = state.data() + i * 2;
+          scalar_t out = c[0] * value + z[0];
+          z[0] = c[1] * value - c[3] * out + z[1];
+          z[1] = c[2] * value - c[4] * out;
+          value = out;
+          if (section_data) {
+            section_data[(i * n_rows + i_row) * n_samples + i_sample] = out;
+          }
+        }
+        y[i_sample] = value;
+      }
+    }
+  });
+}
+
+// Back-propagates `grad` through the cascade, in place.
+//
+// For each section, from the last one to the first one, the adjoint of
+// the recursive part is computed with a reverse-time recurrence,
+//   a0 * q[n] = g[n] - a1 * q[n + 1] - a2 * q[n + 2],
+// from which the gradients are
+//   d/db_k = sum_n q[n] * u[n - k],
+//   d/da_k = - sum_n q[n] * y[n - k],
+//   d/du[n] = b0 * q[n] + b1 * q[n + 1] + b2 * q[n + 2],
+// where `u` and `y` are the input and the output of the section.
+template <typename scalar_t>
+void host_sosfilt_backward(
+    const torch::Tensor& waveform,
+    const torch::Tensor& sos,
+    const torch::Tensor& section_outputs,
+    torch::Tensor& grad,
+    torch::Tensor& grad_sos_partial) {
+  using acc_t = at::acc_type<scalar_t, /*is_cuda=*/false>;
+  int64_t n_rows = waveform.size(0);
+  int64_t n_samples = waveform.size(1);
+  int64_t n_sections = sos.size(0);
+  const scalar_t* input_data = waveform.data_ptr<scalar_t>();
+  const scalar_t* sos_data = sos.data_ptr<scalar_t>();
+  const scalar_t* section_data = section_outputs.data_ptr<scalar_t>();
+  scalar_t* grad_data = grad.data_ptr<scalar_t>();
+  // (n_rows, n_sections, 6)
+  scalar_t* partial_data = grad_sos_partial.data_ptr<scalar_t>();
+
+  at::parallel_for(0, n_rows, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t i_row = begin; i_row < end; i_row++) {
+      scalar_t* g = grad_data + i_row * n_samples;
+      for (int64_t i = n_sections - 1; i >= 0; i--) {
+        const scalar_t* s = sos_data + i * 6;
+        const scalar_t* u = i == 0
+            ? input_data + i_row * n_samples
+            : section_data + ((i - 1) * n_rows + i_row) * n_samples;
+        const scalar_t* y = section_data + (i * n_rows + i_row) * n_samples;
+
+        acc_t acc[6] = {0, 0, 0, 0, 0, 0};
+        scalar_t q1 = 0;
+        scalar_t q2 = 0;
+        for (int64_t n = n_samples - 1; n >= 0; n--) {
+          scalar_t q = (g[n] - s[4] * q1 - s[5] * q2) / s[3];
+          for (int64_t k = 0; k < 3 && k <= n; k++) {
+            acc[k] += q * u[n - k];
+            acc[3 + k] -= q * y[n - k];
+          }
+          g[n] = s[0] * q + s[1] * q1 + s[2] * q2;
+          q2 = q1;
+          q1 = q;
+        }
+        scalar_t* partial = partial_data + (i_row * n_sections + i) * 6;
+        for (int64_t k = 0; k < 6; k++) {
+          partial[k] = static_cast<scalar_t>(acc[k]);
+        }
+      }
+    }
+  });
+}
+
+class DifferentiableSOS : public torch::autograd::Function<DifferentiableSOS> {
+ public:
+  static torch::Tensor forward(
+      torch::autograd::AutogradContext* ctx,
+      const torch::Tensor& waveform,
+      const torch::Tensor& sos) {
+    auto x = waveform.contiguous();
+    auto coeffs = sos.contiguous();
+    auto output = torch::empty_like(x);
+
+    AT_DISPATCH_FLOATING_TYPES(x.scalar_type(), "sosfilt_forward", [&] {
+      host_sosfilt_forward<scalar_t>(x, coeffs, output, nullptr);
+    });
+
+    ctx->save_for_backward({x, coeffs});
+    return output;
+  }
+
+  // Note: The backward pass is computed by native kernels, so only
+  // first-order gradients are supported.
+  static torch::autograd::tensor_list backward(
+      torch::autograd::AutogradContext* ctx,
+      torch::autograd::tensor_list grad_outputs) {
+    auto saved = ctx->get_saved_variables();
+    auto x = saved[0];
+    auto sos = saved[1];
+
+    int64_t n_rows = x.size(0);
+    int64_t n_sections = sos.size(0);
+
+    // The input of every section is recomputed instead of being saved
+    // by the forward pass.
+    auto output = torch::empty_like(x);
+    auto section_outputs =
+        torch::empty({n_sections, n_rows, x.size(1)}, x.options());
+    auto grad = grad_outputs[0].contiguous().clone();
+    auto grad_sos_partial = torch::empty({n_rows, n_sections, 6}, x.options());
+
+    AT_DISPATCH_FLOATING_TYPES(x.scalar_type(), "sosfilt_backward", [&] {
+      host_sosfilt_forward<scalar_t>(x, sos, output, &section_outputs);
+      host_sosfilt_backward<scalar_t>(
+          x, sos, section_outputs, grad, grad_sos_partial);
+    });
+
+    auto dx = torch::Tensor();
+    auto dsos = torch::Tensor();
+    if (x.requires_grad()) {
+      dx = grad;
+    }
+    if (sos.requires_grad()) {
+      dsos = grad_sos_partial.sum(0);
+    }
+    return {dx, dsos};
+  }
+};
+
+torch::Tensor sosfilt_core(
+    const torch::Tensor& waveform,
+    const torch::Tensor& sos) {
+  TORCH_CHECK(waveform.device() == sos.device());
+  TORCH_CHECK(waveform.dtype() == sos.dtype());
+  TORCH_CHECK(
+      sos.dim() == 2 && sos.size(1) == 6,
+      "sos must have shape (n_sections, 6). Found: ",
+      sos.sizes());
+
+  TORCH_INTERNAL_ASSERT(waveform.dim() == 2);
+
+  if (waveform.device().is_cpu()) {
+    return DifferentiableSOS::apply(waveform, sos);
+  }
+
+  // On other devices, the sections are applied one at a time.
+  static auto lfilter =
+      c10::Dispatcher::singleton()
+          .findSchemaOrThrow("torchaudio::_lfilter", "")
+          .typed<torch::Tensor(
+              const torch::Tensor&,
+              const torch::Tensor&,
+              const torch::Tensor&,
+              bool)>();
+  using torch::indexing::Slice;
+  auto output = waveform.unsqueeze(1);
+  for (int64_t i = 0; i < sos.size(0); i++) {
+    output = lfilter.call(
+        output,
+        sos.index({Slice(i, i + 1), Slice(3, 6)}),
+        sos.index({Slice(i, i + 1), Slice(0, 3)}),
+        /*recompute_output=*/false);
+  }
+  return output.squeeze(1);
+}
+
+} // namespace
+
+TORCH_LIBRARY_FRAGMENT(torchaudio, m) {
+  m.def("torchaudio::_sosfilt(Tensor waveform, Tensor sos) -> Tensor");
+}
+
+TORCH_LIBRARY_IMPL(torchaudio, CompositeImplicitAutograd, m) {
+  m.impl("torchaudio::_sosfilt", sosfilt_core);
+}
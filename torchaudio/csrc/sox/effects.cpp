@@ -14,8 +14,14 @@ enum SoxEffectsResourceState { NotInitialized, Initialized, ShutDown };
 SoxEffectsResourceState SOX_RESOURCE_STATE = NotInitialized;
 std::mutex SOX_RESOUCE_STATE_MUTEX;
 
+// The most samples allocated up front by `decode_format` (64 MiB of float).
+constexpr int64_t kMaxPreallocatedSamples = 1 << 24;
+
 } // namespace
 
+// Called by the constructor of `SoxEffectsChain`, so that libsox is only
+// initialized when the first effects chain is created, and not when the
+// library is loaded.
 void initialize_sox_effects() {
   const std::lock_guard<std::mutex> lock(SOX_RESOUCE_STATE_MUTEX);
 
@@ -38,11 +44,12 @@ void shutdown_sox_effects() {
 
   switch (SOX_RESOURCE_STATE) {
     case NotInitialized:
-      throw std::runtime_error(
-          "SoX Effects is not initialized. Cannot shutdown.");
+      // No effects chain was created, so there is nothing to clean up.
+      SOX_RESOURCE_STATE = ShutDown;
+      break;
     case Initialized:
       if (sox_quit() != SOX_SUCCESS) {
-        throw std::runtime_error("Failed to initialize sox effects.");
+        throw std::runtime_error("Failed to shut down sox effects.");
       };
       SOX_RESOURCE_STATE = ShutDown;
     case ShutDown:
@@ -63,29 +70,29 @@ std::tuple<torch::Tensor, int64_t> apply_effects_tensor(
       /*input_encoding=*/get_tensor_encodinginfo(dtype),
       /*output_encoding=*/get_tensor_encodinginfo(dtype));
 
-  // Prepare output buffer
-  std::vector<sox_sample_t> out_buffer;
-  out_buffer.reserve(waveform.numel());
-
   // Build and run effects chain
   chain.addInputTensor(&waveform, sample_rate, channels_first);
   for (const auto& effect : effects) {
     chain.addEffect(effect);
   }
-  chain.addOutputBuffer(&out_buffer);
-  chain.run();
 
-  // Create tensor from buffer
-  auto out_tensor = convert_to_tensor(
-      /*buffer=*/out_buffer.data(),
-      /*num_samples=*/out_buffer.size(),
-      /*num_channels=*/chain.getOutputNumChannels(),
+  // The output is written directly into the resulting tensor
+  TensorOutputSink sink(
       dtype,
       /*noramlize=*/false,
-      channels_first);
+      channels_first,
+      /*num_channels=*/chain.getOutputNumChannels(),
+      /*num_frames=*/chain.getOutputNumFrames());
+  torchaudio::sox_effects_chain::OutputCallback callback =
+      [&](const sox_sample_t* samples, size_t num_samples) {
+        sink.write(samples, num_samples);
+        return true;
+      };
+  chain.addOutputCallback(&callback);
+  chain.run();
 
   return std::tuple<torch::Tensor, int64_t>(
-      out_tensor, chain.getOutputSampleRate());
+      sink.finalize(), chain.getOutputSampleRate());
 }
 
 std::tuple<torch::Tensor, int64_t> apply_effects_file(
@@ -103,36 +110,192 @@ std::tuple<torch::Tensor, int64_t> apply_effects_file(
 
   validate_input_file(sf, path);
 
-  const auto dtype = get_dtype(sf->encoding.encoding, sf->signal.precision);
+  return apply_effects_format(
+      sf, effects, normalize.value_or(true), channels_first.value_or(true));
+}
 
-  // Prepare output
-  std::vector<sox_sample_t> out_buffer;
-  out_buffer.reserve(sf->signal.length);
+std::tuple<torch::Tensor, int64_t> apply_effects_format(
+    sox_format_t* sf,
+    const std::vector<std::vector<std::string>>& effects,
+    bool normalize,
+    bool channels_first,
+    sox_uint64_t skipped_samples,
+    c10::optional<int64_t> buffer_size) {
+  const auto dtype = get_dtype(sf->encoding.encoding, sf->signal.precision);
 
-  // Create and run SoxEffectsChain
+  // Create SoxEffectsChain
   torchaudio::sox_effects_chain::SoxEffectsChain chain(
       /*input_encoding=*/sf->encoding,
       /*output_encoding=*/get_tensor_encodinginfo(dtype));
+  if (buffer_size.has_value()) {
+    chain.setBufferSize(buffer_size.value());
+  }
 
-  chain.addInputFile(sf);
+  chain.addInputFile(sf, skipped_samples);
   for (const auto& effect : effects) {
     chain.addEffect(effect);
   }
-  chain.addOutputBuffer(&out_buffer);
-  chain.run();
 
-  // Create tensor from buffer
-  bool channels_first_ = channels_first.value_or(true);
-  auto tensor = convert_to_tensor(
-      /*buffer=*/out_buffer.data(),
-      /*num_samples=*/out_buffer.size(),
-      /*num_channels=*/chain.getOutputNumChannels(),
+  // The output is written directly into the resulting tensor, which is
+  // allocated once when the length of the output is known (e.g. WAV, FLAC)
+  TensorOutputSink sink(
       dtype,
-      normalize.value_or(true),
-      channels_first_);
+      normalize,
+      channels_first,
+      /*num_channels=*/chain.getOutputNumChannels(),
+      /*num_frames=*/chain.getOutputNumFrames());
+  torchaudio::sox_effects_chain::OutputCallback callback =
+      [&](const sox_sample_t* samples, size_t num_samples) {
+        sink.write(samples, num_samples);
+        return true;
+      };
+  chain.addOutputCallback(&callback);
+  chain.run();
+
+  return std::tuple<torch::Tensor, int64_t>(
+      sink.finalize(), chain.getOutputSampleRate());
+}
+
+std::tuple<torch::Tensor, int64_t> decode_format(
+    sox_format_t* sf,
+    bool normalize,
+    bool channels_first,
+    int64_t num_frames,
+    sox_uint64_t skipped_samples,
+    c10::optional<int64_t> buffer_size) {
+  const auto dtype = get_dtype(sf->encoding.encoding, sf->signal.precision);
+  const int64_t num_channels = sf->signal.channels;
+  const bool length_known = sf->signal.length != SOX_UNSPEC &&
+      sf->signal.length != SOX_UNKNOWN_LEN;
+  int64_t expected_frames = length_known
+      ? static_cast<int64_t>(
+            (std::max(sf->signal.length, skipped_samples) - skipped_samples) /
+            num_channels)
+      : 0;
+  if (num_frames >= 0) {
+    expected_frames = length_known ? std::min(expected_frames, num_frames)
+                                   : num_frames;
+  }
+  // Neither the length in the header nor num_frames is trusted for the
+  // allocation, as the file can be shorter. The sink grows past it as the
+  // samples arrive.
+  expected_frames =
+      std::min(expected_frames, kMaxPreallocatedSamples / num_channels);
+  const int64_t max_samples =
+      num_frames >= 0 ? num_frames * num_channels : -1;
 
+  // Only one chunk of 32-bit samples exists at a time.
+  int64_t chunk_size = buffer_size.value_or(get_buffer_size());
+  chunk_size = std::max(chunk_size, num_channels);
+  chunk_size -= chunk_size % num_channels;
+  std::vector<sox_sample_t> chunk(chunk_size);
+
+  TensorOutputSink sink(
+      dtype, normalize, channels_first, num_channels, expected_frames);
+  int64_t num_samples = 0;
+  while (max_samples < 0 || num_samples < max_samples) {
+    const int64_t request = max_samples < 0
+        ? chunk_size
+        : std::min(chunk_size, max_samples - num_samples);
+    const size_t num_read = sox_read(sf, chunk.data(), request);
+    // Only when 0 sample is read, it is the end of file (or an error).
+    if (num_read == 0) {
+      break;
+    }
+    sink.write(chunk.data(), num_read);
+    num_samples += num_read;
+  }
   return std::tuple<torch::Tensor, int64_t>(
-      tensor, chain.getOutputSampleRate());
+      sink.finalize(), static_cast<int64_t>(sf->signal.rate));
+}
+
+PreparedEffects::PreparedEffects(
+    std::vector<std::vector<std::string>> effects,
+    int64_t sample_rate,
+    int64_t num_channels,
+    c10::ScalarType dtype,
+    bool channels_first,
+    c10::optional<int64_t> buffer_size)
+    : sample_rate_(sample_rate),
+      dtype_(c10::scalarTypeToTypeMeta(dtype)),
+      num_channels_(num_channels),
+      channels_first_(channels_first),
+      buffer_size_(buffer_size) {
+  TORCH_CHECK(
+      num_channels > 0,
+      "num_channels must be positive. Found: ",
+      num_channels);
+  auto empty = channels_first ? torch::empty({num_channels, 0}, dtype)
+                              : torch::empty({0, num_channels}, dtype);
+  validate_input_tensor(empty);
+
+  for (auto& effect : effects) {
+    effects_.emplace_back(
+        new sox_effects_chain::SoxParsedEffect(std::move(effect)));
+  }
+  // Invalid effects throw here rather than on the first call.
+  const auto chain = BuildChain(&empty);
+  output_sample_rate_ = chain->getOutputSampleRate();
+  output_num_channels_ = chain->getOutputNumChannels();
+}
+
+std::unique_ptr<sox_effects_chain::SoxEffectsChain> PreparedEffects::
+    BuildChain(torch::Tensor* waveform) const {
+  std::unique_ptr<sox_effects_chain::SoxEffectsChain> chain(
+      new sox_effects_chain::SoxEffectsChain(
+          /*input_encoding=*/get_tensor_encodinginfo(dtype_),
+          /*output_encoding=*/get_tensor_encodinginfo(dtype_)));
+  if (buffer_size_.has_value()) {
+    chain->setBufferSize(buffer_size_.value());
+  }
+  chain->addInputTensor(waveform, sample_rate_, channels_first_);
+  for (const auto& effect : effects_) {
+    chain->addEffect(*effect);
+  }
+  return chain;
+}
+
+std::tuple<torch::Tensor, int64_t> PreparedEffects::Apply(
+    torch::Tensor waveform) {
+  validate_input_tensor(waveform);
+  TORCH_CHECK(
+      waveform.dtype() == dtype_,
+      "Expected waveform of ",
+      dtype_,
+      " type. Found: ",
+      waveform.dtype());
+  TORCH_CHECK(
+      waveform.size(channels_first_ ? 0 : 1) == num_channels_,
+      "Expected waveform with ",
+      num_channels_,
+      " channels. Found: ",
+      waveform.size(channels_first_ ? 0 : 1));
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto chain = BuildChain(&waveform);
+  TensorOutputSink sink(
+      dtype_,
+      /*normalize=*/false,
+      channels_first_,
+      /*num_channels=*/output_num_channels_,
+      /*num_frames=*/chain->getOutputNumFrames());
+  sox_effects_chain::OutputCallback callback =
+      [&sink](const sox_sample_t* samples, size_t num_samples) {
+        sink.write(samples, num_samples);
+        return true;
+      };
+  chain->addOutputCallback(&callback);
+  chain->run();
+  return std::tuple<torch::Tensor, int64_t>(
+      sink.finalize(), output_sample_rate_);
+}
+
+int64_t PreparedEffects::GetOutputSampleRate() const {
+  return output_sample_rate_;
+}
+
+int64_t PreparedEffects::GetOutputNumChannels() const {
+  return output_num_channels_;
 }
 
 TORCH_LIBRARY_FRAGMENT(torchaudio, m) {
@@ -148,6 +311,17 @@ TORCH_LIBRARY_FRAGMENT(torchaudio, m) {
   m.def(
       "torchaudio::sox_effects_apply_effects_file",
       &torchaudio::sox_effects::apply_effects_file);
+  m.class_<PreparedEffects>("sox_effects_PreparedEffects")
+      .def(torch::init<
+           std::vector<std::vector<std::string>>,
+           int64_t,
+           int64_t,
+           c10::ScalarType,
+           bool,
+           c10::optional<int64_t>>())
+      .def("apply", &PreparedEffects::Apply)
+      .def("get_output_sample_rate", &PreparedEffects::GetOutputSampleRate)
+      .def("get_output_num_channels", &PreparedEffects::GetOutputNumChannels);
 }
 
 } // namespace sox_effects
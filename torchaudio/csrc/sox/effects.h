@@ -2,8 +2,12 @@
 #define TORCHAUDIO_SOX_EFFECTS_H
 
 #include <torch/script.h>
+#include <torchaudio/csrc/sox/effects_chain.h>
 #include <torchaudio/csrc/sox/utils.h>
 
+#include <memory>
+#include <mutex>
+
 namespace torchaudio {
 namespace sox_effects {
 
@@ -24,6 +28,77 @@ std::tuple<torch::Tensor, int64_t> apply_effects_file(
     c10::optional<bool> channels_first,
     const c10::optional<std::string>& format);
 
+/// Same as `apply_effects_file`, on a file opened for reading.
+/// `skipped_samples` is the number of samples skipped with `sox_seek`.
+/// `buffer_size`, if given, is passed to `SoxEffectsChain::setBufferSize`.
+std::tuple<torch::Tensor, int64_t> apply_effects_format(
+    sox_format_t* sf,
+    const std::vector<std::vector<std::string>>& effects,
+    bool normalize,
+    bool channels_first,
+    sox_uint64_t skipped_samples = 0,
+    c10::optional<int64_t> buffer_size = c10::nullopt);
+
+/// Same as `apply_effects_format` without effects, except that the first
+/// `num_frames` frames are loaded (all of them if negative), after the
+/// `skipped_samples` samples skipped with `sox_seek`. The samples are
+/// read with `sox_read` chunk by chunk, `buffer_size` samples at a time, and
+/// converted into the output Tensor. The Tensor is allocated with the final
+/// size when the length of the file is known (up to 2^24 samples), and grows
+/// as the samples arrive past it. So, unlike with an effects chain, only a
+/// chunk of 32-bit samples is in memory at a time, and no effect is started.
+std::tuple<torch::Tensor, int64_t> decode_format(
+    sox_format_t* sf,
+    bool normalize,
+    bool channels_first,
+    int64_t num_frames = -1,
+    sox_uint64_t skipped_samples = 0,
+    c10::optional<int64_t> buffer_size = c10::nullopt);
+
+/// Effects set up once for Tensors of a given signal spec, and applied to
+/// many Tensors.
+///
+/// The effects are looked up and their options are parsed once at
+/// construction (see `SoxParsedEffect`), and checked by building a chain for
+/// the given sample rate, number of channels and dtype, which also gives the
+/// sample rate and the number of channels of the output. `Apply` runs a
+/// chain of copies of the parsed effects, which are started and stopped on
+/// each call. The copies share the data of the parsed effects, such as the
+/// filters that sinc and fir compute when first started, so the calls are
+/// serialized. `buffer_size`, if given, is passed to
+/// `SoxEffectsChain::setBufferSize`.
+struct PreparedEffects : torch::CustomClassHolder {
+  PreparedEffects(
+      std::vector<std::vector<std::string>> effects,
+      int64_t sample_rate,
+      int64_t num_channels,
+      c10::ScalarType dtype,
+      bool channels_first,
+      c10::optional<int64_t> buffer_size);
+
+  /// Same as `apply_effects_tensor` with the effects, the sample rate and the
+  /// layout given at construction. `waveform` must have the dtype and the
+  /// number of channels given at construction.
+  std::tuple<torch::Tensor, int64_t> Apply(torch::Tensor waveform);
+  int64_t GetOutputSampleRate() const;
+  int64_t GetOutputNumChannels() const;
+
+ private:
+  // Builds the chain of the effects with `waveform` as input.
+  std::unique_ptr<sox_effects_chain::SoxEffectsChain> BuildChain(
+      torch::Tensor* waveform) const;
+
+  std::vector<std::unique_ptr<sox_effects_chain::SoxParsedEffect>> effects_;
+  const int64_t sample_rate_;
+  const caffe2::TypeMeta dtype_;
+  const int64_t num_channels_;
+  const bool channels_first_;
+  const c10::optional<int64_t> buffer_size_;
+  int64_t output_sample_rate_;
+  int64_t output_num_channels_;
+  std::mutex mutex_;
+};
+
 } // namespace sox_effects
 } // namespace torchaudio
 
@@ -1,7 +1,8 @@
+#include <ATen/record_function.h>
+#include <torchaudio/csrc/sox/effects.h>
 #include <torchaudio/csrc/sox/effects_chain.h>
 #include <torchaudio/csrc/sox/utils.h>
 
-using namespace torch::indexing;
 using namespace torchaudio::sox_utils;
 
 namespace torchaudio {
@@ -20,23 +21,98 @@ struct TensorInputPriv {
   torch::Tensor* waveform;
   int64_t sample_rate;
   bool channels_first;
+  size_t buffer_size;
+};
+struct FileInputPriv {
+  sox_format_t* sf;
+  size_t buffer_size;
 };
 struct TensorOutputPriv {
   std::vector<sox_sample_t>* buffer;
 };
+struct CallbackOutputPriv {
+  OutputCallback* callback;
+};
 struct FileOutputPriv {
   sox_format_t* sf;
 };
 
+template <typename T>
+sox_sample_t to_sox_sample(T value);
+
+template <>
+C10_ALWAYS_INLINE sox_sample_t to_sox_sample<float>(float value) {
+  // Computed in 64-bit precision so that values around INT32_MIN/MAX are
+  // handled correctly.
+  double v = static_cast<double>(value) * 2147483648.;
+  v = v < INT32_MIN ? INT32_MIN : v;
+  v = v > INT32_MAX ? INT32_MAX : v;
+  return static_cast<sox_sample_t>(v);
+}
+
+template <>
+C10_ALWAYS_INLINE sox_sample_t to_sox_sample<int32_t>(int32_t value) {
+  return value;
+}
+
+template <>
+C10_ALWAYS_INLINE sox_sample_t to_sox_sample<int16_t>(int16_t value) {
+  return static_cast<sox_sample_t>(value) * 65536;
+}
+
+template <>
+C10_ALWAYS_INLINE sox_sample_t to_sox_sample<uint8_t>(uint8_t value) {
+  return (static_cast<sox_sample_t>(value) - 128) * 16777216;
+}
+
+// Number of frames of a channel converted at a time for channels-first input.
+constexpr int64_t kInterleaveBlock = 256;
+
+/// Converts `num_frames` frames of `src`, which has `frame_stride` and
+/// `channel_stride` between consecutive frames and channels, into
+/// interleaved sox_sample_t.
+template <typename T>
+void interleave_samples(
+    const T* src,
+    int64_t num_frames,
+    int64_t num_channels,
+    int64_t frame_stride,
+    int64_t channel_stride,
+    sox_sample_t* dst) {
+  if (frame_stride == num_channels && channel_stride == 1) {
+    const int64_t n = num_frames * num_channels;
+    for (int64_t i = 0; i < n; ++i) {
+      dst[i] = to_sox_sample<T>(src[i]);
+    }
+    return;
+  }
+  for (int64_t f0 = 0; f0 < num_frames; f0 += kInterleaveBlock) {
+    const int64_t n = std::min(kInterleaveBlock, num_frames - f0);
+    for (int64_t c = 0; c < num_channels; ++c) {
+      const T* s = src + f0 * frame_stride + c * channel_stride;
+      sox_sample_t* d = dst + f0 * num_channels + c;
+      for (int64_t t = 0; t < n; ++t) {
+        d[t * num_channels] = to_sox_sample<T>(s[t * frame_stride]);
+      }
+    }
+  }
+}
+
 /// Callback function to feed Tensor data to SoxEffectChain.
 int tensor_input_drain(sox_effect_t* effp, sox_sample_t* obuf, size_t* osamp) {
   // Retrieve the input Tensor and current index
   auto priv = static_cast<TensorInputPriv*>(effp->priv);
-  auto index = priv->index;
-  auto tensor = *(priv->waveform);
-  auto num_channels = effp->out_signal.channels;
+  const auto index = priv->index;
+  const auto& tensor = *(priv->waveform);
+  const int64_t num_channels = effp->out_signal.channels;
 
   // Adjust the number of samples to read
+  // Limit to the buffer size of the chain, but read at least one frame.
+  if (priv->buffer_size) {
+    *osamp = std::min(
+        *osamp,
+        std::max<size_t>(priv->buffer_size, effp->out_signal.channels));
+  }
   const size_t num_samples = tensor.numel();
   if (index + *osamp > num_samples) {
     *osamp = num_samples - index;
@@ -44,51 +120,77 @@ int tensor_input_drain(sox_effect_t* effp, sox_sample_t* obuf, size_t* osamp) {
   // Ensure that it's a multiple of the number of channels
   *osamp -= *osamp % num_channels;
 
-  // Slice the input Tensor
-  auto chunk = [&]() {
-    auto i_frame = index / num_channels;
-    auto num_frames = *osamp / num_channels;
-    auto t = (priv->channels_first)
-        ? tensor.index({Slice(), Slice(i_frame, i_frame + num_frames)}).t()
-        : tensor.index({Slice(i_frame, i_frame + num_frames), Slice()});
-    return t.reshape({-1});
-  }();
-
-  // Convert to sox_sample_t (int32_t)
-  switch (chunk.dtype().toScalarType()) {
-    case c10::ScalarType::Float: {
-      // Need to convert to 64-bit precision so that
-      // values around INT32_MIN/MAX are handled correctly.
-      chunk = chunk.to(c10::ScalarType::Double);
-      chunk *= 2147483648.;
-      chunk.clamp_(INT32_MIN, INT32_MAX);
-      chunk = chunk.to(c10::ScalarType::Int);
+  // Convert the frames directly from the Tensor memory, whatever its strides.
+  const int64_t i_frame = index / num_channels;
+  const int64_t num_frames = *osamp / num_channels;
+  const int64_t frame_stride = tensor.stride(priv->channels_first ? 1 : 0);
+  const int64_t channel_stride = tensor.stride(priv->channels_first ? 0 : 1);
+  switch (tensor.scalar_type()) {
+    case c10::ScalarType::Float:
+      interleave_samples(
+          tensor.data_ptr<float>() + i_frame * frame_stride,
+          num_frames,
+          num_channels,
+          frame_stride,
+          channel_stride,
+          obuf);
       break;
-    }
-    case c10::ScalarType::Int: {
+    case c10::ScalarType::Int:
+      interleave_samples(
+          tensor.data_ptr<int32_t>() + i_frame * frame_stride,
+          num_frames,
+          num_channels,
+          frame_stride,
+          channel_stride,
+          obuf);
       break;
-    }
-    case c10::ScalarType::Short: {
-      chunk = chunk.to(c10::ScalarType::Int);
-      chunk *= 65536;
+    case c10::ScalarType::Short:
+      interleave_samples(
+          tensor.data_ptr<int16_t>() + i_frame * frame_stride,
+          num_frames,
+          num_channels,
+          frame_stride,
+          channel_stride,
+          obuf);
       break;
-    }
-    case c10::ScalarType::Byte: {
-      chunk = chunk.to(c10::ScalarType::Int);
-      chunk -= 128;
-      chunk *= 16777216;
+    case c10::ScalarType::Byte:
+      interleave_samples(
+          tensor.data_ptr<uint8_t>() + i_frame * frame_stride,
+          num_frames,
+          num_channels,
+          frame_stride,
+          channel_stride,
+          obuf);
       break;
-    }
     default:
       throw std::runtime_error("Unexpected dtype.");
   }
-  // Write to buffer
-  chunk = chunk.contiguous();
-  memcpy(obuf, chunk.data_ptr<int32_t>(), *osamp * 4);
   priv->index += *osamp;
   return (priv->index == num_samples) ? SOX_EOF : SOX_SUCCESS;
 }
 
+/// Callback function to read from sox_format_t. Same as "input" effect of
+/// libsox, except that the number of samples read at a time can be limited.
+/// https://github.com/dmkrepo/libsox/blob/b9dd1a86e71bbd62221904e3e59dfaa9e5e72046/src/input.c#L30-L48
+int file_input_drain(sox_effect_t* effp, sox_sample_t* obuf, size_t* osamp) {
+  auto priv = static_cast<FileInputPriv*>(effp->priv);
+  // Limit to the buffer size of the chain, but read at least one frame.
+  if (priv->buffer_size) {
+    *osamp = std::min(
+        *osamp,
+        std::max<size_t>(priv->buffer_size, effp->out_signal.channels));
+  }
+  // Ensure that it's a multiple of the number of channels
+  *osamp -= *osamp % effp->out_signal.channels;
+
+  // Read up to *osamp samples into obuf;
+  // store the actual number read back to *osamp
+  *osamp = sox_read(priv->sf, obuf, *osamp);
+
+  // Only when 0 sample is read, it is the end of file (or an error).
+  return *osamp ? SOX_SUCCESS : SOX_EOF;
+}
+
 /// Callback function to fetch data from SoxEffectChain.
 int tensor_output_flow(
     sox_effect_t* effp,
@@ -104,6 +206,23 @@ int tensor_output_flow(
   return SOX_SUCCESS;
 }
 
+/// Callback function to hand data from SoxEffectChain to a consumer.
+int callback_output_flow(
+    sox_effect_t* effp,
+    sox_sample_t const* ibuf,
+    sox_sample_t* obuf LSX_UNUSED,
+    size_t* isamp,
+    size_t* osamp) {
+  *osamp = 0;
+  if (*isamp) {
+    auto& callback = *static_cast<CallbackOutputPriv*>(effp->priv)->callback;
+    if (!callback(ibuf, *isamp)) {
+      return SOX_EOF;
+    }
+  }
+  return SOX_SUCCESS;
+}
+
 int file_output_flow(
     sox_effect_t* effp,
     sox_sample_t const* ibuf,
@@ -141,6 +260,21 @@ sox_effect_handler_t* get_tensor_input_handler() {
   return &handler;
 }
 
+sox_effect_handler_t* get_file_input_handler() {
+  static sox_effect_handler_t handler{
+      /*name=*/"input_file",
+      /*usage=*/NULL,
+      /*flags=*/SOX_EFF_MCHAN,
+      /*getopts=*/NULL,
+      /*start=*/NULL,
+      /*flow=*/NULL,
+      /*drain=*/file_input_drain,
+      /*stop=*/NULL,
+      /*kill=*/NULL,
+      /*priv_size=*/sizeof(FileInputPriv)};
+  return &handler;
+}
+
 sox_effect_handler_t* get_tensor_output_handler() {
   static sox_effect_handler_t handler{
       /*name=*/"output_tensor",
@@ -156,6 +290,21 @@ sox_effect_handler_t* get_tensor_output_handler() {
   return &handler;
 }
 
+sox_effect_handler_t* get_callback_output_handler() {
+  static sox_effect_handler_t handler{
+      /*name=*/"output_callback",
+      /*usage=*/NULL,
+      /*flags=*/SOX_EFF_MCHAN,
+      /*getopts=*/NULL,
+      /*start=*/NULL,
+      /*flow=*/callback_output_flow,
+      /*drain=*/NULL,
+      /*stop=*/NULL,
+      /*kill=*/NULL,
+      /*priv_size=*/sizeof(CallbackOutputPriv)};
+  return &handler;
+}
+
 sox_effect_handler_t* get_file_output_handler() {
   static sox_effect_handler_t handler{
       /*name=*/"output_file",
@@ -171,6 +320,81 @@ sox_effect_handler_t* get_file_output_handler() {
   return &handler;
 }
 
+sox_effects_chain_t* create_effects_chain(
+    sox_encodinginfo_t* input_encoding,
+    sox_encodinginfo_t* output_encoding) {
+  sox_effects::initialize_sox_effects();
+  return sox_create_effects_chain(input_encoding, output_encoding);
+}
+
+/// Finds the handler of `effect`, the name of an effect followed by its
+/// options.
+const sox_effect_handler_t* find_effect(
+    const std::vector<std::string>& effect) {
+  if (effect.size() == 0) {
+    throw std::runtime_error("Invalid argument: empty effect.");
+  }
+  const auto name = effect[0];
+  RECORD_FUNCTION(
+      "torchaudio::sox_effects::add_effect", std::vector<c10::IValue>({name}));
+  if (UNSUPPORTED_EFFECTS.find(name) != UNSUPPORTED_EFFECTS.end()) {
+    std::ostringstream stream;
+    stream << "Unsupported effect: " << name;
+    throw std::runtime_error(stream.str());
+  }
+
+  auto returned_effect = sox_find_effect(name.c_str());
+  if (!returned_effect) {
+    std::ostringstream stream;
+    stream << "Unsupported effect: " << name;
+    throw std::runtime_error(stream.str());
+  }
+  return returned_effect;
+}
+
+/// Parses the options of `effect` into `e`.
+void parse_options(sox_effect_t* e, const std::vector<std::string>& effect) {
+  const auto num_args = effect.size();
+  const auto num_options = num_args - 1;
+
+  std::vector<char*> opts;
+  for (size_t i = 1; i < num_args; ++i) {
+    opts.push_back((char*)effect[i].c_str());
+  }
+  if (sox_effect_options(e, num_options, num_options ? opts.data() : nullptr) !=
+      SOX_SUCCESS) {
+    std::ostringstream stream;
+    stream << "Invalid effect option:";
+    for (const auto& v : effect) {
+      stream << " " << v;
+    }
+    throw std::runtime_error(stream.str());
+  }
+}
+
+/// Adds `e`, created from `effect`, to `sec`.
+void add_effect(
+    sox_effects_chain_t* sec,
+    sox_effect_t* e,
+    sox_signalinfo_t* in,
+    const sox_signalinfo_t* out,
+    const std::vector<std::string>& effect) {
+  if (sox_add_effect(sec, e, in, out) != SOX_SUCCESS) {
+    std::ostringstream stream;
+    stream << "Internal Error: Failed to add effect: \"" << effect[0];
+    for (size_t i = 1; i < effect.size(); ++i) {
+      stream << " " << effect[i];
+    }
+    stream << "\"";
+    throw std::runtime_error(stream.str());
+  }
+}
+
+/// Kill handler of the copies of a SoxParsedEffect.
+int kill_copied_effect(sox_effect_t* /*effp*/) {
+  return SOX_SUCCESS;
+}
+
 } // namespace
 
 SoxEffect::SoxEffect(sox_effect_t* se) noexcept : se_(se) {}
@@ -189,6 +413,30 @@ sox_effect_t* SoxEffect::operator->() noexcept {
   return se_;
 }
 
+SoxParsedEffect::SoxParsedEffect(std::vector<std::string> effect)
+    : effect_(std::move(effect)) {
+  const auto handler = find_effect(effect_);
+  if (handler->flags & SOX_EFF_MCHAN) {
+    return;
+  }
+  sox_effect_t* e = sox_create_effect(handler);
+  try {
+    parse_options(e, effect_);
+  } catch (...) {
+    free(e);
+    throw;
+  }
+  se_ = e;
+}
+
+SoxParsedEffect::~SoxParsedEffect() {
+  if (se_ != nullptr) {
+    se_->handler.kill(se_);
+    free(se_->priv);
+    free(se_);
+  }
+}
+
 SoxEffectsChain::SoxEffectsChain(
     sox_encodinginfo_t input_encoding,
     sox_encodinginfo_t output_encoding)
@@ -197,7 +445,7 @@ SoxEffectsChain::SoxEffectsChain(
       in_sig_(),
       interm_sig_(),
       out_sig_(),
-      sec_(sox_create_effects_chain(&in_enc_, &out_enc_)) {
+      sec_(create_effects_chain(&in_enc_, &out_enc_)) {
   if (!sec_) {
     throw std::runtime_error("Failed to create effect chain.");
   }
@@ -209,7 +457,16 @@ SoxEffectsChain::~SoxEffectsChain() {
   }
 }
 
+void SoxEffectsChain::setBufferSize(int64_t buffer_size) {
+  TORCH_CHECK(
+      buffer_size > 0, "buffer_size must be positive. Found: ", buffer_size);
+  buffer_size_ = static_cast<size_t>(buffer_size);
+}
+
 void SoxEffectsChain::run() {
+  RECORD_FUNCTION(
+      "torchaudio::sox_effects::flow",
+      std::vector<c10::IValue>({static_cast<int64_t>(sec_->length)}));
   sox_flow_effects(sec_, NULL, NULL);
 }
 
@@ -225,6 +482,7 @@ void SoxEffectsChain::addInputTensor(
   priv->waveform = waveform;
   priv->sample_rate = sample_rate;
   priv->channels_first = channels_first;
+  priv->buffer_size = buffer_size_;
   if (sox_add_effect(sec_, e, &interm_sig_, &in_sig_) != SOX_SUCCESS) {
     throw std::runtime_error(
         "Internal Error: Failed to add effect: input_tensor");
@@ -241,12 +499,27 @@ void SoxEffectsChain::addOutputBuffer(
   }
 }
 
-void SoxEffectsChain::addInputFile(sox_format_t* sf) {
+void SoxEffectsChain::addOutputCallback(OutputCallback* callback) {
+  SoxEffect e(sox_create_effect(get_callback_output_handler()));
+  static_cast<CallbackOutputPriv*>(e->priv)->callback = callback;
+  if (sox_add_effect(sec_, e, &interm_sig_, &in_sig_) != SOX_SUCCESS) {
+    throw std::runtime_error(
+        "Internal Error: Failed to add effect: output_callback");
+  }
+}
+
+void SoxEffectsChain::addInputFile(
+    sox_format_t* sf,
+    sox_uint64_t skipped_samples) {
   in_sig_ = sf->signal;
+  if (in_sig_.length != SOX_UNSPEC && in_sig_.length != SOX_UNKNOWN_LEN) {
+    in_sig_.length -= std::min(in_sig_.length, skipped_samples);
+  }
   interm_sig_ = in_sig_;
-  SoxEffect e(sox_create_effect(sox_find_effect("input")));
-  char* opts[] = {(char*)sf};
-  sox_effect_options(e, 1, opts);
+  SoxEffect e(sox_create_effect(get_file_input_handler()));
+  auto priv = static_cast<FileInputPriv*>(e->priv);
+  priv->sf = sf;
+  priv->buffer_size = buffer_size_;
   if (sox_add_effect(sec_, e, &interm_sig_, &in_sig_) != SOX_SUCCESS) {
     std::ostringstream stream;
     stream << "Internal Error: Failed to add effect: input " << sf->filename;
@@ -266,49 +539,24 @@ void SoxEffectsChain::addOutputFile(sox_format_t* sf) {
 }
 
 void SoxEffectsChain::addEffect(const std::vector<std::string> effect) {
-  const auto num_args = effect.size();
-  if (num_args == 0) {
-    throw std::runtime_error("Invalid argument: empty effect.");
-  }
-  const auto name = effect[0];
-  if (UNSUPPORTED_EFFECTS.find(name) != UNSUPPORTED_EFFECTS.end()) {
-    std::ostringstream stream;
-    stream << "Unsupported effect: " << name;
-    throw std::runtime_error(stream.str());
-  }
-
-  auto returned_effect = sox_find_effect(name.c_str());
-  if (!returned_effect) {
-    std::ostringstream stream;
-    stream << "Unsupported effect: " << name;
-    throw std::runtime_error(stream.str());
-  }
-  SoxEffect e(sox_create_effect(returned_effect));
-  const auto num_options = num_args - 1;
+  SoxEffect e(sox_create_effect(find_effect(effect)));
+  parse_options(e, effect);
+  add_effect(sec_, e, &interm_sig_, &in_sig_, effect);
+}
 
-  std::vector<char*> opts;
-  for (size_t i = 1; i < num_args; ++i) {
-    opts.push_back((char*)effect[i].c_str());
+void SoxEffectsChain::addEffect(const SoxParsedEffect& effect) {
+  if (effect.se_ == nullptr) {
+    addEffect(effect.effect_);
+    return;
   }
-  if (sox_effect_options(e, num_options, num_options ? opts.data() : nullptr) !=
-      SOX_SUCCESS) {
-    std::ostringstream stream;
-    stream << "Invalid effect option:";
-    for (const auto& v : effect) {
-      stream << " " << v;
-    }
-    throw std::runtime_error(stream.str());
-  }
-
-  if (sox_add_effect(sec_, e, &interm_sig_, &in_sig_) != SOX_SUCCESS) {
-    std::ostringstream stream;
-    stream << "Internal Error: Failed to add effect: \"" << name;
-    for (size_t i = 1; i < num_args; ++i) {
-      stream << " " << effect[i];
-    }
-    stream << "\"";
-    throw std::runtime_error(stream.str());
+  const sox_effect_t* parsed = effect.se_;
+  SoxEffect e(sox_create_effect(&parsed->handler));
+  if (parsed->handler.priv_size) {
+    memcpy(e->priv, parsed->priv, parsed->handler.priv_size);
   }
+  // What the option parsing allocated belongs to `effect`, which kills it.
+  e->handler.kill = kill_copied_effect;
+  add_effect(sec_, e, &interm_sig_, &in_sig_, effect.effect_);
 }
 
 int64_t SoxEffectsChain::getOutputNumChannels() {
@@ -319,5 +567,14 @@ int64_t SoxEffectsChain::getOutputSampleRate() {
   return interm_sig_.rate;
 }
 
+int64_t SoxEffectsChain::getOutputNumFrames() {
+  const auto length = interm_sig_.length;
+  if (length == SOX_UNSPEC || length == SOX_UNKNOWN_LEN ||
+      interm_sig_.channels == 0) {
+    return 0;
+  }
+  return static_cast<int64_t>(length / interm_sig_.channels);
+}
+
 } // namespace sox_effects_chain
 } // namespace torchaudio
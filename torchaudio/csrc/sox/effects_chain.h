@@ -24,6 +24,37 @@ struct SoxEffect {
   sox_effect_t* se_;
 };
 
+// An effect whose options are parsed once, to be added to many chains by
+// `SoxEffectsChain::addEffect`.
+//
+// libsox runs an effect which processes the channels one by one on copies
+// of its private data taken after option parsing, one per channel, which
+// share what the option parsing allocated. Each copy is started and stopped,
+// and the effect is killed once. The chains are given such copies, so that
+// the effect is looked up and its options are parsed only once. An effect
+// which processes all the channels at once (SOX_EFF_MCHAN) is never copied
+// by libsox, and its start may rewrite its options, so it is created again
+// from its arguments for each chain.
+class SoxParsedEffect {
+ public:
+  explicit SoxParsedEffect(std::vector<std::string> effect);
+  SoxParsedEffect(const SoxParsedEffect& other) = delete;
+  SoxParsedEffect(const SoxParsedEffect&& other) = delete;
+  SoxParsedEffect& operator=(const SoxParsedEffect& other) = delete;
+  SoxParsedEffect& operator=(SoxParsedEffect&& other) = delete;
+  ~SoxParsedEffect();
+
+ private:
+  friend class SoxEffectsChain;
+  const std::vector<std::string> effect_;
+  // The parsed effect, or nullptr for SOX_EFF_MCHAN effects.
+  sox_effect_t* se_ = nullptr;
+};
+
+// Receives the samples coming out of the chain, one sox buffer at a time.
+// Returning false stops the chain. See SoxEffectsChain::addOutputCallback.
+using OutputCallback = std::function<bool(const sox_sample_t*, size_t)>;
+
 // Helper struct to safely close sox_effects_chain_t with handy methods
 class SoxEffectsChain {
   const sox_encodinginfo_t in_enc_;
@@ -34,6 +65,9 @@ class SoxEffectsChain {
   sox_signalinfo_t interm_sig_;
   sox_signalinfo_t out_sig_;
   sox_effects_chain_t* sec_;
+  // The maximum number of samples the input passes to the chain at a time, or
+  // 0 to use the buffer size of libsox. See `setBufferSize`.
+  size_t buffer_size_ = 0;
 
  public:
   explicit SoxEffectsChain(
@@ -44,17 +78,30 @@ class SoxEffectsChain {
   SoxEffectsChain& operator=(const SoxEffectsChain& other) = delete;
   SoxEffectsChain& operator=(SoxEffectsChain&& other) = delete;
   ~SoxEffectsChain();
+  // Makes this chain process at most `buffer_size` samples at a time, without
+  // changing the process-wide configuration of libsox, so that chains running
+  // concurrently can use different sizes. libsox allocates the buffers of the
+  // chain with its own buffer size (see `sox_utils::set_buffer_size`), which
+  // therefore bounds `buffer_size`. Must be called before adding the input.
+  void setBufferSize(int64_t buffer_size);
   void run();
   void addInputTensor(
       torch::Tensor* waveform,
       int64_t sample_rate,
       bool channels_first);
-  void addInputFile(sox_format_t* sf);
+  // `skipped_samples` is the number of samples already skipped with
+  // `sox_seek`, which is subtracted from the length of the signal.
+  void addInputFile(sox_format_t* sf, sox_uint64_t skipped_samples = 0);
   void addOutputBuffer(std::vector<sox_sample_t>* output_buffer);
+  void addOutputCallback(OutputCallback* callback);
   void addOutputFile(sox_format_t* sf);
   void addEffect(const std::vector<std::string> effect);
+  // Adds a copy of `effect`, which must outlive the chain.
+  void addEffect(const SoxParsedEffect& effect);
   int64_t getOutputNumChannels();
   int64_t getOutputSampleRate();
+  // The number of frames the chain is expected to output, or 0 if unknown.
+  int64_t getOutputNumFrames();
 };
 
 } // namespace sox_effects_chain
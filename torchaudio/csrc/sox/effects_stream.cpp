@@ -0,0 +1,162 @@
+#include <torchaudio/csrc/sox/effects_stream.h>
+
+using namespace torchaudio::sox_utils;
+
+namespace torchaudio {
+namespace sox_effects {
+
+StreamingEffectsReader::StreamingEffectsReader(
+    const std::string& path,
+    std::vector<std::vector<std::string>> effects,
+    int64_t frames_per_chunk,
+    c10::optional<bool> normalize,
+    c10::optional<bool> channels_first,
+    const c10::optional<std::string>& format,
+    int64_t num_buffered_chunks)
+    : sf_(sox_open_read(
+          path.c_str(),
+          /*signal=*/nullptr,
+          /*encoding=*/nullptr,
+          /*filetype=*/format.has_value() ? format.value().c_str() : nullptr)),
+      normalize_(normalize.value_or(true)),
+      channels_first_(channels_first.value_or(true)) {
+  TORCH_CHECK(
+      frames_per_chunk > 0,
+      "frames_per_chunk must be positive. Found: ",
+      frames_per_chunk);
+  TORCH_CHECK(
+      num_buffered_chunks > 0,
+      "num_buffered_chunks must be positive. Found: ",
+      num_buffered_chunks);
+  validate_input_file(sf_, path);
+
+  dtype_ = get_dtype(sf_->encoding.encoding, sf_->signal.precision);
+  chain_.reset(new sox_effects_chain::SoxEffectsChain(
+      /*input_encoding=*/sf_->encoding,
+      /*output_encoding=*/get_tensor_encodinginfo(dtype_)));
+  callback_ = [this](const sox_sample_t* samples, size_t num_samples) {
+    return consume(samples, num_samples);
+  };
+  chain_->addInputFile(sf_);
+  for (const auto& effect : effects) {
+    chain_->addEffect(effect);
+  }
+  chain_->addOutputCallback(&callback_);
+
+  sample_rate_ = chain_->getOutputSampleRate();
+  num_channels_ = chain_->getOutputNumChannels();
+  samples_per_chunk_ = frames_per_chunk * num_channels_;
+  num_buffered_chunks_ = num_buffered_chunks;
+  pending_.reserve(samples_per_chunk_);
+  worker_ = std::thread(&StreamingEffectsReader::run, this);
+}
+
+StreamingEffectsReader::~StreamingEffectsReader() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cancelled_ = true;
+  }
+  cv_.notify_all();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+}
+
+void StreamingEffectsReader::run() {
+  try {
+    chain_->run();
+    flush();
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    error_ = std::current_exception();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    done_ = true;
+  }
+  cv_.notify_all();
+}
+
+bool StreamingEffectsReader::consume(
+    const sox_sample_t* samples,
+    size_t num_samples) {
+  while (num_samples > 0) {
+    const size_t n =
+        std::min(num_samples, samples_per_chunk_ - pending_.size());
+    pending_.insert(pending_.end(), samples, samples + n);
+    samples += n;
+    num_samples -= n;
+    if (pending_.size() == samples_per_chunk_ && !flush()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool StreamingEffectsReader::flush() {
+  if (pending_.empty()) {
+    return true;
+  }
+  auto chunk = convert_to_tensor(
+      /*buffer=*/pending_.data(),
+      /*num_samples=*/pending_.size(),
+      /*num_channels=*/num_channels_,
+      dtype_,
+      normalize_,
+      channels_first_);
+  pending_.clear();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [this]() {
+    return cancelled_ || chunks_.size() < num_buffered_chunks_;
+  });
+  if (cancelled_) {
+    return false;
+  }
+  chunks_.push_back(std::move(chunk));
+  lock.unlock();
+  cv_.notify_all();
+  return true;
+}
+
+c10::optional<torch::Tensor> StreamingEffectsReader::Next() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [this]() { return done_ || !chunks_.empty(); });
+  if (!chunks_.empty()) {
+    auto chunk = std::move(chunks_.front());
+    chunks_.pop_front();
+    lock.unlock();
+    cv_.notify_all();
+    return chunk;
+  }
+  if (error_) {
+    std::rethrow_exception(error_);
+  }
+  return {};
+}
+
+int64_t StreamingEffectsReader::GetSampleRate() const {
+  return sample_rate_;
+}
+
+int64_t StreamingEffectsReader::GetNumChannels() const {
+  return num_channels_;
+}
+
+TORCH_LIBRARY_FRAGMENT(torchaudio, m) {
+  m.class_<StreamingEffectsReader>("sox_effects_StreamingEffectsReader")
+      .def(torch::init<
+           std::string,
+           std::vector<std::vector<std::string>>,
+           int64_t,
+           c10::optional<bool>,
+           c10::optional<bool>,
+           c10::optional<std::string>,
+           int64_t>())
+      .def("next", &StreamingEffectsReader::Next)
+      .def("get_sample_rate", &StreamingEffectsReader::GetSampleRate)
+      .def("get_num_channels", &StreamingEffectsReader::GetNumChannels);
+}
+
+} // namespace sox_effects
+} // namespace torchaudio
@@ -0,0 +1,76 @@
+#ifndef TORCHAUDIO_SOX_EFFECTS_STREAM_H
+#define TORCHAUDIO_SOX_EFFECTS_STREAM_H
+
+#include <torch/script.h>
+#include <torchaudio/csrc/sox/effects_chain.h>
+#include <torchaudio/csrc/sox/utils.h>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace torchaudio {
+namespace sox_effects {
+
+/// Applies effects to an audio file and hands out the result chunk by chunk.
+///
+/// libsox runs an effects chain to completion in `sox_flow_effects`, so the
+/// chain runs on a worker thread, and the output is cut into chunks of
+/// `frames_per_chunk` frames which are queued until `next` is called. The
+/// worker stops when `num_buffered_chunks` chunks are waiting, so the memory
+/// in use is bounded by the chunk size instead of the length of the file,
+/// and decoding proceeds while the caller processes the previous chunks.
+struct StreamingEffectsReader : torch::CustomClassHolder {
+  StreamingEffectsReader(
+      const std::string& path,
+      std::vector<std::vector<std::string>> effects,
+      int64_t frames_per_chunk,
+      c10::optional<bool> normalize,
+      c10::optional<bool> channels_first,
+      const c10::optional<std::string>& format,
+      int64_t num_buffered_chunks);
+  ~StreamingEffectsReader() override;
+
+  /// Returns the next chunk, or nothing after the last one. Every chunk has
+  /// `frames_per_chunk` frames, except the last one, which can be shorter.
+  /// Errors raised while decoding are rethrown here.
+  c10::optional<torch::Tensor> Next();
+  int64_t GetSampleRate() const;
+  int64_t GetNumChannels() const;
+
+ private:
+  void run();
+  // Called from the chain with its output.
+  bool consume(const sox_sample_t* samples, size_t num_samples);
+  // Converts the pending samples into a chunk and queues it.
+  bool flush();
+
+  sox_utils::SoxFormat sf_;
+  std::unique_ptr<sox_effects_chain::SoxEffectsChain> chain_;
+  sox_effects_chain::OutputCallback callback_;
+  caffe2::TypeMeta dtype_;
+  bool normalize_;
+  bool channels_first_;
+  int64_t sample_rate_;
+  int64_t num_channels_;
+  size_t samples_per_chunk_;
+  size_t num_buffered_chunks_;
+
+  // Only accessed by the worker.
+  std::vector<sox_sample_t> pending_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<torch::Tensor> chunks_;
+  std::exception_ptr error_;
+  bool done_ = false;
+  bool cancelled_ = false;
+  std::thread worker_;
+};
+
+} // namespace sox_effects
+} // namespace torchaudio
+
+#endif
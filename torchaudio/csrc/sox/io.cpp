@@ -3,6 +3,10 @@
 #include <torchaudio/csrc/sox/io.h>
 #include <torchaudio/csrc/sox/types.h>
 #include <torchaudio/csrc/sox/utils.h>
+#include <torchaudio/csrc/sox/wav.h>
+
+#include <atomic>
+#include <fstream>
 
 using namespace torch::indexing;
 using namespace torchaudio::sox_utils;
@@ -58,6 +62,126 @@ std::vector<std::vector<std::string>> get_effects(
   return effects;
 }
 
+namespace {
+
+// See `get_info_fileobj`.
+constexpr int64_t kDefaultHeaderCapacityInBytes = 4096;
+
+// Whether `sox_seek` on the file lands on the exact sample, so that seeking
+// gives the same result as trim. That is the case for uncompressed WAV and
+// FLAC. The MP3 handler of libsox seeks in whole MPEG frames (and without a
+// seek table, by scanning the headers), so MP3 and the other formats go
+// through trim.
+bool can_seek_exactly(sox_format_t* sf) {
+  if (!sf->seekable || sf->signal.length == SOX_UNSPEC ||
+      sf->signal.length == SOX_UNKNOWN_LEN) {
+    return false;
+  }
+  const std::string filetype = sf->filetype;
+  if (filetype == "flac") {
+    return true;
+  }
+  if (filetype == "wav") {
+    switch (sf->encoding.encoding) {
+      case SOX_ENCODING_SIGN2:
+      case SOX_ENCODING_UNSIGNED:
+      case SOX_ENCODING_FLOAT:
+        return true;
+      default:
+        return false;
+    }
+  }
+  return false;
+}
+
+// Calls `fn(i)` for i in [0, num_files) on the intra-op thread pool. Each file
+// gets its own sox objects, so the files are independent. Files are handed
+// out one at a time so that long files do not hold up the short ones; one
+// task is started per thread, up to `max_tasks` if it is positive.
+// Exceptions are propagated to the caller by `at::parallel_for`.
+template <typename Fn>
+void parallel_for_each_file(
+    int64_t num_files,
+    const Fn& fn,
+    int64_t max_tasks = 0) {
+  std::atomic<int64_t> next{0};
+  int64_t num_tasks = std::min<int64_t>(num_files, at::get_num_threads());
+  if (max_tasks > 0) {
+    num_tasks = std::min(num_tasks, max_tasks);
+  }
+  at::parallel_for(0, num_tasks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t i = next++; i < num_files; i = next++) {
+      fn(i);
+    }
+  });
+}
+
+// `load_audio_file` with the buffer size of the effects chain, which is not a
+// part of the public signature so that the TorchScript schema is unchanged.
+std::tuple<torch::Tensor, int64_t> load_audio_file_impl(
+    const std::string& path,
+    const c10::optional<int64_t>& frame_offset,
+    const c10::optional<int64_t>& num_frames,
+    c10::optional<bool> normalize,
+    c10::optional<bool> channels_first,
+    const c10::optional<std::string>& format,
+    const c10::optional<int64_t>& buffer_size) {
+  auto effects = get_effects(frame_offset, num_frames);
+
+  // PCM and floating point WAV files are read directly from a memory map.
+  if (!format.has_value() || format.value() == "wav") {
+    auto result = load_wav_mmap(
+        path,
+        frame_offset.value_or(0),
+        num_frames.value_or(-1),
+        normalize.value_or(true),
+        channels_first.value_or(true));
+    if (result.has_value()) {
+      return result.value();
+    }
+  }
+
+  SoxFormat sf(sox_open_read(
+      path.c_str(),
+      /*signal=*/nullptr,
+      /*encoding=*/nullptr,
+      /*filetype=*/format.has_value() ? format.value().c_str() : nullptr));
+
+  validate_input_file(sf, path);
+
+  // Seek to the first frame instead of decoding and discarding everything
+  // before it with trim, if it can be done exactly.
+  sox_uint64_t skipped_samples = 0;
+  const auto offset = frame_offset.value_or(0);
+  if (offset > 0 && can_seek_exactly(sf)) {
+    const auto num_samples = static_cast<sox_uint64_t>(offset) *
+        static_cast<sox_uint64_t>(sf->signal.channels);
+    if (sox_seek(sf, num_samples, SOX_SEEK_SET) == SOX_SUCCESS) {
+      skipped_samples = num_samples;
+      effects = get_effects(c10::nullopt, num_frames);
+    }
+  }
+  // Without trim, the file is decoded without an effects chain.
+  if (offset == 0 || skipped_samples > 0) {
+    return torchaudio::sox_effects::decode_format(
+        sf,
+        normalize.value_or(true),
+        channels_first.value_or(true),
+        num_frames.value_or(-1),
+        skipped_samples,
+        buffer_size);
+  }
+  return torchaudio::sox_effects::apply_effects_format(
+      sf,
+      effects,
+      normalize.value_or(true),
+      channels_first.value_or(true),
+      skipped_samples,
+      buffer_size);
+}
+
+} // namespace
+
 std::tuple<torch::Tensor, int64_t> load_audio_file(
     const std::string& path,
     const c10::optional<int64_t>& frame_offset,
@@ -65,28 +189,148 @@ std::tuple<torch::Tensor, int64_t> load_audio_file(
     c10::optional<bool> normalize,
     c10::optional<bool> channels_first,
     const c10::optional<std::string>& format) {
-  auto effects = get_effects(frame_offset, num_frames);
-  return torchaudio::sox_effects::apply_effects_file(
-      path, effects, normalize, channels_first, format);
+  return load_audio_file_impl(
+      path,
+      frame_offset,
+      num_frames,
+      normalize,
+      channels_first,
+      format,
+      /*buffer_size=*/c10::nullopt);
 }
 
-void save_audio_file(
+std::tuple<std::vector<torch::Tensor>, std::vector<int64_t>> load_audio_files(
+    const std::vector<std::string>& paths,
+    const c10::optional<std::vector<int64_t>>& frame_offsets,
+    const c10::optional<std::vector<int64_t>>& num_frames,
+    c10::optional<bool> normalize,
+    c10::optional<bool> channels_first,
+    const c10::optional<std::string>& format,
+    const c10::optional<int64_t>& buffer_size,
+    const c10::optional<int64_t>& num_threads) {
+  const int64_t num_files = paths.size();
+  TORCH_CHECK(
+      !frame_offsets.has_value() ||
+          static_cast<int64_t>(frame_offsets.value().size()) == num_files,
+      "The number of frame_offsets must match the number of paths. Found: ",
+      frame_offsets.value_or(std::vector<int64_t>{}).size(),
+      " and ",
+      num_files);
+  TORCH_CHECK(
+      !num_frames.has_value() ||
+          static_cast<int64_t>(num_frames.value().size()) == num_files,
+      "The number of num_frames must match the number of paths. Found: ",
+      num_frames.value_or(std::vector<int64_t>{}).size(),
+      " and ",
+      num_files);
+
+  TORCH_CHECK(
+      !num_threads.has_value() || num_threads.value() > 0,
+      "num_threads must be positive. Found: ",
+      num_threads.value_or(0));
+
+  std::vector<torch::Tensor> waveforms(num_files);
+  std::vector<int64_t> sample_rates(num_files);
+  parallel_for_each_file(
+      num_files,
+      [&](int64_t i) {
+        std::tie(waveforms[i], sample_rates[i]) = load_audio_file_impl(
+            paths[i],
+            frame_offsets.has_value()
+                ? c10::optional<int64_t>(frame_offsets.value()[i])
+                : c10::nullopt,
+            num_frames.has_value()
+                ? c10::optional<int64_t>(num_frames.value()[i])
+                : c10::nullopt,
+            normalize,
+            channels_first,
+            format,
+            buffer_size);
+      },
+      /*max_tasks=*/num_threads.value_or(0));
+  return std::make_tuple(std::move(waveforms), std::move(sample_rates));
+}
+
+std::tuple<int64_t, int64_t, int64_t, int64_t, std::string> get_info_header(
     const std::string& path,
-    torch::Tensor tensor,
+    const c10::optional<std::string>& format) {
+  // Only the beginning of the file is handed to libsox, so that the format
+  // handlers cannot scan the rest of the file to compute the length (MP3 and
+  // Vorbis do). See `get_info_fileobj` for the size of the header.
+  const auto capacity =
+      std::max<int64_t>(get_buffer_size(), kDefaultHeaderCapacityInBytes);
+  std::string buffer(capacity, '\0');
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    throw std::runtime_error(
+        "Error loading audio file: failed to open file " + path);
+  }
+  file.read(&buffer[0], capacity);
+  const auto num_read = static_cast<size_t>(file.gcount());
+  // If the file is shorter than 256, then libsox cannot read the header.
+  const auto buf_size = std::max<size_t>(num_read, 256);
+
+  const auto open = [&](const char* filetype) {
+    return sox_open_mem_read(
+        &buffer[0],
+        buf_size,
+        /*signal=*/nullptr,
+        /*encoding=*/nullptr,
+        filetype);
+  };
+  sox_format_t* fd =
+      open(format.has_value() ? format.value().c_str() : nullptr);
+  // Without a file name, libsox detects the format only from the content,
+  // which does not work for MP3 without ID3 tag, so fall back to the
+  // extension as `sox_open_read` does.
+  const auto dot = path.find_last_of('.');
+  const auto slash = path.find_last_of('/');
+  if (fd == nullptr && !format.has_value() && dot != std::string::npos &&
+      (slash == std::string::npos || dot > slash)) {
+    fd = open(get_filetype(path).c_str());
+  }
+  SoxFormat sf(fd);
+
+  validate_input_file(sf, path);
+
+  return std::make_tuple(
+      static_cast<int64_t>(sf->signal.rate),
+      /*num_frames=*/int64_t{0},
+      static_cast<int64_t>(sf->signal.channels),
+      static_cast<int64_t>(sf->encoding.bits_per_sample),
+      get_encoding(sf->encoding.encoding));
+}
+
+std::vector<std::tuple<int64_t, int64_t, int64_t, int64_t, std::string>>
+get_info_files(
+    const std::vector<std::string>& paths,
+    const c10::optional<std::string>& format,
+    bool header_only) {
+  const int64_t num_files = paths.size();
+  std::vector<std::tuple<int64_t, int64_t, int64_t, int64_t, std::string>>
+      infos(num_files);
+  parallel_for_each_file(num_files, [&](int64_t i) {
+    infos[i] = header_only ? get_info_header(paths[i], format)
+                           : get_info_file(paths[i], format);
+  });
+  return infos;
+}
+
+std::string get_save_filetype(
+    const std::string& path,
+    const c10::optional<std::string>& format) {
+  if (format.has_value())
+    return format.value();
+  return get_filetype(path);
+}
+
+void validate_save_options(
+    const torch::Tensor& tensor,
     int64_t sample_rate,
     bool channels_first,
-    c10::optional<double> compression,
-    c10::optional<std::string> format,
-    c10::optional<std::string> encoding,
-    c10::optional<int64_t> bits_per_sample) {
+    const std::string& filetype) {
   validate_input_tensor(tensor);
 
-  const auto filetype = [&]() {
-    if (format.has_value())
-      return format.value();
-    return get_filetype(path);
-  }();
-
   if (filetype == "amr-nb") {
     const auto num_channels = tensor.size(channels_first ? 0 : 1);
     TORCH_CHECK(
@@ -103,10 +347,17 @@ void save_audio_file(
         sample_rate == 8000,
         "gsm format only supports a sampling rate of 8kHz.");
   }
+}
+
+void save_audio_file_with_encoding(
+    const std::string& path,
+    torch::Tensor tensor,
+    int64_t sample_rate,
+    bool channels_first,
+    const std::string& filetype,
+    const sox_encodinginfo_t& encoding_info) {
   const auto signal_info =
       get_signalinfo(&tensor, sample_rate, filetype, channels_first);
-  const auto encoding_info = get_encodinginfo_for_save(
-      filetype, tensor.dtype(), compression, encoding, bits_per_sample);
 
   SoxFormat sf(sox_open_write(
       path.c_str(),
@@ -129,11 +380,32 @@ void save_audio_file(
   chain.run();
 }
 
+void save_audio_file(
+    const std::string& path,
+    torch::Tensor tensor,
+    int64_t sample_rate,
+    bool channels_first,
+    c10::optional<double> compression,
+    c10::optional<std::string> format,
+    c10::optional<std::string> encoding,
+    c10::optional<int64_t> bits_per_sample) {
+  const auto filetype = get_save_filetype(path, format);
+  validate_save_options(tensor, sample_rate, channels_first, filetype);
+  const auto encoding_info = get_encodinginfo_for_save(
+      filetype, tensor.dtype(), compression, encoding, bits_per_sample);
+  save_audio_file_with_encoding(
+      path, tensor, sample_rate, channels_first, filetype, encoding_info);
+}
+
 TORCH_LIBRARY_FRAGMENT(torchaudio, m) {
   m.def("torchaudio::sox_io_get_info", &torchaudio::sox_io::get_info_file);
   m.def(
       "torchaudio::sox_io_load_audio_file",
       &torchaudio::sox_io::load_audio_file);
+  m.def(
+      "torchaudio::sox_io_load_audio_files",
+      &torchaudio::sox_io::load_audio_files);
+  m.def("torchaudio::sox_io_get_info_files", &torchaudio::sox_io::get_info_files);
   m.def(
       "torchaudio::sox_io_save_audio_file",
       &torchaudio::sox_io::save_audio_file);
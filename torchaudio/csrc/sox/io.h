@@ -15,6 +15,20 @@ std::tuple<int64_t, int64_t, int64_t, int64_t, std::string> get_info_file(
     const std::string& path,
     const c10::optional<std::string>& format);
 
+/// Same as `get_info_file`, but only the header of the file is parsed, so the
+/// number of frames is not known and set to 0.
+std::tuple<int64_t, int64_t, int64_t, int64_t, std::string> get_info_header(
+    const std::string& path,
+    const c10::optional<std::string>& format);
+
+/// Gets the information of multiple files in parallel with
+/// `get_info_header` if `header_only`, else `get_info_file`.
+std::vector<std::tuple<int64_t, int64_t, int64_t, int64_t, std::string>>
+get_info_files(
+    const std::vector<std::string>& paths,
+    const c10::optional<std::string>& format,
+    bool header_only);
+
 std::tuple<torch::Tensor, int64_t> load_audio_file(
     const std::string& path,
     const c10::optional<int64_t>& frame_offset,
@@ -23,6 +37,46 @@ std::tuple<torch::Tensor, int64_t> load_audio_file(
     c10::optional<bool> channels_first,
     const c10::optional<std::string>& format);
 
+/// Loads multiple files in parallel with `at::parallel_for`.
+/// `frame_offsets` and `num_frames`, when given, have one value per path and
+/// the same meaning as in `load_audio_file`. `buffer_size`, when given, is
+/// passed to `SoxEffectsChain::setBufferSize` of every file, and `num_threads`
+/// limits the number of files decoded at the same time. Returns the waveforms
+/// and their sample rates in the order of `paths`.
+std::tuple<std::vector<torch::Tensor>, std::vector<int64_t>> load_audio_files(
+    const std::vector<std::string>& paths,
+    const c10::optional<std::vector<int64_t>>& frame_offsets,
+    const c10::optional<std::vector<int64_t>>& num_frames,
+    c10::optional<bool> normalize,
+    c10::optional<bool> channels_first,
+    const c10::optional<std::string>& format,
+    const c10::optional<int64_t>& buffer_size,
+    const c10::optional<int64_t>& num_threads);
+
+/// Returns `format` if given, else the extension of `path`.
+std::string get_save_filetype(
+    const std::string& path,
+    const c10::optional<std::string>& format);
+
+/// Checks that `tensor` can be saved in `filetype`, which limits the number
+/// of channels and the sample rate of some formats.
+void validate_save_options(
+    const torch::Tensor& tensor,
+    int64_t sample_rate,
+    bool channels_first,
+    const std::string& filetype);
+
+/// Encodes `tensor` into a new file at `path`. The arguments must be already
+/// validated with `validate_save_options`, and `encoding_info` is the result
+/// of `get_encodinginfo_for_save` for them.
+void save_audio_file_with_encoding(
+    const std::string& path,
+    torch::Tensor tensor,
+    int64_t sample_rate,
+    bool channels_first,
+    const std::string& filetype,
+    const sox_encodinginfo_t& encoding_info);
+
 void save_audio_file(
     const std::string& path,
     torch::Tensor tensor,
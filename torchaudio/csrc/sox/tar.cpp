@@ -0,0 +1,244 @@
+#include <torchaudio/csrc/sox/effects.h>
+#include <torchaudio/csrc/sox/tar.h>
+#include <torchaudio/csrc/sox/utils.h>
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace torchaudio::sox_utils;
+
+namespace torchaudio {
+namespace sox_io {
+
+namespace {
+
+constexpr size_t kBlockSize = 512;
+
+// Offsets and lengths of the fields of a ustar header.
+constexpr size_t kNameOffset = 0;
+constexpr size_t kNameLength = 100;
+constexpr size_t kSizeOffset = 124;
+constexpr size_t kSizeLength = 12;
+constexpr size_t kChecksumOffset = 148;
+constexpr size_t kChecksumLength = 8;
+constexpr size_t kTypeOffset = 156;
+constexpr size_t kMagicOffset = 257;
+constexpr size_t kPrefixOffset = 345;
+constexpr size_t kPrefixLength = 155;
+
+size_t pad_to_block(uint64_t size) {
+  return (size + kBlockSize - 1) / kBlockSize * kBlockSize;
+}
+
+std::string parse_string(const uint8_t* field, size_t length) {
+  const auto end = std::find(field, field + length, 0);
+  return std::string(reinterpret_cast<const char*>(field), end - field);
+}
+
+// Octal, padded with spaces or NUL, or the base-256 encoding of GNU tar for
+// large values, flagged by the high bit of the first byte.
+uint64_t parse_number(const uint8_t* field, size_t length) {
+  uint64_t value = 0;
+  if (field[0] & 0x80) {
+    value = field[0] & 0x7f;
+    for (size_t i = 1; i < length; ++i) {
+      value = (value << 8) | field[i];
+    }
+    return value;
+  }
+  size_t i = 0;
+  while (i < length && field[i] == ' ') {
+    ++i;
+  }
+  for (; i < length && field[i] >= '0' && field[i] <= '7'; ++i) {
+    value = value * 8 + (field[i] - '0');
+  }
+  return value;
+}
+
+bool is_zero_block(const uint8_t* block) {
+  return std::all_of(
+      block, block + kBlockSize, [](uint8_t c) { return c == 0; });
+}
+
+// The checksum is the sum of the bytes of the header, with the checksum field
+// taken as spaces. Some old archivers summed signed chars.
+bool verify_checksum(const uint8_t* header) {
+  uint64_t sum = 0;
+  int64_t signed_sum = 0;
+  for (size_t i = 0; i < kBlockSize; ++i) {
+    const bool in_field =
+        i >= kChecksumOffset && i < kChecksumOffset + kChecksumLength;
+    const uint8_t c = in_field ? ' ' : header[i];
+    sum += c;
+    signed_sum += static_cast<int8_t>(c);
+  }
+  const auto expected = parse_number(header + kChecksumOffset, kChecksumLength);
+  return sum == expected || static_cast<uint64_t>(signed_sum) == expected;
+}
+
+// Reads the "path" and "size" records of a pax extended header, which apply
+// to the next member. Each record is "<length> <key>=<value>\n".
+void parse_pax_header(
+    const uint8_t* data,
+    size_t size,
+    std::string* path,
+    c10::optional<uint64_t>* member_size) {
+  const char* records = reinterpret_cast<const char*>(data);
+  size_t pos = 0;
+  while (pos < size) {
+    size_t length = 0;
+    size_t i = pos;
+    for (; i < size && records[i] >= '0' && records[i] <= '9'; ++i) {
+      length = length * 10 + (records[i] - '0');
+    }
+    if (i >= size || records[i] != ' ' || length <= i - pos + 1 ||
+        length > size - pos) {
+      return;
+    }
+    const std::string record(records + i + 1, pos + length - i - 2);
+    const auto eq = record.find('=');
+    if (eq != std::string::npos) {
+      const auto key = record.substr(0, eq);
+      if (key == "path") {
+        *path = record.substr(eq + 1);
+      } else if (key == "size") {
+        *member_size = std::stoull(record.substr(eq + 1));
+      }
+    }
+    pos += length;
+  }
+}
+
+} // namespace
+
+TarReader::TarReader(
+    const std::string& path,
+    c10::optional<bool> normalize,
+    c10::optional<bool> channels_first)
+    : path_(path),
+      normalize_(normalize.value_or(true)),
+      channels_first_(channels_first.value_or(true)),
+      file_(map_file(path)) {
+  if (!file_) {
+    throw std::runtime_error(
+        "Error loading tar archive: failed to open file " + path);
+  }
+  madvise(file_->data, file_->size, MADV_SEQUENTIAL);
+}
+
+c10::optional<TarReader::Member> TarReader::next_member() {
+  const auto base = static_cast<const uint8_t*>(file_->data);
+  std::string long_name;
+  c10::optional<uint64_t> pax_size;
+  // The end of the archive is marked by zero blocks, but archives cut at the
+  // end of the last member are accepted.
+  while (pos_ + kBlockSize <= file_->size) {
+    const uint8_t* header = base + pos_;
+    if (is_zero_block(header)) {
+      break;
+    }
+    if (!verify_checksum(header)) {
+      throw std::runtime_error(
+          "Error loading tar archive: invalid header at offset " +
+          std::to_string(pos_) + " of " + path_);
+    }
+    const uint64_t size =
+        pax_size.value_or(parse_number(header + kSizeOffset, kSizeLength));
+    const size_t data_pos = pos_ + kBlockSize;
+    if (size > file_->size - data_pos) {
+      throw std::runtime_error(
+          "Error loading tar archive: truncated member at offset " +
+          std::to_string(pos_) + " of " + path_);
+    }
+    pos_ = data_pos + pad_to_block(size);
+    const uint8_t* data = base + data_pos;
+
+    switch (header[kTypeOffset]) {
+      case 'L': // GNU long name of the next member
+        long_name = parse_string(data, size);
+        break;
+      case 'x': // pax extended header of the next member
+        parse_pax_header(data, size, &long_name, &pax_size);
+        break;
+      case '0':
+      case '\0':
+      case '7': { // regular file
+        std::string name = long_name;
+        if (name.empty()) {
+          name = parse_string(header + kNameOffset, kNameLength);
+          const auto prefix =
+              parse_string(header + kPrefixOffset, kPrefixLength);
+          if (memcmp(header + kMagicOffset, "ustar", 5) == 0 &&
+              !prefix.empty()) {
+            name = prefix + "/" + name;
+          }
+        }
+        return Member{std::move(name), data, static_cast<size_t>(size)};
+      }
+      default: // directories, links, pax global headers, ...
+        long_name.clear();
+        pax_size.reset();
+        break;
+    }
+  }
+  pos_ = file_->size;
+  return {};
+}
+
+c10::optional<std::tuple<std::string, torch::Tensor, int64_t>> TarReader::
+    Next() {
+  while (auto member = next_member()) {
+    const auto& name = member->name;
+    const auto slash = name.find_last_of('/');
+    const auto dot =
+        name.find('.', slash == std::string::npos ? 0 : slash + 1);
+    if (dot == std::string::npos) {
+      continue;
+    }
+    auto key = name.substr(0, dot);
+    const auto filetype = get_filetype(name);
+    if (filetype == "wav") {
+      auto result = load_wav_memory(
+          file_,
+          member->data,
+          member->size,
+          /*frame_offset=*/0,
+          /*num_frames=*/-1,
+          normalize_,
+          channels_first_);
+      if (result.has_value()) {
+        return std::make_tuple(
+            std::move(key),
+            std::get<0>(result.value()),
+            std::get<1>(result.value()));
+      }
+    }
+    if (sox_find_format(filetype.c_str(), sox_false) == nullptr) {
+      continue;
+    }
+    SoxFormat sf(sox_open_mem_read(
+        const_cast<uint8_t*>(member->data),
+        member->size,
+        /*signal=*/nullptr,
+        /*encoding=*/nullptr,
+        /*filetype=*/filetype.c_str()));
+    validate_input_file(sf, path_ + ":" + name);
+    auto result = torchaudio::sox_effects::decode_format(
+        sf, normalize_, channels_first_);
+    return std::make_tuple(
+        std::move(key), std::get<0>(result), std::get<1>(result));
+  }
+  return {};
+}
+
+TORCH_LIBRARY_FRAGMENT(torchaudio, m) {
+  m.class_<TarReader>("sox_io_TarReader")
+      .def(torch::init<std::string, c10::optional<bool>, c10::optional<bool>>())
+      .def("next", &TarReader::Next);
+}
+
+} // namespace sox_io
+} // namespace torchaudio
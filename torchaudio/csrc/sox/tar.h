@@ -0,0 +1,55 @@
+#ifndef TORCHAUDIO_SOX_TAR_H
+#define TORCHAUDIO_SOX_TAR_H
+
+#include <torch/script.h>
+#include <torchaudio/csrc/sox/wav.h>
+
+namespace torchaudio {
+namespace sox_io {
+
+/// Decodes the audio members of a tar archive one after another, without
+/// extracting them.
+///
+/// The archive is mapped in memory and its headers are walked in order, so
+/// the archive is read sequentially with a single open. WAV members are
+/// decoded as in `load_wav_mmap`, and the other members are handed to
+/// libsox with `sox_open_mem_read` from the mapped bytes. Members for which
+/// libsox has no format handler (judging by the extension, e.g. `.json` or
+/// `.txt` in WebDataset shards) are skipped.
+///
+/// The key of a member is its path up to the first dot of the file name,
+/// which is the convention of WebDataset for the members of a sample.
+///
+/// Supports ustar, GNU (long names) and pax (path and size records)
+/// archives. Tensors returned without conversion view the mapped archive,
+/// which is kept mapped while they are alive.
+struct TarReader : torch::CustomClassHolder {
+  TarReader(
+      const std::string& path,
+      c10::optional<bool> normalize,
+      c10::optional<bool> channels_first);
+
+  /// Returns the key, the waveform and the sample rate of the next audio
+  /// member, or nothing at the end of the archive.
+  c10::optional<std::tuple<std::string, torch::Tensor, int64_t>> Next();
+
+ private:
+  struct Member {
+    std::string name;
+    const uint8_t* data;
+    size_t size;
+  };
+  // Finds the next regular file and moves past it.
+  c10::optional<Member> next_member();
+
+  std::string path_;
+  bool normalize_;
+  bool channels_first_;
+  std::shared_ptr<MappedFile> file_;
+  size_t pos_ = 0;
+};
+
+} // namespace sox_io
+} // namespace torchaudio
+
+#endif
@@ -1,3 +1,4 @@
+#include <ATen/record_function.h>
 #include <c10/core/ScalarType.h>
 #include <sox.h>
 #include <torchaudio/csrc/sox/types.h>
@@ -26,43 +27,50 @@ int64_t get_buffer_size() {
   return sox_get_globals()->bufsiz;
 }
 
+// The handlers are linked into libsox, so the lists are built on the first
+// call and reused.
 std::vector<std::vector<std::string>> list_effects() {
-  std::vector<std::vector<std::string>> effects;
-  for (const sox_effect_fn_t* fns = sox_get_effect_fns(); *fns; ++fns) {
-    const sox_effect_handler_t* handler = (*fns)();
-    if (handler && handler->name) {
-      if (UNSUPPORTED_EFFECTS.find(handler->name) ==
-          UNSUPPORTED_EFFECTS.end()) {
-        effects.emplace_back(std::vector<std::string>{
-            handler->name,
-            handler->usage ? std::string(handler->usage) : std::string("")});
+  static const auto effects = [] {
+    std::vector<std::vector<std::string>> effects;
+    for (const sox_effect_fn_t* fns = sox_get_effect_fns(); *fns; ++fns) {
+      const sox_effect_handler_t* handler = (*fns)();
+      if (handler && handler->name) {
+        if (UNSUPPORTED_EFFECTS.find(handler->name) ==
+            UNSUPPORTED_EFFECTS.end()) {
+          effects.emplace_back(std::vector<std::string>{
+              handler->name,
+              handler->usage ? std::string(handler->usage) : std::string("")});
+        }
       }
     }
-  }
+    return effects;
+  }();
   return effects;
 }
 
-std::vector<std::string> list_write_formats() {
+namespace {
+
+std::vector<std::string> list_formats(bool write) {
   std::vector<std::string> formats;
   for (const sox_format_tab_t* fns = sox_get_format_fns(); fns->fn; ++fns) {
     const sox_format_handler_t* handler = fns->fn();
     for (const char* const* names = handler->names; *names; ++names) {
-      if (!strchr(*names, '/') && handler->write)
+      if (!strchr(*names, '/') && (write ? handler->write : handler->read))
         formats.emplace_back(*names);
     }
   }
   return formats;
 }
 
+} // namespace
+
+std::vector<std::string> list_write_formats() {
+  static const auto formats = list_formats(/*write=*/true);
+  return formats;
+}
+
 std::vector<std::string> list_read_formats() {
-  std::vector<std::string> formats;
-  for (const sox_format_tab_t* fns = sox_get_format_fns(); fns->fn; ++fns) {
-    const sox_format_handler_t* handler = fns->fn();
-    for (const char* const* names = handler->names; *names; ++names) {
-      if (!strchr(*names, '/') && handler->read)
-        formats.emplace_back(*names);
-    }
-  }
+  static const auto formats = list_formats(/*write=*/false);
   return formats;
 }
 
@@ -150,6 +158,164 @@ caffe2::TypeMeta get_dtype(
   return c10::scalarTypeToTypeMeta(dtype);
 }
 
+namespace {
+
+// Number of frames of a channel converted at a time for channels-first output.
+constexpr int64_t kConversionBlock = 256;
+// Buffers with fewer samples than this are converted by a single thread.
+constexpr int64_t kConversionGrainSize = 1 << 16;
+
+// Converts `num_frames` interleaved frames into `dst`, which has
+// `frame_stride` and `channel_stride` between consecutive frames and
+// channels. Deinterleaving into channels-first is done in the same pass.
+template <typename T>
+void convert_frames(
+    const sox_sample_t* src,
+    int64_t num_frames,
+    int64_t num_channels,
+    T* dst,
+    int64_t frame_stride,
+    int64_t channel_stride) {
+  const int64_t grain_size =
+      std::max<int64_t>(kConversionGrainSize / num_channels, 1);
+  at::parallel_for(0, num_frames, grain_size, [&](int64_t begin, int64_t end) {
+    if (frame_stride == num_channels && channel_stride == 1) {
+      // Channels-last or mono: the layout does not change.
+      const sox_sample_t* s = src + begin * num_channels;
+      T* d = dst + begin * num_channels;
+      const int64_t n = (end - begin) * num_channels;
+      for (int64_t i = 0; i < n; ++i) {
+        d[i] = convert_sample<T>(s[i]);
+      }
+      return;
+    }
+    // Channels-first: each channel of a block of frames is gathered while the
+    // block stays in cache, so that the output is written contiguously.
+    for (int64_t f0 = begin; f0 < end; f0 += kConversionBlock) {
+      const int64_t n = std::min(kConversionBlock, end - f0);
+      for (int64_t c = 0; c < num_channels; ++c) {
+        const sox_sample_t* s = src + f0 * num_channels + c;
+        T* d = dst + c * channel_stride + f0 * frame_stride;
+        for (int64_t t = 0; t < n; ++t) {
+          d[t * frame_stride] = convert_sample<T>(s[t * num_channels]);
+        }
+      }
+    }
+  });
+}
+
+// Converts interleaved samples starting at the sample `offset` into `dst`,
+// which has `frame_stride` and `channel_stride` between consecutive frames
+// and channels. The samples do not have to start or end on a frame boundary.
+template <typename T>
+void convert_samples(
+    const sox_sample_t* src,
+    int64_t num_samples,
+    int64_t offset,
+    int64_t num_channels,
+    T* dst,
+    int64_t frame_stride,
+    int64_t channel_stride) {
+  int64_t frame = offset / num_channels;
+  int64_t channel = offset % num_channels;
+  int64_t i = 0;
+  // Finish the frame left partially written by the previous call.
+  for (; channel != 0 && i < num_samples; ++i) {
+    dst[frame * frame_stride + channel * channel_stride] =
+        convert_sample<T>(src[i]);
+    if (++channel == num_channels) {
+      channel = 0;
+      ++frame;
+    }
+  }
+  const int64_t num_frames = (num_samples - i) / num_channels;
+  convert_frames(
+      src + i,
+      num_frames,
+      num_channels,
+      dst + frame * frame_stride,
+      frame_stride,
+      channel_stride);
+  i += num_frames * num_channels;
+  frame += num_frames;
+  for (channel = 0; i < num_samples; ++i, ++channel) {
+    dst[frame * frame_stride + channel * channel_stride] =
+        convert_sample<T>(src[i]);
+  }
+}
+
+// Converts samples into `dst`, a 2D float32, int32, int16 or uint8 Tensor
+// of either [channel, time] or [time, channel] shape.
+void convert_samples(
+    const sox_sample_t* src,
+    int64_t num_samples,
+    int64_t offset,
+    int64_t num_channels,
+    torch::Tensor& dst,
+    bool channels_first) {
+  const int64_t frame_stride = dst.stride(channels_first ? 1 : 0);
+  const int64_t channel_stride = dst.stride(channels_first ? 0 : 1);
+  switch (dst.scalar_type()) {
+    case torch::kFloat32:
+      convert_samples(
+          src,
+          num_samples,
+          offset,
+          num_channels,
+          dst.data_ptr<float>(),
+          frame_stride,
+          channel_stride);
+      break;
+    case torch::kInt32:
+      convert_samples(
+          src,
+          num_samples,
+          offset,
+          num_channels,
+          dst.data_ptr<int32_t>(),
+          frame_stride,
+          channel_stride);
+      break;
+    case torch::kInt16:
+      convert_samples(
+          src,
+          num_samples,
+          offset,
+          num_channels,
+          dst.data_ptr<int16_t>(),
+          frame_stride,
+          channel_stride);
+      break;
+    case torch::kUInt8:
+      convert_samples(
+          src,
+          num_samples,
+          offset,
+          num_channels,
+          dst.data_ptr<uint8_t>(),
+          frame_stride,
+          channel_stride);
+      break;
+    default:
+      throw std::runtime_error("Unsupported dtype.");
+  }
+}
+
+torch::ScalarType get_output_dtype(
+    const caffe2::TypeMeta dtype,
+    const bool normalize) {
+  if (normalize || dtype == torch::kFloat32) {
+    return torch::kFloat32;
+  }
+  if (dtype == torch::kInt32 || dtype == torch::kInt16 ||
+      dtype == torch::kUInt8) {
+    return dtype.toScalarType();
+  }
+  throw std::runtime_error("Unsupported dtype.");
+}
+
+} // namespace
+
 torch::Tensor convert_to_tensor(
     sox_sample_t* buffer,
     const int32_t num_samples,
@@ -157,39 +323,85 @@ torch::Tensor convert_to_tensor(
     const caffe2::TypeMeta dtype,
     const bool normalize,
     const bool channels_first) {
-  torch::Tensor t;
-  uint64_t dummy = 0;
-  SOX_SAMPLE_LOCALS;
-  if (normalize || dtype == torch::kFloat32) {
-    t = torch::empty(
-        {num_samples / num_channels, num_channels}, torch::kFloat32);
-    auto ptr = t.data_ptr<float_t>();
-    for (int32_t i = 0; i < num_samples; ++i) {
-      ptr[i] = SOX_SAMPLE_TO_FLOAT_32BIT(buffer[i], dummy);
-    }
-  } else if (dtype == torch::kInt32) {
-    t = torch::from_blob(
-            buffer, {num_samples / num_channels, num_channels}, torch::kInt32)
-            .clone();
-  } else if (dtype == torch::kInt16) {
-    t = torch::empty({num_samples / num_channels, num_channels}, torch::kInt16);
-    auto ptr = t.data_ptr<int16_t>();
-    for (int32_t i = 0; i < num_samples; ++i) {
-      ptr[i] = SOX_SAMPLE_TO_SIGNED_16BIT(buffer[i], dummy);
-    }
-  } else if (dtype == torch::kUInt8) {
-    t = torch::empty({num_samples / num_channels, num_channels}, torch::kUInt8);
-    auto ptr = t.data_ptr<uint8_t>();
-    for (int32_t i = 0; i < num_samples; ++i) {
-      ptr[i] = SOX_SAMPLE_TO_UNSIGNED_8BIT(buffer[i], dummy);
-    }
-  } else {
-    throw std::runtime_error("Unsupported dtype.");
+  RECORD_FUNCTION(
+      "torchaudio::sox_utils::convert_to_tensor",
+      std::vector<c10::IValue>({static_cast<int64_t>(num_samples)}));
+  const auto out_dtype = get_output_dtype(dtype, normalize);
+  const int64_t num_frames = num_samples / num_channels;
+  auto t = channels_first
+      ? torch::empty({num_channels, num_frames}, out_dtype)
+      : torch::empty({num_frames, num_channels}, out_dtype);
+  convert_samples(
+      buffer, num_frames * num_channels, 0, num_channels, t, channels_first);
+  return t;
+}
+
+TensorOutputSink::TensorOutputSink(
+    const caffe2::TypeMeta dtype,
+    const bool normalize,
+    const bool channels_first,
+    const int64_t num_channels,
+    const int64_t num_frames)
+    : dtype_(get_output_dtype(dtype, normalize)),
+      channels_first_(channels_first),
+      num_channels_(num_channels) {
+  TORCH_CHECK(num_channels > 0, "The number of channels must be positive.");
+  grow(num_frames);
+}
+
+void TensorOutputSink::grow(int64_t min_frames) {
+  if (min_frames <= capacity_ && tensor_.defined()) {
+    return;
+  }
+  const int64_t capacity =
+      tensor_.defined() ? std::max(min_frames, capacity_ * 2) : min_frames;
+  auto tensor = channels_first_
+      ? torch::empty({num_channels_, capacity}, dtype_)
+      : torch::empty({capacity, num_channels_}, dtype_);
+  const int64_t num_frames = num_samples_ / num_channels_ +
+      (num_samples_ % num_channels_ ? 1 : 0);
+  if (num_frames > 0) {
+    const int64_t time_dim = channels_first_ ? 1 : 0;
+    tensor.narrow(time_dim, 0, num_frames)
+        .copy_(tensor_.narrow(time_dim, 0, num_frames));
+  }
+  tensor_ = tensor;
+  capacity_ = capacity;
+}
+
+void TensorOutputSink::write(const sox_sample_t* samples, size_t num_samples) {
+  if (num_samples == 0) {
+    return;
+  }
+  RECORD_FUNCTION(
+      "torchaudio::sox_utils::convert_samples",
+      std::vector<c10::IValue>({static_cast<int64_t>(num_samples)}));
+  const int64_t end = num_samples_ + num_samples;
+  const int64_t num_frames =
+      end / num_channels_ + (end % num_channels_ ? 1 : 0);
+  if (num_frames > capacity_) {
+    // Start at 64k frames when the length is not known.
+    grow(std::max<int64_t>(num_frames, 65536));
   }
-  if (channels_first) {
-    t = t.transpose(1, 0);
+  convert_samples(
+      samples,
+      num_samples,
+      num_samples_,
+      num_channels_,
+      tensor_,
+      channels_first_);
+  num_samples_ = end;
+}
+
+torch::Tensor TensorOutputSink::finalize() {
+  RECORD_FUNCTION(
+      "torchaudio::sox_utils::finalize",
+      std::vector<c10::IValue>({num_samples_}));
+  const int64_t num_frames = num_samples_ / num_channels_;
+  if (num_frames == capacity_) {
+    return tensor_;
   }
-  return t.contiguous();
+  return tensor_.narrow(channels_first_ ? 1 : 0, 0, num_frames).contiguous();
 }
 
 const std::string get_filetype(const std::string path) {
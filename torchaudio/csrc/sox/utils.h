@@ -69,6 +69,45 @@ caffe2::TypeMeta get_dtype(
     const sox_encoding_t encoding,
     const unsigned precision);
 
+///
+/// Convert a sample in the same way as the SOX_SAMPLE_TO_FLOAT_32BIT,
+/// SOX_SAMPLE_TO_SIGNED_16BIT and SOX_SAMPLE_TO_UNSIGNED_8BIT macros of libsox,
+/// but branch-free and without counting the clipped samples, so that loops
+/// calling them are vectorized.
+template <typename T>
+T convert_sample(sox_sample_t sample);
+
+template <>
+C10_ALWAYS_INLINE float convert_sample<float>(sox_sample_t sample) {
+  const auto rounded = static_cast<int32_t>(
+      (static_cast<uint32_t>(sample) + 64u) & ~static_cast<uint32_t>(127));
+  return sample > SOX_SAMPLE_MAX - 64
+      ? 1.f
+      : static_cast<float>(rounded) * (1.f / 2147483648.f);
+}
+
+template <>
+C10_ALWAYS_INLINE int32_t convert_sample<int32_t>(sox_sample_t sample) {
+  return sample;
+}
+
+template <>
+C10_ALWAYS_INLINE int16_t convert_sample<int16_t>(sox_sample_t sample) {
+  const uint32_t offset = static_cast<uint32_t>(sample) ^ 0x80000000u;
+  const auto value = static_cast<uint16_t>((offset + (1u << 15)) >> 16);
+  return sample > SOX_SAMPLE_MAX - (1 << 15)
+      ? int16_t{32767}
+      : static_cast<int16_t>(value ^ 0x8000u);
+}
+
+template <>
+C10_ALWAYS_INLINE uint8_t convert_sample<uint8_t>(sox_sample_t sample) {
+  const uint32_t offset = static_cast<uint32_t>(sample) ^ 0x80000000u;
+  return sample > SOX_SAMPLE_MAX - (1 << 23)
+      ? uint8_t{255}
+      : static_cast<uint8_t>((offset + (1u << 23)) >> 24);
+}
+
 ///
 /// Convert sox_sample_t buffer to uint8/int16/int32/float32 Tensor
 /// NOTE: This function might modify the values in the input buffer to
@@ -92,6 +131,41 @@ torch::Tensor convert_to_tensor(
     const bool normalize,
     const bool channels_first);
 
+/// Writes sox_sample_t data into a Tensor of the target dtype and layout as
+/// it comes out of an effects chain, so that the samples are converted once
+/// and not buffered in between.
+/// When the number of frames is known in advance, the output Tensor is
+/// allocated once with the final size. Otherwise (or if the estimate turns
+/// out to be too small), the Tensor grows geometrically.
+class TensorOutputSink {
+ public:
+  /// @param dtype, normalize, channels_first Same as `convert_to_tensor`.
+  /// @param num_channels The number of channels of the incoming data.
+  /// @param num_frames The expected number of frames, or 0 if unknown.
+  TensorOutputSink(
+      const caffe2::TypeMeta dtype,
+      const bool normalize,
+      const bool channels_first,
+      const int64_t num_channels,
+      const int64_t num_frames);
+
+  /// Appends interleaved samples.
+  void write(const sox_sample_t* samples, size_t num_samples);
+
+  /// Returns the Tensor of the samples written so far.
+  torch::Tensor finalize();
+
+ private:
+  void grow(int64_t min_frames);
+
+  torch::ScalarType dtype_;
+  bool channels_first_;
+  int64_t num_channels_;
+  int64_t capacity_ = 0;
+  int64_t num_samples_ = 0;
+  torch::Tensor tensor_;
+};
+
 /// Extract extension from file path
 const std::string get_filetype(const std::string path);
 
@@ -0,0 +1,403 @@
+#include <torchaudio/csrc/sox/utils.h>
+#include <torchaudio/csrc/sox/wav.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+using namespace torchaudio::sox_utils;
+
+namespace torchaudio {
+namespace sox_io {
+
+namespace {
+
+constexpr uint16_t kFormatPCM = 1;
+constexpr uint16_t kFormatFloat = 3;
+constexpr uint16_t kFormatExtensible = 0xFFFE;
+// The part of the sub-format GUID of WAVE_FORMAT_EXTENSIBLE following the
+// format code, which is the same for PCM and floating point.
+constexpr uint8_t kSubFormatGuidSuffix[14] =
+    {0, 0, 0, 0, 0x10, 0, 0x80, 0, 0, 0xAA, 0, 0x38, 0x9B, 0x71};
+
+// Number of frames of a channel converted at a time for channels-first output.
+constexpr int64_t kConversionBlock = 256;
+// Buffers with fewer samples than this are converted by a single thread.
+constexpr int64_t kConversionGrainSize = 1 << 16;
+
+bool is_little_endian() {
+  const uint16_t value = 1;
+  return *reinterpret_cast<const uint8_t*>(&value) == 1;
+}
+
+uint16_t read_u16(const uint8_t* p) {
+  return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t read_u32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+      (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+struct WavHeader {
+  uint16_t format;
+  int64_t num_channels;
+  int64_t sample_rate;
+  int64_t bits_per_sample;
+  size_t data_offset;
+  int64_t num_frames;
+};
+
+/// Parses the RIFF header, up to the beginning of the data chunk.
+c10::optional<WavHeader> parse_header(const uint8_t* data, size_t size) {
+  if (size < 12 || memcmp(data, "RIFF", 4) != 0 ||
+      memcmp(data + 8, "WAVE", 4) != 0) {
+    return {};
+  }
+  WavHeader header{};
+  int64_t block_align = 0;
+  size_t pos = 12;
+  while (pos + 8 <= size) {
+    const uint8_t* chunk = data + pos;
+    const size_t chunk_size = read_u32(chunk + 4);
+    pos += 8;
+    if (memcmp(chunk, "fmt ", 4) == 0) {
+      if (chunk_size < 16 || chunk_size > size - pos) {
+        return {};
+      }
+      const uint8_t* fmt = data + pos;
+      header.format = read_u16(fmt);
+      header.num_channels = read_u16(fmt + 2);
+      header.sample_rate = read_u32(fmt + 4);
+      block_align = read_u16(fmt + 12);
+      header.bits_per_sample = read_u16(fmt + 14);
+      if (header.format == kFormatExtensible) {
+        // The container size has to match the valid bits.
+        if (chunk_size < 40 || read_u16(fmt + 18) != header.bits_per_sample ||
+            memcmp(fmt + 26, kSubFormatGuidSuffix, 14) != 0) {
+          return {};
+        }
+        header.format = read_u16(fmt + 24);
+      }
+      const bool supported = header.format == kFormatPCM
+          ? (header.bits_per_sample == 8 || header.bits_per_sample == 16 ||
+             header.bits_per_sample == 24 || header.bits_per_sample == 32)
+          : (header.format == kFormatFloat && header.bits_per_sample == 32);
+      if (!supported || header.num_channels == 0 || header.sample_rate == 0 ||
+          block_align != header.num_channels * header.bits_per_sample / 8) {
+        return {};
+      }
+    } else if (memcmp(chunk, "data", 4) == 0) {
+      if (block_align == 0) {
+        return {};
+      }
+      header.data_offset = pos;
+      // The size in the header is not always right (e.g. wav written as a
+      // stream), so it is capped by the size of the file.
+      const size_t data_size = std::min(chunk_size, size - pos);
+      header.num_frames = static_cast<int64_t>(data_size) / block_align;
+      return header;
+    }
+    // Chunks are aligned to 2 bytes.
+    const size_t padded_size = chunk_size + (chunk_size & 1);
+    if (padded_size > size - pos) {
+      return {};
+    }
+    pos += padded_size;
+  }
+  return {};
+}
+
+// Readers of a little endian sample at any alignment, as sox_sample_t.
+struct ReadU8 {
+  static constexpr int64_t kBytes = 1;
+  C10_ALWAYS_INLINE sox_sample_t operator()(const uint8_t* p) const {
+    return (static_cast<sox_sample_t>(p[0]) - 128) * (1 << 24);
+  }
+};
+
+struct ReadS16 {
+  static constexpr int64_t kBytes = 2;
+  C10_ALWAYS_INLINE sox_sample_t operator()(const uint8_t* p) const {
+    int16_t value;
+    memcpy(&value, p, sizeof(value));
+    return static_cast<sox_sample_t>(value) * (1 << 16);
+  }
+};
+
+struct ReadS24 {
+  static constexpr int64_t kBytes = 3;
+  C10_ALWAYS_INLINE sox_sample_t operator()(const uint8_t* p) const {
+    const int32_t value = static_cast<int32_t>(
+        static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+        (static_cast<uint32_t>(p[2]) << 16));
+    // Sign-extend from 24 bits.
+    return ((value ^ 0x800000) - 0x800000) * (1 << 8);
+  }
+};
+
+struct ReadS32 {
+  static constexpr int64_t kBytes = 4;
+  C10_ALWAYS_INLINE sox_sample_t operator()(const uint8_t* p) const {
+    sox_sample_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+  }
+};
+
+struct ReadF32 {
+  static constexpr int64_t kBytes = 4;
+  C10_ALWAYS_INLINE sox_sample_t operator()(const uint8_t* p) const {
+    float value;
+    memcpy(&value, p, sizeof(value));
+    // Same as SOX_FLOAT_32BIT_TO_SAMPLE, which clips to [-1, 1] and rounds.
+    const double scaled = value * (SOX_SAMPLE_MAX + 1.0);
+    if (scaled < 0) {
+      return scaled <= SOX_SAMPLE_MIN - 0.5
+          ? SOX_SAMPLE_MIN
+          : static_cast<sox_sample_t>(scaled - 0.5);
+    }
+    return scaled < SOX_SAMPLE_MAX + 0.5
+        ? static_cast<sox_sample_t>(scaled + 0.5)
+        : SOX_SAMPLE_MAX;
+  }
+};
+
+/// Converts `num_frames` interleaved frames of `Read::kBytes` bytes per
+/// sample into `dst`, which has `frame_stride` and `channel_stride` between
+/// consecutive frames and channels.
+template <typename Read, typename T, typename Convert>
+void convert_frames(
+    const uint8_t* src,
+    int64_t num_frames,
+    int64_t num_channels,
+    T* dst,
+    int64_t frame_stride,
+    int64_t channel_stride,
+    const Convert& convert) {
+  constexpr int64_t kBytes = Read::kBytes;
+  const int64_t grain_size =
+      std::max<int64_t>(kConversionGrainSize / num_channels, 1);
+  at::parallel_for(0, num_frames, grain_size, [&](int64_t begin, int64_t end) {
+    if (frame_stride == num_channels && channel_stride == 1) {
+      const uint8_t* s = src + begin * num_channels * kBytes;
+      T* d = dst + begin * num_channels;
+      const int64_t n = (end - begin) * num_channels;
+      for (int64_t i = 0; i < n; ++i) {
+        d[i] = convert(s + i * kBytes);
+      }
+      return;
+    }
+    for (int64_t f0 = begin; f0 < end; f0 += kConversionBlock) {
+      const int64_t n = std::min(kConversionBlock, end - f0);
+      for (int64_t c = 0; c < num_channels; ++c) {
+        const uint8_t* s = src + (f0 * num_channels + c) * kBytes;
+        T* d = dst + c * channel_stride + f0 * frame_stride;
+        for (int64_t t = 0; t < n; ++t) {
+          d[t * frame_stride] = convert(s + t * num_channels * kBytes);
+        }
+      }
+    }
+  });
+}
+
+/// Converts PCM or floating point samples into `dst` in the same way as
+/// libsox followed by `TensorOutputSink`.
+template <typename Read>
+void convert_pcm(
+    const uint8_t* src,
+    int64_t num_frames,
+    int64_t num_channels,
+    torch::Tensor& dst,
+    bool channels_first) {
+  const int64_t frame_stride = dst.stride(channels_first ? 1 : 0);
+  const int64_t channel_stride = dst.stride(channels_first ? 0 : 1);
+  const Read read;
+  switch (dst.scalar_type()) {
+    case torch::kFloat32:
+      convert_frames<Read>(
+          src,
+          num_frames,
+          num_channels,
+          dst.data_ptr<float>(),
+          frame_stride,
+          channel_stride,
+          [&](const uint8_t* p) { return convert_sample<float>(read(p)); });
+      break;
+    case torch::kInt32:
+      convert_frames<Read>(
+          src,
+          num_frames,
+          num_channels,
+          dst.data_ptr<int32_t>(),
+          frame_stride,
+          channel_stride,
+          [&](const uint8_t* p) { return convert_sample<int32_t>(read(p)); });
+      break;
+    case torch::kInt16:
+      convert_frames<Read>(
+          src,
+          num_frames,
+          num_channels,
+          dst.data_ptr<int16_t>(),
+          frame_stride,
+          channel_stride,
+          [&](const uint8_t* p) { return convert_sample<int16_t>(read(p)); });
+      break;
+    case torch::kUInt8:
+      convert_frames<Read>(
+          src,
+          num_frames,
+          num_channels,
+          dst.data_ptr<uint8_t>(),
+          frame_stride,
+          channel_stride,
+          [&](const uint8_t* p) { return convert_sample<uint8_t>(read(p)); });
+      break;
+    default:
+      throw std::runtime_error("Unsupported dtype.");
+  }
+}
+
+} // namespace
+
+MappedFile::~MappedFile() {
+  munmap(data, size);
+}
+
+std::shared_ptr<MappedFile> map_file(const std::string& path) {
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return nullptr;
+  }
+  std::shared_ptr<MappedFile> file;
+  struct stat st;
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+    void* data = mmap(
+        nullptr,
+        st.st_size,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE,
+        fd,
+        /*offset=*/0);
+    if (data != MAP_FAILED) {
+      file = std::make_shared<MappedFile>(data, st.st_size);
+    }
+  }
+  close(fd);
+  return file;
+}
+
+c10::optional<std::tuple<torch::Tensor, int64_t>> load_wav_mmap(
+    const std::string& path,
+    int64_t frame_offset,
+    int64_t num_frames,
+    bool normalize,
+    bool channels_first) {
+  const auto file = map_file(path);
+  if (!file) {
+    return {};
+  }
+  return load_wav_memory(
+      file,
+      static_cast<uint8_t*>(file->data),
+      file->size,
+      frame_offset,
+      num_frames,
+      normalize,
+      channels_first);
+}
+
+c10::optional<std::tuple<torch::Tensor, int64_t>> load_wav_memory(
+    const std::shared_ptr<MappedFile>& file,
+    const uint8_t* base,
+    size_t size,
+    int64_t frame_offset,
+    int64_t num_frames,
+    bool normalize,
+    bool channels_first) {
+  if (!is_little_endian()) {
+    return {};
+  }
+  const auto header = parse_header(base, size);
+  if (!header.has_value()) {
+    return {};
+  }
+
+  const int64_t num_channels = header->num_channels;
+  const int64_t bits = header->bits_per_sample;
+  const bool is_float = header->format == kFormatFloat;
+  const auto dtype = [&]() {
+    if (normalize || is_float) {
+      return torch::kFloat32;
+    }
+    switch (bits) {
+      case 8:
+        return torch::kUInt8;
+      case 16:
+        return torch::kInt16;
+      default: // Cast 24-bit to 32-bit.
+        return torch::kInt32;
+    }
+  }();
+
+  // Same as trim, the region is clipped by the end of the data.
+  const int64_t begin = std::min(frame_offset, header->num_frames);
+  const int64_t frames = num_frames < 0
+      ? header->num_frames - begin
+      : std::min(num_frames, header->num_frames - begin);
+  const int64_t bytes_per_sample = bits / 8;
+  const uint8_t* src = base + header->data_offset +
+      begin * num_channels * bytes_per_sample;
+
+  // The data can be used as is.
+  const bool same_values = !is_float && !normalize && bits != 24;
+  const bool same_layout = num_channels == 1 || !channels_first;
+  const bool aligned =
+      reinterpret_cast<uintptr_t>(src) % bytes_per_sample == 0;
+  if (same_values && same_layout && aligned && frames > 0) {
+    const std::vector<int64_t> sizes = channels_first
+        ? std::vector<int64_t>{num_channels, frames}
+        : std::vector<int64_t>{frames, num_channels};
+    auto tensor = torch::from_blob(
+        const_cast<uint8_t*>(src),
+        sizes,
+        [file](void*) {},
+        torch::TensorOptions().dtype(dtype));
+    return std::make_tuple(tensor, header->sample_rate);
+  }
+
+  auto tensor = channels_first
+      ? torch::empty({num_channels, frames}, dtype)
+      : torch::empty({frames, num_channels}, dtype);
+  if (is_float) {
+    convert_pcm<ReadF32>(src, frames, num_channels, tensor, channels_first);
+  } else {
+    switch (bits) {
+      case 8:
+        convert_pcm<ReadU8>(src, frames, num_channels, tensor, channels_first);
+        break;
+      case 16:
+        convert_pcm<ReadS16>(
+            src, frames, num_channels, tensor, channels_first);
+        break;
+      case 24:
+        convert_pcm<ReadS24>(
+            src, frames, num_channels, tensor, channels_first);
+        break;
+      default:
+        convert_pcm<ReadS32>(
+            src, frames, num_channels, tensor, channels_first);
+        break;
+    }
+  }
+  return std::make_tuple(tensor, header->sample_rate);
+}
+
+} // namespace sox_io
+} // namespace torchaudio
@@ -0,0 +1,63 @@
+#ifndef TORCHAUDIO_SOX_WAV_H
+#define TORCHAUDIO_SOX_WAV_H
+
+#include <torch/script.h>
+
+#include <memory>
+
+namespace torchaudio {
+namespace sox_io {
+
+/// Private, copy-on-write memory map of a whole file.
+struct MappedFile {
+  MappedFile(void* data, size_t size) : data(data), size(size) {}
+  MappedFile(const MappedFile& other) = delete;
+  MappedFile& operator=(const MappedFile& other) = delete;
+  ~MappedFile();
+
+  void* const data;
+  const size_t size;
+};
+
+/// Maps the regular file at `path`, or returns nullptr if it is empty or
+/// cannot be mapped.
+std::shared_ptr<MappedFile> map_file(const std::string& path);
+
+/// Loads a PCM (8, 16, 24 or 32-bit) or 32-bit floating point WAV file
+/// without libsox, from a memory map of the file.
+///
+/// The arguments and the result are the same as `load_audio_file`.
+/// Samples are converted in the same way as libsox, so floating point
+/// samples are clipped to [-1, 1] and rounded to 32-bit integer precision.
+/// The data chunk is capped by the size of the file when it is mapped, so a
+/// truncated file is loaded up to its last complete frame, as libsox does.
+/// When no conversion is needed (8, 16 or 32-bit PCM without normalization),
+/// the output is mono or `[time, channel]`, and the samples are aligned, the
+/// returned Tensor is a view of the mapped file. The mapping is private, so
+/// modifying the Tensor does not modify the file, but the file must not be
+/// truncated while the Tensor is alive.
+///
+/// Returns nothing if the file is not a WAV file of the supported formats or
+/// cannot be mapped, so that the caller falls back to libsox.
+c10::optional<std::tuple<torch::Tensor, int64_t>> load_wav_mmap(
+    const std::string& path,
+    int64_t frame_offset,
+    int64_t num_frames,
+    bool normalize,
+    bool channels_first);
+
+/// Same as `load_wav_mmap` on the `size` bytes at `base`, which are a part of
+/// `file`. Tensors viewing the data keep `file` alive.
+c10::optional<std::tuple<torch::Tensor, int64_t>> load_wav_memory(
+    const std::shared_ptr<MappedFile>& file,
+    const uint8_t* base,
+    size_t size,
+    int64_t frame_offset,
+    int64_t num_frames,
+    bool normalize,
+    bool channels_first);
+
+} // namespace sox_io
+} // namespace torchaudio
+
+#endif
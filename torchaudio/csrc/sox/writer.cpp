@@ -0,0 +1,107 @@
+#include <torchaudio/csrc/sox/io.h>
+#include <torchaudio/csrc/sox/writer.h>
+
+using namespace torchaudio::sox_utils;
+
+namespace torchaudio {
+namespace sox_io {
+namespace {
+
+int get_pool_size(int64_t num_threads) {
+  TORCH_CHECK(
+      num_threads > 0, "num_threads must be positive. Found: ", num_threads);
+  return static_cast<int>(num_threads);
+}
+
+// The schema of `save` has a Future return type, which cannot be inferred
+// from the signature of a method, so it is registered as a boxed operator
+// taking the writer as the first argument.
+void save_boxed(const c10::OperatorHandle& op, torch::jit::Stack* stack) {
+  auto args = torch::jit::pop(*stack, 9);
+  auto future = args[0].toCustomClass<AudioWriter>()->Save(
+      args[1].toStringRef(),
+      args[2].toTensor(),
+      args[3].toInt(),
+      args[4].toBool(),
+      args[5].toOptional<double>(),
+      args[6].toOptional<std::string>(),
+      args[7].toOptional<std::string>(),
+      args[8].toOptional<int64_t>());
+  torch::jit::push(*stack, c10::IValue(std::move(future)));
+}
+
+} // namespace
+
+AudioWriter::AudioWriter(int64_t num_threads)
+    : pool_(get_pool_size(num_threads)) {}
+
+AudioWriter::~AudioWriter() {
+  // The pool drops the pending tasks when it is destroyed.
+  Wait();
+}
+
+c10::intrusive_ptr<c10::ivalue::Future> AudioWriter::Save(
+    const std::string& path,
+    torch::Tensor tensor,
+    int64_t sample_rate,
+    bool channels_first,
+    c10::optional<double> compression,
+    c10::optional<std::string> format,
+    c10::optional<std::string> encoding,
+    c10::optional<int64_t> bits_per_sample) {
+  // Invalid arguments are reported by the caller, before anything is queued.
+  auto filetype = get_save_filetype(path, format);
+  validate_save_options(tensor, sample_rate, channels_first, filetype);
+  const auto encoding_info = get_encodinginfo(
+      filetype, tensor.dtype(), compression, encoding, bits_per_sample);
+
+  auto future = c10::make_intrusive<c10::ivalue::Future>(c10::NoneType::get());
+  pool_.run([=, filetype = std::move(filetype)]() {
+    try {
+      save_audio_file_with_encoding(
+          path, tensor, sample_rate, channels_first, filetype, encoding_info);
+    } catch (...) {
+      future->setError(std::current_exception());
+      return;
+    }
+    future->markCompleted(c10::IValue());
+  });
+  return future;
+}
+
+void AudioWriter::Wait() {
+  pool_.waitWorkComplete();
+}
+
+sox_encodinginfo_t AudioWriter::get_encodinginfo(
+    const std::string& filetype,
+    const caffe2::TypeMeta dtype,
+    const c10::optional<double>& compression,
+    const c10::optional<std::string>& encoding,
+    const c10::optional<int64_t>& bits_per_sample) {
+  EncodingKey key{
+      filetype, dtype.toScalarType(), compression, encoding, bits_per_sample};
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = encodings_.find(key);
+  if (it == encodings_.end()) {
+    it = encodings_
+             .emplace(
+                 std::move(key),
+                 get_encodinginfo_for_save(
+                     filetype, dtype, compression, encoding, bits_per_sample))
+             .first;
+  }
+  return it->second;
+}
+
+TORCH_LIBRARY_FRAGMENT(torchaudio, m) {
+  m.class_<AudioWriter>("sox_io_AudioWriter")
+      .def(torch::init<int64_t>())
+      .def("wait", &AudioWriter::Wait);
+  m.def(
+      "torchaudio::sox_io_AudioWriter_save(__torch__.torch.classes.torchaudio.sox_io_AudioWriter writer, str path, Tensor tensor, int sample_rate, bool channels_first, float? compression, str? format, str? encoding, int? bits_per_sample) -> Future(NoneType)",
+      torch::CppFunction::makeFromBoxedFunction<&save_boxed>());
+}
+
+} // namespace sox_io
+} // namespace torchaudio
@@ -0,0 +1,65 @@
+#ifndef TORCHAUDIO_SOX_WRITER_H
+#define TORCHAUDIO_SOX_WRITER_H
+
+#include <c10/core/thread_pool.h>
+#include <torch/script.h>
+#include <torchaudio/csrc/sox/utils.h>
+
+#include <map>
+#include <mutex>
+
+namespace torchaudio {
+namespace sox_io {
+
+/// Saves audio files in the background.
+///
+/// `Save` validates the arguments, then hands the encoding to a pool of
+/// `num_threads` threads and returns a Future which is completed when the
+/// file is written, or set to the error raised while writing it. The encoding
+/// parameters (`get_encodinginfo_for_save`) are resolved once per combination
+/// of format, dtype, compression, encoding and bits per sample.
+///
+/// The destructor waits for the files submitted so far.
+struct AudioWriter : torch::CustomClassHolder {
+  explicit AudioWriter(int64_t num_threads);
+  ~AudioWriter() override;
+
+  /// Same arguments as `save_audio_file`. The Tensor must not be modified
+  /// before the Future is completed.
+  c10::intrusive_ptr<c10::ivalue::Future> Save(
+      const std::string& path,
+      torch::Tensor tensor,
+      int64_t sample_rate,
+      bool channels_first,
+      c10::optional<double> compression,
+      c10::optional<std::string> format,
+      c10::optional<std::string> encoding,
+      c10::optional<int64_t> bits_per_sample);
+
+  /// Blocks until all the files submitted so far are written.
+  void Wait();
+
+ private:
+  sox_encodinginfo_t get_encodinginfo(
+      const std::string& filetype,
+      const caffe2::TypeMeta dtype,
+      const c10::optional<double>& compression,
+      const c10::optional<std::string>& encoding,
+      const c10::optional<int64_t>& bits_per_sample);
+
+  using EncodingKey = std::tuple<
+      std::string,
+      c10::ScalarType,
+      c10::optional<double>,
+      c10::optional<std::string>,
+      c10::optional<int64_t>>;
+
+  std::mutex mutex_;
+  std::map<EncodingKey, sox_encodinginfo_t> encodings_;
+  c10::ThreadPool pool_;
+};
+
+} // namespace sox_io
+} // namespace torchaudio
+
+#endif
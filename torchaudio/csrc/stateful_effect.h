@@ -0,0 +1,193 @@
+#pragma once
+
+#include <torch/script.h>
+#include <torch/torch.h>
+#include <torchaudio/csrc/cpu/capability.h>
+
+#include <array>
+
+#ifdef __CUDACC__
+#define TORCHAUDIO_HOST_DEVICE __host__ __device__
+#else
+#define TORCHAUDIO_HOST_DEVICE
+#endif
+
+namespace torchaudio {
+namespace effects {
+inline namespace TORCHAUDIO_CPU_CAPABILITY_NAMESPACE {
+
+// Per-sample effects with a per-channel state, such as overdrive, phaser or
+// flanger, are written as small functors of the following form, and are run
+// over `(n_channels, n_frames)` signals by `run_stateful_effect_cpu` and
+// `run_stateful_effect_cuda`.
+//
+//   template <typename scalar_t>
+//   struct Effect {
+//     // Number of input signals consumed frame by frame.
+//     static constexpr int64_t kNumInputs = ...;
+//     // Number of state values of one channel.
+//     int64_t state_size() const;
+//     // Consumes one frame of each input, updates the state of the channel
+//     // and returns one output frame. `i_frame` is the index of the frame
+//     // within the current call, starting from 0.
+//     TORCHAUDIO_HOST_DEVICE scalar_t operator()(
+//         StateView<scalar_t> state,
+//         const scalar_t* inputs,
+//         int64_t i_frame) const;
+//   };
+//
+// The state of all the channels is a `(n_channels, state_size)` tensor,
+// which is updated in place. An effect which only depends on its state, such
+// as overdrive, continues from where the previous call stopped. An effect
+// which also depends on `i_frame`, such as the delay and modulation
+// positions of phaser, restarts them at every call, so a signal split into
+// several calls is not processed as a whole.
+
+// The state of one channel. Its values are not necessarily contiguous, so
+// that the CPU runner can interleave the state of several channels.
+template <typename scalar_t>
+struct StateView {
+  scalar_t* data;
+  int64_t stride;
+
+  TORCHAUDIO_HOST_DEVICE scalar_t& operator[](int64_t i) const {
+    return data[i * stride];
+  }
+};
+
+template <size_t kNumInputs>
+void check_stateful_effect_args(
+    const std::array<torch::Tensor, kNumInputs>& inputs,
+    const torch::Tensor& state,
+    const torch::Tensor& output,
+    int64_t state_size) {
+  TORCH_CHECK(output.dim() == 2, "output must be a 2D tensor");
+  TORCH_CHECK(output.is_contiguous(), "output must be contiguous");
+  for (const auto& input : inputs) {
+    TORCH_CHECK(
+        input.sizes() == output.sizes(),
+        "inputs must have the same shape as output");
+    TORCH_CHECK(
+        input.device() == output.device(),
+        "inputs must be on the same device as output");
+    TORCH_CHECK(
+        input.scalar_type() == output.scalar_type(),
+        "inputs must have the same dtype as output");
+    TORCH_CHECK(input.is_contiguous(), "inputs must be contiguous");
+  }
+  TORCH_CHECK(
+      state.sizes() == torch::IntArrayRef({output.size(0), state_size}),
+      "state must have shape (",
+      output.size(0),
+      ", ",
+      state_size,
+      "). Found: ",
+      state.sizes());
+  TORCH_CHECK(
+      state.device() == output.device(),
+      "state must be on the same device as output");
+  TORCH_CHECK(
+      state.scalar_type() == output.scalar_type(),
+      "state must have the same dtype as output");
+  TORCH_CHECK(state.is_contiguous(), "state must be contiguous");
+}
+
+// Number of channels which are processed in lockstep by the CPU runner.
+constexpr int64_t kEffectLanes = 8;
+// Number of frames that are transposed into a channels-last tile at a time.
+constexpr int64_t kEffectBlock = 64;
+
+// Runs `effect` on CPU. Groups of `kEffectLanes` channels are dispatched to
+// the threads with `at::parallel_for`. Within a group, the frames and the
+// states of the channels are interleaved, so that the compiler can run the
+// functor on all the lanes with vector instructions.
+template <typename scalar_t, typename Effect>
+void run_stateful_effect_cpu(
+    const Effect& effect,
+    const std::array<torch::Tensor, Effect::kNumInputs>& inputs,
+    torch::Tensor& state,
+    torch::Tensor& output) {
+  constexpr int64_t kNumInputs = Effect::kNumInputs;
+  const int64_t state_size = effect.state_size();
+  check_stateful_effect_args(inputs, state, output, state_size);
+  TORCH_CHECK(output.device().is_cpu(), "output must be on CPU");
+
+  const int64_t n_channels = output.size(0);
+  const int64_t n_frames = output.size(1);
+  std::array<const scalar_t*, kNumInputs> input_data;
+  for (int64_t i = 0; i < kNumInputs; i++) {
+    input_data[i] = inputs[i].template data_ptr<scalar_t>();
+  }
+  scalar_t* state_data = state.data_ptr<scalar_t>();
+  scalar_t* output_data = output.data_ptr<scalar_t>();
+
+  const int64_t n_tiles = (n_channels + kEffectLanes - 1) / kEffectLanes;
+  at::parallel_for(0, n_tiles, 1, [&](int64_t begin, int64_t end) {
+    std::vector<scalar_t> state_tile(state_size * kEffectLanes);
+    scalar_t input_tile[kNumInputs][kEffectBlock][kEffectLanes];
+    scalar_t output_tile[kEffectBlock][kEffectLanes];
+
+    for (int64_t i_tile = begin; i_tile < end; i_tile++) {
+      const int64_t channel_begin = i_tile * kEffectLanes;
+      const int64_t n_lanes =
+          std::min(kEffectLanes, n_channels - channel_begin);
+
+      // Lanes past `n_lanes` run on zeros, and their results are dropped.
+      std::fill(state_tile.begin(), state_tile.end(), scalar_t(0));
+      std::fill(
+          &input_tile[0][0][0],
+          &input_tile[0][0][0] + kNumInputs * kEffectBlock * kEffectLanes,
+          scalar_t(0));
+      for (int64_t lane = 0; lane < n_lanes; lane++) {
+        const scalar_t* s = state_data + (channel_begin + lane) * state_size;
+        for (int64_t k = 0; k < state_size; k++) {
+          state_tile[k * kEffectLanes + lane] = s[k];
+        }
+      }
+
+      for (int64_t t0 = 0; t0 < n_frames; t0 += kEffectBlock) {
+        const int64_t n_block = std::min(kEffectBlock, n_frames - t0);
+        for (int64_t i = 0; i < kNumInputs; i++) {
+          for (int64_t lane = 0; lane < n_lanes; lane++) {
+            const scalar_t* x =
+                input_data[i] + (channel_begin + lane) * n_frames + t0;
+            for (int64_t t = 0; t < n_block; t++) {
+              input_tile[i][t][lane] = x[t];
+            }
+          }
+        }
+
+        for (int64_t t = 0; t < n_block; t++) {
+          for (int64_t lane = 0; lane < kEffectLanes; lane++) {
+            scalar_t x[kNumInputs];
+            for (int64_t i = 0; i < kNumInputs; i++) {
+              x[i] = input_tile[i][t][lane];
+            }
+            output_tile[t][lane] = effect(
+                StateView<scalar_t>{state_tile.data() + lane, kEffectLanes},
+                x,
+                t0 + t);
+          }
+        }
+
+        for (int64_t lane = 0; lane < n_lanes; lane++) {
+          scalar_t* y = output_data + (channel_begin + lane) * n_frames + t0;
+          for (int64_t t = 0; t < n_block; t++) {
+            y[t] = output_tile[t][lane];
+          }
+        }
+      }
+
+      for (int64_t lane = 0; lane < n_lanes; lane++) {
+        scalar_t* s = state_data + (channel_begin + lane) * state_size;
+        for (int64_t k = 0; k < state_size; k++) {
+          s[k] = state_tile[k * kEffectLanes + lane];
+        }
+      }
+    }
+  });
+}
+
+} // namespace TORCHAUDIO_CPU_CAPABILITY_NAMESPACE
+} // namespace effects
+} // namespace torchaudio
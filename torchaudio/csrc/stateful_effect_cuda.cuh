@@ -0,0 +1,82 @@
+#pragma once
+
+#include <ATen/cuda/CUDAContext.h>
+#include <c10/cuda/CUDAGuard.h>
+#include <torchaudio/csrc/stateful_effect.h>
+
+namespace torchaudio {
+namespace effects {
+
+template <typename scalar_t, int64_t kNumInputs>
+struct InputPointers {
+  const scalar_t* data[kNumInputs];
+};
+
+// One thread runs the effect over one channel. The state of the channel is
+// contiguous in global memory.
+template <typename scalar_t, typename Effect>
+__global__ void stateful_effect_kernel(
+    const Effect effect,
+    const InputPointers<scalar_t, Effect::kNumInputs> inputs,
+    scalar_t* __restrict__ state_data,
+    scalar_t* __restrict__ output_data,
+    int64_t n_channels,
+    int64_t n_frames,
+    int64_t state_size) {
+  constexpr int64_t kNumInputs = Effect::kNumInputs;
+  const int64_t i_channel = blockIdx.x * blockDim.x + threadIdx.x;
+  if (i_channel >= n_channels) {
+    return;
+  }
+  const StateView<scalar_t> state{state_data + i_channel * state_size, 1};
+  const int64_t offset = i_channel * n_frames;
+  for (int64_t i_frame = 0; i_frame < n_frames; i_frame++) {
+    scalar_t x[kNumInputs];
+#pragma unroll
+    for (int64_t i = 0; i < kNumInputs; i++) {
+      x[i] = inputs.data[i][offset + i_frame];
+    }
+    output_data[offset + i_frame] = effect(state, x, i_frame);
+  }
+}
+
+// Runs `effect` on the current CUDA stream.
+template <typename scalar_t, typename Effect>
+void run_stateful_effect_cuda(
+    const Effect& effect,
+    const std::array<torch::Tensor, Effect::kNumInputs>& inputs,
+    torch::Tensor& state,
+    torch::Tensor& output) {
+  constexpr int kThreadsPerBlock = 64;
+  const int64_t state_size = effect.state_size();
+  check_stateful_effect_args(inputs, state, output, state_size);
+  TORCH_CHECK(output.device().is_cuda(), "output must be on CUDA device");
+
+  const int64_t n_channels = output.size(0);
+  const int64_t n_frames = output.size(1);
+  if (n_channels == 0 || n_frames == 0) {
+    return;
+  }
+
+  InputPointers<scalar_t, Effect::kNumInputs> input_data;
+  for (int64_t i = 0; i < Effect::kNumInputs; i++) {
+    input_data.data[i] = inputs[i].template data_ptr<scalar_t>();
+  }
+
+  const c10::cuda::CUDAGuard device_guard(output.device());
+  const dim3 threads(kThreadsPerBlock);
+  const dim3 blocks((n_channels + kThreadsPerBlock - 1) / kThreadsPerBlock);
+  stateful_effect_kernel<scalar_t, Effect>
+      <<<blocks, threads, 0, at::cuda::getCurrentCUDAStream()>>>(
+          effect,
+          input_data,
+          state.data_ptr<scalar_t>(),
+          output.data_ptr<scalar_t>(),
+          n_channels,
+          n_frames,
+          state_size);
+  C10_CUDA_KERNEL_LAUNCH_CHECK();
+}
+
+} // namespace effects
+} // namespace torchaudio
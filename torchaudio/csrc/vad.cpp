@@ -0,0 +1,499 @@
+#include <ATen/record_function.h>
+#include <torch/fft.h>
+#include <torchaudio/csrc/vad.h>
+
+#include <cmath>
+#include <limits>
+
+namespace torchaudio {
+namespace vad {
+namespace {
+
+// Number of measurements whose DFTs are computed in a batch. Measuring past
+// the trigger point is wasted, so it is kept to a few seconds of audio.
+constexpr int64_t kMeasureBlock = 64;
+
+} // namespace
+
+Options make_options(
+    int64_t sample_rate,
+    double trigger_level,
+    double trigger_time,
+    double search_time,
+    double allowed_gap,
+    double pre_trigger_time,
+    double boot_time,
+    double noise_up_time,
+    double noise_down_time,
+    double noise_reduction_amount,
+    double measure_freq,
+    c10::optional<double> measure_duration,
+    double measure_smooth_time,
+    double hp_filter_freq,
+    double lp_filter_freq,
+    double hp_lifter_freq,
+    double lp_lifter_freq) {
+  TORCH_CHECK(
+      sample_rate > 0, "sample_rate must be positive. Found: ", sample_rate);
+  TORCH_CHECK(
+      measure_freq > 0,
+      "measure_freq must be positive. Found: ",
+      measure_freq);
+  const double sr = static_cast<double>(sample_rate);
+  Options o;
+  o.measure_len = static_cast<int64_t>(
+      sr * measure_duration.value_or(2.0 / measure_freq) + 0.5);
+  TORCH_CHECK(o.measure_len > 0, "measure_duration must be positive.");
+  o.dft_len = 16;
+  while (o.dft_len < o.measure_len) {
+    o.dft_len <<= 1;
+  }
+  o.measure_period = static_cast<int64_t>(sr / measure_freq + 0.5);
+  TORCH_CHECK(o.measure_period > 0, "measure_freq is too high.");
+  o.measures_len = static_cast<int64_t>(std::ceil(search_time * measure_freq));
+  TORCH_CHECK(o.measures_len > 0, "search_time must be positive.");
+  o.gap_len = static_cast<int64_t>(allowed_gap * measure_freq + 0.5);
+  o.samples_len = static_cast<int64_t>(pre_trigger_time * sr + 0.5) +
+      o.measures_len * o.measure_period + o.measure_len;
+
+  o.spectrum_start = std::max<int64_t>(
+      static_cast<int64_t>(hp_filter_freq / sr * o.dft_len + 0.5), 1);
+  o.spectrum_end = std::min<int64_t>(
+      static_cast<int64_t>(lp_filter_freq / sr * o.dft_len + 0.5),
+      o.dft_len / 2);
+  TORCH_CHECK(
+      o.spectrum_end > o.spectrum_start,
+      "lp_filter_freq must be higher than hp_filter_freq.");
+  o.cepstrum_start = static_cast<int64_t>(std::ceil(sr * 0.5 / lp_lifter_freq));
+  o.cepstrum_end = std::min<int64_t>(
+      static_cast<int64_t>(std::floor(sr * 0.5 / hp_lifter_freq)),
+      o.dft_len / 4);
+  TORCH_CHECK(
+      o.cepstrum_end > o.cepstrum_start,
+      "The lifter does not pass any quefrency. Found: [",
+      o.cepstrum_start,
+      ", ",
+      o.cepstrum_end,
+      ")");
+
+  o.boot_count_max = static_cast<int64_t>(boot_time * measure_freq - 0.5);
+  o.trigger_level = static_cast<float>(trigger_level);
+  o.noise_reduction_amount = static_cast<float>(noise_reduction_amount);
+  o.measure_smooth_time_mult =
+      std::exp(-1.0 / (measure_smooth_time * measure_freq));
+  o.trigger_meas_time_mult = std::exp(-1.0 / (trigger_time * measure_freq));
+  o.noise_up_time_mult =
+      static_cast<float>(std::exp(-1.0 / (noise_up_time * measure_freq)));
+  o.noise_down_time_mult =
+      static_cast<float>(std::exp(-1.0 / (noise_down_time * measure_freq)));
+
+  // Hann windows scaled as in SoX.
+  const int64_t num_bins = o.spectrum_end - o.spectrum_start;
+  o.spectrum_window =
+      torch::full(
+          {o.measure_len},
+          2.0 / std::sqrt(static_cast<double>(o.measure_len)),
+          torch::kFloat32) *
+      torch::hann_window(o.measure_len, torch::kFloat32);
+  o.cepstrum_window =
+      torch::full(
+          {num_bins},
+          2.0 / std::sqrt(static_cast<double>(num_bins)),
+          torch::kFloat32) *
+      torch::hann_window(num_bins, torch::kFloat32);
+  return o;
+}
+
+Detector::Detector(Options options, int64_t num_channels)
+    : opts_(std::move(options)),
+      num_channels_(num_channels),
+      spectrum_(
+          num_channels * (opts_.spectrum_end - opts_.spectrum_start),
+          0.f),
+      noise_spectrum_(spectrum_.size(), 0.f),
+      measures_(num_channels * opts_.measures_len, 0.f),
+      mean_measures_(num_channels, 0.f) {}
+
+bool Detector::Measure(
+    const torch::Tensor& signal,
+    int64_t signal_begin,
+    int64_t num_samples) {
+  if (num_channels_ == 0) {
+    return false;
+  }
+  // The measurement k is taken when the sample
+  // `measure_len - 1 + k * measure_period` is fed, on the `measure_len`
+  // samples before it.
+  const int64_t num_measures = num_samples < opts_.measure_len
+      ? 0
+      : (num_samples - opts_.measure_len) / opts_.measure_period + 1;
+  while (!triggered_ && num_measures_ < num_measures) {
+    MeasureBlock(
+        signal,
+        signal_begin,
+        num_measures_,
+        std::min(num_measures, num_measures_ + kMeasureBlock));
+  }
+  return triggered_;
+}
+
+void Detector::MeasureBlock(
+    const torch::Tensor& signal,
+    int64_t signal_begin,
+    int64_t k_begin,
+    int64_t k_end) {
+  const auto& o = opts_;
+  const int64_t n = k_end - k_begin;
+  const int64_t num_bins = o.spectrum_end - o.spectrum_start;
+  const int64_t cepstrum_len = o.dft_len / 2;
+  const int64_t first = k_begin * o.measure_period - 1 - signal_begin;
+  TORCH_INTERNAL_ASSERT(
+      first >= 0 &&
+      first + (n - 1) * o.measure_period + o.measure_len <= signal.size(1));
+
+  const auto frames = signal.as_strided(
+      {num_channels_, n, o.measure_len},
+      {signal.stride(0), o.measure_period, 1},
+      signal.storage_offset() + first);
+  const auto magnitudes =
+      torch::fft::rfft(frames * o.spectrum_window, o.dft_len)
+          .slice(-1, o.spectrum_start, o.spectrum_end)
+          .abs()
+          .contiguous();
+  const float* magnitude_data = magnitudes.data_ptr<float>();
+  const float* cepstrum_window = o.cepstrum_window.data_ptr<float>();
+
+  // Smooths the spectra, and estimates and removes the noise.
+  auto cepstra = torch::zeros({num_channels_, n, cepstrum_len});
+  float* cepstrum_data = cepstra.data_ptr<float>();
+  for (int64_t k = 0; k < n; ++k) {
+    const double mult = boot_count_ >= 0
+        ? boot_count_ / (1.0 + boot_count_)
+        : o.measure_smooth_time_mult;
+    const float a = static_cast<float>(mult);
+    const float b = static_cast<float>(1 - mult);
+    for (int64_t c = 0; c < num_channels_; ++c) {
+      float* spectrum = spectrum_.data() + c * num_bins;
+      float* noise = noise_spectrum_.data() + c * num_bins;
+      const float* magnitude = magnitude_data + (c * n + k) * num_bins;
+      float* cepstrum =
+          cepstrum_data + (c * n + k) * cepstrum_len + o.spectrum_start;
+      for (int64_t i = 0; i < num_bins; ++i) {
+        spectrum[i] = spectrum[i] * a + magnitude[i] * b;
+        const float power = spectrum[i] * spectrum[i];
+        const float noise_mult = boot_count_ >= 0
+            ? 0.f
+            : (power > noise[i] ? o.noise_up_time_mult
+                                : o.noise_down_time_mult);
+        noise[i] = noise[i] * noise_mult + power * (1.f - noise_mult);
+        cepstrum[i] = std::sqrt(std::max(
+                          0.f, power - o.noise_reduction_amount * noise[i])) *
+            cepstrum_window[i];
+      }
+    }
+    if (boot_count_ >= 0) {
+      boot_count_ = boot_count_ == o.boot_count_max ? -1 : boot_count_ + 1;
+    }
+  }
+
+  const auto powers = torch::fft::rfft(cepstra)
+                          .slice(-1, o.cepstrum_start, o.cepstrum_end)
+                          .abs()
+                          .pow(2)
+                          .sum(-1)
+                          .contiguous();
+  const float* power_data = powers.data_ptr<float>();
+
+  // Searches the trigger point, as SoX does sample by sample.
+  const int64_t measures_len = o.measures_len;
+  const double time_mult = o.trigger_meas_time_mult;
+  for (int64_t k = 0; k < n; ++k) {
+    const int64_t index = (k_begin + k) % measures_len;
+    int64_t num_measures_to_flush = 0;
+    for (int64_t c = 0; c < num_channels_; ++c) {
+      const double power = power_data[c * n + k];
+      const double result = power > 0
+          ? std::log(power / (o.cepstrum_end - o.cepstrum_start))
+          : -std::numeric_limits<double>::infinity();
+      const double meas = std::max(0., 21 + result);
+      float* measures = measures_.data() + c * measures_len;
+      measures[index] = static_cast<float>(meas);
+      mean_measures_[c] =
+          static_cast<float>(
+              mean_measures_[c] * static_cast<float>(time_mult)) +
+          static_cast<float>(meas * (1.0 - time_mult));
+
+      // Once a channel triggers, the following ones are searched too.
+      triggered_ = triggered_ || mean_measures_[c] >= o.trigger_level;
+      if (triggered_) {
+        int64_t i = index;
+        int64_t j_trigger = measures_len;
+        int64_t j_zero = measures_len;
+        for (int64_t j = 0; j < measures_len; ++j) {
+          if (measures[i] >= o.trigger_level && j <= j_trigger + o.gap_len) {
+            j_zero = j_trigger = j;
+          } else if (measures[i] == 0 && j_trigger >= j_zero) {
+            j_zero = j;
+          }
+          i = (i + measures_len - 1) % measures_len;
+        }
+        // The Python implementation leaves the loop with `j` at
+        // `measures_len - 1` (SoX at `measures_len`), and this matches it.
+        const int64_t j = std::min(measures_len - 1, j_zero);
+        num_measures_to_flush =
+            std::min(std::max(num_measures_to_flush, j), measures_len);
+      }
+    }
+    if (triggered_) {
+      // The sample after the one the measurement was taken at.
+      const int64_t pos = o.measure_len + (k_begin + k) * o.measure_period;
+      const int64_t flushed_len =
+          (measures_len - num_measures_to_flush) * o.measure_period;
+      start_ = pos - o.samples_len + flushed_len;
+      num_measures_ = k_begin + k + 1;
+      return;
+    }
+  }
+  num_measures_ = k_end;
+}
+
+bool Detector::Triggered() const {
+  return triggered_;
+}
+
+int64_t Detector::NextFrameBegin() const {
+  return num_measures_ * opts_.measure_period - 1;
+}
+
+int64_t Detector::Start(int64_t num_samples) const {
+  return triggered_ ? start_ : num_samples - opts_.samples_len;
+}
+
+torch::Tensor ComputeVadStart(
+    const torch::Tensor& waveform,
+    const c10::optional<torch::Tensor>& lengths,
+    int64_t sample_rate,
+    double trigger_level,
+    double trigger_time,
+    double search_time,
+    double allowed_gap,
+    double pre_trigger_time,
+    double boot_time,
+    double noise_up_time,
+    double noise_down_time,
+    double noise_reduction_amount,
+    double measure_freq,
+    c10::optional<double> measure_duration,
+    double measure_smooth_time,
+    double hp_filter_freq,
+    double lp_filter_freq,
+    double hp_lifter_freq,
+    double lp_lifter_freq) {
+  TORCH_CHECK(
+      waveform.dim() == 3,
+      "waveform must be a (batch, channels, time) tensor. Found: ",
+      waveform.sizes());
+  const auto opts = make_options(
+      sample_rate,
+      trigger_level,
+      trigger_time,
+      search_time,
+      allowed_gap,
+      pre_trigger_time,
+      boot_time,
+      noise_up_time,
+      noise_down_time,
+      noise_reduction_amount,
+      measure_freq,
+      measure_duration,
+      measure_smooth_time,
+      hp_filter_freq,
+      lp_filter_freq,
+      hp_lifter_freq,
+      lp_lifter_freq);
+  const int64_t batch_size = waveform.size(0);
+  const int64_t num_channels = waveform.size(1);
+  const int64_t num_samples = waveform.size(2);
+
+  torch::Tensor lengths_;
+  const int64_t* lengths_data = nullptr;
+  if (lengths.has_value()) {
+    TORCH_CHECK(
+        lengths->dim() == 1 && lengths->size(0) == batch_size,
+        "lengths must be a 1D tensor with one value per waveform.");
+    lengths_ = lengths->to(torch::kCPU, torch::kInt64).contiguous();
+    lengths_data = lengths_.data_ptr<int64_t>();
+    for (int64_t i = 0; i < batch_size; ++i) {
+      TORCH_CHECK(
+          lengths_data[i] >= 0 && lengths_data[i] <= num_samples,
+          "lengths must be in the range of [0, ",
+          num_samples,
+          "]. Found: ",
+          lengths_data[i]);
+    }
+  }
+
+  // The first column is the sample -1, which the first measurement includes.
+  const auto signal = torch::constant_pad_nd(
+                          waveform.to(torch::kCPU, torch::kFloat32), {1, 0})
+                          .contiguous();
+  auto output = torch::empty({batch_size}, torch::kInt64);
+  int64_t* output_data = output.data_ptr<int64_t>();
+  at::parallel_for(0, batch_size, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      const int64_t length = lengths_data ? lengths_data[i] : num_samples;
+      RECORD_FUNCTION("torchaudio::vad", std::vector<c10::IValue>({length}));
+      Detector detector(opts, num_channels);
+      detector.Measure(signal[i], -1, length);
+      output_data[i] = detector.Start(length);
+    }
+  });
+  return output;
+}
+
+VoiceActivityDetector::VoiceActivityDetector(
+    int64_t sample_rate,
+    int64_t num_channels,
+    double trigger_level,
+    double trigger_time,
+    double search_time,
+    double allowed_gap,
+    double pre_trigger_time,
+    double boot_time,
+    double noise_up_time,
+    double noise_down_time,
+    double noise_reduction_amount,
+    double measure_freq,
+    c10::optional<double> measure_duration,
+    double measure_smooth_time,
+    double hp_filter_freq,
+    double lp_filter_freq,
+    double hp_lifter_freq,
+    double lp_lifter_freq)
+    : num_channels_(num_channels),
+      detector_(
+          make_options(
+              sample_rate,
+              trigger_level,
+              trigger_time,
+              search_time,
+              allowed_gap,
+              pre_trigger_time,
+              boot_time,
+              noise_up_time,
+              noise_down_time,
+              noise_reduction_amount,
+              measure_freq,
+              measure_duration,
+              measure_smooth_time,
+              hp_filter_freq,
+              lp_filter_freq,
+              hp_lifter_freq,
+              lp_lifter_freq),
+          num_channels) {
+  TORCH_CHECK(
+      num_channels > 0,
+      "num_channels must be positive. Found: ",
+      num_channels);
+}
+
+torch::Tensor VoiceActivityDetector::AcceptWaveform(
+    const torch::Tensor& chunk) {
+  TORCH_CHECK(!input_finished_, "The input has already finished.");
+  TORCH_CHECK(
+      chunk.dim() == 2 && chunk.size(0) == num_channels_,
+      "chunk must be a (",
+      num_channels_,
+      ", time) tensor. Found: ",
+      chunk.sizes());
+  if (!history_.defined()) {
+    history_ = torch::zeros({num_channels_, 1}, chunk.options());
+  }
+  TORCH_CHECK(
+      chunk.scalar_type() == history_.scalar_type() &&
+          chunk.device() == history_.device(),
+      "chunks must have the same dtype and device.");
+  num_samples_ += chunk.size(1);
+  if (detector_.Triggered()) {
+    return chunk;
+  }
+
+  history_ = torch::cat({history_, chunk}, 1);
+  const auto signal = history_.to(torch::kCPU, torch::kFloat32).contiguous();
+  if (detector_.Measure(signal, history_begin_, num_samples_)) {
+    const int64_t begin =
+        std::max<int64_t>(detector_.Start(num_samples_), 0) - history_begin_;
+    auto output = history_.slice(1, begin);
+    history_ = torch::empty({num_channels_, 0}, history_.options());
+    return output;
+  }
+  // Keeps the samples of the next measurements, and the ones to output if
+  // they trigger.
+  const int64_t keep = std::max<int64_t>(
+      -1,
+      std::min(detector_.NextFrameBegin(), detector_.Start(num_samples_)));
+  history_ = history_.slice(1, keep - history_begin_);
+  history_begin_ = keep;
+  return torch::empty({num_channels_, 0}, history_.options());
+}
+
+torch::Tensor VoiceActivityDetector::InputFinished() {
+  TORCH_CHECK(!input_finished_, "The input has already finished.");
+  input_finished_ = true;
+  if (!history_.defined()) {
+    return torch::empty({num_channels_, 0});
+  }
+  if (detector_.Triggered()) {
+    return history_;
+  }
+  // Same as `vad`, which returns the last `samples_len` samples.
+  const int64_t begin =
+      std::max<int64_t>(detector_.Start(num_samples_), 0) - history_begin_;
+  auto output = history_.slice(1, begin);
+  history_ = torch::empty({num_channels_, 0}, history_.options());
+  return output;
+}
+
+bool VoiceActivityDetector::Triggered() const {
+  return detector_.Triggered();
+}
+
+} // namespace vad
+} // namespace torchaudio
+
+TORCH_LIBRARY_FRAGMENT(torchaudio, m) {
+  m.def(
+      "torchaudio::_vad(Tensor waveform, Tensor? lengths, int sample_rate, float trigger_level, float trigger_time, float search_time, float allowed_gap, float pre_trigger_time, float boot_time, float noise_up_time, float noise_down_time, float noise_reduction_amount, float measure_freq, float? measure_duration, float measure_smooth_time, float hp_filter_freq, float lp_filter_freq, float hp_lifter_freq, float lp_lifter_freq) -> Tensor");
+  m.class_<torchaudio::vad::VoiceActivityDetector>(
+      "vad_VoiceActivityDetector")
+      .def(torch::init<
+           int64_t,
+           int64_t,
+           double,
+           double,
+           double,
+           double,
+           double,
+           double,
+           double,
+           double,
+           double,
+           double,
+           c10::optional<double>,
+           double,
+           double,
+           double,
+           double,
+           double>())
+      .def(
+          "accept_waveform",
+          &torchaudio::vad::VoiceActivityDetector::AcceptWaveform)
+      .def(
+          "input_finished",
+          &torchaudio::vad::VoiceActivityDetector::InputFinished)
+      .def("triggered", &torchaudio::vad::VoiceActivityDetector::Triggered);
+}
+
+TORCH_LIBRARY_IMPL(torchaudio, CompositeExplicitAutograd, m) {
+  m.impl("torchaudio::_vad", &torchaudio::vad::ComputeVadStart);
+}
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <torch/script.h>
+
+namespace torchaudio {
+namespace vad {
+
+// The parameters of the detector, derived from the arguments of
+// `torchaudio.functional.vad` as the SoX `vad` effect does. The lengths are
+// in samples, except for `measures_len` and `gap_len`, which are in
+// measurements.
+struct Options {
+  // Number of samples a measurement is taken on, and size of its DFT.
+  int64_t measure_len;
+  int64_t dft_len;
+  // Number of samples between two measurements.
+  int64_t measure_period;
+  // Number of measurements searched back from the trigger point.
+  int64_t measures_len;
+  int64_t gap_len;
+  // Length of the ring buffer of SoX, from which the output starts.
+  int64_t samples_len;
+  // The bins of the spectra and of the cepstra the measurements sum over.
+  int64_t spectrum_start;
+  int64_t spectrum_end;
+  int64_t cepstrum_start;
+  int64_t cepstrum_end;
+  int64_t boot_count_max;
+  float trigger_level;
+  float noise_reduction_amount;
+  double measure_smooth_time_mult;
+  double trigger_meas_time_mult;
+  float noise_up_time_mult;
+  float noise_down_time_mult;
+  // [measure_len] and [spectrum_end - spectrum_start], float32.
+  torch::Tensor spectrum_window;
+  torch::Tensor cepstrum_window;
+};
+
+Options make_options(
+    int64_t sample_rate,
+    double trigger_level,
+    double trigger_time,
+    double search_time,
+    double allowed_gap,
+    double pre_trigger_time,
+    double boot_time,
+    double noise_up_time,
+    double noise_down_time,
+    double noise_reduction_amount,
+    double measure_freq,
+    c10::optional<double> measure_duration,
+    double measure_smooth_time,
+    double hp_filter_freq,
+    double lp_filter_freq,
+    double hp_lifter_freq,
+    double lp_lifter_freq);
+
+/// Detects the voice activity in one recording, which is fed sample by
+/// sample as in SoX, but measured a block of measurements at a time.
+///
+/// The measurements only depend on the samples and on the smoothed spectra,
+/// and not on whether the detector triggered, so the DFTs of the frames of
+/// a block of measurements, and then the ones of their cepstra, are computed
+/// in two batches for all the channels. Only the spectral smoothing and the
+/// trigger search run measurement by measurement. The computation is done in
+/// float32, as the Python implementation does.
+class Detector {
+ public:
+  Detector(Options options, int64_t num_channels);
+
+  /// Takes the measurements which end within the first `num_samples`
+  /// samples of the recording, until voice activity is detected.
+  /// `signal` is a contiguous [num_channels, n] float32 tensor whose first
+  /// column is the sample `signal_begin` of the recording (sample -1 is
+  /// zero), and which covers the samples [`NextFrameBegin()`,
+  /// `num_samples`). Returns whether voice activity was detected.
+  bool Measure(
+      const torch::Tensor& signal,
+      int64_t signal_begin,
+      int64_t num_samples);
+
+  bool Triggered() const;
+  /// The first sample of the next measurement.
+  int64_t NextFrameBegin() const;
+  /// The first sample kept by `vad` for a recording of `num_samples` samples
+  /// fed so far. It is negative when the trigger point is close to the
+  /// beginning.
+  int64_t Start(int64_t num_samples) const;
+
+ private:
+  // Takes the measurements [k_begin, k_end).
+  void MeasureBlock(
+      const torch::Tensor& signal,
+      int64_t signal_begin,
+      int64_t k_begin,
+      int64_t k_end);
+
+  const Options opts_;
+  const int64_t num_channels_;
+  // [num_channels, spectrum_end - spectrum_start]
+  std::vector<float> spectrum_;
+  std::vector<float> noise_spectrum_;
+  // [num_channels, measures_len], ring buffers of the measurements.
+  std::vector<float> measures_;
+  // [num_channels]
+  std::vector<float> mean_measures_;
+  int64_t boot_count_ = 0;
+  int64_t num_measures_ = 0;
+  bool triggered_ = false;
+  int64_t start_ = 0;
+};
+
+/// Same as `torchaudio.functional.vad` for a batch of recordings of shape
+/// (batch, channels, time), of which only the first `lengths[i]` samples
+/// are valid. Returns the index of the first sample kept for each
+/// recording, which is negative in the same cases as `Detector::Start`.
+torch::Tensor ComputeVadStart(
+    const torch::Tensor& waveform,
+    const c10::optional<torch::Tensor>& lengths,
+    int64_t sample_rate,
+    double trigger_level,
+    double trigger_time,
+    double search_time,
+    double allowed_gap,
+    double pre_trigger_time,
+    double boot_time,
+    double noise_up_time,
+    double noise_down_time,
+    double noise_reduction_amount,
+    double measure_freq,
+    c10::optional<double> measure_duration,
+    double measure_smooth_time,
+    double hp_filter_freq,
+    double lp_filter_freq,
+    double hp_lifter_freq,
+    double lp_lifter_freq);
+
+/// Incremental voice activity detection.
+///
+/// Audio is fed chunk by chunk with `AcceptWaveform`, which returns the
+/// audio to output so far: nothing until voice activity is detected, then
+/// the audio from the trigger point, including the search and pre-trigger
+/// periods, and then every chunk as it is. Only the samples which can still
+/// be output are kept. When the input ends without voice activity,
+/// `InputFinished` returns the tail that `vad` returns in that case.
+struct VoiceActivityDetector : torch::CustomClassHolder {
+  VoiceActivityDetector(
+      int64_t sample_rate,
+      int64_t num_channels,
+      double trigger_level,
+      double trigger_time,
+      double search_time,
+      double allowed_gap,
+      double pre_trigger_time,
+      double boot_time,
+      double noise_up_time,
+      double noise_down_time,
+      double noise_reduction_amount,
+      double measure_freq,
+      c10::optional<double> measure_duration,
+      double measure_smooth_time,
+      double hp_filter_freq,
+      double lp_filter_freq,
+      double hp_lifter_freq,
+      double lp_lifter_freq);
+
+  /// Feeds a (channels, time) chunk, and returns the audio to output.
+  torch::Tensor AcceptWaveform(const torch::Tensor& chunk);
+  /// Signals the end of the audio, and returns the audio left to output.
+  torch::Tensor InputFinished();
+  bool Triggered() const;
+
+ private:
+  const int64_t num_channels_;
+  Detector detector_;
+  // The samples from `history_begin_`, in the dtype and on the device of
+  // the input. Sample -1 is zero.
+  torch::Tensor history_;
+  int64_t history_begin_ = -1;
+  int64_t num_samples_ = 0;
+  bool input_finished_ = false;
+};
+
+} // namespace vad
+} // namespace torchaudio
@@ -4,6 +4,9 @@ from .functional import (
     complex_norm,
     compute_deltas,
     compute_kaldi_pitch,
+    create_online_kaldi_pitch,
+    compute_kaldi_fbank,
+    compute_kaldi_mfcc,
     create_dct,
     create_fb_matrix,
     melscale_fbanks,
@@ -26,6 +29,13 @@ from .functional import (
     edit_distance,
     pitch_shift,
     rnnt_loss,
+    rnnt_loss_release_workspace,
+    rnnt_score,
+    rnnt_loss_pruned,
+    rnnt_prune_ranges,
+    rnnt_prune,
+    create_ctc_decoder,
+    create_rnnt_decoder,
 )
 from .filtering import (
     allpass_biquad,
@@ -48,8 +58,11 @@ from .filtering import (
     overdrive,
     phaser,
     riaa_biquad,
+    sosfilt,
     treble_biquad,
     vad,
+    vad_start_index,
+    create_online_vad,
 )
 
 __all__ = [
@@ -58,6 +71,9 @@ __all__ = [
     'complex_norm',
     'compute_deltas',
     'compute_kaldi_pitch',
+    'create_online_kaldi_pitch',
+    'compute_kaldi_fbank',
+    'compute_kaldi_mfcc',
     'create_dct',
     'create_fb_matrix',
     'melscale_fbanks',
@@ -95,11 +111,21 @@ __all__ = [
     'overdrive',
     'phaser',
     'riaa_biquad',
+    'sosfilt',
     'treble_biquad',
     'vad',
+    'vad_start_index',
+    'create_online_vad',
     'apply_codec',
     'resample',
     'edit_distance',
     'pitch_shift',
     'rnnt_loss',
+    'rnnt_loss_release_workspace',
+    'rnnt_score',
+    'rnnt_loss_pruned',
+    'rnnt_prune_ranges',
+    'rnnt_prune',
+    'create_ctc_decoder',
+    'create_rnnt_decoder',
 ]
@@ -672,6 +672,53 @@ def filtfilt(
     return backward_filtered
 
 
+def _flanger_core_loop_generic(
+    waveform: Tensor,
+    delay: Tensor,
+    state: Tensor,
+    output_waveform: Tensor,
+    in_gain: float,
+    delay_gain: float,
+    feedback_gain: float,
+    quadratic: bool
+):
+    delay_buf_length = state.size(1) - 1
+    int_delays = torch.floor(delay)
+    frac_delays = delay - int_delays
+    int_delays = int_delays.to(torch.int64)
+
+    for i in range(waveform.shape[-1]):
+        delay_buf_pos = delay_buf_length - 1 - i % delay_buf_length
+        idx = delay_buf_pos + int_delays[:, i:i + 1]
+        frac_delay = frac_delays[:, i]
+
+        state[:, delay_buf_pos] = waveform[:, i] + state[:, delay_buf_length] * feedback_gain
+        delay_buf = state[:, :delay_buf_length]
+        delayed_0 = delay_buf.gather(1, idx % delay_buf_length).squeeze(1)
+        delayed_1 = delay_buf.gather(1, (idx + 1) % delay_buf_length).squeeze(1)
+
+        if quadratic:
+            delayed_2 = delay_buf.gather(1, (idx + 2) % delay_buf_length).squeeze(1)
+            delayed_2 = delayed_2 - delayed_0
+            delayed_1 = delayed_1 - delayed_0
+            a = delayed_2 * 0.5 - delayed_1
+            b = delayed_1 * 2 - delayed_2 * 0.5
+
+            delayed = delayed_0 + (a * frac_delay + b) * frac_delay
+        else:
+            delayed = delayed_0 + (delayed_1 - delayed_0) * frac_delay
+
+        state[:, delay_buf_length] = delayed
+        output_waveform[:, i] = waveform[:, i] * in_gain + delayed * delay_gain
+
+
+try:
+    _flanger_core_loop = torch.ops.torchaudio._flanger_core_loop
+except RuntimeError as err:
+    assert str(err) == 'No such operator torchaudio::_flanger_core_loop'
+    _flanger_core_loop = _flanger_core_loop_generic
+
+
 def flanger(
     waveform: Tensor,
     sample_rate: int,
@@ -757,10 +804,10 @@ def flanger(
     delay_buf_length = int((delay_min + delay_depth) * sample_rate + 0.5)
     delay_buf_length = delay_buf_length + 2
 
-    delay_bufs = torch.zeros(
-        waveform.shape[0], n_channels, delay_buf_length, dtype=dtype, device=device
+    # The delay buffer of each channel, followed by its last delayed sample
+    state = torch.zeros(
+        waveform.shape[0] * n_channels, delay_buf_length + 1, dtype=dtype, device=device
     )
-    delay_last = torch.zeros(waveform.shape[0], n_channels, dtype=dtype, device=device)
 
     lfo_length = int(sample_rate / speed)
 
@@ -777,61 +824,21 @@ def flanger(
         device=device,
     )
 
-    output_waveform = torch.zeros_like(waveform, dtype=dtype, device=device)
-
-    delay_buf_pos = 0
-    lfo_pos = 0
+    # The LFO of each channel is shifted by its phase
+    n_frames = waveform.shape[-1]
     channel_idxs = torch.arange(0, n_channels, device=device)
+    cur_channel_phase = (channel_idxs * lfo_length * channel_phase + 0.5).to(torch.int64)
+    lfo_pos = torch.arange(0, n_frames, device=device)
+    delay = lfo[(lfo_pos + cur_channel_phase.unsqueeze(1)) % lfo_length].to(dtype)
+    delay = delay.expand(waveform.shape[0], n_channels, n_frames).reshape(-1, n_frames)
 
-    for i in range(waveform.shape[-1]):
-
-        delay_buf_pos = (delay_buf_pos + delay_buf_length - 1) % delay_buf_length
-
-        cur_channel_phase = (channel_idxs * lfo_length * channel_phase + 0.5).to(
-            torch.int64
-        )
-        delay_tensor = lfo[(lfo_pos + cur_channel_phase) % lfo_length]
-        frac_delay = torch.frac(delay_tensor)
-        delay_tensor = torch.floor(delay_tensor)
-
-        int_delay = delay_tensor.to(torch.int64)
+    waveform = waveform.reshape(-1, n_frames).contiguous()
+    output_waveform = torch.empty_like(waveform)
 
-        temp = waveform[:, :, i]
-
-        delay_bufs[:, :, delay_buf_pos] = temp + delay_last * feedback_gain
-
-        delayed_0 = delay_bufs[
-            :, channel_idxs, (delay_buf_pos + int_delay) % delay_buf_length
-        ]
-
-        int_delay = int_delay + 1
-
-        delayed_1 = delay_bufs[
-            :, channel_idxs, (delay_buf_pos + int_delay) % delay_buf_length
-        ]
-
-        int_delay = int_delay + 1
-
-        if interpolation == "linear":
-            delayed = delayed_0 + (delayed_1 - delayed_0) * frac_delay
-        else:
-            delayed_2 = delay_bufs[
-                :, channel_idxs, (delay_buf_pos + int_delay) % delay_buf_length
-            ]
-
-            int_delay = int_delay + 1
-
-            delayed_2 = delayed_2 - delayed_0
-            delayed_1 = delayed_1 - delayed_0
-            a = delayed_2 * 0.5 - delayed_1
-            b = delayed_1 * 2 - delayed_2 * 0.5
-
-            delayed = delayed_0 + (a * frac_delay + b) * frac_delay
-
-        delay_last = delayed
-        output_waveform[:, :, i] = waveform[:, :, i] * in_gain + delayed * delay_gain
-
-        lfo_pos = (lfo_pos + 1) % lfo_length
+    # Uses the native loop function, which has optimized CPU and CUDA kernels
+    _flanger_core_loop(
+        waveform, delay, state, output_waveform, in_gain, delay_gain, feedback_gain, interpolation == "quadratic"
+    )
 
     return output_waveform.clamp(min=-1, max=1).view(actual_shape)
 
@@ -886,13 +893,14 @@ def highpass_biquad(
 
 
 def _lfilter_core_generic_loop(input_signal_windows: Tensor, a_coeffs_flipped: Tensor, padded_output_waveform: Tensor):
-    n_order = a_coeffs_flipped.size(1)
-    a_coeffs_flipped = a_coeffs_flipped.unsqueeze(2)
+    n_order = a_coeffs_flipped.size(-1)
+    # (n_channel, n_order, 1) or (n_batch, n_channel, n_order, 1), broadcast against the windows
+    a_coeffs_flipped = a_coeffs_flipped.unsqueeze(-1)
     for i_sample, o0 in enumerate(input_signal_windows.permute(2, 0, 1)):
         windowed_output_signal = padded_output_waveform[
             :, :, i_sample:i_sample + n_order
         ]
-        o0 -= (windowed_output_signal.transpose(0, 1) @ a_coeffs_flipped)[..., 0].t()
+        o0 -= (windowed_output_signal.unsqueeze(2) @ a_coeffs_flipped)[..., 0, 0]
         padded_output_waveform[:, :, i_sample + n_order - 1] = o0
 
 
@@ -907,7 +915,9 @@ def _lfilter_core(
     waveform: Tensor,
     a_coeffs: Tensor,
     b_coeffs: Tensor,
+    recompute_output: bool = False,
 ) -> Tensor:
+    # ``recompute_output`` only applies to the native op, whose backward pass is written by hand.
 
     assert a_coeffs.size() == b_coeffs.size()
     assert len(waveform.size()) == 3
@@ -915,7 +925,7 @@ def _lfilter_core(
     assert b_coeffs.device == a_coeffs.device
 
     n_batch, n_channel, n_sample = waveform.size()
-    n_order = a_coeffs.size(1)
+    n_order = a_coeffs.size(-1)
     assert n_order > 0
 
     # Pad the input and create output
@@ -925,18 +935,26 @@ def _lfilter_core(
 
     # Set up the coefficients matrix
     # Flip coefficients' order
-    a_coeffs_flipped = a_coeffs.flip(1)
-    b_coeffs_flipped = b_coeffs.flip(1)
+    a_coeffs_flipped = a_coeffs.flip(-1)
+    b_coeffs_flipped = b_coeffs.flip(-1)
 
     # calculate windowed_input_signal in parallel using convolution
-    input_signal_windows = torch.nn.functional.conv1d(
-        padded_waveform,
-        b_coeffs_flipped.unsqueeze(1),
-        groups=n_channel
-    )
+    if b_coeffs.ndim == 2:
+        input_signal_windows = torch.nn.functional.conv1d(
+            padded_waveform,
+            b_coeffs_flipped.unsqueeze(1),
+            groups=n_channel
+        )
+    else:
+        # one set of filters per example
+        input_signal_windows = torch.nn.functional.conv1d(
+            padded_waveform.reshape(1, n_batch * n_channel, -1),
+            b_coeffs_flipped.reshape(n_batch * n_channel, 1, n_order),
+            groups=n_batch * n_channel
+        ).view(n_batch, n_channel, n_sample)
 
-    input_signal_windows.div_(a_coeffs[:, :1])
-    a_coeffs_flipped.div_(a_coeffs[:, :1])
+    input_signal_windows.div_(a_coeffs[..., :1])
+    a_coeffs_flipped.div_(a_coeffs[..., :1])
 
     if input_signal_windows.device == torch.device('cpu') and\
        a_coeffs_flipped.device == torch.device('cpu') and\
@@ -961,7 +979,8 @@ def lfilter(
     a_coeffs: Tensor,
     b_coeffs: Tensor,
     clamp: bool = True,
-    batching: bool = True
+    batching: bool = True,
+    recompute_output: bool = False,
 ) -> Tensor:
     r"""Perform an IIR filter by evaluating difference equation.
 
@@ -972,11 +991,13 @@ def lfilter(
     Args:
         waveform (Tensor): audio waveform of dimension of ``(..., time)``.  Must be normalized to -1 to 1.
         a_coeffs (Tensor): denominator coefficients of difference equation of dimension of either
-                                1D with shape ``(num_order + 1)`` or 2D with shape ``(num_filters, num_order + 1)``.
+                                1D with shape ``(num_order + 1)``, 2D with shape ``(num_filters, num_order + 1)``
+                                or ``(..., num_filters, num_order + 1)`` for one set of filters per example.
                                 Lower delays coefficients are first, e.g. ``[a0, a1, a2, ...]``.
                                 Must be same size as b_coeffs (pad with 0's as necessary).
         b_coeffs (Tensor): numerator coefficients of difference equation of dimension of either
-                                1D with shape ``(num_order + 1)`` or 2D with shape ``(num_filters, num_order + 1)``.
+                                1D with shape ``(num_order + 1)``, 2D with shape ``(num_filters, num_order + 1)``
+                                or ``(..., num_filters, num_order + 1)`` for one set of filters per example.
                                 Lower delays coefficients are first, e.g. ``[b0, b1, b2, ...]``.
                                 Must be same size as a_coeffs (pad with 0's as necessary).
         clamp (bool, optional): If ``True``, clamp the output signal to be in the range [-1, 1] (Default: ``True``)
@@ -985,14 +1006,27 @@ def lfilter(
                                     The output can be expressed as ``output[..., i, :] = lfilter(waveform[..., i, :],
                                     a_coeffs[i], b_coeffs[i], clamp=clamp, batching=False)``. (Default: ``True``)
 
+                                    When the coefficients have more than two dimensions, ``batching`` must be
+                                    ``True``, and their leading dimensions must equal the ones of the waveform.
+                                    Each example is then filtered with its own filters, that is,
+                                    ``output[j, i, :] = lfilter(waveform[j, i, :], a_coeffs[j, i], b_coeffs[j, i],
+                                    clamp=clamp, batching=False)``, and so is the gradient, which makes it possible
+                                    to filter a batch of randomly equalized examples in one call.
+        recompute_output (bool, optional): If ``True``, the output of the recursive part of the filter is not kept
+            for the backward pass, and is computed again from its input when the gradient with respect to
+            ``a_coeffs`` is computed. This lowers the peak memory of training on long signals, at the cost
+            of one more pass of the filter. (Default: ``False``)
+
     Returns:
         Tensor: Waveform with dimension of either ``(..., num_filters, time)`` if ``a_coeffs`` and ``b_coeffs``
-                are 2D Tensors, or ``(..., time)`` otherwise.
+                have at least two dimensions, or ``(..., time)`` otherwise.
     """
     assert a_coeffs.size() == b_coeffs.size()
-    assert a_coeffs.ndim <= 2
 
-    if a_coeffs.ndim > 1:
+    if a_coeffs.ndim > 2:
+        assert batching, "Per-example coefficients require batching=True."
+        assert waveform.shape[:-1] == a_coeffs.shape[:-1]
+    elif a_coeffs.ndim > 1:
         if batching:
             assert waveform.ndim > 1
             assert waveform.shape[-2] == a_coeffs.shape[0]
@@ -1004,8 +1038,12 @@ def lfilter(
 
     # pack batch
     shape = waveform.size()
-    waveform = waveform.reshape(-1, a_coeffs.shape[0], shape[-1])
-    output = _lfilter(waveform, a_coeffs, b_coeffs)
+    num_filters = a_coeffs.shape[-2]
+    waveform = waveform.reshape(-1, num_filters, shape[-1])
+    if a_coeffs.ndim > 2:
+        a_coeffs = a_coeffs.reshape(-1, num_filters, a_coeffs.shape[-1])
+        b_coeffs = b_coeffs.reshape(-1, num_filters, b_coeffs.shape[-1])
+    output = _lfilter(waveform, a_coeffs, b_coeffs, recompute_output)
 
     if clamp:
         output = torch.clamp(output, min=-1.0, max=1.0)
@@ -1061,10 +1099,10 @@ def _overdrive_core_loop_generic(
 
 
 try:
-    _overdrive_core_loop_cpu = torch.ops.torchaudio._overdrive_core_loop
+    _overdrive_core_loop = torch.ops.torchaudio._overdrive_core_loop
 except RuntimeError as err:
     assert str(err) == 'No such operator torchaudio::_overdrive_core_loop'
-    _overdrive_core_loop_cpu = _overdrive_core_loop_generic
+    _overdrive_core_loop = _overdrive_core_loop_generic
 
 
 def overdrive(waveform: Tensor, gain: float = 20, colour: float = 20) -> Tensor:
@@ -1109,15 +1147,46 @@ def overdrive(waveform: Tensor, gain: float = 20, colour: float = 20) -> Tensor:
 
     output_waveform = torch.zeros_like(waveform, dtype=dtype, device=device)
 
-    # Uses CPU optimized loop function if available for CPU device
-    if device == torch.device('cpu'):
-        _overdrive_core_loop_cpu(waveform, temp, last_in, last_out, output_waveform)
-    else:
-        _overdrive_core_loop_generic(waveform, temp, last_in, last_out, output_waveform)
+    # Uses the native loop function, which has optimized CPU and CUDA kernels
+    _overdrive_core_loop(waveform, temp, last_in, last_out, output_waveform)
 
     return output_waveform.clamp(min=-1, max=1).view(actual_shape)
 
 
+def _phaser_core_loop_generic(
+    waveform: Tensor,
+    mod_table: Tensor,
+    delay_buf: Tensor,
+    output_waveform: Tensor,
+    decay: float
+):
+    delay_buf_len = delay_buf.size(1)
+    mod_buf_len = mod_table.size(0)
+    delay_pos = 0
+    mod_pos = 0
+
+    waveform_list = [waveform[:, i] for i in range(waveform.size(1))]
+    delay_buf_list = [delay_buf[:, i] for i in range(delay_buf.size(1))]
+    mod_buf_list = [mod_table[i] for i in range(mod_table.size(0))]
+
+    for i in range(waveform.shape[-1]):
+        idx = int((delay_pos + mod_buf_list[mod_pos]) % delay_buf_len)
+        mod_pos = (mod_pos + 1) % mod_buf_len
+        delay_pos = (delay_pos + 1) % delay_buf_len
+        temp = (waveform_list[i]) + (delay_buf_list[idx])
+        delay_buf_list[delay_pos] = temp * decay
+        output_waveform[:, i] = temp
+
+    delay_buf.copy_(torch.stack(delay_buf_list, dim=1))
+
+
+try:
+    _phaser_core_loop = torch.ops.torchaudio._phaser_core_loop
+except RuntimeError as err:
+    assert str(err) == 'No such operator torchaudio::_phaser_core_loop'
+    _phaser_core_loop = _phaser_core_loop_generic
+
+
 def phaser(
     waveform: Tensor,
     sample_rate: int,
@@ -1185,27 +1254,12 @@ def phaser(
         device=device,
     )
 
-    delay_pos = 0
-    mod_pos = 0
-
-    output_waveform_pre_gain_list = []
     waveform = waveform * gain_in
-    delay_buf = delay_buf * decay
-    waveform_list = [waveform[:, i] for i in range(waveform.size(1))]
-    delay_buf_list = [delay_buf[:, i] for i in range(delay_buf.size(1))]
-    mod_buf_list = [mod_buf[i] for i in range(mod_buf.size(0))]
+    output_waveform = torch.empty_like(waveform)
 
-    for i in range(waveform.shape[-1]):
-        idx = int((delay_pos + mod_buf_list[mod_pos]) % delay_buf_len)
-        mod_pos = (mod_pos + 1) % mod_buf_len
-        delay_pos = (delay_pos + 1) % delay_buf_len
-        temp = (waveform_list[i]) + (delay_buf_list[idx])
-        delay_buf_list[delay_pos] = temp * decay
-        output_waveform_pre_gain_list.append(temp)
+    # Uses the native loop function, which has optimized CPU and CUDA kernels
+    _phaser_core_loop(waveform, mod_buf, delay_buf, output_waveform, decay)
 
-    output_waveform = torch.stack(output_waveform_pre_gain_list, dim=1).to(
-        dtype=dtype, device=device
-    )
     output_waveform.mul_(gain_out)
 
     return output_waveform.clamp(min=-1, max=1).view(actual_shape)
@@ -1271,6 +1325,49 @@ def riaa_biquad(waveform: Tensor, sample_rate: int) -> Tensor:
     return biquad(waveform, b0, b1, b2, a0, a1, a2)
 
 
+def _sosfilt_core(waveform: Tensor, sos: Tensor) -> Tensor:
+    output = waveform.unsqueeze(1)
+    for i in range(sos.size(0)):
+        output = _lfilter(output, sos[i:i + 1, 3:], sos[i:i + 1, :3])
+    return output.squeeze(1)
+
+
+try:
+    _sosfilt = torch.ops.torchaudio._sosfilt
+except RuntimeError as err:
+    assert str(err) == 'No such operator torchaudio::_sosfilt'
+    _sosfilt = _sosfilt_core
+
+
+def sosfilt(waveform: Tensor, sos: Tensor, clamp: bool = True) -> Tensor:
+    r"""Apply a cascade of second-order IIR filters (biquads).
+
+    All the sections are applied in a single pass over the samples, which is faster
+    and more accurate than filtering the waveform with each biquad in turn.
+
+    Args:
+        waveform (Tensor): audio waveform of dimension of ``(..., time)``.  Must be normalized to -1 to 1.
+        sos (Tensor): coefficients of the sections, of dimension of ``(num_sections, 6)``.
+            Each row is ``[b0, b1, b2, a0, a1, a2]``, as returned by ``scipy.signal.butter(..., output='sos')``.
+        clamp (bool, optional): If ``True``, clamp the output signal to be in the range [-1, 1] (Default: ``True``)
+
+    Returns:
+        Tensor: Waveform of dimension of ``(..., time)``
+    """
+    assert sos.ndim == 2 and sos.size(1) == 6
+
+    # pack batch
+    shape = waveform.size()
+    waveform = waveform.reshape(-1, shape[-1])
+    output = _sosfilt(waveform, sos)
+
+    if clamp:
+        output = torch.clamp(output, min=-1.0, max=1.0)
+
+    # unpack batch
+    return output.reshape(shape)
+
+
 def treble_biquad(
     waveform: Tensor,
     sample_rate: int,
@@ -1401,6 +1498,180 @@ def _measure(
     return max(0, 21 + result)
 
 
+def _vad_start_generic(
+    waveform: Tensor,
+    lengths: Optional[Tensor],
+    sample_rate: int,
+    trigger_level: float,
+    trigger_time: float,
+    search_time: float,
+    allowed_gap: float,
+    pre_trigger_time: float,
+    boot_time: float,
+    noise_up_time: float,
+    noise_down_time: float,
+    noise_reduction_amount: float,
+    measure_freq: float,
+    measure_duration: Optional[float],
+    measure_smooth_time: float,
+    hp_filter_freq: float,
+    lp_filter_freq: float,
+    hp_lifter_freq: float,
+    lp_lifter_freq: float,
+) -> Tensor:
+    """Returns the index of the first sample that ``vad`` keeps for each ``(channels, time)`` recording
+    of a ``(batch, channels, time)`` batch, of which ``lengths`` samples are valid."""
+    measure_duration: float = (
+        2.0 / measure_freq if measure_duration is None else measure_duration
+    )
+
+    measure_len_ws = int(sample_rate * measure_duration + 0.5)
+    measure_len_ns = measure_len_ws
+    # for (dft_len_ws = 16; dft_len_ws < measure_len_ws; dft_len_ws <<= 1);
+    dft_len_ws = 16
+    while dft_len_ws < measure_len_ws:
+        dft_len_ws *= 2
+
+    measure_period_ns = int(sample_rate / measure_freq + 0.5)
+    measures_len = math.ceil(search_time * measure_freq)
+    search_pre_trigger_len_ns = measures_len * measure_period_ns
+    gap_len = int(allowed_gap * measure_freq + 0.5)
+
+    fixed_pre_trigger_len_ns = int(pre_trigger_time * sample_rate + 0.5)
+    samplesLen_ns = (
+        fixed_pre_trigger_len_ns + search_pre_trigger_len_ns + measure_len_ns
+    )
+
+    spectrum_window = torch.zeros(measure_len_ws)
+    for i in range(measure_len_ws):
+        # sox.h:741 define SOX_SAMPLE_MIN (sox_sample_t)SOX_INT_MIN(32)
+        spectrum_window[i] = 2.0 / math.sqrt(float(measure_len_ws))
+    # lsx_apply_hann(spectrum_window, (int)measure_len_ws);
+    spectrum_window *= torch.hann_window(measure_len_ws, dtype=torch.float)
+
+    spectrum_start: int = int(hp_filter_freq / sample_rate * dft_len_ws + 0.5)
+    spectrum_start: int = max(spectrum_start, 1)
+    spectrum_end: int = int(lp_filter_freq / sample_rate * dft_len_ws + 0.5)
+    spectrum_end: int = min(spectrum_end, dft_len_ws // 2)
+
+    cepstrum_window = torch.zeros(spectrum_end - spectrum_start)
+    for i in range(spectrum_end - spectrum_start):
+        cepstrum_window[i] = 2.0 / math.sqrt(float(spectrum_end) - spectrum_start)
+    # lsx_apply_hann(cepstrum_window,(int)(spectrum_end - spectrum_start));
+    cepstrum_window *= torch.hann_window(
+        spectrum_end - spectrum_start, dtype=torch.float
+    )
+
+    cepstrum_start = math.ceil(sample_rate * 0.5 / lp_lifter_freq)
+    cepstrum_end = math.floor(sample_rate * 0.5 / hp_lifter_freq)
+    cepstrum_end = min(cepstrum_end, dft_len_ws // 4)
+
+    assert cepstrum_end > cepstrum_start
+
+    noise_up_time_mult = math.exp(-1.0 / (noise_up_time * measure_freq))
+    noise_down_time_mult = math.exp(-1.0 / (noise_down_time * measure_freq))
+    measure_smooth_time_mult = math.exp(-1.0 / (measure_smooth_time * measure_freq))
+    trigger_meas_time_mult = math.exp(-1.0 / (trigger_time * measure_freq))
+
+    boot_count_max = int(boot_time * measure_freq - 0.5)
+
+    n_channels = waveform.size(1)
+    starts = torch.zeros(waveform.size(0), dtype=torch.int64)
+    for b in range(waveform.size(0)):
+        ilen = waveform.size(2) if lengths is None else int(lengths[b])
+        measure_timer_ns = measure_len_ns
+        boot_count = measures_index = flushedLen_ns = samplesIndex_ns = 0
+
+        mean_meas = torch.zeros(n_channels)
+        samples = torch.zeros(n_channels, samplesLen_ns)
+        spectrum = torch.zeros(n_channels, dft_len_ws)
+        noise_spectrum = torch.zeros(n_channels, dft_len_ws)
+        measures = torch.zeros(n_channels, measures_len)
+
+        has_triggered: bool = False
+        num_measures_to_flush: int = 0
+        pos: int = 0
+
+        while pos < ilen and not has_triggered:
+            measure_timer_ns -= 1
+            for i in range(n_channels):
+                samples[i, samplesIndex_ns] = waveform[b, i, pos]
+                # if (!p->measure_timer_ns) {
+                if measure_timer_ns == 0:
+                    index_ns: int = (
+                        samplesIndex_ns + samplesLen_ns - measure_len_ns
+                    ) % samplesLen_ns
+                    meas: float = _measure(
+                        measure_len_ws=measure_len_ws,
+                        samples=samples[i],
+                        spectrum=spectrum[i],
+                        noise_spectrum=noise_spectrum[i],
+                        spectrum_window=spectrum_window,
+                        spectrum_start=spectrum_start,
+                        spectrum_end=spectrum_end,
+                        cepstrum_window=cepstrum_window,
+                        cepstrum_start=cepstrum_start,
+                        cepstrum_end=cepstrum_end,
+                        noise_reduction_amount=noise_reduction_amount,
+                        measure_smooth_time_mult=measure_smooth_time_mult,
+                        noise_up_time_mult=noise_up_time_mult,
+                        noise_down_time_mult=noise_down_time_mult,
+                        index_ns=index_ns,
+                        boot_count=boot_count,
+                    )
+                    measures[i, measures_index] = meas
+                    mean_meas[i] = mean_meas[i] * trigger_meas_time_mult + meas * (
+                        1.0 - trigger_meas_time_mult
+                    )
+
+                    has_triggered = has_triggered or (mean_meas[i] >= trigger_level)
+                    if has_triggered:
+                        n: int = measures_len
+                        k: int = measures_index
+                        jTrigger: int = n
+                        jZero: int = n
+                        j: int = 0
+
+                        for j in range(n):
+                            if (measures[i, k] >= trigger_level) and (
+                                j <= jTrigger + gap_len
+                            ):
+                                jZero = jTrigger = j
+                            elif (measures[i, k] == 0) and (jTrigger >= jZero):
+                                jZero = j
+                            k = (k + n - 1) % n
+                        j = min(j, jZero)
+                        # num_measures_to_flush = range_limit(j, num_measures_to_flush, n);
+                        num_measures_to_flush = min(max(num_measures_to_flush, j), n)
+                    # end if has_triggered
+                # end if (measure_timer_ns == 0):
+            # end for
+            samplesIndex_ns += 1
+            pos += 1
+            # end while
+            if samplesIndex_ns == samplesLen_ns:
+                samplesIndex_ns = 0
+            if measure_timer_ns == 0:
+                measure_timer_ns = measure_period_ns
+                measures_index += 1
+                measures_index = measures_index % measures_len
+                if boot_count >= 0:
+                    boot_count = -1 if boot_count == boot_count_max else boot_count + 1
+
+            if has_triggered:
+                flushedLen_ns = (measures_len - num_measures_to_flush) * measure_period_ns
+                samplesIndex_ns = (samplesIndex_ns + flushedLen_ns) % samplesLen_ns
+        starts[b] = pos - samplesLen_ns + flushedLen_ns
+    return starts
+
+
+try:
+    _vad_start = torch.ops.torchaudio._vad
+except RuntimeError as err:
+    assert str(err) == 'No such operator torchaudio::_vad'
+    _vad_start = _vad_start_generic
+
+
 def vad(
     waveform: Tensor,
     sample_rate: int,
@@ -1484,153 +1755,131 @@ def vad(
         warnings.warn(
             "Expected input tensor dimension of 1 for single channel"
             f" or 2 for multi-channel. Got {waveform.ndim} instead. "
-            "Batch semantics is not supported. "
+            "Batch semantics is not supported; use vad_start_index for batches. "
             "Please refer to https://github.com/pytorch/audio/issues/1348"
             " and https://github.com/pytorch/audio/issues/1468."
         )
 
-    measure_duration: float = (
-        2.0 / measure_freq if measure_duration is None else measure_duration
-    )
-
-    measure_len_ws = int(sample_rate * measure_duration + 0.5)
-    measure_len_ns = measure_len_ws
-    # for (dft_len_ws = 16; dft_len_ws < measure_len_ws; dft_len_ws <<= 1);
-    dft_len_ws = 16
-    while dft_len_ws < measure_len_ws:
-        dft_len_ws *= 2
+    # pack batch
+    shape = waveform.size()
+    waveform = waveform.view(-1, shape[-1])
+    start = int(_vad_start(
+        waveform.unsqueeze(0), None,
+        sample_rate, trigger_level, trigger_time, search_time, allowed_gap, pre_trigger_time, boot_time,
+        noise_up_time, noise_down_time, noise_reduction_amount, measure_freq, measure_duration,
+        measure_smooth_time, hp_filter_freq, lp_filter_freq, hp_lifter_freq, lp_lifter_freq,
+    )[0])
+    res = waveform[:, start:]
+    # unpack batch
+    return res.view(shape[:-1] + res.shape[-1:])
 
-    measure_period_ns = int(sample_rate / measure_freq + 0.5)
-    measures_len = math.ceil(search_time * measure_freq)
-    search_pre_trigger_len_ns = measures_len * measure_period_ns
-    gap_len = int(allowed_gap * measure_freq + 0.5)
 
-    fixed_pre_trigger_len_ns = int(pre_trigger_time * sample_rate + 0.5)
-    samplesLen_ns = (
-        fixed_pre_trigger_len_ns + search_pre_trigger_len_ns + measure_len_ns
-    )
+def vad_start_index(
+    waveform: Tensor,
+    sample_rate: int,
+    trigger_level: float = 7.0,
+    trigger_time: float = 0.25,
+    search_time: float = 1.0,
+    allowed_gap: float = 0.25,
+    pre_trigger_time: float = 0.0,
+    # Fine-tuning parameters
+    boot_time: float = 0.35,
+    noise_up_time: float = 0.1,
+    noise_down_time: float = 0.01,
+    noise_reduction_amount: float = 1.35,
+    measure_freq: float = 20.0,
+    measure_duration: Optional[float] = None,
+    measure_smooth_time: float = 0.4,
+    hp_filter_freq: float = 50.0,
+    lp_filter_freq: float = 6000.0,
+    hp_lifter_freq: float = 150.0,
+    lp_lifter_freq: float = 2000.0,
+    lengths: Optional[Tensor] = None,
+) -> Tensor:
+    r"""Finds where :py:func:`vad` trims each recording of a batch.
 
-    spectrum_window = torch.zeros(measure_len_ws)
-    for i in range(measure_len_ws):
-        # sox.h:741 define SOX_SAMPLE_MIN (sox_sample_t)SOX_INT_MIN(32)
-        spectrum_window[i] = 2.0 / math.sqrt(float(measure_len_ws))
-    # lsx_apply_hann(spectrum_window, (int)measure_len_ws);
-    spectrum_window *= torch.hann_window(measure_len_ws, dtype=torch.float)
+    The recordings are processed in parallel, and ``vad(waveform[i, :, :lengths[i]], ...)`` is
+    ``waveform[i, :, start[i]:lengths[i]]``, so the batch can be trimmed without padding the
+    recordings again. The other arguments are the same as the ones of :py:func:`vad`.
 
-    spectrum_start: int = int(hp_filter_freq / sample_rate * dft_len_ws + 0.5)
-    spectrum_start: int = max(spectrum_start, 1)
-    spectrum_end: int = int(lp_filter_freq / sample_rate * dft_len_ws + 0.5)
-    spectrum_end: int = min(spectrum_end, dft_len_ws // 2)
+    Args:
+        waveform (Tensor): Tensor of audio of dimension `(..., channels, time)`.
+            Each `(channels, time)` Tensor is a multi-channel recording, as in :py:func:`vad`.
+        sample_rate (int): Sample rate of audio signal.
+        lengths (Tensor or None, optional):
+            The number of valid samples of each recording in a padded batch, of shape `(...)`.
+            (Default: ``None``)
 
-    cepstrum_window = torch.zeros(spectrum_end - spectrum_start)
-    for i in range(spectrum_end - spectrum_start):
-        cepstrum_window[i] = 2.0 / math.sqrt(float(spectrum_end) - spectrum_start)
-    # lsx_apply_hann(cepstrum_window,(int)(spectrum_end - spectrum_start));
-    cepstrum_window *= torch.hann_window(
-        spectrum_end - spectrum_start, dtype=torch.float
+    Returns:
+        Tensor: The index of the first sample kept of each recording, of shape `(...)` and int64 dtype.
+    """
+    shape = waveform.size()
+    waveform = waveform.reshape(-1, shape[-2], shape[-1])
+    if lengths is not None:
+        lengths = lengths.reshape(-1)
+    start = _vad_start(
+        waveform, lengths,
+        sample_rate, trigger_level, trigger_time, search_time, allowed_gap, pre_trigger_time, boot_time,
+        noise_up_time, noise_down_time, noise_reduction_amount, measure_freq, measure_duration,
+        measure_smooth_time, hp_filter_freq, lp_filter_freq, hp_lifter_freq, lp_lifter_freq,
     )
+    if lengths is None:
+        length = torch.full_like(start, shape[-1])
+    else:
+        length = lengths.to(device=start.device, dtype=start.dtype)
+    # A negative start is counted from the end, as when vad slices the waveform with it.
+    start = torch.where(start < 0, (length + start).clamp(min=0), start)
+    return start.reshape(shape[:-2])
 
-    cepstrum_start = math.ceil(sample_rate * 0.5 / lp_lifter_freq)
-    cepstrum_end = math.floor(sample_rate * 0.5 / hp_lifter_freq)
-    cepstrum_end = min(cepstrum_end, dft_len_ws // 4)
-
-    assert cepstrum_end > cepstrum_start
-
-    noise_up_time_mult = math.exp(-1.0 / (noise_up_time * measure_freq))
-    noise_down_time_mult = math.exp(-1.0 / (noise_down_time * measure_freq))
-    measure_smooth_time_mult = math.exp(-1.0 / (measure_smooth_time * measure_freq))
-    trigger_meas_time_mult = math.exp(-1.0 / (trigger_time * measure_freq))
-
-    boot_count_max = int(boot_time * measure_freq - 0.5)
-    measure_timer_ns = measure_len_ns
-    boot_count = measures_index = flushedLen_ns = samplesIndex_ns = 0
 
-    # pack batch
-    shape = waveform.size()
-    waveform = waveform.view(-1, shape[-1])
+def create_online_vad(
+    sample_rate: int,
+    num_channels: int = 1,
+    trigger_level: float = 7.0,
+    trigger_time: float = 0.25,
+    search_time: float = 1.0,
+    allowed_gap: float = 0.25,
+    pre_trigger_time: float = 0.0,
+    # Fine-tuning parameters
+    boot_time: float = 0.35,
+    noise_up_time: float = 0.1,
+    noise_down_time: float = 0.01,
+    noise_reduction_amount: float = 1.35,
+    measure_freq: float = 20.0,
+    measure_duration: Optional[float] = None,
+    measure_smooth_time: float = 0.4,
+    hp_filter_freq: float = 50.0,
+    lp_filter_freq: float = 6000.0,
+    hp_lifter_freq: float = 150.0,
+    lp_lifter_freq: float = 2000.0,
+):
+    """Create a stateful voice activity detector which processes audio incrementally.
 
-    n_channels, ilen = waveform.size()
+    This is the streaming counterpart of :py:func:`vad`. It carries the noise estimate, the
+    measurements and the trigger state from chunk to chunk, and only keeps the audio which can still
+    be output. The returned object has the following methods.
 
-    mean_meas = torch.zeros(n_channels)
-    samples = torch.zeros(n_channels, samplesLen_ns)
-    spectrum = torch.zeros(n_channels, dft_len_ws)
-    noise_spectrum = torch.zeros(n_channels, dft_len_ws)
-    measures = torch.zeros(n_channels, measures_len)
+    - ``accept_waveform(chunk)`` feeds a chunk of shape ``(num_channels, time)``, and returns the
+      audio to output: nothing until voice activity is detected, then the audio from the beginning
+      of the activity, and then every chunk as it is.
+    - ``input_finished()`` marks the end of the audio, and returns the audio left to output, which is
+      the last samples of the audio when no voice activity was detected.
+    - ``triggered()`` returns whether voice activity was detected.
 
-    has_triggered: bool = False
-    num_measures_to_flush: int = 0
-    pos: int = 0
+    The concatenation of the outputs matches :py:func:`vad`, except when the activity begins so early
+    that :py:func:`vad` would start before the first sample, in which case it starts at the first sample.
+    The arguments are the same as the ones of :py:func:`vad`.
 
-    while pos < ilen and not has_triggered:
-        measure_timer_ns -= 1
-        for i in range(n_channels):
-            samples[i, samplesIndex_ns] = waveform[i, pos]
-            # if (!p->measure_timer_ns) {
-            if measure_timer_ns == 0:
-                index_ns: int = (
-                    samplesIndex_ns + samplesLen_ns - measure_len_ns
-                ) % samplesLen_ns
-                meas: float = _measure(
-                    measure_len_ws=measure_len_ws,
-                    samples=samples[i],
-                    spectrum=spectrum[i],
-                    noise_spectrum=noise_spectrum[i],
-                    spectrum_window=spectrum_window,
-                    spectrum_start=spectrum_start,
-                    spectrum_end=spectrum_end,
-                    cepstrum_window=cepstrum_window,
-                    cepstrum_start=cepstrum_start,
-                    cepstrum_end=cepstrum_end,
-                    noise_reduction_amount=noise_reduction_amount,
-                    measure_smooth_time_mult=measure_smooth_time_mult,
-                    noise_up_time_mult=noise_up_time_mult,
-                    noise_down_time_mult=noise_down_time_mult,
-                    index_ns=index_ns,
-                    boot_count=boot_count,
-                )
-                measures[i, measures_index] = meas
-                mean_meas[i] = mean_meas[i] * trigger_meas_time_mult + meas * (
-                    1.0 - trigger_meas_time_mult
-                )
+    Args:
+        sample_rate (int): Sample rate of audio signal.
+        num_channels (int, optional): The number of channels of the audio. (Default: ``1``)
 
-                has_triggered = has_triggered or (mean_meas[i] >= trigger_level)
-                if has_triggered:
-                    n: int = measures_len
-                    k: int = measures_index
-                    jTrigger: int = n
-                    jZero: int = n
-                    j: int = 0
-
-                    for j in range(n):
-                        if (measures[i, k] >= trigger_level) and (
-                            j <= jTrigger + gap_len
-                        ):
-                            jZero = jTrigger = j
-                        elif (measures[i, k] == 0) and (jTrigger >= jZero):
-                            jZero = j
-                        k = (k + n - 1) % n
-                    j = min(j, jZero)
-                    # num_measures_to_flush = range_limit(j, num_measures_to_flush, n);
-                    num_measures_to_flush = min(max(num_measures_to_flush, j), n)
-                # end if has_triggered
-            # end if (measure_timer_ns == 0):
-        # end for
-        samplesIndex_ns += 1
-        pos += 1
-        # end while
-        if samplesIndex_ns == samplesLen_ns:
-            samplesIndex_ns = 0
-        if measure_timer_ns == 0:
-            measure_timer_ns = measure_period_ns
-            measures_index += 1
-            measures_index = measures_index % measures_len
-            if boot_count >= 0:
-                boot_count = -1 if boot_count == boot_count_max else boot_count + 1
-
-        if has_triggered:
-            flushedLen_ns = (measures_len - num_measures_to_flush) * measure_period_ns
-            samplesIndex_ns = (samplesIndex_ns + flushedLen_ns) % samplesLen_ns
-
-    res = waveform[:, pos - samplesLen_ns + flushedLen_ns:]
-    # unpack batch
-    return res.view(shape[:-1] + res.shape[-1:])
+    Returns:
+        torch.classes.torchaudio.vad_VoiceActivityDetector: The detector.
+    """
+    return torch.classes.torchaudio.vad_VoiceActivityDetector(
+        sample_rate, num_channels,
+        trigger_level, trigger_time, search_time, allowed_gap, pre_trigger_time, boot_time,
+        noise_up_time, noise_down_time, noise_reduction_amount, measure_freq, measure_duration,
+        measure_smooth_time, hp_filter_freq, lp_filter_freq, hp_lifter_freq, lp_lifter_freq,
+    )
@@ -4,7 +4,7 @@ from collections.abc import Sequence
 import io
 import math
 import warnings
-from typing import Optional, Tuple
+from typing import List, Optional, Tuple
 
 import torch
 from torch import Tensor
@@ -19,6 +19,9 @@ __all__ = [
     "DB_to_amplitude",
     "compute_deltas",
     "compute_kaldi_pitch",
+    "create_online_kaldi_pitch",
+    "compute_kaldi_fbank",
+    "compute_kaldi_mfcc",
     "create_fb_matrix",
     "melscale_fbanks",
     "linear_fbanks",
@@ -41,6 +44,9 @@ __all__ = [
     "edit_distance",
     "pitch_shift",
     "rnnt_loss",
+    "rnnt_loss_pruned",
+    "rnnt_prune_ranges",
+    "rnnt_prune",
 ]
 
 
@@ -1394,6 +1400,7 @@ def compute_kaldi_pitch(
         simulate_first_pass_online: bool = False,
         recompute_frame: int = 500,
         snip_edges: bool = True,
+        lengths: Optional[torch.Tensor] = None,
 ) -> torch.Tensor:
     """Extract pitch based on method described in *A pitch extraction algorithm tuned
     for automatic speech recognition* [:footcite:`6854049`].
@@ -1451,6 +1458,10 @@ def compute_kaldi_pitch(
             If this is set to false, the incomplete frames near the ending edge won't be snipped,
             so that the number of frames is the file size divided by the frame-shift.
             This makes different types of features give the same number of frames. (default: True)
+        lengths (Tensor or None, optional):
+            The number of valid samples of each waveform in a padded batch, of shape `(...)`.
+            When given, the pitch of each waveform is computed on its valid samples only, and
+            the frames past the end of its output are filled with zeros. (default: ``None``)
 
     Returns:
        Tensor: Pitch feature. Shape: ``(batch, frames 2)`` where the last dimension
@@ -1458,29 +1469,188 @@ def compute_kaldi_pitch(
     """
     shape = waveform.shape
     waveform = waveform.reshape(-1, shape[-1])
-    result = torch.ops.torchaudio.kaldi_ComputeKaldiPitch(
-        waveform, sample_rate, frame_length, frame_shift,
+    if lengths is None:
+        result = torch.ops.torchaudio.kaldi_ComputeKaldiPitch(
+            waveform, sample_rate, frame_length, frame_shift,
+            min_f0, max_f0, soft_min_f0, penalty_factor, lowpass_cutoff,
+            resample_frequency, delta_pitch, nccf_ballast,
+            lowpass_filter_width, upsample_filter_width, max_frames_latency,
+            frames_per_chunk, simulate_first_pass_online, recompute_frame,
+            snip_edges,
+        )
+    else:
+        result, _ = torch.ops.torchaudio.kaldi_ComputeKaldiPitchWithLengths(
+            waveform, lengths.reshape(-1), sample_rate, frame_length, frame_shift,
+            min_f0, max_f0, soft_min_f0, penalty_factor, lowpass_cutoff,
+            resample_frequency, delta_pitch, nccf_ballast,
+            lowpass_filter_width, upsample_filter_width, max_frames_latency,
+            frames_per_chunk, simulate_first_pass_online, recompute_frame,
+            snip_edges,
+        )
+    result = result.reshape(shape[:-1] + result.shape[-2:])
+    return result
+
+
+@_mod_utils.requires_kaldi()
+def create_online_kaldi_pitch(
+        sample_rate: float,
+        frame_length: float = 25.0,
+        frame_shift: float = 10.0,
+        min_f0: float = 50,
+        max_f0: float = 400,
+        soft_min_f0: float = 10.0,
+        penalty_factor: float = 0.1,
+        lowpass_cutoff: float = 1000,
+        resample_frequency: float = 4000,
+        delta_pitch: float = 0.005,
+        nccf_ballast: float = 7000,
+        lowpass_filter_width: int = 1,
+        upsample_filter_width: int = 5,
+        max_frames_latency: int = 0,
+        frames_per_chunk: int = 0,
+        simulate_first_pass_online: bool = False,
+        recompute_frame: int = 500,
+        snip_edges: bool = True,
+):
+    """Create a stateful pitch extractor which processes audio incrementally.
+
+    This is the streaming counterpart of :py:func:`compute_kaldi_pitch`, built on Kaldi's
+    ``OnlinePitchFeature``. The returned object has the following methods.
+
+    - ``accept_waveform(chunk)`` feeds a 1D float32 chunk of audio.
+    - ``get_frames()`` returns the frames which became ready since the previous call,
+      as a Tensor of shape ``(frames, 2)``.
+    - ``num_frames_ready()`` returns the number of frames ready so far.
+    - ``input_finished()`` marks the end of the audio, so that the last frames become ready.
+
+    Frames are not revised once they are returned. ``max_frames_latency`` sets how many
+    frames are held back so that the pitch tracking can settle. When ``get_frames`` is only
+    called after ``input_finished``, the result matches :py:func:`compute_kaldi_pitch`.
+    The arguments are the same as the ones of :py:func:`compute_kaldi_pitch`.
+
+    Args:
+        sample_rate (float): Sample rate of the audio.
+
+    Returns:
+        torch.classes.torchaudio.kaldi_OnlinePitchFeature: The pitch extractor.
+    """
+    return torch.classes.torchaudio.kaldi_OnlinePitchFeature(
+        sample_rate, frame_length, frame_shift,
         min_f0, max_f0, soft_min_f0, penalty_factor, lowpass_cutoff,
         resample_frequency, delta_pitch, nccf_ballast,
         lowpass_filter_width, upsample_filter_width, max_frames_latency,
         frames_per_chunk, simulate_first_pass_online, recompute_frame,
         snip_edges,
     )
+
+
+@_mod_utils.requires_kaldi()
+def compute_kaldi_fbank(
+        waveform: torch.Tensor,
+        sample_rate: float,
+        blackman_coeff: float = 0.42,
+        energy_floor: float = 1.0,
+        frame_length: float = 25.0,
+        frame_shift: float = 10.0,
+        high_freq: float = 0.0,
+        htk_compat: bool = False,
+        low_freq: float = 20.0,
+        num_mel_bins: int = 23,
+        preemphasis_coefficient: float = 0.97,
+        raw_energy: bool = True,
+        remove_dc_offset: bool = True,
+        round_to_power_of_two: bool = True,
+        snip_edges: bool = True,
+        subtract_mean: bool = False,
+        use_energy: bool = False,
+        use_log_fbank: bool = True,
+        use_power: bool = True,
+        vtln_high: float = -500.0,
+        vtln_low: float = 100.0,
+        vtln_warp: float = 1.0,
+        window_type: str = "povey",
+) -> torch.Tensor:
+    """Compute filter bank features in the same way as `compute-fbank-feats` from Kaldi.
+
+    This is a native implementation of :py:func:`torchaudio.compliance.kaldi.fbank`, which
+    processes a batch of waveforms in a single pass. Each frame is windowed, transformed and
+    reduced to the mel energies at once, and the frames are processed in parallel.
+    Dithering is not applied. Refer to :py:func:`torchaudio.compliance.kaldi.fbank` for the
+    description of the arguments.
+
+    Args:
+        waveform (Tensor): The input waveform of shape `(..., time)` and of float32 type,
+            in the value range of the audio file, such as int16.
+        sample_rate (float): Sample rate of `waveform`.
+
+    Returns:
+        Tensor: Filter bank features of shape `(..., frames, num_mel_bins + use_energy)`.
+    """
+    shape = waveform.shape
+    waveform = waveform.reshape(-1, shape[-1])
+    result = torch.ops.torchaudio.kaldi_ComputeFbank(
+        waveform, sample_rate, blackman_coeff, energy_floor, frame_length, frame_shift,
+        high_freq, htk_compat, low_freq, num_mel_bins, preemphasis_coefficient,
+        raw_energy, remove_dc_offset, round_to_power_of_two, snip_edges, subtract_mean,
+        use_energy, use_log_fbank, use_power, vtln_high, vtln_low, vtln_warp, window_type,
+    )
     result = result.reshape(shape[:-1] + result.shape[-2:])
     return result
 
 
-def _get_sinc_resample_kernel(
-        orig_freq: float,
-        new_freq: float,
-        gcd: int,
-        lowpass_filter_width: int,
-        rolloff: float,
-        resampling_method: str,
-        beta: Optional[float],
-        device: torch.device = torch.device("cpu"),
-        dtype: Optional[torch.dtype] = None):
+@_mod_utils.requires_kaldi()
+def compute_kaldi_mfcc(
+        waveform: torch.Tensor,
+        sample_rate: float,
+        blackman_coeff: float = 0.42,
+        cepstral_lifter: float = 22.0,
+        energy_floor: float = 1.0,
+        frame_length: float = 25.0,
+        frame_shift: float = 10.0,
+        high_freq: float = 0.0,
+        htk_compat: bool = False,
+        low_freq: float = 20.0,
+        num_ceps: int = 13,
+        num_mel_bins: int = 23,
+        preemphasis_coefficient: float = 0.97,
+        raw_energy: bool = True,
+        remove_dc_offset: bool = True,
+        round_to_power_of_two: bool = True,
+        snip_edges: bool = True,
+        subtract_mean: bool = False,
+        use_energy: bool = False,
+        vtln_high: float = -500.0,
+        vtln_low: float = 100.0,
+        vtln_warp: float = 1.0,
+        window_type: str = "povey",
+) -> torch.Tensor:
+    """Compute MFCC features in the same way as `compute-mfcc-feats` from Kaldi.
+
+    This is a native implementation of :py:func:`torchaudio.compliance.kaldi.mfcc`, which
+    processes a batch of waveforms in a single pass. Dithering is not applied. Refer to
+    :py:func:`torchaudio.compliance.kaldi.mfcc` for the description of the arguments.
+
+    Args:
+        waveform (Tensor): The input waveform of shape `(..., time)` and of float32 type,
+            in the value range of the audio file, such as int16.
+        sample_rate (float): Sample rate of `waveform`.
+
+    Returns:
+        Tensor: MFCC features of shape `(..., frames, num_ceps)`.
+    """
+    shape = waveform.shape
+    waveform = waveform.reshape(-1, shape[-1])
+    result = torch.ops.torchaudio.kaldi_ComputeMfcc(
+        waveform, sample_rate, blackman_coeff, cepstral_lifter, energy_floor, frame_length,
+        frame_shift, high_freq, htk_compat, low_freq, num_ceps, num_mel_bins,
+        preemphasis_coefficient, raw_energy, remove_dc_offset, round_to_power_of_two,
+        snip_edges, subtract_mean, use_energy, vtln_high, vtln_low, vtln_warp, window_type,
+    )
+    result = result.reshape(shape[:-1] + result.shape[-2:])
+    return result
 
+
+def _warn_non_integer_freq(orig_freq: float, new_freq: float):
     if not (int(orig_freq) == orig_freq and int(new_freq) == new_freq):
         warnings.warn(
             "Non-integer frequencies are being cast to ints and may result in poor resampling quality "
@@ -1494,6 +1664,20 @@ def _get_sinc_resample_kernel(
             "https://github.com/pytorch/audio/issues/1487."
         )
 
+
+def _get_sinc_resample_kernel(
+        orig_freq: float,
+        new_freq: float,
+        gcd: int,
+        lowpass_filter_width: int,
+        rolloff: float,
+        resampling_method: str,
+        beta: Optional[float],
+        device: torch.device = torch.device("cpu"),
+        dtype: Optional[torch.dtype] = None):
+
+    _warn_non_integer_freq(orig_freq, new_freq)
+
     if resampling_method not in ['sinc_interpolation', 'kaiser_window']:
         raise ValueError('Invalid resampling method: {}'.format(resampling_method))
 
@@ -1627,6 +1811,17 @@ def resample(
 
     gcd = math.gcd(int(orig_freq), int(new_freq))
 
+    # The native implementation caches the polyphase form of the kernel, but it does not support autograd.
+    if (
+        not waveform.requires_grad
+        and waveform.dtype in [torch.float32, torch.float64]
+        and waveform.device.type in ["cpu", "cuda"]
+    ):
+        _warn_non_integer_freq(orig_freq, new_freq)
+        return torch.ops.torchaudio._resample(
+            waveform, int(orig_freq) // gcd, int(new_freq) // gcd, lowpass_filter_width, rolloff,
+            resampling_method, beta)
+
     kernel, width = _get_sinc_resample_kernel(orig_freq, new_freq, gcd, lowpass_filter_width, rolloff,
                                               resampling_method, beta, waveform.device, waveform.dtype)
     resampled = _apply_sinc_resample_kernel(waveform, orig_freq, new_freq, gcd, kernel, width)
@@ -1756,6 +1951,9 @@ def rnnt_loss(
     blank: int = -1,
     clamp: float = -1,
     reduction: str = "mean",
+    reuse_logits_for_grads: bool = False,
+    check_lengths: bool = True,
+    alphas_betas_kernel: str = "counters",
 ):
     """Compute the RNN Transducer loss from *Sequence Transduction with Recurrent Neural Networks*
     [:footcite:`graves2012sequence`].
@@ -1765,7 +1963,9 @@ def rnnt_loss(
 
     Args:
         logits (Tensor): Tensor of dimension (batch, max seq length, max target length + 1, class)
-            containing output from joiner
+            containing output from joiner, or the packed output, of dimension (rows, class), where the
+            (seq length, target length + 1, class) outputs of the sequences, without padding, are flattened and
+            concatenated. The packed layout saves the memory and the computation of the padding.
         targets (Tensor): Tensor of dimension (batch, max target length) containing targets with zero padded
         logit_lengths (Tensor): Tensor of dimension (batch) containing lengths of each sequence from encoder
         target_lengths (Tensor): Tensor of dimension (batch) containing lengths of targets for each sequence
@@ -1773,6 +1973,22 @@ def rnnt_loss(
         clamp (float, optional): clamp for gradients (Default: ``-1``)
         reduction (string, optional): Specifies the reduction to apply to the output:
             ``'none'`` | ``'mean'`` | ``'sum'``. (Default: ``'mean'``)
+        reuse_logits_for_grads (bool, optional): Whether to write the gradients over ``logits`` instead of
+            allocating a tensor of the same size, which halves the memory needed by the loss. The content of
+            ``logits`` is replaced, so autograd raises an error if an operation saved it for its backward pass
+            (a final linear layer only saves its input), and ``logits`` cannot be a leaf tensor requiring
+            gradient. (Default: ``False``)
+        check_lengths (bool, optional): Whether to check on the host that the lengths match the shapes of
+            ``logits`` and ``targets``, which on CUDA waits for the lengths to be computed. If ``False``, they are
+            checked with device-side assertions instead, so that the loss is launched without synchronization
+            and can be captured in a CUDA graph. Then the maximum lengths may be smaller than the padded
+            dimensions, and packed ``logits`` still need one synchronization. (Default: ``True``)
+        alphas_betas_kernel (str, optional): The CUDA kernel computing the forward and backward variables.
+            ``'counters'`` runs many blocks per lattice, which wait for each other through counters in the
+            workspace. ``'diagonal'`` runs one block per lattice and direction, which walks the lattice through its
+            anti-diagonals and needs no counters, so it only fills the device with large batches. It falls back to
+            ``'counters'`` when ``2 * (max target length + 1)`` floats do not fit in 48 KiB of shared memory.
+            Ignored on CPU. (Default: ``'counters'``)
     Returns:
         Tensor: Loss with the reduction option applied. If ``reduction`` is  ``'none'``, then size (batch),
         otherwise scalar.
@@ -1790,6 +2006,252 @@ def rnnt_loss(
         target_lengths=target_lengths,
         blank=blank,
         clamp=clamp,
+        reuse_logits_for_grads=reuse_logits_for_grads,
+        check_lengths=check_lengths,
+        alphas_betas_kernel=alphas_betas_kernel,
+    )
+
+    if reduction == 'mean':
+        return costs.mean()
+    elif reduction == 'sum':
+        return costs.sum()
+
+    return costs
+
+
+def rnnt_loss_release_workspace() -> None:
+    """Free the workspaces cached by :py:func:`rnnt_loss`.
+
+    The buffers that :py:func:`rnnt_loss` needs besides its outputs (softmax denominators, log probabilities,
+    alphas and betas, about five floats per element of the lattice) are kept after the call and reused by the
+    next ones on the same device and stream. They only grow, to the size of the largest batch seen, which can
+    be returned to the system with this function, for example at the end of the training. On GPU, the memory
+    goes back to the caching allocator, see :py:func:`torch.cuda.empty_cache`.
+    """
+    torch.ops.torchaudio.rnnt_loss_release_workspace()
+
+
+def rnnt_score(
+    logits: Tensor,
+    targets: Tensor,
+    logit_lengths: Tensor,
+    target_lengths: Tensor,
+    blank: int = -1,
+    alphas_betas_kernel: str = "counters",
+) -> Tensor:
+    """Compute the RNN Transducer costs (negative log likelihoods) of hypotheses, without gradients.
+
+    Unlike :py:func:`rnnt_loss`, only the forward variables (alphas) are computed, and the buffers of the
+    backward variables and of the gradients are not allocated, which suits the rescoring of N-best lists and
+    validation. Each sequence can have multiple hypotheses, scored against the same encoder output.
+
+    Args:
+        logits (Tensor): Tensor of dimension (batch * hypos, max seq length, max target length + 1, class)
+            containing output from joiner, the hypotheses of a sequence being consecutive
+        targets (Tensor): Tensor of dimension (batch * hypos, max target length) containing targets with zero
+            padded
+        logit_lengths (Tensor): Tensor of dimension (batch) containing lengths of each sequence from encoder
+        target_lengths (Tensor): Tensor of dimension (batch * hypos) containing lengths of targets for each
+            hypothesis
+        blank (int, optional): blank label (Default: ``-1``)
+        alphas_betas_kernel (str, optional): The CUDA kernel computing the forward variables, see
+            :py:func:`rnnt_loss`. (Default: ``'counters'``)
+    Returns:
+        Tensor: Costs of dimension (batch * hypos).
+    """
+    if blank < 0:  # reinterpret blank index if blank < 0.
+        blank = logits.shape[-1] + blank
+
+    return torch.ops.torchaudio.rnnt_score(
+        logits=logits,
+        targets=targets,
+        logit_lengths=logit_lengths,
+        target_lengths=target_lengths,
+        blank=blank,
+        alphas_betas_kernel=alphas_betas_kernel,
+    )
+
+
+def _rnnt_simple_occupancy(
+    am: Tensor,
+    lm: Tensor,
+    targets: Tensor,
+    logit_lengths: Tensor,
+    target_lengths: Tensor,
+    blank: int,
+) -> Tensor:
+    """Posterior probabilities of the nodes (batch, time, max target length + 1) of the lattice of the
+    simple joiner ``log_softmax(am[:, :, None] + lm[:, None])``, without materializing its logits."""
+    B, T, _ = am.shape
+    U = targets.shape[1]
+    am_max = am.amax(dim=2, keepdim=True)
+    lm_max = lm.amax(dim=2, keepdim=True)
+    # log sum_d exp(am[t, d] + lm[u, d]), as a matrix product.
+    norm = torch.matmul((am - am_max).exp(), (lm - lm_max).exp().transpose(1, 2)).log()
+    norm = norm + am_max + lm_max.transpose(1, 2)
+
+    blank_lp = am[:, :, blank].unsqueeze(2) + lm[:, :, blank].unsqueeze(1) - norm
+    targets_ = targets.long()
+    am_target = torch.gather(am, 2, targets_.unsqueeze(1).expand(B, T, U))
+    lm_target = torch.gather(lm[:, :U], 2, targets_.unsqueeze(2)).squeeze(2)
+    emit_lp = am_target + lm_target.unsqueeze(1) - norm[:, :, :U]
+    emit_lp = torch.nn.functional.pad(emit_lp, (0, 1), value=float("-inf"))
+
+    # The lattice ops take logits over classes: the third class carries the rest of the probability mass, so
+    # that their log softmax gives back blank_lp and emit_lp.
+    rest = (1 - blank_lp.exp() - emit_lp.exp()).clamp(min=1e-10).log()
+    logits = torch.stack([blank_lp, emit_lp, rest], dim=3).float().contiguous()
+    lattice_targets = torch.ones_like(targets, dtype=torch.int32)
+    lengths = (logit_lengths.int(), target_lengths.int())
+    alphas = torch.ops.torchaudio.rnnt_loss_alphas(logits, lattice_targets, lengths[0], lengths[1], 0, -1.0)
+    betas = torch.ops.torchaudio.rnnt_loss_betas(logits, lattice_targets, lengths[0], lengths[1], 0, -1.0)
+    occupancy = (alphas + betas - betas[:, :1, :1]).exp()
+
+    t = torch.arange(T, device=am.device)
+    u = torch.arange(U + 1, device=am.device)
+    valid = (t[None, :, None] < logit_lengths[:, None, None]) & (u[None, None, :] <= target_lengths[:, None, None])
+    return occupancy.masked_fill(~valid, 0.)
+
+
+def rnnt_prune_ranges(
+    am: Tensor,
+    lm: Tensor,
+    targets: Tensor,
+    logit_lengths: Tensor,
+    target_lengths: Tensor,
+    prune_range: int,
+    blank: int = -1,
+) -> Tensor:
+    """Select the band of symbols of each frame for :py:func:`rnnt_loss_pruned`
+    [:footcite:`kuang2022pruned`].
+
+    The bands are chosen with a simple joiner, ``log_softmax(am[:, :, None] + lm[:, None])``, whose lattice is
+    computed without materializing its logits: for each frame, the window of ``prune_range`` consecutive
+    symbols with the largest posterior probability is selected, then the windows are adjusted so that the
+    pruned lattice is connected.
+
+    Args:
+        am (Tensor): Tensor of dimension (batch, max seq length, class) containing the output of the encoder,
+            projected to the classes.
+        lm (Tensor): Tensor of dimension (batch, max target length + 1, class) containing the output of the
+            prediction network, projected to the classes.
+        targets (Tensor): Tensor of dimension (batch, max target length) containing targets with zero padded
+        logit_lengths (Tensor): Tensor of dimension (batch) containing lengths of each sequence from encoder
+        target_lengths (Tensor): Tensor of dimension (batch) containing lengths of targets for each sequence
+        prune_range (int): Number of symbols of the band of each frame. Must be at least 2.
+        blank (int, optional): blank label (Default: ``-1``)
+
+    Returns:
+        Tensor: Tensor of dimension (batch, max seq length) and type ``int32``, containing the first symbol of
+        the band of each frame.
+    """
+    if prune_range < 2:
+        raise ValueError(f"prune_range must be at least 2. Found: {prune_range}")
+    if blank < 0:
+        blank = am.shape[-1] + blank
+    U = targets.shape[1]
+    S = min(prune_range, U + 1)
+
+    with torch.no_grad():
+        occupancy = _rnnt_simple_occupancy(am, lm, targets, logit_lengths, target_lengths, blank)
+        # Probability mass of the windows [s, s + S), for s in [0, U + 1 - S].
+        cumulated = torch.nn.functional.pad(occupancy.cumsum(dim=2), (1, 0))
+        ranges = (cumulated[:, :, S:] - cumulated[:, :, :-S]).argmax(dim=2)
+
+        T = ranges.shape[1]
+        last = (target_lengths.long() + 1 - S).clamp(min=0).unsqueeze(1)
+        t = torch.arange(T, device=ranges.device).unsqueeze(0)
+        ranges = torch.min(ranges, last)
+        ranges[:, 0] = 0
+        ranges = torch.cummax(ranges, dim=1)[0]
+        # The band of the last frame contains the end of the targets.
+        ranges = torch.where(t >= logit_lengths.unsqueeze(1) - 1, last, ranges)
+        # The bands of consecutive frames overlap: ranges[t + 1] <= ranges[t] + S - 1, raising the bands from
+        # the end, then lowering them from the start.
+        step = t * (S - 1)
+        ranges = torch.cummax((ranges - step).flip(1), dim=1)[0].flip(1) + step
+        ranges[:, 0] = 0
+        ranges = torch.cummin(ranges - step, dim=1)[0] + step
+    return ranges.int()
+
+
+def rnnt_prune(am: Tensor, lm: Tensor, ranges: Tensor, prune_range: int) -> Tuple[Tensor, Tensor]:
+    """Gather the inputs of the joiner for the bands selected by :py:func:`rnnt_prune_ranges`.
+
+    Args:
+        am (Tensor): Tensor of dimension (batch, max seq length, feature) containing the output of the encoder.
+        lm (Tensor): Tensor of dimension (batch, max target length + 1, feature) containing the output of the
+            prediction network.
+        ranges (Tensor): Tensor of dimension (batch, max seq length) returned by :py:func:`rnnt_prune_ranges`.
+        prune_range (int): Number of symbols of the band of each frame.
+
+    Returns:
+        (Tensor, Tensor): The encoder and the prediction network outputs, both of dimension
+        (batch, max seq length, prune_range, feature), to be combined by the joiner into the logits of
+        :py:func:`rnnt_loss_pruned`.
+    """
+    B, T, C = am.shape
+    U1, C_lm = lm.shape[1], lm.shape[2]
+    S = min(prune_range, U1)
+    index = ranges.long().unsqueeze(2) + torch.arange(S, device=ranges.device)
+    index = index.clamp(max=U1 - 1)
+    am_pruned = am.unsqueeze(2).expand(B, T, S, C)
+    lm_pruned = torch.gather(lm.unsqueeze(1).expand(B, T, U1, C_lm), 2, index.unsqueeze(3).expand(B, T, S, C_lm))
+    return am_pruned, lm_pruned
+
+
+def rnnt_loss_pruned(
+    logits: Tensor,
+    targets: Tensor,
+    logit_lengths: Tensor,
+    target_lengths: Tensor,
+    ranges: Tensor,
+    blank: int = -1,
+    clamp: float = -1,
+    reduction: str = "mean",
+):
+    """Compute the RNN Transducer loss over a pruned lattice [:footcite:`kuang2022pruned`].
+
+    Only the nodes (t, u) with ``ranges[b, t] <= u < ranges[b, t] + prune_range`` are kept, so the logits and
+    the gradients are of dimension (batch, max seq length, prune_range, class) instead of
+    (batch, max seq length, max target length + 1, class). The ranges are usually computed with
+    :py:func:`rnnt_prune_ranges` and the logits by applying the joiner to the outputs of :py:func:`rnnt_prune`.
+
+    If no path of the full lattice remains in the pruned one, the loss is infinite and the gradients are zero.
+    The nodes of the bands which are out of ``[0, target length]`` are ignored, so this is also the case for
+    ranges which are negative or past the targets.
+    With ``prune_range = max target length + 1`` and zero ranges, the loss is the one of :py:func:`rnnt_loss`.
+
+    Args:
+        logits (Tensor): Tensor of dimension (batch, max seq length, prune_range, class) containing output from
+            joiner for the pruned nodes
+        targets (Tensor): Tensor of dimension (batch, max target length) containing targets with zero padded
+        logit_lengths (Tensor): Tensor of dimension (batch) containing lengths of each sequence from encoder
+        target_lengths (Tensor): Tensor of dimension (batch) containing lengths of targets for each sequence
+        ranges (Tensor): Tensor of dimension (batch, max seq length) containing the first symbol of the band
+            of each frame
+        blank (int, optional): blank label (Default: ``-1``)
+        clamp (float, optional): clamp for gradients (Default: ``-1``)
+        reduction (string, optional): Specifies the reduction to apply to the output:
+            ``'none'`` | ``'mean'`` | ``'sum'``. (Default: ``'mean'``)
+    Returns:
+        Tensor: Loss with the reduction option applied. If ``reduction`` is  ``'none'``, then size (batch),
+        otherwise scalar.
+    """
+    if reduction not in ['none', 'mean', 'sum']:
+        raise ValueError("reduction should be one of 'none', 'mean', or 'sum'")
+
+    if blank < 0:  # reinterpret blank index if blank < 0.
+        blank = logits.shape[-1] + blank
+
+    costs, _ = torch.ops.torchaudio.rnnt_loss_pruned(
+        logits=logits,
+        targets=targets,
+        logit_lengths=logit_lengths,
+        target_lengths=target_lengths,
+        ranges=ranges,
+        blank=blank,
+        clamp=clamp,
     )
 
     if reduction == 'mean':
@@ -1798,3 +2260,106 @@ def rnnt_loss(
         return costs.sum()
 
     return costs
+
+
+def create_ctc_decoder(
+    tokens: List[str],
+    blank: int = 0,
+    word_boundary: int = -1,
+    beam_size: int = 50,
+    beam_size_token: Optional[int] = None,
+    beam_threshold: float = 25.,
+    lexicon: Optional[str] = None,
+    lm: Optional[str] = None,
+    lm_weight: float = 2.,
+    word_score: float = 0.,
+    nbest: int = 1,
+):
+    """Create a CTC prefix beam search decoder, with an optional lexicon and n-gram language model.
+
+    The prefixes of the beam are extended frame by frame with the ``beam_size_token`` tokens of
+    highest emission, and the probability of a prefix is summed over the alignments which collapse
+    to it. A prefix is scored by its log probability, plus ``lm_weight`` times the log probability
+    of its words under the language model, plus ``word_score`` per word.
+    The words are the tokens between the ``word_boundary`` tokens; with a lexicon, the prefixes only
+    spell the words of the lexicon, and the hypotheses which end inside a word are dropped.
+
+    The returned object has the method ``decode(emissions, lengths=None)``, which takes the
+    float32 CPU log probabilities of shape ``(batch, frame, len(tokens))`` and the optional number of
+    valid frames of each utterance, and returns, for each utterance, the list of the ``(tokens, score)``
+    of its best hypotheses by decreasing score. The utterances are decoded in parallel.
+    The object can be used in TorchScript, and be serialized.
+
+    Args:
+        tokens (List[str]): The tokens (labels) of the emissions.
+        blank (int, optional): The index of blank. (Default: ``0``)
+        word_boundary (int, optional): The index of the token which separates the words, such as ``|``,
+            or ``-1`` if there is none, in which case ``lexicon`` and ``lm`` must be ``None``.
+            (Default: ``-1``)
+        beam_size (int, optional): The number of prefixes kept at each frame. (Default: ``50``)
+        beam_size_token (int or None, optional): The number of tokens, besides blank, tried at each
+            frame, or ``None`` for all of them. (Default: ``None``)
+        beam_threshold (float, optional): The prefixes whose score is below the best by more than
+            this are dropped. (Default: ``25.``)
+        lexicon (str or None, optional): The path of a lexicon file, with one word per line followed
+            by its tokens, separated by spaces. (Default: ``None``)
+        lm (str or None, optional): The path of a word n-gram language model in ARPA format.
+            (Default: ``None``)
+        lm_weight (float, optional): The weight of the language model. (Default: ``2.``)
+        word_score (float, optional): The score added for each word. (Default: ``0.``)
+        nbest (int, optional): The number of hypotheses returned. (Default: ``1``)
+
+    Returns:
+        torch.classes.torchaudio.decoder_CTCDecoder: The decoder.
+    """
+    return torch.classes.torchaudio.decoder_CTCDecoder(
+        tokens, blank, word_boundary, beam_size,
+        0 if beam_size_token is None else beam_size_token,
+        beam_threshold, lexicon or '', lm or '', lm_weight, word_score, nbest,
+    )
+
+
+def create_rnnt_decoder(
+    predictor: str,
+    joiner: str,
+    blank: int,
+    beam_width: int = 10,
+    mode: str = "time_synchronous",
+    max_symbols_per_step: int = 2,
+    max_output_length: Optional[int] = None,
+):
+    """Create a beam search decoder for RNN transducers [:footcite:`saon2020alignment`].
+
+    The predictor and the joiner are TorchScript modules saved with :py:func:`torch.jit.save`.
+    The ``forward`` method of the predictor takes the ``(N, )`` int64 tokens of ``N`` hypotheses and
+    their state, a list of tensors whose first dimension is the hypothesis, and returns its outputs,
+    ``(N, ...)``, and the state after the tokens. Before the first symbol, it is given ``blank``.
+    The ``forward`` method of the joiner takes the encoder frames and the predictor outputs of ``N``
+    hypotheses, and returns their ``(N, class)`` logits.
+
+    The returned object has the method ``search(encoder_outputs, initial_state)``, which takes the
+    ``(frame, ...)`` outputs of the encoder for one utterance and the state of the predictor for one
+    hypothesis (an empty list for a stateless predictor), and returns the list of the ``(tokens, score)``
+    of the best hypotheses by decreasing score. The hypotheses of a step are run through the predictor
+    and the joiner as one batch, and the hypotheses with the same tokens are merged.
+    The object can be used in TorchScript, and be serialized.
+
+    Args:
+        predictor (str): The path of the predictor module.
+        joiner (str): The path of the joiner module.
+        blank (int): The index of blank.
+        beam_width (int, optional): The number of hypotheses kept at each step. With ``1`` and
+            ``"time_synchronous"``, the decoding is greedy. (Default: ``10``)
+        mode (str, optional): ``"time_synchronous"``, in which the hypotheses advance frame by frame,
+            or ``"alignment_length_synchronous"``, in which the hypotheses of a step have the same
+            number of frames plus tokens. (Default: ``"time_synchronous"``)
+        max_symbols_per_step (int, optional): The maximum number of tokens emitted in a frame, for
+            ``"time_synchronous"``. (Default: ``2``)
+        max_output_length (int or None, optional): The maximum number of tokens of a hypothesis, or
+            ``None`` for ``max_symbols_per_step`` times the number of frames. (Default: ``None``)
+
+    Returns:
+        torch.classes.torchaudio.rnnt_BeamSearchDecoder: The decoder.
+    """
+    return torch.classes.torchaudio.rnnt_BeamSearchDecoder(
+        predictor, joiner, blank, beam_width, mode, max_symbols_per_step, max_output_length or 0)
@@ -4,13 +4,14 @@ from .sox_effects import (
     shutdown_sox_effects,
     effect_names,
     apply_effects_tensor,
+    prepare_effects,
     apply_effects_file,
+    stream_effects_file,
 )
 
 
 if _mod_utils.is_sox_available():
     import atexit
-    init_sox_effects()
     atexit.register(shutdown_sox_effects)
 
 __all__ = [
@@ -18,5 +19,7 @@ __all__ = [
     'shutdown_sox_effects',
     'effect_names',
     'apply_effects_tensor',
+    'prepare_effects',
     'apply_effects_file',
+    'stream_effects_file',
 ]
@@ -1,5 +1,5 @@
 import os
-from typing import List, Tuple, Optional
+from typing import Iterator, List, Tuple, Optional
 
 import torch
 
@@ -13,7 +13,9 @@ def init_sox_effects():
     """Initialize resources required to use sox effects.
 
     Note:
-        You do not need to call this function manually. It is called automatically.
+        You do not need to call this function manually. It is called automatically
+        the first time an effects chain is created, so importing :py:mod:`torchaudio`
+        does not initialize libsox.
 
     Once initialized, you do not need to call this function again across the multiple uses of
     sox effects though it is safe to do so as long as :func:`shutdown_sox_effects` is not called yet.
@@ -30,7 +32,7 @@ def shutdown_sox_effects():
     Note:
         You do not need to call this function manually. It is called automatically.
 
-    It is safe to call this function multiple times.
+    It is safe to call this function multiple times, and before sox effects are initialized.
     Once :py:func:`shutdown_sox_effects` is called, you can no longer use SoX effects and
     initializing again will result in error.
     """
@@ -153,6 +155,60 @@ def apply_effects_tensor(
         tensor, sample_rate, effects, channels_first)
 
 
+@_mod_utils.requires_sox()
+def prepare_effects(
+        effects: List[List[str]],
+        sample_rate: int,
+        num_channels: int,
+        dtype: torch.dtype = torch.float32,
+        channels_first: bool = True,
+        buffer_size: Optional[int] = None,
+):
+    """Set up sox effects once, to apply them to many Tensors
+
+    The effects are checked once for Tensors of the given sample rate, number of channels and
+    dtype, and the returned object has an ``apply`` method which works like
+    :py:func:`apply_effects_tensor`. The effects are looked up and their options are parsed
+    once, and each call starts and stops them again. The effects of multichannel kind, such as
+    ``compand``, are created again by each call. The calls share the state of the effects, so
+    calls made from multiple threads at the same time run one after another.
+
+    Args:
+        effects (List[List[str]]): List of effects. See :py:func:`apply_effects_tensor`.
+        sample_rate (int): Sample rate of the input Tensors.
+        num_channels (int): The number of channels of the input Tensors.
+        dtype (torch.dtype, optional): The dtype of the input Tensors. One of ``torch.float32``,
+            ``torch.int32``, ``torch.int16`` and ``torch.uint8``. (Default: ``torch.float32``)
+        channels_first (bool, optional): Indicates if the input Tensors' dimension is
+            ``[channels, time]`` or ``[time, channels]``.
+        buffer_size (int, optional): The maximum number of samples processed by the effects at a
+            time. Unlike :py:func:`torchaudio.utils.sox_utils.set_buffer_size`, this only affects
+            the returned object, but it cannot exceed the buffer size set with that function.
+            (Default: ``None``, the buffer size of ``libsox``)
+
+    Returns:
+        torch.classes.torchaudio.sox_effects_PreparedEffects: Object with the following methods.
+
+            * ``apply(tensor: torch.Tensor) -> Tuple[torch.Tensor, int]``: Same as
+              :py:func:`apply_effects_tensor` with the above arguments.
+            * ``get_output_sample_rate() -> int``: Sample rate of the output.
+            * ``get_output_num_channels() -> int``: The number of channels of the output.
+
+    Example
+        >>> effects = [
+        ...     ["speed", "0.9"],
+        ...     ["rate", "16000"],
+        ...     ["reverb", "-w"],
+        ...     ["channels", "1"],
+        ... ]
+        >>> augment = torchaudio.sox_effects.prepare_effects(effects, 16000, 2)
+        >>> for waveform in clips:
+        ...     augmented, sample_rate = augment.apply(waveform)
+    """
+    return torch.classes.torchaudio.sox_effects_PreparedEffects(
+        effects, sample_rate, num_channels, dtype, channels_first, buffer_size)
+
+
 @_mod_utils.requires_sox()
 def apply_effects_file(
         path: str,
@@ -271,3 +327,62 @@ def apply_effects_file(
         path = os.fspath(path)
     return torch.ops.torchaudio.sox_effects_apply_effects_file(
         path, effects, normalize, channels_first, format)
+
+
+@_mod_utils.requires_sox()
+def stream_effects_file(
+        path: str,
+        effects: List[List[str]],
+        frames_per_chunk: int,
+        normalize: bool = True,
+        channels_first: bool = True,
+        format: Optional[str] = None,
+        num_buffered_chunks: int = 3,
+) -> Tuple[Iterator[torch.Tensor], int]:
+    """Apply sox effects to the audio file and load the resulting data chunk by chunk
+
+    This function works like :py:func:`apply_effects_file`, but instead of returning the
+    whole audio at once, it returns an iterator over chunks of ``frames_per_chunk`` frames
+    (the last chunk can be shorter). The file is decoded in a background thread, which stops
+    when ``num_buffered_chunks`` chunks are waiting to be consumed, so the memory in use does
+    not depend on the length of the file and decoding overlaps with the processing of the
+    chunks. Concatenating the chunks along the time axis gives the output of
+    :py:func:`apply_effects_file`.
+
+    Note:
+        The decoding stops when the iterator is deleted, even if it is not exhausted.
+        With TorchScript, use ``torch.classes.torchaudio.sox_effects_StreamingEffectsReader``,
+        whose ``next`` method returns the next chunk or ``None`` at the end.
+
+    Args:
+        path (path-like object): Source of audio data.
+        effects (List[List[str]]): List of effects.
+        frames_per_chunk (int): The number of frames of each chunk.
+        normalize (bool, optional): See :py:func:`apply_effects_file`.
+        channels_first (bool, optional): When True, the chunks have dimension ``[channel, time]``.
+            Otherwise, they have dimension ``[time, channel]``.
+        format (str or None, optional): See :py:func:`apply_effects_file`.
+        num_buffered_chunks (int, optional): The maximum number of decoded chunks waiting
+            to be consumed. (Default: ``3``)
+
+    Returns:
+        Tuple[Iterator[torch.Tensor], int]: Iterator over the chunks and sample rate.
+
+    Example
+        >>> chunks, sample_rate = torchaudio.sox_effects.stream_effects_file(
+        ...     "podcast.mp3", [["rate", "16000"]], frames_per_chunk=16000 * 30)
+        >>> for chunk in chunks:
+        ...     transcript = model(chunk)
+    """
+    reader = torch.classes.torchaudio.sox_effects_StreamingEffectsReader(
+        os.fspath(path), effects, frames_per_chunk, normalize, channels_first, format,
+        num_buffered_chunks)
+
+    def _iterate():
+        while True:
+            chunk = reader.next()
+            if chunk is None:
+                return
+            yield chunk
+
+    return _iterate(), reader.get_sample_rate()
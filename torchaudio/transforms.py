@@ -480,6 +480,33 @@ class InverseMelScale(torch.nn.Module):
         return specgram
 
 
+def _mel_spectrogram_generic(
+        waveform: Tensor,
+        window: Tensor,
+        fb: Tensor,
+        n_fft: int,
+        hop_length: int,
+        center: bool,
+        pad_mode: str,
+        normalized: bool,
+        power: float,
+        log_offset: Optional[float],
+) -> Tensor:
+    specgram = F.spectrogram(
+        waveform, 0, window, n_fft, hop_length, window.size(0), power, normalized, center, pad_mode, True)
+    mel_specgram = torch.matmul(specgram.transpose(-1, -2), fb).transpose(-1, -2)
+    if log_offset is not None:
+        mel_specgram = torch.log(mel_specgram + log_offset)
+    return mel_specgram
+
+
+try:
+    _mel_spectrogram = torch.ops.torchaudio._mel_spectrogram
+except RuntimeError as err:
+    assert str(err) == 'No such operator torchaudio::_mel_spectrogram'
+    _mel_spectrogram = _mel_spectrogram_generic
+
+
 class MelSpectrogram(torch.nn.Module):
     r"""Create MelSpectrogram for a raw audio signal. This is a composition of Spectrogram
     and MelScale.
@@ -574,8 +601,33 @@ class MelSpectrogram(torch.nn.Module):
         Returns:
             Tensor: Mel frequency spectrogram of size (..., ``n_mels``, time).
         """
+        return self._mel_spectrogram(waveform, None)
+
+    def _mel_spectrogram(self, waveform: Tensor, log_offset: Optional[float]) -> Tensor:
+        """Computes the mel spectrogram, and its log with the offset if ``log_offset`` is given."""
+        spectrogram = self.spectrogram
+        fb = self.mel_scale.fb
+        # The native implementation computes the spectra and projects them onto the mel bands for a block of frames
+        # at a time, so the linear spectrogram is not materialized, but it does not support autograd.
+        if (
+            not waveform.requires_grad
+            and waveform.dtype in [torch.float32, torch.float64]
+            and waveform.device.type in ["cpu", "cuda"]
+            and spectrogram.window.dtype == waveform.dtype
+            and fb.dtype == waveform.dtype
+            and spectrogram.onesided
+            and spectrogram.pad_mode in ["reflect", "replicate", "constant"]
+        ):
+            if self.pad > 0:
+                waveform = torch.nn.functional.pad(waveform, (self.pad, self.pad), "constant")
+            return _mel_spectrogram(
+                waveform, spectrogram.window, fb, self.n_fft, self.hop_length, spectrogram.center,
+                spectrogram.pad_mode, self.normalized, self.power, log_offset)
+
         specgram = self.spectrogram(waveform)
         mel_specgram = self.mel_scale(specgram)
+        if log_offset is not None:
+            mel_specgram = torch.log(mel_specgram + log_offset)
         return mel_specgram
 
 
@@ -635,12 +687,11 @@ class MFCC(torch.nn.Module):
         Returns:
             Tensor: specgram_mel_db of size (..., ``n_mfcc``, time).
         """
-        mel_specgram = self.MelSpectrogram(waveform)
         if self.log_mels:
             log_offset = 1e-6
-            mel_specgram = torch.log(mel_specgram + log_offset)
+            mel_specgram = self.MelSpectrogram._mel_spectrogram(waveform, log_offset)
         else:
-            mel_specgram = self.amplitude_to_DB(mel_specgram)
+            mel_specgram = self.amplitude_to_DB(self.MelSpectrogram(waveform))
 
         # (..., time, n_mels) dot (n_mels, n_mfcc) -> (..., n_nfcc, time)
         mfcc = torch.matmul(mel_specgram.transpose(-1, -2), self.dct_mat).transpose(-1, -2)
@@ -1448,6 +1499,12 @@ class RNNTLoss(torch.nn.Module):
         clamp (float, optional): clamp for gradients (Default: ``-1``)
         reduction (string, optional): Specifies the reduction to apply to the output:
             ``'none'`` | ``'mean'`` | ``'sum'``. (Default: ``'mean'``)
+        reuse_logits_for_grads (bool, optional): Whether to write the gradients over the logits, see
+            :py:func:`torchaudio.functional.rnnt_loss`. (Default: ``False``)
+        check_lengths (bool, optional): Whether to check the lengths on the host, see
+            :py:func:`torchaudio.functional.rnnt_loss`. (Default: ``True``)
+        alphas_betas_kernel (str, optional): The CUDA kernel of the forward and backward variables, see
+            :py:func:`torchaudio.functional.rnnt_loss`. (Default: ``'counters'``)
     """
 
     def __init__(
@@ -1455,11 +1512,17 @@ class RNNTLoss(torch.nn.Module):
         blank: int = -1,
         clamp: float = -1.,
         reduction: str = "mean",
+        reuse_logits_for_grads: bool = False,
+        check_lengths: bool = True,
+        alphas_betas_kernel: str = "counters",
     ):
         super().__init__()
         self.blank = blank
         self.clamp = clamp
         self.reduction = reduction
+        self.reuse_logits_for_grads = reuse_logits_for_grads
+        self.check_lengths = check_lengths
+        self.alphas_betas_kernel = alphas_betas_kernel
 
     def forward(
         self,
@@ -1471,7 +1534,8 @@ class RNNTLoss(torch.nn.Module):
         """
         Args:
             logits (Tensor): Tensor of dimension (batch, max seq length, max target length + 1, class)
-                containing output from joiner
+                containing output from joiner, or the packed output of dimension (rows, class), see
+                :py:func:`torchaudio.functional.rnnt_loss`
             targets (Tensor): Tensor of dimension (batch, max target length) containing targets with zero padded
             logit_lengths (Tensor): Tensor of dimension (batch) containing lengths of each sequence from encoder
             target_lengths (Tensor): Tensor of dimension (batch) containing lengths of targets for each sequence
@@ -1486,5 +1550,8 @@ class RNNTLoss(torch.nn.Module):
             target_lengths,
             self.blank,
             self.clamp,
-            self.reduction
+            self.reduction,
+            self.reuse_logits_for_grads,
+            self.check_lengths,
+            self.alphas_betas_kernel,
         )